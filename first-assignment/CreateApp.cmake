@@ -13,6 +13,11 @@ function(create_app target_name cpphpp_files hlsl_files)
     set_source_files_properties(${hlsl_files} PROPERTIES VS_TOOL_OVERRIDE "None")
     add_executable(${target_name} ${cpphpp_files} ${hlsl_files})
 
+    # Optional fourth argument: the shader entry points to compile at build time, see embed_shaders.
+    if(ARGC GREATER 3)
+        embed_shaders(${target_name} "${hlsl_files}" "${ARGV3}")
+    endif()
+
 
     set(INCLUDE_DIR
         "${CMAKE_CURRENT_SOURCE_DIR}/include")
@@ -26,4 +31,82 @@ function(create_app target_name cpphpp_files hlsl_files)
     endforeach()
         
     target_link_libraries(${target_name} PRIVATE glm::glm gimslib Microsoft.Direct3D.D3D12 Microsoft.Direct3D.DXC d3d12 dxcompiler dxgi.lib dxguid.lib)
-endfunction()
\ No newline at end of file
+endfunction()
+
+# Compiles shader entry points with DXC at build time and embeds the DXIL into the executable, where
+# gims::ShaderLibrary::getEmbedded() finds it. Each entry point has the form
+#   <hlsl file>|<entry point>|<target profile>[|<feature>,<feature>,...]
+# All permutations of the features are compiled, with each feature defined as 0 or 1 like gims::ShaderFeatureSet does.
+function(embed_shaders target_name hlsl_files shader_entry_points)
+    set(DXC "${Microsoft.Direct3D.DXC_DIRECTORY}/build/native/bin/x64/dxc.exe")
+    set(OUTPUT_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}/shaders")
+    set(MANIFEST_FILE "${OUTPUT_DIRECTORY}/${target_name}-shaders.txt")
+    set(GENERATED_SOURCE "${OUTPUT_DIRECTORY}/${target_name}-shaders.cpp")
+    set(EMBED_SHADERS_SCRIPT "${CMAKE_CURRENT_FUNCTION_LIST_DIR}/EmbedShaders.cmake")
+
+    # DXC does not report includes, so every entry point depends on all shaders of the app.
+    set(SHADER_SOURCES "")
+    foreach(HLSL_FILE ${hlsl_files})
+        get_filename_component(HLSL_FILE_ABSOLUTE ${HLSL_FILE} ABSOLUTE)
+        list(APPEND SHADER_SOURCES ${HLSL_FILE_ABSOLUTE})
+    endforeach()
+
+    set(MANIFEST "")
+    set(DXIL_FILES "")
+    foreach(SHADER_ENTRY_POINT ${shader_entry_points})
+        string(REPLACE "|" ";" FIELDS "${SHADER_ENTRY_POINT}")
+        list(GET FIELDS 0 HLSL_FILE)
+        list(GET FIELDS 1 ENTRY_POINT)
+        list(GET FIELDS 2 TARGET_PROFILE)
+        set(FEATURES "")
+        list(LENGTH FIELDS N_FIELDS)
+        if(N_FIELDS GREATER 3)
+            list(GET FIELDS 3 FEATURES)
+            string(REPLACE "," ";" FEATURES "${FEATURES}")
+        endif()
+        get_filename_component(HLSL_FILE_ABSOLUTE ${HLSL_FILE} ABSOLUTE)
+        get_filename_component(SHADER_NAME ${HLSL_FILE} NAME)
+        get_filename_component(SHADER_STEM ${HLSL_FILE} NAME_WE)
+
+        list(LENGTH FEATURES N_FEATURES)
+        math(EXPR LAST_PERMUTATION "(1 << ${N_FEATURES}) - 1")
+        foreach(PERMUTATION RANGE ${LAST_PERMUTATION})
+            set(DEFINE_ARGUMENTS "")
+            set(DEFINES_KEY "")
+            set(FEATURE_INDEX 0)
+            foreach(FEATURE ${FEATURES})
+                math(EXPR VALUE "(${PERMUTATION} >> ${FEATURE_INDEX}) & 1")
+                list(APPEND DEFINE_ARGUMENTS "-D" "${FEATURE}=${VALUE}")
+                if(DEFINES_KEY)
+                    string(APPEND DEFINES_KEY ",")
+                endif()
+                string(APPEND DEFINES_KEY "${FEATURE}=${VALUE}")
+                math(EXPR FEATURE_INDEX "${FEATURE_INDEX} + 1")
+            endforeach()
+
+            set(DXIL_FILE "${OUTPUT_DIRECTORY}/${SHADER_STEM}.${ENTRY_POINT}.${PERMUTATION}.dxil")
+            add_custom_command(
+                OUTPUT ${DXIL_FILE}
+                COMMAND ${CMAKE_COMMAND} -E make_directory ${OUTPUT_DIRECTORY}
+                COMMAND ${DXC} -nologo -T ${TARGET_PROFILE} -E ${ENTRY_POINT} ${DEFINE_ARGUMENTS} -Fo ${DXIL_FILE} ${HLSL_FILE_ABSOLUTE}
+                DEPENDS ${SHADER_SOURCES}
+                COMMENT "Compiling ${SHADER_NAME} ${ENTRY_POINT} ${DEFINES_KEY}"
+                VERBATIM
+            )
+            list(APPEND DXIL_FILES ${DXIL_FILE})
+            string(APPEND MANIFEST "${DXIL_FILE}|${SHADER_NAME}|${ENTRY_POINT}|${TARGET_PROFILE}|${DEFINES_KEY}\n")
+        endforeach()
+    endforeach()
+
+    # Only rewritten when the entry points change, so configuring again does not embed the shaders again.
+    file(GENERATE OUTPUT ${MANIFEST_FILE} CONTENT "${MANIFEST}")
+    add_custom_command(
+        OUTPUT ${GENERATED_SOURCE}
+        COMMAND ${CMAKE_COMMAND} -DMANIFEST_FILE=${MANIFEST_FILE} -DOUTPUT_FILE=${GENERATED_SOURCE} -P ${EMBED_SHADERS_SCRIPT}
+        DEPENDS ${DXIL_FILES} ${MANIFEST_FILE} ${EMBED_SHADERS_SCRIPT}
+        COMMENT "Embedding the shaders of ${target_name}"
+        VERBATIM
+    )
+    source_group("Shaders\\Generated" FILES ${GENERATED_SOURCE})
+    target_sources(${target_name} PRIVATE ${GENERATED_SOURCE})
+endfunction()
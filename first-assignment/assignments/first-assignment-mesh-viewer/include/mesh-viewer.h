@@ -1,8 +1,12 @@
 #pragma once
 #include <gimslib/d3d/DX12App.hpp>
+#include <gimslib/d3d/PipelineStateManager.hpp>
+#include <gimslib/d3d/ShaderPermutations.hpp>
+#include <gimslib/io/CameraPath.hpp>
 #include <gimslib/io/CograBinaryMeshFile.hpp>
 #include <gimslib/types.hpp>
 #include <gimslib/ui/ExaminerController.hpp>
+#include <unordered_map>
 
 using namespace gims;
 
@@ -85,7 +89,6 @@ private:
     f32v4  diffuseColor;
     f32    lightDirectionXCoordinate;
     f32    lightDirectionYCoordinate;
-    ui32v1 flags;
   };
 
   // Stores data related to the UI
@@ -94,6 +97,12 @@ private:
   // Stores controller of the camera
   gims::ExaminerController m_examinerController;
 
+  // Stores whether the camera of each drawn frame is recorded, kept apart from the UI data, which can be reset
+  bool m_cameraPathRecordingEnabled;
+
+  // Stores the camera of each drawn frame while recording, replayed with --benchmark
+  CameraPath m_cameraPath;
+
   // Stores normalization transformation of the mesh loaded
   f32m4 m_meshLoadedNormalizationTransformation;
 
@@ -112,8 +121,14 @@ private:
   // Stores the root signature
   ComPtr<ID3D12RootSignature>              m_rootSignature;
 
-  // Stores state of the pipeline (a. k. a. PSO)
-  std::vector<ComPtr<ID3D12PipelineState>> m_pipelineStates;
+  // Stores the features of the pixel shader permutations
+  ShaderFeatureSet m_pixelShaderFeatures;
+
+  // Creates the pipelines on the threads of the app and keeps them in a pipeline library across runs
+  PipelineStateManager m_pipelineStateManager;
+
+  // Stores the pipeline states (a. k. a. PSOs) requested so far, keyed by rasterizer settings and shader permutation
+  std::unordered_map<ui32, PipelineStateManager::Handle> m_pipelineStates;
 
   // Stores COM pointer for the vertex buffer residing in the GPU memory (VRAM)
   ComPtr<ID3D12Resource>       m_vertexBuffer;
@@ -229,13 +244,34 @@ private:
   void createRootSignature();
 
    /**
-   * Creates a pipeline and assigns it to the member variable responsible for storing the current/active PSO
+   * Requests a pipeline and adds it to the pipeline states requested so far. It is created by the next call of
+   * PipelineStateManager::createPipelines
    *
    * @param [in] backfaceCullingEnabled Specifying whether back-face culling is desired
    * @param [in] wireFrameOverlayEnabled Specifying whether wireframe overlay is desired
+   * @param [in] shaderPermutation Features of the pixel shader, ignored for the wireframe overlay
    * @return void
    */
-  void createPipelineForRenderingMeshes(bool backfaceCullingEnabled = false, bool wireFrameOverlayEnabled = false);
+  void requestPipelineForRenderingMeshes(bool backfaceCullingEnabled = false, bool wireFrameOverlayEnabled = false,
+                                         ui32 shaderPermutation = 0);
+
+   /**
+   * Returns a pipeline, which is created on first use
+   *
+   * @param [in] backfaceCullingEnabled Specifying whether back-face culling is desired
+   * @param [in] wireFrameOverlayEnabled Specifying whether wireframe overlay is desired
+   * @param [in] shaderPermutation Features of the pixel shader, ignored for the wireframe overlay
+   * @return ComPtr<ID3D12PipelineState> The pipeline state
+   */
+  const ComPtr<ID3D12PipelineState>& getPipelineState(bool backfaceCullingEnabled, bool wireFrameOverlayEnabled,
+                                                      ui32 shaderPermutation);
+
+   /**
+   * Derives the pixel shader permutation from the UI settings
+   *
+   * @return ui32 Bit mask of the enabled pixel shader features
+   */
+  ui32 getShaderPermutation() const;
 
    /**
    * Creates a pipeline and assigns it to the member variable responsible for storing the current/active PSO
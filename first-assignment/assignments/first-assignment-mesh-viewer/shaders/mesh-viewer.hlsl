@@ -1,3 +1,15 @@
+// Features of the shader permutations. The application compiles one variant per combination and defines each
+// feature as 0 or 1.
+#ifndef TWO_SIDED_LIGHTING
+#define TWO_SIDED_LIGHTING 0
+#endif
+#ifndef USE_TEXTURE
+#define USE_TEXTURE 0
+#endif
+#ifndef FLAT_SHADING
+#define FLAT_SHADING 0
+#endif
+
 struct VertexShaderOutput
 {
   float4 position : SV_POSITION;
@@ -22,7 +34,6 @@ cbuffer PerFrameConstants : register(b0)
   float4   diffuseColor;
   float    lightDirectionXCoordinate;
   float    lightDirectionYCoordinate;
-  uint1    flags;
 }
 
 Texture2D<float3> g_texture : register(t0);
@@ -42,25 +53,28 @@ VertexShaderOutput VS_main(float3 position : POSITION, float3 normal : NORMAL, f
 float4 PS_main(VertexShaderOutput input)
     : SV_TARGET
 {  
-    bool twoSidedLighting = flags & 0x1;
-    bool useTexture       = flags & 0x2;
-    bool flatShading = flags & 0x4;
-
     float3 lightDirection = float3(lightDirectionXCoordinate, lightDirectionYCoordinate, -1.0f);
 
     float3 l = normalize(lightDirection);
-    float3 n = flatShading ? normalize(cross(ddx(input.viewSpacePosition), ddy(input.viewSpacePosition))) : normalize(input.viewSpaceNormal);
-    if (twoSidedLighting)
-    {
-      n = n.z < 0.0 ? n : -n;
-    }
+#if FLAT_SHADING
+    float3 n = normalize(cross(ddx(input.viewSpacePosition), ddy(input.viewSpacePosition)));
+#else
+    float3 n = normalize(input.viewSpaceNormal);
+#endif
+#if TWO_SIDED_LIGHTING
+    n = n.z < 0.0 ? n : -n;
+#endif
     float3 v = normalize(-input.viewSpacePosition);
     float3 h = normalize(l + v);
 
     float f_diffuse  = max(0.0f, dot(n, l));
     float f_specular = pow(max(0.0f, dot(n, h)), specularColor_and_Exponent.w);
 
-    float3 textureColor = useTexture ? g_texture.Sample(g_sampler, input.texCoord, 0) : float4(1, 1, 1, 0);
+#if USE_TEXTURE
+    float3 textureColor = g_texture.Sample(g_sampler, input.texCoord, 0);
+#else
+    float3 textureColor = float3(1, 1, 1);
+#endif
 
     return float4(ambientColor.xyz + f_diffuse * diffuseColor.xyz * textureColor.xyz +
                       f_specular * specularColor_and_Exponent.xyz,
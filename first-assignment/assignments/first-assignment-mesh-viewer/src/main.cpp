@@ -2,10 +2,11 @@
 #include <gimslib/d3d/DX12Util.hpp>
 #include <gimslib/types.hpp>
 #include <iostream>
+#include <string>
 
 using namespace gims;
 
-int main(int /* argc*/, char /* **argv */)
+int main(int argc, char** argv)
 {
   // Instantiating a configuration for our D3D12-app
   gims::DX12AppConfig config;
@@ -17,6 +18,29 @@ int main(int /* argc*/, char /* **argv */)
   config.debug    = true;
   try
   {
+    // Replaying a camera path recorded with "Record Camera Path", the viewer quits after writing benchmark.json
+    for (int i = 1; i < argc; i++)
+    {
+      const std::string argument = argv[i];
+      if (argument == "--benchmark" && i + 1 < argc)
+      {
+        config.benchmarkCameraPath = argv[++i];
+      }
+      else if (argument == "--frames" && i + 1 < argc)
+      {
+        config.benchmarkFrames = static_cast<ui32>(std::stoul(argv[++i]));
+      }
+      else if (argument == "--warm-up" && i + 1 < argc)
+      {
+        config.benchmarkWarmUpFrames = static_cast<ui32>(std::stoul(argv[++i]));
+      }
+      else
+      {
+        throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                    " [--benchmark <camera path> [--frames <n>] [--warm-up <n>]]");
+      }
+    }
+
     // Instantiating the mesh viewer
     MeshViewer meshViewer(config);
     // Running the mesh viewer
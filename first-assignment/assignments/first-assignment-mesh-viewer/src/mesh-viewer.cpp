@@ -13,9 +13,27 @@
 
 using namespace gims;
 
+namespace
+{
+// Returns the key of a pipeline state. The wireframe overlay has its own pixel shader without features.
+ui32 getPipelineStateKey(bool backfaceCullingEnabled, bool wireFrameOverlayEnabled, ui32 shaderPermutation)
+{
+  const ui32 permutation = wireFrameOverlayEnabled ? 0 : shaderPermutation;
+  return (permutation << 2) | (static_cast<ui32>(wireFrameOverlayEnabled) << 1) |
+         static_cast<ui32>(backfaceCullingEnabled);
+}
+} // namespace
+
 MeshViewer::MeshViewer(const DX12AppConfig config)
     : DX12App(config)
     , m_examinerController(true)
+    , m_cameraPathRecordingEnabled(false)
+    , m_pixelShaderFeatures({L"TWO_SIDED_LIGHTING", L"USE_TEXTURE", L"FLAT_SHADING"})
+    , m_pipelineStateManager(getDevice(),
+                             config.shaderCacheDirectory.empty()
+                                 ? std::filesystem::path()
+                                 : config.shaderCacheDirectory / L"mesh-viewer.psolib",
+                             &getThreadPool())
 {
 
   initializeCameraPosition();
@@ -31,16 +49,28 @@ MeshViewer::MeshViewer(const DX12AppConfig config)
 
   // Creating our pipelines
 
-  // Preparing the vector created to keep track of our pipeline
-  m_pipelineStates.resize(4);
-  // Creating the ordinary graphics pipeline
-  createPipelineForRenderingMeshes(false, false);
-  // Creating the ordinary graphics pipeline with back-face culling
-  createPipelineForRenderingMeshes(true, false);
-  // Creating the wire-frame overlay graphics pipeline
-  createPipelineForRenderingMeshes(false, true);
-  // Creating the wire-frame overlay graphics pipeline with back-face culling
-  createPipelineForRenderingMeshes(true, true);
+  // Creating the pipelines of the default UI settings up front, all other permutations are created on first use
+  // Requesting the ordinary graphics pipeline
+  requestPipelineForRenderingMeshes(false, false);
+  // Requesting the ordinary graphics pipeline with back-face culling
+  requestPipelineForRenderingMeshes(true, false);
+  // Requesting the wire-frame overlay graphics pipeline
+  requestPipelineForRenderingMeshes(false, true);
+  // Requesting the wire-frame overlay graphics pipeline with back-face culling
+  requestPipelineForRenderingMeshes(true, true);
+  // Creating all of them in parallel, or loading them from the pipeline library of an earlier run
+  m_pipelineStateManager.createPipelines();
+  m_pipelineStateManager.storeLibrary();
+
+  // All shaders are built into the executable, unless compileShadersAtRuntime is set for editing them.
+  const auto shaderStatistics = getShaderCompilationStatistics();
+  std::cout << "Shader compilation: " << shaderStatistics.milliseconds << " ms (" << shaderStatistics.nEmbedded
+            << " built in, " << shaderStatistics.nCacheHits << " from cache, " << shaderStatistics.nCacheMisses
+            << " compiled)" << std::endl;
+  const auto pipelineStatistics = m_pipelineStateManager.getStatistics();
+  std::cout << "Pipeline creation: " << pipelineStatistics.milliseconds << " ms (" << pipelineStatistics.nRequests
+            << " requested, " << pipelineStatistics.nPipelines << " unique, " << pipelineStatistics.nLoadedFromLibrary
+            << " from library)" << std::endl;
 
   createConstantBuffers();
 
@@ -85,8 +115,7 @@ void MeshViewer::createRootSignature()
   ComPtr<ID3DBlob> rootBlob, errorBlob;
   D3D12SerializeRootSignature(&rootSignatureDescription, D3D_ROOT_SIGNATURE_VERSION_1, &rootBlob, &errorBlob);
 
-  getDevice()->CreateRootSignature(0, rootBlob->GetBufferPointer(), rootBlob->GetBufferSize(),
-                                   IID_PPV_ARGS(&m_rootSignature));
+  m_rootSignature = m_pipelineStateManager.createRootSignature(rootBlob);
 }
 
 void MeshViewer::printInformationOfMeshToLoad(const CograBinaryMeshFile* meshToLoad)
@@ -103,22 +132,25 @@ void MeshViewer::printInformationOfMeshToLoad(const CograBinaryMeshFile* meshToL
             << std::endl;
 }
 
-void MeshViewer::createPipelineForRenderingMeshes(bool backfaceCullingEnabled, bool wireFrameOverlayEnabled)
+void MeshViewer::requestPipelineForRenderingMeshes(bool backfaceCullingEnabled, bool wireFrameOverlayEnabled,
+                                                   ui32 shaderPermutation)
 {
+  // Each permutation is compiled with its features defined, so the pixel shader does not branch on them
+  const auto defines = m_pixelShaderFeatures.getDefines(wireFrameOverlayEnabled ? 0 : shaderPermutation);
 
   const auto vertexShader =
       wireFrameOverlayEnabled
-          ? compileShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl",
-                          L"VS_WireFrame_main", L"vs_6_0")
-          : compileShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl", L"VS_main",
-                          L"vs_6_0");
+          ? loadShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl",
+                       L"VS_WireFrame_main", L"vs_6_0")
+          : loadShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl", L"VS_main",
+                       L"vs_6_0", defines);
 
   const auto pixelShader =
       wireFrameOverlayEnabled
-          ? compileShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl",
-                          L"PS_WireFrame_main", L"ps_6_0")
-          : compileShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl", L"PS_main",
-                          L"ps_6_0");
+          ? loadShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl",
+                       L"PS_WireFrame_main", L"ps_6_0")
+          : loadShader(L"../../../assignments/first-assignment-mesh-viewer/shaders/mesh-viewer.hlsl", L"PS_main",
+                       L"ps_6_0", defines);
 
   D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
       {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
@@ -130,8 +162,8 @@ void MeshViewer::createPipelineForRenderingMeshes(bool backfaceCullingEnabled, b
   D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDescription = {};
   pipelineStateDescription.InputLayout                        = {inputElementDescs, _countof(inputElementDescs)};
   pipelineStateDescription.pRootSignature                     = m_rootSignature.Get();
-  pipelineStateDescription.VS                                 = HLSLCompiler::convert(vertexShader);
-  pipelineStateDescription.PS                                 = HLSLCompiler::convert(pixelShader);
+  pipelineStateDescription.VS                                 = vertexShader;
+  pipelineStateDescription.PS                                 = pixelShader;
   pipelineStateDescription.RasterizerState                    = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
   pipelineStateDescription.RasterizerState.FillMode =
       wireFrameOverlayEnabled ? D3D12_FILL_MODE_WIREFRAME : D3D12_FILL_MODE_SOLID;
@@ -157,11 +189,41 @@ void MeshViewer::createPipelineForRenderingMeshes(bool backfaceCullingEnabled, b
     pipelineStateDescription.RasterizerState.SlopeScaledDepthBias = -1.0f;
   }
 
-  ComPtr<ID3D12PipelineState> pipeLineStateToCreate;
-  throwIfFailed(
-      getDevice()->CreateGraphicsPipelineState(&pipelineStateDescription, IID_PPV_ARGS(&pipeLineStateToCreate)));
-  m_pipelineStates.at(static_cast<ui8>(backfaceCullingEnabled) | (wireFrameOverlayEnabled << 1)) =
-      pipeLineStateToCreate;
+  m_pipelineStates[getPipelineStateKey(backfaceCullingEnabled, wireFrameOverlayEnabled, shaderPermutation)] =
+      m_pipelineStateManager.requestPipeline(pipelineStateDescription);
+}
+
+const ComPtr<ID3D12PipelineState>& MeshViewer::getPipelineState(bool backfaceCullingEnabled,
+                                                                bool wireFrameOverlayEnabled, ui32 shaderPermutation)
+{
+  const ui32 key = getPipelineStateKey(backfaceCullingEnabled, wireFrameOverlayEnabled, shaderPermutation);
+  if (m_pipelineStates.find(key) == m_pipelineStates.end())
+  {
+    std::cout << "Creating pipeline for the shader permutation "
+              << m_pixelShaderFeatures.getDescription(wireFrameOverlayEnabled ? 0 : shaderPermutation) << std::endl;
+    requestPipelineForRenderingMeshes(backfaceCullingEnabled, wireFrameOverlayEnabled, shaderPermutation);
+    m_pipelineStateManager.createPipelines();
+    m_pipelineStateManager.storeLibrary();
+  }
+  return m_pipelineStateManager.getPipeline(m_pipelineStates.at(key));
+}
+
+ui32 MeshViewer::getShaderPermutation() const
+{
+  ui32 permutation = 0;
+  if (m_uiData.twoSidedLightingEnabled)
+  {
+    permutation |= m_pixelShaderFeatures.getFeatureBit(L"TWO_SIDED_LIGHTING");
+  }
+  if (m_uiData.useTexture)
+  {
+    permutation |= m_pixelShaderFeatures.getFeatureBit(L"USE_TEXTURE");
+  }
+  if (m_uiData.flatShadingEnabled)
+  {
+    permutation |= m_pixelShaderFeatures.getFeatureBit(L"FLAT_SHADING");
+  }
+  return permutation;
 }
 
 void MeshViewer::initializeUIData()
@@ -219,7 +281,8 @@ void MeshViewer::createTriangleMesh()
   m_indexBufferView.SizeInBytes    = static_cast<ui32>(m_indexBufferOnCPUSizeInBytes);
   m_indexBufferView.Format         = DXGI_FORMAT_R32_UINT;
 
-  uploadBuffer.uploadBuffer(m_indexBufferOnCPU.data(), m_indexBuffer, m_indexBufferOnCPUSizeInBytes, getCommandQueue());
+  uploadBuffer.uploadBuffer(m_indexBufferOnCPU.data(), m_indexBuffer, m_indexBufferOnCPUSizeInBytes, getCommandQueue(),
+                            D3D12_RESOURCE_STATE_INDEX_BUFFER);
 }
 
 void MeshViewer::loadMesh(const CograBinaryMeshFile* meshToLoad)
@@ -465,8 +528,6 @@ void MeshViewer::updateConstantBuffers()
       f32v4(m_uiData.specular.x, m_uiData.specular.y, m_uiData.specular.z, m_uiData.exponent);
   currentConstantBufferOnCPU.lightDirectionXCoordinate = f32(m_uiData.lightDirectionXCoordinate);
   currentConstantBufferOnCPU.lightDirectionYCoordinate = f32(m_uiData.lightDirectionYCoordinate);
-  currentConstantBufferOnCPU.flags =
-      ui32v1((m_uiData.flatShadingEnabled << 2) | (m_uiData.useTexture << 1) | int(m_uiData.twoSidedLightingEnabled));
 
   // Actually updating the current constant buffer
   const auto& currentConstantBuffer = m_constantBuffersOnCPU[this->getFrameIndex()];
@@ -478,8 +539,20 @@ void MeshViewer::updateConstantBuffers()
 
 void MeshViewer::onDraw()
 {
+  // Replaying a camera path, each frame gets the camera that was recorded for it
+  const CameraPose* benchmarkCameraPose = getBenchmarkCameraPose();
+  if (benchmarkCameraPose)
+  {
+    m_examinerController.setRotationQuaterion(benchmarkCameraPose->rotation);
+    m_examinerController.setTranslationVector(benchmarkCameraPose->translation);
+  }
+  // Recording the camera the frame is drawn with, before the mouse moves it
+  if (m_cameraPathRecordingEnabled)
+  {
+    m_cameraPath.add({m_examinerController.getRotationQuaterion(), m_examinerController.getTranslationVector()});
+  }
   updateConstantBuffers();
-  if (!ImGui::GetIO().WantCaptureMouse)
+  if (!benchmarkCameraPose && !ImGui::GetIO().WantCaptureMouse)
   {
     bool pressed  = ImGui::IsMouseClicked(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right);
     bool released = ImGui::IsMouseReleased(ImGuiMouseButton_Left) || ImGui::IsMouseReleased(ImGuiMouseButton_Right);
@@ -509,7 +582,8 @@ void MeshViewer::onDraw()
   commandList->RSSetViewports(1, &getViewport());
   commandList->RSSetScissorRects(1, &getRectScissor());
 
-  commandList->SetPipelineState(m_pipelineStates.at(m_uiData.backFaceCullingEnabled).Get());
+  // Two-sided lighting, texturing and flat shading select the shader permutation instead of a per pixel branch
+  commandList->SetPipelineState(getPipelineState(m_uiData.backFaceCullingEnabled, false, getShaderPermutation()).Get());
 
   commandList->SetGraphicsRootSignature(m_rootSignature.Get());
 
@@ -527,9 +601,7 @@ void MeshViewer::onDraw()
 
   if (m_uiData.wireFrameOverlayEnabled)
   {
-    commandList->SetPipelineState(
-        m_pipelineStates.at(static_cast<ui8>(m_uiData.backFaceCullingEnabled) | (m_uiData.wireFrameOverlayEnabled << 1))
-            .Get());
+    commandList->SetPipelineState(getPipelineState(m_uiData.backFaceCullingEnabled, true, 0).Get());
     commandList->SetGraphicsRootSignature(m_rootSignature.Get());
     commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -601,6 +673,28 @@ void MeshViewer::onDrawUI()
   {
     m_uiData.cameraResetButtonClicked = true;
   }
+
+  // Starting a new camera path, or saving it once the recording stops
+  const bool cameraPathRecordingWasEnabled = m_cameraPathRecordingEnabled;
+  ImGui::Checkbox("Record Camera Path", &m_cameraPathRecordingEnabled);
+  ImGui::Text("Recorded Camera Poses: %d", m_cameraPath.getNumberOfPoses());
+  if (m_cameraPathRecordingEnabled && !cameraPathRecordingWasEnabled)
+  {
+    m_cameraPath.clear();
+  }
+  else if (!m_cameraPathRecordingEnabled && cameraPathRecordingWasEnabled && m_cameraPath.getNumberOfPoses() > 0)
+  {
+    const std::filesystem::path cameraPathPath = std::filesystem::absolute("camera-path.txt");
+    try
+    {
+      m_cameraPath.save(cameraPathPath);
+      std::cout << "Wrote camera path to " << cameraPathPath.string() << std::endl;
+    }
+    catch (const std::runtime_error& exceptionThrown)
+    {
+      std::cerr << exceptionThrown.what() << std::endl;
+    }
+  }
   ImGui::End();
 
 }
@@ -13,7 +13,19 @@
 #include <vector>
 #include <wrl.h>
 #include <filesystem>
+#include <functional>
+#include <gimslib/d3d/GpuProfilerD3D12.hpp>
 #include <gimslib/d3d/HLSLCompiler.hpp>
+#include <gimslib/d3d/RenderGraphD3D12.hpp>
+#include <gimslib/io/CameraPath.hpp>
+#include <gimslib/sys/Benchmark.hpp>
+#include <gimslib/sys/CommandListSequence.hpp>
+#include <gimslib/sys/QueueScheduler.hpp>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
 
 
 using Microsoft::WRL::ComPtr;
@@ -26,15 +38,34 @@ struct DX12AppConfig
 #else
 #define TrueIfBuildConfigIsDebug false
 #endif
-  std::wstring      title              = L"Window";                  //! Window title.
-  ui32              width              = 640;                        //! Width of the drawing aera.
-  ui32              height             = 480;                        //! Height of the drawing aera.
-  bool              debug              = TrueIfBuildConfigIsDebug;   //! Create debug context;
-  ui32              frameCount         = 3;                          //! Number of swapchain-frames in flight.
-  D3D_FEATURE_LEVEL d3d_featureLevel   = D3D_FEATURE_LEVEL_11_0;     //! Features for D3D12.
-  DXGI_FORMAT       renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM; //! Format for frames.
-  DXGI_FORMAT       depthBufferFormat  = DXGI_FORMAT_D32_FLOAT;      //! Format for depth buffer.
-  bool              useVSync           = true;                       //! True, to enable vertical synchronization.
+  std::wstring          title                   = L"Window";                  //! Window title.
+  ui32                  width                   = 640;                        //! Width of the drawing aera.
+  ui32                  height                  = 480;                        //! Height of the drawing aera.
+  bool                  debug                   = TrueIfBuildConfigIsDebug;   //! Create debug context;
+  ui32                  frameCount              = 3;                          //! Number of swapchain-frames in flight.
+  D3D_FEATURE_LEVEL     d3d_featureLevel        = D3D_FEATURE_LEVEL_11_0;     //! Features for D3D12.
+  DXGI_FORMAT           renderTargetFormat      = DXGI_FORMAT_R8G8B8A8_UNORM; //! Format for frames.
+  DXGI_FORMAT           depthBufferFormat       = DXGI_FORMAT_D32_FLOAT;      //! Format for depth buffer.
+  bool                  useVSync                = true;                       //! True, to enable vertical synchronization.
+  std::filesystem::path shaderCacheDirectory    = L"shader-cache";            //! Shader cache, empty disables.
+  bool                  compileShadersAtRuntime = false;                      //! Compile, ignoring built-in shaders.
+  bool                  useUpdateThread         = false;                      //! Call onUpdate on its own thread.
+  f32                   updateFrequency         = 120.0f;                     //! onUpdate calls per second on it.
+  ui32                  maxGpuPassesPerFrame    = 64;                         //! Passes measured by beginGpuPass.
+  std::filesystem::path benchmarkCameraPath     = L"";                        //! Camera path to replay, empty disables.
+  ui32                  benchmarkWarmUpFrames   = 100;                        //! Replayed before measuring.
+  ui32                  benchmarkFrames         = 1000;                       //! Measured frames of the replay.
+  std::filesystem::path benchmarkResultPath     = L"benchmark.json";          //! Summary, frame times go to a .csv.
+};
+
+//! \brief A command list with its own allocator, so several threads can record at the same time.
+struct DX12CommandList
+{
+  ComPtr<ID3D12CommandAllocator>     commandAllocator;
+  ComPtr<ID3D12GraphicsCommandList6> commandList;
+
+  void reset(); //! Resets allocator and list. The GPU must have finished the list.
+  void close();
 };
 
 namespace impl
@@ -57,6 +88,12 @@ public:
   virtual void onDrawUI();
   virtual void onResize();
 
+  // Advances the simulation, e.g., the camera, and hands the result to onDraw, e.g., with a TripleBuffer. Called after
+  // onDrawUI on the render thread, or at DX12AppConfig::updateFrequency on an update thread that overlaps with drawing
+  // and presenting if DX12AppConfig::useUpdateThread is set. On the update thread, it must not use ImGui, the command
+  // lists, or anything else of the render thread.
+  virtual void onUpdate();
+
   ui32  getFrameIndex() const;
   f32v2 getNormalizedMouseCoordinates() const;
   ui32  getWidth() const;
@@ -64,6 +101,7 @@ public:
 
   const ComPtr<ID3D12Device2>&              getDevice() const;
   const ComPtr<ID3D12CommandQueue>&        getCommandQueue() const;
+  const ComPtr<ID3D12CommandQueue>&        getComputeQueue() const;
   const ComPtr<ID3D12GraphicsCommandList6>& getCommandList() const;
   const ComPtr<ID3D12CommandAllocator>&    getCommandAllocator() const;
   const ComPtr<ID3D12Resource>&            getRenderTarget() const;
@@ -72,13 +110,56 @@ public:
   CD3DX12_CPU_DESCRIPTOR_HANDLE            getDSVHandle();
   const D3D12_VIEWPORT&                    getViewport() const;
   const D3D12_RECT&                        getRectScissor() const;
+  ThreadPool&                              getThreadPool();
+
+  // Records nChunks command lists on the thread pool and submits them in chunk order, after everything recorded so far.
+  // Each list starts without any state. getCommandList() returns a new list afterwards, do not keep the old one.
+  void recordCommandListsInParallel(
+      ui32 nChunks, const std::function<void(ui32 chunkIdx, const ComPtr<ID3D12GraphicsCommandList6>&)>& record);
+
+  // Records a job for the compute queue, which overlaps with the graphics commands of the frame. The job starts after
+  // the graphics commands recorded so far if waitForGraphics is true, otherwise it only waits for previous frames. All
+  // compute jobs finish before the frame is presented. Resources shared with graphics commands have to be in states
+  // the compute queue supports. Returns the job for waitForComputeJob.
+  ui32 recordComputeJob(const std::function<void(const ComPtr<ID3D12GraphicsCommandList6>&)>& record,
+                        bool waitForGraphics = false);
+
+  // Graphics commands recorded after this call execute after the compute job. getCommandList() returns a new list
+  // afterwards, which starts without any state.
+  void waitForComputeJob(ui32 computeJob);
+
+  // Measures the GPU time of the graphics commands recorded until the matching endGpuPass, which may be in later
+  // command lists of the frame. Passes may be nested. The frame, onDraw and the UI are measured as "Frame", "Draw" and
+  // "UI". Compute jobs are not measured.
+  void beginGpuPass(const std::string& name);
+  void endGpuPass();
+
+  // Returns the GPU times of the passes, read back a few frames after they were recorded.
+  const GpuProfiler& getGpuProfiler() const;
+
+  // Returns the camera of the current frame if DX12AppConfig::benchmarkCameraPath is replayed, nullptr otherwise. The
+  // replay disables VSync and the update thread, measures DX12AppConfig::benchmarkFrames after the warm-up frames,
+  // writes their times to DX12AppConfig::benchmarkResultPath and quits.
+  const CameraPose* getBenchmarkCameraPose() const;
 
   ComPtr<IDxcBlob> compileShader(const std::filesystem::path&            shaderFile,
-                                 const wchar_t* entryPoint, const wchar_t* targetProfile);
+                                 const wchar_t* entryPoint, const wchar_t* targetProfile,
+                                 const std::vector<ShaderDefine>&        defines = {});
+  D3D12_SHADER_BYTECODE loadShader(const std::filesystem::path& shaderFile, const wchar_t* entryPoint,
+                                   const wchar_t* targetProfile, const std::vector<ShaderDefine>& defines = {});
+  ShaderCompilationStatistics getShaderCompilationStatistics() const;
   
   LRESULT windowProcHandler(UINT message, WPARAM wParam, LPARAM lParam);
 
 private:
+  // Command lists of a job of the frame. Graphics jobs are ranges of the command list sequence.
+  struct FrameJobCommandLists
+  {
+    ui32             firstCommandList;
+    ui32             endCommandList;
+    DX12CommandList* computeCommandList;
+  };
+
   struct WindowState
   {
     bool sizemove  = false;
@@ -90,15 +171,42 @@ private:
   HWND                                           m_hwnd;
   ComPtr<IDXGIFactory4>                          m_factory;
   ComPtr<ID3D12Device2>                           m_device;
-  gims::HLSLCompiler                             m_hlslCompiler;
+  std::unique_ptr<gims::HLSLCompiler>            m_hlslCompiler;
+  std::vector<ComPtr<IDxcBlob>>                  m_compiledShaders;
+  ui32                                           m_nEmbeddedShaders;
   ComPtr<ID3D12CommandQueue>                     m_commandQueue;
-  std::vector<ComPtr<ID3D12CommandAllocator>>    m_commandAllocators;
-  std::vector<ComPtr<ID3D12GraphicsCommandList6>> m_commandLists;
+  ComPtr<ID3D12CommandQueue>                     m_computeQueue;
+  std::vector<CommandListSequence<DX12CommandList>> m_commandListSequences;
+  std::vector<std::vector<std::unique_ptr<DX12CommandList>>> m_computeCommandLists; //! Per frame, pooled.
+  ui32                                           m_nUsedComputeCommandLists;
+  std::array<ComPtr<ID3D12Fence>, nQueueTypes>   m_queueFences;
+  QueueScheduler                                 m_queueScheduler;
+  std::vector<QueueJob>                          m_frameJobs;
+  std::vector<FrameJobCommandLists>              m_frameJobCommandLists; //! Per job of the frame.
+  ui32                                           m_currentGraphicsJob;
+  std::vector<RenderGraphD3D12>                  m_renderGraphs;
+  GpuProfilerD3D12                               m_gpuProfiler;
+  ThreadPool                                     m_threadPool;
   std::unique_ptr<impl::ImGUIAdapter>            m_imGUIAdapter;
   std::unique_ptr<impl::SwapChainAdapter>        m_swapChainAdapter;
   WindowState                                    m_windowState;
+  std::thread                                    m_updateThread;
+  std::atomic<bool>                              m_stopUpdateThread;
+  std::atomic<bool>                              m_updateThreadFailed;
+  std::exception_ptr                             m_updateThreadException; //! Set before m_updateThreadFailed.
+  CameraPath                                     m_benchmarkCameraPath;
+  std::unique_ptr<BenchmarkRecorder>             m_benchmark;             //! Only while replaying.
+  std::chrono::steady_clock::time_point          m_frameEndTime;          //! Of the previous frame, after presenting.
 
   void onDrawImpl();
+  void updateLoop();
+  void stopUpdateThread();
+  void startGraphicsJob(const std::vector<ui32>& dependencies);
+  void waitForPendingComputeJobs();
+  void submitFrameJobs();
+  void addBenchmarkGpuTime();
+  void addBenchmarkFrame(std::chrono::steady_clock::time_point frameStartTime,
+                         std::chrono::steady_clock::time_point cpuEndTime);
 };
 
 } // namespace gims
@@ -2,25 +2,51 @@
 #include <d3dx12/d3dx12.h>
 #include <dxcapi.h>
 #include <filesystem>
+#include <gimslib/io/ShaderCache.hpp>
+#include <gimslib/types.hpp>
 #include <wrl.h>
 using Microsoft::WRL::ComPtr;
 
 namespace gims
 {
+//! \brief Time spent in compileShader and how many shaders came from the cache.
+struct ShaderCompilationStatistics
+{
+  ui32 nEmbedded    = 0;   //! Shaders compiled at build time, see ShaderLibrary. Counted by DX12App::loadShader.
+  ui32 nCacheHits   = 0;   //! Shaders loaded from the cache.
+  ui32 nCacheMisses = 0;   //! Shaders compiled by DXC.
+  f64  milliseconds = 0.0; //! Total time spent in compileShader, including hashing and cache access.
+};
+
 class HLSLCompiler
 {
 public:
-  HLSLCompiler();
+  //! \brief Creates the compiler. DXC is only loaded when the first shader is not found in the cache.
+  //! \param cacheDirectory Directory of the on-disk shader cache. An empty path disables the cache.
+  HLSLCompiler(const std::filesystem::path& cacheDirectory = std::filesystem::path());
 
+  //! \brief Compiles a shader. If the cache holds the shader for the same sources, includes, entry point, profile
+  //! and defines, DXC is skipped entirely, neither loaded nor called, and the blob holds the cached bytes.
+  //! \param defines Preprocessor defines, e.g., the features of a shader permutation.
+  //! \throws std::runtime_error If DXC is needed but cannot be loaded.
   ComPtr<IDxcBlob> compileShader(const std::filesystem::path& shaderFile, const wchar_t* targetProfile,
-                                 const wchar_t* entryPoint);
+                                 const wchar_t* entryPoint, const std::vector<ShaderDefine>& defines = {});
+
+  //! \brief Returns the statistics of all compileShader calls so far.
+  const ShaderCompilationStatistics& getStatistics() const;
 
   static D3D12_SHADER_BYTECODE convert(ComPtr<IDxcBlob> in);
 
 
 private:
-  ComPtr<IDxcUtils>          m_utils;
-  ComPtr<IDxcCompiler3>      m_compiler;  
-  ComPtr<IDxcIncludeHandler> m_includeHandler;
+  //! \brief Loads dxcompiler.dll and creates the DXC objects, unless that happened before.
+  void loadCompiler();
+
+  ComPtr<IDxcUtils>           m_utils;
+  ComPtr<IDxcCompiler3>       m_compiler;  
+  ComPtr<IDxcIncludeHandler>  m_includeHandler;
+  ShaderCache                 m_cache;
+  ui64                        m_compilerVersion;
+  ShaderCompilationStatistics m_statistics;
 };
 } // namespace gims
\ No newline at end of file
@@ -13,11 +13,17 @@ public:
   ~UploadHelper();
 
   void uploadBuffer(const void* const src, ComPtr<ID3D12Resource>& dst, size_t size,
-                    const ComPtr<ID3D12CommandQueue>& commandQueue);
+                    const ComPtr<ID3D12CommandQueue>& commandQueue,
+                    D3D12_RESOURCE_STATES targetState = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 
   void uploadTexture(const void* const imageData, ComPtr<ID3D12Resource> texture, i32 textureWidth, i32 textureHeight,
                      const ComPtr<ID3D12CommandQueue>& commandQueue);
 
+  //! \brief Uploads several subresources at once, e.g., the mip levels of a texture, whose data is copied into the
+  //! upload buffer as it is. The upload buffer needs GetRequiredIntermediateSize() of all subresources.
+  void uploadTexture(const D3D12_SUBRESOURCE_DATA* subresources, ui32 nSubresources, ComPtr<ID3D12Resource> texture,
+                     const ComPtr<ID3D12CommandQueue>& commandQueue);
+
   void uploadDefaultBuffer(const void* const src, ComPtr<ID3D12Resource>& dst, size_t size,
                            const ComPtr<ID3D12CommandQueue>& commandQueue);
 
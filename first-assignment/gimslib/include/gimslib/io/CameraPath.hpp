@@ -0,0 +1,44 @@
+#pragma once
+#include <filesystem>
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+//! \brief Camera of a frame, as set by ExaminerController::setRotationQuaterion and setTranslationVector.
+struct CameraPose
+{
+  f32q  rotation;
+  f32v3 translation;
+};
+
+//! \brief Camera poses of consecutive frames, e.g., recorded while the camera is moved with the mouse and replayed to
+//! benchmark the same frames on every run.
+//!
+//! Paths are stored as text with one pose per line, the rotation quaternion w x y z followed by the translation x y z.
+//! The numbers are written with enough digits to be read back exactly.
+class CameraPath
+{
+public:
+  //! \brief Appends the pose of the next frame.
+  void add(const CameraPose& pose);
+
+  //! \brief Removes all poses.
+  void clear();
+
+  ui32 getNumberOfPoses() const;
+
+  //! \brief Returns the pose of a frame. The path starts over after its last pose.
+  //! \throws std::logic_error If the path is empty.
+  const CameraPose& getPose(ui64 frameIdx) const;
+
+  //! \throws std::runtime_error If the file cannot be written.
+  void save(const std::filesystem::path& path) const;
+
+  //! \throws std::runtime_error If the file cannot be read, is malformed, or has no poses.
+  static CameraPath load(const std::filesystem::path& path);
+
+private:
+  std::vector<CameraPose> m_poses;
+};
+} // namespace gims
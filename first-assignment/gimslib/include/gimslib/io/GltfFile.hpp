@@ -0,0 +1,248 @@
+#pragma once
+#include <cstring>
+#include <filesystem>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief Types of the components of glTF accessors, with the values of the file.
+enum class GltfComponentType : ui32
+{
+  Int8   = 5120,
+  UInt8  = 5121,
+  Int16  = 5122,
+  UInt16 = 5123,
+  UInt32 = 5125,
+  Float  = 5126
+};
+
+//! \brief Typed view of the elements of an accessor, which may be interleaved with other attributes.
+//!
+//! Elements are copied out when they are read, so the view has no alignment requirements and points right into the
+//! mapped buffer of the file.
+template <typename T> class GltfAccessorView
+{
+public:
+  GltfAccessorView()
+      : m_data(nullptr)
+      , m_count(0)
+      , m_stride(0)
+  {
+  }
+
+  GltfAccessorView(const ui8* data, ui32 count, ui32 stride)
+      : m_data(data)
+      , m_count(count)
+      , m_stride(stride)
+  {
+  }
+
+  ui32 size() const
+  {
+    return m_count;
+  }
+
+  T operator[](ui32 idx) const
+  {
+    T value;
+    std::memcpy(&value, m_data + static_cast<size_t>(idx) * m_stride, sizeof(T));
+    return value;
+  }
+
+private:
+  const ui8* m_data;
+  ui32       m_count;
+  ui32       m_stride; //! Bytes from one element to the next.
+};
+
+//! \brief Typed array of elements in a buffer view.
+struct GltfAccessor
+{
+  ui32              bufferView;
+  ui32              byteOffset;    //! Relative to the buffer view.
+  GltfComponentType componentType;
+  ui32              nComponents;   //! 1 for SCALAR up to 16 for MAT4.
+  bool              normalized;
+  ui32              count;
+};
+
+//! \brief Triangles of a mesh with one material. Attributes the primitive does not have are GltfFile::invalidIdx.
+struct GltfPrimitive
+{
+  ui32 positions;          //! Accessor of POSITION.
+  ui32 normals;            //! Accessor of NORMAL.
+  ui32 textureCoordinates; //! Accessor of TEXCOORD_0.
+  ui32 tangents;           //! Accessor of TANGENT.
+  ui32 indices;            //! Accessor of the indices, or invalidIdx if the vertices are used in order.
+  ui32 material;
+  ui32 mode;               //! 4 for triangles, 5 for triangle strips, 6 for triangle fans, lower for points and lines.
+};
+
+struct GltfMesh
+{
+  std::string                name;
+  std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfNode
+{
+  std::string       name;
+  f32m4             transformation; //! To the parent node, from the matrix or the translation, rotation, and scale.
+  ui32              mesh;           //! GltfFile::invalidIdx if the node has none.
+  std::vector<ui32> children;
+};
+
+//! \brief Metallic-roughness or specular-glossiness material. Textures are indices of GltfFile::getTextureImagePath, or
+//! invalidIdx.
+struct GltfMaterial
+{
+  std::string name;
+  f32v4       baseColorFactor; //! Or the diffuse factor of KHR_materials_pbrSpecularGlossiness.
+  f32v3       emissiveFactor;
+  f32         metallicFactor;
+  f32         roughnessFactor;
+  bool        specularGlossiness;  //! If the material uses KHR_materials_pbrSpecularGlossiness.
+  f32         glossinessFactor;    //! Of KHR_materials_pbrSpecularGlossiness.
+  bool        hasSpecularColor;    //! If the material uses KHR_materials_specular or specular-glossiness.
+  f32v3       specularColorFactor; //! Of KHR_materials_specular, or the specular factor of specular-glossiness.
+  ui32        baseColorTexture;    //! Or the diffuse texture of specular-glossiness.
+  ui32        metallicRoughnessTexture;
+  ui32        specularGlossinessTexture;
+  ui32        normalTexture;
+  ui32        occlusionTexture;
+  ui32        emissiveTexture;
+};
+
+//! \brief glTF 2.0 file, in the .gltf or the binary .glb format, read without Assimp.
+//!
+//! Buffers in files of their own and the binary chunk of .glb files are mapped into memory, only buffers in data URIs
+//! are decoded. The accessors are views into the mapped buffers, so vertices are converted straight from the file into
+//! their final layout. Sparse accessors are not supported.
+class GltfFile
+{
+public:
+  static const ui32 invalidIdx = ~0u;
+
+  GltfFile();
+
+  //! \throws std::runtime_error If a file cannot be read or is not valid glTF 2.0, or an accessor or a buffer view
+  //! exceeds its buffer.
+  explicit GltfFile(const std::filesystem::path& path);
+
+  //! \brief Returns the nodes without parent of the default scene, or of all nodes if the file has no scenes.
+  const std::vector<ui32>& getRootNodes() const;
+
+  const std::vector<GltfNode>&     getNodes() const;
+  const std::vector<GltfMesh>&     getMeshes() const;
+  const std::vector<GltfMaterial>& getMaterials() const;
+  const std::vector<GltfAccessor>& getAccessors() const;
+
+  //! \brief Returns the material of primitives without a material.
+  static GltfMaterial getDefaultMaterial();
+
+  ui32 getNumberOfTextures() const;
+
+  //! \brief Returns the path of the image of a texture, relative to the directory of the file.
+  //! \throws std::runtime_error If the image is stored in a buffer or a data URI instead of a file of its own.
+  const std::filesystem::path& getTextureImagePath(ui32 textureIdx) const;
+
+  //! \brief Returns a view of an accessor whose components match T, e.g., f32v3 for a VEC3 of floats, or ui16 for a
+  //! SCALAR of unsigned shorts.
+  //! \throws std::runtime_error If the accessor has other components or is not in a buffer view.
+  template <typename T> GltfAccessorView<T> getAccessorView(ui32 accessorIdx) const;
+
+  //! \brief Returns the indices of an accessor of unsigned bytes, shorts, or ints, widened to 32 bits.
+  std::vector<ui32> readIndices(ui32 accessorIdx) const;
+
+private:
+  struct BufferView
+  {
+    ui32 buffer;
+    ui32 byteOffset;
+    ui32 byteLength;
+    ui32 byteStride; //! 0 if the elements are tightly packed.
+  };
+
+  // Checks the accessor and returns its first element and the bytes from one element to the next.
+  const ui8* getAccessorData(ui32 accessorIdx, GltfComponentType componentType, ui32 nComponents,
+                             ui32& stride) const;
+
+  std::vector<MappedFile>            m_mappedFiles;    //! The .glb file or the buffers in files of their own.
+  std::vector<std::vector<ui8>>      m_decodedBuffers; //! Buffers in data URIs.
+  std::vector<const ui8*>            m_bufferData;     //! Per buffer, in m_mappedFiles or m_decodedBuffers.
+  std::vector<size_t>                m_bufferSizes;
+  std::vector<BufferView>            m_bufferViews;
+  std::vector<GltfAccessor>          m_accessors;
+  std::vector<GltfMesh>              m_meshes;
+  std::vector<GltfNode>              m_nodes;
+  std::vector<ui32>                  m_rootNodes;
+  std::vector<GltfMaterial>          m_materials;
+  std::vector<ui32>                  m_textureImages; //! Per texture, its index in m_imagePaths.
+  std::vector<std::filesystem::path> m_imagePaths;    //! Empty for images in buffers or data URIs.
+};
+
+//! \brief Component type and number of components of the accessors that can be viewed as T.
+template <typename T> struct GltfAccessorType;
+
+template <> struct GltfAccessorType<f32>
+{
+  static const GltfComponentType componentType = GltfComponentType::Float;
+  static const ui32              nComponents   = 1;
+};
+
+template <> struct GltfAccessorType<f32v2>
+{
+  static const GltfComponentType componentType = GltfComponentType::Float;
+  static const ui32              nComponents   = 2;
+};
+
+template <> struct GltfAccessorType<f32v3>
+{
+  static const GltfComponentType componentType = GltfComponentType::Float;
+  static const ui32              nComponents   = 3;
+};
+
+template <> struct GltfAccessorType<f32v4>
+{
+  static const GltfComponentType componentType = GltfComponentType::Float;
+  static const ui32              nComponents   = 4;
+};
+
+template <> struct GltfAccessorType<f32m4>
+{
+  static const GltfComponentType componentType = GltfComponentType::Float;
+  static const ui32              nComponents   = 16;
+};
+
+template <> struct GltfAccessorType<ui8>
+{
+  static const GltfComponentType componentType = GltfComponentType::UInt8;
+  static const ui32              nComponents   = 1;
+};
+
+template <> struct GltfAccessorType<ui16>
+{
+  static const GltfComponentType componentType = GltfComponentType::UInt16;
+  static const ui32              nComponents   = 1;
+};
+
+template <> struct GltfAccessorType<ui32>
+{
+  static const GltfComponentType componentType = GltfComponentType::UInt32;
+  static const ui32              nComponents   = 1;
+};
+
+template <typename T> GltfAccessorView<T> GltfFile::getAccessorView(ui32 accessorIdx) const
+{
+  static_assert(sizeof(T) == sizeof(f32) * GltfAccessorType<T>::nComponents ||
+                    GltfAccessorType<T>::componentType != GltfComponentType::Float,
+                "The view has to match the layout of the accessor.");
+  ui32       stride = 0;
+  const ui8* data =
+      getAccessorData(accessorIdx, GltfAccessorType<T>::componentType, GltfAccessorType<T>::nComponents, stride);
+  return GltfAccessorView<T>(data, m_accessors[accessorIdx].count, stride);
+}
+} // namespace gims
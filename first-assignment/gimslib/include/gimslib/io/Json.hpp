@@ -0,0 +1,88 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gims
+{
+//! \brief Value of a JSON document, e.g., of a glTF file or of benchmark results.
+//!
+//! Numbers are stored as f64, which holds every integer of a glTF file exactly. Objects keep their members in the order
+//! of the document, and members are looked up linearly, which is fast for the few members of typical objects.
+class JsonValue
+{
+public:
+  enum class Type
+  {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+  };
+
+  //! \brief Creates null.
+  JsonValue();
+
+  //! \brief Parses a document. Escapes of characters outside the basic multilingual plane are kept as two UTF-8
+  //! encoded surrogates.
+  //! \throws std::runtime_error If the text is not a single JSON value, with the offset of the first error.
+  static JsonValue parse(std::string_view text);
+
+  Type getType() const;
+  bool isNull() const;
+  bool isNumber() const;
+  bool isString() const;
+  bool isArray() const;
+  bool isObject() const;
+
+  //! \throws std::runtime_error If the value has another type, as do the getters below.
+  bool getBool() const;
+
+  f64 getNumber() const;
+
+  //! \brief Returns a number that has to be a non-negative integer, e.g., an index or a count.
+  //! \throws std::runtime_error If the value is not such a number or does not fit into 32 bits.
+  ui32 getIndex() const;
+
+  const std::string& getString() const;
+
+  //! \brief Returns the elements of an array, or the values of the members of an object.
+  const std::vector<JsonValue>& getElements() const;
+
+  //! \brief Returns the names of the members of an object, in the order of getElements().
+  const std::vector<std::string>& getKeys() const;
+
+  //! \brief Returns a member of an object, or nullptr if it has none of that name.
+  //! \throws std::runtime_error If the value is not an object.
+  const JsonValue* find(std::string_view key) const;
+
+  //! \brief Returns a member of an object.
+  //! \throws std::runtime_error If the value is not an object or has no member of that name.
+  const JsonValue& operator[](std::string_view key) const;
+
+  //! \brief Returns an element of an array.
+  //! \throws std::runtime_error If the value is not an array or the index is out of range.
+  const JsonValue& operator[](size_t idx) const;
+
+  //! \brief Returns a member that is a number, or the default if the object does not have it.
+  f64 getNumber(std::string_view key, f64 defaultValue) const;
+
+  //! \brief Returns a member that is an index, or the default if the object does not have it.
+  ui32 getIndex(std::string_view key, ui32 defaultValue) const;
+
+private:
+  friend class JsonParser;
+
+  [[noreturn]] void throwTypeError(const char* expected) const;
+
+  Type                     m_type;
+  bool                     m_bool;
+  f64                      m_number;
+  std::string              m_string;
+  std::vector<JsonValue>   m_elements; //! Of arrays and objects.
+  std::vector<std::string> m_keys;     //! Of objects.
+};
+} // namespace gims
@@ -0,0 +1,104 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gims
+{
+//! \brief Payloads start at multiples of 4 KB, the page size of the mapping and the sector size of most disks, so each
+//! one can be read, mapped, or handed to the GPU without copying or straddling a page it does not use.
+const ui64 packageAlignment = 4096;
+
+//! \brief What the payload of an entry holds. The library only stores the type, its users define the layouts.
+enum class PackageEntryType : ui32
+{
+  Blob       = 0, //! Any data.
+  Mesh       = 1, //! Vertices and indices.
+  Texture    = 2, //! An encoded image, e.g., a PNG, or a DDS or KTX2 file.
+  Materials  = 3, //! Constants and texture indices of materials.
+  SceneGraph = 4  //! Nodes of a scene.
+};
+
+//! \brief Entry of the table of contents of a package.
+struct PackageEntry
+{
+  std::string      name;   //! Unique within the package, e.g., "mesh/3".
+  PackageEntryType type;
+  ui64             offset; //! Of the payload, relative to the start of the file, a multiple of packageAlignment.
+  ui64             size;   //! Of the payload, in bytes.
+  ui64             hash;   //! hashBytes of the payload, e.g., to verify it or to find duplicates without reading it.
+};
+
+//! \brief Writes a package, one entry after the other, so payloads do not have to be kept in memory.
+//!
+//! The file starts with a header, followed by the payloads and the table of contents, each on pages of their own. The
+//! header is written by finish, so a package that was not finished is rejected by PackageFile.
+class PackageWriter
+{
+public:
+  //! \throws std::runtime_error If the file cannot be created.
+  explicit PackageWriter(const std::filesystem::path& path);
+
+  //! \brief Appends an entry, whose payload starts at the next multiple of packageAlignment.
+  //! \throws std::invalid_argument If the name is used already.
+  //! \throws std::logic_error If the package is finished.
+  //! \throws std::runtime_error If the file cannot be written.
+  void add(const std::string& name, PackageEntryType type, const void* data, size_t size);
+
+  //! \brief Writes the table of contents and the header. No entries can be added afterwards.
+  //! \throws std::runtime_error If the file cannot be written.
+  void finish();
+
+  const std::vector<PackageEntry>& getEntries() const;
+
+private:
+  void pad(ui64 alignment);
+
+  std::filesystem::path                 m_path;
+  std::ofstream                         m_stream;
+  std::vector<PackageEntry>             m_entries;
+  std::unordered_map<std::string, ui32> m_nameToEntryIdx;
+  ui64                                  m_size; //! Bytes written so far.
+  bool                                  m_finished;
+};
+
+//! \brief Package written by PackageWriter, mapped into memory as a whole.
+//!
+//! Opening a package maps it, asks the operating system to read all of it ahead in one sequential pass, and parses the
+//! table of contents. Entries are found by their names, their payloads point into the mapping and stay valid until the
+//! object is destroyed.
+class PackageFile
+{
+public:
+  static const ui32 invalidIdx = ~0u; //! Returned by find for entries that do not exist.
+
+  //! \throws std::runtime_error If the file cannot be mapped, is no package, or its table of contents is corrupt.
+  explicit PackageFile(const std::filesystem::path& path);
+
+  const std::vector<PackageEntry>& getEntries() const;
+
+  //! \brief Returns the index of the entry with a name, or invalidIdx.
+  ui32 find(const std::string& name) const;
+
+  //! \brief Returns the payload of an entry.
+  //! \throws std::out_of_range If the entry does not exist.
+  const ui8* getData(ui32 entryIdx) const;
+
+  //! \brief Hashes the payload of an entry and compares it with the hash of the table of contents. This reads the
+  //! whole payload, so it is left to the user, e.g., to the packer or after downloads.
+  //! \throws std::out_of_range If the entry does not exist.
+  bool verify(ui32 entryIdx) const;
+
+private:
+  MappedFile                            m_file;
+  std::vector<PackageEntry>             m_entries;
+  std::unordered_map<std::string, ui32> m_nameToEntryIdx;
+};
+
+//! \brief Returns true for .gpak files, which PackageFile reads.
+bool isPackageFile(const std::filesystem::path& path);
+} // namespace gims
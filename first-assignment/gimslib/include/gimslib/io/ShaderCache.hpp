@@ -0,0 +1,75 @@
+#pragma once
+#include <filesystem>
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief A preprocessor define passed to the shader compiler, i.e., -D name=value.
+struct ShaderDefine
+{
+  std::wstring name;  //! Name of the macro.
+  std::wstring value; //! Value of the macro. May be empty.
+};
+
+//! \brief Compiled shader as stored in the cache.
+struct ShaderCacheEntry
+{
+  std::vector<ui8> object;     //! The DXIL container.
+  std::vector<ui8> reflection; //! The reflection data. May be empty.
+};
+
+//! \brief Returns all files a shader includes, directly or indirectly, sorted and without duplicates.
+//!
+//! Every line of the form #include "file" or #include <file> counts, also those in inactive preprocessor branches.
+//! That may list a few files too many, which is harmless for cache keys. Includes are resolved relative to the
+//! including file first, then relative to the include directories. Includes that cannot be found are skipped.
+//! \param shaderFile The shader source file.
+//! \param includeDirectories Additional directories that are searched for includes.
+std::vector<std::filesystem::path> findShaderIncludes(const std::filesystem::path&              shaderFile,
+                                                      const std::vector<std::filesystem::path>& includeDirectories = {});
+
+//! \brief Content addressed on-disk cache of compiled shaders.
+//!
+//! The key of an entry is a hash over the contents of the shader file and of all its transitive includes, the include
+//! directories, the entry point, the target profile, the defines, and the compiler version. Changing any of them
+//! yields a new key, so entries never have to be invalidated.
+class ShaderCache
+{
+public:
+  //! \brief Creates a disabled cache, which never finds or stores anything.
+  ShaderCache();
+
+  //! \brief Creates a cache that keeps its entries in a directory. The directory is created if necessary.
+  //! \param directory The cache directory. An empty path disables the cache.
+  explicit ShaderCache(const std::filesystem::path& directory);
+
+  //! \brief Returns true, if the cache has a directory.
+  bool isEnabled() const;
+
+  //! \brief Computes the key of a shader. Throws if the shader file cannot be read.
+  //! \param shaderFile The shader source file.
+  //! \param entryPoint Name of the entry function.
+  //! \param targetProfile Shader model, e.g., vs_6_0.
+  //! \param defines Preprocessor defines.
+  //! \param compilerVersion Any value that identifies the compiler build.
+  //! \param includeDirectories The include directories passed to the compiler, see findShaderIncludes.
+  ui64 computeKey(const std::filesystem::path& shaderFile, const std::wstring& entryPoint,
+                  const std::wstring& targetProfile, const std::vector<ShaderDefine>& defines, ui64 compilerVersion,
+                  const std::vector<std::filesystem::path>& includeDirectories = {}) const;
+
+  //! \brief Loads an entry. Returns false, if the cache is disabled, or the entry is missing or damaged, e.g.,
+  //! truncated or with sizes that do not match the file.
+  bool load(ui64 key, ShaderCacheEntry& entry) const;
+
+  //! \brief Stores an entry. Failures only leave the entry out of the cache and return false.
+  bool store(ui64 key, const ShaderCacheEntry& entry) const;
+
+  //! \brief Returns the file of an entry.
+  std::filesystem::path getEntryPath(ui64 key) const;
+
+private:
+  std::filesystem::path m_directory; //! Directory with one file per entry. Empty if disabled.
+};
+} // namespace gims
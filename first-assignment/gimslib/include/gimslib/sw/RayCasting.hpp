@@ -0,0 +1,190 @@
+#pragma once
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <limits>
+#include <vector>
+
+namespace gims
+{
+//! \brief Ray with the parameter range [tMin, tMax]. The direction does not have to be normalized, t is measured in
+//! multiples of it, so t stays the same when a ray is transformed into the space of an instance.
+struct Ray
+{
+  f32v3 origin;
+  f32v3 direction;
+  f32   tMin = 0.0f;
+  f32   tMax = std::numeric_limits<f32>::infinity();
+};
+
+//! \brief Closest intersection of a ray with a mesh or a scene.
+struct RayHit
+{
+  static const ui32 invalidIdx = ~0u;
+
+  f32   t            = std::numeric_limits<f32>::infinity(); //! Ray parameter of the hit.
+  ui32  triangleIdx  = invalidIdx; //! Triangle of the mesh, invalidIdx if nothing was hit.
+  ui32  instanceIdx  = invalidIdx; //! Instance of the RayCastingScene, invalidIdx for a TriangleBvh.
+  f32v2 barycentrics = f32v2(0.0f); //! Weights of the second and third vertex, the first has 1 - x - y.
+
+  bool isHit() const
+  {
+    return triangleIdx != invalidIdx;
+  }
+};
+
+//! \brief Axis-aligned box.
+struct BvhBounds
+{
+  f32v3 lowerLeftBottom;
+  f32v3 upperRightTop;
+};
+
+//! \brief Node of a bounding volume hierarchy, 32 bytes, so two nodes share a cache line.
+//!
+//! The nodes are stored depth first, the first child of an inner node directly follows it.
+struct BvhNode
+{
+  f32v3 lowerLeftBottom;
+  ui32  offset; //! Inner nodes: index of the second child. Leaves: index of the first primitive.
+  f32v3 upperRightTop;
+  ui32  count;  //! Number of primitives of a leaf, 0 for inner nodes.
+
+  bool isLeaf() const
+  {
+    return count != 0;
+  }
+};
+
+//! \brief Triangles to build a TriangleBvh from, e.g., of a vertex array whose vertices start with the position.
+struct TriangleBvhGeometry
+{
+  const f32v3* positions;      //! Position of the first vertex.
+  ui32         nVertices;
+  ui32         positionStride; //! Bytes from one position to the next, e.g., sizeof(Vertex).
+  const ui32*  indices;        //! Three per triangle.
+  ui32         nTriangles;
+};
+
+//! \brief Bounding volume hierarchy of the triangles of a mesh, for picking and for rendering with rays.
+//!
+//! The hierarchy is built top-down with the surface area heuristic on 16 bins per axis. The upper levels are split
+//! one after the other, with the bins filled in parallel, and the subtrees below are built in parallel and then copied
+//! into one array. The triangles of a leaf are stored in blocks of four, with their vertices and edges per coordinate,
+//! so a ray is intersected with four triangles at once with SSE2, or with plain loops on other CPUs. The heuristic
+//! counts blocks instead of triangles, so leaves tend to fill their blocks.
+class TriangleBvh
+{
+public:
+  //! \brief Largest number of triangles of a leaf, unless the triangles cannot be separated.
+  static const ui32 maxLeafSize = 8;
+
+  //! \brief Largest depth of the hierarchy, the traversal keeps a stack of this size.
+  static const ui32 maxDepth = 64;
+
+  //! \brief Creates an empty hierarchy, which no ray hits.
+  TriangleBvh();
+
+  //! \brief Builds the hierarchy. The geometry is copied and not needed afterwards.
+  //! \param threadPool Threads that build the hierarchy, or nullptr to build it on the calling thread, e.g., when
+  //!                   several meshes are built in parallel.
+  //! \throws std::invalid_argument If an index refers to a vertex the geometry does not have.
+  explicit TriangleBvh(const TriangleBvhGeometry& geometry, ThreadPool* threadPool = nullptr);
+
+  //! \brief Finds the closest hit with a parameter in [ray.tMin, min(ray.tMax, hit.t)).
+  //! \return True if the hit was updated, then hit.t, hit.triangleIdx and hit.barycentrics are set.
+  bool intersect(const Ray& ray, RayHit& hit) const;
+
+  //! \brief Returns true if any triangle is hit in [ray.tMin, ray.tMax), e.g., for shadow rays.
+  bool isOccluded(const Ray& ray) const;
+
+  //! \brief Returns the bounds of all triangles, or an empty box at the origin if there are none.
+  BvhBounds getBounds() const;
+
+  ui32 getNumberOfTriangles() const;
+
+  const std::vector<BvhNode>& getNodes() const;
+
+  //! \brief Returns the expected cost of a ray relative to testing one node, by the surface area heuristic.
+  f32 getSahCost() const;
+
+private:
+  // Four triangles, with the first vertex and the two edges leaving it per coordinate and lane.
+  struct alignas(16) TriangleBlock
+  {
+    f32  v0[3][4];
+    f32  edge1[3][4];
+    f32  edge2[3][4];
+    ui32 triangleIndices[4]; //! RayHit::invalidIdx for unused lanes.
+  };
+
+  // Returns the triangle of the closest hit in [tMin, tMax) and lowers tMax to it, or RayHit::invalidIdx.
+  static ui32 intersectBlock(const TriangleBlock& block, const Ray& ray, f32& tMax, f32v2& barycentrics);
+
+  std::vector<BvhNode>       m_nodes; //! Leaves refer to m_blocks.
+  std::vector<TriangleBlock> m_blocks;
+  ui32                       m_nTriangles;
+};
+
+//! \brief Occurrence of a mesh in a scene.
+struct RayCastingInstance
+{
+  ui32  meshIdx;
+  f32m4 transformation; //! From the space of the mesh to the space of the scene.
+};
+
+//! \brief Meshes with a hierarchy each, and their instances with a hierarchy of the instance bounds on top.
+//!
+//! Rays in the space of the scene are transformed into the space of each instance they reach, so the triangles are
+//! stored once per mesh, however often the scene graph refers to it. The instances can be replaced every frame, the
+//! hierarchy of the instances is cheap to build compared to the meshes.
+class RayCastingScene
+{
+public:
+  //! \brief Creates a scene without meshes and instances.
+  RayCastingScene();
+
+  //! \brief Takes over the hierarchies of the meshes, see createTriangleBvhs.
+  explicit RayCastingScene(std::vector<TriangleBvh> meshes);
+
+  //! \brief Replaces the instances and builds the hierarchy of their bounds.
+  //! \throws std::out_of_range If an instance refers to a mesh the scene does not have.
+  void setInstances(const std::vector<RayCastingInstance>& instances);
+
+  //! \brief Finds the closest hit like TriangleBvh::intersect, and sets hit.instanceIdx as well.
+  bool intersect(const Ray& ray, RayHit& hit) const;
+
+  //! \brief Returns true if any instance is hit in [ray.tMin, ray.tMax).
+  bool isOccluded(const Ray& ray) const;
+
+  ui32               getNumberOfMeshes() const;
+  const TriangleBvh& getMesh(ui32 meshIdx) const;
+
+  ui32                      getNumberOfInstances() const;
+  const RayCastingInstance& getInstance(ui32 instanceIdx) const;
+
+private:
+  // An instance, with the transformation of rays into the space of its mesh.
+  struct Instance
+  {
+    f32m4 sceneToMesh;
+    ui32  meshIdx;
+    ui32  instanceIdx; //! In the order of setInstances, as reported by RayHit::instanceIdx.
+  };
+
+  std::vector<TriangleBvh>        m_meshes;
+  std::vector<RayCastingInstance> m_instances;
+  std::vector<BvhNode>            m_nodes;           //! Leaves refer to m_sortedInstances.
+  std::vector<Instance>           m_sortedInstances; //! In the order of the leaves.
+};
+
+//! \brief Builds the hierarchies of several meshes. Meshes with many triangles are built one after the other, each on
+//! all threads, the others are built in parallel, one per thread.
+std::vector<TriangleBvh> createTriangleBvhs(const std::vector<TriangleBvhGeometry>& meshes, ThreadPool& threadPool);
+
+//! \brief Returns the ray from the near to the far plane through a point on the screen, e.g., under the cursor. t is
+//! 0 on the near plane and 1 on the far plane.
+//! \param inverseViewProjection Inverse of the transformation from the space of the ray to clip space, with a depth
+//!                              range of [0, 1]. It is passed inverted, so rays of many pixels share the inversion.
+//! \param normalizedCoordinates Position on the screen, from -1 to 1, with y pointing up.
+Ray createCameraRay(const f32m4& inverseViewProjection, const f32v2& normalizedCoordinates);
+} // namespace gims
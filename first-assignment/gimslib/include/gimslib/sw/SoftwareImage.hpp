@@ -0,0 +1,43 @@
+#pragma once
+#include <filesystem>
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+//! \brief RGBA8 image, e.g., a frame of the SoftwareRasterizer or a capture of a viewer.
+struct SoftwareImage
+{
+  ui32               width;
+  ui32               height;
+  std::vector<ui8v4> pixels; //! Row by row, starting at the top.
+};
+
+//! \brief Differences of two images of the same size, per color channel.
+struct SoftwareImageDifference
+{
+  f64  meanError;              //! Mean absolute difference of the RGB channels, from 0 to 255.
+  ui32 maxError;               //! Largest absolute difference of a channel.
+  ui64 nPixelsAboveTolerance;  //! Pixels with a channel that differs by more than the tolerance.
+  f64  fractionAboveTolerance; //! nPixelsAboveTolerance divided by the number of pixels.
+};
+
+//! \brief Loads a PNG, JPEG, or any other file stb_image reads, converted to RGBA8.
+//! \throws std::runtime_error If the file cannot be read.
+SoftwareImage loadSoftwareImage(const std::filesystem::path& path);
+
+//! \brief Decodes a file in memory, e.g., a texture inside a package, like loadSoftwareImage.
+//! \throws std::runtime_error If the data cannot be decoded.
+SoftwareImage loadSoftwareImage(const ui8* data, size_t size);
+
+//! \brief Saves the image as PNG. The image data is stored without compression, so no further library is needed.
+//! \throws std::invalid_argument If the number of pixels does not match the size.
+//! \throws std::runtime_error If the file cannot be written.
+void saveSoftwareImage(const std::filesystem::path& path, const SoftwareImage& image);
+
+//! \brief Compares the RGB channels of two images, alpha is ignored.
+//! \param tolerance Largest difference of a channel that is not counted, e.g., for the rounding of other GPUs.
+//! \throws std::invalid_argument If the images differ in size.
+SoftwareImageDifference compareSoftwareImages(const SoftwareImage& image, const SoftwareImage& reference,
+                                              ui32 tolerance);
+} // namespace gims
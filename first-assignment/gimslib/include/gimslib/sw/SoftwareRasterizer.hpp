@@ -0,0 +1,198 @@
+#pragma once
+#include <array>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+class CograBinaryMeshFile;
+
+//! \brief Vertex of a software mesh, the attributes the shaders of the viewers read.
+struct SoftwareVertex
+{
+  f32v3 position;
+  f32v3 normal;
+  f32v2 textureCoordinate;
+};
+
+//! \brief Indexed triangle list with one material.
+struct SoftwareMesh
+{
+  std::vector<SoftwareVertex> vertices;
+  std::vector<ui32>           indices;     //! Three per triangle.
+  ui32                        materialIdx; //! Index in SoftwareScene::materials.
+};
+
+//! \brief RGBA8 texture, sampled like the viewers do, with point filtering and wrapping.
+struct SoftwareTexture
+{
+  ui32               width;
+  ui32               height;
+  std::vector<ui8v4> texels; //! Row by row, starting at texture coordinate v = 0.
+  bool               srgb;   //! True, if the texels are converted to linear colors when sampled, as for an SRGB view.
+};
+
+//! \brief Texture slots of a material, in the order of the registers of TriangleMesh.hlsl.
+enum class SoftwareTextureSlot : ui32
+{
+  Ambient,
+  Diffuse,
+  Specular,
+  Emissive
+};
+
+//! \brief Constants and textures of a material, like an entry of the material table of TriangleMesh.hlsl.
+struct SoftwareMaterial
+{
+  f32v4               emissive;
+  f32v4               ambient;
+  f32v4               diffuse;
+  f32v4               specularColorAndExponent; //! xyz: Specular Color, w: Specular Exponent.
+  std::array<ui32, 4> textureIndices;           //! Per SoftwareTextureSlot, the index in SoftwareScene::textures.
+};
+
+//! \brief Everything a draw call can refer to.
+struct SoftwareScene
+{
+  std::vector<SoftwareMesh>     meshes;
+  std::vector<SoftwareMaterial> materials;
+  std::vector<SoftwareTexture>  textures;
+};
+
+//! \brief Draws a mesh of the scene.
+struct SoftwareDrawCall
+{
+  ui32  meshIdx;
+  f32m4 modelView; //! Transformation from mesh to view space.
+};
+
+//! \brief Constants of a frame, the per frame constants of the shaders and the state of the pipeline.
+struct SoftwareFrameConstants
+{
+  f32m4 projection;                //! From view to clip space, with a depth range of [0, 1] as in D3D12.
+  f32v3 backgroundColor;
+  f32v2 lightDirectionXY;          //! The light direction is (x, y, -1) in view space.
+  f32   lightIntensity   = 1.0f;
+  bool  cullBackFaces    = false;  //! Front faces are clockwise on the screen, as in D3D12.
+  bool  twoSidedLighting = false;  //! Normals are turned towards the camera, TWO_SIDED_LIGHTING of mesh-viewer.hlsl.
+  bool  flatShading      = false;  //! Normals of the triangles instead of the vertices, FLAT_SHADING.
+};
+
+//! \brief Work and times of the last frame.
+struct SoftwareRasterizerStatistics
+{
+  ui64 nTriangles;             //! Of all draw calls.
+  ui64 nRasterizedTriangles;   //! That were binned, after culling and clipping.
+  ui64 nShadedPixels;          //! Covered pixels, each is shaded once.
+  f64  vertexMilliseconds;     //! Transforming the vertices.
+  f64  binningMilliseconds;    //! Setting up, clipping and binning the triangles.
+  f64  rasterMilliseconds;     //! Rasterizing and shading the tiles.
+  f64  totalMilliseconds;
+};
+
+//! \brief Renders a scene on the CPU like the viewers' pipelines do, e.g., on machines without GPU.
+//!
+//! A frame runs in three parallel phases on the thread pool: the vertices of each draw call are transformed, the
+//! triangles are set up, clipped at the near plane and sorted into screen tiles by chunks of triangles, and each tile
+//! is rasterized by one task. The edge functions are evaluated for four pixels at once with SSE2, or with plain loops
+//! on other CPUs, and use fixed-point positions with the top-left rule of D3D12, so adjacent triangles leave no gaps.
+//! A tile first only keeps the closest triangle of each pixel and then shades the pixels, so every pixel is shaded
+//! once. Bins are filled per chunk and read in chunk order, so the result does not depend on the number of threads.
+class SoftwareRasterizer
+{
+public:
+  //! \brief Width and height of the screen tiles, in pixels.
+  static const ui32 tileSize = 64;
+
+  //! \brief Largest width and height, so the fixed-point edge functions cannot overflow.
+  static const ui32 maxSize = 8192;
+
+  //! \param threadPool Threads that render, it has to outlive the rasterizer.
+  //! \throws std::invalid_argument If width or height is 0 or larger than maxSize.
+  SoftwareRasterizer(ui32 width, ui32 height, ThreadPool& threadPool);
+
+  //! \brief Renders the draw calls into the color and depth buffer, which are cleared before.
+  //! \throws std::out_of_range If a draw call, mesh or material refers to something the scene does not have.
+  void draw(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+            const SoftwareFrameConstants& constants);
+
+  ui32 getWidth() const;
+  ui32 getHeight() const;
+
+  //! \brief Returns the colors of the last frame, row by row from the top, with an alpha of 255.
+  const std::vector<ui8v4>& getColors() const;
+
+  //! \brief Returns the depths of the last frame, 1 where nothing was drawn.
+  const std::vector<f32>& getDepths() const;
+
+  const SoftwareRasterizerStatistics& getStatistics() const;
+
+private:
+  struct TransformedVertex
+  {
+    f32v4 clipPosition;
+    f32v3 viewPosition;
+    f32v3 viewNormal;
+    f32v2 textureCoordinate;
+  };
+
+  // A triangle in screen space, with the edge functions and the attributes the tiles need.
+  struct Triangle
+  {
+    i32               x[3];        //! Fixed-point screen positions, see subpixelBits in the source.
+    i32               y[3];
+    i32               minX;        //! Bounding box in pixels, inclusive and clamped to the screen.
+    i32               minY;
+    i32               maxX;
+    i32               maxY;
+    i32               bias[3];     //! -1 for edges that are not top or left, so pixels on them are not covered.
+    f32               z[3];        //! Depths of the vertices.
+    f32               invW[3];     //! 1 / w of the vertices, for perspective correct attributes.
+    f32               invArea;     //! 1 / the sum of the edge functions.
+    TransformedVertex vertices[3]; //! Edge i is opposite of vertex i.
+    f32v3             faceNormal;  //! In view space, towards the camera.
+    ui32              materialIdx;
+  };
+
+  void transformVertices(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+                         const f32m4& projection, ui32 taskIdx);
+  void binTriangles(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+                    const SoftwareFrameConstants& constants, ui64 trianglesPerChunk, ui32 chunkIdx);
+  void renderTile(const SoftwareScene& scene, const SoftwareFrameConstants& constants, ui32 tileIdx,
+                  ui64& nShadedPixels);
+  void addTriangle(const TransformedVertex& v0, const TransformedVertex& v1, const TransformedVertex& v2,
+                   ui32 materialIdx, const SoftwareFrameConstants& constants, ui32 chunkIdx);
+  void setupTriangle(const TransformedVertex& v0, const TransformedVertex& v1, const TransformedVertex& v2,
+                     const f32v3& faceNormal, ui32 materialIdx, const SoftwareFrameConstants& constants,
+                     ui32 chunkIdx);
+
+  ui32                         m_width;
+  ui32                         m_height;
+  f32v2                        m_guardBand; //! Clip space extent of the area in which triangles are not clipped.
+  ui32                         m_nTilesX;
+  ui32                         m_nTilesY;
+  ThreadPool&                  m_threadPool;
+  std::vector<ui8v4>           m_colors;
+  std::vector<f32>             m_depths;
+  SoftwareRasterizerStatistics m_statistics;
+
+  std::vector<ui64>                           m_vertexOffsets;       //! Per draw call, its first vertex of all.
+  std::vector<ui64>                           m_triangleOffsets;     //! Per draw call, its first triangle of all.
+  std::vector<std::vector<TransformedVertex>> m_transformedVertices; //! Per draw call.
+  std::vector<std::vector<Triangle>>          m_triangles;           //! Per chunk, the triangles that were set up.
+  std::vector<std::vector<std::vector<ui32>>> m_bins;                //! Per chunk and tile, indices in m_triangles.
+};
+
+//! \brief Shades a point of a surface like the pixel shaders of the viewers, e.g., for renderers that find the surfaces
+//! with rays. Positions and normals are in view space.
+//! \param faceNormal Normal of the triangle, towards the camera, for flat shading.
+//! \return The color, converted to UNORM as the render target does.
+ui8v4 shadeSoftwareSurface(const SoftwareScene& scene, const SoftwareMaterial& material,
+                           const SoftwareFrameConstants& constants, const f32v3& viewPosition,
+                           const f32v3& viewNormal, const f32v2& textureCoordinate, const f32v3& faceNormal);
+
+//! \brief Converts a mesh file with normals in attribute 0 and texture coordinates in attribute 1, as the mesh viewer
+//! reads them. Attributes the file does not have are 0.
+SoftwareMesh createSoftwareMesh(const CograBinaryMeshFile& meshFile, ui32 materialIdx);
+} // namespace gims
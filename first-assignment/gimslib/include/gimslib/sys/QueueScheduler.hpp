@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <gimslib/types.hpp>
+#include <map>
+#include <vector>
+
+namespace gims
+{
+//! \brief Queue a job is submitted to.
+enum class QueueType
+{
+  Graphics,
+  Compute
+};
+
+//! \brief Number of values of QueueType.
+const ui32 nQueueTypes = 2;
+
+//! \brief Work for one queue, e.g., the command lists recorded between two synchronization points.
+struct QueueJob
+{
+  QueueType         queue;        //! Queue that executes the job.
+  std::vector<ui32> dependencies; //! Earlier jobs that have to finish before the job starts.
+};
+
+//! \brief Waits until the fence of a queue reaches a value.
+struct QueueWait
+{
+  QueueType queue;      //! Queue whose fence is waited for.
+  ui64      fenceValue; //! Value the fence has to reach.
+};
+
+//! \brief Submission of a job with the fence operations around it.
+struct QueueSubmission
+{
+  ui32                   jobIdx;      //! Index of the job.
+  QueueType              queue;       //! Queue that executes the job.
+  std::vector<QueueWait> waits;       //! Recorded on the queue before the job.
+  ui64                   signalValue; //! Signaled on the fence of the queue after the job, 0 if nobody waits.
+};
+
+//! \brief Derives the fence waits and signals that let jobs on several queues overlap as much as their dependencies
+//! allow.
+//!
+//! Each queue has a fence whose value grows with every signal. Jobs of the same queue execute in order, so only
+//! dependencies on other queues need fences, and a wait that an earlier wait of the queue already covers is omitted.
+//! The first job of a queue in a schedule waits for all work the other queues were given by the previous schedules,
+//! so the jobs of a frame overlap each other but not the frames before, which may still use the same resources.
+class QueueScheduler
+{
+public:
+  QueueScheduler();
+
+  //! \brief Schedules the jobs of a frame.
+  //! \param jobs Jobs in submission order.
+  //! \return One submission per job, in the order of the jobs.
+  //! \throws std::invalid_argument If a job depends on itself or a later job.
+  std::vector<QueueSubmission> schedule(const std::vector<QueueJob>& jobs);
+
+  //! \brief Returns the next value of the fence of a queue for a signal outside of the schedules, e.g., to wait on the
+  //! CPU until the queue is idle. The next schedule waits for it like for the jobs of the previous schedules.
+  ui64 reserveSignalValue(QueueType queue);
+
+  //! \brief Returns the last value signaled on the fence of a queue, 0 if none was.
+  ui64 getLastSignaledValue(QueueType queue) const;
+
+private:
+  std::array<ui64, nQueueTypes>                          m_lastSignaledValues; //! Per queue.
+  std::array<std::array<ui64, nQueueTypes>, nQueueTypes> m_waitedValues;       //! Per queue, per awaited queue.
+};
+
+//! \brief Simulates the execution of submissions on the GPU, to check the overlap of a schedule without a GPU.
+class QueueTimelineSimulator
+{
+public:
+  //! \brief When a job was executed.
+  struct JobTiming
+  {
+    f64 start;
+    f64 end;
+  };
+
+  QueueTimelineSimulator();
+
+  //! \brief Executes submissions after all submissions of previous calls.
+  //! \param jobDurations Per job of the schedule.
+  //! \return Per job of the schedule.
+  //! \throws std::logic_error If a submission waits for a value that is never signaled.
+  std::vector<JobTiming> simulate(const std::vector<QueueSubmission>& submissions,
+                                  const std::vector<f64>&             jobDurations);
+
+  //! \brief Returns the time at which a queue has finished all simulated work.
+  f64 getQueueTime(QueueType queue) const;
+
+private:
+  std::array<f64, nQueueTypes>                 m_queueTimes;  //! Per queue.
+  std::array<std::map<ui64, f64>, nQueueTypes> m_signalTimes; //! Per queue, the time of each signaled value.
+};
+} // namespace gims
@@ -0,0 +1,143 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief Resource states with the bits of D3D12_RESOURCE_STATES, so the graph itself does not depend on D3D12.
+using ResourceStates = ui32;
+
+//! \brief D3D12_RESOURCE_STATE_UNORDERED_ACCESS, which needs UAV barriers between writes.
+const ResourceStates resourceStateUnorderedAccess = 0x8;
+
+//! \brief Index of a resource or pass that does not exist.
+const ui32 renderGraphInvalidIdx = ~0u;
+
+//! \brief How a pass uses a resource.
+struct RenderGraphResourceUsage
+{
+  ui32           resourceIdx; //! Index returned by importResource or createTransientResource.
+  ResourceStates state;       //! State the resource has to be in during the pass.
+};
+
+//! \brief Memory requirements of a transient resource.
+struct TransientResourceDesc
+{
+  ui64 sizeInBytes; //! Size of the resource in the heap.
+  ui64 alignment;   //! Alignment of the resource in the heap.
+};
+
+//! \brief A resource barrier computed by the render graph.
+struct RenderGraphBarrier
+{
+  enum class Type
+  {
+    Transition,      //! Transition of resourceIdx from stateBefore to stateAfter.
+    UnorderedAccess, //! UAV barrier on resourceIdx.
+    Aliasing         //! resourceIdx takes over memory of resourceBeforeIdx, any resource if renderGraphInvalidIdx.
+  };
+  Type           type;
+  ui32           resourceIdx;
+  ui32           resourceBeforeIdx;
+  ResourceStates stateBefore;
+  ResourceStates stateAfter;
+};
+
+//! \brief A pass that is executed, together with the barriers that have to be recorded before it.
+struct RenderGraphStep
+{
+  ui32                            passIdx;   //! Pass to execute, renderGraphInvalidIdx for the final barriers.
+  std::vector<RenderGraphBarrier> barriers;  //! Recorded with a single ResourceBarrier call before the pass.
+  std::vector<ui32>               activated; //! Transient resources used for the first time by the pass.
+};
+
+//! \brief The result of RenderGraph::compile().
+struct CompiledRenderGraph
+{
+  std::vector<RenderGraphStep> steps;         //! Passes that are not culled in order, then the final barriers.
+  std::vector<bool>            passCulled;    //! Per pass, true if nothing that is used depends on it.
+  std::vector<ResourceStates>  initialStates; //! Per resource, transients have to be created in this state.
+  std::vector<ui64>            heapOffsets;   //! Per transient resource, ~0 for unused and imported resources.
+  ui64                         heapSize;      //! Size of the heap all transient resources are placed in.
+  ui64                         transientSize; //! Size the transient resources would need without aliasing.
+  ui32                         nBarriers;     //! Number of barriers of all steps.
+};
+
+//! \brief Passes that declare which resources they read and write, from which the graph derives the barriers.
+//!
+//! compile() culls passes whose results are never used, computes batched barriers with as few transitions as possible
+//! and places transient resources with disjoint lifetimes at the same heap memory. Resources that a pass both reads and
+//! writes must use the same state for both. A pass that keeps the previous contents of a resource, e.g., draws
+//! without clearing a render target first, has to read it as well, otherwise the pass that wrote the contents before
+//! may be culled. RenderGraphD3D12 records the result.
+class RenderGraph
+{
+public:
+  //! \brief Adds a resource that lives outside the graph. Its contents are used after the graph, so the last pass
+  //! that writes it is never culled.
+  //! \param initialState State of the resource before the graph.
+  //! \param finalState State the resource is transitioned to after the last pass.
+  //! \return Index of the resource.
+  ui32 importResource(const std::string& name, ResourceStates initialState, ResourceStates finalState);
+
+  //! \brief Adds a resource that only lives while the graph executes. It may share memory with other transient
+  //! resources, so the first pass that uses it must not depend on its contents.
+  //! \return Index of the resource.
+  ui32 createTransientResource(const std::string& name, const TransientResourceDesc& desc);
+
+  //! \brief Adds a pass. Passes are executed in the order in which they are added.
+  //! \param hasSideEffects True, if the pass must not be culled even if nothing uses its results.
+  //! \return Index of the pass.
+  //! \throws std::invalid_argument If the pass uses an unknown resource, or reads and writes one in different states.
+  ui32 addPass(const std::string& name, const std::vector<RenderGraphResourceUsage>& reads,
+               const std::vector<RenderGraphResourceUsage>& writes, bool hasSideEffects = false);
+
+  //! \brief Computes the order of execution, the barriers and the placement of the transient resources.
+  CompiledRenderGraph compile() const;
+
+  //! \brief Removes all passes and resources.
+  void clear();
+
+  ui32               getNumberOfPasses() const;
+  ui32               getNumberOfResources() const;
+  const std::string& getPassName(ui32 passIdx) const;
+  const std::string& getResourceName(ui32 resourceIdx) const;
+  bool               isTransient(ui32 resourceIdx) const;
+
+private:
+  struct Resource
+  {
+    std::string           name;
+    bool                  transient;
+    ResourceStates        initialState;
+    ResourceStates        finalState;
+    TransientResourceDesc desc;
+  };
+
+  struct Usage
+  {
+    ui32           resourceIdx;
+    ResourceStates state;
+    bool           read;
+    bool           write;
+  };
+
+  struct Pass
+  {
+    std::string        name;
+    std::vector<Usage> usages; //! One per resource.
+    bool               hasSideEffects;
+  };
+
+  std::vector<bool> cullPasses() const;
+
+  // Returns per resource the resources whose memory it takes over.
+  std::vector<std::vector<ui32>> placeTransientResources(const std::vector<ui32>& firstUse,
+                                                         const std::vector<ui32>& lastUse,
+                                                         CompiledRenderGraph&     result) const;
+
+  std::vector<Resource> m_resources; //! Imported and transient resources.
+  std::vector<Pass>     m_passes;    //! Passes in order of execution.
+};
+} // namespace gims
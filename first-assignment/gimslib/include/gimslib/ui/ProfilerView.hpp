@@ -0,0 +1,11 @@
+#pragma once
+#include <gimslib/sys/Profiler.hpp>
+#include <gimslib/types.hpp>
+
+namespace gims
+{
+//! \brief Draws a capture as a timeline into the current ImGui window. Each thread gets a row per zone depth, zones are
+//! colored by their name and show name and duration when hovered.
+//! \param rowHeight Height of a row in pixels.
+void drawProfilerTimeline(const ProfileCapture& capture, f32 rowHeight = 16.0f);
+} // namespace gims
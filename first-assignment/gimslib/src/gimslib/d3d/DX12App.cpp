@@ -5,7 +5,12 @@
 #include <d3dx12/d3dx12.h>
 #include <gimslib/d3d/DX12App.hpp>
 #include <gimslib/d3d/DX12Util.hpp>
+#include <gimslib/d3d/ShaderLibrary.hpp>
 #include <gimslib/dbg/HrException.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <imgui.h>
 #include <iostream>
 #include <string>
@@ -188,41 +193,49 @@ ComPtr<ID3D12Device2> createDevice(bool debug, D3D_FEATURE_LEVEL d3d_featureLeve
   return device;
 }
 
-ComPtr<ID3D12CommandQueue> createCommandQueue(const ComPtr<ID3D12Device>& device)
+ComPtr<ID3D12CommandQueue> createCommandQueue(const ComPtr<ID3D12Device>& device,
+                                              D3D12_COMMAND_LIST_TYPE     type = D3D12_COMMAND_LIST_TYPE_DIRECT)
 {
   ComPtr<ID3D12CommandQueue> result;
 
   D3D12_COMMAND_QUEUE_DESC queueDesc = {};
   queueDesc.Flags                    = D3D12_COMMAND_QUEUE_FLAG_NONE;
-  queueDesc.Type                     = D3D12_COMMAND_LIST_TYPE_DIRECT;
+  queueDesc.Type                     = type;
 
   throwIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&result)));
 
   return result;
 }
 
-std::vector<ComPtr<ID3D12CommandAllocator>> createCommandAllocators(const ComPtr<ID3D12Device>& device,
-                                                                    const ui32                  frameCount)
+std::unique_ptr<DX12CommandList> createCommandList(const ComPtr<ID3D12Device2>& device,
+                                                   D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT)
 {
-  std::vector<ComPtr<ID3D12CommandAllocator>> result(frameCount);
+  auto result = std::make_unique<DX12CommandList>();
+  throwIfFailed(device->CreateCommandAllocator(type, IID_PPV_ARGS(&result->commandAllocator)));
+  throwIfFailed(device->CreateCommandList(0, type, result->commandAllocator.Get(), nullptr,
+                                          IID_PPV_ARGS(&result->commandList)));
+  result->commandList->Close();
+  return result;
+}
+
+std::vector<CommandListSequence<DX12CommandList>> createCommandListSequences(const ComPtr<ID3D12Device2>& device,
+                                                                             const ui32 frameCount)
+{
+  std::vector<CommandListSequence<DX12CommandList>> result;
+  result.reserve(frameCount);
   for (ui32 i = 0; i < frameCount; i++)
   {
-    throwIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&result[i])));
+    result.emplace_back([device]() { return createCommandList(device); });
   }
   return result;
 }
 
-std::vector<ComPtr<ID3D12GraphicsCommandList6>> createCommandLists(
-    const std::vector<ComPtr<ID3D12CommandAllocator>>& commandAllocators)
+std::array<ComPtr<ID3D12Fence>, nQueueTypes> createQueueFences(const ComPtr<ID3D12Device2>& device)
 {
-  std::vector<ComPtr<ID3D12GraphicsCommandList6>> result(commandAllocators.size());
-
-  for (size_t i = 0; i < result.size(); i++)
+  std::array<ComPtr<ID3D12Fence>, nQueueTypes> result;
+  for (auto& fence : result)
   {
-    auto device = DX12Util::getDevice(commandAllocators[i]);
-    throwIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators[i].Get(), nullptr,
-                                            IID_PPV_ARGS(&result[i])));
-    result[i]->Close();
+    throwIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
   }
   return result;
 }
@@ -236,21 +249,52 @@ DX12App::DX12App(const DX12AppConfig config)
     , m_hwnd(createWindow(m_config.title, m_config.width, m_config.height, this))
     , m_factory(createDXGIFactory(m_config.debug))
     , m_device(createDevice(m_config.debug, m_config.d3d_featureLevel, m_factory))
-    , m_hlslCompiler()
     , m_commandQueue(createCommandQueue(m_device))
-    , m_commandAllocators(createCommandAllocators(m_device, m_config.frameCount))
-    , m_commandLists(createCommandLists(m_commandAllocators))
+    , m_computeQueue(createCommandQueue(m_device, D3D12_COMMAND_LIST_TYPE_COMPUTE))
+    , m_commandListSequences(createCommandListSequences(m_device, m_config.frameCount))
+    , m_computeCommandLists(m_config.frameCount)
+    , m_nUsedComputeCommandLists(0)
+    , m_queueFences(createQueueFences(m_device))
+    , m_currentGraphicsJob(0)
+    , m_renderGraphs(m_config.frameCount, RenderGraphD3D12(m_device))
+    , m_gpuProfiler(m_device, m_commandQueue, m_config.frameCount, m_config.maxGpuPassesPerFrame)
     , m_imGUIAdapter(
           std::make_unique<impl::ImGUIAdapter>(m_hwnd, m_device, m_config.frameCount, m_config.renderTargetFormat))
     , m_swapChainAdapter(
           std::make_unique<impl::SwapChainAdapter>(m_hwnd, m_factory, m_commandQueue, m_config.frameCount))
+    , m_nEmbeddedShaders(0)
+    , m_stopUpdateThread(false)
+    , m_updateThreadFailed(false)
 {
+  if (!m_config.benchmarkCameraPath.empty())
+  {
+    // A replay measures how fast the frames can be drawn, so it neither waits for VSync nor runs the camera on its own
+    // thread. The GPU times of a frame arrive after the other frames in flight.
+    m_benchmarkCameraPath    = CameraPath::load(m_config.benchmarkCameraPath);
+    m_benchmark              = std::make_unique<BenchmarkRecorder>(m_config.benchmarkWarmUpFrames,
+                                                                   m_config.benchmarkFrames, m_config.frameCount);
+    m_config.useVSync        = false;
+    m_config.useUpdateThread = false;
+  }
+  m_frameEndTime = std::chrono::steady_clock::now();
 
   ShowWindow(m_hwnd, SW_SHOWNORMAL);
 }
 
 DX12App::~DX12App()
 {
+  stopUpdateThread();
+}
+
+void DX12CommandList::reset()
+{
+  throwIfFailed(commandAllocator->Reset());
+  throwIfFailed(commandList->Reset(commandAllocator.Get(), nullptr));
+}
+
+void DX12CommandList::close()
+{
+  throwIfFailed(commandList->Close());
 }
 
 const DX12AppConfig& DX12App::getDX12AppConfig() const
@@ -260,31 +304,94 @@ const DX12AppConfig& DX12App::getDX12AppConfig() const
 
 i32 DX12App::run()
 {
+  GIMS_PROFILE_THREAD("Render");
+  if (m_config.useUpdateThread)
+  {
+    m_stopUpdateThread = false;
+    m_updateThread     = std::thread(&DX12App::updateLoop, this);
+  }
+
   MSG msg = {};
-  while (true)
+  try
   {
-    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+    while (true)
     {
-      TranslateMessage(&msg);
-      DispatchMessage(&msg);
+      while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+      {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+        if (msg.message == WM_QUIT)
+        {
+          break;
+        }
+      }
       if (msg.message == WM_QUIT)
       {
         break;
       }
+      onDrawImpl();
+      if (m_updateThreadFailed.load(std::memory_order_acquire))
+      {
+        std::rethrow_exception(m_updateThreadException);
+      }
     }
-    if (msg.message == WM_QUIT)
-    {
-      break;
-    }
-    onDrawImpl();
   }
+  catch (...)
+  {
+    // The update thread calls into the derived class, so it has to stop before the exception leaves the app.
+    stopUpdateThread();
+    throw;
+  }
+  stopUpdateThread();
   waitForGPU();
   return static_cast<char>(msg.wParam);
 }
 
+void DX12App::updateLoop()
+{
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<f64>(1.0 / m_config.updateFrequency));
+  auto nextUpdate = std::chrono::steady_clock::now();
+  GIMS_PROFILE_THREAD("Update");
+  try
+  {
+    while (!m_stopUpdateThread.load(std::memory_order_relaxed))
+    {
+      {
+        GIMS_PROFILE_ZONE("Update");
+        onUpdate();
+      }
+      // Updates that take longer than the period delay the next one instead of being caught up with.
+      nextUpdate = std::max(nextUpdate + period, std::chrono::steady_clock::now());
+      std::this_thread::sleep_until(nextUpdate);
+    }
+  }
+  catch (...)
+  {
+    m_updateThreadException = std::current_exception();
+    m_updateThreadFailed.store(true, std::memory_order_release);
+  }
+}
+
+void DX12App::stopUpdateThread()
+{
+  if (m_updateThread.joinable())
+  {
+    m_stopUpdateThread = true;
+    m_updateThread.join();
+  }
+}
+
 void DX12App::waitForGPU()
 {
+  GIMS_PROFILE_ZONE("Wait for GPU");
   m_swapChainAdapter->waitForGPU();
+
+  // The compute queue is not known to the swap chain.
+  auto&      computeFence      = m_queueFences[static_cast<ui32>(QueueType::Compute)];
+  const ui64 computeFenceValue = m_queueScheduler.reserveSignalValue(QueueType::Compute);
+  throwIfFailed(m_computeQueue->Signal(computeFence.Get(), computeFenceValue));
+  DX12Util::waitForFence(computeFence, computeFenceValue);
 }
 
 const ComPtr<ID3D12Device2>& DX12App::getDevice() const
@@ -294,12 +401,220 @@ const ComPtr<ID3D12Device2>& DX12App::getDevice() const
 
 const ComPtr<ID3D12GraphicsCommandList6>& DX12App::getCommandList() const
 {
-  return m_commandLists[m_swapChainAdapter->getFrameIndex()];
+  return m_commandListSequences[m_swapChainAdapter->getFrameIndex()].getCurrent().commandList;
 }
 
 const ComPtr<ID3D12CommandAllocator>& DX12App::getCommandAllocator() const
 {
-  return m_commandAllocators[m_swapChainAdapter->getFrameIndex()];
+  return m_commandListSequences[m_swapChainAdapter->getFrameIndex()].getCurrent().commandAllocator;
+}
+
+ThreadPool& DX12App::getThreadPool()
+{
+  return m_threadPool;
+}
+
+const ComPtr<ID3D12CommandQueue>& DX12App::getComputeQueue() const
+{
+  return m_computeQueue;
+}
+
+void DX12App::recordCommandListsInParallel(
+    ui32 nChunks, const std::function<void(ui32 chunkIdx, const ComPtr<ID3D12GraphicsCommandList6>&)>& record)
+{
+  m_commandListSequences[m_swapChainAdapter->getFrameIndex()].recordParallel(
+      nChunks, &m_threadPool,
+      [&record](ui32 chunkIdx, DX12CommandList& commandList) { record(chunkIdx, commandList.commandList); });
+}
+
+ui32 DX12App::recordComputeJob(const std::function<void(const ComPtr<ID3D12GraphicsCommandList6>&)>& record,
+                               bool waitForGraphics)
+{
+  QueueJob job = {QueueType::Compute, {}};
+  if (waitForGraphics)
+  {
+    job.dependencies.push_back(m_currentGraphicsJob);
+    startGraphicsJob({});
+  }
+
+  auto& computeCommandLists = m_computeCommandLists[m_swapChainAdapter->getFrameIndex()];
+  if (m_nUsedComputeCommandLists == computeCommandLists.size())
+  {
+    computeCommandLists.push_back(createCommandList(m_device, D3D12_COMMAND_LIST_TYPE_COMPUTE));
+  }
+  DX12CommandList& computeCommandList = *computeCommandLists[m_nUsedComputeCommandLists++];
+  computeCommandList.reset();
+  record(computeCommandList.commandList);
+  computeCommandList.close();
+
+  m_frameJobs.push_back(job);
+  m_frameJobCommandLists.push_back({0, 0, &computeCommandList});
+  return static_cast<ui32>(m_frameJobs.size() - 1);
+}
+
+void DX12App::waitForComputeJob(ui32 computeJob)
+{
+  if (computeJob >= m_frameJobs.size() || m_frameJobs[computeJob].queue != QueueType::Compute)
+  {
+    throw std::invalid_argument("Not a compute job of the current frame.");
+  }
+  startGraphicsJob({computeJob});
+}
+
+void DX12App::beginGpuPass(const std::string& name)
+{
+  m_gpuProfiler.beginPass(getCommandList(), name);
+}
+
+void DX12App::endGpuPass()
+{
+  m_gpuProfiler.endPass(getCommandList());
+}
+
+const GpuProfiler& DX12App::getGpuProfiler() const
+{
+  return m_gpuProfiler.getProfiler();
+}
+
+const CameraPose* DX12App::getBenchmarkCameraPose() const
+{
+  if (!m_benchmark)
+  {
+    return nullptr;
+  }
+  return &m_benchmarkCameraPath.getPose(m_benchmark->getFrameIdx());
+}
+
+void DX12App::addBenchmarkGpuTime()
+{
+  const auto& profiler = m_gpuProfiler.getProfiler();
+  if (!m_benchmark || profiler.getNumberOfFrames() == 0)
+  {
+    return;
+  }
+  // The profiler counts the frames from the first one, as the benchmark does. If no frame was read, the last one is
+  // added again, which has no effect.
+  for (const auto& passTiming : profiler.getPassTimings())
+  {
+    if (passTiming.name == "Frame")
+    {
+      m_benchmark->addGpuTime(profiler.getLastReadFrameIdx(), passTiming.milliseconds);
+      break;
+    }
+  }
+}
+
+void DX12App::addBenchmarkFrame(std::chrono::steady_clock::time_point frameStartTime,
+                                std::chrono::steady_clock::time_point cpuEndTime)
+{
+  using milliseconds = std::chrono::duration<f64, std::milli>;
+
+  const auto frameEndTime = std::chrono::steady_clock::now();
+  const auto frameTime    = milliseconds(frameEndTime - m_frameEndTime).count();
+  m_frameEndTime          = frameEndTime;
+  if (!m_benchmark || m_benchmark->isComplete())
+  {
+    return;
+  }
+
+  m_benchmark->addFrame(frameTime, milliseconds(cpuEndTime - frameStartTime).count());
+  if (!m_benchmark->isComplete())
+  {
+    return;
+  }
+  std::filesystem::path csvPath = m_config.benchmarkResultPath;
+  csvPath.replace_extension(".csv");
+  std::ofstream jsonStream(m_config.benchmarkResultPath);
+  std::ofstream csvStream(csvPath);
+  if (!jsonStream || !csvStream)
+  {
+    throw std::runtime_error("Unable to write " + m_config.benchmarkResultPath.string());
+  }
+  m_benchmark->writeJson(jsonStream);
+  m_benchmark->writeCsv(csvStream);
+
+  const auto frameTimes = m_benchmark->getFrameTimeSummary();
+  const auto cpuTimes   = m_benchmark->getCpuTimeSummary();
+  const auto gpuTimes   = m_benchmark->getGpuTimeSummary();
+  std::cout << "Benchmark of " << frameTimes.nSamples << " frames, p50/p95/p99 in ms:\n"
+            << "  Frame: " << frameTimes.p50 << " / " << frameTimes.p95 << " / " << frameTimes.p99 << "\n"
+            << "  CPU:   " << cpuTimes.p50 << " / " << cpuTimes.p95 << " / " << cpuTimes.p99 << "\n"
+            << "  GPU:   " << gpuTimes.p50 << " / " << gpuTimes.p95 << " / " << gpuTimes.p99 << "\n"
+            << "Wrote " << m_config.benchmarkResultPath.string() << " and " << csvPath.string() << std::endl;
+  PostQuitMessage(0);
+}
+
+void DX12App::startGraphicsJob(const std::vector<ui32>& dependencies)
+{
+  const ui32 firstCommandList = m_commandListSequences[m_swapChainAdapter->getFrameIndex()].split();
+  m_frameJobCommandLists[m_currentGraphicsJob].endCommandList = firstCommandList;
+
+  m_frameJobs.push_back({QueueType::Graphics, dependencies});
+  m_frameJobCommandLists.push_back({firstCommandList, 0, nullptr});
+  m_currentGraphicsJob = static_cast<ui32>(m_frameJobs.size() - 1);
+}
+
+void DX12App::waitForPendingComputeJobs()
+{
+  // Compute jobs that a graphics job already waits for are finished before the later graphics jobs, too.
+  std::vector<bool> awaited(m_frameJobs.size(), false);
+  for (const auto& job : m_frameJobs)
+  {
+    if (job.queue == QueueType::Graphics)
+    {
+      for (const ui32 dependency : job.dependencies)
+      {
+        awaited[dependency] = true;
+      }
+    }
+  }
+  std::vector<ui32> pendingComputeJobs;
+  for (ui32 jobIdx = 0; jobIdx < m_frameJobs.size(); jobIdx++)
+  {
+    if (m_frameJobs[jobIdx].queue == QueueType::Compute && !awaited[jobIdx])
+    {
+      pendingComputeJobs.push_back(jobIdx);
+    }
+  }
+  if (!pendingComputeJobs.empty())
+  {
+    startGraphicsJob(pendingComputeJobs);
+  }
+}
+
+void DX12App::submitFrameJobs()
+{
+  GIMS_PROFILE_ZONE("Submit");
+  const auto& commandLists = m_commandListSequences[m_swapChainAdapter->getFrameIndex()].end();
+  m_frameJobCommandLists[m_currentGraphicsJob].endCommandList = static_cast<ui32>(commandLists.size());
+
+  std::vector<ID3D12CommandList*> ppCommandLists;
+  ppCommandLists.reserve(commandLists.size());
+  for (const auto& submission : m_queueScheduler.schedule(m_frameJobs))
+  {
+    const auto& queue = submission.queue == QueueType::Graphics ? m_commandQueue : m_computeQueue;
+    for (const auto& wait : submission.waits)
+    {
+      throwIfFailed(queue->Wait(m_queueFences[static_cast<ui32>(wait.queue)].Get(), wait.fenceValue));
+    }
+
+    const auto& jobCommandLists = m_frameJobCommandLists[submission.jobIdx];
+    ppCommandLists.clear();
+    if (jobCommandLists.computeCommandList)
+    {
+      ppCommandLists.push_back(jobCommandLists.computeCommandList->commandList.Get());
+    }
+    for (ui32 i = jobCommandLists.firstCommandList; i < jobCommandLists.endCommandList; i++)
+    {
+      ppCommandLists.push_back(commandLists[i]->commandList.Get());
+    }
+    queue->ExecuteCommandLists(static_cast<UINT>(ppCommandLists.size()), ppCommandLists.data());
+
+    if (submission.signalValue != 0)
+    {
+      throwIfFailed(queue->Signal(m_queueFences[static_cast<ui32>(submission.queue)].Get(), submission.signalValue));
+    }
+  }
 }
 
 const ComPtr<ID3D12Resource>& DX12App::getRenderTarget() const
@@ -309,7 +624,7 @@ const ComPtr<ID3D12Resource>& DX12App::getRenderTarget() const
 
 const ComPtr<ID3D12Resource>& DX12App::getDepthStencil() const
 {
-  return m_swapChainAdapter->getRenderTarget();
+  return m_swapChainAdapter->getDepthStencil();
 }
 
 CD3DX12_CPU_DESCRIPTOR_HANDLE DX12App::getRTVHandle()
@@ -338,9 +653,39 @@ const D3D12_RECT& DX12App::getRectScissor() const
 }
 
 ComPtr<IDxcBlob> DX12App::compileShader(const std::filesystem::path& shaderFile, const wchar_t* entryPoint,
-                                        const wchar_t* targetProfile)
+                                        const wchar_t* targetProfile, const std::vector<ShaderDefine>& defines)
+{
+  // DXC is only loaded once a shader has to be compiled, apps with all shaders built in never load it.
+  if (!m_hlslCompiler)
+  {
+    m_hlslCompiler = std::make_unique<HLSLCompiler>(m_config.shaderCacheDirectory);
+  }
+  return m_hlslCompiler->compileShader(shaderFile, targetProfile, entryPoint, defines);
+}
+
+D3D12_SHADER_BYTECODE DX12App::loadShader(const std::filesystem::path& shaderFile, const wchar_t* entryPoint,
+                                          const wchar_t* targetProfile, const std::vector<ShaderDefine>& defines)
+{
+  D3D12_SHADER_BYTECODE bytecode = {};
+  if (!m_config.compileShadersAtRuntime &&
+      ShaderLibrary::getEmbedded().find(shaderFile, entryPoint, targetProfile, defines, bytecode))
+  {
+    m_nEmbeddedShaders++;
+    return bytecode;
+  }
+  m_compiledShaders.push_back(compileShader(shaderFile, entryPoint, targetProfile, defines));
+  return HLSLCompiler::convert(m_compiledShaders.back());
+}
+
+ShaderCompilationStatistics DX12App::getShaderCompilationStatistics() const
 {
-  return m_hlslCompiler.compileShader(shaderFile, targetProfile, entryPoint);
+  ShaderCompilationStatistics statistics;
+  if (m_hlslCompiler)
+  {
+    statistics = m_hlslCompiler->getStatistics();
+  }
+  statistics.nEmbedded = m_nEmbeddedShaders;
+  return statistics;
 }
 
 void DX12App::onDraw()
@@ -355,35 +700,78 @@ void DX12App::onResize()
 {
 }
 
-void DX12App::onDrawImpl()
+void DX12App::onUpdate()
 {
-  const auto& commandList      = getCommandList();
-  const auto& commandAllocator = getCommandAllocator();
-  ;
-  throwIfFailed(commandAllocator->Reset());
-  throwIfFailed(commandList->Reset(commandAllocator.Get(), nullptr));
-
-  const auto toBackBuffer = CD3DX12_RESOURCE_BARRIER::Transition(getRenderTarget().Get(), D3D12_RESOURCE_STATE_PRESENT,
-                                                                 D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-  commandList->ResourceBarrier(1, &toBackBuffer);
-
-  m_imGUIAdapter->newFrame();
-  onDrawUI();
-  m_imGUIAdapter->render();
+}
 
-  onDraw();
+void DX12App::onDrawImpl()
+{
+  GIMS_PROFILE_ZONE("Frame");
+  const auto frameStartTime = std::chrono::steady_clock::now();
+  m_commandListSequences[m_swapChainAdapter->getFrameIndex()].begin();
+  m_nUsedComputeCommandLists = 0;
+  m_frameJobs                = {{QueueType::Graphics, {}}};
+  m_frameJobCommandLists     = {{0, 0, nullptr}};
+  m_currentGraphicsJob       = 0;
 
-  m_imGUIAdapter->addToCommadList(getCommandList());
+  // The frame that used the same back buffer before has finished, so its timestamps can be read.
+  m_gpuProfiler.beginFrame(m_swapChainAdapter->getFrameIndex());
+  addBenchmarkGpuTime();
+  beginGpuPass("Frame");
 
-  const auto toPresentBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
-      getRenderTarget().Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-  commandList->ResourceBarrier(1, &toPresentBarrier);
-  throwIfFailed(commandList->Close());
+  {
+    GIMS_PROFILE_ZONE("UI");
+    m_imGUIAdapter->newFrame();
+    onDrawUI();
+    m_imGUIAdapter->render();
+  }
+  if (!m_updateThread.joinable())
+  {
+    GIMS_PROFILE_ZONE("Update");
+    onUpdate();
+  }
 
-  ID3D12CommandList* ppCommandLists[] = {commandList.Get()};
-  getCommandQueue()->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+  // The graph derives the transitions of the back buffer from present to render target and back.
+  auto& renderGraph = m_renderGraphs[m_swapChainAdapter->getFrameIndex()];
+  renderGraph.reset();
+  const ui32 backBuffer  = renderGraph.importResource("Back Buffer", getRenderTarget(), D3D12_RESOURCE_STATE_PRESENT,
+                                                      D3D12_RESOURCE_STATE_PRESENT);
+  const ui32 depthBuffer = renderGraph.importResource("Depth Buffer", getDepthStencil(),
+                                                      D3D12_RESOURCE_STATE_DEPTH_WRITE,
+                                                      D3D12_RESOURCE_STATE_DEPTH_WRITE);
+  renderGraph.addPass("Draw", {},
+                      {{backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET},
+                       {depthBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE}},
+                      [this](const ComPtr<ID3D12GraphicsCommandList6>&)
+                      {
+                        GIMS_PROFILE_ZONE("Draw");
+                        beginGpuPass("Draw");
+                        onDraw();
+                        endGpuPass();
+                      });
+  renderGraph.addPass("UI", {{backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET}},
+                      {{backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET}},
+                      [this](const ComPtr<ID3D12GraphicsCommandList6>&)
+                      {
+                        // The frame is presented after the UI. onDraw may have recorded in parallel, so the back
+                        // buffer is not necessarily bound to the last list of the frame.
+                        GIMS_PROFILE_ZONE("Draw UI");
+                        waitForPendingComputeJobs();
+                        const auto& commandList = getCommandList();
+                        const auto  rtvHandle   = getRTVHandle();
+                        commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+                        beginGpuPass("UI");
+                        m_imGUIAdapter->addToCommadList(commandList);
+                        endGpuPass();
+                      });
+  renderGraph.execute([this]() -> const ComPtr<ID3D12GraphicsCommandList6>& { return getCommandList(); });
+  endGpuPass();
+  m_gpuProfiler.endFrame(getCommandList());
+
+  submitFrameJobs();
+  const auto cpuEndTime = std::chrono::steady_clock::now();
   m_swapChainAdapter->nextFrame(m_config.useVSync);
+  addBenchmarkFrame(frameStartTime, cpuEndTime);
 }
 
 ui32 DX12App::getFrameIndex() const
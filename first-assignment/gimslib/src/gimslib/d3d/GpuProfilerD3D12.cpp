@@ -0,0 +1,91 @@
+#include <d3dx12/d3dx12.h>
+#include <gimslib/d3d/GpuProfilerD3D12.hpp>
+#include <gimslib/dbg/HrException.hpp>
+
+namespace
+{
+using namespace gims;
+
+ui64 getTimestampFrequency(const ComPtr<ID3D12CommandQueue>& queue)
+{
+  ui64 result = 0;
+  throwIfFailed(queue->GetTimestampFrequency(&result));
+  return result;
+}
+} // namespace
+
+namespace gims
+{
+GpuProfilerD3D12::GpuProfilerD3D12(const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& queue,
+                                   ui32 nFrames, ui32 maxPassesPerFrame)
+    : m_profiler(nFrames, maxPassesPerFrame, getTimestampFrequency(queue))
+    , m_frameQueries(nFrames, {0, 0})
+    , m_currentFrameSlot(0)
+{
+  D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+  queryHeapDesc.Type                  = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+  queryHeapDesc.Count                 = m_profiler.getNumberOfQueries();
+  throwIfFailed(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)));
+
+  const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+  const auto bufferDesc     = CD3DX12_RESOURCE_DESC::Buffer(sizeof(ui64) * m_profiler.getNumberOfQueries());
+  throwIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                                D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                IID_PPV_ARGS(&m_readbackBuffer)));
+}
+
+void GpuProfilerD3D12::beginFrame(ui32 frameSlot)
+{
+  if (frameSlot >= m_frameQueries.size() || m_frameQueries[frameSlot].count == 0)
+  {
+    m_profiler.beginFrame(frameSlot, nullptr);
+    m_currentFrameSlot = frameSlot;
+    return;
+  }
+
+  // Only the range of the finished frame is mapped, the GPU may still write the ones of the other frames.
+  const GpuQueryRange queries    = m_frameQueries[frameSlot];
+  const D3D12_RANGE   readRange  = {sizeof(ui64) * queries.first, sizeof(ui64) * (queries.first + queries.count)};
+  const D3D12_RANGE   writeRange = {0, 0};
+  void*               timestamps = nullptr;
+  throwIfFailed(m_readbackBuffer->Map(0, &readRange, &timestamps));
+  m_profiler.beginFrame(frameSlot, static_cast<const ui64*>(timestamps));
+  m_readbackBuffer->Unmap(0, &writeRange);
+  m_frameQueries[frameSlot] = {0, 0};
+  m_currentFrameSlot        = frameSlot;
+}
+
+void GpuProfilerD3D12::beginPass(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const std::string& name)
+{
+  const ui32 query = m_profiler.beginPass(name);
+  if (query != GpuProfiler::invalidQuery)
+  {
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+  }
+}
+
+void GpuProfilerD3D12::endPass(const ComPtr<ID3D12GraphicsCommandList6>& commandList)
+{
+  const ui32 query = m_profiler.endPass();
+  if (query != GpuProfiler::invalidQuery)
+  {
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+  }
+}
+
+void GpuProfilerD3D12::endFrame(const ComPtr<ID3D12GraphicsCommandList6>& commandList)
+{
+  const GpuQueryRange queries = m_profiler.endFrame();
+  if (queries.count > 0)
+  {
+    commandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queries.first, queries.count,
+                                  m_readbackBuffer.Get(), sizeof(ui64) * queries.first);
+  }
+  m_frameQueries[m_currentFrameSlot] = queries;
+}
+
+const GpuProfiler& GpuProfilerD3D12::getProfiler() const
+{
+  return m_profiler;
+}
+} // namespace gims
@@ -3,10 +3,64 @@
 #include <dxgi1_6.h>
 #include <dxgidebug.h>
 #include <gimslib/d3d/HLSLCompiler.hpp>
+#include <chrono>
 #include <gimslib/dbg/HrException.hpp>
+#include <winver.h>
 
 namespace
 {
+using namespace gims;
+
+/// <summary>
+/// Blob with the bytes of a cache entry, so cache hits need no DXC object to return the shader.
+/// </summary>
+class CachedShaderBlob
+    : public Microsoft::WRL::RuntimeClass<Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::ClassicCom>, IDxcBlob>
+{
+public:
+  explicit CachedShaderBlob(std::vector<ui8>&& bytes)
+      : m_bytes(std::move(bytes))
+  {
+  }
+
+  LPVOID STDMETHODCALLTYPE GetBufferPointer() override
+  {
+    return m_bytes.data();
+  }
+
+  SIZE_T STDMETHODCALLTYPE GetBufferSize() override
+  {
+    return m_bytes.size();
+  }
+
+private:
+  std::vector<ui8> m_bytes;
+};
+
+/// <summary>
+/// Identifies the DXC build by the file version of dxcompiler.dll. The version resource is read without loading the
+/// library, and the file is searched like LoadLibraryW does. Returns 0 if the version cannot be read.
+/// </summary>
+ui64 getCompilerVersion()
+{
+  DWORD       handle          = 0;
+  const DWORD versionInfoSize = GetFileVersionInfoSizeW(L"dxcompiler.dll", &handle);
+  if (versionInfoSize == 0)
+  {
+    return 0;
+  }
+  std::vector<ui8>  versionInfo(versionInfoSize);
+  VS_FIXEDFILEINFO* fileInfo     = nullptr;
+  UINT              fileInfoSize = 0;
+  if (!GetFileVersionInfoW(L"dxcompiler.dll", 0, versionInfoSize, versionInfo.data()) ||
+      !VerQueryValueW(versionInfo.data(), L"\\", reinterpret_cast<void**>(&fileInfo), &fileInfoSize) ||
+      fileInfoSize < sizeof(VS_FIXEDFILEINFO))
+  {
+    return 0;
+  }
+  return (static_cast<ui64>(fileInfo->dwFileVersionMS) << 32) | fileInfo->dwFileVersionLS;
+}
+
 std::string wstring_to_string(const std::wstring& wstr)
 {
   std::string str(wstr.size(), '\0');
@@ -17,12 +71,47 @@ std::string wstring_to_string(const std::wstring& wstr)
                  });
   return str;
 }
+
+std::string definesToString(const std::vector<gims::ShaderDefine>& defines)
+{
+  std::string result;
+  for (const auto& define : defines)
+  {
+    result += (result.empty() ? "" : " ") + wstring_to_string(define.name) + "=" + wstring_to_string(define.value);
+  }
+  return result;
+}
+
+std::vector<gims::ui8> toByteVector(const ComPtr<IDxcBlob>& blob)
+{
+  if (blob == nullptr || blob->GetBufferSize() == 0)
+  {
+    return std::vector<gims::ui8>();
+  }
+  const gims::ui8* begin = static_cast<const gims::ui8*>(blob->GetBufferPointer());
+  return std::vector<gims::ui8>(begin, begin + blob->GetBufferSize());
+}
 } // namespace
 
 namespace gims
 {
-HLSLCompiler::HLSLCompiler()
+HLSLCompiler::HLSLCompiler(const std::filesystem::path& cacheDirectory)
+    : m_cache(cacheDirectory)
+    , m_compilerVersion(0)
+{
+  // A different DXC build may produce different code, so its version is part of every cache key.
+  if (m_cache.isEnabled())
+  {
+    m_compilerVersion = getCompilerVersion();
+  }
+}
+
+void HLSLCompiler::loadCompiler()
 {
+  if (m_compiler)
+  {
+    return;
+  }
   HMODULE dxcompilerDLL = LoadLibraryW(L"dxcompiler.dll");
 
   if (!dxcompilerDLL)
@@ -39,13 +128,40 @@ HLSLCompiler::HLSLCompiler()
   }
 
   throwIfFailed(pfxDxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_utils)));
-  throwIfFailed(pfxDxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler)));
   throwIfFailed(m_utils->CreateDefaultIncludeHandler(&m_includeHandler));
+  throwIfFailed(pfxDxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler)));
 }
 
 ComPtr<IDxcBlob> HLSLCompiler::compileShader(const std::filesystem::path& shaderFile, const wchar_t* targetProfile,
-                                             const wchar_t* entryPoint)
+                                             const wchar_t* entryPoint, const std::vector<ShaderDefine>& defines)
 {
+  const auto start = std::chrono::high_resolution_clock::now();
+
+  // The DxcDefines point into the strings of defines, which outlive the compilation.
+  std::vector<DxcDefine> userDefines(defines.size());
+  for (size_t i = 0; i < defines.size(); i++)
+  {
+    userDefines[i].Name  = defines[i].name.c_str();
+    userDefines[i].Value = defines[i].value.empty() ? nullptr : defines[i].value.c_str();
+  }
+
+  ui64 cacheKey = 0;
+  if (m_cache.isEnabled())
+  {
+    cacheKey = m_cache.computeKey(shaderFile, entryPoint, targetProfile, defines, m_compilerVersion);
+
+    ShaderCacheEntry entry;
+    if (m_cache.load(cacheKey, entry))
+    {
+      const ComPtr<IDxcBlob> cachedObject = Microsoft::WRL::Make<CachedShaderBlob>(std::move(entry.object));
+      m_statistics.nCacheHits++;
+      m_statistics.milliseconds +=
+          std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+      return cachedObject;
+    }
+  }
+
+  loadCompiler();
   ComPtr<IDxcBlobEncoding> sourceCode;
   if (FAILED(m_utils->LoadFile(shaderFile.wstring().c_str(), nullptr, &sourceCode)))
   {
@@ -53,7 +169,6 @@ ComPtr<IDxcBlob> HLSLCompiler::compileShader(const std::filesystem::path& shader
   }
 
   std::vector<const wchar_t*> userArguments = {};
-  std::vector<DxcDefine>      userDefines   = {};
 
   ComPtr<IDxcCompilerArgs> arguments;
   m_utils->BuildArguments(shaderFile.wstring().c_str(), entryPoint, targetProfile, userArguments.data(),
@@ -79,8 +194,9 @@ ComPtr<IDxcBlob> HLSLCompiler::compileShader(const std::filesystem::path& shader
     if (errors != nullptr && errors->GetStringPointer() != nullptr && errors->GetStringLength() != 0)
     {
       const auto errorString =
-          std::format("Failed to compile {} (Profile: {}, Entroy: {}):\n{}", shaderFile.string(),
-                      wstring_to_string(targetProfile), wstring_to_string(entryPoint), errors->GetStringPointer());
+          std::format("Failed to compile {} (Profile: {}, Entroy: {}, Defines: {}):\n{}", shaderFile.string(),
+                      wstring_to_string(targetProfile), wstring_to_string(entryPoint), definesToString(defines),
+                      errors->GetStringPointer());
       OutputDebugStringA(errorString.c_str());
       throw std::exception((char*)errorString.c_str());
     }
@@ -88,9 +204,28 @@ ComPtr<IDxcBlob> HLSLCompiler::compileShader(const std::filesystem::path& shader
 
   ComPtr<IDxcBlob> shaderBlob;
   result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr);
+
+  if (m_cache.isEnabled() && shaderBlob != nullptr)
+  {
+    ComPtr<IDxcBlob> reflectionBlob;
+    if (result->HasOutput(DXC_OUT_REFLECTION))
+    {
+      result->GetOutput(DXC_OUT_REFLECTION, IID_PPV_ARGS(&reflectionBlob), nullptr);
+    }
+    m_cache.store(cacheKey, {toByteVector(shaderBlob), toByteVector(reflectionBlob)});
+  }
+
+  m_statistics.nCacheMisses++;
+  m_statistics.milliseconds +=
+      std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
   return shaderBlob;
 }
 
+const ShaderCompilationStatistics& HLSLCompiler::getStatistics() const
+{
+  return m_statistics;
+}
+
 D3D12_SHADER_BYTECODE HLSLCompiler::convert(ComPtr<IDxcBlob> in)
 {
   D3D12_SHADER_BYTECODE result = {};
@@ -0,0 +1,463 @@
+#include <chrono>
+#include <fstream>
+#include <gimslib/d3d/PipelineStateManager.hpp>
+#include <gimslib/dbg/HrException.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+// Distinguishes the pipeline types, so a compute and a graphics description never hash to the same name.
+enum class PipelineType : ui32
+{
+  Graphics   = 1,
+  Compute    = 2,
+  MeshShader = 3,
+};
+
+// The description structs contain padding, so they are hashed member by member instead of by their bytes.
+
+void addShader(Hasher& hasher, const D3D12_SHADER_BYTECODE& shader)
+{
+  hasher.addValue(static_cast<ui64>(shader.BytecodeLength));
+  if (shader.BytecodeLength > 0)
+  {
+    hasher.add(shader.pShaderBytecode, shader.BytecodeLength);
+  }
+}
+
+void addBlendState(Hasher& hasher, const D3D12_BLEND_DESC& blendState)
+{
+  hasher.addValue(blendState.AlphaToCoverageEnable);
+  hasher.addValue(blendState.IndependentBlendEnable);
+  for (const auto& renderTarget : blendState.RenderTarget)
+  {
+    hasher.addValue(renderTarget.BlendEnable);
+    hasher.addValue(renderTarget.LogicOpEnable);
+    hasher.addValue(renderTarget.SrcBlend);
+    hasher.addValue(renderTarget.DestBlend);
+    hasher.addValue(renderTarget.BlendOp);
+    hasher.addValue(renderTarget.SrcBlendAlpha);
+    hasher.addValue(renderTarget.DestBlendAlpha);
+    hasher.addValue(renderTarget.BlendOpAlpha);
+    hasher.addValue(renderTarget.LogicOp);
+    hasher.addValue(renderTarget.RenderTargetWriteMask);
+  }
+}
+
+void addRasterizerState(Hasher& hasher, const D3D12_RASTERIZER_DESC& rasterizerState)
+{
+  static_assert(sizeof(D3D12_RASTERIZER_DESC) == 11 * 4, "D3D12_RASTERIZER_DESC is expected to have no padding.");
+  hasher.addValue(rasterizerState);
+}
+
+void addDepthStencilState(Hasher& hasher, const D3D12_DEPTH_STENCIL_DESC& depthStencilState)
+{
+  hasher.addValue(depthStencilState.DepthEnable);
+  hasher.addValue(depthStencilState.DepthWriteMask);
+  hasher.addValue(depthStencilState.DepthFunc);
+  hasher.addValue(depthStencilState.StencilEnable);
+  hasher.addValue(depthStencilState.StencilReadMask);
+  hasher.addValue(depthStencilState.StencilWriteMask);
+  hasher.addValue(depthStencilState.FrontFace);
+  hasher.addValue(depthStencilState.BackFace);
+}
+
+void addOutputMergerState(Hasher& hasher, const D3D12_BLEND_DESC& blendState, UINT sampleMask,
+                          const D3D12_RASTERIZER_DESC& rasterizerState,
+                          const D3D12_DEPTH_STENCIL_DESC& depthStencilState,
+                          D3D12_PRIMITIVE_TOPOLOGY_TYPE primitiveTopologyType, UINT numRenderTargets,
+                          const DXGI_FORMAT (&rtvFormats)[8], DXGI_FORMAT dsvFormat, const DXGI_SAMPLE_DESC& sampleDesc)
+{
+  addBlendState(hasher, blendState);
+  hasher.addValue(sampleMask);
+  addRasterizerState(hasher, rasterizerState);
+  addDepthStencilState(hasher, depthStencilState);
+  hasher.addValue(primitiveTopologyType);
+  hasher.addValue(numRenderTargets);
+  for (UINT i = 0; i < numRenderTargets; i++)
+  {
+    hasher.addValue(rtvFormats[i]);
+  }
+  hasher.addValue(dsvFormat);
+  hasher.addValue(sampleDesc.Count);
+  hasher.addValue(sampleDesc.Quality);
+}
+
+/// <summary>
+/// Copies the bytecode of a shader, so the copy does not depend on the lifetime of the blob.
+/// </summary>
+void copyShader(D3D12_SHADER_BYTECODE& shader, std::vector<ui8>& bytecode)
+{
+  const ui8* begin = static_cast<const ui8*>(shader.pShaderBytecode);
+  bytecode.assign(begin, begin + shader.BytecodeLength);
+  shader.pShaderBytecode = bytecode.empty() ? nullptr : bytecode.data();
+}
+
+/// <summary>
+/// A graphics pipeline description that owns everything its pointers refer to. Never moved after construction.
+/// </summary>
+struct GraphicsPipelineRequest
+{
+  D3D12_GRAPHICS_PIPELINE_STATE_DESC    description;
+  ComPtr<ID3D12RootSignature>           rootSignature;
+  std::vector<ui8>                      shaders[5];
+  std::vector<D3D12_INPUT_ELEMENT_DESC> inputElements;
+  std::vector<std::string>              semanticNames;
+
+  explicit GraphicsPipelineRequest(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& other)
+      : description(other)
+      , rootSignature(other.pRootSignature)
+  {
+    if (other.StreamOutput.NumEntries > 0)
+    {
+      throw std::invalid_argument("Pipelines with stream output are not supported.");
+    }
+    copyShader(description.VS, shaders[0]);
+    copyShader(description.PS, shaders[1]);
+    copyShader(description.DS, shaders[2]);
+    copyShader(description.HS, shaders[3]);
+    copyShader(description.GS, shaders[4]);
+
+    inputElements.assign(other.InputLayout.pInputElementDescs,
+                         other.InputLayout.pInputElementDescs + other.InputLayout.NumElements);
+    semanticNames.reserve(inputElements.size());
+    for (const auto& inputElement : inputElements)
+    {
+      semanticNames.push_back(inputElement.SemanticName);
+    }
+    for (size_t i = 0; i < inputElements.size(); i++)
+    {
+      inputElements[i].SemanticName = semanticNames[i].c_str();
+    }
+    description.InputLayout.pInputElementDescs = inputElements.empty() ? nullptr : inputElements.data();
+    description.CachedPSO                      = {};
+  }
+};
+
+struct ComputePipelineRequest
+{
+  D3D12_COMPUTE_PIPELINE_STATE_DESC description;
+  ComPtr<ID3D12RootSignature>       rootSignature;
+  std::vector<ui8>                  shader;
+
+  explicit ComputePipelineRequest(const D3D12_COMPUTE_PIPELINE_STATE_DESC& other)
+      : description(other)
+      , rootSignature(other.pRootSignature)
+  {
+    copyShader(description.CS, shader);
+    description.CachedPSO = {};
+  }
+};
+
+struct MeshShaderPipelineRequest
+{
+  D3DX12_MESH_SHADER_PIPELINE_STATE_DESC description;
+  ComPtr<ID3D12RootSignature>            rootSignature;
+  std::vector<ui8>                       shaders[3];
+
+  explicit MeshShaderPipelineRequest(const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& other)
+      : description(other)
+      , rootSignature(other.pRootSignature)
+  {
+    copyShader(description.AS, shaders[0]);
+    copyShader(description.MS, shaders[1]);
+    copyShader(description.PS, shaders[2]);
+    description.CachedPSO = {};
+  }
+};
+
+std::wstring getPipelineName(ui64 hash)
+{
+  const std::string name = toHexString(hash);
+  return std::wstring(name.begin(), name.end());
+}
+} // namespace
+
+namespace gims
+{
+ui64 hashRootSignature(const void* serializedRootSignature, size_t sizeInBytes)
+{
+  return hashBytes(serializedRootSignature, sizeInBytes);
+}
+
+ui64 hashPipelineDescription(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash)
+{
+  Hasher hasher;
+  hasher.addValue(PipelineType::Graphics);
+  hasher.addValue(rootSignatureHash);
+  addShader(hasher, description.VS);
+  addShader(hasher, description.PS);
+  addShader(hasher, description.DS);
+  addShader(hasher, description.HS);
+  addShader(hasher, description.GS);
+  addOutputMergerState(hasher, description.BlendState, description.SampleMask, description.RasterizerState,
+                       description.DepthStencilState, description.PrimitiveTopologyType, description.NumRenderTargets,
+                       description.RTVFormats, description.DSVFormat, description.SampleDesc);
+  hasher.addValue(description.InputLayout.NumElements);
+  for (UINT i = 0; i < description.InputLayout.NumElements; i++)
+  {
+    const D3D12_INPUT_ELEMENT_DESC& inputElement = description.InputLayout.pInputElementDescs[i];
+    hasher.add(std::string(inputElement.SemanticName));
+    hasher.addValue(inputElement.SemanticIndex);
+    hasher.addValue(inputElement.Format);
+    hasher.addValue(inputElement.InputSlot);
+    hasher.addValue(inputElement.AlignedByteOffset);
+    hasher.addValue(inputElement.InputSlotClass);
+    hasher.addValue(inputElement.InstanceDataStepRate);
+  }
+  hasher.addValue(description.IBStripCutValue);
+  hasher.addValue(description.NodeMask);
+  hasher.addValue(description.Flags);
+  return hasher.getValue();
+}
+
+ui64 hashPipelineDescription(const D3D12_COMPUTE_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash)
+{
+  Hasher hasher;
+  hasher.addValue(PipelineType::Compute);
+  hasher.addValue(rootSignatureHash);
+  addShader(hasher, description.CS);
+  hasher.addValue(description.NodeMask);
+  hasher.addValue(description.Flags);
+  return hasher.getValue();
+}
+
+ui64 hashPipelineDescription(const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash)
+{
+  Hasher hasher;
+  hasher.addValue(PipelineType::MeshShader);
+  hasher.addValue(rootSignatureHash);
+  addShader(hasher, description.AS);
+  addShader(hasher, description.MS);
+  addShader(hasher, description.PS);
+  addOutputMergerState(hasher, description.BlendState, description.SampleMask, description.RasterizerState,
+                       description.DepthStencilState, description.PrimitiveTopologyType, description.NumRenderTargets,
+                       description.RTVFormats, description.DSVFormat, description.SampleDesc);
+  hasher.addValue(description.NodeMask);
+  hasher.addValue(description.Flags);
+  return hasher.getValue();
+}
+
+PipelineStateManager::PipelineStateManager(const ComPtr<ID3D12Device2>& device,
+                                           const std::filesystem::path& libraryFile, ThreadPool* threadPool)
+    : m_device(device)
+    , m_threadPool(threadPool)
+    , m_libraryFile(libraryFile)
+    , m_libraryModified(false)
+    , m_nLoadedFromLibrary(0)
+    , m_milliseconds(0.0)
+{
+  if (m_libraryFile.empty())
+  {
+    return;
+  }
+
+  ComPtr<ID3D12Device1> device1;
+  if (FAILED(m_device.As(&device1)))
+  {
+    return;
+  }
+
+  std::ifstream stream(m_libraryFile, std::ios::binary);
+  if (stream)
+  {
+    m_libraryBlob.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  }
+  if (!m_libraryBlob.empty() && FAILED(device1->CreatePipelineLibrary(m_libraryBlob.data(), m_libraryBlob.size(),
+                                                                      IID_PPV_ARGS(&m_library))))
+  {
+    // Libraries are only valid for the driver and device that wrote them.
+    std::cout << "Pipeline library " << m_libraryFile.string() << " does not match the driver and is rebuilt."
+              << std::endl;
+    m_libraryBlob.clear();
+    m_library.Reset();
+  }
+  if (!m_library && FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+  {
+    // Not supported, e.g., by some debugging tools. Pipelines are always compiled then.
+    m_library.Reset();
+  }
+}
+
+ComPtr<ID3D12RootSignature> PipelineStateManager::createRootSignature(const ComPtr<ID3DBlob>& serializedRootSignature)
+{
+  ComPtr<ID3D12RootSignature> rootSignature;
+  throwIfFailed(m_device->CreateRootSignature(0, serializedRootSignature->GetBufferPointer(),
+                                              serializedRootSignature->GetBufferSize(),
+                                              IID_PPV_ARGS(&rootSignature)));
+  m_rootSignatureHashes[rootSignature.Get()] =
+      hashRootSignature(serializedRootSignature->GetBufferPointer(), serializedRootSignature->GetBufferSize());
+  m_rootSignatures.push_back(rootSignature);
+  return rootSignature;
+}
+
+PipelineStateManager::Handle PipelineStateManager::requestPipeline(
+    const D3D12_GRAPHICS_PIPELINE_STATE_DESC& description)
+{
+  const ui64 hash    = hashPipelineDescription(description, getRootSignatureHash(description.pRootSignature));
+  auto       request = std::make_shared<GraphicsPipelineRequest>(description);
+  return m_pipelines.request(hash, [this, hash, request]() {
+    return createPipeline(
+        hash,
+        [request](ID3D12PipelineLibrary* library, const wchar_t* name, ComPtr<ID3D12PipelineState>& pipelineState) {
+          return library->LoadGraphicsPipeline(name, &request->description, IID_PPV_ARGS(&pipelineState));
+        },
+        [this, request]() {
+          ComPtr<ID3D12PipelineState> pipelineState;
+          throwIfFailed(m_device->CreateGraphicsPipelineState(&request->description, IID_PPV_ARGS(&pipelineState)));
+          return pipelineState;
+        });
+  });
+}
+
+PipelineStateManager::Handle PipelineStateManager::requestPipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& description)
+{
+  const ui64 hash    = hashPipelineDescription(description, getRootSignatureHash(description.pRootSignature));
+  auto       request = std::make_shared<ComputePipelineRequest>(description);
+  return m_pipelines.request(hash, [this, hash, request]() {
+    return createPipeline(
+        hash,
+        [request](ID3D12PipelineLibrary* library, const wchar_t* name, ComPtr<ID3D12PipelineState>& pipelineState) {
+          return library->LoadComputePipeline(name, &request->description, IID_PPV_ARGS(&pipelineState));
+        },
+        [this, request]() {
+          ComPtr<ID3D12PipelineState> pipelineState;
+          throwIfFailed(m_device->CreateComputePipelineState(&request->description, IID_PPV_ARGS(&pipelineState)));
+          return pipelineState;
+        });
+  });
+}
+
+PipelineStateManager::Handle PipelineStateManager::requestPipeline(
+    const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& description)
+{
+  const ui64 hash    = hashPipelineDescription(description, getRootSignatureHash(description.pRootSignature));
+  auto       request = std::make_shared<MeshShaderPipelineRequest>(description);
+  return m_pipelines.request(hash, [this, hash, request]() {
+    return createPipeline(
+        hash,
+        [request](ID3D12PipelineLibrary* library, const wchar_t* name, ComPtr<ID3D12PipelineState>& pipelineState) {
+          ComPtr<ID3D12PipelineLibrary1> library1;
+          HRESULT                        hr = library->QueryInterface(IID_PPV_ARGS(&library1));
+          if (FAILED(hr))
+          {
+            return hr;
+          }
+          auto                             stream     = CD3DX12_PIPELINE_MESH_STATE_STREAM(request->description);
+          D3D12_PIPELINE_STATE_STREAM_DESC streamDesc = {sizeof(stream), &stream};
+          return library1->LoadPipeline(name, &streamDesc, IID_PPV_ARGS(&pipelineState));
+        },
+        [this, request]() {
+          auto                             stream     = CD3DX12_PIPELINE_MESH_STATE_STREAM(request->description);
+          D3D12_PIPELINE_STATE_STREAM_DESC streamDesc = {sizeof(stream), &stream};
+          ComPtr<ID3D12PipelineState>      pipelineState;
+          throwIfFailed(m_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&pipelineState)));
+          return pipelineState;
+        });
+  });
+}
+
+void PipelineStateManager::createPipelines()
+{
+  const auto start = std::chrono::high_resolution_clock::now();
+  m_pipelines.run(m_threadPool);
+  const auto end = std::chrono::high_resolution_clock::now();
+  m_milliseconds += std::chrono::duration<f64, std::milli>(end - start).count();
+}
+
+const ComPtr<ID3D12PipelineState>& PipelineStateManager::getPipeline(Handle handle) const
+{
+  return m_pipelines.get(handle);
+}
+
+void PipelineStateManager::storeLibrary()
+{
+  if (!m_library || !m_libraryModified)
+  {
+    return;
+  }
+
+  std::vector<ui8> data(m_library->GetSerializedSize());
+  if (FAILED(m_library->Serialize(data.data(), data.size())))
+  {
+    std::cout << "Unable to serialize the pipeline library." << std::endl;
+    return;
+  }
+
+  // Written to a temporary file first, so a crash never leaves a half written library behind.
+  std::error_code errorCode;
+  if (m_libraryFile.has_parent_path())
+  {
+    std::filesystem::create_directories(m_libraryFile.parent_path(), errorCode);
+  }
+  std::filesystem::path temporaryPath = m_libraryFile;
+  temporaryPath += ".tmp";
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!stream)
+    {
+      std::cout << "Unable to write " << temporaryPath.string() << std::endl;
+      return;
+    }
+  }
+  std::filesystem::rename(temporaryPath, m_libraryFile, errorCode);
+  if (errorCode)
+  {
+    std::cout << "Unable to write " << m_libraryFile.string() << std::endl;
+    std::filesystem::remove(temporaryPath, errorCode);
+    return;
+  }
+  m_libraryModified = false;
+}
+
+PipelineStateStatistics PipelineStateManager::getStatistics() const
+{
+  PipelineStateStatistics statistics;
+  statistics.nRequests          = m_pipelines.getNumberOfRequests();
+  statistics.nPipelines         = m_pipelines.getNumberOfEntries();
+  statistics.nLoadedFromLibrary = m_nLoadedFromLibrary;
+  statistics.milliseconds       = m_milliseconds;
+  return statistics;
+}
+
+ui64 PipelineStateManager::getRootSignatureHash(ID3D12RootSignature* rootSignature) const
+{
+  const auto it = m_rootSignatureHashes.find(rootSignature);
+  if (it != m_rootSignatureHashes.end())
+  {
+    return it->second;
+  }
+  return hashBytes(&rootSignature, sizeof(rootSignature));
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateManager::createPipeline(
+    ui64 hash, const std::function<HRESULT(ID3D12PipelineLibrary*, const wchar_t*, ComPtr<ID3D12PipelineState>&)>& load,
+    const std::function<ComPtr<ID3D12PipelineState>()>& create)
+{
+  const std::wstring          name = getPipelineName(hash);
+  ComPtr<ID3D12PipelineState> pipelineState;
+  if (m_library && SUCCEEDED(load(m_library.Get(), name.c_str(), pipelineState)))
+  {
+    m_nLoadedFromLibrary++;
+    return pipelineState;
+  }
+
+  pipelineState = create();
+  if (m_library)
+  {
+    // Fails if the name is already taken by a pipeline that did not match, the library then keeps the old one.
+    std::lock_guard<std::mutex> lock(m_libraryMutex);
+    if (SUCCEEDED(m_library->StorePipeline(name.c_str(), pipelineState.Get())))
+    {
+      m_libraryModified = true;
+    }
+  }
+  return pipelineState;
+}
+} // namespace gims
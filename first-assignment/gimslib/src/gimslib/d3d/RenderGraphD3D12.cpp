@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <d3dx12/d3dx12.h>
+#include <gimslib/d3d/RenderGraphD3D12.hpp>
+#include <gimslib/dbg/HrException.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+bool isRenderTargetOrDepthBuffer(const D3D12_RESOURCE_DESC& desc)
+{
+  return (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+}
+
+D3D12_RESOURCE_BARRIER toD3D12Barrier(const RenderGraphBarrier& barrier, const RenderGraphD3D12& renderGraph)
+{
+  ID3D12Resource* resource = renderGraph.getResource(barrier.resourceIdx).Get();
+  switch (barrier.type)
+  {
+  case RenderGraphBarrier::Type::UnorderedAccess:
+    return CD3DX12_RESOURCE_BARRIER::UAV(resource);
+  case RenderGraphBarrier::Type::Aliasing:
+    return CD3DX12_RESOURCE_BARRIER::Aliasing(barrier.resourceBeforeIdx == renderGraphInvalidIdx
+                                                  ? nullptr
+                                                  : renderGraph.getResource(barrier.resourceBeforeIdx).Get(),
+                                              resource);
+  default:
+    return CD3DX12_RESOURCE_BARRIER::Transition(resource, static_cast<D3D12_RESOURCE_STATES>(barrier.stateBefore),
+                                                static_cast<D3D12_RESOURCE_STATES>(barrier.stateAfter));
+  }
+}
+} // namespace
+
+namespace gims
+{
+static_assert(resourceStateUnorderedAccess == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+RenderGraphD3D12::RenderGraphD3D12(const ComPtr<ID3D12Device2>& device)
+    : m_device(device)
+    , m_onlyRenderTargetsInHeap(true)
+    , m_heapSize(0)
+{
+  D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+  if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+  {
+    m_onlyRenderTargetsInHeap = options.ResourceHeapTier == D3D12_RESOURCE_HEAP_TIER_1;
+  }
+}
+
+void RenderGraphD3D12::reset()
+{
+  m_renderGraph.clear();
+  m_passes.clear();
+  m_resources.clear();
+  m_transientResources.clear();
+}
+
+ui32 RenderGraphD3D12::importResource(const std::string& name, const ComPtr<ID3D12Resource>& resource,
+                                      D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState)
+{
+  const ui32 resourceIdx = m_renderGraph.importResource(name, initialState, finalState);
+  m_resources.push_back(resource);
+  m_transientResources.emplace_back();
+  return resourceIdx;
+}
+
+ui32 RenderGraphD3D12::createTransientResource(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+                                               const D3D12_CLEAR_VALUE* optimizedClearValue)
+{
+  if (m_onlyRenderTargetsInHeap && !isRenderTargetOrDepthBuffer(desc))
+  {
+    throw std::invalid_argument("Transient resource " + name + " is neither a render target nor a depth buffer.");
+  }
+
+  TransientResource transientResource      = {};
+  transientResource.desc                   = desc;
+  transientResource.hasOptimizedClearValue = optimizedClearValue != nullptr;
+  if (optimizedClearValue)
+  {
+    transientResource.optimizedClearValue = *optimizedClearValue;
+  }
+  const auto allocationInfo   = m_device->GetResourceAllocationInfo(0, 1, &desc);
+  transientResource.alignment = allocationInfo.Alignment;
+
+  const ui32 resourceIdx =
+      m_renderGraph.createTransientResource(name, {allocationInfo.SizeInBytes, allocationInfo.Alignment});
+  m_resources.emplace_back();
+  m_transientResources.push_back(transientResource);
+  return resourceIdx;
+}
+
+ui32 RenderGraphD3D12::addPass(const std::string& name, const std::vector<RenderGraphResourceUsage>& reads,
+                               const std::vector<RenderGraphResourceUsage>& writes, PassFunction execute,
+                               bool hasSideEffects)
+{
+  const ui32 passIdx = m_renderGraph.addPass(name, reads, writes, hasSideEffects);
+  m_passes.push_back(std::move(execute));
+  return passIdx;
+}
+
+const ComPtr<ID3D12Resource>& RenderGraphD3D12::getResource(ui32 resourceIdx) const
+{
+  return m_resources.at(resourceIdx);
+}
+
+void RenderGraphD3D12::execute(const CommandListGetter& getCommandList)
+{
+  m_compiledRenderGraph = m_renderGraph.compile();
+
+  if (m_compiledRenderGraph.heapSize > m_heapSize)
+  {
+    ui64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    for (const auto& transientResource : m_transientResources)
+    {
+      alignment = std::max(alignment, transientResource.alignment);
+    }
+    const CD3DX12_HEAP_DESC heapDesc(m_compiledRenderGraph.heapSize, D3D12_HEAP_TYPE_DEFAULT, alignment,
+                                     m_onlyRenderTargetsInHeap ? D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+                                                               : D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES);
+    throwIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+    m_heapSize = m_compiledRenderGraph.heapSize;
+  }
+
+  for (ui32 resourceIdx = 0; resourceIdx < m_renderGraph.getNumberOfResources(); resourceIdx++)
+  {
+    const ui64 heapOffset = m_compiledRenderGraph.heapOffsets[resourceIdx];
+    if (!m_renderGraph.isTransient(resourceIdx) || heapOffset == ~0ull)
+    {
+      continue;
+    }
+    const TransientResource& transientResource = m_transientResources[resourceIdx];
+    m_resources[resourceIdx].Reset();
+    throwIfFailed(m_device->CreatePlacedResource(
+        m_heap.Get(), heapOffset, &transientResource.desc,
+        static_cast<D3D12_RESOURCE_STATES>(m_compiledRenderGraph.initialStates[resourceIdx]),
+        transientResource.hasOptimizedClearValue ? &transientResource.optimizedClearValue : nullptr,
+        IID_PPV_ARGS(&m_resources[resourceIdx])));
+  }
+
+  std::vector<D3D12_RESOURCE_BARRIER> barriers;
+  for (const auto& step : m_compiledRenderGraph.steps)
+  {
+    const auto& commandList = getCommandList();
+    barriers.clear();
+    for (const auto& barrier : step.barriers)
+    {
+      barriers.push_back(toD3D12Barrier(barrier, *this));
+    }
+    if (!barriers.empty())
+    {
+      commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+    }
+
+    for (const ui32 resourceIdx : step.activated)
+    {
+      const auto initialState = m_compiledRenderGraph.initialStates[resourceIdx];
+      if (initialState == D3D12_RESOURCE_STATE_RENDER_TARGET || initialState == D3D12_RESOURCE_STATE_DEPTH_WRITE)
+      {
+        commandList->DiscardResource(m_resources[resourceIdx].Get(), nullptr);
+      }
+    }
+
+    if (step.passIdx != renderGraphInvalidIdx)
+    {
+      m_passes[step.passIdx](commandList);
+    }
+  }
+}
+
+const CompiledRenderGraph& RenderGraphD3D12::getCompiledRenderGraph() const
+{
+  return m_compiledRenderGraph;
+}
+
+const RenderGraph& RenderGraphD3D12::getRenderGraph() const
+{
+  return m_renderGraph;
+}
+} // namespace gims
@@ -0,0 +1,725 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <gimslib/io/AsyncFileReader.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace gims
+{
+//! \brief Counts the reads that have not completed, so waitForAll works the same for all backends.
+class AsyncFileReader::Backend
+{
+public:
+  virtual ~Backend() = default;
+
+  virtual AsyncFileReaderBackend getType() const = 0;
+
+  virtual void submit(const std::vector<FileReadRequest>& requests, const FileReadCallback& onCompletion) = 0;
+
+  void waitForAll()
+  {
+    std::unique_lock<std::mutex> lock(m_countMutex);
+    m_allCompleted.wait(lock, [this] { return m_nIncompleteReads == 0; });
+  }
+
+protected:
+  void addReads(size_t nReads)
+  {
+    std::lock_guard<std::mutex> lock(m_countMutex);
+    m_nIncompleteReads += nReads;
+  }
+
+  void completeRead()
+  {
+    std::lock_guard<std::mutex> lock(m_countMutex);
+    if (--m_nIncompleteReads == 0)
+    {
+      m_allCompleted.notify_all();
+    }
+  }
+
+private:
+  std::mutex              m_countMutex;
+  std::condition_variable m_allCompleted;
+  size_t                  m_nIncompleteReads = 0;
+};
+} // namespace gims
+
+using namespace gims;
+
+namespace
+{
+// A request of a batch, which shares the callback with the other requests of the batch.
+struct ReadOperation
+{
+  std::shared_ptr<const FileReadCallback> onCompletion;
+  size_t                                  requestIdx;
+  FileReadRequest                         request;
+  size_t                                  nBytesRead = 0;
+#ifdef __linux__
+  int   file      = -1;
+  iovec remainder = {}; // The part of the buffer the next read goes to.
+#endif
+};
+
+std::vector<ReadOperation*> createOperations(const std::vector<FileReadRequest>& requests,
+                                             const FileReadCallback&             onCompletion)
+{
+  const auto                  sharedOnCompletion = std::make_shared<const FileReadCallback>(onCompletion);
+  std::vector<ReadOperation*> operations;
+  operations.reserve(requests.size());
+  for (size_t requestIdx = 0; requestIdx < requests.size(); requestIdx++)
+  {
+    operations.push_back(new ReadOperation {sharedOnCompletion, requestIdx, requests[requestIdx]});
+  }
+  return operations;
+}
+
+std::exception_ptr createReadError(const ReadOperation& operation, int errorCode)
+{
+  return std::make_exception_ptr(
+      std::runtime_error("Unable to read " + operation.request.path.string() + ": " + std::strerror(errorCode)));
+}
+
+// Reads a request with blocking calls and returns the number of bytes read.
+size_t readBlocking(const FileReadRequest& request)
+{
+  ui8*   buffer     = static_cast<ui8*>(request.buffer);
+  size_t nBytesRead = 0;
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(request.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error("Unable to open " + request.path.string());
+  }
+  while (nBytesRead < request.size)
+  {
+    const ui64 position   = request.offset + nBytesRead;
+    OVERLAPPED overlapped = {};
+    overlapped.Offset     = static_cast<DWORD>(position);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    const DWORD nBytes    = static_cast<DWORD>(std::min<size_t>(request.size - nBytesRead, 1 << 30));
+    DWORD       nRead     = 0;
+    if (!ReadFile(file, buffer + nBytesRead, nBytes, &nRead, &overlapped))
+    {
+      if (GetLastError() == ERROR_HANDLE_EOF)
+      {
+        break;
+      }
+      CloseHandle(file);
+      throw std::runtime_error("Unable to read " + request.path.string());
+    }
+    if (nRead == 0)
+    {
+      break;
+    }
+    nBytesRead += nRead;
+  }
+  CloseHandle(file);
+#else
+  const int file = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0)
+  {
+    throw std::runtime_error("Unable to open " + request.path.string());
+  }
+  while (nBytesRead < request.size)
+  {
+    const ssize_t nRead = pread(file, buffer + nBytesRead, request.size - nBytesRead,
+                                static_cast<off_t>(request.offset + nBytesRead));
+    if (nRead < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (nRead < 0)
+    {
+      const int errorCode = errno;
+      close(file);
+      throw std::runtime_error("Unable to read " + request.path.string() + ": " + std::strerror(errorCode));
+    }
+    if (nRead == 0)
+    {
+      break;
+    }
+    nBytesRead += static_cast<size_t>(nRead);
+  }
+  close(file);
+#endif
+  return nBytesRead;
+}
+
+// Workers that read one request after the other with blocking calls. Each worker opens the files of its requests.
+class ThreadPoolBackend : public AsyncFileReader::Backend
+{
+public:
+  explicit ThreadPoolBackend(ui32 nThreads)
+      : m_stop(false)
+  {
+    for (ui32 i = 0; i < nThreads; i++)
+    {
+      m_workers.emplace_back(&ThreadPoolBackend::workerLoop, this);
+    }
+  }
+
+  ~ThreadPoolBackend() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& worker : m_workers)
+    {
+      worker.join();
+    }
+  }
+
+  AsyncFileReaderBackend getType() const override
+  {
+    return AsyncFileReaderBackend::ThreadPool;
+  }
+
+  void submit(const std::vector<FileReadRequest>& requests, const FileReadCallback& onCompletion) override
+  {
+    const std::vector<ReadOperation*> operations = createOperations(requests, onCompletion);
+    addReads(operations.size());
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_queue.insert(m_queue.end(), operations.begin(), operations.end());
+    }
+    m_wakeUp.notify_all();
+  }
+
+private:
+  void workerLoop()
+  {
+    GIMS_PROFILE_THREAD("File Reader");
+    while (true)
+    {
+      ReadOperation* operation;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+        {
+          return;
+        }
+        operation = m_queue.front();
+        m_queue.pop_front();
+      }
+      std::exception_ptr error;
+      try
+      {
+        operation->nBytesRead = readBlocking(operation->request);
+      }
+      catch (const std::runtime_error&)
+      {
+        error = std::current_exception();
+      }
+      (*operation->onCompletion)(operation->requestIdx, error ? 0 : operation->nBytesRead, error);
+      delete operation;
+      completeRead();
+    }
+  }
+
+  std::vector<std::thread>   m_workers;
+  std::mutex                 m_mutex;
+  std::condition_variable    m_wakeUp;
+  std::deque<ReadOperation*> m_queue;
+  bool                       m_stop;
+};
+
+#ifdef __linux__
+// liburing is not a dependency, so the rings are set up with the system calls. See io_uring_setup(2).
+int ioUringSetup(ui32 nEntries, io_uring_params* parameters)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, nEntries, parameters));
+}
+
+int ioUringEnter(int ring, ui32 nToSubmit, ui32 nMinCompletions, ui32 flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring, nToSubmit, nMinCompletions, flags, nullptr, 0));
+}
+
+ui32 loadAcquire(ui32* value)
+{
+  return std::atomic_ref<ui32>(*value).load(std::memory_order_acquire);
+}
+
+void storeRelease(ui32* value, ui32 newValue)
+{
+  std::atomic_ref<ui32>(*value).store(newValue, std::memory_order_release);
+}
+
+// Reads with io_uring. Callers fill the submission queue under a mutex, a thread of the backend waits for the
+// completions, resubmits short reads, and calls the callbacks. Operations beyond the queue depth wait in a queue, so
+// the completion queue, twice the size of the submission queue, cannot overflow.
+class IoUringBackend : public AsyncFileReader::Backend
+{
+public:
+  explicit IoUringBackend(ui32 queueDepth)
+      : m_queueDepth(queueDepth)
+  {
+    io_uring_params parameters = {};
+    m_ring                     = ioUringSetup(queueDepth, &parameters);
+    if (m_ring < 0)
+    {
+      throw std::runtime_error(std::string("Unable to set up io_uring: ") + std::strerror(errno));
+    }
+    // Kernels since 5.4 map both rings with one mapping, older ones need two.
+    const bool   singleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    const size_t sqRingSize    = parameters.sq_off.array + parameters.sq_entries * sizeof(ui32);
+    const size_t cqRingSize    = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+    m_sqRingSize               = singleMapping ? std::max(sqRingSize, cqRingSize) : sqRingSize;
+    m_cqRingSize               = singleMapping ? 0 : cqRingSize;
+    m_sqesSize                 = parameters.sq_entries * sizeof(io_uring_sqe);
+
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring,
+                    IORING_OFF_SQ_RING);
+    m_cqRing = singleMapping ? m_sqRing
+                             : mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring,
+                                    IORING_OFF_CQ_RING);
+    void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+    if (m_sqRing == MAP_FAILED || m_cqRing == MAP_FAILED || sqes == MAP_FAILED)
+    {
+      const std::string message = std::string("Unable to map the io_uring queues: ") + std::strerror(errno);
+      unmap(sqes);
+      throw std::runtime_error(message);
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    ui8* sqRing = static_cast<ui8*>(m_sqRing);
+    ui8* cqRing = static_cast<ui8*>(m_cqRing);
+    m_sqTail    = reinterpret_cast<ui32*>(sqRing + parameters.sq_off.tail);
+    m_sqMask    = *reinterpret_cast<ui32*>(sqRing + parameters.sq_off.ring_mask);
+    m_sqArray   = reinterpret_cast<ui32*>(sqRing + parameters.sq_off.array);
+    m_cqHead    = reinterpret_cast<ui32*>(cqRing + parameters.cq_off.head);
+    m_cqTail    = reinterpret_cast<ui32*>(cqRing + parameters.cq_off.tail);
+    m_cqMask    = *reinterpret_cast<ui32*>(cqRing + parameters.cq_off.ring_mask);
+    m_cqes      = reinterpret_cast<io_uring_cqe*>(cqRing + parameters.cq_off.cqes);
+
+    m_completionThread = std::thread(&IoUringBackend::completionLoop, this);
+  }
+
+  ~IoUringBackend() override
+  {
+    // A no-op without operation tells the completion thread to stop, unless it stopped when the ring failed.
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error)
+      {
+        m_pending.push_back(nullptr);
+        submitPending();
+      }
+    }
+    m_completionThread.join();
+    unmap(m_sqes);
+  }
+
+  AsyncFileReaderBackend getType() const override
+  {
+    return AsyncFileReaderBackend::IoUring;
+  }
+
+  void submit(const std::vector<FileReadRequest>& requests, const FileReadCallback& onCompletion) override
+  {
+    const std::vector<ReadOperation*> operations = createOperations(requests, onCompletion);
+    addReads(operations.size());
+
+    // Files that cannot be opened complete right away, on the calling thread.
+    std::vector<ReadOperation*> opened;
+    opened.reserve(operations.size());
+    for (ReadOperation* operation : operations)
+    {
+      operation->file = open(operation->request.path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (operation->file < 0)
+      {
+        complete(operation, std::make_exception_ptr(
+                                std::runtime_error("Unable to open " + operation->request.path.string())));
+        continue;
+      }
+      operation->remainder = {operation->request.buffer, operation->request.size};
+      opened.push_back(operation);
+    }
+
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error)
+      {
+        m_pending.insert(m_pending.end(), opened.begin(), opened.end());
+        submitPending();
+        return;
+      }
+      error = m_error;
+    }
+    // Nobody would complete the reads after the ring failed.
+    for (ReadOperation* operation : opened)
+    {
+      close(operation->file);
+      complete(operation, error);
+    }
+  }
+
+private:
+  void unmap(void* sqes)
+  {
+    if (sqes != MAP_FAILED && sqes != nullptr)
+    {
+      munmap(sqes, m_sqesSize);
+    }
+    if (m_cqRingSize != 0 && m_cqRing != MAP_FAILED)
+    {
+      munmap(m_cqRing, m_cqRingSize);
+    }
+    if (m_sqRing != MAP_FAILED)
+    {
+      munmap(m_sqRing, m_sqRingSize);
+    }
+    close(m_ring);
+  }
+
+  // Moves pending operations into the submission queue, up to the queue depth, and submits them with one system call.
+  // The caller holds m_mutex.
+  void submitPending()
+  {
+    ui32 tail      = *m_sqTail;
+    ui32 nToSubmit = 0;
+    for (; !m_pending.empty() && m_inFlight.size() < m_queueDepth; nToSubmit++)
+    {
+      ReadOperation* operation = m_pending.front();
+      m_pending.pop_front();
+      m_inFlight.insert(operation);
+      const ui32    entryIdx = tail++ & m_sqMask;
+      io_uring_sqe& entry    = m_sqes[entryIdx];
+      std::memset(&entry, 0, sizeof(entry));
+      if (operation == nullptr)
+      {
+        entry.opcode = IORING_OP_NOP;
+      }
+      else
+      {
+        entry.opcode = IORING_OP_READV;
+        entry.fd     = operation->file;
+        entry.off    = operation->request.offset + operation->nBytesRead;
+        entry.addr   = reinterpret_cast<ui64>(&operation->remainder);
+        entry.len    = 1;
+      }
+      entry.user_data     = reinterpret_cast<ui64>(operation);
+      m_sqArray[entryIdx] = entryIdx;
+    }
+    if (nToSubmit == 0)
+    {
+      return;
+    }
+    storeRelease(m_sqTail, tail);
+    while (nToSubmit > 0)
+    {
+      const int nSubmitted = ioUringEnter(m_ring, nToSubmit, 0, 0);
+      if (nSubmitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      if (nSubmitted < 0)
+      {
+        throw std::runtime_error(std::string("Unable to submit to io_uring: ") + std::strerror(errno));
+      }
+      nToSubmit -= static_cast<ui32>(nSubmitted);
+    }
+  }
+
+  void completionLoop()
+  {
+    GIMS_PROFILE_THREAD("File Reader");
+    std::vector<std::pair<ReadOperation*, std::exception_ptr>> completed;
+    bool                                                        stop = false;
+    while (!stop)
+    {
+      try
+      {
+        if (ioUringEnter(m_ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+          throw std::runtime_error(std::string("Unable to wait for io_uring: ") + std::strerror(errno));
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stop = reapCompletions(completed);
+        // The next reads run while the callbacks decode the data of the finished ones.
+        submitPending();
+      }
+      catch (const std::runtime_error&)
+      {
+        // An exception would leave the thread and terminate the process, so the reads that have not completed fail
+        // with it, like reads of files that cannot be read, and so do all reads submitted later.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = std::current_exception();
+        for (ReadOperation* operation : m_pending)
+        {
+          m_inFlight.insert(operation);
+        }
+        m_pending.clear();
+        for (ReadOperation* operation : m_inFlight)
+        {
+          if (operation != nullptr)
+          {
+            completed.emplace_back(operation, m_error);
+          }
+        }
+        m_inFlight.clear();
+        stop = true;
+      }
+      for (auto& [operation, error] : completed)
+      {
+        close(operation->file);
+        complete(operation, error);
+      }
+      completed.clear();
+    }
+  }
+
+  // Moves the operations of the completion queue to completed, or back to m_pending if they are not finished. Returns
+  // true if the no-op that stops the completion thread was among them. The caller holds m_mutex.
+  bool reapCompletions(std::vector<std::pair<ReadOperation*, std::exception_ptr>>& completed)
+  {
+    bool       stop = false;
+    const ui32 tail = loadAcquire(m_cqTail);
+    ui32       head = *m_cqHead;
+    for (; head != tail; head++)
+    {
+      const io_uring_cqe& entry     = m_cqes[head & m_cqMask];
+      ReadOperation*      operation = reinterpret_cast<ReadOperation*>(entry.user_data);
+      m_inFlight.erase(operation);
+      if (operation == nullptr)
+      {
+        stop = true;
+      }
+      else if (entry.res == -EINTR || entry.res == -EAGAIN)
+      {
+        m_pending.push_front(operation);
+      }
+      else if (entry.res < 0)
+      {
+        completed.emplace_back(operation, createReadError(*operation, -entry.res));
+      }
+      else
+      {
+        // Short reads continue where they stopped, until the buffer is full or the file ends.
+        const size_t nRead = static_cast<size_t>(entry.res);
+        operation->nBytesRead += nRead;
+        operation->remainder.iov_base = static_cast<ui8*>(operation->remainder.iov_base) + nRead;
+        operation->remainder.iov_len -= nRead;
+        if (nRead == 0 || operation->remainder.iov_len == 0)
+        {
+          completed.emplace_back(operation, nullptr);
+        }
+        else
+        {
+          m_pending.push_front(operation);
+        }
+      }
+    }
+    storeRelease(m_cqHead, head);
+    return stop;
+  }
+
+  // Calls the callback without holding m_mutex, so callbacks may submit further reads.
+  void complete(ReadOperation* operation, std::exception_ptr error)
+  {
+    (*operation->onCompletion)(operation->requestIdx, error ? 0 : operation->nBytesRead, error);
+    delete operation;
+    completeRead();
+  }
+
+  ui32          m_queueDepth;
+  int           m_ring;
+  void*         m_sqRing;
+  void*         m_cqRing;
+  size_t        m_sqRingSize;
+  size_t        m_cqRingSize; //! 0 if both rings share one mapping.
+  size_t        m_sqesSize;
+  io_uring_sqe* m_sqes;
+  ui32*         m_sqTail;
+  ui32          m_sqMask;
+  ui32*         m_sqArray;
+  ui32*         m_cqHead;
+  ui32*         m_cqTail;
+  ui32          m_cqMask;
+  io_uring_cqe* m_cqes;
+
+  std::mutex                         m_mutex;    //! Guards the submission queue, m_pending, m_inFlight, and m_error.
+  std::deque<ReadOperation*>         m_pending;  //! Waiting for a free entry, nullptr stops the completion thread.
+  std::unordered_set<ReadOperation*> m_inFlight; //! Submitted, but not reaped from the completion queue.
+  std::exception_ptr                 m_error;    //! Set if waiting for or submitting to the ring failed.
+  std::thread                        m_completionThread;
+};
+#endif
+} // namespace
+
+namespace gims
+{
+AsyncFileReader::AsyncFileReader(ui32 queueDepth, AsyncFileReaderBackend backend)
+{
+  if (queueDepth == 0)
+  {
+    throw std::invalid_argument("The queue depth must be at least 1.");
+  }
+#ifdef __linux__
+  if (backend == AsyncFileReaderBackend::IoUring)
+  {
+    m_backend = std::make_unique<IoUringBackend>(queueDepth);
+  }
+  else if (backend == AsyncFileReaderBackend::Automatic)
+  {
+    try
+    {
+      m_backend = std::make_unique<IoUringBackend>(queueDepth);
+    }
+    catch (const std::runtime_error&)
+    {
+      // E.g., kernels before 5.1, or containers whose seccomp profile blocks io_uring.
+    }
+  }
+#else
+  if (backend == AsyncFileReaderBackend::IoUring)
+  {
+    throw std::runtime_error("io_uring is only available on Linux.");
+  }
+#endif
+  if (m_backend == nullptr)
+  {
+    // Blocking reads of small files are short, so a few threads keep the disk busy without oversubscribing the CPU.
+    m_backend = std::make_unique<ThreadPoolBackend>(std::min(queueDepth, 16u));
+  }
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+  m_backend->waitForAll();
+}
+
+AsyncFileReaderBackend AsyncFileReader::getBackend() const
+{
+  return m_backend->getType();
+}
+
+void AsyncFileReader::submit(const std::vector<FileReadRequest>& requests, const FileReadCallback& onCompletion)
+{
+  if (!requests.empty())
+  {
+    m_backend->submit(requests, onCompletion);
+  }
+}
+
+std::vector<std::future<size_t>> AsyncFileReader::submit(const std::vector<FileReadRequest>& requests)
+{
+  const auto                       promises = std::make_shared<std::vector<std::promise<size_t>>>(requests.size());
+  std::vector<std::future<size_t>> futures;
+  futures.reserve(requests.size());
+  for (auto& promise : *promises)
+  {
+    futures.push_back(promise.get_future());
+  }
+  submit(requests,
+         [promises](size_t requestIdx, size_t nBytesRead, std::exception_ptr error)
+         {
+           if (error)
+           {
+             (*promises)[requestIdx].set_exception(error);
+           }
+           else
+           {
+             (*promises)[requestIdx].set_value(nBytesRead);
+           }
+         });
+  return futures;
+}
+
+std::vector<std::future<std::vector<ui8>>> AsyncFileReader::readFiles(const std::vector<std::filesystem::path>& paths)
+{
+  struct File
+  {
+    std::vector<ui8>               data;
+    std::promise<std::vector<ui8>> promise;
+  };
+  const auto                                 files = std::make_shared<std::vector<File>>(paths.size());
+  std::vector<std::future<std::vector<ui8>>> futures;
+  std::vector<FileReadRequest>               requests;
+  std::vector<size_t>                        requestIdxToFileIdx;
+  futures.reserve(paths.size());
+  for (size_t fileIdx = 0; fileIdx < paths.size(); fileIdx++)
+  {
+    File& file = (*files)[fileIdx];
+    futures.push_back(file.promise.get_future());
+    std::error_code errorCode;
+    const auto      size = std::filesystem::file_size(paths[fileIdx], errorCode);
+    if (errorCode)
+    {
+      file.promise.set_exception(
+          std::make_exception_ptr(std::runtime_error("Unable to open " + paths[fileIdx].string())));
+      continue;
+    }
+    file.data.resize(size);
+    requests.push_back({paths[fileIdx], 0, file.data.data(), file.data.size()});
+    requestIdxToFileIdx.push_back(fileIdx);
+  }
+  submit(requests,
+         [files, requestIdxToFileIdx](size_t requestIdx, size_t nBytesRead, std::exception_ptr error)
+         {
+           File& file = (*files)[requestIdxToFileIdx[requestIdx]];
+           if (error)
+           {
+             file.promise.set_exception(error);
+             return;
+           }
+           // Files that shrank since their size was queried are returned as far as they were read.
+           file.data.resize(nBytesRead);
+           file.promise.set_value(std::move(file.data));
+         });
+  return futures;
+}
+
+void AsyncFileReader::waitForAll()
+{
+  m_backend->waitForAll();
+}
+
+bool isIoUringAvailable()
+{
+#ifdef __linux__
+  static const bool available = []
+  {
+    io_uring_params parameters = {};
+    const int       ring       = ioUringSetup(1, &parameters);
+    if (ring < 0)
+    {
+      return false;
+    }
+    close(ring);
+    return true;
+  }();
+  return available;
+#else
+  return false;
+#endif
+}
+} // namespace gims
@@ -0,0 +1,619 @@
+#include <cctype>
+#include <cstring>
+#include <gimslib/io/GltfFile.hpp>
+#include <gimslib/io/Json.hpp>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+using namespace gims;
+
+const ui32 glbMagic     = 0x46546c67; // "glTF"
+const ui32 glbJsonChunk = 0x4e4f534a; // "JSON"
+const ui32 glbBinChunk  = 0x004e4942; // "BIN\0"
+
+ui32 readUi32(const ui8* data)
+{
+  ui32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+ui32 getComponentSize(GltfComponentType componentType)
+{
+  switch (componentType)
+  {
+  case GltfComponentType::Int8:
+  case GltfComponentType::UInt8:
+    return 1;
+  case GltfComponentType::Int16:
+  case GltfComponentType::UInt16:
+    return 2;
+  case GltfComponentType::UInt32:
+  case GltfComponentType::Float:
+    return 4;
+  }
+  throw std::runtime_error("Unsupported component type " + std::to_string(static_cast<ui32>(componentType)) + ".");
+}
+
+ui32 getNumberOfComponents(const std::string& type)
+{
+  const char* types[]       = {"SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4"};
+  const ui32  nComponents[] = {1, 2, 3, 4, 4, 9, 16};
+  for (ui32 i = 0; i < 7; i++)
+  {
+    if (type == types[i])
+    {
+      return nComponents[i];
+    }
+  }
+  throw std::runtime_error("Unsupported accessor type " + type + ".");
+}
+
+// Image and buffer URIs escape spaces and other characters of file names with %XX.
+std::string decodePercentEscapes(const std::string& uri)
+{
+  std::string result;
+  for (size_t i = 0; i < uri.size(); i++)
+  {
+    if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<ui8>(uri[i + 1])) &&
+        std::isxdigit(static_cast<ui8>(uri[i + 2])))
+    {
+      result += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    }
+    else
+    {
+      result += uri[i];
+    }
+  }
+  return result;
+}
+
+std::vector<ui8> decodeDataUri(const std::string& uri)
+{
+  const size_t separator = uri.find(',');
+  if (separator == std::string::npos || uri.rfind(";base64", separator) == std::string::npos)
+  {
+    throw std::runtime_error("Only base64 encoded data URIs are supported.");
+  }
+  std::vector<ui8> result;
+  result.reserve((uri.size() - separator) / 4 * 3);
+  ui32 bits  = 0;
+  ui32 nBits = 0;
+  for (size_t i = separator + 1; i < uri.size() && uri[i] != '='; i++)
+  {
+    const char c     = uri[i];
+    ui32       value = 0;
+    if (c >= 'A' && c <= 'Z')
+    {
+      value = static_cast<ui32>(c - 'A');
+    }
+    else if (c >= 'a' && c <= 'z')
+    {
+      value = static_cast<ui32>(c - 'a' + 26);
+    }
+    else if (c >= '0' && c <= '9')
+    {
+      value = static_cast<ui32>(c - '0' + 52);
+    }
+    else if (c == '+')
+    {
+      value = 62;
+    }
+    else if (c == '/')
+    {
+      value = 63;
+    }
+    else
+    {
+      throw std::runtime_error("Invalid character in a base64 encoded data URI.");
+    }
+    bits = (bits << 6) | value;
+    nBits += 6;
+    if (nBits >= 8)
+    {
+      nBits -= 8;
+      result.push_back(static_cast<ui8>(bits >> nBits));
+    }
+  }
+  return result;
+}
+
+ui32 getTextureIndex(const JsonValue& material, std::string_view key, ui32 nTextures)
+{
+  const JsonValue* textureInfo = material.find(key);
+  if (textureInfo == nullptr)
+  {
+    return GltfFile::invalidIdx;
+  }
+  const ui32 textureIdx = (*textureInfo)["index"].getIndex();
+  if (textureIdx >= nTextures)
+  {
+    throw std::runtime_error("Texture " + std::to_string(textureIdx) + " does not exist.");
+  }
+  return textureIdx;
+}
+
+f32 getFloat(const JsonValue& object, std::string_view key, f32 defaultValue)
+{
+  return static_cast<f32>(object.getNumber(key, defaultValue));
+}
+
+template <typename T> T getVector(const JsonValue& object, std::string_view key, const T& defaultValue)
+{
+  const JsonValue* array = object.find(key);
+  if (array == nullptr)
+  {
+    return defaultValue;
+  }
+  if (array->getElements().size() != static_cast<size_t>(T::length()))
+  {
+    throw std::runtime_error("Expected " + std::to_string(T::length()) + " numbers in \"" + std::string(key) + "\".");
+  }
+  T result;
+  for (ui32 i = 0; i < static_cast<ui32>(T::length()); i++)
+  {
+    result[i] = static_cast<f32>((*array)[i].getNumber());
+  }
+  return result;
+}
+
+// Missing members get the defaults of the specification.
+GltfMaterial readMaterial(const JsonValue& material, ui32 nTextures)
+{
+  const JsonValue  emptyObject = JsonValue::parse("{}");
+  const JsonValue* pbrMaterial = material.find("pbrMetallicRoughness");
+  const JsonValue& pbr         = pbrMaterial ? *pbrMaterial : emptyObject;
+  const JsonValue* extensions  = material.find("extensions");
+  const JsonValue* specular    = extensions ? extensions->find("KHR_materials_specular") : nullptr;
+  const JsonValue* glossiness  = extensions ? extensions->find("KHR_materials_pbrSpecularGlossiness") : nullptr;
+
+  GltfMaterial m;
+  m.name                      = material.find("name") ? material["name"].getString() : std::string();
+  m.baseColorFactor           = getVector(pbr, "baseColorFactor", f32v4(1.0f));
+  m.metallicFactor            = getFloat(pbr, "metallicFactor", 1.0f);
+  m.roughnessFactor           = getFloat(pbr, "roughnessFactor", 1.0f);
+  m.baseColorTexture          = getTextureIndex(pbr, "baseColorTexture", nTextures);
+  m.metallicRoughnessTexture  = getTextureIndex(pbr, "metallicRoughnessTexture", nTextures);
+  m.specularGlossinessTexture = GltfFile::invalidIdx;
+  m.normalTexture             = getTextureIndex(material, "normalTexture", nTextures);
+  m.occlusionTexture          = getTextureIndex(material, "occlusionTexture", nTextures);
+  m.emissiveTexture           = getTextureIndex(material, "emissiveTexture", nTextures);
+  m.emissiveFactor            = getVector(material, "emissiveFactor", f32v3(0.0f));
+  m.specularGlossiness        = false;
+  m.glossinessFactor          = 1.0f;
+  m.hasSpecularColor          = false;
+  m.specularColorFactor       = f32v3(1.0f);
+  if (specular != nullptr)
+  {
+    m.hasSpecularColor    = true;
+    m.specularColorFactor = getVector(*specular, "specularColorFactor", f32v3(1.0f));
+  }
+  if (glossiness != nullptr)
+  {
+    m.specularGlossiness        = true;
+    m.baseColorFactor           = getVector(*glossiness, "diffuseFactor", f32v4(1.0f));
+    m.baseColorTexture          = getTextureIndex(*glossiness, "diffuseTexture", nTextures);
+    m.hasSpecularColor          = true;
+    m.specularColorFactor       = getVector(*glossiness, "specularFactor", f32v3(1.0f));
+    m.glossinessFactor          = getFloat(*glossiness, "glossinessFactor", 1.0f);
+    m.specularGlossinessTexture = getTextureIndex(*glossiness, "specularGlossinessTexture", nTextures);
+  }
+  return m;
+}
+
+void checkIndex(ui32 idx, size_t size, const char* name)
+{
+  if (idx != GltfFile::invalidIdx && idx >= size)
+  {
+    throw std::runtime_error(std::string(name) + " " + std::to_string(idx) + " does not exist.");
+  }
+}
+} // namespace
+
+namespace gims
+{
+GltfFile::GltfFile()
+{
+}
+
+GltfFile::GltfFile(const std::filesystem::path& path)
+{
+  MappedFile       file(path);
+  std::string_view jsonText(reinterpret_cast<const char*>(file.getData()), file.getSize());
+  const ui8*       binaryChunk     = nullptr;
+  size_t           binaryChunkSize = 0;
+  if (file.getSize() >= 12 && readUi32(file.getData()) == glbMagic)
+  {
+    const ui8* data = file.getData();
+    const ui32 size = static_cast<ui32>(std::min(file.getSize(), static_cast<size_t>(readUi32(data + 8))));
+    if (readUi32(data + 4) != 2)
+    {
+      throw std::runtime_error(path.string() + " is not a glTF 2.0 binary file.");
+    }
+    jsonText = {};
+    for (ui32 offset = 12; offset + 8 <= size;)
+    {
+      const ui32 chunkSize = readUi32(data + offset);
+      const ui32 chunkType = readUi32(data + offset + 4);
+      offset += 8;
+      if (chunkSize > size - offset)
+      {
+        throw std::runtime_error("A chunk of " + path.string() + " exceeds the file.");
+      }
+      if (chunkType == glbJsonChunk && jsonText.empty())
+      {
+        jsonText = std::string_view(reinterpret_cast<const char*>(data + offset), chunkSize);
+      }
+      else if (chunkType == glbBinChunk && binaryChunk == nullptr)
+      {
+        binaryChunk     = data + offset;
+        binaryChunkSize = chunkSize;
+      }
+      offset += (chunkSize + 3) & ~3u;
+    }
+  }
+
+  JsonValue document;
+  try
+  {
+    document = JsonValue::parse(jsonText);
+  }
+  catch (const std::runtime_error& e)
+  {
+    throw std::runtime_error(path.string() + ": " + e.what());
+  }
+  const std::string& version = document["asset"]["version"].getString();
+  if (version.empty() || version[0] != '2')
+  {
+    throw std::runtime_error(path.string() + " has glTF version " + version + " instead of 2.0.");
+  }
+  if (const JsonValue* required = document.find("extensionsRequired"))
+  {
+    for (const auto& extension : required->getElements())
+    {
+      if (extension.getString() != "KHR_materials_specular" &&
+          extension.getString() != "KHR_materials_pbrSpecularGlossiness")
+      {
+        throw std::runtime_error(path.string() + " requires the unsupported extension " + extension.getString() + ".");
+      }
+    }
+  }
+  // The arrays of the document may all be missing.
+  const JsonValue emptyArray = JsonValue::parse("[]");
+  const auto      getArray   = [&](std::string_view key) -> const std::vector<JsonValue>&
+  {
+    const JsonValue* array = document.find(key);
+    return array ? array->getElements() : emptyArray.getElements();
+  };
+
+  const auto& buffers = getArray("buffers");
+  m_bufferData.reserve(buffers.size());
+  m_mappedFiles.reserve(buffers.size());
+  m_decodedBuffers.reserve(buffers.size());
+  for (size_t i = 0; i < buffers.size(); i++)
+  {
+    const size_t     byteLength = buffers[i]["byteLength"].getIndex();
+    const JsonValue* uri        = buffers[i].find("uri");
+    if (uri == nullptr)
+    {
+      if (i != 0 || binaryChunk == nullptr)
+      {
+        throw std::runtime_error("Buffer " + std::to_string(i) + " of " + path.string() + " has no data.");
+      }
+      m_bufferData.push_back(binaryChunk);
+      m_bufferSizes.push_back(binaryChunkSize);
+    }
+    else if (uri->getString().starts_with("data:"))
+    {
+      m_decodedBuffers.push_back(decodeDataUri(uri->getString()));
+      m_bufferData.push_back(m_decodedBuffers.back().data());
+      m_bufferSizes.push_back(m_decodedBuffers.back().size());
+    }
+    else
+    {
+      m_mappedFiles.emplace_back(path.parent_path() / std::filesystem::u8path(decodePercentEscapes(uri->getString())));
+      m_bufferData.push_back(m_mappedFiles.back().getData());
+      m_bufferSizes.push_back(m_mappedFiles.back().getSize());
+    }
+    if (m_bufferSizes.back() < byteLength)
+    {
+      throw std::runtime_error("Buffer " + std::to_string(i) + " of " + path.string() + " is too short.");
+    }
+  }
+  // The binary chunk is only needed if it is a buffer, otherwise the mapped file can be released.
+  if (binaryChunk != nullptr && !m_bufferData.empty() && m_bufferData[0] == binaryChunk)
+  {
+    m_mappedFiles.push_back(std::move(file));
+  }
+
+  for (const auto& bufferView : getArray("bufferViews"))
+  {
+    BufferView view;
+    view.buffer     = bufferView["buffer"].getIndex();
+    view.byteOffset = bufferView.getIndex("byteOffset", 0);
+    view.byteLength = bufferView["byteLength"].getIndex();
+    view.byteStride = bufferView.getIndex("byteStride", 0);
+    checkIndex(view.buffer, m_bufferData.size(), "Buffer");
+    if (static_cast<size_t>(view.byteOffset) + view.byteLength > m_bufferSizes[view.buffer])
+    {
+      throw std::runtime_error("A buffer view of " + path.string() + " exceeds its buffer.");
+    }
+    m_bufferViews.push_back(view);
+  }
+
+  for (const auto& accessor : getArray("accessors"))
+  {
+    if (accessor.find("sparse") != nullptr)
+    {
+      throw std::runtime_error(path.string() + " has sparse accessors, which are not supported.");
+    }
+    GltfAccessor a;
+    a.bufferView    = accessor.getIndex("bufferView", invalidIdx);
+    a.byteOffset    = accessor.getIndex("byteOffset", 0);
+    a.componentType = static_cast<GltfComponentType>(accessor["componentType"].getIndex());
+    a.nComponents   = getNumberOfComponents(accessor["type"].getString());
+    a.normalized    = accessor.find("normalized") != nullptr && accessor["normalized"].getBool();
+    a.count         = accessor["count"].getIndex();
+    checkIndex(a.bufferView, m_bufferViews.size(), "Buffer view");
+    const size_t elementSize = static_cast<size_t>(getComponentSize(a.componentType)) * a.nComponents;
+    if (a.bufferView != invalidIdx && a.count > 0)
+    {
+      const BufferView& view   = m_bufferViews[a.bufferView];
+      const size_t      stride = view.byteStride != 0 ? view.byteStride : elementSize;
+      if (a.byteOffset + stride * (a.count - 1) + elementSize > view.byteLength)
+      {
+        throw std::runtime_error("An accessor of " + path.string() + " exceeds its buffer view.");
+      }
+    }
+    m_accessors.push_back(a);
+  }
+
+  const auto& images = getArray("images");
+  for (const auto& image : images)
+  {
+    const JsonValue* uri = image.find("uri");
+    if (uri == nullptr || uri->getString().starts_with("data:"))
+    {
+      m_imagePaths.emplace_back();
+    }
+    else
+    {
+      m_imagePaths.push_back(std::filesystem::u8path(decodePercentEscapes(uri->getString())));
+    }
+  }
+  for (const auto& texture : getArray("textures"))
+  {
+    m_textureImages.push_back(texture.getIndex("source", invalidIdx));
+    checkIndex(m_textureImages.back(), images.size(), "Image");
+  }
+
+  for (const auto& material : getArray("materials"))
+  {
+    m_materials.push_back(readMaterial(material, static_cast<ui32>(m_textureImages.size())));
+  }
+
+  for (const auto& mesh : getArray("meshes"))
+  {
+    GltfMesh m;
+    m.name = mesh.find("name") ? mesh["name"].getString() : std::string();
+    for (const auto& primitive : mesh["primitives"].getElements())
+    {
+      const JsonValue& attributes = primitive["attributes"];
+      GltfPrimitive    p;
+      p.positions          = attributes.getIndex("POSITION", invalidIdx);
+      p.normals            = attributes.getIndex("NORMAL", invalidIdx);
+      p.textureCoordinates = attributes.getIndex("TEXCOORD_0", invalidIdx);
+      p.tangents           = attributes.getIndex("TANGENT", invalidIdx);
+      p.indices            = primitive.getIndex("indices", invalidIdx);
+      p.material           = primitive.getIndex("material", invalidIdx);
+      p.mode               = primitive.getIndex("mode", 4);
+      for (const ui32 accessor : {p.positions, p.normals, p.textureCoordinates, p.tangents, p.indices})
+      {
+        checkIndex(accessor, m_accessors.size(), "Accessor");
+      }
+      checkIndex(p.material, m_materials.size(), "Material");
+      m.primitives.push_back(p);
+    }
+    m_meshes.push_back(std::move(m));
+  }
+
+  const auto& nodes = getArray("nodes");
+  for (const auto& node : nodes)
+  {
+    GltfNode n;
+    n.name = node.find("name") ? node["name"].getString() : std::string();
+    n.mesh = node.getIndex("mesh", invalidIdx);
+    checkIndex(n.mesh, m_meshes.size(), "Mesh");
+    if (const JsonValue* children = node.find("children"))
+    {
+      for (const auto& child : children->getElements())
+      {
+        n.children.push_back(child.getIndex());
+        checkIndex(n.children.back(), nodes.size(), "Node");
+      }
+    }
+    if (const JsonValue* matrix = node.find("matrix"))
+    {
+      if (matrix->getElements().size() != 16)
+      {
+        throw std::runtime_error("Expected 16 numbers in the matrix of a node.");
+      }
+      // Column major, as in glm.
+      for (ui32 i = 0; i < 16; i++)
+      {
+        n.transformation[i / 4][i % 4] = static_cast<f32>((*matrix)[i].getNumber());
+      }
+    }
+    else
+    {
+      const f32v3 translation = getVector(node, "translation", f32v3(0.0f));
+      const f32v4 rotation    = getVector(node, "rotation", f32v4(0.0f, 0.0f, 0.0f, 1.0f));
+      const f32v3 scale       = getVector(node, "scale", f32v3(1.0f));
+      n.transformation        = glm::translate(f32m4(1.0f), translation) *
+                         glm::mat4_cast(f32q(rotation.w, rotation.x, rotation.y, rotation.z)) *
+                         glm::scale(f32m4(1.0f), scale);
+    }
+    m_nodes.push_back(std::move(n));
+  }
+
+  // The nodes have to form trees, so that the scene graph can be traversed from its roots.
+  std::vector<ui32> nParents(m_nodes.size(), 0);
+  for (const auto& node : m_nodes)
+  {
+    for (const ui32 child : node.children)
+    {
+      if (++nParents[child] > 1)
+      {
+        throw std::runtime_error("Node " + std::to_string(child) + " of " + path.string() + " has several parents.");
+      }
+    }
+  }
+  const auto& scenes = getArray("scenes");
+  if (scenes.empty())
+  {
+    for (ui32 i = 0; i < static_cast<ui32>(m_nodes.size()); i++)
+    {
+      if (nParents[i] == 0)
+      {
+        m_rootNodes.push_back(i);
+      }
+    }
+  }
+  else
+  {
+    const ui32 sceneIdx = document.getIndex("scene", 0);
+    checkIndex(sceneIdx, scenes.size(), "Scene");
+    if (const JsonValue* rootNodes = scenes[sceneIdx].find("nodes"))
+    {
+      for (const auto& root : rootNodes->getElements())
+      {
+        m_rootNodes.push_back(root.getIndex());
+        checkIndex(m_rootNodes.back(), m_nodes.size(), "Node");
+        if (nParents[m_rootNodes.back()] != 0)
+        {
+          throw std::runtime_error("Root node " + std::to_string(m_rootNodes.back()) + " of " + path.string() +
+                                   " has a parent.");
+        }
+      }
+    }
+  }
+}
+
+const std::vector<ui32>& GltfFile::getRootNodes() const
+{
+  return m_rootNodes;
+}
+
+const std::vector<GltfNode>& GltfFile::getNodes() const
+{
+  return m_nodes;
+}
+
+const std::vector<GltfMesh>& GltfFile::getMeshes() const
+{
+  return m_meshes;
+}
+
+const std::vector<GltfMaterial>& GltfFile::getMaterials() const
+{
+  return m_materials;
+}
+
+GltfMaterial GltfFile::getDefaultMaterial()
+{
+  return readMaterial(JsonValue::parse("{}"), 0);
+}
+
+const std::vector<GltfAccessor>& GltfFile::getAccessors() const
+{
+  return m_accessors;
+}
+
+ui32 GltfFile::getNumberOfTextures() const
+{
+  return static_cast<ui32>(m_textureImages.size());
+}
+
+const std::filesystem::path& GltfFile::getTextureImagePath(ui32 textureIdx) const
+{
+  if (textureIdx >= m_textureImages.size())
+  {
+    throw std::out_of_range("Texture " + std::to_string(textureIdx) + " does not exist.");
+  }
+  const ui32 imageIdx = m_textureImages[textureIdx];
+  if (imageIdx == invalidIdx || m_imagePaths[imageIdx].empty())
+  {
+    throw std::runtime_error("The image of texture " + std::to_string(textureIdx) +
+                             " is not in a file of its own, which is not supported.");
+  }
+  return m_imagePaths[imageIdx];
+}
+
+std::vector<ui32> GltfFile::readIndices(ui32 accessorIdx) const
+{
+  checkIndex(accessorIdx, m_accessors.size(), "Accessor");
+  std::vector<ui32> result;
+  switch (m_accessors[accessorIdx].componentType)
+  {
+  case GltfComponentType::UInt8:
+  {
+    const auto view = getAccessorView<ui8>(accessorIdx);
+    result.resize(view.size());
+    for (ui32 i = 0; i < view.size(); i++)
+    {
+      result[i] = view[i];
+    }
+    break;
+  }
+  case GltfComponentType::UInt16:
+  {
+    const auto view = getAccessorView<ui16>(accessorIdx);
+    result.resize(view.size());
+    for (ui32 i = 0; i < view.size(); i++)
+    {
+      result[i] = view[i];
+    }
+    break;
+  }
+  default:
+  {
+    const auto view = getAccessorView<ui32>(accessorIdx);
+    result.resize(view.size());
+    for (ui32 i = 0; i < view.size(); i++)
+    {
+      result[i] = view[i];
+    }
+    break;
+  }
+  }
+  return result;
+}
+
+const ui8* GltfFile::getAccessorData(ui32 accessorIdx, GltfComponentType componentType, ui32 nComponents,
+                                     ui32& stride) const
+{
+  if (accessorIdx >= m_accessors.size())
+  {
+    throw std::out_of_range("Accessor " + std::to_string(accessorIdx) + " does not exist.");
+  }
+  const GltfAccessor& accessor = m_accessors[accessorIdx];
+  if (accessor.componentType != componentType || accessor.nComponents != nComponents)
+  {
+    throw std::runtime_error("Accessor " + std::to_string(accessorIdx) + " has " +
+                             std::to_string(accessor.nComponents) + " components of type " +
+                             std::to_string(static_cast<ui32>(accessor.componentType)) + " instead of " +
+                             std::to_string(nComponents) + " of type " +
+                             std::to_string(static_cast<ui32>(componentType)) + ".");
+  }
+  if (accessor.bufferView == invalidIdx)
+  {
+    throw std::runtime_error("Accessor " + std::to_string(accessorIdx) + " is not in a buffer view.");
+  }
+  const BufferView& view = m_bufferViews[accessor.bufferView];
+  stride = view.byteStride != 0 ? view.byteStride : getComponentSize(componentType) * nComponents;
+  return m_bufferData[view.buffer] + view.byteOffset + accessor.byteOffset;
+}
+} // namespace gims
@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <gimslib/io/Json.hpp>
+#include <stdexcept>
+
+namespace
+{
+// Deeper documents are rejected instead of overflowing the stack of the recursive parser.
+const gims::ui32 maxDepth = 256;
+
+void appendUtf8(std::string& text, gims::ui32 codePoint)
+{
+  if (codePoint < 0x80)
+  {
+    text += static_cast<char>(codePoint);
+  }
+  else if (codePoint < 0x800)
+  {
+    text += static_cast<char>(0xc0 | (codePoint >> 6));
+    text += static_cast<char>(0x80 | (codePoint & 0x3f));
+  }
+  else
+  {
+    text += static_cast<char>(0xe0 | (codePoint >> 12));
+    text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    text += static_cast<char>(0x80 | (codePoint & 0x3f));
+  }
+}
+} // namespace
+
+namespace gims
+{
+// Recursive descent over the text, which reports the offset of the first error.
+class JsonParser
+{
+public:
+  explicit JsonParser(std::string_view text)
+      : m_text(text)
+      , m_position(0)
+  {
+  }
+
+  JsonValue parseDocument()
+  {
+    JsonValue result = parseValue(0);
+    skipWhitespace();
+    if (m_position != m_text.size())
+    {
+      fail("the end of the document");
+    }
+    return result;
+  }
+
+private:
+  JsonValue parseValue(ui32 depth)
+  {
+    if (depth == maxDepth)
+    {
+      fail("at most " + std::to_string(maxDepth) + " nested arrays and objects");
+    }
+    skipWhitespace();
+    JsonValue result;
+    const char c = m_position < m_text.size() ? m_text[m_position] : '\0';
+    if (c == '{')
+    {
+      m_position++;
+      result.m_type = JsonValue::Type::Object;
+      if (accept('}'))
+      {
+        return result;
+      }
+      do
+      {
+        skipWhitespace();
+        result.m_keys.push_back(parseString());
+        expect(':');
+        result.m_elements.push_back(parseValue(depth + 1));
+      } while (accept(','));
+      expect('}');
+    }
+    else if (c == '[')
+    {
+      m_position++;
+      result.m_type = JsonValue::Type::Array;
+      if (accept(']'))
+      {
+        return result;
+      }
+      do
+      {
+        result.m_elements.push_back(parseValue(depth + 1));
+      } while (accept(','));
+      expect(']');
+    }
+    else if (c == '"')
+    {
+      result.m_type   = JsonValue::Type::String;
+      result.m_string = parseString();
+    }
+    else if (acceptWord("true"))
+    {
+      result.m_type = JsonValue::Type::Bool;
+      result.m_bool = true;
+    }
+    else if (acceptWord("false"))
+    {
+      result.m_type = JsonValue::Type::Bool;
+    }
+    else if (acceptWord("null"))
+    {
+      result.m_type = JsonValue::Type::Null;
+    }
+    else
+    {
+      result.m_type   = JsonValue::Type::Number;
+      result.m_number = parseNumber();
+    }
+    return result;
+  }
+
+  std::string parseString()
+  {
+    if (m_position == m_text.size() || m_text[m_position] != '"')
+    {
+      fail("a string");
+    }
+    m_position++;
+    std::string result;
+    while (true)
+    {
+      // Appends the characters up to the next quote or escape at once, e.g., of long data URIs.
+      const size_t end = m_text.find_first_of("\"\\", m_position);
+      if (end == std::string_view::npos)
+      {
+        m_position = m_text.size();
+        fail("the end of the string");
+      }
+      result.append(m_text.substr(m_position, end - m_position));
+      m_position   = end;
+      const char c = m_text[m_position++];
+      if (c == '"')
+      {
+        return result;
+      }
+      if (m_position == m_text.size())
+      {
+        fail("an escape sequence");
+      }
+      const char escape = m_text[m_position++];
+      switch (escape)
+      {
+      case '"':
+      case '\\':
+      case '/':
+        result += escape;
+        break;
+      case 'b':
+        result += '\b';
+        break;
+      case 'f':
+        result += '\f';
+        break;
+      case 'n':
+        result += '\n';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      case 't':
+        result += '\t';
+        break;
+      case 'u':
+      {
+        ui32       codePoint = 0;
+        const auto end       = m_text.data() + std::min(m_position + 4, m_text.size());
+        const auto parsed    = std::from_chars(m_text.data() + m_position, end, codePoint, 16);
+        if (parsed.ec != std::errc() || parsed.ptr != m_text.data() + m_position + 4)
+        {
+          fail("four hexadecimal digits");
+        }
+        m_position += 4;
+        appendUtf8(result, codePoint);
+        break;
+      }
+      default:
+        m_position--;
+        fail("an escape sequence");
+      }
+    }
+  }
+
+  f64 parseNumber()
+  {
+    f64        result = 0.0;
+    const auto begin  = m_text.data() + m_position;
+    const auto parsed = std::from_chars(begin, m_text.data() + m_text.size(), result);
+    if (parsed.ec != std::errc() || !std::isfinite(result))
+    {
+      fail("a value");
+    }
+    m_position += static_cast<size_t>(parsed.ptr - begin);
+    return result;
+  }
+
+  void skipWhitespace()
+  {
+    while (m_position < m_text.size() && (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+                                          m_text[m_position] == '\n' || m_text[m_position] == '\r'))
+    {
+      m_position++;
+    }
+  }
+
+  bool accept(char c)
+  {
+    skipWhitespace();
+    if (m_position < m_text.size() && m_text[m_position] == c)
+    {
+      m_position++;
+      return true;
+    }
+    return false;
+  }
+
+  bool acceptWord(std::string_view word)
+  {
+    if (m_text.substr(m_position, word.size()) == word)
+    {
+      m_position += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c)
+  {
+    if (!accept(c))
+    {
+      fail(std::string("'") + c + "'");
+    }
+  }
+
+  [[noreturn]] void fail(const std::string& expected) const
+  {
+    throw std::runtime_error("Expected " + expected + " at offset " + std::to_string(m_position) + " of the JSON.");
+  }
+
+  std::string_view m_text;
+  size_t           m_position;
+};
+
+JsonValue::JsonValue()
+    : m_type(Type::Null)
+    , m_bool(false)
+    , m_number(0.0)
+{
+}
+
+JsonValue JsonValue::parse(std::string_view text)
+{
+  return JsonParser(text).parseDocument();
+}
+
+JsonValue::Type JsonValue::getType() const
+{
+  return m_type;
+}
+
+bool JsonValue::isNull() const
+{
+  return m_type == Type::Null;
+}
+
+bool JsonValue::isNumber() const
+{
+  return m_type == Type::Number;
+}
+
+bool JsonValue::isString() const
+{
+  return m_type == Type::String;
+}
+
+bool JsonValue::isArray() const
+{
+  return m_type == Type::Array;
+}
+
+bool JsonValue::isObject() const
+{
+  return m_type == Type::Object;
+}
+
+bool JsonValue::getBool() const
+{
+  if (m_type != Type::Bool)
+  {
+    throwTypeError("a boolean");
+  }
+  return m_bool;
+}
+
+f64 JsonValue::getNumber() const
+{
+  if (m_type != Type::Number)
+  {
+    throwTypeError("a number");
+  }
+  return m_number;
+}
+
+ui32 JsonValue::getIndex() const
+{
+  const f64 number = getNumber();
+  if (number < 0.0 || number > 4294967295.0 || number != std::floor(number))
+  {
+    throw std::runtime_error("Expected a non-negative integer instead of " + std::to_string(number) + ".");
+  }
+  return static_cast<ui32>(number);
+}
+
+const std::string& JsonValue::getString() const
+{
+  if (m_type != Type::String)
+  {
+    throwTypeError("a string");
+  }
+  return m_string;
+}
+
+const std::vector<JsonValue>& JsonValue::getElements() const
+{
+  if (m_type != Type::Array && m_type != Type::Object)
+  {
+    throwTypeError("an array or an object");
+  }
+  return m_elements;
+}
+
+const std::vector<std::string>& JsonValue::getKeys() const
+{
+  if (m_type != Type::Object)
+  {
+    throwTypeError("an object");
+  }
+  return m_keys;
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const
+{
+  for (size_t i = 0; i < getKeys().size(); i++)
+  {
+    if (m_keys[i] == key)
+    {
+      return &m_elements[i];
+    }
+  }
+  return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const
+{
+  const JsonValue* member = find(key);
+  if (member == nullptr)
+  {
+    throw std::runtime_error("The JSON object has no member \"" + std::string(key) + "\".");
+  }
+  return *member;
+}
+
+const JsonValue& JsonValue::operator[](size_t idx) const
+{
+  if (m_type != Type::Array)
+  {
+    throwTypeError("an array");
+  }
+  if (idx >= m_elements.size())
+  {
+    throw std::runtime_error("Index " + std::to_string(idx) + " is out of range of a JSON array of " +
+                             std::to_string(m_elements.size()) + " elements.");
+  }
+  return m_elements[idx];
+}
+
+f64 JsonValue::getNumber(std::string_view key, f64 defaultValue) const
+{
+  const JsonValue* member = find(key);
+  return member ? member->getNumber() : defaultValue;
+}
+
+ui32 JsonValue::getIndex(std::string_view key, ui32 defaultValue) const
+{
+  const JsonValue* member = find(key);
+  return member ? member->getIndex() : defaultValue;
+}
+
+void JsonValue::throwTypeError(const char* expected) const
+{
+  const char* typeNames[] = {"null", "a boolean", "a number", "a string", "an array", "an object"};
+  throw std::runtime_error(std::string("Expected ") + expected + " instead of " +
+                           typeNames[static_cast<ui32>(m_type)] + " in the JSON.");
+}
+} // namespace gims
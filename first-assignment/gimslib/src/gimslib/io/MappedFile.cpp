@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <gimslib/io/MappedFile.hpp>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gims
+{
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+{
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+    : MappedFile()
+{
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error("Unable to open " + path.string());
+  }
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(file, &size))
+  {
+    CloseHandle(file);
+    throw std::runtime_error("Unable to get the size of " + path.string());
+  }
+  if (size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return;
+  }
+  // The view keeps the mapping and the file open, so both handles can be closed right away.
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr)
+  {
+    throw std::runtime_error("Unable to map " + path.string());
+  }
+  const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == nullptr)
+  {
+    throw std::runtime_error("Unable to map " + path.string());
+  }
+  m_data = static_cast<const ui8*>(data);
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0)
+  {
+    throw std::runtime_error("Unable to open " + path.string());
+  }
+  struct stat status = {};
+  if (fstat(file, &status) != 0)
+  {
+    close(file);
+    throw std::runtime_error("Unable to get the size of " + path.string());
+  }
+  if (status.st_size == 0)
+  {
+    close(file);
+    return;
+  }
+  // The mapping keeps the file open, so the descriptor can be closed right away.
+  void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    throw std::runtime_error("Unable to map " + path.string());
+  }
+  m_data = static_cast<const ui8*>(data);
+  m_size = static_cast<size_t>(status.st_size);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+  unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    unmap();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+const ui8* MappedFile::getData() const
+{
+  return m_data;
+}
+
+size_t MappedFile::getSize() const
+{
+  return m_size;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const
+{
+  if (offset >= m_size)
+  {
+    return;
+  }
+  size = std::min(size, m_size - offset);
+#ifdef _WIN32
+  WIN32_MEMORY_RANGE_ENTRY range = {const_cast<ui8*>(m_data) + offset, size};
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+  // madvise takes page-aligned addresses, mappings start at a page.
+  const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t start    = offset / pageSize * pageSize;
+  madvise(const_cast<ui8*>(m_data) + start, offset + size - start, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::unmap()
+{
+  if (m_data == nullptr)
+  {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<ui8*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+} // namespace gims
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+// The header holds the magic, the version, the number of entries, and the offset and size of the table of contents.
+// Each entry of the table holds its offset, size, hash, type, and the length of its name, followed by the name and
+// padding to 8 bytes. All values are little-endian.
+const char packageMagic[8]         = {'G', 'I', 'M', 'S', 'P', 'A', 'K', '\0'};
+const ui32 packageVersion          = 2;
+const ui64 headerSize              = 32;
+const ui64 tocEntrySize            = 32;
+const ui32 maxNameSize             = 4096;
+const char zeros[packageAlignment] = {};
+
+ui32 readUi32(const ui8* data)
+{
+  return static_cast<ui32>(data[0]) | (static_cast<ui32>(data[1]) << 8) | (static_cast<ui32>(data[2]) << 16) |
+         (static_cast<ui32>(data[3]) << 24);
+}
+
+ui64 readUi64(const ui8* data)
+{
+  return static_cast<ui64>(readUi32(data)) | (static_cast<ui64>(readUi32(data + 4)) << 32);
+}
+
+void appendUi32(std::vector<ui8>& bytes, ui32 value)
+{
+  for (ui32 i = 0; i < 4; i++)
+  {
+    bytes.push_back(static_cast<ui8>(value >> (8 * i)));
+  }
+}
+
+void appendUi64(std::vector<ui8>& bytes, ui64 value)
+{
+  appendUi32(bytes, static_cast<ui32>(value));
+  appendUi32(bytes, static_cast<ui32>(value >> 32));
+}
+
+ui64 alignUp(ui64 value, ui64 alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+namespace gims
+{
+PackageWriter::PackageWriter(const std::filesystem::path& path)
+    : m_path(path)
+    , m_stream(path, std::ios::binary | std::ios::trunc)
+    , m_size(0)
+    , m_finished(false)
+{
+  if (!m_stream)
+  {
+    throw std::runtime_error("Unable to create " + path.string());
+  }
+  // Zeros instead of the header, which is written last.
+  m_stream.write(zeros, headerSize);
+  m_size = headerSize;
+}
+
+void PackageWriter::add(const std::string& name, PackageEntryType type, const void* data, size_t size)
+{
+  if (m_finished)
+  {
+    throw std::logic_error("Entries cannot be added to finished packages.");
+  }
+  if (name.empty() || name.size() > maxNameSize)
+  {
+    throw std::invalid_argument("Names of entries must have 1 to " + std::to_string(maxNameSize) + " characters.");
+  }
+  if (m_nameToEntryIdx.count(name) != 0)
+  {
+    throw std::invalid_argument("The package has an entry " + name + " already.");
+  }
+  pad(packageAlignment);
+  m_nameToEntryIdx[name] = static_cast<ui32>(m_entries.size());
+  m_entries.push_back({name, type, m_size, size, hashBytes(data, size)});
+  m_stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  m_size += size;
+  if (!m_stream)
+  {
+    throw std::runtime_error("Unable to write " + m_path.string());
+  }
+}
+
+void PackageWriter::finish()
+{
+  if (m_finished)
+  {
+    return;
+  }
+  std::vector<ui8> toc;
+  for (const auto& entry : m_entries)
+  {
+    appendUi64(toc, entry.offset);
+    appendUi64(toc, entry.size);
+    appendUi64(toc, entry.hash);
+    appendUi32(toc, static_cast<ui32>(entry.type));
+    appendUi32(toc, static_cast<ui32>(entry.name.size()));
+    toc.insert(toc.end(), entry.name.begin(), entry.name.end());
+    toc.resize(alignUp(toc.size(), 8), 0);
+  }
+  pad(packageAlignment);
+  const ui64 tocOffset = m_size;
+  m_stream.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size()));
+  m_size += toc.size();
+
+  std::vector<ui8> header(packageMagic, packageMagic + sizeof(packageMagic));
+  appendUi32(header, packageVersion);
+  appendUi32(header, static_cast<ui32>(m_entries.size()));
+  appendUi64(header, tocOffset);
+  appendUi64(header, toc.size());
+  m_stream.seekp(0);
+  m_stream.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+  m_stream.close();
+  if (!m_stream)
+  {
+    throw std::runtime_error("Unable to write " + m_path.string());
+  }
+  m_finished = true;
+}
+
+const std::vector<PackageEntry>& PackageWriter::getEntries() const
+{
+  return m_entries;
+}
+
+void PackageWriter::pad(ui64 alignment)
+{
+  const ui64 paddedSize = alignUp(m_size, alignment);
+  m_stream.write(zeros, static_cast<std::streamsize>(paddedSize - m_size));
+  m_size = paddedSize;
+}
+
+PackageFile::PackageFile(const std::filesystem::path& path)
+    : m_file(path)
+{
+  const ui8* data = m_file.getData();
+  const ui64 size = m_file.getSize();
+  if (size < headerSize || std::memcmp(data, packageMagic, sizeof(packageMagic)) != 0)
+  {
+    throw std::runtime_error(path.string() + " is no package.");
+  }
+  const ui32 version = readUi32(data + 8);
+  if (version != packageVersion)
+  {
+    throw std::runtime_error(path.string() + " is a package of version " + std::to_string(version) + " instead of " +
+                             std::to_string(packageVersion) + ".");
+  }
+  const ui32 nEntries  = readUi32(data + 12);
+  const ui64 tocOffset = readUi64(data + 16);
+  const ui64 tocSize   = readUi64(data + 24);
+  if (tocOffset > size || tocSize > size - tocOffset || tocSize < static_cast<ui64>(nEntries) * tocEntrySize)
+  {
+    throw std::runtime_error(path.string() + ": The table of contents exceeds the file.");
+  }
+
+  // The payloads are read ahead in one pass, in the background while the table of contents is parsed, instead of
+  // page by page when they are touched.
+  m_file.prefetch(0, size);
+
+  m_entries.reserve(nEntries);
+  ui64 position = tocOffset;
+  for (ui32 entryIdx = 0; entryIdx < nEntries; entryIdx++)
+  {
+    if (tocOffset + tocSize - position < tocEntrySize)
+    {
+      throw std::runtime_error(path.string() + ": The table of contents is truncated.");
+    }
+    PackageEntry entry;
+    entry.offset        = readUi64(data + position);
+    entry.size          = readUi64(data + position + 8);
+    entry.hash          = readUi64(data + position + 16);
+    entry.type          = static_cast<PackageEntryType>(readUi32(data + position + 24));
+    const ui32 nameSize = readUi32(data + position + 28);
+    position += tocEntrySize;
+    if (nameSize == 0 || nameSize > maxNameSize || tocOffset + tocSize - position < nameSize)
+    {
+      throw std::runtime_error(path.string() + ": The name of entry " + std::to_string(entryIdx) + " is corrupt.");
+    }
+    entry.name.assign(reinterpret_cast<const char*>(data + position), nameSize);
+    position = alignUp(position + nameSize, 8);
+    if (entry.offset % packageAlignment != 0 || entry.offset > tocOffset || entry.size > tocOffset - entry.offset)
+    {
+      throw std::runtime_error(path.string() + ": Entry " + entry.name + " exceeds the payloads.");
+    }
+    if (!m_nameToEntryIdx.emplace(entry.name, entryIdx).second)
+    {
+      throw std::runtime_error(path.string() + ": Entry " + entry.name + " exists twice.");
+    }
+    m_entries.push_back(std::move(entry));
+  }
+}
+
+const std::vector<PackageEntry>& PackageFile::getEntries() const
+{
+  return m_entries;
+}
+
+ui32 PackageFile::find(const std::string& name) const
+{
+  const auto it = m_nameToEntryIdx.find(name);
+  return it == m_nameToEntryIdx.end() ? invalidIdx : it->second;
+}
+
+const ui8* PackageFile::getData(ui32 entryIdx) const
+{
+  return m_file.getData() + m_entries.at(entryIdx).offset;
+}
+
+bool PackageFile::verify(ui32 entryIdx) const
+{
+  const PackageEntry& entry = m_entries.at(entryIdx);
+  return hashBytes(getData(entryIdx), static_cast<size_t>(entry.size)) == entry.hash;
+}
+
+bool isPackageFile(const std::filesystem::path& path)
+{
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+  return extension == ".gpak";
+}
+} // namespace gims
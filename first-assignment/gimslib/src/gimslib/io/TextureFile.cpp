@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <gimslib/io/TextureFile.hpp>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+using namespace gims;
+
+constexpr ui32 makeFourCC(char c0, char c1, char c2, char c3)
+{
+  return static_cast<ui32>(static_cast<ui8>(c0)) | (static_cast<ui32>(static_cast<ui8>(c1)) << 8) |
+         (static_cast<ui32>(static_cast<ui8>(c2)) << 16) | (static_cast<ui32>(static_cast<ui8>(c3)) << 24);
+}
+
+// "DDS ", followed by the DDS_HEADER, and the DDS_HEADER_DXT10 if the four character code is "DX10".
+const ui32 ddsMagic          = makeFourCC('D', 'D', 'S', ' ');
+const ui32 ddsHeaderSize     = 124;
+const ui32 ddsDx10HeaderSize = 20;
+const ui32 ddsFlagMipMapCount = 0x20000;
+const ui32 ddsPixelFlagFourCC = 0x4;
+const ui32 ddsPixelFlagRgb    = 0x40;
+const ui32 ddsCaps2Cubemap    = 0x200;
+const ui32 ddsCaps2Volume     = 0x200000;
+const ui32 ddsDimension2D     = 3;
+const ui32 ddsMiscFlagCube    = 0x4;
+
+// Identifier, header, and index of a KTX2 file, followed by the level index with 24 bytes per level.
+const ui8  ktx2Identifier[12]   = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+const ui32 ktx2LevelIndexOffset = 80;
+const ui32 ktx2LevelIndexStride = 24;
+
+ui32 readUi32(const ui8* data)
+{
+  ui32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+ui64 readUi64(const ui8* data)
+{
+  ui64 value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void appendUi32(std::vector<ui8>& bytes, ui32 value)
+{
+  for (ui32 i = 0; i < 4; i++)
+  {
+    bytes.push_back(static_cast<ui8>(value >> (8 * i)));
+  }
+}
+
+// Computes the layout of the levels of a file, whose sizes and number of levels are checked like the rest of it.
+std::vector<TextureSubresource> computeFileSubresources(TextureFormat format, ui32 width, ui32 height, ui32 nLevels,
+                                                        size_t offset)
+{
+  try
+  {
+    return computeTextureSubresources(format, width, height, nLevels, offset);
+  }
+  catch (const std::invalid_argument& e)
+  {
+    throw std::runtime_error(e.what());
+  }
+}
+
+bool isSupportedFormat(TextureFormat format)
+{
+  switch (format)
+  {
+  case TextureFormat::R16G16B16A16Float:
+  case TextureFormat::R8G8B8A8Unorm:
+  case TextureFormat::R8G8B8A8UnormSrgb:
+  case TextureFormat::R8G8Unorm:
+  case TextureFormat::R8Unorm:
+  case TextureFormat::BC1Unorm:
+  case TextureFormat::BC1UnormSrgb:
+  case TextureFormat::BC2Unorm:
+  case TextureFormat::BC2UnormSrgb:
+  case TextureFormat::BC3Unorm:
+  case TextureFormat::BC3UnormSrgb:
+  case TextureFormat::BC4Unorm:
+  case TextureFormat::BC4Snorm:
+  case TextureFormat::BC5Unorm:
+  case TextureFormat::BC5Snorm:
+  case TextureFormat::B8G8R8A8Unorm:
+  case TextureFormat::B8G8R8A8UnormSrgb:
+  case TextureFormat::BC6HUF16:
+  case TextureFormat::BC6HSF16:
+  case TextureFormat::BC7Unorm:
+  case TextureFormat::BC7UnormSrgb:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Formats of files without DX10 header, which have no SRGB variants.
+TextureFormat getLegacyDdsFormat(const ui8* pixelFormat)
+{
+  const ui32 flags  = readUi32(pixelFormat + 4);
+  const ui32 fourCC = readUi32(pixelFormat + 8);
+  if (flags & ddsPixelFlagFourCC)
+  {
+    switch (fourCC)
+    {
+    case makeFourCC('D', 'X', 'T', '1'):
+      return TextureFormat::BC1Unorm;
+    case makeFourCC('D', 'X', 'T', '2'):
+    case makeFourCC('D', 'X', 'T', '3'):
+      return TextureFormat::BC2Unorm;
+    case makeFourCC('D', 'X', 'T', '4'):
+    case makeFourCC('D', 'X', 'T', '5'):
+      return TextureFormat::BC3Unorm;
+    case makeFourCC('A', 'T', 'I', '1'):
+    case makeFourCC('B', 'C', '4', 'U'):
+      return TextureFormat::BC4Unorm;
+    case makeFourCC('B', 'C', '4', 'S'):
+      return TextureFormat::BC4Snorm;
+    case makeFourCC('A', 'T', 'I', '2'):
+    case makeFourCC('B', 'C', '5', 'U'):
+      return TextureFormat::BC5Unorm;
+    case makeFourCC('B', 'C', '5', 'S'):
+      return TextureFormat::BC5Snorm;
+    case 113: // D3DFMT_A16B16G16R16F
+      return TextureFormat::R16G16B16A16Float;
+    default:
+      return TextureFormat::Unknown;
+    }
+  }
+  const ui32 rgbBitCount = readUi32(pixelFormat + 12);
+  const ui32 redMask     = readUi32(pixelFormat + 16);
+  const ui32 blueMask    = readUi32(pixelFormat + 24);
+  if ((flags & ddsPixelFlagRgb) && rgbBitCount == 32)
+  {
+    if (redMask == 0x000000FF && blueMask == 0x00FF0000)
+    {
+      return TextureFormat::R8G8B8A8Unorm;
+    }
+    if (redMask == 0x00FF0000 && blueMask == 0x000000FF)
+    {
+      return TextureFormat::B8G8R8A8Unorm;
+    }
+  }
+  return TextureFormat::Unknown;
+}
+
+TextureHeader readDdsHeader(const ui8* data, size_t size)
+{
+  if (size < 4 + ddsHeaderSize || readUi32(data + 4) != ddsHeaderSize)
+  {
+    throw std::runtime_error("The DDS header is truncated.");
+  }
+  const ui8* header  = data + 4;
+  const ui32 flags   = readUi32(header + 4);
+  const ui32 height  = readUi32(header + 8);
+  const ui32 width   = readUi32(header + 12);
+  const ui32 nLevels = (flags & ddsFlagMipMapCount) ? std::max(1u, readUi32(header + 24)) : 1;
+  const ui32 caps2   = readUi32(header + 108);
+  if (caps2 & (ddsCaps2Cubemap | ddsCaps2Volume))
+  {
+    throw std::runtime_error("Cube maps and volume textures are not supported, only 2D textures.");
+  }
+
+  TextureFormat format     = TextureFormat::Unknown;
+  size_t        dataOffset = 4 + ddsHeaderSize;
+  const ui8*    pixelFormat = header + 72;
+  if ((readUi32(pixelFormat + 4) & ddsPixelFlagFourCC) && readUi32(pixelFormat + 8) == makeFourCC('D', 'X', '1', '0'))
+  {
+    if (size < dataOffset + ddsDx10HeaderSize)
+    {
+      throw std::runtime_error("The DX10 header is truncated.");
+    }
+    const ui8* dx10Header = data + dataOffset;
+    format                = static_cast<TextureFormat>(readUi32(dx10Header));
+    if (readUi32(dx10Header + 4) != ddsDimension2D || (readUi32(dx10Header + 8) & ddsMiscFlagCube) ||
+        readUi32(dx10Header + 12) > 1)
+    {
+      throw std::runtime_error("Cube maps, arrays, 1D, and 3D textures are not supported, only 2D textures.");
+    }
+    dataOffset += ddsDx10HeaderSize;
+  }
+  else
+  {
+    format = getLegacyDdsFormat(pixelFormat);
+  }
+  if (!isSupportedFormat(format))
+  {
+    throw std::runtime_error("The DDS format " + std::to_string(static_cast<ui32>(format)) + " is not supported.");
+  }
+  return {format, width, height, computeFileSubresources(format, width, height, nLevels, dataOffset)};
+}
+
+TextureFormat getKtx2Format(ui32 vkFormat)
+{
+  switch (vkFormat)
+  {
+  case 9: // VK_FORMAT_R8_UNORM
+    return TextureFormat::R8Unorm;
+  case 16: // VK_FORMAT_R8G8_UNORM
+    return TextureFormat::R8G8Unorm;
+  case 37: // VK_FORMAT_R8G8B8A8_UNORM
+    return TextureFormat::R8G8B8A8Unorm;
+  case 43: // VK_FORMAT_R8G8B8A8_SRGB
+    return TextureFormat::R8G8B8A8UnormSrgb;
+  case 44: // VK_FORMAT_B8G8R8A8_UNORM
+    return TextureFormat::B8G8R8A8Unorm;
+  case 50: // VK_FORMAT_B8G8R8A8_SRGB
+    return TextureFormat::B8G8R8A8UnormSrgb;
+  case 97: // VK_FORMAT_R16G16B16A16_SFLOAT
+    return TextureFormat::R16G16B16A16Float;
+  case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+  case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    return TextureFormat::BC1Unorm;
+  case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+  case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+    return TextureFormat::BC1UnormSrgb;
+  case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+    return TextureFormat::BC2Unorm;
+  case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+    return TextureFormat::BC2UnormSrgb;
+  case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+    return TextureFormat::BC3Unorm;
+  case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+    return TextureFormat::BC3UnormSrgb;
+  case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+    return TextureFormat::BC4Unorm;
+  case 140: // VK_FORMAT_BC4_SNORM_BLOCK
+    return TextureFormat::BC4Snorm;
+  case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+    return TextureFormat::BC5Unorm;
+  case 142: // VK_FORMAT_BC5_SNORM_BLOCK
+    return TextureFormat::BC5Snorm;
+  case 143: // VK_FORMAT_BC6H_UFLOAT_BLOCK
+    return TextureFormat::BC6HUF16;
+  case 144: // VK_FORMAT_BC6H_SFLOAT_BLOCK
+    return TextureFormat::BC6HSF16;
+  case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+    return TextureFormat::BC7Unorm;
+  case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+    return TextureFormat::BC7UnormSrgb;
+  default:
+    return TextureFormat::Unknown;
+  }
+}
+
+TextureHeader readKtx2Header(const ui8* data, size_t size)
+{
+  if (size < ktx2LevelIndexOffset)
+  {
+    throw std::runtime_error("The KTX2 header is truncated.");
+  }
+  const ui32 vkFormat         = readUi32(data + 12);
+  const ui32 width            = readUi32(data + 20);
+  const ui32 height           = readUi32(data + 24);
+  const ui32 depth            = readUi32(data + 28);
+  const ui32 nLayers          = readUi32(data + 32);
+  const ui32 nFaces           = readUi32(data + 36);
+  const ui32 nLevels          = std::max(1u, readUi32(data + 40)); // 0 asks the loader to create the mip levels.
+  const ui32 supercompression = readUi32(data + 44);
+  if (supercompression != 0)
+  {
+    throw std::runtime_error("Supercompressed KTX2 files, e.g., Basis Universal or Zstandard, are not supported.");
+  }
+  if (height == 0 || depth != 0 || nLayers > 1 || nFaces != 1)
+  {
+    throw std::runtime_error("Cube maps, arrays, 1D, and 3D textures are not supported, only 2D textures.");
+  }
+  const TextureFormat format = getKtx2Format(vkFormat);
+  if (format == TextureFormat::Unknown)
+  {
+    throw std::runtime_error("The KTX2 format " + std::to_string(vkFormat) + " is not supported.");
+  }
+  if (size < ktx2LevelIndexOffset + static_cast<size_t>(nLevels) * ktx2LevelIndexStride)
+  {
+    throw std::runtime_error("The level index of the KTX2 file is truncated.");
+  }
+
+  // Levels are tightly packed within, but may be stored in any order, usually the smallest first.
+  TextureHeader header = {format, width, height, computeFileSubresources(format, width, height, nLevels, 0)};
+  for (ui32 level = 0; level < nLevels; level++)
+  {
+    const ui8* entry      = data + ktx2LevelIndexOffset + static_cast<size_t>(level) * ktx2LevelIndexStride;
+    const ui64 byteOffset = readUi64(entry);
+    const ui64 byteLength = readUi64(entry + 8);
+    if (byteLength != header.mipLevels[level].size)
+    {
+      throw std::runtime_error("Level " + std::to_string(level) + " of the KTX2 file has " +
+                               std::to_string(byteLength) + " bytes instead of " +
+                               std::to_string(header.mipLevels[level].size) + ".");
+    }
+    header.mipLevels[level].offset = static_cast<size_t>(byteOffset);
+  }
+  return header;
+}
+} // namespace
+
+namespace gims
+{
+bool isBlockCompressed(TextureFormat format)
+{
+  const ui32 value = static_cast<ui32>(format);
+  return (value >= static_cast<ui32>(TextureFormat::BC1Unorm) && value <= static_cast<ui32>(TextureFormat::BC5Snorm)) ||
+         (value >= static_cast<ui32>(TextureFormat::BC6HUF16) && value <= static_cast<ui32>(TextureFormat::BC7UnormSrgb));
+}
+
+ui32 getBytesPerBlock(TextureFormat format)
+{
+  switch (format)
+  {
+  case TextureFormat::R8Unorm:
+    return 1;
+  case TextureFormat::R8G8Unorm:
+    return 2;
+  case TextureFormat::R8G8B8A8Unorm:
+  case TextureFormat::R8G8B8A8UnormSrgb:
+  case TextureFormat::B8G8R8A8Unorm:
+  case TextureFormat::B8G8R8A8UnormSrgb:
+    return 4;
+  case TextureFormat::R16G16B16A16Float:
+    return 8;
+  case TextureFormat::BC1Unorm:
+  case TextureFormat::BC1UnormSrgb:
+  case TextureFormat::BC4Unorm:
+  case TextureFormat::BC4Snorm:
+    return 8;
+  case TextureFormat::BC2Unorm:
+  case TextureFormat::BC2UnormSrgb:
+  case TextureFormat::BC3Unorm:
+  case TextureFormat::BC3UnormSrgb:
+  case TextureFormat::BC5Unorm:
+  case TextureFormat::BC5Snorm:
+  case TextureFormat::BC6HUF16:
+  case TextureFormat::BC6HSF16:
+  case TextureFormat::BC7Unorm:
+  case TextureFormat::BC7UnormSrgb:
+    return 16;
+  default:
+    throw std::invalid_argument("Unknown texture format " + std::to_string(static_cast<ui32>(format)) + ".");
+  }
+}
+
+TextureFormat getSrgbFormat(TextureFormat format)
+{
+  switch (format)
+  {
+  case TextureFormat::R8G8B8A8Unorm:
+    return TextureFormat::R8G8B8A8UnormSrgb;
+  case TextureFormat::B8G8R8A8Unorm:
+    return TextureFormat::B8G8R8A8UnormSrgb;
+  case TextureFormat::BC1Unorm:
+    return TextureFormat::BC1UnormSrgb;
+  case TextureFormat::BC2Unorm:
+    return TextureFormat::BC2UnormSrgb;
+  case TextureFormat::BC3Unorm:
+    return TextureFormat::BC3UnormSrgb;
+  case TextureFormat::BC7Unorm:
+    return TextureFormat::BC7UnormSrgb;
+  default:
+    return format;
+  }
+}
+
+std::vector<TextureSubresource> computeTextureSubresources(TextureFormat format, ui32 width, ui32 height,
+                                                           ui32 nMipLevels, size_t offset)
+{
+  const ui32 bytesPerBlock = getBytesPerBlock(format);
+  if (width == 0 || height == 0)
+  {
+    throw std::invalid_argument("Textures must not be empty.");
+  }
+  ui32 maxMipLevels = 1;
+  while ((std::max(width, height) >> maxMipLevels) != 0)
+  {
+    maxMipLevels++;
+  }
+  if (nMipLevels == 0 || nMipLevels > maxMipLevels)
+  {
+    throw std::invalid_argument("A texture of " + std::to_string(width) + "x" + std::to_string(height) + " has " +
+                                std::to_string(nMipLevels) + " mip levels instead of 1 to " +
+                                std::to_string(maxMipLevels) + ".");
+  }
+
+  const ui32                      blockSize = isBlockCompressed(format) ? 4 : 1;
+  std::vector<TextureSubresource> result(nMipLevels);
+  for (ui32 level = 0; level < nMipLevels; level++)
+  {
+    TextureSubresource& subresource = result[level];
+    subresource.width               = std::max(1u, width >> level);
+    subresource.height              = std::max(1u, height >> level);
+    const ui64 rowPitch =
+        static_cast<ui64>((subresource.width + blockSize - 1) / blockSize) * bytesPerBlock;
+    if (rowPitch > std::numeric_limits<ui32>::max())
+    {
+      throw std::invalid_argument("A row of the texture exceeds 4 GB.");
+    }
+    subresource.rowPitch = static_cast<ui32>(rowPitch);
+    subresource.nRows    = (subresource.height + blockSize - 1) / blockSize;
+    subresource.offset   = offset;
+    subresource.size     = static_cast<size_t>(subresource.rowPitch) * subresource.nRows;
+    offset += subresource.size;
+  }
+  return result;
+}
+
+TextureHeader readTextureHeader(const ui8* data, size_t size)
+{
+  TextureHeader header;
+  if (size >= 4 && readUi32(data) == ddsMagic)
+  {
+    header = readDdsHeader(data, size);
+  }
+  else if (size >= sizeof(ktx2Identifier) && std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0)
+  {
+    header = readKtx2Header(data, size);
+  }
+  else
+  {
+    throw std::runtime_error("The data is neither a DDS nor a KTX2 file.");
+  }
+  for (size_t level = 0; level < header.mipLevels.size(); level++)
+  {
+    const auto& mipLevel = header.mipLevels[level];
+    if (mipLevel.offset > size || mipLevel.size > size - mipLevel.offset)
+    {
+      throw std::runtime_error("Mip level " + std::to_string(level) + " exceeds the file.");
+    }
+  }
+  return header;
+}
+
+TextureFile::TextureFile(const std::filesystem::path& path)
+    : m_file(path)
+{
+  try
+  {
+    m_header = readTextureHeader(m_file.getData(), m_file.getSize());
+  }
+  catch (const std::runtime_error& e)
+  {
+    throw std::runtime_error(path.string() + ": " + e.what());
+  }
+}
+
+const TextureHeader& TextureFile::getHeader() const
+{
+  return m_header;
+}
+
+const ui8* TextureFile::getMipLevelData(ui32 mipLevel) const
+{
+  return m_file.getData() + m_header.mipLevels.at(mipLevel).offset;
+}
+
+bool isTextureContainerFile(const std::filesystem::path& path)
+{
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+  return extension == ".dds" || extension == ".ktx2";
+}
+
+std::filesystem::path findTextureContainerFile(const std::filesystem::path& imagePath)
+{
+  for (const char* extension : {".dds", ".ktx2"})
+  {
+    const auto containerPath = std::filesystem::path(imagePath).replace_extension(extension);
+    if (containerPath != imagePath && std::filesystem::exists(containerPath))
+    {
+      return containerPath;
+    }
+  }
+  return imagePath;
+}
+
+bool isTextureContainer(const ui8* data, size_t size)
+{
+  return (size >= 4 && readUi32(data) == ddsMagic) ||
+         (size >= sizeof(ktx2Identifier) && std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0);
+}
+
+std::vector<ui8> createDdsFile(TextureFormat format, ui32 width, ui32 height,
+                               const std::vector<std::vector<ui8>>& mipLevels)
+{
+  const auto layout =
+      computeTextureSubresources(format, width, height, static_cast<ui32>(mipLevels.size()), 0);
+  for (size_t level = 0; level < layout.size(); level++)
+  {
+    if (mipLevels[level].size() != layout[level].size)
+    {
+      throw std::invalid_argument("Mip level " + std::to_string(level) + " has " +
+                                  std::to_string(mipLevels[level].size()) + " bytes instead of " +
+                                  std::to_string(layout[level].size) + ".");
+    }
+  }
+
+  std::vector<ui8> result;
+  appendUi32(result, ddsMagic);
+  appendUi32(result, ddsHeaderSize);
+  appendUi32(result, 0x1 | 0x2 | 0x4 | 0x1000 | ddsFlagMipMapCount); // Caps, height, width, pixel format.
+  appendUi32(result, height);
+  appendUi32(result, width);
+  appendUi32(result, 0);
+  appendUi32(result, 0);
+  appendUi32(result, static_cast<ui32>(mipLevels.size()));
+  result.resize(result.size() + 11 * 4, 0);
+  appendUi32(result, 32); // Size of the pixel format.
+  appendUi32(result, ddsPixelFlagFourCC);
+  appendUi32(result, makeFourCC('D', 'X', '1', '0'));
+  result.resize(result.size() + 5 * 4, 0);
+  appendUi32(result, 0x1000 | (mipLevels.size() > 1 ? 0x400008 : 0)); // Texture, and mip map and complex.
+  result.resize(result.size() + 4 * 4, 0);
+  appendUi32(result, static_cast<ui32>(format));
+  appendUi32(result, ddsDimension2D);
+  appendUi32(result, 0);
+  appendUi32(result, 1);
+  appendUi32(result, 0);
+  for (const auto& mipLevel : mipLevels)
+  {
+    result.insert(result.end(), mipLevel.begin(), mipLevel.end());
+  }
+  return result;
+}
+
+void saveDdsFile(const std::filesystem::path& path, TextureFormat format, ui32 width, ui32 height,
+                 const std::vector<std::vector<ui8>>& mipLevels)
+{
+  const auto    file = createDdsFile(format, width, height, mipLevels);
+  std::ofstream stream(path, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+}
+} // namespace gims
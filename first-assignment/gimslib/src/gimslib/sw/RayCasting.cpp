@@ -0,0 +1,873 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <gimslib/sw/RayCasting.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+#include <string>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GIMS_RAY_CASTING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+using namespace gims;
+
+// Number of bins per axis that the split positions are chosen from.
+const ui32 nBins = 16;
+// Cost of testing a block of primitives, relative to testing a node, for the surface area heuristic.
+const f32 blockCost = 1.0f;
+// Number of triangles per block of a TriangleBvh.
+const ui32 trianglesPerBlock = 4;
+// Largest number of instances of a leaf of a RayCastingScene.
+const ui32 maxInstancesPerLeaf = 4;
+// Ranges with at least this many primitives are binned in parallel, in chunks of the same size.
+const ui32 parallelChunkSize = 16384;
+// Subtrees with fewer primitives are built by a single task.
+const ui32 minSubtreeSize = 4096;
+// Meshes with at least this many triangles are built with all threads by createTriangleBvhs.
+const ui32 minParallelMeshSize = 65536;
+// Marks nodes of the upper levels that are replaced by a subtree.
+const ui32 subtreeCount = ~0u;
+
+BvhBounds getEmptyBounds()
+{
+  const f32 infinity = std::numeric_limits<f32>::infinity();
+  return {f32v3(infinity), f32v3(-infinity)};
+}
+
+void grow(BvhBounds& bounds, const f32v3& point)
+{
+  bounds.lowerLeftBottom = glm::min(bounds.lowerLeftBottom, point);
+  bounds.upperRightTop   = glm::max(bounds.upperRightTop, point);
+}
+
+void grow(BvhBounds& bounds, const BvhBounds& other)
+{
+  bounds.lowerLeftBottom = glm::min(bounds.lowerLeftBottom, other.lowerLeftBottom);
+  bounds.upperRightTop   = glm::max(bounds.upperRightTop, other.upperRightTop);
+}
+
+// Half of the surface area, which is all the heuristic needs. 0 for empty bounds.
+f32 getArea(const BvhBounds& bounds)
+{
+  const f32v3 extent = glm::max(bounds.upperRightTop - bounds.lowerLeftBottom, f32v3(0.0f));
+  return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+f32 getArea(const BvhNode& node)
+{
+  return getArea(BvhBounds {node.lowerLeftBottom, node.upperRightTop});
+}
+
+ui32 getNumberOfBlocks(ui32 nPrimitives, ui32 blockSize)
+{
+  return (nPrimitives + blockSize - 1) / blockSize;
+}
+
+struct Bin
+{
+  BvhBounds bounds = getEmptyBounds();
+  ui32      count  = 0;
+};
+
+struct Bins
+{
+  std::array<std::array<Bin, nBins>, 3> axes;
+
+  void merge(const Bins& other)
+  {
+    for (ui32 axis = 0; axis < 3; axis++)
+    {
+      for (ui32 i = 0; i < nBins; i++)
+      {
+        grow(axes[axis][i].bounds, other.axes[axis][i].bounds);
+        axes[axis][i].count += other.axes[axis][i].count;
+      }
+    }
+  }
+};
+
+// Bounds of the primitives of a node and of their centroids, which the bins divide.
+struct RangeBounds
+{
+  BvhBounds bounds         = getEmptyBounds();
+  BvhBounds centroidBounds = getEmptyBounds();
+
+  void merge(const RangeBounds& other)
+  {
+    grow(bounds, other.bounds);
+    grow(centroidBounds, other.centroidBounds);
+  }
+};
+
+// A range of primitives whose subtree is built by a single task.
+struct Subtree
+{
+  ui32 begin;
+  ui32 end;
+  ui32 depth;
+};
+
+// Bounds of a primitive with its index. The references are partitioned in place, so the primitives of each node are
+// consecutive in memory.
+struct PrimitiveReference
+{
+  f32v3 lowerLeftBottom;
+  ui32  primitiveIdx;
+  f32v3 upperRightTop;
+
+  // Twice the center of the bounds, which orders and bins like the center.
+  f32v3 getCentroid() const
+  {
+    return lowerLeftBottom + upperRightTop;
+  }
+};
+
+struct BvhBuilder
+{
+  std::vector<PrimitiveReference> references;
+  ui32                            maxLeafSize;
+  ui32                            blockSize; //! Primitives that are tested at once, the cost of a leaf.
+};
+
+// Calls chunkFunction(begin, end, result) for the range, in chunks on all threads if the range is large.
+template <typename Result, typename ChunkFunction>
+Result reduceRange(ThreadPool* threadPool, ui32 begin, ui32 end, const ChunkFunction& chunkFunction)
+{
+  Result result;
+  if (!threadPool || end - begin < 2 * parallelChunkSize)
+  {
+    chunkFunction(begin, end, result);
+    return result;
+  }
+  const ui32          nChunks = (end - begin + parallelChunkSize - 1) / parallelChunkSize;
+  std::vector<Result> chunkResults(nChunks);
+  threadPool->parallelFor(nChunks,
+                          [&](ui32 chunkIdx)
+                          {
+                            const ui32 chunkBegin = begin + chunkIdx * parallelChunkSize;
+                            chunkFunction(chunkBegin, std::min(end, chunkBegin + parallelChunkSize),
+                                          chunkResults[chunkIdx]);
+                          });
+  for (const Result& chunkResult : chunkResults)
+  {
+    result.merge(chunkResult);
+  }
+  return result;
+}
+
+// Bin of a centroid on an axis, with a scale of the number of bins / extent of the centroid bounds.
+ui32 getBinIdx(f32 centroid, f32 lowest, f32 scale, ui32 nNodeBins)
+{
+  return std::min(nNodeBins - 1, static_cast<ui32>(std::max(0.0f, (centroid - lowest) * scale)));
+}
+
+// Builds the node of the range and its descendants, depth first into nodes. If subtrees is set, ranges of up to
+// subtreeSize primitives are only recorded as subtrees, with a node that refers to them.
+void buildNode(BvhBuilder& builder, ui32 begin, ui32 end, ui32 depth, std::vector<BvhNode>& nodes,
+               ThreadPool* threadPool, std::vector<Subtree>* subtrees, ui32 subtreeSize)
+{
+  const RangeBounds rangeBounds = reduceRange<RangeBounds>(threadPool, begin, end,
+                                                           [&](ui32 first, ui32 last, RangeBounds& result)
+                                                           {
+                                                             for (ui32 i = first; i < last; i++)
+                                                             {
+                                                               const PrimitiveReference& reference =
+                                                                   builder.references[i];
+                                                               grow(result.bounds, {reference.lowerLeftBottom,
+                                                                                    reference.upperRightTop});
+                                                               grow(result.centroidBounds, reference.getCentroid());
+                                                             }
+                                                           });
+  const ui32 nodeIdx = static_cast<ui32>(nodes.size());
+  const ui32 n       = end - begin;
+  nodes.push_back({rangeBounds.bounds.lowerLeftBottom, begin, rangeBounds.bounds.upperRightTop, n});
+  if (subtrees && n <= subtreeSize)
+  {
+    nodes[nodeIdx].offset = static_cast<ui32>(subtrees->size());
+    nodes[nodeIdx].count  = subtreeCount;
+    subtrees->push_back({begin, end, depth});
+    return;
+  }
+  if (n == 1 || depth + 1 >= TriangleBvh::maxDepth)
+  {
+    return;
+  }
+
+  // Small nodes have fewer bins. Axes on which all centroids coincide cannot be split.
+  const ui32       nNodeBins      = std::min(nBins, n);
+  const BvhBounds& centroidBounds = rangeBounds.centroidBounds;
+  const f32v3      extent         = centroidBounds.upperRightTop - centroidBounds.lowerLeftBottom;
+  const f32v3      scale          = f32v3(static_cast<f32>(nNodeBins)) / extent;
+  bool             splittable[3];
+  for (ui32 axis = 0; axis < 3; axis++)
+  {
+    splittable[axis] = extent[axis] > 0.0f && std::isfinite(scale[axis]);
+  }
+  const Bins bins = reduceRange<Bins>(
+      threadPool, begin, end,
+      [&](ui32 first, ui32 last, Bins& result)
+      {
+        for (ui32 i = first; i < last; i++)
+        {
+          const PrimitiveReference& reference = builder.references[i];
+          const f32v3               centroid  = reference.getCentroid();
+          for (ui32 axis = 0; axis < 3; axis++)
+          {
+            if (splittable[axis])
+            {
+              Bin& bin = result.axes[axis][getBinIdx(centroid[axis], centroidBounds.lowerLeftBottom[axis],
+                                                     scale[axis], nNodeBins)];
+              grow(bin.bounds, {reference.lowerLeftBottom, reference.upperRightTop});
+              bin.count++;
+            }
+          }
+        }
+      });
+
+  // Sweeps over the bins of each axis, for the cost of splitting after each bin.
+  const f32 nodeArea  = getArea(rangeBounds.bounds);
+  f32       bestCost  = std::numeric_limits<f32>::infinity();
+  ui32      bestAxis  = 0;
+  ui32      bestSplit = 0;
+  for (ui32 axis = 0; axis < 3; axis++)
+  {
+    if (!splittable[axis])
+    {
+      continue;
+    }
+    std::array<f32, nBins> rightCosts;
+    BvhBounds              rightBounds = getEmptyBounds();
+    ui32                   rightCount  = 0;
+    for (ui32 i = nNodeBins - 1; i > 0; i--)
+    {
+      grow(rightBounds, bins.axes[axis][i].bounds);
+      rightCount += bins.axes[axis][i].count;
+      rightCosts[i] = getArea(rightBounds) * static_cast<f32>(getNumberOfBlocks(rightCount, builder.blockSize));
+    }
+    BvhBounds leftBounds = getEmptyBounds();
+    ui32      leftCount  = 0;
+    for (ui32 i = 0; i + 1 < nNodeBins; i++)
+    {
+      grow(leftBounds, bins.axes[axis][i].bounds);
+      leftCount += bins.axes[axis][i].count;
+      if (leftCount == 0 || leftCount == n)
+      {
+        continue;
+      }
+      const f32 cost = getArea(leftBounds) * static_cast<f32>(getNumberOfBlocks(leftCount, builder.blockSize)) +
+                       rightCosts[i + 1];
+      if (cost < bestCost)
+      {
+        bestCost  = cost;
+        bestAxis  = axis;
+        bestSplit = i;
+      }
+    }
+  }
+  // Relative to the node, with the test of its two children.
+  bestCost = 1.0f + blockCost * bestCost / std::max(nodeArea, std::numeric_limits<f32>::min());
+
+  auto* const references = builder.references.data();
+  ui32        mid        = begin;
+  if (bestCost < std::numeric_limits<f32>::infinity())
+  {
+    if (n <= builder.maxLeafSize && bestCost >= blockCost * getNumberOfBlocks(n, builder.blockSize))
+    {
+      return;
+    }
+    const f32 lowest = centroidBounds.lowerLeftBottom[bestAxis];
+    mid              = static_cast<ui32>(std::partition(references + begin, references + end,
+                                                        [&](const PrimitiveReference& reference)
+                                                        {
+                                                          return getBinIdx(reference.getCentroid()[bestAxis], lowest,
+                                                                           scale[bestAxis], nNodeBins) <= bestSplit;
+                                                        }) -
+                            references);
+  }
+  else
+  {
+    // All centroids coincide, only too large leaves are split, in the middle.
+    if (n <= builder.maxLeafSize)
+    {
+      return;
+    }
+    mid = begin + n / 2;
+  }
+
+  nodes[nodeIdx].count = 0;
+  buildNode(builder, begin, mid, depth + 1, nodes, threadPool, subtrees, subtreeSize);
+  nodes[nodeIdx].offset = static_cast<ui32>(nodes.size());
+  buildNode(builder, mid, end, depth + 1, nodes, threadPool, subtrees, subtreeSize);
+}
+
+// Copies the node and its descendants into result, with the nodes of the subtrees in place of their placeholders.
+void appendNodes(const std::vector<BvhNode>& upperNodes, ui32 nodeIdx,
+                 const std::vector<std::vector<BvhNode>>& subtreeNodes, std::vector<BvhNode>& result)
+{
+  const BvhNode& node = upperNodes[nodeIdx];
+  if (node.count == subtreeCount)
+  {
+    const ui32 firstIdx = static_cast<ui32>(result.size());
+    for (BvhNode subtreeNode : subtreeNodes[node.offset])
+    {
+      subtreeNode.offset += subtreeNode.isLeaf() ? 0 : firstIdx;
+      result.push_back(subtreeNode);
+    }
+    return;
+  }
+  result.push_back(node);
+  if (node.isLeaf())
+  {
+    return;
+  }
+  const ui32 resultIdx = static_cast<ui32>(result.size()) - 1;
+  appendNodes(upperNodes, nodeIdx + 1, subtreeNodes, result);
+  result[resultIdx].offset = static_cast<ui32>(result.size());
+  appendNodes(upperNodes, node.offset, subtreeNodes, result);
+}
+
+struct BvhBuild
+{
+  std::vector<BvhNode> nodes;            //! Leaves refer to primitiveIndices.
+  std::vector<ui32>    primitiveIndices; //! Indices of the primitives, in the order of the leaves.
+};
+
+// Builds a hierarchy of the bounds of primitives. The upper levels are split on the calling thread, with the bins
+// filled by all threads, until there are a few subtrees per thread, which are then built in parallel.
+BvhBuild buildBvh(const std::vector<BvhBounds>& bounds, ui32 maxLeafSize, ui32 blockSize, ThreadPool* threadPool)
+{
+  BvhBuilder builder {std::vector<PrimitiveReference>(bounds.size()), maxLeafSize, blockSize};
+  for (ui32 i = 0; i < bounds.size(); i++)
+  {
+    builder.references[i] = {bounds[i].lowerLeftBottom, i, bounds[i].upperRightTop};
+  }
+
+  BvhBuild   result;
+  const ui32 n = static_cast<ui32>(bounds.size());
+  if (n == 0)
+  {
+    return result;
+  }
+  const ui32 nThreads = threadPool ? threadPool->getNumberOfThreads() : 1;
+  if (nThreads == 1 || n < 2 * minSubtreeSize)
+  {
+    buildNode(builder, 0, n, 0, result.nodes, nullptr, nullptr, 0);
+  }
+  else
+  {
+    std::vector<BvhNode> upperNodes;
+    std::vector<Subtree> subtrees;
+    buildNode(builder, 0, n, 0, upperNodes, threadPool, &subtrees, std::max(minSubtreeSize, n / (4 * nThreads)));
+
+    // The subtrees refer to disjoint ranges of the references, so they are reordered independently.
+    std::vector<std::vector<BvhNode>> subtreeNodes(subtrees.size());
+    threadPool->parallelFor(static_cast<ui32>(subtrees.size()),
+                            [&](ui32 subtreeIdx)
+                            {
+                              const Subtree& subtree = subtrees[subtreeIdx];
+                              buildNode(builder, subtree.begin, subtree.end, subtree.depth, subtreeNodes[subtreeIdx],
+                                        nullptr, nullptr, 0);
+                            });
+    result.nodes.reserve(upperNodes.size() + subtrees.size() * (2 * minSubtreeSize / maxLeafSize));
+    appendNodes(upperNodes, 0, subtreeNodes, result.nodes);
+  }
+  result.primitiveIndices.reserve(n);
+  for (const PrimitiveReference& reference : builder.references)
+  {
+    result.primitiveIndices.push_back(reference.primitiveIdx);
+  }
+  return result;
+}
+
+// Ray with the reciprocal direction, for the slab test of the node bounds.
+struct RayBoxTest
+{
+  f32v3 origin;
+  f32v3 inverseDirection;
+
+  explicit RayBoxTest(const Ray& ray)
+      : origin(ray.origin)
+  {
+    // Directions parallel to an axis get a tiny component, so the slabs never compute 0 * infinity.
+    for (ui32 axis = 0; axis < 3; axis++)
+    {
+      const f32 d            = ray.direction[axis];
+      inverseDirection[axis] = 1.0f / (std::abs(d) > 1e-30f ? d : std::copysign(1e-30f, d));
+    }
+  }
+
+  // Returns true if the ray enters the node in [tMin, tMax), with the parameter where it enters.
+  bool intersect(const BvhNode& node, f32 tMin, f32 tMax, f32& tNear) const
+  {
+    const f32v3 t0   = (node.lowerLeftBottom - origin) * inverseDirection;
+    const f32v3 t1   = (node.upperRightTop - origin) * inverseDirection;
+    const f32v3 tLow = glm::min(t0, t1);
+    const f32v3 tUp  = glm::max(t0, t1);
+    tNear            = std::max(std::max(tLow.x, tLow.y), std::max(tLow.z, tMin));
+    const f32 tFar   = std::min(std::min(tUp.x, tUp.y), std::min(tUp.z, tMax));
+    return tNear <= tFar;
+  }
+};
+
+// Visits the leaves the ray reaches, the closer child first, and skips nodes that are farther than the closest hit.
+// intersectLeaf(node, tMax) tests the primitives of a leaf and lowers tMax if one is hit. For any hit, the traversal
+// stops at the first hit.
+template <bool anyHit, typename LeafFunction>
+bool traverse(const std::vector<BvhNode>& nodes, const Ray& ray, f32 tMax, const LeafFunction& intersectLeaf)
+{
+  struct StackEntry
+  {
+    ui32 nodeIdx;
+    f32  tNear;
+  };
+
+  const RayBoxTest boxTest(ray);
+  f32              tNear;
+  if (nodes.empty() || !boxTest.intersect(nodes[0], ray.tMin, tMax, tNear))
+  {
+    return false;
+  }
+  std::array<StackEntry, TriangleBvh::maxDepth> stack;
+  ui32                                          stackSize = 0;
+  ui32                                          nodeIdx   = 0;
+  bool                                          found     = false;
+  while (true)
+  {
+    const BvhNode& node = nodes[nodeIdx];
+    if (node.isLeaf())
+    {
+      if (intersectLeaf(node, tMax))
+      {
+        found = true;
+        if (anyHit)
+        {
+          return true;
+        }
+      }
+    }
+    else
+    {
+      f32        tNears[2];
+      const ui32 children[2] = {nodeIdx + 1, node.offset};
+      const bool hits[2]     = {boxTest.intersect(nodes[children[0]], ray.tMin, tMax, tNears[0]),
+                                boxTest.intersect(nodes[children[1]], ray.tMin, tMax, tNears[1])};
+      if (hits[0] && hits[1])
+      {
+        const ui32 first          = tNears[1] < tNears[0] ? 1 : 0;
+        stack[stackSize++]        = {children[1 - first], tNears[1 - first]};
+        nodeIdx                   = children[first];
+        continue;
+      }
+      if (hits[0] || hits[1])
+      {
+        nodeIdx = children[hits[0] ? 0 : 1];
+        continue;
+      }
+    }
+
+    // The next node on the stack that is not behind the closest hit.
+    while (stackSize > 0 && stack[stackSize - 1].tNear > tMax)
+    {
+      stackSize--;
+    }
+    if (stackSize == 0)
+    {
+      return found;
+    }
+    nodeIdx = stack[--stackSize].nodeIdx;
+  }
+}
+
+BvhBounds transformBounds(const BvhBounds& bounds, const f32m4& transformation)
+{
+  BvhBounds result = getEmptyBounds();
+  for (ui32 i = 0; i < 8; i++)
+  {
+    const f32v3 corner((i & 1) ? bounds.upperRightTop.x : bounds.lowerLeftBottom.x,
+                       (i & 2) ? bounds.upperRightTop.y : bounds.lowerLeftBottom.y,
+                       (i & 4) ? bounds.upperRightTop.z : bounds.lowerLeftBottom.z);
+    grow(result, f32v3(transformation * f32v4(corner, 1.0f)));
+  }
+  return result;
+}
+} // namespace
+
+namespace gims
+{
+TriangleBvh::TriangleBvh()
+    : m_nTriangles(0)
+{
+}
+
+TriangleBvh::TriangleBvh(const TriangleBvhGeometry& geometry, ThreadPool* threadPool)
+    : m_nTriangles(geometry.nTriangles)
+{
+  GIMS_PROFILE_ZONE("Build Triangle BVH");
+  const auto getPosition = [&](ui32 vertexIdx) -> const f32v3&
+  {
+    return *reinterpret_cast<const f32v3*>(reinterpret_cast<const ui8*>(geometry.positions) +
+                                           static_cast<size_t>(vertexIdx) * geometry.positionStride);
+  };
+  for (ui32 i = 0; i < geometry.nTriangles * 3; i++)
+  {
+    if (geometry.indices[i] >= geometry.nVertices)
+    {
+      throw std::invalid_argument("Index " + std::to_string(geometry.indices[i]) + " of triangle " +
+                                  std::to_string(i / 3) + " refers to one of " + std::to_string(geometry.nVertices) +
+                                  " vertices.");
+    }
+  }
+
+  std::vector<BvhBounds> bounds(geometry.nTriangles, getEmptyBounds());
+  for (ui32 i = 0; i < geometry.nTriangles; i++)
+  {
+    for (ui32 k = 0; k < 3; k++)
+    {
+      grow(bounds[i], getPosition(geometry.indices[i * 3 + k]));
+    }
+  }
+  BvhBuild build = buildBvh(bounds, maxLeafSize, trianglesPerBlock, threadPool);
+
+  // The triangles of each leaf are copied into its blocks, unused lanes have no area, so no ray hits them.
+  m_nodes = std::move(build.nodes);
+  m_blocks.reserve(getNumberOfBlocks(geometry.nTriangles, trianglesPerBlock) + m_nodes.size() / 2);
+  for (BvhNode& node : m_nodes)
+  {
+    if (!node.isLeaf())
+    {
+      continue;
+    }
+    const ui32 firstBlock = static_cast<ui32>(m_blocks.size());
+    for (ui32 i = 0; i < node.count; i += trianglesPerBlock)
+    {
+      TriangleBlock block = {};
+      for (ui32 lane = 0; lane < trianglesPerBlock; lane++)
+      {
+        block.triangleIndices[lane] = RayHit::invalidIdx;
+        if (i + lane >= node.count)
+        {
+          continue;
+        }
+        const ui32   triangleIdx = build.primitiveIndices[node.offset + i + lane];
+        const f32v3& v0          = getPosition(geometry.indices[triangleIdx * 3 + 0]);
+        const f32v3  edge1       = getPosition(geometry.indices[triangleIdx * 3 + 1]) - v0;
+        const f32v3  edge2       = getPosition(geometry.indices[triangleIdx * 3 + 2]) - v0;
+        for (ui32 axis = 0; axis < 3; axis++)
+        {
+          block.v0[axis][lane]    = v0[axis];
+          block.edge1[axis][lane] = edge1[axis];
+          block.edge2[axis][lane] = edge2[axis];
+        }
+        block.triangleIndices[lane] = triangleIdx;
+      }
+      m_blocks.push_back(block);
+    }
+    node.offset = firstBlock;
+    node.count  = static_cast<ui32>(m_blocks.size()) - firstBlock;
+  }
+}
+
+bool TriangleBvh::intersect(const Ray& ray, RayHit& hit) const
+{
+  return traverse<false>(m_nodes, ray, std::min(ray.tMax, hit.t),
+                         [&](const BvhNode& node, f32& tMax)
+                         {
+                           bool found = false;
+                           for (ui32 i = node.offset; i < node.offset + node.count; i++)
+                           {
+                             const ui32 triangleIdx = intersectBlock(m_blocks[i], ray, tMax, hit.barycentrics);
+                             if (triangleIdx != RayHit::invalidIdx)
+                             {
+                               hit.t           = tMax;
+                               hit.triangleIdx = triangleIdx;
+                               found           = true;
+                             }
+                           }
+                           return found;
+                         });
+}
+
+bool TriangleBvh::isOccluded(const Ray& ray) const
+{
+  return traverse<true>(m_nodes, ray, ray.tMax,
+                        [&](const BvhNode& node, f32& tMax)
+                        {
+                          f32v2 barycentrics;
+                          for (ui32 i = node.offset; i < node.offset + node.count; i++)
+                          {
+                            if (intersectBlock(m_blocks[i], ray, tMax, barycentrics) != RayHit::invalidIdx)
+                            {
+                              return true;
+                            }
+                          }
+                          return false;
+                        });
+}
+
+BvhBounds TriangleBvh::getBounds() const
+{
+  if (m_nodes.empty())
+  {
+    return {f32v3(0.0f), f32v3(0.0f)};
+  }
+  return {m_nodes[0].lowerLeftBottom, m_nodes[0].upperRightTop};
+}
+
+ui32 TriangleBvh::getNumberOfTriangles() const
+{
+  return m_nTriangles;
+}
+
+const std::vector<BvhNode>& TriangleBvh::getNodes() const
+{
+  return m_nodes;
+}
+
+f32 TriangleBvh::getSahCost() const
+{
+  if (m_nodes.empty())
+  {
+    return 0.0f;
+  }
+  // Each node is reached with the probability of its area relative to the root. Inner nodes test their two children.
+  const f32 rootArea = std::max(getArea(m_nodes[0]), std::numeric_limits<f32>::min());
+  f32       cost     = 1.0f;
+  for (const BvhNode& node : m_nodes)
+  {
+    cost += getArea(node) / rootArea * (node.isLeaf() ? blockCost * static_cast<f32>(node.count) : 2.0f);
+  }
+  return cost;
+}
+
+ui32 TriangleBvh::intersectBlock(const TriangleBlock& block, const Ray& ray, f32& tMax, f32v2& barycentrics)
+{
+  // Moeller-Trumbore for each lane: t, u and v solve origin + t * direction = v0 + u * edge1 + v * edge2.
+  alignas(16) f32 ts[4];
+  alignas(16) f32 us[4];
+  alignas(16) f32 vs[4];
+  ui32            mask;
+#ifdef GIMS_RAY_CASTING_SSE2
+  const __m128 dx  = _mm_set1_ps(ray.direction.x);
+  const __m128 dy  = _mm_set1_ps(ray.direction.y);
+  const __m128 dz  = _mm_set1_ps(ray.direction.z);
+  const __m128 e1x = _mm_load_ps(block.edge1[0]);
+  const __m128 e1y = _mm_load_ps(block.edge1[1]);
+  const __m128 e1z = _mm_load_ps(block.edge1[2]);
+  const __m128 e2x = _mm_load_ps(block.edge2[0]);
+  const __m128 e2y = _mm_load_ps(block.edge2[1]);
+  const __m128 e2z = _mm_load_ps(block.edge2[2]);
+  const __m128 sx  = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(block.v0[0]));
+  const __m128 sy  = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(block.v0[1]));
+  const __m128 sz  = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(block.v0[2]));
+
+  const __m128 px     = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+  const __m128 py     = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+  const __m128 pz     = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+  const __m128 det    = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+  const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+  const __m128 qx     = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+  const __m128 qy     = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+  const __m128 qz     = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+  const __m128 u =
+      _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+  const __m128 v =
+      _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+  const __m128 t =
+      _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+  // Comparisons with NaN fail, so degenerate triangles and unused lanes are never hit.
+  const __m128 zero   = _mm_setzero_ps();
+  __m128       inside = _mm_cmpneq_ps(det, zero);
+  inside              = _mm_and_ps(inside, _mm_cmpge_ps(u, zero));
+  inside              = _mm_and_ps(inside, _mm_cmpge_ps(v, zero));
+  inside              = _mm_and_ps(inside, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+  inside              = _mm_and_ps(inside, _mm_cmpge_ps(t, _mm_set1_ps(ray.tMin)));
+  inside              = _mm_and_ps(inside, _mm_cmplt_ps(t, _mm_set1_ps(tMax)));
+  mask                = static_cast<ui32>(_mm_movemask_ps(inside));
+  if (mask == 0)
+  {
+    return RayHit::invalidIdx;
+  }
+  _mm_store_ps(ts, t);
+  _mm_store_ps(us, u);
+  _mm_store_ps(vs, v);
+#else
+  mask = 0;
+  for (ui32 lane = 0; lane < 4; lane++)
+  {
+    const f32 dx  = ray.direction.x;
+    const f32 dy  = ray.direction.y;
+    const f32 dz  = ray.direction.z;
+    const f32 e1x = block.edge1[0][lane];
+    const f32 e1y = block.edge1[1][lane];
+    const f32 e1z = block.edge1[2][lane];
+    const f32 e2x = block.edge2[0][lane];
+    const f32 e2y = block.edge2[1][lane];
+    const f32 e2z = block.edge2[2][lane];
+    const f32 sx  = ray.origin.x - block.v0[0][lane];
+    const f32 sy  = ray.origin.y - block.v0[1][lane];
+    const f32 sz  = ray.origin.z - block.v0[2][lane];
+
+    const f32 px     = dy * e2z - dz * e2y;
+    const f32 py     = dz * e2x - dx * e2z;
+    const f32 pz     = dx * e2y - dy * e2x;
+    const f32 det    = e1x * px + e1y * py + e1z * pz;
+    const f32 invDet = 1.0f / det;
+    const f32 qx     = sy * e1z - sz * e1y;
+    const f32 qy     = sz * e1x - sx * e1z;
+    const f32 qz     = sx * e1y - sy * e1x;
+    us[lane]         = (sx * px + sy * py + sz * pz) * invDet;
+    vs[lane]         = (dx * qx + dy * qy + dz * qz) * invDet;
+    ts[lane]         = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+    if (det != 0.0f && us[lane] >= 0.0f && vs[lane] >= 0.0f && us[lane] + vs[lane] <= 1.0f &&
+        ts[lane] >= ray.tMin && ts[lane] < tMax)
+    {
+      mask |= 1u << lane;
+    }
+  }
+  if (mask == 0)
+  {
+    return RayHit::invalidIdx;
+  }
+#endif
+
+  // The closest of the hit lanes, the first one if several are equally close.
+  ui32 closestLane = 4;
+  for (ui32 lane = 0; lane < 4; lane++)
+  {
+    if ((mask & (1u << lane)) && (closestLane == 4 || ts[lane] < ts[closestLane]))
+    {
+      closestLane = lane;
+    }
+  }
+  tMax         = ts[closestLane];
+  barycentrics = f32v2(us[closestLane], vs[closestLane]);
+  return block.triangleIndices[closestLane];
+}
+
+RayCastingScene::RayCastingScene()
+{
+}
+
+RayCastingScene::RayCastingScene(std::vector<TriangleBvh> meshes)
+    : m_meshes(std::move(meshes))
+{
+}
+
+void RayCastingScene::setInstances(const std::vector<RayCastingInstance>& instances)
+{
+  GIMS_PROFILE_ZONE("Build Instance BVH");
+  std::vector<BvhBounds> bounds;
+  bounds.reserve(instances.size());
+  for (const auto& instance : instances)
+  {
+    bounds.push_back(transformBounds(m_meshes.at(instance.meshIdx).getBounds(), instance.transformation));
+  }
+  BvhBuild build = buildBvh(bounds, maxInstancesPerLeaf, 1, nullptr);
+
+  m_instances = instances;
+  m_nodes     = std::move(build.nodes);
+  m_sortedInstances.clear();
+  m_sortedInstances.reserve(instances.size());
+  for (const ui32 instanceIdx : build.primitiveIndices)
+  {
+    m_sortedInstances.push_back(
+        {glm::inverse(instances[instanceIdx].transformation), instances[instanceIdx].meshIdx, instanceIdx});
+  }
+}
+
+bool RayCastingScene::intersect(const Ray& ray, RayHit& hit) const
+{
+  return traverse<false>(m_nodes, ray, std::min(ray.tMax, hit.t),
+                         [&](const BvhNode& node, f32& tMax)
+                         {
+                           bool found = false;
+                           for (ui32 i = node.offset; i < node.offset + node.count; i++)
+                           {
+                             const Instance& instance = m_sortedInstances[i];
+                             const Ray       meshRay  = {f32v3(instance.sceneToMesh * f32v4(ray.origin, 1.0f)),
+                                                         f32v3(instance.sceneToMesh * f32v4(ray.direction, 0.0f)),
+                                                         ray.tMin, tMax};
+                             if (m_meshes[instance.meshIdx].intersect(meshRay, hit))
+                             {
+                               tMax            = hit.t;
+                               hit.instanceIdx = instance.instanceIdx;
+                               found           = true;
+                             }
+                           }
+                           return found;
+                         });
+}
+
+bool RayCastingScene::isOccluded(const Ray& ray) const
+{
+  return traverse<true>(m_nodes, ray, ray.tMax,
+                        [&](const BvhNode& node, f32&)
+                        {
+                          for (ui32 i = node.offset; i < node.offset + node.count; i++)
+                          {
+                            const Instance& instance = m_sortedInstances[i];
+                            const Ray       meshRay  = {f32v3(instance.sceneToMesh * f32v4(ray.origin, 1.0f)),
+                                                        f32v3(instance.sceneToMesh * f32v4(ray.direction, 0.0f)),
+                                                        ray.tMin, ray.tMax};
+                            if (m_meshes[instance.meshIdx].isOccluded(meshRay))
+                            {
+                              return true;
+                            }
+                          }
+                          return false;
+                        });
+}
+
+ui32 RayCastingScene::getNumberOfMeshes() const
+{
+  return static_cast<ui32>(m_meshes.size());
+}
+
+const TriangleBvh& RayCastingScene::getMesh(ui32 meshIdx) const
+{
+  return m_meshes.at(meshIdx);
+}
+
+ui32 RayCastingScene::getNumberOfInstances() const
+{
+  return static_cast<ui32>(m_instances.size());
+}
+
+const RayCastingInstance& RayCastingScene::getInstance(ui32 instanceIdx) const
+{
+  return m_instances.at(instanceIdx);
+}
+
+std::vector<TriangleBvh> createTriangleBvhs(const std::vector<TriangleBvhGeometry>& meshes, ThreadPool& threadPool)
+{
+  GIMS_PROFILE_ZONE("Build Triangle BVHs");
+  std::vector<TriangleBvh> result(meshes.size());
+  std::vector<ui32>        smallMeshIndices;
+  for (ui32 i = 0; i < meshes.size(); i++)
+  {
+    if (meshes[i].nTriangles >= minParallelMeshSize)
+    {
+      result[i] = TriangleBvh(meshes[i], &threadPool);
+    }
+    else
+    {
+      smallMeshIndices.push_back(i);
+    }
+  }
+  threadPool.parallelFor(static_cast<ui32>(smallMeshIndices.size()),
+                         [&](ui32 i) { result[smallMeshIndices[i]] = TriangleBvh(meshes[smallMeshIndices[i]]); });
+  return result;
+}
+
+Ray createCameraRay(const f32m4& inverseViewProjection, const f32v2& normalizedCoordinates)
+{
+  const f32v4 nearPoint = inverseViewProjection * f32v4(normalizedCoordinates, 0.0f, 1.0f);
+  const f32v4 farPoint  = inverseViewProjection * f32v4(normalizedCoordinates, 1.0f, 1.0f);
+  const f32v3 origin    = f32v3(nearPoint) / nearPoint.w;
+  return {origin, f32v3(farPoint) / farPoint.w - origin, 0.0f, 1.0f};
+}
+} // namespace gims
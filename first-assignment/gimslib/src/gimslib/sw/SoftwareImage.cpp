@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <gimslib/contrib/stb/stb_image.h>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+using namespace gims;
+
+// Largest block of a deflate stream that is stored without compression.
+const size_t maxStoredBlockSize = 65535;
+
+ui32 getCrc32(const ui8* data, size_t size, ui32 crc = 0)
+{
+  static const auto table = []()
+  {
+    std::array<ui32, 256> result;
+    for (ui32 i = 0; i < 256; i++)
+    {
+      ui32 c = i;
+      for (ui32 k = 0; k < 8; k++)
+      {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      result[i] = c;
+    }
+    return result;
+  }();
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+  {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+ui32 getAdler32(const std::vector<ui8>& data)
+{
+  ui32 a = 1;
+  ui32 b = 0;
+  for (const ui8 value : data)
+  {
+    a = (a + value) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+void appendBigEndian(std::vector<ui8>& bytes, ui32 value)
+{
+  bytes.push_back(static_cast<ui8>(value >> 24));
+  bytes.push_back(static_cast<ui8>(value >> 16));
+  bytes.push_back(static_cast<ui8>(value >> 8));
+  bytes.push_back(static_cast<ui8>(value));
+}
+
+SoftwareImage createSoftwareImage(ui8* pixels, i32 width, i32 height)
+{
+  SoftwareImage image;
+  image.width  = static_cast<ui32>(width);
+  image.height = static_cast<ui32>(height);
+  image.pixels.assign(reinterpret_cast<const ui8v4*>(pixels),
+                      reinterpret_cast<const ui8v4*>(pixels) + static_cast<size_t>(width) * height);
+  stbi_image_free(pixels);
+  return image;
+}
+
+void appendChunk(std::vector<ui8>& bytes, const char* type, const std::vector<ui8>& data)
+{
+  appendBigEndian(bytes, static_cast<ui32>(data.size()));
+  const size_t typeOffset = bytes.size();
+  bytes.insert(bytes.end(), type, type + 4);
+  bytes.insert(bytes.end(), data.begin(), data.end());
+  appendBigEndian(bytes, getCrc32(bytes.data() + typeOffset, bytes.size() - typeOffset));
+}
+} // namespace
+
+namespace gims
+{
+SoftwareImage loadSoftwareImage(const std::filesystem::path& path)
+{
+  i32  width, height, nChannels;
+  ui8* pixels = stbi_load(path.string().c_str(), &width, &height, &nChannels, 4);
+  if (!pixels)
+  {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+  return createSoftwareImage(pixels, width, height);
+}
+
+SoftwareImage loadSoftwareImage(const ui8* data, size_t size)
+{
+  if (size > static_cast<size_t>(std::numeric_limits<i32>::max()))
+  {
+    throw std::runtime_error("Images of more than 2 GB cannot be decoded.");
+  }
+  i32  width, height, nChannels;
+  ui8* pixels = stbi_load_from_memory(data, static_cast<i32>(size), &width, &height, &nChannels, 4);
+  if (!pixels)
+  {
+    throw std::runtime_error(std::string("Unable to decode the image: ") + stbi_failure_reason());
+  }
+  return createSoftwareImage(pixels, width, height);
+}
+
+void saveSoftwareImage(const std::filesystem::path& path, const SoftwareImage& image)
+{
+  if (image.pixels.size() != static_cast<size_t>(image.width) * image.height || image.pixels.empty())
+  {
+    throw std::invalid_argument("The image has " + std::to_string(image.pixels.size()) + " pixels instead of " +
+                                std::to_string(image.width) + "x" + std::to_string(image.height) + ".");
+  }
+
+  // Each row starts with filter type 0, the rows form a zlib stream of stored deflate blocks.
+  std::vector<ui8> rows;
+  rows.reserve(image.pixels.size() * 4 + image.height);
+  for (ui32 y = 0; y < image.height; y++)
+  {
+    rows.push_back(0);
+    const ui8* row = reinterpret_cast<const ui8*>(&image.pixels[static_cast<size_t>(y) * image.width]);
+    rows.insert(rows.end(), row, row + image.width * 4);
+  }
+  std::vector<ui8> zlib = {0x78, 0x01};
+  for (size_t offset = 0; offset < rows.size(); offset += maxStoredBlockSize)
+  {
+    const size_t blockSize = std::min(maxStoredBlockSize, rows.size() - offset);
+    zlib.push_back(offset + blockSize == rows.size() ? 1 : 0);
+    zlib.push_back(static_cast<ui8>(blockSize));
+    zlib.push_back(static_cast<ui8>(blockSize >> 8));
+    zlib.push_back(static_cast<ui8>(~blockSize));
+    zlib.push_back(static_cast<ui8>(~blockSize >> 8));
+    zlib.insert(zlib.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+  }
+  appendBigEndian(zlib, getAdler32(rows));
+
+  // 8 bits per channel, RGBA, no interlacing.
+  std::vector<ui8> header;
+  appendBigEndian(header, image.width);
+  appendBigEndian(header, image.height);
+  header.insert(header.end(), {8, 6, 0, 0, 0});
+
+  std::vector<ui8> bytes = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  appendChunk(bytes, "IHDR", header);
+  appendChunk(bytes, "IDAT", zlib);
+  appendChunk(bytes, "IEND", {});
+
+  std::ofstream stream(path, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+}
+
+SoftwareImageDifference compareSoftwareImages(const SoftwareImage& image, const SoftwareImage& reference,
+                                              ui32 tolerance)
+{
+  if (image.width != reference.width || image.height != reference.height ||
+      image.pixels.size() != reference.pixels.size())
+  {
+    throw std::invalid_argument("Images of " + std::to_string(image.width) + "x" + std::to_string(image.height) +
+                                " and " + std::to_string(reference.width) + "x" + std::to_string(reference.height) +
+                                " pixels cannot be compared.");
+  }
+
+  SoftwareImageDifference result = {0.0, 0, 0, 0.0};
+  ui64                    sum    = 0;
+  for (size_t i = 0; i < image.pixels.size(); i++)
+  {
+    ui32 maxPixelError = 0;
+    for (ui32 c = 0; c < 3; c++)
+    {
+      const ui32 error = static_cast<ui32>(std::abs(static_cast<i32>(image.pixels[i][c]) - reference.pixels[i][c]));
+      sum += error;
+      maxPixelError = std::max(maxPixelError, error);
+    }
+    result.maxError = std::max(result.maxError, maxPixelError);
+    if (maxPixelError > tolerance)
+    {
+      result.nPixelsAboveTolerance++;
+    }
+  }
+  if (!image.pixels.empty())
+  {
+    result.meanError              = static_cast<f64>(sum) / static_cast<f64>(3 * image.pixels.size());
+    result.fractionAboveTolerance = static_cast<f64>(result.nPixelsAboveTolerance) / image.pixels.size();
+  }
+  return result;
+}
+} // namespace gims
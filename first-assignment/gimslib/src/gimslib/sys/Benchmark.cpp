@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <gimslib/sys/Benchmark.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+// Nearest rank of a percentile in sorted times.
+f64 getPercentile(const std::vector<f64>& sortedMilliseconds, f64 percentile)
+{
+  const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<f64>(sortedMilliseconds.size())));
+  return sortedMilliseconds[std::clamp<size_t>(rank, 1, sortedMilliseconds.size()) - 1];
+}
+
+void writeTimeSummary(std::ostream& stream, const char* name, const TimeSummary& summary)
+{
+  stream << "\"" << name << "\":{\"samples\":" << summary.nSamples << ",\"mean\":" << summary.mean
+         << ",\"min\":" << summary.min << ",\"max\":" << summary.max << ",\"p50\":" << summary.p50
+         << ",\"p95\":" << summary.p95 << ",\"p99\":" << summary.p99 << "}";
+}
+} // namespace
+
+namespace gims
+{
+TimeSummary summarizeTimes(std::vector<f64> milliseconds)
+{
+  TimeSummary result = {0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  if (milliseconds.empty())
+  {
+    return result;
+  }
+  std::sort(milliseconds.begin(), milliseconds.end());
+  f64 sum = 0.0;
+  for (const f64 time : milliseconds)
+  {
+    sum += time;
+  }
+  result.nSamples = static_cast<ui32>(milliseconds.size());
+  result.mean     = sum / static_cast<f64>(milliseconds.size());
+  result.min      = milliseconds.front();
+  result.max      = milliseconds.back();
+  result.p50      = getPercentile(milliseconds, 50.0);
+  result.p95      = getPercentile(milliseconds, 95.0);
+  result.p99      = getPercentile(milliseconds, 99.0);
+  return result;
+}
+
+BenchmarkRecorder::BenchmarkRecorder(ui32 nWarmUpFrames, ui32 nFrames, ui32 maxGpuLatency)
+    : m_nWarmUpFrames(nWarmUpFrames)
+    , m_nFrames(nFrames)
+    , m_maxGpuLatency(maxGpuLatency)
+    , m_frameIdx(0)
+    , m_nGpuTimes(0)
+{
+  if (nFrames == 0)
+  {
+    throw std::invalid_argument("A benchmark needs at least one measured frame.");
+  }
+  m_frames.reserve(nFrames);
+}
+
+ui64 BenchmarkRecorder::getFrameIdx() const
+{
+  return m_frameIdx;
+}
+
+void BenchmarkRecorder::addFrame(f64 frameMilliseconds, f64 cpuMilliseconds)
+{
+  if (m_frameIdx >= m_nWarmUpFrames && m_frames.size() < m_nFrames)
+  {
+    m_frames.push_back({frameMilliseconds, cpuMilliseconds, 0.0, false});
+  }
+  m_frameIdx++;
+}
+
+void BenchmarkRecorder::addGpuTime(ui64 frameIdx, f64 milliseconds)
+{
+  if (frameIdx < m_nWarmUpFrames || frameIdx - m_nWarmUpFrames >= m_frames.size())
+  {
+    return;
+  }
+  auto& frame = m_frames[frameIdx - m_nWarmUpFrames];
+  if (!frame.hasGpuTime)
+  {
+    m_nGpuTimes++;
+  }
+  frame.gpuMilliseconds = milliseconds;
+  frame.hasGpuTime      = true;
+}
+
+bool BenchmarkRecorder::isComplete() const
+{
+  const ui64 endFrameIdx = static_cast<ui64>(m_nWarmUpFrames) + m_nFrames;
+  return m_frameIdx >= endFrameIdx && (m_nGpuTimes == m_nFrames || m_frameIdx >= endFrameIdx + m_maxGpuLatency);
+}
+
+TimeSummary BenchmarkRecorder::getFrameTimeSummary() const
+{
+  std::vector<f64> milliseconds;
+  for (const auto& frame : m_frames)
+  {
+    milliseconds.push_back(frame.frameMilliseconds);
+  }
+  return summarizeTimes(std::move(milliseconds));
+}
+
+TimeSummary BenchmarkRecorder::getCpuTimeSummary() const
+{
+  std::vector<f64> milliseconds;
+  for (const auto& frame : m_frames)
+  {
+    milliseconds.push_back(frame.cpuMilliseconds);
+  }
+  return summarizeTimes(std::move(milliseconds));
+}
+
+TimeSummary BenchmarkRecorder::getGpuTimeSummary() const
+{
+  std::vector<f64> milliseconds;
+  for (const auto& frame : m_frames)
+  {
+    if (frame.hasGpuTime)
+    {
+      milliseconds.push_back(frame.gpuMilliseconds);
+    }
+  }
+  return summarizeTimes(std::move(milliseconds));
+}
+
+void BenchmarkRecorder::writeJson(std::ostream& stream) const
+{
+  stream << "{\"warmUpFrames\":" << m_nWarmUpFrames << ",\"frames\":" << m_frames.size() << ",\n";
+  writeTimeSummary(stream, "frameTime", getFrameTimeSummary());
+  stream << ",\n";
+  writeTimeSummary(stream, "cpuTime", getCpuTimeSummary());
+  stream << ",\n";
+  writeTimeSummary(stream, "gpuTime", getGpuTimeSummary());
+  stream << "\n}\n";
+}
+
+void BenchmarkRecorder::writeCsv(std::ostream& stream) const
+{
+  stream << "frame,frameMilliseconds,cpuMilliseconds,gpuMilliseconds\n";
+  for (size_t i = 0; i < m_frames.size(); i++)
+  {
+    const auto& frame = m_frames[i];
+    stream << m_nWarmUpFrames + i << "," << frame.frameMilliseconds << "," << frame.cpuMilliseconds << ","
+           << (frame.hasGpuTime ? frame.gpuMilliseconds : -1.0) << "\n";
+  }
+}
+} // namespace gims
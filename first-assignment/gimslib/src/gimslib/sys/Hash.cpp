@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <gimslib/sys/Hash.hpp>
+
+namespace
+{
+using gims::ui32;
+using gims::ui64;
+using gims::ui8;
+
+const ui64 PRIME_1 = 0x9E3779B185EBCA87ull;
+const ui64 PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+const ui64 PRIME_3 = 0x165667B19E3779F9ull;
+const ui64 PRIME_4 = 0x85EBCA77C2B2AE63ull;
+const ui64 PRIME_5 = 0x27D4EB2F165667C5ull;
+
+ui64 rotateLeft(ui64 value, int nBits)
+{
+  return (value << nBits) | (value >> (64 - nBits));
+}
+
+// Loaded with memcpy, since the bytes need not be aligned.
+ui64 readUi64(const ui8* bytes)
+{
+  ui64 value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+ui32 readUi32(const ui8* bytes)
+{
+  ui32 value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+ui64 accumulate(ui64 accumulator, ui64 input)
+{
+  accumulator += input * PRIME_2;
+  accumulator = rotateLeft(accumulator, 31);
+  return accumulator * PRIME_1;
+}
+
+ui64 mergeAccumulator(ui64 hash, ui64 accumulator)
+{
+  hash ^= accumulate(0, accumulator);
+  return hash * PRIME_1 + PRIME_4;
+}
+
+// Consumes one 32 byte stripe, 8 bytes per lane.
+void consumeStripe(ui64 (&accumulators)[4], const ui8* stripe)
+{
+  accumulators[0] = accumulate(accumulators[0], readUi64(stripe));
+  accumulators[1] = accumulate(accumulators[1], readUi64(stripe + 8));
+  accumulators[2] = accumulate(accumulators[2], readUi64(stripe + 16));
+  accumulators[3] = accumulate(accumulators[3], readUi64(stripe + 24));
+}
+} // namespace
+
+namespace gims
+{
+Hasher::Hasher()
+    : m_accumulators{PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1}
+    , m_buffer{}
+    , m_bufferSize(0)
+    , m_totalSize(0)
+{
+}
+
+void Hasher::add(const void* data, size_t sizeInBytes)
+{
+  const ui8* bytes = static_cast<const ui8*>(data);
+  const ui8* end   = bytes + sizeInBytes;
+  m_totalSize += sizeInBytes;
+
+  // Completes the stripe of earlier calls first, so the hash does not depend on how the bytes were split.
+  if (m_bufferSize > 0)
+  {
+    const size_t nCopied = std::min(sizeof(m_buffer) - m_bufferSize, sizeInBytes);
+    std::memcpy(m_buffer + m_bufferSize, bytes, nCopied);
+    m_bufferSize += static_cast<ui32>(nCopied);
+    bytes += nCopied;
+    if (m_bufferSize < sizeof(m_buffer))
+    {
+      return;
+    }
+    consumeStripe(m_accumulators, m_buffer);
+    m_bufferSize = 0;
+  }
+  for (; end - bytes >= static_cast<ptrdiff_t>(sizeof(m_buffer)); bytes += sizeof(m_buffer))
+  {
+    consumeStripe(m_accumulators, bytes);
+  }
+  std::memcpy(m_buffer, bytes, end - bytes);
+  m_bufferSize = static_cast<ui32>(end - bytes);
+}
+
+void Hasher::add(const std::string& str)
+{
+  addValue(static_cast<ui64>(str.size()));
+  add(str.data(), str.size());
+}
+
+void Hasher::add(const std::wstring& str)
+{
+  // wchar_t differs in size between platforms, so every character is widened to 32 bits.
+  addValue(static_cast<ui64>(str.size()));
+  for (const wchar_t c : str)
+  {
+    addValue(static_cast<ui32>(c));
+  }
+}
+
+ui64 Hasher::getValue() const
+{
+  ui64 hash;
+  if (m_totalSize >= sizeof(m_buffer))
+  {
+    hash = rotateLeft(m_accumulators[0], 1) + rotateLeft(m_accumulators[1], 7) + rotateLeft(m_accumulators[2], 12) +
+           rotateLeft(m_accumulators[3], 18);
+    for (const ui64 accumulator : m_accumulators)
+    {
+      hash = mergeAccumulator(hash, accumulator);
+    }
+  }
+  else
+  {
+    hash = PRIME_5;
+  }
+  hash += m_totalSize;
+
+  // The bytes after the last complete stripe.
+  const ui8* bytes = m_buffer;
+  const ui8* end   = m_buffer + m_bufferSize;
+  for (; end - bytes >= 8; bytes += 8)
+  {
+    hash ^= accumulate(0, readUi64(bytes));
+    hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+  }
+  if (end - bytes >= 4)
+  {
+    hash ^= readUi32(bytes) * PRIME_1;
+    hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+    bytes += 4;
+  }
+  for (; bytes != end; bytes++)
+  {
+    hash ^= *bytes * PRIME_5;
+    hash = rotateLeft(hash, 11) * PRIME_1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME_2;
+  hash ^= hash >> 29;
+  hash *= PRIME_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+ui64 hashBytes(const void* data, size_t sizeInBytes)
+{
+  Hasher hasher;
+  hasher.add(data, sizeInBytes);
+  return hasher.getValue();
+}
+
+std::string toHexString(ui64 hash)
+{
+  const char* digits = "0123456789abcdef";
+  std::string result(16, '0');
+  for (i32 i = 15; i >= 0; i--)
+  {
+    result[i] = digits[hash & 0xf];
+    hash >>= 4;
+  }
+  return result;
+}
+} // namespace gims
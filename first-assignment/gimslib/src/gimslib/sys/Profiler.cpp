@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+using namespace gims;
+
+void writeJsonString(std::ostream& stream, const std::string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\' << c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      stream << ' ';
+    }
+    else
+    {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+} // namespace
+
+namespace gims
+{
+ProfileThreadBuffer::ProfileThreadBuffer(ui32 threadIdx)
+    : m_nStarted(0)
+    , m_nWritten(0)
+    , m_depth(0)
+    , m_threadIdx(threadIdx)
+    , m_name("Thread " + std::to_string(threadIdx))
+{
+}
+
+ProfileThreadCapture ProfileThreadBuffer::capture(ui64 startTicks) const
+{
+  ProfileThreadCapture result;
+  result.threadIdx  = m_threadIdx;
+  result.incomplete = false;
+  {
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    result.threadName = m_name;
+  }
+
+  // Events end in the order in which they are written, so the ones of the time range are at the end.
+  const ui64 nWritten = m_nWritten.load(std::memory_order_acquire);
+  const ui64 nKept    = std::min<ui64>(nWritten, capacity);
+  ui64       first    = nWritten;
+  while (first > nWritten - nKept)
+  {
+    const Slot& slot = m_slots[(first - 1) & (capacity - 1)];
+    if (slot.endTicks < startTicks)
+    {
+      break;
+    }
+    first--;
+  }
+  for (ui64 eventIdx = first; eventIdx < nWritten; eventIdx++)
+  {
+    const Slot& slot = m_slots[eventIdx & (capacity - 1)];
+    result.events.push_back({slot.name, slot.startTicks, slot.endTicks, slot.depth});
+  }
+
+  // Event i is overwritten by event i + capacity, so the events whose slots the thread has started to overwrite while
+  // they were copied may be torn.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const ui64 nStarted   = m_nStarted.load(std::memory_order_relaxed);
+  const ui64 firstValid = std::max(first, nStarted > capacity ? nStarted - capacity : 0);
+  const ui64 nTorn      = std::min<ui64>(firstValid - first, result.events.size());
+  result.events.erase(result.events.begin(), result.events.begin() + nTorn);
+  result.incomplete = nTorn > 0 || (first == nWritten - nKept && nWritten > capacity);
+  return result;
+}
+
+void ProfileThreadBuffer::setName(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_nameMutex);
+  m_name = name;
+}
+
+Profiler::Profiler()
+    : m_startTicks(getTicks())
+    , m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+Profiler& Profiler::get()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+ui64 Profiler::now() const
+{
+  return static_cast<ui64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+ProfileThreadBuffer& Profiler::createThreadBuffer()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_buffers.push_back(std::make_unique<ProfileThreadBuffer>(static_cast<ui32>(m_buffers.size())));
+  return *m_buffers.back();
+}
+
+f64 Profiler::getNanosecondsPerTick() const
+{
+  const ui64 ticks = getTicks();
+  const f64  nanoseconds =
+      std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - m_startTime).count();
+  return ticks > m_startTicks ? nanoseconds / static_cast<f64>(ticks - m_startTicks) : 1.0;
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+  getThreadBuffer().setName(name);
+}
+
+ProfileCapture Profiler::capture(ui64 startNs) const
+{
+  ProfileCapture result;
+  result.startNs = startNs;
+  result.endNs   = now();
+
+  // Zones that started before the profiler was created are clamped to its creation.
+  const f64  nanosecondsPerTick = getNanosecondsPerTick();
+  const auto toNanoseconds      = [&](ui64 ticks)
+  {
+    return ticks > m_startTicks ? static_cast<ui64>(static_cast<f64>(ticks - m_startTicks) * nanosecondsPerTick) : 0;
+  };
+  const ui64 startTicks = m_startTicks + static_cast<ui64>(static_cast<f64>(startNs) / nanosecondsPerTick);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& buffer : m_buffers)
+  {
+    auto threadCapture = buffer->capture(startTicks);
+    if (!threadCapture.events.empty())
+    {
+      for (auto& event : threadCapture.events)
+      {
+        event.startNs = toNanoseconds(event.startNs);
+        event.endNs   = toNanoseconds(event.endNs);
+      }
+      result.threads.push_back(std::move(threadCapture));
+    }
+  }
+  return result;
+}
+
+f64 Profiler::measureZoneOverhead(ui32 nZones)
+{
+  f64 nanosecondsPerZone = 0.0;
+  std::thread measurement(
+      [&]()
+      {
+        setThreadName("Zone Overhead Measurement");
+        getThreadBuffer();
+        const ui64 start = now();
+        for (ui32 i = 0; i < nZones; i++)
+        {
+          const ProfileZone zone("Empty Zone");
+        }
+        nanosecondsPerZone = static_cast<f64>(now() - start) / std::max(nZones, 1u);
+      });
+  measurement.join();
+  return nanosecondsPerZone;
+}
+
+void writeChromeTrace(const ProfileCapture& capture, const std::filesystem::path& path)
+{
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+
+  // Complete events ("X") with timestamps in microseconds, and the thread names as metadata events ("M").
+  stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  stream.precision(3);
+  stream << std::fixed;
+  bool first = true;
+  for (const auto& thread : capture.threads)
+  {
+    stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.threadIdx
+           << ",\"args\":{\"name\":";
+    writeJsonString(stream, thread.threadName);
+    stream << "}}";
+    first = false;
+    for (const auto& event : thread.events)
+    {
+      stream << ",\n{\"name\":";
+      writeJsonString(stream, event.name);
+      stream << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.threadIdx << ",\"ts\":" << event.startNs / 1000.0
+             << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0 << "}";
+    }
+  }
+  stream << "\n]}\n";
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+}
+} // namespace gims
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <gimslib/sys/QueueScheduler.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+ui32 toIndex(QueueType queue)
+{
+  return static_cast<ui32>(queue);
+}
+} // namespace
+
+namespace gims
+{
+QueueScheduler::QueueScheduler()
+    : m_lastSignaledValues {}
+    , m_waitedValues {}
+{
+}
+
+std::vector<QueueSubmission> QueueScheduler::schedule(const std::vector<QueueJob>& jobs)
+{
+  // Jobs are signaled if a job of another queue depends on them, and the last job of each queue is signaled for the
+  // next schedule.
+  std::vector<bool>             signaled(jobs.size(), false);
+  std::array<ui32, nQueueTypes> lastJobs;
+  lastJobs.fill(~0u);
+  for (ui32 jobIdx = 0; jobIdx < jobs.size(); jobIdx++)
+  {
+    for (const ui32 dependency : jobs[jobIdx].dependencies)
+    {
+      if (dependency >= jobIdx)
+      {
+        throw std::invalid_argument("A job may only depend on earlier jobs.");
+      }
+      signaled[dependency] = signaled[dependency] || jobs[dependency].queue != jobs[jobIdx].queue;
+    }
+    lastJobs[toIndex(jobs[jobIdx].queue)] = jobIdx;
+  }
+  for (const ui32 lastJob : lastJobs)
+  {
+    if (lastJob != ~0u)
+    {
+      signaled[lastJob] = true;
+    }
+  }
+
+  const auto                    previousSignaledValues = m_lastSignaledValues;
+  std::array<bool, nQueueTypes> started                = {};
+  std::vector<QueueSubmission>  submissions(jobs.size());
+  for (ui32 jobIdx = 0; jobIdx < jobs.size(); jobIdx++)
+  {
+    const QueueJob&  job        = jobs[jobIdx];
+    const ui32       queueIdx   = toIndex(job.queue);
+    QueueSubmission& submission = submissions[jobIdx];
+    submission.jobIdx           = jobIdx;
+    submission.queue            = job.queue;
+
+    std::array<ui64, nQueueTypes> requiredValues = {};
+    if (!started[queueIdx])
+    {
+      requiredValues    = previousSignaledValues;
+      started[queueIdx] = true;
+    }
+    for (const ui32 dependency : job.dependencies)
+    {
+      const ui32 dependencyQueueIdx      = toIndex(jobs[dependency].queue);
+      requiredValues[dependencyQueueIdx] = std::max(requiredValues[dependencyQueueIdx],
+                                                    submissions[dependency].signalValue);
+    }
+    for (ui32 otherQueueIdx = 0; otherQueueIdx < nQueueTypes; otherQueueIdx++)
+    {
+      if (otherQueueIdx != queueIdx && requiredValues[otherQueueIdx] > m_waitedValues[queueIdx][otherQueueIdx])
+      {
+        submission.waits.push_back({static_cast<QueueType>(otherQueueIdx), requiredValues[otherQueueIdx]});
+        m_waitedValues[queueIdx][otherQueueIdx] = requiredValues[otherQueueIdx];
+      }
+    }
+
+    submission.signalValue = signaled[jobIdx] ? ++m_lastSignaledValues[queueIdx] : 0;
+  }
+  return submissions;
+}
+
+ui64 QueueScheduler::reserveSignalValue(QueueType queue)
+{
+  return ++m_lastSignaledValues[toIndex(queue)];
+}
+
+ui64 QueueScheduler::getLastSignaledValue(QueueType queue) const
+{
+  return m_lastSignaledValues[toIndex(queue)];
+}
+
+QueueTimelineSimulator::QueueTimelineSimulator()
+    : m_queueTimes {}
+{
+}
+
+std::vector<QueueTimelineSimulator::JobTiming> QueueTimelineSimulator::simulate(
+    const std::vector<QueueSubmission>& submissions, const std::vector<f64>& jobDurations)
+{
+  std::vector<JobTiming> timings(jobDurations.size(), {0.0, 0.0});
+  for (const auto& submission : submissions)
+  {
+    const ui32 queueIdx = toIndex(submission.queue);
+    f64        start    = m_queueTimes[queueIdx];
+    for (const auto& wait : submission.waits)
+    {
+      // Fence values grow with every signal, so the first signal of at least the value releases the wait.
+      const auto& signalTimes = m_signalTimes[toIndex(wait.queue)];
+      const auto  signal      = signalTimes.lower_bound(wait.fenceValue);
+      if (signal == signalTimes.end())
+      {
+        throw std::logic_error("A submission waits for a fence value that is not signaled before.");
+      }
+      start = std::max(start, signal->second);
+    }
+
+    const f64 end              = start + jobDurations.at(submission.jobIdx);
+    timings[submission.jobIdx] = {start, end};
+    m_queueTimes[queueIdx]     = end;
+    if (submission.signalValue != 0)
+    {
+      m_signalTimes[queueIdx][submission.signalValue] = end;
+    }
+  }
+  return timings;
+}
+
+f64 QueueTimelineSimulator::getQueueTime(QueueType queue) const
+{
+  return m_queueTimes[toIndex(queue)];
+}
+} // namespace gims
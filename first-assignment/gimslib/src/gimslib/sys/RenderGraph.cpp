@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <gimslib/sys/RenderGraph.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+ui64 alignUp(ui64 value, ui64 alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool lifetimesOverlap(ui32 firstUseA, ui32 lastUseA, ui32 firstUseB, ui32 lastUseB)
+{
+  return firstUseA <= lastUseB && firstUseB <= lastUseA;
+}
+} // namespace
+
+namespace gims
+{
+ui32 RenderGraph::importResource(const std::string& name, ResourceStates initialState, ResourceStates finalState)
+{
+  m_resources.push_back({name, false, initialState, finalState, {0, 1}});
+  return static_cast<ui32>(m_resources.size() - 1);
+}
+
+ui32 RenderGraph::createTransientResource(const std::string& name, const TransientResourceDesc& desc)
+{
+  m_resources.push_back({name, true, 0, 0, desc});
+  return static_cast<ui32>(m_resources.size() - 1);
+}
+
+ui32 RenderGraph::addPass(const std::string& name, const std::vector<RenderGraphResourceUsage>& reads,
+                          const std::vector<RenderGraphResourceUsage>& writes, bool hasSideEffects)
+{
+  Pass pass;
+  pass.name           = name;
+  pass.hasSideEffects = hasSideEffects;
+
+  const auto addUsage = [&](const RenderGraphResourceUsage& resourceUsage, bool write)
+  {
+    if (resourceUsage.resourceIdx >= m_resources.size())
+    {
+      throw std::invalid_argument("Pass " + name + " uses an unknown resource.");
+    }
+    for (auto& usage : pass.usages)
+    {
+      if (usage.resourceIdx == resourceUsage.resourceIdx)
+      {
+        if (usage.state != resourceUsage.state)
+        {
+          throw std::invalid_argument("Pass " + name + " uses " + m_resources[usage.resourceIdx].name +
+                                      " in different states.");
+        }
+        usage.read |= !write;
+        usage.write |= write;
+        return;
+      }
+    }
+    pass.usages.push_back({resourceUsage.resourceIdx, resourceUsage.state, !write, write});
+  };
+  for (const auto& read : reads)
+  {
+    addUsage(read, false);
+  }
+  for (const auto& write : writes)
+  {
+    addUsage(write, true);
+  }
+
+  m_passes.push_back(std::move(pass));
+  return static_cast<ui32>(m_passes.size() - 1);
+}
+
+CompiledRenderGraph RenderGraph::compile() const
+{
+  const ui32 nResources = getNumberOfResources();
+
+  CompiledRenderGraph result;
+  result.passCulled = cullPasses();
+  result.initialStates.resize(nResources);
+  result.nBarriers = 0;
+
+  std::vector<ui32> livePasses;
+  for (ui32 passIdx = 0; passIdx < m_passes.size(); passIdx++)
+  {
+    if (!result.passCulled[passIdx])
+    {
+      livePasses.push_back(passIdx);
+    }
+  }
+
+  // Consecutive passes that only read a resource are served by a single transition into the combination of their
+  // states, so it is computed backwards up to the next pass that writes.
+  std::vector<std::vector<ResourceStates>> combinedReadStates(m_passes.size());
+  std::vector<ResourceStates>              pendingReadStates(nResources, 0);
+  for (auto passIter = livePasses.rbegin(); passIter != livePasses.rend(); passIter++)
+  {
+    const Pass& pass = m_passes[*passIter];
+    combinedReadStates[*passIter].resize(pass.usages.size());
+    for (size_t usageIdx = 0; usageIdx < pass.usages.size(); usageIdx++)
+    {
+      const Usage& usage = pass.usages[usageIdx];
+      if (usage.write)
+      {
+        pendingReadStates[usage.resourceIdx] = 0;
+        combinedReadStates[*passIter][usageIdx] = usage.state;
+      }
+      else
+      {
+        pendingReadStates[usage.resourceIdx] |= usage.state;
+        combinedReadStates[*passIter][usageIdx] = pendingReadStates[usage.resourceIdx];
+      }
+    }
+  }
+
+  std::vector<ui32> firstUse(nResources, renderGraphInvalidIdx);
+  std::vector<ui32> lastUse(nResources, renderGraphInvalidIdx);
+  for (ui32 livePassIdx = 0; livePassIdx < livePasses.size(); livePassIdx++)
+  {
+    for (const auto& usage : m_passes[livePasses[livePassIdx]].usages)
+    {
+      if (firstUse[usage.resourceIdx] == renderGraphInvalidIdx)
+      {
+        firstUse[usage.resourceIdx] = livePassIdx;
+      }
+      lastUse[usage.resourceIdx] = livePassIdx;
+    }
+  }
+  const auto aliasedResources = placeTransientResources(firstUse, lastUse, result);
+
+  std::vector<ResourceStates> currentStates(nResources);
+  std::vector<bool>           used(nResources, false);
+  std::vector<bool>           lastUseWasRead(nResources, false);
+  std::vector<bool>           lastUseWasWrite(nResources, false);
+  for (ui32 resourceIdx = 0; resourceIdx < nResources; resourceIdx++)
+  {
+    currentStates[resourceIdx]        = m_resources[resourceIdx].initialState;
+    result.initialStates[resourceIdx] = m_resources[resourceIdx].initialState;
+  }
+
+  for (const ui32 passIdx : livePasses)
+  {
+    const Pass&                     pass = m_passes[passIdx];
+    RenderGraphStep                 step;
+    std::vector<RenderGraphBarrier> aliasingBarriers;
+    step.passIdx = passIdx;
+    for (size_t usageIdx = 0; usageIdx < pass.usages.size(); usageIdx++)
+    {
+      const Usage&         usage         = pass.usages[usageIdx];
+      const ui32           resourceIdx   = usage.resourceIdx;
+      const ResourceStates requiredState = combinedReadStates[passIdx][usageIdx];
+      ResourceStates&      currentState  = currentStates[resourceIdx];
+
+      if (m_resources[resourceIdx].transient && !used[resourceIdx])
+      {
+        // Transient resources are created in the state of their first use.
+        result.initialStates[resourceIdx] = requiredState;
+        currentState                      = requiredState;
+        step.activated.push_back(resourceIdx);
+        const auto& aliased = aliasedResources[resourceIdx];
+        if (!aliased.empty())
+        {
+          aliasingBarriers.push_back({RenderGraphBarrier::Type::Aliasing, resourceIdx,
+                                      aliased.size() == 1 ? aliased.front() : renderGraphInvalidIdx, 0, 0});
+        }
+      }
+      else if (currentState == requiredState)
+      {
+        if (requiredState == resourceStateUnorderedAccess && (usage.write || lastUseWasWrite[resourceIdx]))
+        {
+          step.barriers.push_back({RenderGraphBarrier::Type::UnorderedAccess, resourceIdx, renderGraphInvalidIdx,
+                                   currentState, currentState});
+        }
+      }
+      else if (!usage.write && lastUseWasRead[resourceIdx] && requiredState != 0 &&
+               (currentState & requiredState) == requiredState)
+      {
+        // Already in a combination of read states that includes the required ones.
+      }
+      else
+      {
+        step.barriers.push_back(
+            {RenderGraphBarrier::Type::Transition, resourceIdx, renderGraphInvalidIdx, currentState, requiredState});
+        currentState = requiredState;
+      }
+      used[resourceIdx]            = true;
+      lastUseWasRead[resourceIdx]  = !usage.write;
+      lastUseWasWrite[resourceIdx] = usage.write;
+    }
+    step.barriers.insert(step.barriers.begin(), aliasingBarriers.begin(), aliasingBarriers.end());
+    result.nBarriers += static_cast<ui32>(step.barriers.size());
+    result.steps.push_back(std::move(step));
+  }
+
+  RenderGraphStep finalStep;
+  finalStep.passIdx = renderGraphInvalidIdx;
+  for (ui32 resourceIdx = 0; resourceIdx < nResources; resourceIdx++)
+  {
+    const Resource& resource = m_resources[resourceIdx];
+    if (!resource.transient && currentStates[resourceIdx] != resource.finalState)
+    {
+      finalStep.barriers.push_back({RenderGraphBarrier::Type::Transition, resourceIdx, renderGraphInvalidIdx,
+                                    currentStates[resourceIdx], resource.finalState});
+    }
+  }
+  result.nBarriers += static_cast<ui32>(finalStep.barriers.size());
+  result.steps.push_back(std::move(finalStep));
+
+  return result;
+}
+
+void RenderGraph::clear()
+{
+  m_resources.clear();
+  m_passes.clear();
+}
+
+ui32 RenderGraph::getNumberOfPasses() const
+{
+  return static_cast<ui32>(m_passes.size());
+}
+
+ui32 RenderGraph::getNumberOfResources() const
+{
+  return static_cast<ui32>(m_resources.size());
+}
+
+const std::string& RenderGraph::getPassName(ui32 passIdx) const
+{
+  return m_passes.at(passIdx).name;
+}
+
+const std::string& RenderGraph::getResourceName(ui32 resourceIdx) const
+{
+  return m_resources.at(resourceIdx).name;
+}
+
+bool RenderGraph::isTransient(ui32 resourceIdx) const
+{
+  return m_resources.at(resourceIdx).transient;
+}
+
+std::vector<bool> RenderGraph::cullPasses() const
+{
+  // Backwards, a resource is live if a pass that is executed later reads its current contents. The contents of
+  // imported resources are used after the graph.
+  std::vector<bool> live(m_resources.size());
+  for (size_t resourceIdx = 0; resourceIdx < m_resources.size(); resourceIdx++)
+  {
+    live[resourceIdx] = !m_resources[resourceIdx].transient;
+  }
+
+  std::vector<bool> passCulled(m_passes.size(), true);
+  for (size_t passIdx = m_passes.size(); passIdx-- > 0;)
+  {
+    const Pass& pass   = m_passes[passIdx];
+    bool        needed = pass.hasSideEffects;
+    for (const auto& usage : pass.usages)
+    {
+      needed |= usage.write && live[usage.resourceIdx];
+    }
+    if (!needed)
+    {
+      continue;
+    }
+    passCulled[passIdx] = false;
+    for (const auto& usage : pass.usages)
+    {
+      if (usage.write)
+      {
+        live[usage.resourceIdx] = false;
+      }
+    }
+    for (const auto& usage : pass.usages)
+    {
+      if (usage.read)
+      {
+        live[usage.resourceIdx] = true;
+      }
+    }
+  }
+  return passCulled;
+}
+
+std::vector<std::vector<ui32>> RenderGraph::placeTransientResources(const std::vector<ui32>& firstUse,
+                                                                    const std::vector<ui32>& lastUse,
+                                                                    CompiledRenderGraph&     result) const
+{
+  result.heapOffsets.assign(m_resources.size(), ~0ull);
+  result.heapSize      = 0;
+  result.transientSize = 0;
+
+  // Largest first, each at the lowest offset that does not collide with a resource whose lifetime overlaps.
+  std::vector<ui32> transients;
+  for (ui32 resourceIdx = 0; resourceIdx < m_resources.size(); resourceIdx++)
+  {
+    if (m_resources[resourceIdx].transient && firstUse[resourceIdx] != renderGraphInvalidIdx)
+    {
+      transients.push_back(resourceIdx);
+    }
+  }
+  std::stable_sort(transients.begin(), transients.end(), [this](ui32 a, ui32 b)
+                   { return m_resources[a].desc.sizeInBytes > m_resources[b].desc.sizeInBytes; });
+
+  std::vector<ui32> placed;
+  for (const ui32 resourceIdx : transients)
+  {
+    const TransientResourceDesc& desc      = m_resources[resourceIdx].desc;
+    const ui64                   alignment = std::max<ui64>(desc.alignment, 1);
+
+    std::vector<std::pair<ui64, ui64>> occupied;
+    for (const ui32 otherIdx : placed)
+    {
+      if (lifetimesOverlap(firstUse[resourceIdx], lastUse[resourceIdx], firstUse[otherIdx], lastUse[otherIdx]))
+      {
+        occupied.emplace_back(result.heapOffsets[otherIdx],
+                              result.heapOffsets[otherIdx] + m_resources[otherIdx].desc.sizeInBytes);
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+
+    ui64 offset = 0;
+    for (const auto& range : occupied)
+    {
+      if (alignUp(offset, alignment) + desc.sizeInBytes <= range.first)
+      {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    offset = alignUp(offset, alignment);
+
+    result.heapOffsets[resourceIdx] = offset;
+    result.heapSize                 = std::max(result.heapSize, offset + desc.sizeInBytes);
+    result.transientSize += alignUp(desc.sizeInBytes, alignment);
+    placed.push_back(resourceIdx);
+  }
+
+  // A resource takes over the memory of all resources it overlaps that were used before it.
+  std::vector<std::vector<ui32>> aliased(m_resources.size());
+  for (const ui32 resourceIdx : placed)
+  {
+    const ui64 begin = result.heapOffsets[resourceIdx];
+    const ui64 end   = begin + m_resources[resourceIdx].desc.sizeInBytes;
+    for (const ui32 otherIdx : placed)
+    {
+      const ui64 otherBegin = result.heapOffsets[otherIdx];
+      const ui64 otherEnd   = otherBegin + m_resources[otherIdx].desc.sizeInBytes;
+      if (lastUse[otherIdx] < firstUse[resourceIdx] && begin < otherEnd && otherBegin < end)
+      {
+        aliased[resourceIdx].push_back(otherIdx);
+      }
+    }
+  }
+  return aliased;
+}
+} // namespace gims
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <gimslib/ui/ProfilerView.hpp>
+#include <imgui.h>
+#include <string_view>
+
+namespace
+{
+using namespace gims;
+
+// Same name, same color, so zones can be recognized across threads and frames.
+ImU32 getZoneColor(const char* name)
+{
+  const size_t hash = std::hash<std::string_view>()(name);
+  const f32    hue  = static_cast<f32>(hash % 360) / 360.0f;
+  f32          r, g, b;
+  ImGui::ColorConvertHSVtoRGB(hue, 0.5f, 0.8f, r, g, b);
+  return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+}
+} // namespace
+
+namespace gims
+{
+void drawProfilerTimeline(const ProfileCapture& capture, f32 rowHeight)
+{
+  const f32 width       = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+  const f64 durationNs  = static_cast<f64>(std::max<ui64>(capture.endNs - capture.startNs, 1));
+  const f64 pixelsPerNs = width / durationNs;
+  ImGui::Text("Last %.2f ms", durationNs * 1e-6);
+
+  ImDrawList* drawList = ImGui::GetWindowDrawList();
+  for (const auto& thread : capture.threads)
+  {
+    ImGui::Text("%s%s", thread.threadName.c_str(), thread.incomplete ? " (older zones overwritten)" : "");
+    ui32 maxDepth = 0;
+    for (const auto& event : thread.events)
+    {
+      maxDepth = std::max(maxDepth, event.depth);
+    }
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(width, static_cast<f32>(maxDepth + 1) * rowHeight));
+
+    for (const auto& event : thread.events)
+    {
+      const f64 start = static_cast<f64>(std::max(event.startNs, capture.startNs) - capture.startNs);
+      const f64 end   = static_cast<f64>(std::max(event.endNs, capture.startNs) - capture.startNs);
+      // Zones shorter than a pixel are widened, so they stay visible.
+      const ImVec2 min(origin.x + static_cast<f32>(start * pixelsPerNs),
+                       origin.y + static_cast<f32>(event.depth) * rowHeight);
+      const ImVec2 max(std::max(origin.x + static_cast<f32>(end * pixelsPerNs), min.x + 1.0f),
+                       min.y + rowHeight - 1.0f);
+      drawList->AddRectFilled(min, max, getZoneColor(event.name));
+      if (ImGui::CalcTextSize(event.name).x < max.x - min.x - 4.0f)
+      {
+        drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_BLACK, event.name);
+      }
+      if (ImGui::IsMouseHoveringRect(min, max))
+      {
+        ImGui::SetTooltip("%s: %.3f ms", event.name, static_cast<f64>(event.endNs - event.startNs) * 1e-6);
+      }
+    }
+  }
+}
+} // namespace gims
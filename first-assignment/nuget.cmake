@@ -48,6 +48,9 @@ function(get_nuget_package)
     endif()
 
     
+    # e.g. Microsoft.Direct3D.DXC_DIRECTORY, for tools of the package that run at build time
+    set(${NAMED_ARGS_PACKAGE}_DIRECTORY ${DOWNLOADED_PACKAGE_DIRECTORY} PARENT_SCOPE)
+
     add_library(${NAMED_ARGS_PACKAGE} INTERFACE)
     target_include_directories(${NAMED_ARGS_PACKAGE} INTERFACE ${DOWNLOADED_PACKAGE_DIRECTORY}/build/native/include)
 
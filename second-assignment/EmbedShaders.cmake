@@ -0,0 +1,43 @@
+# Writes a C++ source that embeds compiled shaders into an executable and registers them with
+# gims::ShaderLibrary::getEmbedded(). Run in script mode by embed_shaders in CreateApp.cmake:
+#   cmake -DMANIFEST_FILE=<file> -DOUTPUT_FILE=<file> -P EmbedShaders.cmake
+# Each line of the manifest has the form <dxil file>|<shader name>|<entry point>|<target profile>|<defines>.
+cmake_minimum_required(VERSION 3.21)
+
+file(STRINGS ${MANIFEST_FILE} ENTRIES)
+string(REPEAT "[0-9a-f]" 64 HEX_LINE)
+
+set(ARRAYS "")
+set(TABLE "")
+set(INDEX 0)
+foreach(ENTRY ${ENTRIES})
+    string(REPLACE "|" ";" FIELDS "${ENTRY}")
+    list(GET FIELDS 0 DXIL_FILE)
+    list(GET FIELDS 1 SHADER_NAME)
+    list(GET FIELDS 2 ENTRY_POINT)
+    list(GET FIELDS 3 TARGET_PROFILE)
+    list(GET FIELDS 4 DEFINES)
+
+    # 32 bytes per line
+    file(READ ${DXIL_FILE} HEX HEX)
+    string(REGEX REPLACE "(${HEX_LINE})" "\\1\n" HEX "${HEX}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+
+    string(APPEND ARRAYS "alignas(4) const gims::ui8 shader${INDEX}[] = {\n${BYTES}};\n\n")
+    string(APPEND TABLE "    {L\"${SHADER_NAME}\", L\"${ENTRY_POINT}\", L\"${TARGET_PROFILE}\", L\"${DEFINES}\", shader${INDEX},\n")
+    string(APPEND TABLE "     sizeof(shader${INDEX})},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+file(WRITE ${OUTPUT_FILE} "// Generated by EmbedShaders.cmake from the SHADER_ENTRY_POINTS of the app, do not edit.
+#include <gimslib/d3d/ShaderLibrary.hpp>
+
+namespace
+{
+${ARRAYS}const gims::EmbeddedShader embeddedShaders[] = {
+${TABLE}};
+
+const gims::EmbeddedShaderRegistration registration(embeddedShaders,
+                                                    sizeof(embeddedShaders) / sizeof(embeddedShaders[0]));
+} // namespace
+")
@@ -1,3 +1,4 @@
+#pragma once
 #include <d3d12.h>
 #include <gimslib/types.hpp>
 #include <wrl.h>
@@ -0,0 +1,75 @@
+#pragma once
+#include "SceneTypes.hpp"
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// Triangle mesh in the vertex layout of TriangleMeshD3D12.
+/// </summary>
+struct ImportedMesh
+{
+  std::vector<Vertex> vertices;
+  std::vector<ui32>   indices;     //! Triples of indices form a triangle.
+  ui32                materialIdx = 0;
+};
+
+/// <summary>
+/// Material with the constants and texture slots the SceneGraphFactory creates from Assimp materials.
+/// </summary>
+struct ImportedMaterial
+{
+  f32v4               emissive;
+  f32v4               ambient;
+  f32v4               diffuse;
+  f32v4               specularColorAndExponent;
+  std::array<ui32, 5> textureIndices; //! Ambient, diffuse, specular, emissive, and height, see getTexture.
+  ui32                textureMask = 0; //! Bit i is set if slot i holds a texture of the material.
+};
+
+/// <summary>
+/// Encoded texture in memory instead of a file of its own, e.g., a PNG or a DDS file inside a package.
+/// </summary>
+struct ImportedTexture
+{
+  const ui8* data;
+  size_t     size;
+};
+
+/// <summary>
+/// Scene read without Assimp. Node 0 is the root node.
+/// </summary>
+struct ImportedScene
+{
+  std::vector<ImportedMesh>                       meshes;
+  std::vector<SceneNode>                          nodes;
+  std::vector<ImportedMaterial>                   materials;
+  std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex; //! See textureFilenameToIndex.
+  std::vector<ImportedTexture>                    textures; //! Texture i + 3, after the ones in files.
+  std::shared_ptr<const void>                     storage;  //! Keeps the memory of the textures alive.
+};
+
+/// <summary>
+/// Reads a glTF 2.0 scene with GltfFile, whose buffers are mapped into memory, and converts it into the scene Assimp
+/// creates with the post-processing steps of importAssimpScene: a left-handed coordinate system, one mesh per
+/// primitive, smooth normals for meshes without normals, and colors and textures of the materials as Assimp maps them.
+/// The vertices are written straight into their final layout, without the intermediate copies of Assimp. Unlike
+/// Assimp, meshes are neither merged nor reordered for the vertex cache. Only textures that the material slots use
+/// are listed. Does not depend on D3D12, so the import can be benchmarked without a GPU.
+/// </summary>
+/// <param name="pathToScene">Path to the .gltf or .glb file.</param>
+/// <returns>The scene.</returns>
+/// <exception cref="std::runtime_error">If the file cannot be read, or uses features that are not supported, e.g.,
+/// sparse accessors, points, lines, or images that are not in files of their own. importAssimpScene can read those.
+/// </exception>
+ImportedScene importGltfScene(const std::filesystem::path& pathToScene);
+
+/// <summary>
+/// Returns true for .gltf and .glb files, which importGltfScene can read.
+/// </summary>
+bool isGltfFile(const std::filesystem::path& pathToScene);
+} // namespace gims
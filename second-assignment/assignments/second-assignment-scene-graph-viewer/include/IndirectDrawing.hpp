@@ -0,0 +1,167 @@
+#pragma once
+#include "InstanceBatching.hpp"
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// Kind of an argument in an indirect command. Mirrors the D3D12_INDIRECT_ARGUMENT_TYPE values we use.
+/// </summary>
+enum class IndirectArgumentType
+{
+  Constant,
+  VertexBufferView,
+  IndexBufferView,
+  DrawIndexed
+};
+
+/// <summary>
+/// One argument of an indirect command, i.e., the platform independent form of D3D12_INDIRECT_ARGUMENT_DESC.
+/// </summary>
+struct IndirectArgument
+{
+  IndirectArgumentType type                    = IndirectArgumentType::DrawIndexed;
+  ui32                 rootParameterIdx        = 0; //! Only for constants.
+  ui32                 destOffsetIn32BitValues = 0; //! Only for constants.
+  ui32                 num32BitValues          = 0; //! Only for constants.
+};
+
+/// <summary>
+/// One indirect draw command as it is stored in the argument buffer. The layout must match
+/// getIndirectDrawCommandLayout() and the IndirectDrawCommand struct in IndirectCulling.hlsl.
+/// </summary>
+struct IndirectDrawCommand
+{
+  // Root constants: material index and instance index.
+  ui32 materialIndex = 0;
+  ui32 instanceIndex = 0;
+  // D3D12_VERTEX_BUFFER_VIEW
+  ui64 vertexBufferLocation = 0;
+  ui32 vertexBufferSize     = 0;
+  ui32 vertexBufferStride   = 0;
+  // D3D12_INDEX_BUFFER_VIEW
+  ui64 indexBufferLocation = 0;
+  ui32 indexBufferSize     = 0;
+  ui32 indexBufferFormat   = 0;
+  // D3D12_DRAW_INDEXED_ARGUMENTS
+  ui32 indexCountPerInstance = 0;
+  ui32 instanceCount         = 0;
+  ui32 startIndexLocation    = 0;
+  i32  baseVertexLocation    = 0;
+  ui32 startInstanceLocation = 0;
+  // Keeps the stride a multiple of 16 bytes.
+  ui32 padding = 0;
+};
+
+/// <summary>
+/// Per command data the culling kernel needs in addition to the command itself.
+/// </summary>
+struct IndirectCullRecord
+{
+  f32v4 center            = f32v4(0); //! xyz: Center of the mesh bounding box in mesh space.
+  f32v4 extent            = f32v4(0); //! xyz: Half the size of the mesh bounding box.
+  ui32  instanceIndex     = 0;        //! Index into the instance transformations.
+  ui32  groupIdx          = 0;        //! Index of the material group, i.e., of the counter.
+  ui32  groupFirstCommand = 0;        //! First slot of the group in the argument buffer.
+  ui32  padding           = 0;
+};
+
+/// <summary>
+/// Commands that share a material. Each group is submitted with one ExecuteIndirect, since the texture descriptors
+/// can't be switched by an indirect command.
+/// </summary>
+struct IndirectMaterialGroup
+{
+  ui32 materialIndex = 0;
+  ui32 firstCommand  = 0;
+  ui32 nCommands     = 0;
+};
+
+/// <summary>
+/// GPU buffer locations and bounds of one mesh, i.e., the input for packing the commands.
+/// </summary>
+struct IndirectMeshBuffers
+{
+  ui64  vertexBufferLocation = 0;
+  ui32  vertexBufferSize     = 0;
+  ui32  vertexBufferStride   = 0;
+  ui64  indexBufferLocation  = 0;
+  ui32  indexBufferSize      = 0;
+  ui32  indexBufferFormat    = 0;
+  ui32  nIndices             = 0;
+  ui32  materialIndex        = 0;
+  f32v3 lowerLeftBottom      = f32v3(0);
+  f32v3 upperRightTop        = f32v3(0);
+};
+
+/// <summary>
+/// Everything that has to be uploaded once for GPU driven rendering.
+/// </summary>
+struct IndirectDrawData
+{
+  std::vector<IndirectDrawCommand>   commandTemplates; //! One command per instance, grouped by material.
+  std::vector<IndirectCullRecord>    cullRecords;      //! One record per command template.
+  std::vector<IndirectMaterialGroup> groups;           //! Groups ordered by material index.
+};
+
+/// <summary>
+/// The six planes (left, right, bottom, top, near, far) of a view frustum. A point p is inside if dot(plane.xyz, p) +
+/// plane.w >= 0 for every plane. The planes are not normalized.
+/// </summary>
+struct FrustumPlanes
+{
+  f32v4 planes[6];
+};
+
+/// <summary>
+/// Returns the layout of IndirectDrawCommand as a list of arguments for the command signature.
+/// </summary>
+/// <param name="rootConstantsParameterIdx">Root parameter of the per draw root constants. The material index and the
+/// instance index are written to the 32-bit values 16 and 17, behind the model view matrix.</param>
+std::vector<IndirectArgument> getIndirectDrawCommandLayout(ui32 rootConstantsParameterIdx);
+
+/// <summary>
+/// Returns the number of bytes an argument occupies in the argument buffer.
+/// </summary>
+ui32 getIndirectArgumentSizeInBytes(const IndirectArgument& argument);
+
+/// <summary>
+/// Returns the byte offset of every argument of the layout. GPU virtual addresses are aligned to 8 bytes. The last
+/// element is the size of the whole command, i.e., the byte stride of the command signature.
+/// </summary>
+std::vector<ui32> getIndirectArgumentOffsets(const std::vector<IndirectArgument>& layout);
+
+/// <summary>
+/// Creates one command template and one cull record per instance. The commands are grouped by material, within a
+/// group they are ordered by mesh and instance.
+/// </summary>
+/// <param name="batches">Instance batches of the scene.</param>
+/// <param name="meshes">Buffers and bounds of every mesh of the scene.</param>
+IndirectDrawData packIndirectDrawData(const std::vector<InstanceBatch>&       batches,
+                                      const std::vector<IndirectMeshBuffers>& meshes);
+
+/// <summary>
+/// Extracts the frustum planes from a view projection matrix with a [0, 1] depth range.
+/// </summary>
+FrustumPlanes extractFrustumPlanes(const f32m4& viewProjection);
+
+/// <summary>
+/// CPU reference of the culling kernel in IndirectCulling.hlsl. Uses the same operations in the same order, so it
+/// decides exactly like the GPU.
+/// </summary>
+/// <param name="frustum">The frustum planes.</param>
+/// <param name="instanceTransformation">Mesh to scene transformation of the instance.</param>
+/// <param name="cullRecord">Bounds of the mesh.</param>
+/// <returns>True if the bounding box is not completely outside one of the planes.</returns>
+bool isInstanceVisible(const FrustumPlanes& frustum, const f32m4& instanceTransformation,
+                       const IndirectCullRecord& cullRecord);
+
+/// <summary>
+/// Runs the CPU reference for every command template.
+/// </summary>
+/// <returns>Indices of the visible command templates in ascending order.</returns>
+std::vector<ui32> cullIndirectDrawDataReference(const FrustumPlanes& frustum,
+                                                const std::vector<f32m4>& instanceTransformations,
+                                                const IndirectDrawData& indirectDrawData);
+} // namespace gims
@@ -0,0 +1,128 @@
+#pragma once
+#include "IndirectDrawing.hpp"
+#include "Scene.hpp"
+#include <d3d12.h>
+#include <gimslib/types.hpp>
+#include <vector>
+#include <wrl.h>
+using Microsoft::WRL::ComPtr;
+
+namespace gims
+{
+/// <summary>
+/// GPU driven rendering of a scene. A compute pass culls every instance against the view frustum and writes the draw
+/// commands of the visible instances plus one counter per material. The commands are submitted with one
+/// ExecuteIndirect per material, so the CPU cost does not depend on the number of instances.
+/// </summary>
+class IndirectSceneRendererD3D12
+{
+public:
+  /// <summary>
+  /// Creates an empty renderer.
+  /// </summary>
+  IndirectSceneRendererD3D12();
+
+  /// <summary>
+  /// Packs the command templates of the scene and creates all GPU resources.
+  /// </summary>
+  /// <param name="scene">The scene. Its meshes and instance table must outlive the renderer.</param>
+  /// <param name="device">Device on which the resources are created.</param>
+  /// <param name="graphicsRootSignature">Root signature of the triangle pipeline.</param>
+  /// <param name="modelViewRootParameterIdx">Root parameter of the 18 per draw root constants.</param>
+  /// <param name="cullingShader">Compiled CS_main of IndirectCulling.hlsl.</param>
+  /// <param name="frameCount">Number of frames in flight.</param>
+  IndirectSceneRendererD3D12(const Scene& scene, const ComPtr<ID3D12Device>& device,
+                             const ComPtr<ID3D12RootSignature>& graphicsRootSignature,
+                             ui32 modelViewRootParameterIdx, const D3D12_SHADER_BYTECODE& cullingShader,
+                             ui32 frameCount);
+
+  /// <summary>
+  /// Resets the counters and records the culling pass. Changes the compute root signature and the pipeline state.
+  /// </summary>
+  /// <param name="commandList">The command list.</param>
+  /// <param name="viewProjection">Maps scene space to clip space.</param>
+  /// <param name="frameIdx">Index of the current frame in flight.</param>
+  void cull(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const f32m4& viewProjection, ui32 frameIdx);
+
+  /// <summary>
+  /// Records one ExecuteIndirect per material. The triangle pipeline and its root signature must be set.
+  /// </summary>
+  /// <param name="commandList">The command list.</param>
+  /// <param name="scene">The scene passed to the constructor.</param>
+  /// <param name="viewMatrix">Maps scene space to view space.</param>
+  /// <param name="modelViewRootParameterIdx">Root parameter of the 18 per draw root constants.</param>
+  /// <param name="materialTableRootParameterIdx">Root parameter of the material table.</param>
+  /// <param name="instanceTableRootParameterIdx">Root parameter of the instance table.</param>
+  /// <param name="srvRootParameterIdx">Root parameter of the texture descriptor table.</param>
+  /// <param name="frameIdx">Index of the current frame in flight.</param>
+  void draw(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const Scene& scene, const f32m4& viewMatrix,
+            ui32 modelViewRootParameterIdx, ui32 materialTableRootParameterIdx, ui32 instanceTableRootParameterIdx,
+            ui32 srvRootParameterIdx, ui32 frameIdx);
+
+  /// <summary>
+  /// If enabled, the visible commands are read back every frame and compared with the CPU reference.
+  /// </summary>
+  void setValidation(bool enabled);
+
+  /// <summary>
+  /// Returns the total number of commands, i.e., of instances.
+  /// </summary>
+  ui32 getNumberOfCommands() const;
+
+  /// <summary>
+  /// Returns the number of commands the GPU found visible in the last validated frame.
+  /// </summary>
+  ui32 getNumberOfVisibleCommandsOnGPU() const;
+
+  /// <summary>
+  /// Returns the number of commands the CPU reference found visible in the last validated frame.
+  /// </summary>
+  ui32 getNumberOfVisibleCommandsOnCPU() const;
+
+  /// <summary>
+  /// Returns true if the GPU and the CPU reference found exactly the same instances visible in the last validated
+  /// frame.
+  /// </summary>
+  bool isValidationMatching() const;
+
+  IndirectSceneRendererD3D12(const IndirectSceneRendererD3D12& other)                = default;
+  IndirectSceneRendererD3D12(IndirectSceneRendererD3D12&& other) noexcept            = default;
+  IndirectSceneRendererD3D12& operator=(const IndirectSceneRendererD3D12& other)     = default;
+  IndirectSceneRendererD3D12& operator=(IndirectSceneRendererD3D12&& other) noexcept = default;
+
+private:
+  /// <summary>
+  /// Frustum and number of commands, uploaded as root constants of the culling pass.
+  /// </summary>
+  struct CullingConstants
+  {
+    FrustumPlanes frustum;
+    ui32          nCommands;
+  };
+
+  /// <summary>
+  /// Compares the visible commands read back from the GPU with the CPU reference for the same frustum.
+  /// </summary>
+  void validate(ui32 frameIdx);
+
+  IndirectDrawData                    m_indirectDrawData;       //! Command templates, cull records, and groups.
+  std::vector<f32m4>                  m_instanceTransformations; //! CPU copy of the instance table for validation.
+  D3D12_GPU_VIRTUAL_ADDRESS           m_instanceTableLocation;  //! The instance table of the scene.
+  StructuredBufferD3D12               m_commandTemplates;       //! One command per instance.
+  StructuredBufferD3D12               m_cullRecords;            //! One cull record per command.
+  ComPtr<ID3D12Resource>              m_visibleCommands;        //! Commands of the visible instances, per group.
+  ComPtr<ID3D12Resource>              m_visibleCommandCounts;   //! One counter per group.
+  ComPtr<ID3D12Resource>              m_zeroCounts;             //! Source for resetting the counters.
+  std::vector<ComPtr<ID3D12Resource>> m_readBackBuffers;        //! Counters followed by commands, per frame.
+  std::vector<CullingConstants>       m_readBackConstants;      //! Frustum of the commands in the read back buffer.
+  std::vector<bool>                   m_readBackPending;        //! True if the read back buffer holds a frame.
+  ComPtr<ID3D12CommandSignature>      m_commandSignature;       //! Layout of IndirectDrawCommand.
+  ComPtr<ID3D12RootSignature>         m_cullingRootSignature;   //! Root signature of the culling pass.
+  ComPtr<ID3D12PipelineState>         m_cullingPipelineState;   //! Pipeline of the culling pass.
+  CullingConstants                    m_cullingConstants;       //! Constants of the current frame.
+  bool                                m_validationEnabled;      //! Read back and compare with the CPU reference.
+  ui32                                m_nVisibleCommandsOnGPU;  //! Result of the last validation.
+  ui32                                m_nVisibleCommandsOnCPU;  //! Result of the last validation.
+  bool                                m_validationMatching;     //! Result of the last validation.
+};
+} // namespace gims
@@ -0,0 +1,46 @@
+#pragma once
+#include "SceneTypes.hpp"
+#include <iosfwd>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// All occurrences of one mesh in the scene graph, drawn with a single instanced draw call.
+/// </summary>
+struct InstanceBatch
+{
+  ui32 meshIdx       = 0; //! Index of the mesh, i.e., Scene::m_meshes[].
+  ui32 firstInstance = 0; //! Index of the first instance transformation of this batch.
+  ui32 nInstances    = 0; //! Number of instances.
+};
+
+/// <summary>
+/// The instance batches of a scene graph together with the flattened instance transformations.
+/// </summary>
+struct InstanceBatches
+{
+  std::vector<InstanceBatch> batches;                 //! One batch per mesh that is referenced by at least one node.
+  std::vector<f32m4>         instanceTransformations; //! Transformations from mesh to scene space, grouped by batch.
+  ui32                       nDrawCallsWithoutInstancing = 0; //! One draw call per mesh occurrence.
+  ui32                       nDrawCallsWithInstancing    = 0; //! One draw call per batch.
+};
+
+/// <summary>
+/// Traverses the scene graph starting at the root node, accumulates the transformations and groups all nodes that
+/// reference the same mesh into one batch. Batches are ordered by mesh index, instances within a batch by traversal
+/// order.
+/// </summary>
+/// <param name="nodes">Nodes of the scene graph.</param>
+/// <param name="nMeshes">Number of meshes in the scene. Mesh indices outside this range are skipped.</param>
+/// <param name="rootNodeIdx">Index of the root node.</param>
+/// <returns>The batches and the per-instance transformations.</returns>
+InstanceBatches createInstanceBatches(const std::vector<SceneNode>& nodes, ui32 nMeshes, ui32 rootNodeIdx = 0);
+
+/// <summary>
+/// Writes the number of batches, instances, and draw calls with and without instancing to the stream.
+/// </summary>
+/// <param name="stream">The output stream.</param>
+/// <param name="instanceBatches">The batches.</param>
+void printInstanceBatchingReport(std::ostream& stream, const InstanceBatches& instanceBatches);
+} // namespace gims
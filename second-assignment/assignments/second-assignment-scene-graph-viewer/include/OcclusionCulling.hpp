@@ -0,0 +1,202 @@
+#pragma once
+#include "AABB.hpp"
+#include "InstanceBatching.hpp"
+#include "StaticBatching.hpp"
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <iosfwd>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// Settings of the software occlusion culling.
+/// </summary>
+struct OcclusionCullingSettings
+{
+  ui32 width                   = 256;   //! Width of the depth buffer. Rounded up to a multiple of 4.
+  ui32 height                  = 128;   //! Height of the depth buffer.
+  ui32 maxNumberOfOccluders    = 64;    //! Only the largest instances are rasterized.
+  ui32 maxTrianglesPerOccluder = 10000; //! Instances with more triangles are too expensive to serve as occluder.
+  ui32 nBands                  = 16;    //! Number of horizontal screen bands rasterized in parallel.
+  bool useSimd                 = true;  //! Four pixels at once with SSE2 where available, else one at a time.
+};
+
+/// <summary>
+/// A triangle mesh in scene space that is rasterized into the depth buffer.
+/// </summary>
+struct Occluder
+{
+  std::vector<f32v3> positions;                               //! Positions in mesh space.
+  std::vector<ui32>  indices;                                 //! Triangle list.
+  f32m4              transformation = glm::identity<f32m4>(); //! Mesh to scene transformation.
+};
+
+/// <summary>
+/// A bounding box in scene space that is tested against the depth buffer.
+/// </summary>
+struct OcclusionQuery
+{
+  f32v3 lowerLeftBottom = f32v3(0);
+  f32v3 upperRightTop   = f32v3(0);
+};
+
+/// <summary>
+/// Cost and result of culling one frame.
+/// </summary>
+struct OcclusionCullingFrameStatistics
+{
+  f64  rasterizationMilliseconds = 0.0; //! Transforming, clipping, and rasterizing the occluders.
+  f64  hiZMilliseconds           = 0.0; //! Building the hierarchical depth buffer.
+  f64  testMilliseconds          = 0.0; //! Testing the queries.
+  ui32 nOccluderTriangles        = 0;   //! Triangles that reached the rasterizer.
+  ui32 nQueries                  = 0;   //! Number of tested bounding boxes.
+  ui32 nOccluded                 = 0;   //! Number of bounding boxes that are hidden.
+
+  /// <summary>
+  /// Returns the total time of the frame.
+  /// </summary>
+  f64 getTotalMilliseconds() const;
+};
+
+/// <summary>
+/// Summary of the culling statistics of many frames, e.g., of a camera path.
+/// </summary>
+struct OcclusionCullingReport
+{
+  ui32 nFrames                     = 0;
+  f64  averageMillisecondsPerFrame = 0.0;
+  f64  maxMillisecondsPerFrame     = 0.0;
+  f64  rejectedFraction            = 0.0; //! Occluded queries divided by tested queries over all frames.
+};
+
+/// <summary>
+/// Software occlusion culling. A few large occluders are rasterized depth-only at low resolution on the CPU, the
+/// depth buffer is reduced to a max pyramid, and bounding boxes are tested against the pyramid before they are
+/// submitted. The rasterizer splits the screen into horizontal bands that are processed in parallel and evaluates four
+/// pixels at once with SSE2 where available.
+/// Depth follows the D3D12 convention: 0 is the near plane, 1 the far plane, smaller values are closer.
+/// </summary>
+class OcclusionCuller
+{
+public:
+  /// <summary>
+  /// Creates a culler that runs on the calling thread only and has no occluders.
+  /// </summary>
+  OcclusionCuller();
+
+  /// <summary>
+  /// Creates a culler.
+  /// </summary>
+  /// <param name="settings">Resolution and limits.</param>
+  /// <param name="threadPool">Threads for rasterization. Must outlive the culler. May be nullptr.</param>
+  OcclusionCuller(const OcclusionCullingSettings& settings, ThreadPool* threadPool);
+
+  /// <summary>
+  /// Replaces the occluders.
+  /// </summary>
+  void setOccluders(std::vector<Occluder> occluders);
+
+  /// <summary>
+  /// Rasterizes the occluders, builds the pyramid, and tests all queries.
+  /// </summary>
+  /// <param name="viewProjection">Maps scene space to clip space with a [0, 1] depth range.</param>
+  /// <param name="queries">The bounding boxes to test.</param>
+  /// <param name="visible">Receives one entry per query, 1 if the box may be visible, 0 if it is hidden.</param>
+  /// <returns>Timings and counts of this frame.</returns>
+  OcclusionCullingFrameStatistics cull(const f32m4& viewProjection, const std::vector<OcclusionQuery>& queries,
+                                       std::vector<ui8>& visible);
+
+  /// <summary>
+  /// Clears the depth buffer and rasterizes the occluders.
+  /// </summary>
+  /// <returns>The number of triangles that reached the rasterizer.</returns>
+  ui32 renderOccluders(const f32m4& viewProjection);
+
+  /// <summary>
+  /// Builds the max pyramid from the depth buffer.
+  /// </summary>
+  void buildHiZ();
+
+  /// <summary>
+  /// Tests a bounding box against the pyramid. Boxes that intersect the near plane or are not entirely on the screen
+  /// are reported as visible, i.e., the test is conservative.
+  /// </summary>
+  bool isVisible(const OcclusionQuery& query, const f32m4& viewProjection) const;
+
+  /// <summary>
+  /// Returns the depth buffer, row by row, top row first.
+  /// </summary>
+  const std::vector<f32>& getDepthBuffer() const;
+
+  /// <summary>
+  /// Returns the number of levels of the pyramid.
+  /// </summary>
+  ui32 getNumberOfHiZLevels() const;
+
+  /// <summary>
+  /// Returns the maximum depth stored in a texel of a pyramid level.
+  /// </summary>
+  f32 getHiZDepth(ui32 level, ui32 x, ui32 y) const;
+
+  ui32 getWidth() const;
+  ui32 getHeight() const;
+
+private:
+  /// <summary>
+  /// A triangle in screen space, prepared for evaluation with edge functions.
+  /// </summary>
+  struct ScreenTriangle
+  {
+    f32v3 edgeA;      //! Edge functions are edgeA * x + edgeB * y + edgeC, one component per edge.
+    f32v3 edgeB;      //! See edgeA.
+    f32v3 edgeC;      //! See edgeA.
+    f32v3 depthPlane; //! depth = depthPlane.x * x + depthPlane.y * y + depthPlane.z.
+    i32   minX;       //! Bounding rectangle in pixels, inclusive.
+    i32   maxX;
+    i32   minY;
+    i32   maxY;
+  };
+
+  void setupTriangle(const f32v4& c0, const f32v4& c1, const f32v4& c2);
+  void rasterizeBand(ui32 bandIdx);
+
+  OcclusionCullingSettings      m_settings;    //! Resolution and limits.
+  ThreadPool*                   m_threadPool;  //! Threads for rasterization, may be nullptr.
+  std::vector<Occluder>         m_occluders;   //! The occluders in mesh space.
+  std::vector<ScreenTriangle>   m_triangles;   //! Occluder triangles of the current frame.
+  std::vector<f32>              m_depthBuffer; //! Depth buffer, top row first.
+  std::vector<std::vector<f32>> m_hiZ;         //! Max pyramid, level 0 is a copy of the depth buffer.
+  std::vector<ui32v2>           m_hiZSizes;    //! Size of each level of the pyramid.
+};
+
+/// <summary>
+/// Selects the instances with the largest scene-space bounding boxes as occluders.
+/// </summary>
+/// <param name="meshes">Geometry of the meshes.</param>
+/// <param name="batches">Instance batches of the scene.</param>
+/// <param name="instanceTransformations">Mesh to scene transformation of every instance.</param>
+/// <param name="settings">Limits for the number and size of the occluders.</param>
+std::vector<Occluder> selectOccluders(const std::vector<StaticMeshData>& meshes,
+                                      const std::vector<InstanceBatch>&  batches,
+                                      const std::vector<f32m4>&          instanceTransformations,
+                                      const OcclusionCullingSettings&    settings);
+
+/// <summary>
+/// Creates one query per instance, indexed by instance index, from the mesh bounding boxes.
+/// </summary>
+std::vector<OcclusionQuery> createOcclusionQueries(const std::vector<AABB>&          meshAABBs,
+                                                   const std::vector<InstanceBatch>& batches,
+                                                   const std::vector<f32m4>&         instanceTransformations);
+
+/// <summary>
+/// Culls the queries for every view projection matrix, e.g., of a recorded camera path, and summarizes the results.
+/// </summary>
+OcclusionCullingReport evaluateOcclusionCulling(OcclusionCuller& culler, const std::vector<f32m4>& viewProjections,
+                                                const std::vector<OcclusionQuery>& queries);
+
+/// <summary>
+/// Writes the report to the stream.
+/// </summary>
+void printOcclusionCullingReport(std::ostream& stream, const OcclusionCullingReport& report);
+} // namespace gims
@@ -1,8 +1,11 @@
 #pragma once
+#include "InstanceBatching.hpp"
+#include "SceneTypes.hpp"
 #include "TriangleMeshD3D12.hpp"
-#include <ConstantBufferD3D12.hpp>
+#include <StructuredBufferD3D12.hpp>
 #include <Texture2DD3D12.hpp>
 #include <d3d12.h>
+#include <gimslib/sys/CommandListSequence.hpp>
 #include <gimslib/types.hpp>
 #include <vector>
 
@@ -46,17 +49,11 @@ public:
   /// <summary>
   /// Node of the scene graph.
   /// </summary>
-  struct Node
-  {
-    f32m4             transformation; //! Transformation to parent node.
-    std::vector<ui32> meshIndices;    //! Index in the array of meshIndices, i.e., Scene::m_meshes[].
-    std::vector<ui32> childIndices;   //! Index in the array of nodes, i.e.,Scene::m_nodes[].
-
-
-  };
+  using Node = SceneNode;
 
   /// <summary>
-  /// Material information per mesh that will be uploaded to the GPU.
+  /// Material information per mesh that will be uploaded to the GPU. All materials of the scene are packed into one
+  /// structured buffer, the material table, and shaders index it by material index.
   /// </summary>
   struct MaterialConstantBuffer
   {
@@ -71,8 +68,9 @@ public:
   /// </summary>
   struct Material
   {
-    ConstantBufferD3D12          materialConstantBuffer; //! Constant buffer for the material.
-    ComPtr<ID3D12DescriptorHeap> srvDescriptorHeap;      //! Descriptor Heap for the textures.
+    ComPtr<ID3D12DescriptorHeap> srvDescriptorHeap; //! Descriptor Heap for the textures.
+    ui32                         textureMask = 0;   //! Bit i is set if slot i holds a texture of the material.
+    ComPtr<ID3D12PipelineState>  pipelineState;     //! Pipeline of the material's shader permutation, may be nullptr.
   };
 
   /// <summary>
@@ -109,7 +107,7 @@ public:
   /// Returns the total number of meshes.
   /// </summary>
   /// <returns></returns>
-  const ui32 getNumberOfMeshesAvailable();
+  const ui32 getNumberOfMeshesAvailable() const;
 
   /// <summary>
   /// Returns the total number of materials.
@@ -123,6 +121,18 @@ public:
   /// <returns></returns>
   const ui32 getNumberOfTexturesAvailable();
 
+  /// <summary>
+  /// Returns the number of draw calls that are issued for the meshes of the scene with instancing.
+  /// </summary>
+  /// <returns></returns>
+  const ui32 getNumberOfDrawCalls() const;
+
+  /// <summary>
+  /// Returns the number of draw calls that would be issued for the meshes of the scene without instancing, i.e., one
+  /// per mesh occurrence in the scene graph.
+  /// </summary>
+  /// <returns></returns>
+  const ui32 getNumberOfDrawCallsWithoutInstancing() const;
 
 
   /// <summary>
@@ -137,21 +147,94 @@ public:
   /// <param name="materialIdx">The index of the material</param>
   const Material& getMaterial(ui32 materialIdx) const;
 
+  /// <summary>
+  /// Returns the constants of a material as they are stored in the material table.
+  /// </summary>
+  /// <param name="materialIdx">The index of the material</param>
+  const MaterialConstantBuffer& getMaterialConstants(ui32 materialIdx) const;
+
+  /// <summary>
+  /// Changes the constants of a single material. Only the affected entry of the material table is copied to the GPU,
+  /// by the next call of addMaterialTableUpdatesToCommandList.
+  /// </summary>
+  /// <param name="materialIdx">The index of the material</param>
+  /// <param name="materialConstants">The new constants of the material.</param>
+  void updateMaterialConstants(ui32 materialIdx, const MaterialConstantBuffer& materialConstants);
+
+  /// <summary>
+  /// Copies the material constants changed since the last call into the material table. Has to be recorded before
+  /// the draws of the frame, the first call uploads all materials.
+  /// </summary>
+  /// <param name="commandList">The command list of the frame.</param>
+  /// <param name="frameIdx">Index of the frame in flight, whose upload buffer the GPU no longer reads.</param>
+  void addMaterialTableUpdatesToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 frameIdx);
+
+  /// <summary>
+  /// Sets the pipeline that draws the meshes of a material. Instanced draws switch to it, draws of materials without
+  /// pipeline use the default pipeline passed to addToCommandList.
+  /// </summary>
+  /// <param name="materialIdx">The index of the material</param>
+  /// <param name="pipelineState">Pipeline compiled for the shader permutation of the material.</param>
+  void setMaterialPipelineState(ui32 materialIdx, const ComPtr<ID3D12PipelineState>& pipelineState);
+
+  /// <summary>
+  /// Returns the instance batches, one per mesh that occurs in the scene graph.
+  /// </summary>
+  const std::vector<InstanceBatch>& getInstanceBatches() const;
+
+  /// <summary>
+  /// Returns the CPU copy of the instance transformations, i.e., the mesh to scene transformation of every instance.
+  /// </summary>
+  const std::vector<f32m4>& getInstanceTransformations() const;
+
+  /// <summary>
+  /// Returns the GPU buffer holding the instance transformations.
+  /// </summary>
+  const StructuredBufferD3D12& getInstanceTable() const;
+
+  /// <summary>
+  /// Returns the GPU buffer holding the constants of all materials.
+  /// </summary>
+  const StructuredBufferD3D12& getMaterialTable() const;
+
   /// <summary>
   /// Traverse the scene graph and add the draw calls, and all other neccessary commands to the command list.
   /// </summary>
   /// <param name="commandList">The command list to which the commands will be added.</param>
   /// <param name="viewMatrix">The view matrix (or camera matrix).</param>
-  /// <param name="modelViewRootParameterIdx">>In your root signature, reserve 16 floats for root constants
-  /// which obtain the model view matrix.</param>
-  /// <param name="materialConstantsRootParameterIdx">In your root signature, the parameter index of the material
-  /// constant buffer.</param>
+  /// <param name="modelViewRootParameterIdx">>In your root signature, reserve 18 32-bit values for root constants
+  /// which obtain the model view matrix followed by the material index and the index of the first instance. For
+  /// instanced draws the model view matrix only holds the view matrix, the model part is read from the instance
+  /// table.</param>
+  /// <param name="materialTableRootParameterIdx">In your root signature, the parameter index of the root
+  /// shader-resource-view of the material table.</param>
+  /// <param name="instanceTableRootParameterIdx">In your root signature, the parameter index of the root
+  /// shader-resource-view of the instance transformations.</param>
   /// <param name="srvRootParameterIdx">In your root signature the paramer index of the Shader-Resource-View For the
   /// textures.</param>
+  /// <param name="defaultPipelineState">The pipeline the caller has set. Instanced draws of materials without
+  /// pipeline switch back to it.</param>
+  /// <param name="instanceVisibility">Optional, one entry per instance of the instance table. Instances with entry 0
+  /// are skipped by the instanced draws.</param>
   void addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const f32m4 transformation,
-                        ui32 modelViewRootParameterIdx, ui32 materialConstantsRootParameterIdx,
-                        ui32 srvRootParameterIdx,
-      ui32 pipelineState);
+                        ui32 modelViewRootParameterIdx, ui32 materialTableRootParameterIdx,
+                        ui32 instanceTableRootParameterIdx, ui32 srvRootParameterIdx, ui32 pipelineState,
+                        const ComPtr<ID3D12PipelineState>& defaultPipelineState,
+                        const std::vector<ui8>*            instanceVisibility = nullptr);
+
+  /// <summary>
+  /// Adds the instanced draws of a range of instance batches, so several command lists can draw parts of the scene.
+  /// Records the same commands as addToCommandList with pipeline state 0 would for these batches, including the
+  /// bindings of the material and instance tables.
+  /// </summary>
+  /// <param name="instanceBatches">Range of getInstanceBatches() to draw.</param>
+  /// <remarks>The other parameters are the same as for addToCommandList.</remarks>
+  void addInstanceBatchesToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList,
+                                       const f32m4 transformation, ui32 modelViewRootParameterIdx,
+                                       ui32 materialTableRootParameterIdx, ui32 instanceTableRootParameterIdx,
+                                       ui32 srvRootParameterIdx, ItemRange instanceBatches,
+                                       const ComPtr<ID3D12PipelineState>& defaultPipelineState,
+                                       const std::vector<ui8>*            instanceVisibility = nullptr);
 
   // Allow the class SceneGraphFactor access to the private members.
   friend class SceneGraphFactory;
@@ -162,5 +245,13 @@ private:
   AABB                           m_aabb;      //! The axis-aligned bounding box of the scene.
   std::vector<Material>          m_materials; //! Material information for each mesh.
   std::vector<Texture2DD3D12>    m_textures;  //! Array of textures.
+
+  std::vector<MaterialConstantBuffer> m_materialConstants; //! CPU copy of the material table.
+  StructuredBufferD3D12               m_materialTable;     //! All material constants in one GPU buffer.
+
+  std::vector<InstanceBatch> m_instanceBatches;                 //! One instanced draw call per batch.
+  std::vector<f32m4>         m_instanceTransformations;         //! CPU copy of the instance table.
+  StructuredBufferD3D12      m_instanceTable;                   //! Mesh to scene transformation of every instance.
+  ui32                       m_nDrawCallsWithoutInstancing = 0; //! Number of mesh occurrences in the scene graph.
 };
 } // namespace gims
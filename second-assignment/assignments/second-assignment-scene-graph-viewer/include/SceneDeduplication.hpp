@@ -0,0 +1,67 @@
+#pragma once
+#include "GltfImport.hpp"
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// Maps the items of a list with duplicates to the list without them.
+/// </summary>
+struct DeduplicationRemap
+{
+  std::vector<ui32> oldToNewIndex; //! New index of each item, the one of its first equal item for duplicates.
+  std::vector<ui32> uniqueIndices; //! Old index of each new item, in the order of the old list.
+};
+
+/// <summary>
+/// Finds the items that are equal to an earlier one. Items with the same key are compared with isEqual, so items whose
+/// keys collide are never merged. The first of equal items is kept.
+/// </summary>
+/// <param name="keys">Key of each item, e.g., the hash of its bytes. Equal items must have equal keys.</param>
+/// <param name="isEqual">Compares the items with two indices, only called for items with the same key.</param>
+/// <returns>The remap, whose new indices keep the order of the first occurrences.</returns>
+DeduplicationRemap createDeduplicationRemap(const std::vector<ui64>&               keys,
+                                            const std::function<bool(ui32, ui32)>& isEqual);
+
+/// <summary>
+/// Duplicates that deduplicateScene removed and the bytes they would have taken.
+/// </summary>
+struct SceneDeduplicationReport
+{
+  ui32 nTextures           = 0; //! Textures in files or in memory, without the three default textures.
+  ui32 nDuplicateTextures  = 0;
+  ui64 textureBytesSaved   = 0; //! Of the encoded files, which are neither read, decoded, nor uploaded.
+  ui32 nMaterials          = 0;
+  ui32 nDuplicateMaterials = 0;
+  ui64 materialBytesSaved  = 0; //! Of the imported materials. Each one also saves a descriptor heap.
+  ui32 nMeshes             = 0;
+  ui32 nDuplicateMeshes    = 0;
+  ui64 meshBytesSaved      = 0; //! Of the vertex and index buffers.
+};
+
+/// <summary>
+/// Removes textures, materials, and meshes that have the same content as an earlier one and remaps the indices that
+/// refer to them, so each is decoded, uploaded, and given a descriptor heap once. textureFilenameToIndex only merges
+/// textures with the same path, this also merges equal files with different names.
+///
+/// Textures are compared by the bytes of the files createTextures loads, materials by their constants and their
+/// textures after the textures were merged, and meshes by their vertices, indices, and material after the materials
+/// were merged. Only items with the same hash, see Hasher, are compared byte by byte, and only textures whose files
+/// have the same size are hashed at all. Merged texture files are removed from
+/// ImportedScene::textureFileNameToTextureIndex, the indices of the others are renumbered.
+/// </summary>
+/// <param name="scene">The scene, e.g., read with importGltfScene or importScenePackage.</param>
+/// <param name="parentPath">Directory of the scene file, the texture paths are relative to it.</param>
+/// <returns>What was removed. Files that cannot be read are kept, createTextures reports them.</returns>
+SceneDeduplicationReport deduplicateScene(ImportedScene& scene, const std::filesystem::path& parentPath);
+
+/// <summary>
+/// Writes the number of duplicates and the bytes they would have taken to the stream.
+/// </summary>
+/// <param name="stream">The output stream.</param>
+/// <param name="report">The report of deduplicateScene.</param>
+void printSceneDeduplicationReport(std::ostream& stream, const SceneDeduplicationReport& report);
+} // namespace gims
@@ -1,4 +1,5 @@
 #pragma once
+#include "GltfImport.hpp"
 #include "Scene.hpp"
 #include <filesystem>
 #include <unordered_map>
@@ -18,34 +19,98 @@ class SceneGraphFactory
 public:
 
 
+  /// <summary>
+  /// Loads a scene. The bounding boxes of the meshes are computed on the compute queue while the textures are uploaded
+  /// with the command queue, wait for both before createSceneAABBs().
+  /// </summary>
+  /// <param name="commandList">Compute command list with the pipeline of the bounding boxes, executed on
+  /// computeQueue.</param>
   static Scene createFromAssImpScene(const std::filesystem::path pathToScene,
                                      const ComPtr<ID3D12GraphicsCommandList6> commandList,
                                      const ComPtr<ID3D12Device2>&             device,
                                      const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                     const ComPtr<ID3D12CommandQueue>&        computeQueue,
                                      ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
                                      ComPtr<ID3D12Resource>& outputOBB);
+
+  /// <summary>
+  /// Loads a scene like createFromAssImpScene. glTF scenes are read with importGltfScene instead of Assimp, which maps
+  /// their buffers into memory and skips Assimp's intermediate copies. Scenes that use glTF features importGltfScene
+  /// does not support, and all other formats, are loaded with Assimp. Packages, see saveScenePackage, are mapped into
+  /// memory and their textures are uploaded from there.
+  /// </summary>
+  static Scene createFromFile(const std::filesystem::path pathToScene,
+                              const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                              const ComPtr<ID3D12Device2>&             device,
+                              const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                              const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                              ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
+                              ComPtr<ID3D12Resource>& outputOBB);
   static void  createSceneAABBs(Scene& scene, ComPtr<ID3D12Resource>& outputOBBReadBack);
 
+  /// <summary>
+  /// Optional pass for scenes that never move. Bakes the accumulated transformation of every node into its meshes and
+  /// merges all geometry of a material into one mesh. Afterwards the scene graph consists of a single root node that
+  /// references the merged meshes. Call after createSceneAABBs(), the AABB points are replaced by the ones of the
+  /// batches.
+  /// </summary>
+  static void applyStaticBatching(Scene& scene, const ComPtr<ID3D12Device2>& device,
+                                  const ComPtr<ID3D12CommandQueue>& commandQueue);
+
 private:
 
+  /// <summary>
+  /// Creates a scene that was read without Assimp, see createFromFile.
+  /// </summary>
+  static Scene createFromImportedScene(const ImportedScene& inputScene, const std::filesystem::path& parentPath,
+                                       const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                                       const ComPtr<ID3D12Device2>&             device,
+                                       const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                       const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                                       ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
+                                       ComPtr<ID3D12Resource>& outputOBB);
+
   static void createMeshes(aiScene const* const inputScene, const ComPtr<ID3D12GraphicsCommandList6> commandList,
                            const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& commandQueue,
+                           const ComPtr<ID3D12CommandQueue>& computeQueue,
+                           ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
+                           ComPtr<ID3D12Resource>& outputOBB, Scene& outputScene);
+
+  static void createMeshes(const ImportedScene& inputScene, const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                           const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& commandQueue,
+                           const ComPtr<ID3D12CommandQueue>& computeQueue,
                            ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
                            ComPtr<ID3D12Resource>& outputOBB, Scene& outputScene);
 
+  /// <summary>
+  /// Computes the bounding boxes of the meshes on the compute queue, see createFromAssImpScene.
+  /// </summary>
+  static void computeMeshAABBs(const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                               const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& commandQueue,
+                               const ComPtr<ID3D12CommandQueue>& computeQueue,
+                               ComPtr<ID3D12Resource>& outputOBBReadBack, ComPtr<ID3D12Resource>& inputAABB,
+                               ComPtr<ID3D12Resource>& outputOBB, const Scene& outputScene);
+
 
   static ui32 createNodes(aiScene const* const inputScene, Scene& outputScene, aiNode const* const inputNode);
 
   static void computeSceneAABB(Scene& scene, AABB& aabb, ui32 nodeIdx, f32m4 transformation);
 
+  /// <summary>
+  /// Creates the default textures, the textures in files, and the textures in memory, in this order.
+  /// </summary>
   static void createTextures(const std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex,
-                             std::filesystem::path parentPath, const ComPtr<ID3D12Device2>& device,
-                             const ComPtr<ID3D12CommandQueue>& commandQueue, Scene& outputScene);
+                             const std::vector<ImportedTexture>& textures, std::filesystem::path parentPath,
+                             const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& commandQueue,
+                             Scene& outputScene);
 
   static void createMaterials(aiScene const* const                            inputScene,
                               std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex,
                               const ComPtr<ID3D12Device2>& device, Scene& outputScene);
 
+  static void createMaterials(const std::vector<ImportedMaterial>& materials, const ComPtr<ID3D12Device2>& device,
+                              Scene& outputScene);
 
+  static void createInstanceTable(const ComPtr<ID3D12Device2>& device, Scene& outputScene);
 };
 } // namespace gims
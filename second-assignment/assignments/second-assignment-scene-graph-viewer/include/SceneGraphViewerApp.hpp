@@ -1,8 +1,17 @@
 #pragma once
+#include "ConstantBufferD3D12.hpp"
+#include "IndirectSceneRendererD3D12.hpp"
+#include "OcclusionCulling.hpp"
 #include "Scene.hpp"
 #include <gimslib/d3d/DX12App.hpp>
+#include <gimslib/d3d/PipelineStateManager.hpp>
+#include <gimslib/d3d/ShaderPermutations.hpp>
+#include <gimslib/io/CameraPath.hpp>
+#include <gimslib/sw/RayCasting.hpp>
+#include <gimslib/sys/TripleBuffer.hpp>
 #include <gimslib/types.hpp>
 #include <gimslib/ui/ExaminerController.hpp>
+#include <unordered_map>
 using namespace gims;
 
 /// <summary>
@@ -16,7 +25,11 @@ public:
   /// Creates the SceneGraphViewerApp and loads a scene.
   /// </summary>
   /// <param name="config">Configuration.</param>
-  SceneGraphViewerApp(const DX12AppConfig config, const std::filesystem::path pathToScene);
+  /// <param name="pathToScene">Path to the scene file.</param>
+  /// <param name="useStaticBatching">If true, the scene is treated as static and its geometry is merged per material
+  /// at load time.</param>
+  SceneGraphViewerApp(const DX12AppConfig config, const std::filesystem::path pathToScene,
+                      bool useStaticBatching = false);
 
   ~SceneGraphViewerApp() = default;
 
@@ -30,9 +43,46 @@ public:
   /// </summary>
   virtual void onDrawUI();
 
+  /// <summary>
+  /// Moves the camera with the latest input, or to the pose of a replayed camera path, culls the instances against
+  /// the occluders, and finds the instance under the cursor. The result is published as the snapshot that onDraw
+  /// draws. Runs on the update thread, if it is enabled.
+  /// </summary>
+  virtual void onUpdate();
+
 
 private:
 
+  /// <summary>
+  /// Input of an update, captured by onDrawUI on the render thread.
+  /// </summary>
+  struct UpdateInput
+  {
+    f32v2 mousePosition       = f32v2(0.0f, 0.0f); //! Normalized mouse coordinates.
+    bool  leftButton          = false;
+    bool  rightButton         = false;
+    bool  control             = false;
+    bool  mouseCaptured       = false;             //! True, if the UI uses the mouse.
+    f32m4 projection          = f32m4(1.0f);
+    bool  useOcclusionCulling = false;
+  };
+
+  /// <summary>
+  /// Result of an update, which the render thread only reads.
+  /// </summary>
+  struct FrameSnapshot
+  {
+    ui64                            updateIdx               = 0; //! 0 before the first update.
+    f32m4                           projection              = f32m4(1.0f);
+    f32m4                           sceneViewTransformation = f32m4(1.0f);
+    CameraPose                      camera                  = {f32q(1.0f, 0.0f, 0.0f, 0.0f), f32v3(0.0f)};
+    bool                            cameraActive            = false;
+    bool                            useInstanceVisibility   = false;
+    std::vector<ui8>                instanceVisibility;          //! Per instance, if useInstanceVisibility is set.
+    OcclusionCullingFrameStatistics occlusionCullingStatistics;
+    RayHit                          cursorHit;                   //! Instance under the cursor, see m_rayCastingScene.
+  };
+
   /// <summary>
   /// Root signature connecting shader and GPU resources for our compute pipeline.
   /// </summary>
@@ -45,26 +95,59 @@ private:
   void createRootSignature();
 
   /// <summary>
-  /// Creates the pipeline
+  /// Requests all pipelines for rendering and creates them in parallel. Pipelines of earlier runs are loaded from the
+  /// pipeline library instead of being compiled again.
   /// </summary>
-  void createPipeline();
+  void createPipelines();
 
+  /// <summary>
+  /// Requests the pipeline of a pixel shader permutation. The shaders of each permutation are compiled once.
+  /// </summary>
+  /// <param name="shaderPermutation">Bit mask of the enabled pixel shader features.</param>
+  PipelineStateManager::Handle requestPipelineForPermutation(ui32 shaderPermutation);
 
   /// <summary>
-  /// Creates the pipeline for AABB rendering with mesh shaders
+  /// Requests the pipeline for AABB rendering with mesh shaders
   /// </summary>
-  void createMeshShaderPipeline();
+  PipelineStateManager::Handle requestMeshShaderPipeline();
 
     /// <summary>
   /// Creates the pipeline for AABB rendering with mesh shaders
   /// </summary>
   void createComputePipeline();
 
+  /// <summary>
+  /// Creates the renderer for GPU driven rendering of the scene.
+  /// </summary>
+  void createIndirectSceneRenderer();
+
+  /// <summary>
+  /// Selects the occluders and creates one occlusion query per instance for the CPU occlusion culling.
+  /// </summary>
+  void createOcclusionCuller();
+
+  /// <summary>
+  /// Builds the bounding volume hierarchies of the meshes and of the instances for picking.
+  /// </summary>
+  void createRayCastingScene();
+
+  /// <summary>
+  /// Returns the projection matrix for the current window size and UI settings.
+  /// </summary>
+  f32m4 getProjectionMatrix() const;
+
   /// <summary>
   /// Draws the scene.
   /// </summary>
   /// <param name="commandList">Command list to which we upload the buffer</param>
-  void drawScene(const ComPtr<ID3D12GraphicsCommandList6>& commandList);
+  /// <param name="snapshot">Camera and visibility of the frame.</param>
+  void drawScene(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const FrameSnapshot& snapshot);
+
+  /// <summary>
+  /// Binds the render targets, viewport, root signature and constant buffer of the frame to a command list that was
+  /// started while drawing.
+  /// </summary>
+  void setGraphicsState(const ComPtr<ID3D12GraphicsCommandList6>& commandList);
 
   /// <summary>
   /// Creates the scene's constant buffer
@@ -74,7 +157,8 @@ private:
   /// <summary>
   /// Updates the scene's constant buffer
   /// </summary>
-  void updateSceneConstantBuffer();
+  /// <param name="projection">Projection of the frame.</param>
+  void updateSceneConstantBuffer(const f32m4& projection);
 
   /// <summary>
   /// Strructs containing data related to the UI
@@ -90,14 +174,37 @@ private:
     f32   m_fieldOfView = 45.0f;
     f32   m_nearPlane   = 1.0f / 256.0f;
     f32   m_farPlane    = 256.0f;
+    i32   m_selectedMaterialIdx = 0;
+    bool  m_useGpuDrivenRendering = false;
+    bool  m_validateGpuCulling    = false;
+    bool  m_useAsyncCompute       = true;
+    bool  m_useOcclusionCulling   = false;
+    bool  m_useParallelRecording  = true;
+    bool  m_showProfiler          = false;
+    f32   m_profilerMilliseconds  = 50.0f; //! Time range of the profiler timeline.
+    bool  m_recordCameraPath      = false;
   };
 
   ComPtr<ID3D12PipelineState>      m_pipelineState;
   ComPtr<ID3D12PipelineState>      m_meshShaderPipelineState;
+  ShaderFeatureSet                 m_pixelShaderFeatures;
+  std::unordered_map<ui32, PipelineStateManager::Handle> m_permutationPipelines;
+  PipelineStateManager             m_pipelineStateManager;
   ComPtr<ID3D12RootSignature>      m_rootSignature;
   ComPtr<ID3D12RootSignature>      m_rootSignatureForComputePipeline;
   std::vector<ConstantBufferD3D12> m_constantBuffers;
-  gims::ExaminerController         m_examinerController;  
+  gims::ExaminerController         m_examinerController;  //! Only used by onUpdate.
   Scene                            m_scene;
+  IndirectSceneRendererD3D12       m_indirectSceneRenderer;
+  OcclusionCuller                  m_occlusionCuller;
+  std::vector<OcclusionQuery>      m_occlusionQueries;
+  RayCastingScene                  m_rayCastingScene;     //! Meshes and instances of m_scene, in scene space.
   UiData                           m_uiData;
+  TripleBuffer<UpdateInput>        m_updateInputs;        //! From the render thread to the update.
+  TripleBuffer<FrameSnapshot>      m_frameSnapshots;      //! From the update to the render thread.
+  ui64                             m_nUpdates;            //! Only used by onUpdate.
+  bool                             m_leftButtonDown;      //! Only used by onUpdate.
+  bool                             m_rightButtonDown;     //! Only used by onUpdate.
+  f64                              m_profileZoneOverhead; //! Nanoseconds per zone, measured at startup.
+  CameraPath                       m_cameraPath;          //! Camera of each drawn frame, while recording.
 };
@@ -0,0 +1,68 @@
+#pragma once
+#include "SceneTypes.hpp"
+#include <assimp/material.h>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+struct aiNode;
+struct aiScene;
+namespace Assimp
+{
+class Importer;
+}
+
+namespace gims
+{
+/// <summary>
+/// Imports a scene with Assimp and the post-processing steps of the viewer. The scene is owned by the importer.
+/// Does not depend on D3D12, so the import can be benchmarked without a GPU.
+/// </summary>
+/// <param name="importer">Importer that owns the scene.</param>
+/// <param name="pathToScene">Path to the scene file.</param>
+/// <returns>The imported scene.</returns>
+/// <exception cref="std::runtime_error">If the file does not exist or cannot be imported.</exception>
+const aiScene* importAssimpScene(Assimp::Importer& importer, const std::filesystem::path& pathToScene);
+
+/// <summary>
+/// Appends a node of an Assimp scene and all nodes below it in depth-first order.
+/// </summary>
+/// <param name="inputNode">The Assimp node.</param>
+/// <param name="nodes">Nodes of the scene graph, the new ones refer to each other by their indices.</param>
+/// <returns>Index of the node that was created for inputNode.</returns>
+ui32 appendSceneNodes(aiNode const* const inputNode, std::vector<SceneNode>& nodes);
+
+/// <summary>
+/// Assigns an index to every texture file the materials refer to. The indices start at 3, after the white, black,
+/// and normal map default textures.
+/// </summary>
+/// <param name="inputScene">The Assimp scene.</param>
+/// <returns>Index of each texture file, relative to the scene file.</returns>
+std::unordered_map<std::filesystem::path, ui32> textureFilenameToIndex(aiScene const* const inputScene);
+
+/// <summary>
+/// Reads the color from the Asset Importer specific (pKey, type, idx) triple.
+/// Use the Asset Importer Macros AI_MATKEY_COLOR_AMBIENT, AI_MATKEY_COLOR_DIFFUSE, etc. which map to these arguments
+/// correctly.
+///
+/// If that key does not exist a null vector is returned.
+/// </summary>
+/// <param name="pKey">Asset importer specific parameter</param>
+/// <param name="type"></param>
+/// <param name="idx"></param>
+/// <param name="material">The material from which we wish to extract the color.</param>
+/// <returns>Color or 0 vector if no color exists.</returns>
+f32v4 getColor(char const* const pKey, unsigned int type, unsigned int idx, aiMaterial const* const material);
+
+/// <summary>
+/// Returns the index of the texture of a material, or of the default texture of its type if it has none: black for
+/// ambient, diffuse, and emissive, white for specular, and the flat normal map for height.
+/// </summary>
+/// <param name="textureType">Type of the texture.</param>
+/// <param name="textureIndex">Index of the texture within its type.</param>
+/// <param name="material">The material.</param>
+/// <param name="textureFileNameToTextureIndex">Indices of the texture files, see textureFilenameToIndex.</param>
+/// <returns>Index of the texture.</returns>
+i32 getTexture(aiTextureType textureType, unsigned int textureIndex, aiMaterial const* const material,
+               const std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex);
+} // namespace gims
@@ -0,0 +1,31 @@
+#pragma once
+#include "GltfImport.hpp"
+#include <filesystem>
+
+namespace gims
+{
+/// <summary>
+/// Saves a scene as package, see PackageFile: one file with the nodes, the materials, one entry per mesh, and one
+/// entry per texture, each at a multiple of 4 KB and with a content hash. Loading it maps the file once instead of
+/// opening the scene, its buffers, and every texture, which is what makes cold starts slow on spinning and network
+/// disks.
+/// </summary>
+/// <param name="pathToPackage">Path of the .gpak file.</param>
+/// <param name="scene">The scene, e.g., read with importGltfScene or importScenePackage.</param>
+/// <param name="parentPath">Directory of the scene file, the texture paths are relative to it.</param>
+/// <param name="compressTextures">Stores the textures as DDS files with mip levels, see compressTexture, which the
+/// viewer uploads without decoding. A DDS or KTX2 file next to a texture is stored instead, if there is one.
+/// Otherwise the files are stored as they are.</param>
+/// <exception cref="std::runtime_error">If a texture cannot be read or the package cannot be written.</exception>
+void saveScenePackage(const std::filesystem::path& pathToPackage, const ImportedScene& scene,
+                      const std::filesystem::path& parentPath, bool compressTextures);
+
+/// <summary>
+/// Reads a scene saved with saveScenePackage. The meshes are copied out of the package, the textures point into it
+/// and are kept alive by ImportedScene::storage.
+/// </summary>
+/// <param name="pathToPackage">Path of the .gpak file.</param>
+/// <returns>The scene, whose textures are all in ImportedScene::textures.</returns>
+/// <exception cref="std::runtime_error">If the file is no package or an entry is missing or corrupt.</exception>
+ImportedScene importScenePackage(const std::filesystem::path& pathToPackage);
+} // namespace gims
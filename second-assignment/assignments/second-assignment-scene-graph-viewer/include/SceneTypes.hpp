@@ -0,0 +1,28 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <vector>
+
+/// <summary>
+/// Vertex layout of all triangle meshes. Must match TriangleMeshD3D12::getInputElementDescriptors().
+/// </summary>
+struct Vertex
+{
+  gims::f32v3 position;
+  gims::f32v3 normal;
+  gims::f32v2 textureCoordinate;
+  gims::f32v3 tangent;
+};
+
+namespace gims
+{
+/// <summary>
+/// Node of the scene graph. It only holds indices into the arrays of the scene, so code that processes the scene graph
+/// does not depend on D3D12 and can run without a GPU.
+/// </summary>
+struct SceneNode
+{
+  f32m4             transformation; //! Transformation to parent node.
+  std::vector<ui32> meshIndices;    //! Index in the array of meshIndices, i.e., Scene::m_meshes[].
+  std::vector<ui32> childIndices;   //! Index in the array of nodes, i.e.,Scene::m_nodes[].
+};
+} // namespace gims
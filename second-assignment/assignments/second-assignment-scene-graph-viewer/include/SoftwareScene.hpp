@@ -0,0 +1,52 @@
+#pragma once
+#include "AABB.hpp"
+#include "GltfImport.hpp"
+#include "InstanceBatching.hpp"
+#include <filesystem>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <vector>
+
+struct aiScene;
+
+namespace gims
+{
+/// <summary>
+/// A scene for the SoftwareRasterizer, with the same meshes, materials, textures, and instances the SceneGraphFactory
+/// creates for D3D12. Does not depend on D3D12, so scenes can be rendered on machines without GPU.
+/// </summary>
+struct SoftwareSceneGraph
+{
+  SoftwareScene   scene;           //! Meshes and materials have the indices of the imported scene.
+  InstanceBatches instanceBatches; //! Occurrences of the meshes in the scene graph.
+  AABB            aabb;            //! Bounding box of all instances, like Scene::getAABB().
+};
+
+/// <summary>
+/// Converts an imported scene. Textures get the indices of textureFilenameToIndex, after the white, black, and normal
+/// map default textures, and are sampled as SRGB like Texture2DD3D12 does.
+/// </summary>
+/// <param name="inputScene">The Assimp scene, see importAssimpScene.</param>
+/// <param name="parentPath">Directory of the scene file, the texture paths are relative to it.</param>
+/// <returns>The scene.</returns>
+/// <exception cref="std::runtime_error">If a texture cannot be read.</exception>
+SoftwareSceneGraph createSoftwareSceneGraph(aiScene const* const inputScene, const std::filesystem::path& parentPath);
+
+/// <summary>
+/// Converts a scene that was read without Assimp, see importGltfScene.
+/// </summary>
+/// <param name="inputScene">The scene.</param>
+/// <param name="parentPath">Directory of the scene file, the texture paths are relative to it.</param>
+/// <returns>The scene.</returns>
+/// <exception cref="std::runtime_error">If a texture cannot be read.</exception>
+SoftwareSceneGraph createSoftwareSceneGraph(const ImportedScene& inputScene, const std::filesystem::path& parentPath);
+
+/// <summary>
+/// Creates one draw call per instance, with the model view matrices the viewer computes.
+/// </summary>
+/// <param name="sceneGraph">The scene.</param>
+/// <param name="sceneViewTransformation">Transformation from scene to view space, i.e., the transformation of the
+/// camera times the normalization transformation of the scene bounding box.</param>
+/// <returns>The draw calls.</returns>
+std::vector<SoftwareDrawCall> createSoftwareDrawCalls(const SoftwareSceneGraph& sceneGraph,
+                                                      const f32m4&              sceneViewTransformation);
+} // namespace gims
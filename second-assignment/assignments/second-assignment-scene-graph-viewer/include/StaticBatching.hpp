@@ -0,0 +1,101 @@
+#pragma once
+#include "AABB.hpp"
+#include "SceneTypes.hpp"
+#include <iosfwd>
+#include <vector>
+
+namespace gims
+{
+/// <summary>
+/// CPU copy of the geometry of one mesh, i.e., the input of static batching.
+/// </summary>
+struct StaticMeshData
+{
+  std::vector<Vertex> vertices;          //! Vertices in mesh space.
+  std::vector<ui32>   indices;           //! Triangle list.
+  ui32                materialIndex = 0; //! Material index of the mesh.
+};
+
+/// <summary>
+/// Location of one mesh occurrence inside a static batch.
+/// </summary>
+struct StaticBatchRange
+{
+  ui32  meshIdx     = 0;                         //! Index of the source mesh.
+  ui32  firstVertex = 0;                         //! First vertex of this occurrence within the batch.
+  ui32  firstIndex  = 0;                         //! First index of this occurrence within the batch.
+  f32m4 transformation = glm::identity<f32m4>(); //! Transformation that was baked into the vertices.
+};
+
+/// <summary>
+/// All geometry of the scene that shares one material, pre-transformed to scene space.
+/// </summary>
+struct StaticBatch
+{
+  ui32                          materialIndex = 0; //! Material index of all triangles in this batch.
+  std::vector<Vertex>           vertices;          //! Vertices in scene space.
+  std::vector<ui32>             indices;           //! Triangle list, indices relative to the batch.
+  std::vector<StaticBatchRange> ranges;            //! Which part of the batch stems from which mesh occurrence.
+  AABB                          aabb;              //! Bounding box of the batch in scene space.
+};
+
+/// <summary>
+/// Cost of the scene before and after static batching.
+/// </summary>
+struct StaticBatchingStatistics
+{
+  ui32   nDrawCallsBefore     = 0; //! One draw call per mesh occurrence.
+  ui32   nDrawCallsAfter      = 0; //! One draw call per material.
+  ui32   nVerticesBefore      = 0; //! Vertices stored for the meshes, shared meshes are stored once.
+  ui32   nVerticesAfter       = 0; //! Vertices stored for the batches, every occurrence gets its own copy.
+  size_t geometryBytesBefore  = 0; //! Vertex and index buffer size of the meshes.
+  size_t geometryBytesAfter   = 0; //! Vertex and index buffer size of the batches.
+};
+
+/// <summary>
+/// Result of static batching.
+/// </summary>
+struct StaticBatches
+{
+  std::vector<StaticBatch> batches;    //! One batch per material, ordered by material index.
+  StaticBatchingStatistics statistics; //! Draw call and memory trade-offs.
+};
+
+/// <summary>
+/// Transforms a vertex to scene space. Positions are transformed with the transformation, normals with the
+/// inverse-transpose of its upper 3x3 matrix, and tangents with the upper 3x3 matrix.
+/// </summary>
+/// <param name="vertex">Vertex in mesh space.</param>
+/// <param name="transformation">Mesh to scene transformation.</param>
+/// <param name="normalTransformation">Inverse-transpose of the upper 3x3 matrix of the transformation.</param>
+/// <returns>The vertex in scene space.</returns>
+Vertex transformVertex(const Vertex& vertex, const f32m4& transformation, const f32m3& normalTransformation);
+
+/// <summary>
+/// Bakes the accumulated transformation of every node into a copy of its meshes and merges all copies that share a
+/// material. Occurrences with a mirroring transformation get their triangle winding flipped, so front faces stay
+/// front faces.
+/// </summary>
+/// <param name="nodes">Nodes of the scene graph. All nodes are treated as static.</param>
+/// <param name="meshes">Geometry of the meshes referenced by the nodes.</param>
+/// <param name="rootNodeIdx">Index of the root node.</param>
+/// <returns>The batches and the statistics.</returns>
+StaticBatches createStaticBatches(const std::vector<SceneNode>& nodes, const std::vector<StaticMeshData>& meshes,
+                                  ui32 rootNodeIdx = 0);
+
+/// <summary>
+/// Checks the batches against the original geometry. Every range is transformed again from its source mesh and
+/// compared vertex by vertex, the indices are compared after removing the batch offset.
+/// </summary>
+/// <param name="staticBatches">The batches created from the meshes.</param>
+/// <param name="meshes">The original geometry.</param>
+/// <returns>The largest position distance found, or infinity if the topology does not match.</returns>
+f32 getMaxStaticBatchingError(const StaticBatches& staticBatches, const std::vector<StaticMeshData>& meshes);
+
+/// <summary>
+/// Writes the draw call and memory statistics to the stream.
+/// </summary>
+/// <param name="stream">The output stream.</param>
+/// <param name="staticBatches">The batches.</param>
+void printStaticBatchingReport(std::ostream& stream, const StaticBatches& staticBatches);
+} // namespace gims
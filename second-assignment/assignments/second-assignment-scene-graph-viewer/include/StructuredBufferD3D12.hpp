@@ -0,0 +1,119 @@
+#pragma once
+#include <d3d12.h>
+#include <gimslib/types.hpp>
+#include <vector>
+#include <wrl.h>
+using Microsoft::WRL::ComPtr;
+
+namespace gims
+{
+/// <summary>
+/// Whether the records of a structured buffer can change while frames that read them are in flight.
+/// </summary>
+enum class StructuredBufferUsage
+{
+  Static,   //! Written once before the first use, in an upload heap the shaders read directly.
+  Updatable //! In a default heap, changed records are copied into it by addUpdatesToCommandList.
+};
+
+/// <summary>
+/// A class that holds an array of equally sized records on the GPU, that shaders can access as a StructuredBuffer.
+/// All records share a single committed resource. Records of updatable buffers can be changed individually without
+/// touching the others.
+///
+/// Updatable buffers sit in video memory, which shaders read faster than the upload heap, e.g., once per pixel. Their
+/// updates are never written to memory the GPU may be reading: each frame in flight copies them from an upload buffer
+/// of its own, which is only written again after the GPU finished the frame.
+/// </summary>
+class StructuredBufferD3D12
+{
+public:
+  /// <summary>
+  /// Creates an empty structured buffer.
+  /// </summary>
+  StructuredBufferD3D12();
+
+  /// <summary>
+  /// Creates an uninitialized structured buffer.
+  /// </summary>
+  /// <param name="elementSizeInBytes">Size of one record in bytes. Must match the stride of the HLSL struct.</param>
+  /// <param name="nElements">Number of records.</param>
+  /// <param name="device">Device on which the structured buffer should be allocated.</param>
+  /// <param name="usage">Whether records can be updated after the first use.</param>
+  StructuredBufferD3D12(size_t elementSizeInBytes, ui32 nElements, const ComPtr<ID3D12Device>& device,
+                        StructuredBufferUsage usage = StructuredBufferUsage::Static);
+
+  /// <summary>
+  /// Creates a structured buffer from an array of records and uploads it to the GPU.
+  /// </summary>
+  /// <typeparam name="T">Struct with the layout of one record.</typeparam>
+  /// <param name="data">Array of nElements records.</param>
+  /// <param name="nElements">Number of records.</param>
+  /// <param name="device">Device on which the structured buffer should be allocated.</param>
+  /// <param name="usage">Whether records can be updated after the first use.</param>
+  template<class T>
+  StructuredBufferD3D12(T const* const data, ui32 nElements, const ComPtr<ID3D12Device>& device,
+                        StructuredBufferUsage usage = StructuredBufferUsage::Static)
+      : StructuredBufferD3D12(sizeof(T), nElements, device, usage)
+  {
+    this->upload(data);
+  }
+
+  /// <summary>
+  /// Uploads all records to the GPU buffer. Static buffers are written immediately, so they must not be in use by the
+  /// GPU. Updatable buffers are copied by the next call of addUpdatesToCommandList.
+  /// </summary>
+  /// <param name="data">Array with getNumElements() records.</param>
+  void upload(void const* const data);
+
+  /// <summary>
+  /// Changes a single record of an updatable buffer. The GPU copies it with the next call of addUpdatesToCommandList,
+  /// all other records remain untouched.
+  /// </summary>
+  /// <param name="elementIdx">Index of the record.</param>
+  /// <param name="data">The record. Its size must match the element size.</param>
+  /// <exception cref="std::logic_error">If the buffer is static.</exception>
+  void updateElement(ui32 elementIdx, void const* const data);
+
+  /// <summary>
+  /// Copies the records changed since the last call from the upload buffer of the frame into the GPU buffer. Has to
+  /// be recorded before the commands of the frame that read the buffer. Does nothing for static buffers.
+  /// </summary>
+  /// <param name="commandList">The command list of the frame.</param>
+  /// <param name="frameIdx">Index of the frame in flight, e.g., DX12App::getFrameIndex(). Its upload buffer must not
+  /// be in use by the GPU anymore.</param>
+  void addUpdatesToCommandList(const ComPtr<ID3D12GraphicsCommandList>& commandList, ui32 frameIdx);
+
+  /// <summary>
+  /// Returns the GPU resource.
+  /// </summary>
+  const ComPtr<ID3D12Resource>& getResource() const;
+
+  /// <summary>
+  /// Returns the number of records.
+  /// </summary>
+  ui32 getNumElements() const;
+
+  /// <summary>
+  /// Returns the size of one record in bytes.
+  /// </summary>
+  size_t getElementSizeInBytes() const;
+
+  StructuredBufferD3D12(const StructuredBufferD3D12& other)                = default;
+  StructuredBufferD3D12(StructuredBufferD3D12&& other) noexcept            = default;
+  StructuredBufferD3D12& operator=(const StructuredBufferD3D12& other)     = default;
+  StructuredBufferD3D12& operator=(StructuredBufferD3D12&& other) noexcept = default;
+
+private:
+  ComPtr<ID3D12Resource> m_structuredBuffer;   //! The buffer on the GPU.
+  size_t                 m_elementSizeInBytes; //! The size of one record in bytes.
+  ui32                   m_nElements;          //! The number of records.
+  StructuredBufferUsage  m_usage;
+
+  std::vector<ui8>                    m_data;                //! CPU copy of the records of updatable buffers.
+  std::vector<ui32>                   m_changedElements;     //! Not yet copied to the GPU, each record once.
+  std::vector<bool>                   m_isChanged;           //! Per record, true if it is in m_changedElements.
+  std::vector<ComPtr<ID3D12Resource>> m_uploadBuffers;       //! Per frame in flight, with room for all records.
+  std::vector<ui8*>                   m_mappedUploadBuffers; //! Stay mapped for the lifetime of the buffer.
+};
+} // namespace gims
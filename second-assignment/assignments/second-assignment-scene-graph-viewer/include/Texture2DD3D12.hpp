@@ -8,13 +8,16 @@ using Microsoft::WRL::ComPtr;
 namespace gims
 {
 /// <summary>
-/// A class that represents 2D textures. It supports the format RGBA8_UNORM only.
+/// A class that represents 2D textures. Images are decoded to RGBA8_UNORM, DDS and KTX2 files keep their format, e.g.,
+/// BC1 to BC7, and their mip levels. All textures are sampled as SRGB if their format has an SRGB variant.
 /// </summary>
 class Texture2DD3D12
 {
 public:
   /// <summary>
   /// Loads a texture from a file and uploads it onto the GPU. Throws an std::exception in cases something goes wrong.
+  /// The mip levels of .dds and .ktx2 files are uploaded straight from the mapped file, without decoding them on the
+  /// CPU, see readTextureHeader. Other files are decoded with stb_image.
   /// </summary>
   /// <param name="pathToFileName">Path to filename</param>
   /// <param name="device">Device on which the GPU buffers should be created.</param>
@@ -22,6 +25,17 @@ public:
   Texture2DD3D12(std::filesystem::path pathToFileName, const ComPtr<ID3D12Device>& device,
                  const ComPtr<ID3D12CommandQueue>& commandQueue);
 
+  /// <summary>
+  /// Loads a texture from a file in memory, e.g., inside a package, like the constructor that takes a path. DDS and
+  /// KTX2 files are recognized by their header instead of their extension.
+  /// </summary>
+  /// <param name="fileData">Start of the file, which is only read during the constructor.</param>
+  /// <param name="fileSize">Size of the file in bytes.</param>
+  /// <param name="device">Device on which the GPU buffers should be created.</param>
+  /// <param name="commandQueue">Command queue used to copy the data from the GPU to the GPU.</param>
+  Texture2DD3D12(const ui8* fileData, size_t fileSize, const ComPtr<ID3D12Device>& device,
+                 const ComPtr<ID3D12CommandQueue>& commandQueue);
+
   /// <summary>
   /// Creates a texture from a pointer in memory.
   /// </summary>
@@ -53,5 +67,15 @@ private:
   /// The texture resource.
   /// </summary>
   ComPtr<ID3D12Resource> m_textureResource;
+
+  /// <summary>
+  /// Format of the shader resource view.
+  /// </summary>
+  DXGI_FORMAT m_format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+  /// <summary>
+  /// Number of mip levels of the texture resource.
+  /// </summary>
+  ui32 m_nMipLevels = 1;
 };
 } // namespace gims
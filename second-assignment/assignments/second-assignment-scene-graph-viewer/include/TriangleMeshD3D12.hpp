@@ -1,5 +1,6 @@
 #pragma once
 #include "AABB.hpp"
+#include "SceneTypes.hpp"
 #include <d3d12.h>
 #include <gimslib/types.hpp>
 #include <vector>
@@ -7,14 +8,6 @@
 #include <iostream>
 using Microsoft::WRL::ComPtr;
 
-struct Vertex
-{
-  gims::f32v3 position;
-  gims::f32v3 normal;
-  gims::f32v2 textureCoordinate;
-  gims::f32v3 tangent;
-};
-
 namespace gims
 {
 
@@ -41,11 +34,27 @@ public:
                     ui32 nVertices, ui32v3 const* const indexBuffer, ui32 nIndices, ui32 materialIndex,
                     const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& commandQueue);
 
+  /// <summary>
+  /// Constructor that creates a D3D12 GPU Triangle mesh from vertices that are already in the final vertex layout.
+  /// </summary>
+  /// <param name="vertices">Array of nVertices vertices.</param>
+  /// <param name="nVertices">Number of vertices.</param>
+  /// <param name="indexBuffer">Index buffer for triangle list. Triples of integer indices form a triangle.</param>
+  /// <param name="nIndices">Number of indices (NOT the number triangles!)</param>
+  /// <param name="materialIndex">Material index.</param>
+  /// <param name="device">Device on which the GPU buffers should be created.</param>
+  /// <param name="commandQueue">Command queue used to copy the data from the GPU to the GPU.</param>
+  TriangleMeshD3D12(Vertex const* const vertices, ui32 nVertices, ui32 const* const indexBuffer, ui32 nIndices,
+                    ui32 materialIndex, const ComPtr<ID3D12Device>& device,
+                    const ComPtr<ID3D12CommandQueue>& commandQueue);
+
   /// <summary>
   /// Adds the commands neccessary for rendering this triangle mesh to the provided commandList.
   /// </summary>
   /// <param name="commandList">The command list</param>
-  void addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 pipelineState) const;
+  /// <param name="nInstances">Number of instances drawn with the triangle pipeline.</param>
+  void addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 pipelineState,
+                        ui32 nInstances = 1) const;
 
   /// <summary>
   /// Returns the axis-aligned bounding-box of the mesh.
@@ -59,6 +68,31 @@ public:
   /// <returns><The material index of the mesh./returns>
   const ui32 getMaterialIndex() const;
 
+  /// <summary>
+  /// Returns the view of the vertex buffer on the GPU.
+  /// </summary>
+  const D3D12_VERTEX_BUFFER_VIEW& getVertexBufferView() const;
+
+  /// <summary>
+  /// Returns the view of the index buffer on the GPU.
+  /// </summary>
+  const D3D12_INDEX_BUFFER_VIEW& getIndexBufferView() const;
+
+  /// <summary>
+  /// Returns the number of indices (NOT the number triangles!)
+  /// </summary>
+  ui32 getNumberOfIndices() const;
+
+  /// <summary>
+  /// Returns the CPU copy of the vertex buffer.
+  /// </summary>
+  const std::vector<Vertex>& getVertices() const;
+
+  /// <summary>
+  /// Returns the CPU copy of the index buffer.
+  /// </summary>
+  const std::vector<ui32>& getIndices() const;
+
   /// <summary>
   /// Returns the input element descriptors required for the pipeline.
   /// </summary>
@@ -0,0 +1,100 @@
+/// <summary>
+/// One indirect draw command. Must match IndirectDrawCommand in IndirectDrawing.hpp.
+/// </summary>
+struct IndirectDrawCommand
+{
+    uint materialIndex;
+    uint instanceIndex;
+    uint2 vertexBufferLocation;
+    uint vertexBufferSize;
+    uint vertexBufferStride;
+    uint2 indexBufferLocation;
+    uint indexBufferSize;
+    uint indexBufferFormat;
+    uint indexCountPerInstance;
+    uint instanceCount;
+    uint startIndexLocation;
+    int baseVertexLocation;
+    uint startInstanceLocation;
+    uint padding;
+};
+
+/// <summary>
+/// Bounds of the mesh of a command. Must match IndirectCullRecord in IndirectDrawing.hpp.
+/// </summary>
+struct IndirectCullRecord
+{
+    float4 center;
+    float4 extent;
+    uint instanceIndex;
+    uint groupIdx;
+    uint groupFirstCommand;
+    uint padding;
+};
+
+/// <summary>
+/// Constants that can change every frame.
+/// </summary>
+cbuffer CullingConstants : register(b0)
+{
+    float4 frustumPlanes[6];
+    uint numberOfCommands;
+}
+
+StructuredBuffer<IndirectDrawCommand> g_commandTemplates : register(t0);
+StructuredBuffer<IndirectCullRecord> g_cullRecords : register(t1);
+StructuredBuffer<float4x4> g_instanceTransformations : register(t2);
+RWStructuredBuffer<IndirectDrawCommand> g_visibleCommands : register(u0);
+RWStructuredBuffer<uint> g_visibleCommandCounts : register(u1);
+
+/// <summary>
+/// Same operations in the same order as isInstanceVisible() in IndirectDrawing.cpp. precise keeps the compiler from
+/// fusing or reordering them, so CPU and GPU agree bit for bit.
+/// </summary>
+bool isInstanceVisible(float4x4 m, IndirectCullRecord cullRecord)
+{
+    const float4 c = cullRecord.center;
+    const float4 e = cullRecord.extent;
+
+    precise float3 center;
+    precise float3 extent;
+    [unroll]
+    for (uint r = 0; r < 3; r++)
+    {
+        center[r] = ((m[r][0] * c.x + m[r][1] * c.y) + m[r][2] * c.z) + m[r][3];
+        extent[r] = (abs(m[r][0]) * e.x + abs(m[r][1]) * e.y) + abs(m[r][2]) * e.z;
+    }
+
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        const float4 p = frustumPlanes[i];
+        precise float distance = ((p.x * center.x + p.y * center.y) + p.z * center.z) + p.w;
+        precise float radius = (abs(p.x) * extent.x + abs(p.y) * extent.y) + abs(p.z) * extent.z;
+        if (distance + radius < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+[numthreads(64, 1, 1)]
+void CS_main(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    const uint commandIdx = dispatchThreadId.x;
+    if (commandIdx >= numberOfCommands)
+    {
+        return;
+    }
+
+    const IndirectCullRecord cullRecord = g_cullRecords[commandIdx];
+    if (!isInstanceVisible(g_instanceTransformations[cullRecord.instanceIndex], cullRecord))
+    {
+        return;
+    }
+
+    uint slot;
+    InterlockedAdd(g_visibleCommandCounts[cullRecord.groupIdx], 1, slot);
+    g_visibleCommands[cullRecord.groupFirstCommand + slot] = g_commandTemplates[commandIdx];
+}
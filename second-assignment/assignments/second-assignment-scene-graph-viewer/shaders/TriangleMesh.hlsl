@@ -1,3 +1,20 @@
+/// <summary>
+/// Features of the shader permutations. A material that has no texture in a slot gets the 1x1 default texture, so
+/// its permutation replaces the sample by the default color. Without defines all textures are sampled.
+/// </summary>
+#ifndef HAS_AMBIENT_TEXTURE
+#define HAS_AMBIENT_TEXTURE 1
+#endif
+#ifndef HAS_DIFFUSE_TEXTURE
+#define HAS_DIFFUSE_TEXTURE 1
+#endif
+#ifndef HAS_SPECULAR_TEXTURE
+#define HAS_SPECULAR_TEXTURE 1
+#endif
+#ifndef HAS_EMISSIVE_TEXTURE
+#define HAS_EMISSIVE_TEXTURE 1
+#endif
+
 struct VertexShaderOutput
 {
     float4 clipSpacePosition : SV_POSITION;
@@ -25,19 +42,30 @@ cbuffer PerFrameConstants : register(b0)
 cbuffer PerMeshConstants : register(b1)
 {
     float4x4 modelViewMatrix;
-
+    uint materialIndex;
+    uint instanceOffset;
 }
 
 /// <summary>
 /// Constants that are really constant for the entire scene.
 /// </summary>
-cbuffer Material : register(b2)
+struct Material
 {
     float4 emissiveMaterialParameters;
     float4 ambientMaterialParameters;
     float4 diffuseMaterialParameters;
     float4 specularMaterialParameters;
-}
+};
+
+/// <summary>
+/// Material table with one entry per material of the scene.
+/// </summary>
+StructuredBuffer<Material> g_materials : register(t5);
+
+/// <summary>
+/// Mesh to scene transformation of every instance. The instances of one draw call start at instanceOffset.
+/// </summary>
+StructuredBuffer<float4x4> g_instanceTransformations : register(t6);
 
 
 /// <summary>
@@ -57,13 +85,15 @@ Texture2D<float4> g_textureNormal : register(t4);
 
 SamplerState g_sampler : register(s0);
 
-VertexShaderOutput VS_main(float3 position : POSITION, float3 normal : NORMAL, float2 texCoord : TEXCOORD)
+VertexShaderOutput VS_main(float3 position : POSITION, float3 normal : NORMAL, float2 texCoord : TEXCOORD,
+                           uint instanceID : SV_InstanceID)
 {
     VertexShaderOutput output;
 
-    float4 p4 = mul(modelViewMatrix, float4(position, 1.0f));
+    const float4x4 instanceModelViewMatrix = mul(modelViewMatrix, g_instanceTransformations[instanceOffset + instanceID]);
+    float4 p4 = mul(instanceModelViewMatrix, float4(position, 1.0f));
     output.viewSpacePosition = p4.xyz;
-    output.viewSpaceNormal = mul(modelViewMatrix, float4(normal, 0.0f));
+    output.viewSpaceNormal = mul(instanceModelViewMatrix, float4(normal, 0.0f)).xyz;
     output.clipSpacePosition = mul(projectionMatrix, p4);
     output.texCoord = texCoord;
     return output;
@@ -72,13 +102,30 @@ VertexShaderOutput VS_main(float3 position : POSITION, float3 normal : NORMAL, f
 float4 PS_main(VertexShaderOutput input)
     : SV_TARGET
 {
+    const Material material = g_materials[materialIndex];
     float3 lightIntensity = float3(lightIntensityFactor, lightIntensityFactor, lightIntensityFactor);
     
+    // The defaults match the 1x1 textures the scene binds to empty slots: black, except white for specular.
+#if HAS_DIFFUSE_TEXTURE
     float3 sampledDiffuseColor = g_textureDiffuse.Sample(g_sampler, input.texCoord, 0).rgb;
+#else
+    float3 sampledDiffuseColor = float3(0.0f, 0.0f, 0.0f);
+#endif
+#if HAS_AMBIENT_TEXTURE
     float3 sampledAmbientColor = g_textureAmbient.Sample(g_sampler, input.texCoord, 0).rgb;
+#else
+    float3 sampledAmbientColor = float3(0.0f, 0.0f, 0.0f);
+#endif
+#if HAS_SPECULAR_TEXTURE
     float3 sampledSpecularColor = g_textureSpecular.Sample(g_sampler, input.texCoord, 0).rgb;
+#else
+    float3 sampledSpecularColor = float3(1.0f, 1.0f, 1.0f);
+#endif
+#if HAS_EMISSIVE_TEXTURE
     float3 sampledEmissiveColor = g_textureEmissive.Sample(g_sampler, input.texCoord, 0).rgb;
-    float3 sampledNormalMapTexture = g_textureNormal.Sample(g_sampler, input.texCoord, 0).rgb;
+#else
+    float3 sampledEmissiveColor = float3(0.0f, 0.0f, 0.0f);
+#endif
     
 
 
@@ -90,15 +137,15 @@ float4 PS_main(VertexShaderOutput input)
     
     float3 normalizedHalfwayVector = normalize(normalizeLightDirectionVector + normalizedViewVector);
     float diffuslyReflectedLight = max(0.0f, dot(normalizedNormalVector, normalizeLightDirectionVector));
-    float specularReflectedLight = pow(max(0.0f, dot(normalizedNormalVector, normalizedHalfwayVector)), specularMaterialParameters.w);
+    float specularReflectedLight = pow(max(0.0f, dot(normalizedNormalVector, normalizedHalfwayVector)), material.specularMaterialParameters.w);
     
-    float3 finalColor = emissiveMaterialParameters.xyz * sampledEmissiveColor
+    float3 finalColor = material.emissiveMaterialParameters.xyz * sampledEmissiveColor
                         + 
-                        ambientMaterialParameters.xyz * sampledAmbientColor
+                        material.ambientMaterialParameters.xyz * sampledAmbientColor
                         + 
-                        lightIntensity * diffuslyReflectedLight * diffuseMaterialParameters.xyz * sampledDiffuseColor.xyz
+                        lightIntensity * diffuslyReflectedLight * material.diffuseMaterialParameters.xyz * sampledDiffuseColor.xyz
                         +
-                        lightIntensity * specularReflectedLight * specularMaterialParameters.xyz * sampledSpecularColor.xyz;
+                        lightIntensity * specularReflectedLight * material.specularMaterialParameters.xyz * sampledSpecularColor.xyz;
     
 
     return float4(finalColor, 1.0f);
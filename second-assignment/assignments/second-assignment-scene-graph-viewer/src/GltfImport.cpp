@@ -0,0 +1,280 @@
+#include "GltfImport.hpp"
+#include <gimslib/io/GltfFile.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+
+using namespace gims;
+
+namespace
+{
+// Assimp's aiProcess_ConvertToLeftHanded mirrors the z axis and flips the winding order of the triangles.
+const f32m4 mirrorZ = glm::scale(f32m4(1.0f), f32v3(1.0f, 1.0f, -1.0f));
+
+f32v3 toLeftHanded(const f32v3& v)
+{
+  return f32v3(v.x, v.y, -v.z);
+}
+
+// Converts strips and fans into lists, in the winding order of the file.
+std::vector<ui32> getTriangleList(const std::vector<ui32>& indices, ui32 mode)
+{
+  if (mode == 4)
+  {
+    if (indices.size() % 3 != 0)
+    {
+      throw std::runtime_error("The number of indices of a triangle list is not a multiple of three.");
+    }
+    return indices;
+  }
+  if (mode != 5 && mode != 6)
+  {
+    throw std::runtime_error("Primitives of mode " + std::to_string(mode) + " are not supported, only triangles.");
+  }
+  std::vector<ui32> result;
+  for (size_t i = 2; i < indices.size(); i++)
+  {
+    if (mode == 6)
+    {
+      result.insert(result.end(), {indices[0], indices[i - 1], indices[i]});
+    }
+    else if (i % 2 == 0)
+    {
+      result.insert(result.end(), {indices[i - 2], indices[i - 1], indices[i]});
+    }
+    else
+    {
+      result.insert(result.end(), {indices[i - 1], indices[i - 2], indices[i]});
+    }
+  }
+  return result;
+}
+
+// Area-weighted average of the normals of the adjacent triangles, like aiProcess_GenSmoothNormals.
+void computeSmoothNormals(ImportedMesh& mesh)
+{
+  for (auto& vertex : mesh.vertices)
+  {
+    vertex.normal = f32v3(0.0f);
+  }
+  for (size_t i = 0; i < mesh.indices.size(); i += 3)
+  {
+    Vertex&     v0     = mesh.vertices[mesh.indices[i]];
+    Vertex&     v1     = mesh.vertices[mesh.indices[i + 1]];
+    Vertex&     v2     = mesh.vertices[mesh.indices[i + 2]];
+    const f32v3 normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+    v0.normal += normal;
+    v1.normal += normal;
+    v2.normal += normal;
+  }
+  for (auto& vertex : mesh.vertices)
+  {
+    const f32 length = glm::length(vertex.normal);
+    vertex.normal    = length > 0.0f ? vertex.normal / length : f32v3(0.0f);
+  }
+}
+
+ImportedMesh createMesh(const GltfFile& file, const GltfPrimitive& primitive, ui32 defaultMaterialIdx)
+{
+  if (primitive.positions == GltfFile::invalidIdx)
+  {
+    throw std::runtime_error("A primitive has no positions.");
+  }
+  ImportedMesh mesh;
+  mesh.materialIdx = primitive.material != GltfFile::invalidIdx ? primitive.material : defaultMaterialIdx;
+
+  const auto positions = file.getAccessorView<f32v3>(primitive.positions);
+  const ui32 nVertices = positions.size();
+  const auto normals   = primitive.normals != GltfFile::invalidIdx ? file.getAccessorView<f32v3>(primitive.normals)
+                                                                    : GltfAccessorView<f32v3>();
+  const auto textureCoordinates = primitive.textureCoordinates != GltfFile::invalidIdx
+                                      ? file.getAccessorView<f32v2>(primitive.textureCoordinates)
+                                      : GltfAccessorView<f32v2>();
+  const auto tangents           = primitive.tangents != GltfFile::invalidIdx
+                                      ? file.getAccessorView<f32v4>(primitive.tangents)
+                                      : GltfAccessorView<f32v4>();
+  if ((normals.size() != 0 && normals.size() != nVertices) ||
+      (textureCoordinates.size() != 0 && textureCoordinates.size() != nVertices) ||
+      (tangents.size() != 0 && tangents.size() != nVertices))
+  {
+    throw std::runtime_error("The attributes of a primitive have different numbers of vertices.");
+  }
+
+  mesh.vertices.resize(nVertices);
+  for (ui32 i = 0; i < nVertices; i++)
+  {
+    Vertex& vertex  = mesh.vertices[i];
+    vertex.position = toLeftHanded(positions[i]);
+    vertex.normal   = normals.size() != 0 ? toLeftHanded(normals[i]) : f32v3(0.0f);
+    // Assimp flips v when it reads glTF and again to convert to left-handed coordinates.
+    vertex.textureCoordinate = textureCoordinates.size() != 0 ? textureCoordinates[i] : f32v2(0.0f);
+    vertex.tangent           = tangents.size() != 0 ? toLeftHanded(f32v3(tangents[i])) : f32v3(0.0f);
+  }
+
+  std::vector<ui32> indices;
+  if (primitive.indices != GltfFile::invalidIdx)
+  {
+    indices = file.readIndices(primitive.indices);
+  }
+  else
+  {
+    indices.resize(nVertices);
+    for (ui32 i = 0; i < nVertices; i++)
+    {
+      indices[i] = i;
+    }
+  }
+  const std::vector<ui32> triangles = getTriangleList(indices, primitive.mode);
+  mesh.indices.resize(triangles.size());
+  for (size_t i = 0; i < triangles.size(); i += 3)
+  {
+    if (triangles[i] >= nVertices || triangles[i + 1] >= nVertices || triangles[i + 2] >= nVertices)
+    {
+      throw std::runtime_error("An index of a primitive exceeds its vertices.");
+    }
+    mesh.indices[i]     = triangles[i + 2];
+    mesh.indices[i + 1] = triangles[i + 1];
+    mesh.indices[i + 2] = triangles[i];
+  }
+
+  if (normals.size() == 0)
+  {
+    computeSmoothNormals(mesh);
+  }
+  return mesh;
+}
+
+ui32 appendNodes(const GltfFile& file, ui32 gltfNodeIdx, const std::vector<ui32>& firstMeshIdx,
+                 std::vector<SceneNode>& nodes)
+{
+  const GltfNode& gltfNode = file.getNodes()[gltfNodeIdx];
+  const ui32      nodeIdx  = static_cast<ui32>(nodes.size());
+  nodes.emplace_back();
+  nodes[nodeIdx].transformation = mirrorZ * gltfNode.transformation * mirrorZ;
+  if (gltfNode.mesh != GltfFile::invalidIdx)
+  {
+    for (ui32 i = firstMeshIdx[gltfNode.mesh]; i < firstMeshIdx[gltfNode.mesh + 1]; i++)
+    {
+      nodes[nodeIdx].meshIndices.push_back(i);
+    }
+  }
+  for (const ui32 child : gltfNode.children)
+  {
+    // The vector may grow, so the node is looked up again after each child.
+    const ui32 childIdx = appendNodes(file, child, firstMeshIdx, nodes);
+    nodes[nodeIdx].childIndices.push_back(childIdx);
+  }
+  return nodeIdx;
+}
+
+// Returns the index of a texture in the scene, or the default texture of the slot if the material has none.
+ui32 getTextureIndex(const GltfFile& file, ui32 gltfTextureIdx, ui32 defaultTextureIdx,
+                     std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex)
+{
+  if (gltfTextureIdx == GltfFile::invalidIdx)
+  {
+    return defaultTextureIdx;
+  }
+  // Indices start at 3, after the white, black, and normal map default textures.
+  const auto& path = file.getTextureImagePath(gltfTextureIdx);
+  return textureFileNameToTextureIndex.emplace(path, static_cast<ui32>(textureFileNameToTextureIndex.size() + 3))
+      .first->second;
+}
+
+// Maps the material like the glTF importer of Assimp does, see getColor and getTexture.
+ImportedMaterial createMaterial(const GltfFile& file, const GltfMaterial& gltfMaterial,
+                                std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex)
+{
+  const f32 exponent = gltfMaterial.specularGlossiness
+                           ? gltfMaterial.glossinessFactor * 1000.0f
+                           : (1.0f - gltfMaterial.roughnessFactor) * (1.0f - gltfMaterial.roughnessFactor) * 1000.0f;
+  const f32v3 specularColor = gltfMaterial.hasSpecularColor ? gltfMaterial.specularColorFactor : f32v3(0.0f);
+
+  ImportedMaterial material;
+  material.emissive                 = f32v4(gltfMaterial.emissiveFactor, 0.0f);
+  material.ambient                  = f32v4(0.0f);
+  material.diffuse                  = f32v4(f32v3(gltfMaterial.baseColorFactor), 0.0f);
+  material.specularColorAndExponent = f32v4(specularColor, exponent);
+
+  // glTF has no ambient and height textures, normal maps are no height maps.
+  const ui32 slotTextures[]     = {GltfFile::invalidIdx, gltfMaterial.baseColorTexture,
+                                   gltfMaterial.specularGlossinessTexture, gltfMaterial.emissiveTexture,
+                                   GltfFile::invalidIdx};
+  const ui32 defaultTextures[] = {1, 1, 0, 1, 2};
+  for (ui32 slot = 0; slot < material.textureIndices.size(); slot++)
+  {
+    material.textureIndices[slot] =
+        getTextureIndex(file, slotTextures[slot], defaultTextures[slot], textureFileNameToTextureIndex);
+    if (slotTextures[slot] != GltfFile::invalidIdx)
+    {
+      material.textureMask |= 1u << slot;
+    }
+  }
+  return material;
+}
+} // namespace
+
+namespace gims
+{
+ImportedScene importGltfScene(const std::filesystem::path& pathToScene)
+{
+  GIMS_PROFILE_ZONE("Import glTF");
+  const GltfFile file(pathToScene);
+  ImportedScene  result;
+
+  const auto& gltfMeshes = file.getMeshes();
+  const ui32  nMaterials = static_cast<ui32>(file.getMaterials().size());
+  bool        needsDefaultMaterial = false;
+  {
+    GIMS_PROFILE_ZONE("Create Meshes");
+    // Every primitive becomes a mesh of its own, the primitives of glTF mesh i are meshes firstMeshIdx[i] and on.
+    std::vector<ui32> firstMeshIdx;
+    for (const auto& gltfMesh : gltfMeshes)
+    {
+      firstMeshIdx.push_back(static_cast<ui32>(result.meshes.size()));
+      for (const auto& primitive : gltfMesh.primitives)
+      {
+        result.meshes.push_back(createMesh(file, primitive, nMaterials));
+        needsDefaultMaterial |= primitive.material == GltfFile::invalidIdx;
+      }
+    }
+    firstMeshIdx.push_back(static_cast<ui32>(result.meshes.size()));
+
+    // Like Assimp, a single root is the root node, several roots get a common parent.
+    const auto& rootNodes = file.getRootNodes();
+    if (rootNodes.size() == 1)
+    {
+      appendNodes(file, rootNodes[0], firstMeshIdx, result.nodes);
+    }
+    else
+    {
+      result.nodes.emplace_back();
+      result.nodes[0].transformation = glm::identity<f32m4>();
+      for (const ui32 root : rootNodes)
+      {
+        const ui32 childIdx = appendNodes(file, root, firstMeshIdx, result.nodes);
+        result.nodes[0].childIndices.push_back(childIdx);
+      }
+    }
+  }
+
+  {
+    GIMS_PROFILE_ZONE("Create Materials");
+    for (const auto& gltfMaterial : file.getMaterials())
+    {
+      result.materials.push_back(createMaterial(file, gltfMaterial, result.textureFileNameToTextureIndex));
+    }
+    if (needsDefaultMaterial)
+    {
+      result.materials.push_back(
+          createMaterial(file, GltfFile::getDefaultMaterial(), result.textureFileNameToTextureIndex));
+    }
+  }
+  return result;
+}
+
+bool isGltfFile(const std::filesystem::path& pathToScene)
+{
+  const auto extension = pathToScene.extension();
+  return extension == ".gltf" || extension == ".glb" || extension == ".GLTF" || extension == ".GLB";
+}
+} // namespace gims
@@ -0,0 +1,201 @@
+#include "IndirectDrawing.hpp"
+#include <cstddef>
+#include <stdexcept>
+
+using namespace gims;
+
+static_assert(sizeof(IndirectDrawCommand) == 64, "Command stride must match the HLSL struct.");
+static_assert(offsetof(IndirectDrawCommand, vertexBufferLocation) == 8, "Layout must match the command signature.");
+static_assert(offsetof(IndirectDrawCommand, indexBufferLocation) == 24, "Layout must match the command signature.");
+static_assert(offsetof(IndirectDrawCommand, indexCountPerInstance) == 40, "Layout must match the command signature.");
+static_assert(sizeof(IndirectCullRecord) == 48, "Cull record stride must match the HLSL struct.");
+
+namespace
+{
+ui32 alignUp(ui32 value, ui32 alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+f32v4 getRow(const f32m4& m, ui32 rowIdx)
+{
+  return f32v4(m[0][rowIdx], m[1][rowIdx], m[2][rowIdx], m[3][rowIdx]);
+}
+} // namespace
+
+namespace gims
+{
+std::vector<IndirectArgument> getIndirectDrawCommandLayout(ui32 rootConstantsParameterIdx)
+{
+  IndirectArgument constants;
+  constants.type                    = IndirectArgumentType::Constant;
+  constants.rootParameterIdx        = rootConstantsParameterIdx;
+  constants.destOffsetIn32BitValues = 16;
+  constants.num32BitValues          = 2;
+
+  IndirectArgument vertexBufferView;
+  vertexBufferView.type = IndirectArgumentType::VertexBufferView;
+  IndirectArgument indexBufferView;
+  indexBufferView.type = IndirectArgumentType::IndexBufferView;
+  IndirectArgument drawIndexed;
+  drawIndexed.type = IndirectArgumentType::DrawIndexed;
+
+  return {constants, vertexBufferView, indexBufferView, drawIndexed};
+}
+
+ui32 getIndirectArgumentSizeInBytes(const IndirectArgument& argument)
+{
+  switch (argument.type)
+  {
+    case IndirectArgumentType::Constant:
+      return argument.num32BitValues * 4;
+    case IndirectArgumentType::VertexBufferView:
+    case IndirectArgumentType::IndexBufferView:
+      return 16;
+    case IndirectArgumentType::DrawIndexed:
+      return 20;
+  }
+  throw std::invalid_argument("Unknown indirect argument type.");
+}
+
+std::vector<ui32> getIndirectArgumentOffsets(const std::vector<IndirectArgument>& layout)
+{
+  std::vector<ui32> offsets;
+  ui32              offset = 0;
+  for (const auto& argument : layout)
+  {
+    // Buffer views start with a GPU virtual address.
+    if (argument.type == IndirectArgumentType::VertexBufferView ||
+        argument.type == IndirectArgumentType::IndexBufferView)
+    {
+      offset = alignUp(offset, 8);
+    }
+    offsets.push_back(offset);
+    offset += getIndirectArgumentSizeInBytes(argument);
+  }
+  offsets.push_back(alignUp(offset, 16));
+  return offsets;
+}
+
+IndirectDrawData packIndirectDrawData(const std::vector<InstanceBatch>&       batches,
+                                      const std::vector<IndirectMeshBuffers>& meshes)
+{
+  ui32 nMaterials = 0;
+  for (const auto& mesh : meshes)
+  {
+    nMaterials = glm::max(nMaterials, mesh.materialIndex + 1);
+  }
+
+  std::vector<std::vector<const InstanceBatch*>> batchesPerMaterial(nMaterials);
+  for (const auto& batch : batches)
+  {
+    if (batch.meshIdx >= meshes.size())
+    {
+      throw std::out_of_range("Instance batch references a mesh that does not exist.");
+    }
+    batchesPerMaterial[meshes[batch.meshIdx].materialIndex].push_back(&batch);
+  }
+
+  IndirectDrawData result;
+  for (ui32 materialIdx = 0; materialIdx < nMaterials; materialIdx++)
+  {
+    if (batchesPerMaterial[materialIdx].empty())
+    {
+      continue;
+    }
+    IndirectMaterialGroup group;
+    group.materialIndex = materialIdx;
+    group.firstCommand  = static_cast<ui32>(result.commandTemplates.size());
+
+    for (const InstanceBatch* batch : batchesPerMaterial[materialIdx])
+    {
+      const IndirectMeshBuffers& mesh = meshes[batch->meshIdx];
+      for (ui32 i = 0; i < batch->nInstances; i++)
+      {
+        IndirectDrawCommand command;
+        command.materialIndex         = mesh.materialIndex;
+        command.instanceIndex         = batch->firstInstance + i;
+        command.vertexBufferLocation  = mesh.vertexBufferLocation;
+        command.vertexBufferSize      = mesh.vertexBufferSize;
+        command.vertexBufferStride    = mesh.vertexBufferStride;
+        command.indexBufferLocation   = mesh.indexBufferLocation;
+        command.indexBufferSize       = mesh.indexBufferSize;
+        command.indexBufferFormat     = mesh.indexBufferFormat;
+        command.indexCountPerInstance = mesh.nIndices;
+        command.instanceCount         = 1;
+        result.commandTemplates.push_back(command);
+
+        IndirectCullRecord cullRecord;
+        cullRecord.center            = f32v4((mesh.lowerLeftBottom + mesh.upperRightTop) * 0.5f, 1.0f);
+        cullRecord.extent            = f32v4((mesh.upperRightTop - mesh.lowerLeftBottom) * 0.5f, 0.0f);
+        cullRecord.instanceIndex     = command.instanceIndex;
+        cullRecord.groupIdx          = static_cast<ui32>(result.groups.size());
+        cullRecord.groupFirstCommand = group.firstCommand;
+        result.cullRecords.push_back(cullRecord);
+      }
+    }
+    group.nCommands = static_cast<ui32>(result.commandTemplates.size()) - group.firstCommand;
+    result.groups.push_back(group);
+  }
+  return result;
+}
+
+FrustumPlanes extractFrustumPlanes(const f32m4& viewProjection)
+{
+  const f32v4 row0 = getRow(viewProjection, 0);
+  const f32v4 row1 = getRow(viewProjection, 1);
+  const f32v4 row2 = getRow(viewProjection, 2);
+  const f32v4 row3 = getRow(viewProjection, 3);
+
+  FrustumPlanes frustum;
+  frustum.planes[0] = row3 + row0;
+  frustum.planes[1] = row3 - row0;
+  frustum.planes[2] = row3 + row1;
+  frustum.planes[3] = row3 - row1;
+  frustum.planes[4] = row2;
+  frustum.planes[5] = row3 - row2;
+  return frustum;
+}
+
+bool isInstanceVisible(const FrustumPlanes& frustum, const f32m4& m, const IndirectCullRecord& cullRecord)
+{
+  // Every sum is spelled out so the evaluation order matches the HLSL kernel, which is compiled with precise.
+  const f32v4& c = cullRecord.center;
+  const f32v4& e = cullRecord.extent;
+
+  f32v3 center;
+  f32v3 extent;
+  for (i32 r = 0; r < 3; r++)
+  {
+    center[r] = ((m[0][r] * c.x + m[1][r] * c.y) + m[2][r] * c.z) + m[3][r];
+    extent[r] = (glm::abs(m[0][r]) * e.x + glm::abs(m[1][r]) * e.y) + glm::abs(m[2][r]) * e.z;
+  }
+
+  for (const f32v4& p : frustum.planes)
+  {
+    const f32 distance = ((p.x * center.x + p.y * center.y) + p.z * center.z) + p.w;
+    const f32 radius   = (glm::abs(p.x) * extent.x + glm::abs(p.y) * extent.y) + glm::abs(p.z) * extent.z;
+    if (distance + radius < 0.0f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<ui32> cullIndirectDrawDataReference(const FrustumPlanes&      frustum,
+                                                const std::vector<f32m4>& instanceTransformations,
+                                                const IndirectDrawData&   indirectDrawData)
+{
+  std::vector<ui32> visibleCommands;
+  for (ui32 i = 0; i < indirectDrawData.cullRecords.size(); i++)
+  {
+    const auto& cullRecord = indirectDrawData.cullRecords[i];
+    if (isInstanceVisible(frustum, instanceTransformations[cullRecord.instanceIndex], cullRecord))
+    {
+      visibleCommands.push_back(i);
+    }
+  }
+  return visibleCommands;
+}
+} // namespace gims
@@ -0,0 +1,329 @@
+#include "IndirectSceneRendererD3D12.hpp"
+#include <algorithm>
+#include <d3dx12/d3dx12.h>
+#include <gimslib/dbg/HrException.hpp>
+#include <stdexcept>
+
+using namespace gims;
+
+namespace
+{
+D3D12_INDIRECT_ARGUMENT_DESC convert(const IndirectArgument& argument)
+{
+  D3D12_INDIRECT_ARGUMENT_DESC result = {};
+  switch (argument.type)
+  {
+    case IndirectArgumentType::Constant:
+      result.Type                             = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+      result.Constant.RootParameterIndex      = argument.rootParameterIdx;
+      result.Constant.DestOffsetIn32BitValues = argument.destOffsetIn32BitValues;
+      result.Constant.Num32BitValuesToSet     = argument.num32BitValues;
+      break;
+    case IndirectArgumentType::VertexBufferView:
+      result.Type              = D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW;
+      result.VertexBuffer.Slot = 0;
+      break;
+    case IndirectArgumentType::IndexBufferView:
+      result.Type = D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW;
+      break;
+    case IndirectArgumentType::DrawIndexed:
+      result.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+      break;
+  }
+  return result;
+}
+
+ComPtr<ID3D12Resource> createBuffer(const ComPtr<ID3D12Device>& device, size_t sizeInBytes, D3D12_HEAP_TYPE heapType,
+                                    D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState)
+{
+  ComPtr<ID3D12Resource>        buffer;
+  const CD3DX12_HEAP_PROPERTIES heapProperties    = CD3DX12_HEAP_PROPERTIES(heapType);
+  const CD3DX12_RESOURCE_DESC   bufferDescription = CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes, flags);
+  throwIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDescription,
+                                                initialState, nullptr, IID_PPV_ARGS(&buffer)));
+  return buffer;
+}
+} // namespace
+
+namespace gims
+{
+IndirectSceneRendererD3D12::IndirectSceneRendererD3D12()
+    : m_instanceTableLocation(0)
+    , m_cullingConstants()
+    , m_validationEnabled(false)
+    , m_nVisibleCommandsOnGPU(0)
+    , m_nVisibleCommandsOnCPU(0)
+    , m_validationMatching(true)
+{
+}
+
+IndirectSceneRendererD3D12::IndirectSceneRendererD3D12(const Scene& scene, const ComPtr<ID3D12Device>& device,
+                                                       const ComPtr<ID3D12RootSignature>& graphicsRootSignature,
+                                                       ui32                               modelViewRootParameterIdx,
+                                                       const D3D12_SHADER_BYTECODE&       cullingShader,
+                                                       ui32                               frameCount)
+    : IndirectSceneRendererD3D12()
+{
+  std::vector<IndirectMeshBuffers> meshes(scene.getNumberOfMeshesAvailable());
+  for (ui32 i = 0; i < meshes.size(); i++)
+  {
+    const TriangleMeshD3D12& mesh   = scene.getMesh(i);
+    meshes[i].vertexBufferLocation  = mesh.getVertexBufferView().BufferLocation;
+    meshes[i].vertexBufferSize      = mesh.getVertexBufferView().SizeInBytes;
+    meshes[i].vertexBufferStride    = mesh.getVertexBufferView().StrideInBytes;
+    meshes[i].indexBufferLocation   = mesh.getIndexBufferView().BufferLocation;
+    meshes[i].indexBufferSize       = mesh.getIndexBufferView().SizeInBytes;
+    meshes[i].indexBufferFormat     = static_cast<ui32>(mesh.getIndexBufferView().Format);
+    meshes[i].nIndices              = mesh.getNumberOfIndices();
+    meshes[i].materialIndex         = mesh.getMaterialIndex();
+    meshes[i].lowerLeftBottom       = mesh.getAABB().getLowerLeftBottom();
+    meshes[i].upperRightTop         = mesh.getAABB().getUpperRightTop();
+  }
+  m_indirectDrawData        = packIndirectDrawData(scene.getInstanceBatches(), meshes);
+  m_instanceTransformations = scene.getInstanceTransformations();
+
+  const ui32 nCommands = getNumberOfCommands();
+  const ui32 nGroups   = static_cast<ui32>(m_indirectDrawData.groups.size());
+  if (nCommands == 0)
+  {
+    return;
+  }
+
+  m_instanceTableLocation = scene.getInstanceTable().getResource()->GetGPUVirtualAddress();
+  m_commandTemplates      = StructuredBufferD3D12(m_indirectDrawData.commandTemplates.data(), nCommands, device);
+  m_cullRecords           = StructuredBufferD3D12(m_indirectDrawData.cullRecords.data(), nCommands, device);
+
+  const size_t commandsSizeInBytes = nCommands * sizeof(IndirectDrawCommand);
+  const size_t countsSizeInBytes   = nGroups * sizeof(ui32);
+  m_visibleCommands      = createBuffer(device, commandsSizeInBytes, D3D12_HEAP_TYPE_DEFAULT,
+                                        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+  m_visibleCommandCounts = createBuffer(device, countsSizeInBytes, D3D12_HEAP_TYPE_DEFAULT,
+                                        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_DEST);
+  m_zeroCounts = createBuffer(device, countsSizeInBytes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_FLAG_NONE,
+                              D3D12_RESOURCE_STATE_GENERIC_READ);
+  void* p;
+  throwIfFailed(m_zeroCounts->Map(0, nullptr, &p));
+  ::memset(p, 0, countsSizeInBytes);
+  m_zeroCounts->Unmap(0, nullptr);
+
+  m_readBackBuffers.resize(frameCount);
+  m_readBackConstants.resize(frameCount);
+  m_readBackPending.resize(frameCount, false);
+  for (auto& readBackBuffer : m_readBackBuffers)
+  {
+    readBackBuffer = createBuffer(device, countsSizeInBytes + commandsSizeInBytes, D3D12_HEAP_TYPE_READBACK,
+                                  D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+  }
+
+  // Command signature.
+  const auto layout  = getIndirectDrawCommandLayout(modelViewRootParameterIdx);
+  const auto offsets = getIndirectArgumentOffsets(layout);
+  if (offsets.back() != sizeof(IndirectDrawCommand))
+  {
+    throw std::runtime_error("Indirect command layout does not match IndirectDrawCommand.");
+  }
+  std::vector<D3D12_INDIRECT_ARGUMENT_DESC> argumentDescs;
+  for (const auto& argument : layout)
+  {
+    argumentDescs.push_back(convert(argument));
+  }
+  D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = {};
+  commandSignatureDesc.ByteStride                   = offsets.back();
+  commandSignatureDesc.NumArgumentDescs             = static_cast<ui32>(argumentDescs.size());
+  commandSignatureDesc.pArgumentDescs               = argumentDescs.data();
+  throwIfFailed(device->CreateCommandSignature(&commandSignatureDesc, graphicsRootSignature.Get(),
+                                               IID_PPV_ARGS(&m_commandSignature)));
+
+  // Culling pipeline.
+  const uint8_t          NUMBER_OF_ROOT_PARAMETERS             = 6;
+  CD3DX12_ROOT_PARAMETER parameters[NUMBER_OF_ROOT_PARAMETERS] = {};
+  parameters[0].InitAsConstants(sizeof(CullingConstants) / 4, 0);
+  parameters[1].InitAsShaderResourceView(0);
+  parameters[2].InitAsShaderResourceView(1);
+  parameters[3].InitAsShaderResourceView(2);
+  parameters[4].InitAsUnorderedAccessView(0);
+  parameters[5].InitAsUnorderedAccessView(1);
+
+  CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDescription = {};
+  rootSignatureDescription.Init(NUMBER_OF_ROOT_PARAMETERS, parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+  ComPtr<ID3DBlob> rootBlob, errorBlob;
+  throwIfFailed(
+      D3D12SerializeRootSignature(&rootSignatureDescription, D3D_ROOT_SIGNATURE_VERSION_1, &rootBlob, &errorBlob));
+  throwIfFailed(device->CreateRootSignature(0, rootBlob->GetBufferPointer(), rootBlob->GetBufferSize(),
+                                            IID_PPV_ARGS(&m_cullingRootSignature)));
+
+  D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+  psoDesc.pRootSignature                    = m_cullingRootSignature.Get();
+  psoDesc.CS                                = cullingShader;
+  psoDesc.Flags                             = D3D12_PIPELINE_STATE_FLAG_NONE;
+  throwIfFailed(device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_cullingPipelineState)));
+}
+
+void IndirectSceneRendererD3D12::cull(const ComPtr<ID3D12GraphicsCommandList6>& commandList,
+                                      const f32m4& viewProjection, ui32 frameIdx)
+{
+  if (getNumberOfCommands() == 0)
+  {
+    return;
+  }
+
+  // The read back buffer of this frame index was filled the last time this frame was in flight, which has finished.
+  if (m_validationEnabled && m_readBackPending[frameIdx])
+  {
+    validate(frameIdx);
+  }
+
+  m_cullingConstants.frustum   = extractFrustumPlanes(viewProjection);
+  m_cullingConstants.nCommands = getNumberOfCommands();
+
+  const ui32 nGroups = static_cast<ui32>(m_indirectDrawData.groups.size());
+  commandList->CopyBufferRegion(m_visibleCommandCounts.Get(), 0, m_zeroCounts.Get(), 0, nGroups * sizeof(ui32));
+  const auto countsToUAV = CD3DX12_RESOURCE_BARRIER::Transition(
+      m_visibleCommandCounts.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+  commandList->ResourceBarrier(1, &countsToUAV);
+
+  commandList->SetComputeRootSignature(m_cullingRootSignature.Get());
+  commandList->SetPipelineState(m_cullingPipelineState.Get());
+  commandList->SetComputeRoot32BitConstants(0, sizeof(CullingConstants) / 4, &m_cullingConstants, 0);
+  commandList->SetComputeRootShaderResourceView(1, m_commandTemplates.getResource()->GetGPUVirtualAddress());
+  commandList->SetComputeRootShaderResourceView(2, m_cullRecords.getResource()->GetGPUVirtualAddress());
+  commandList->SetComputeRootShaderResourceView(3, m_instanceTableLocation);
+  commandList->SetComputeRootUnorderedAccessView(4, m_visibleCommands->GetGPUVirtualAddress());
+  commandList->SetComputeRootUnorderedAccessView(5, m_visibleCommandCounts->GetGPUVirtualAddress());
+  commandList->Dispatch((getNumberOfCommands() + 63) / 64, 1, 1);
+
+  const CD3DX12_RESOURCE_BARRIER toIndirectArgument[] = {
+      CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommands.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                                           D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+      CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommandCounts.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                                           D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT)};
+  commandList->ResourceBarrier(_countof(toIndirectArgument), toIndirectArgument);
+}
+
+void IndirectSceneRendererD3D12::draw(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const Scene& scene,
+                                      const f32m4& viewMatrix, ui32 modelViewRootParameterIdx,
+                                      ui32 materialTableRootParameterIdx, ui32 instanceTableRootParameterIdx,
+                                      ui32 srvRootParameterIdx, ui32 frameIdx)
+{
+  if (getNumberOfCommands() == 0)
+  {
+    return;
+  }
+
+  commandList->SetGraphicsRootShaderResourceView(materialTableRootParameterIdx,
+                                                 scene.getMaterialTable().getResource()->GetGPUVirtualAddress());
+  commandList->SetGraphicsRootShaderResourceView(instanceTableRootParameterIdx,
+                                                 scene.getInstanceTable().getResource()->GetGPUVirtualAddress());
+  commandList->SetGraphicsRoot32BitConstants(modelViewRootParameterIdx, 16, &viewMatrix, 0);
+  commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+  for (ui32 groupIdx = 0; groupIdx < m_indirectDrawData.groups.size(); groupIdx++)
+  {
+    const auto&            group    = m_indirectDrawData.groups[groupIdx];
+    const Scene::Material& material = scene.getMaterial(group.materialIndex);
+    commandList->SetDescriptorHeaps(1, material.srvDescriptorHeap.GetAddressOf());
+    commandList->SetGraphicsRootDescriptorTable(srvRootParameterIdx,
+                                                material.srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    commandList->ExecuteIndirect(m_commandSignature.Get(), group.nCommands, m_visibleCommands.Get(),
+                                 group.firstCommand * sizeof(IndirectDrawCommand), m_visibleCommandCounts.Get(),
+                                 groupIdx * sizeof(ui32));
+  }
+
+  const ui32 nGroups = static_cast<ui32>(m_indirectDrawData.groups.size());
+  if (m_validationEnabled)
+  {
+    const CD3DX12_RESOURCE_BARRIER toCopySource[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommands.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+                                             D3D12_RESOURCE_STATE_COPY_SOURCE),
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommandCounts.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+                                             D3D12_RESOURCE_STATE_COPY_SOURCE)};
+    commandList->ResourceBarrier(_countof(toCopySource), toCopySource);
+    commandList->CopyBufferRegion(m_readBackBuffers[frameIdx].Get(), 0, m_visibleCommandCounts.Get(), 0,
+                                  nGroups * sizeof(ui32));
+    commandList->CopyBufferRegion(m_readBackBuffers[frameIdx].Get(), nGroups * sizeof(ui32), m_visibleCommands.Get(),
+                                  0, getNumberOfCommands() * sizeof(IndirectDrawCommand));
+    m_readBackConstants[frameIdx] = m_cullingConstants;
+    m_readBackPending[frameIdx]   = true;
+
+    const CD3DX12_RESOURCE_BARRIER toNextFrame[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommands.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE,
+                                             D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommandCounts.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE,
+                                             D3D12_RESOURCE_STATE_COPY_DEST)};
+    commandList->ResourceBarrier(_countof(toNextFrame), toNextFrame);
+  }
+  else
+  {
+    const CD3DX12_RESOURCE_BARRIER toNextFrame[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommands.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+                                             D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        CD3DX12_RESOURCE_BARRIER::Transition(m_visibleCommandCounts.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+                                             D3D12_RESOURCE_STATE_COPY_DEST)};
+    commandList->ResourceBarrier(_countof(toNextFrame), toNextFrame);
+  }
+}
+
+void IndirectSceneRendererD3D12::validate(ui32 frameIdx)
+{
+  m_readBackPending[frameIdx] = false;
+
+  const auto& groups  = m_indirectDrawData.groups;
+  const ui32  nGroups = static_cast<ui32>(groups.size());
+
+  std::vector<ui32> gpuVisibleInstances;
+  ui8*              p;
+  throwIfFailed(m_readBackBuffers[frameIdx]->Map(0, nullptr, reinterpret_cast<void**>(&p)));
+  const ui32*                counts   = reinterpret_cast<const ui32*>(p);
+  const IndirectDrawCommand* commands = reinterpret_cast<const IndirectDrawCommand*>(p + nGroups * sizeof(ui32));
+  for (ui32 groupIdx = 0; groupIdx < nGroups; groupIdx++)
+  {
+    const ui32 nVisible = std::min(counts[groupIdx], groups[groupIdx].nCommands);
+    for (ui32 i = 0; i < nVisible; i++)
+    {
+      gpuVisibleInstances.push_back(commands[groups[groupIdx].firstCommand + i].instanceIndex);
+    }
+  }
+  const D3D12_RANGE nothingWritten = {0, 0};
+  m_readBackBuffers[frameIdx]->Unmap(0, &nothingWritten);
+
+  std::vector<ui32> cpuVisibleInstances;
+  for (const ui32 commandIdx : cullIndirectDrawDataReference(m_readBackConstants[frameIdx].frustum,
+                                                             m_instanceTransformations, m_indirectDrawData))
+  {
+    cpuVisibleInstances.push_back(m_indirectDrawData.commandTemplates[commandIdx].instanceIndex);
+  }
+
+  // The order within a group depends on the scheduling of the GPU threads, so the sets are compared sorted.
+  std::sort(gpuVisibleInstances.begin(), gpuVisibleInstances.end());
+  std::sort(cpuVisibleInstances.begin(), cpuVisibleInstances.end());
+  m_nVisibleCommandsOnGPU = static_cast<ui32>(gpuVisibleInstances.size());
+  m_nVisibleCommandsOnCPU = static_cast<ui32>(cpuVisibleInstances.size());
+  m_validationMatching    = gpuVisibleInstances == cpuVisibleInstances;
+}
+
+void IndirectSceneRendererD3D12::setValidation(bool enabled)
+{
+  m_validationEnabled = enabled;
+}
+
+ui32 IndirectSceneRendererD3D12::getNumberOfCommands() const
+{
+  return static_cast<ui32>(m_indirectDrawData.commandTemplates.size());
+}
+
+ui32 IndirectSceneRendererD3D12::getNumberOfVisibleCommandsOnGPU() const
+{
+  return m_nVisibleCommandsOnGPU;
+}
+
+ui32 IndirectSceneRendererD3D12::getNumberOfVisibleCommandsOnCPU() const
+{
+  return m_nVisibleCommandsOnCPU;
+}
+
+bool IndirectSceneRendererD3D12::isValidationMatching() const
+{
+  return m_validationMatching;
+}
+} // namespace gims
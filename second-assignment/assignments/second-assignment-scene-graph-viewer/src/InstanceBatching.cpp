@@ -0,0 +1,83 @@
+#include "InstanceBatching.hpp"
+#include <ostream>
+
+using namespace gims;
+
+namespace
+{
+void collectInstancesImpl(const std::vector<SceneNode>& nodes, ui32 nodeIdx, const f32m4& transformation,
+                          std::vector<std::vector<f32m4>>& instancesPerMesh, ui32& nMeshOccurrences)
+{
+  if (nodeIdx >= nodes.size())
+  {
+    return;
+  }
+
+  const SceneNode& currentNode               = nodes[nodeIdx];
+  const f32m4      accumulatedTransformation = transformation * currentNode.transformation;
+
+  for (const ui32 meshIdx : currentNode.meshIndices)
+  {
+    if (meshIdx >= instancesPerMesh.size())
+    {
+      continue;
+    }
+    instancesPerMesh[meshIdx].push_back(accumulatedTransformation);
+    nMeshOccurrences++;
+  }
+
+  for (const ui32 childIdx : currentNode.childIndices)
+  {
+    collectInstancesImpl(nodes, childIdx, accumulatedTransformation, instancesPerMesh, nMeshOccurrences);
+  }
+}
+} // namespace
+
+namespace gims
+{
+InstanceBatches createInstanceBatches(const std::vector<SceneNode>& nodes, ui32 nMeshes, ui32 rootNodeIdx)
+{
+  std::vector<std::vector<f32m4>> instancesPerMesh(nMeshes);
+  ui32                            nMeshOccurrences = 0;
+  collectInstancesImpl(nodes, rootNodeIdx, glm::identity<f32m4>(), instancesPerMesh, nMeshOccurrences);
+
+  InstanceBatches result;
+  result.instanceTransformations.reserve(nMeshOccurrences);
+  for (ui32 meshIdx = 0; meshIdx < nMeshes; meshIdx++)
+  {
+    const auto& instances = instancesPerMesh[meshIdx];
+    if (instances.empty())
+    {
+      continue;
+    }
+    InstanceBatch batch;
+    batch.meshIdx       = meshIdx;
+    batch.firstInstance = static_cast<ui32>(result.instanceTransformations.size());
+    batch.nInstances    = static_cast<ui32>(instances.size());
+    result.batches.push_back(batch);
+    result.instanceTransformations.insert(result.instanceTransformations.end(), instances.begin(), instances.end());
+  }
+  result.nDrawCallsWithoutInstancing = nMeshOccurrences;
+  result.nDrawCallsWithInstancing    = static_cast<ui32>(result.batches.size());
+  return result;
+}
+
+void printInstanceBatchingReport(std::ostream& stream, const InstanceBatches& instanceBatches)
+{
+  ui32 nInstancedBatches = 0;
+  for (const auto& batch : instanceBatches.batches)
+  {
+    if (batch.nInstances > 1)
+    {
+      nInstancedBatches++;
+    }
+  }
+  stream << "Instancing Information:\n"
+         << "-----------------------\n"
+         << "Number of Batches: " << instanceBatches.batches.size() << "\n"
+         << "Number of Batches With More Than One Instance: " << nInstancedBatches << "\n"
+         << "Number of Instances: " << instanceBatches.instanceTransformations.size() << "\n"
+         << "Draw Calls Without Instancing: " << instanceBatches.nDrawCallsWithoutInstancing << "\n"
+         << "Draw Calls With Instancing: " << instanceBatches.nDrawCallsWithInstancing << std::endl;
+}
+} // namespace gims
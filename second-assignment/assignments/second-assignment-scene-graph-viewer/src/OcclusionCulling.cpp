@@ -0,0 +1,503 @@
+#include "OcclusionCulling.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <gimslib/sys/Profiler.hpp>
+#include <limits>
+#include <ostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GIMS_OCCLUSION_CULLING_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace gims;
+
+namespace
+{
+using Clock = std::chrono::high_resolution_clock;
+
+f64 getMilliseconds(Clock::time_point start, Clock::time_point end)
+{
+  return std::chrono::duration<f64, std::milli>(end - start).count();
+}
+
+/// <summary>
+/// Intersection of the segment between two clip-space points with the near plane z = 0.
+/// </summary>
+f32v4 intersectNearPlane(const f32v4& a, const f32v4& b)
+{
+  const f32 t = a.z / (a.z - b.z);
+  return a + (b - a) * t;
+}
+
+AABB transformAABB(const AABB& aabb, const f32m4& transformation)
+{
+  const f32v3& l = aabb.getLowerLeftBottom();
+  const f32v3& u = aabb.getUpperRightTop();
+  f32v3        corners[8];
+  for (ui32 i = 0; i < 8; i++)
+  {
+    const f32v3 corner = f32v3(i & 1 ? u.x : l.x, i & 2 ? u.y : l.y, i & 4 ? u.z : l.z);
+    corners[i]         = f32v3(transformation * f32v4(corner, 1.0f));
+  }
+  return AABB(corners, 8);
+}
+
+f32 getSurfaceArea(const AABB& aabb)
+{
+  const f32v3 size = aabb.getUpperRightTop() - aabb.getLowerLeftBottom();
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+} // namespace
+
+namespace gims
+{
+f64 OcclusionCullingFrameStatistics::getTotalMilliseconds() const
+{
+  return rasterizationMilliseconds + hiZMilliseconds + testMilliseconds;
+}
+
+OcclusionCuller::OcclusionCuller()
+    : OcclusionCuller(OcclusionCullingSettings(), nullptr)
+{
+}
+
+OcclusionCuller::OcclusionCuller(const OcclusionCullingSettings& settings, ThreadPool* threadPool)
+    : m_settings(settings)
+    , m_threadPool(threadPool)
+{
+  m_settings.width  = std::max(4u, (m_settings.width + 3) / 4 * 4);
+  m_settings.height = std::max(1u, m_settings.height);
+  m_settings.nBands = std::clamp(m_settings.nBands, 1u, m_settings.height);
+  m_depthBuffer.resize(m_settings.width * m_settings.height, 1.0f);
+
+  ui32v2 size = ui32v2(m_settings.width, m_settings.height);
+  while (true)
+  {
+    m_hiZSizes.push_back(size);
+    m_hiZ.emplace_back(size.x * size.y, 1.0f);
+    if (size.x == 1 && size.y == 1)
+    {
+      break;
+    }
+    size = ui32v2((size.x + 1) / 2, (size.y + 1) / 2);
+  }
+}
+
+void OcclusionCuller::setOccluders(std::vector<Occluder> occluders)
+{
+  m_occluders = std::move(occluders);
+}
+
+OcclusionCullingFrameStatistics OcclusionCuller::cull(const f32m4&                       viewProjection,
+                                                      const std::vector<OcclusionQuery>& queries,
+                                                      std::vector<ui8>&                  visible)
+{
+  GIMS_PROFILE_ZONE("Occlusion Culling");
+  OcclusionCullingFrameStatistics statistics;
+  statistics.nQueries = static_cast<ui32>(queries.size());
+
+  const auto start                     = Clock::now();
+  statistics.nOccluderTriangles        = renderOccluders(viewProjection);
+  const auto rasterized                = Clock::now();
+  buildHiZ();
+  const auto hiZBuilt                  = Clock::now();
+
+  visible.resize(queries.size());
+  for (size_t i = 0; i < queries.size(); i++)
+  {
+    visible[i] = isVisible(queries[i], viewProjection) ? 1 : 0;
+    statistics.nOccluded += 1 - visible[i];
+  }
+  const auto tested = Clock::now();
+
+  statistics.rasterizationMilliseconds = getMilliseconds(start, rasterized);
+  statistics.hiZMilliseconds           = getMilliseconds(rasterized, hiZBuilt);
+  statistics.testMilliseconds          = getMilliseconds(hiZBuilt, tested);
+  return statistics;
+}
+
+ui32 OcclusionCuller::renderOccluders(const f32m4& viewProjection)
+{
+  GIMS_PROFILE_ZONE("Render Occluders");
+  std::fill(m_depthBuffer.begin(), m_depthBuffer.end(), 1.0f);
+  m_triangles.clear();
+
+  std::vector<f32v4> clipSpacePositions;
+  for (const auto& occluder : m_occluders)
+  {
+    const f32m4 modelViewProjection = viewProjection * occluder.transformation;
+    clipSpacePositions.resize(occluder.positions.size());
+    for (size_t i = 0; i < occluder.positions.size(); i++)
+    {
+      clipSpacePositions[i] = modelViewProjection * f32v4(occluder.positions[i], 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+    {
+      const f32v4 c[3] = {clipSpacePositions[occluder.indices[i]], clipSpacePositions[occluder.indices[i + 1]],
+                          clipSpacePositions[occluder.indices[i + 2]]};
+
+      // Clip against the near plane z = 0, which yields at most a quad.
+      f32v4 polygon[4];
+      ui32  nPolygonVertices = 0;
+      for (ui32 j = 0; j < 3; j++)
+      {
+        const f32v4& a = c[j];
+        const f32v4& b = c[(j + 1) % 3];
+        if (a.z >= 0.0f)
+        {
+          polygon[nPolygonVertices++] = a;
+        }
+        if ((a.z >= 0.0f) != (b.z >= 0.0f))
+        {
+          polygon[nPolygonVertices++] = intersectNearPlane(a, b);
+        }
+      }
+      for (ui32 j = 2; j < nPolygonVertices; j++)
+      {
+        setupTriangle(polygon[0], polygon[j - 1], polygon[j]);
+      }
+    }
+  }
+
+  if (m_threadPool)
+  {
+    m_threadPool->parallelFor(m_settings.nBands, [this](ui32 bandIdx) { rasterizeBand(bandIdx); });
+  }
+  else
+  {
+    for (ui32 bandIdx = 0; bandIdx < m_settings.nBands; bandIdx++)
+    {
+      rasterizeBand(bandIdx);
+    }
+  }
+  return static_cast<ui32>(m_triangles.size());
+}
+
+void OcclusionCuller::setupTriangle(const f32v4& c0, const f32v4& c1, const f32v4& c2)
+{
+  // Viewport transformation, y points down.
+  const f32 w    = static_cast<f32>(m_settings.width);
+  const f32 h    = static_cast<f32>(m_settings.height);
+  f32v3     v[3] = {f32v3(c0) / c0.w, f32v3(c1) / c1.w, f32v3(c2) / c2.w};
+  for (auto& p : v)
+  {
+    p.x = (p.x * 0.5f + 0.5f) * w;
+    p.y = (0.5f - p.y * 0.5f) * h;
+  }
+
+  f32 area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+  if (std::abs(area) < 1e-8f)
+  {
+    return;
+  }
+  // Both sides are rasterized, the edge functions are made positive inside.
+  if (area < 0.0f)
+  {
+    std::swap(v[1], v[2]);
+    area = -area;
+  }
+
+  ScreenTriangle triangle;
+  triangle.minX = std::max(0, static_cast<i32>(std::floor(std::min({v[0].x, v[1].x, v[2].x}))));
+  triangle.maxX = std::min(static_cast<i32>(m_settings.width) - 1,
+                           static_cast<i32>(std::ceil(std::max({v[0].x, v[1].x, v[2].x}))));
+  triangle.minY = std::max(0, static_cast<i32>(std::floor(std::min({v[0].y, v[1].y, v[2].y}))));
+  triangle.maxY = std::min(static_cast<i32>(m_settings.height) - 1,
+                           static_cast<i32>(std::ceil(std::max({v[0].y, v[1].y, v[2].y}))));
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+  {
+    return;
+  }
+
+  // Edge function k is opposite to vertex k and positive on the side of vertex k.
+  for (i32 k = 0; k < 3; k++)
+  {
+    const f32v3& a    = v[(k + 1) % 3];
+    const f32v3& b    = v[(k + 2) % 3];
+    triangle.edgeA[k] = a.y - b.y;
+    triangle.edgeB[k] = b.x - a.x;
+    triangle.edgeC[k] = a.x * b.y - a.y * b.x;
+  }
+
+  // Depth is linear in screen space: z = sum_k z_k * e_k(x, y) / area.
+  const f32v3 z       = f32v3(v[0].z, v[1].z, v[2].z) / area;
+  triangle.depthPlane = f32v3(glm::dot(z, triangle.edgeA), glm::dot(z, triangle.edgeB), glm::dot(z, triangle.edgeC));
+  m_triangles.push_back(triangle);
+}
+
+void OcclusionCuller::rasterizeBand(ui32 bandIdx)
+{
+  GIMS_PROFILE_ZONE("Rasterize Band");
+  const i32 bandHeight = static_cast<i32>((m_settings.height + m_settings.nBands - 1) / m_settings.nBands);
+  const i32 bandMinY   = static_cast<i32>(bandIdx) * bandHeight;
+  const i32 bandMaxY   = std::min(bandMinY + bandHeight, static_cast<i32>(m_settings.height)) - 1;
+  const i32 width      = static_cast<i32>(m_settings.width);
+
+  for (const auto& t : m_triangles)
+  {
+    const i32 minY = std::max(t.minY, bandMinY);
+    const i32 maxY = std::min(t.maxY, bandMaxY);
+    const i32 minX = t.minX & ~3;
+    for (i32 y = minY; y <= maxY; y++)
+    {
+      f32* const row = m_depthBuffer.data() + y * width;
+      const f32  py  = static_cast<f32>(y) + 0.5f;
+#ifdef GIMS_OCCLUSION_CULLING_SSE2
+      if (m_settings.useSimd)
+      {
+        const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        for (i32 x = minX; x <= t.maxX; x += 4)
+        {
+          const __m128 px   = _mm_add_ps(_mm_set1_ps(static_cast<f32>(x)), pixelOffsets);
+          __m128       mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+          for (i32 k = 0; k < 3; k++)
+          {
+            const __m128 e = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(t.edgeA[k])),
+                                        _mm_set1_ps(t.edgeB[k] * py + t.edgeC[k]));
+            mask           = _mm_and_ps(mask, _mm_cmpge_ps(e, _mm_setzero_ps()));
+          }
+          if (_mm_movemask_ps(mask) == 0)
+          {
+            continue;
+          }
+          const __m128 depth    = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(t.depthPlane.x)),
+                                             _mm_set1_ps(t.depthPlane.y * py + t.depthPlane.z));
+          const __m128 oldDepth = _mm_loadu_ps(row + x);
+          const __m128 newDepth = _mm_min_ps(oldDepth, depth);
+          _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, newDepth), _mm_andnot_ps(mask, oldDepth)));
+        }
+        continue;
+      }
+#endif
+      // The same edge functions and depth plane as the SSE2 path, evaluated in the same order.
+      for (i32 x = minX; x <= t.maxX; x++)
+      {
+        const f32 px = static_cast<f32>(x) + 0.5f;
+        if (t.edgeA[0] * px + (t.edgeB[0] * py + t.edgeC[0]) >= 0.0f &&
+            t.edgeA[1] * px + (t.edgeB[1] * py + t.edgeC[1]) >= 0.0f &&
+            t.edgeA[2] * px + (t.edgeB[2] * py + t.edgeC[2]) >= 0.0f)
+        {
+          const f32 depth = t.depthPlane.x * px + (t.depthPlane.y * py + t.depthPlane.z);
+          row[x]          = std::min(row[x], depth);
+        }
+      }
+    }
+  }
+}
+
+void OcclusionCuller::buildHiZ()
+{
+  GIMS_PROFILE_ZONE("Build Hi-Z");
+  m_hiZ[0] = m_depthBuffer;
+  for (size_t level = 1; level < m_hiZ.size(); level++)
+  {
+    const ui32v2            srcSize = m_hiZSizes[level - 1];
+    const ui32v2            dstSize = m_hiZSizes[level];
+    const std::vector<f32>& src     = m_hiZ[level - 1];
+    std::vector<f32>&       dst     = m_hiZ[level];
+    for (ui32 y = 0; y < dstSize.y; y++)
+    {
+      const ui32 y0 = 2 * y;
+      const ui32 y1 = std::min(2 * y + 1, srcSize.y - 1);
+      for (ui32 x = 0; x < dstSize.x; x++)
+      {
+        const ui32 x0          = 2 * x;
+        const ui32 x1          = std::min(2 * x + 1, srcSize.x - 1);
+        dst[y * dstSize.x + x] = std::max({src[y0 * srcSize.x + x0], src[y0 * srcSize.x + x1],
+                                           src[y1 * srcSize.x + x0], src[y1 * srcSize.x + x1]});
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::isVisible(const OcclusionQuery& query, const f32m4& viewProjection) const
+{
+  const f32v3& l = query.lowerLeftBottom;
+  const f32v3& u = query.upperRightTop;
+
+  f32v2 screenMin = f32v2(std::numeric_limits<f32>::max());
+  f32v2 screenMax = f32v2(-std::numeric_limits<f32>::max());
+  f32   minDepth  = std::numeric_limits<f32>::max();
+  for (ui32 i = 0; i < 8; i++)
+  {
+    const f32v4 c = viewProjection * f32v4(i & 1 ? u.x : l.x, i & 2 ? u.y : l.y, i & 4 ? u.z : l.z, 1.0f);
+    if (c.z < 0.0f || c.w <= 0.0f)
+    {
+      // The box reaches in front of the near plane.
+      return true;
+    }
+    const f32v3 ndc = f32v3(c) / c.w;
+    const f32v2 p   = f32v2((ndc.x * 0.5f + 0.5f) * m_settings.width, (0.5f - ndc.y * 0.5f) * m_settings.height);
+    screenMin       = glm::min(screenMin, p);
+    screenMax       = glm::max(screenMax, p);
+    minDepth        = std::min(minDepth, ndc.z);
+  }
+
+  // Boxes outside of the screen are up to frustum culling. Boxes that are partly outside are kept as well, since the
+  // depth buffer says nothing about the part beyond its border.
+  const f32 width  = static_cast<f32>(m_settings.width);
+  const f32 height = static_cast<f32>(m_settings.height);
+  if (screenMin.x < 0.0f || screenMin.y < 0.0f || screenMax.x > width || screenMax.y > height)
+  {
+    return true;
+  }
+  const i32 x0 = static_cast<i32>(std::floor(screenMin.x));
+  const i32 y0 = static_cast<i32>(std::floor(screenMin.y));
+  const i32 x1 = std::min(static_cast<i32>(m_settings.width) - 1, static_cast<i32>(std::floor(screenMax.x)));
+  const i32 y1 = std::min(static_cast<i32>(m_settings.height) - 1, static_cast<i32>(std::floor(screenMax.y)));
+
+  // Pick the level at which the rectangle covers at most 4x4 texels.
+  ui32 level = 0;
+  while (level + 1 < m_hiZ.size() && ((x1 >> level) - (x0 >> level) >= 4 || (y1 >> level) - (y0 >> level) >= 4))
+  {
+    level++;
+  }
+
+  f32 maxDepth = 0.0f;
+  for (i32 y = y0 >> level; y <= (y1 >> level); y++)
+  {
+    for (i32 x = x0 >> level; x <= (x1 >> level); x++)
+    {
+      maxDepth = std::max(maxDepth, getHiZDepth(level, x, y));
+    }
+  }
+  return minDepth <= maxDepth;
+}
+
+const std::vector<f32>& OcclusionCuller::getDepthBuffer() const
+{
+  return m_depthBuffer;
+}
+
+ui32 OcclusionCuller::getNumberOfHiZLevels() const
+{
+  return static_cast<ui32>(m_hiZ.size());
+}
+
+f32 OcclusionCuller::getHiZDepth(ui32 level, ui32 x, ui32 y) const
+{
+  return m_hiZ[level][y * m_hiZSizes[level].x + x];
+}
+
+ui32 OcclusionCuller::getWidth() const
+{
+  return m_settings.width;
+}
+
+ui32 OcclusionCuller::getHeight() const
+{
+  return m_settings.height;
+}
+
+std::vector<Occluder> selectOccluders(const std::vector<StaticMeshData>& meshes,
+                                      const std::vector<InstanceBatch>&  batches,
+                                      const std::vector<f32m4>&          instanceTransformations,
+                                      const OcclusionCullingSettings&    settings)
+{
+  struct Candidate
+  {
+    f32  surfaceArea;
+    ui32 meshIdx;
+    ui32 instanceIdx;
+  };
+  std::vector<Candidate> candidates;
+  for (const auto& batch : batches)
+  {
+    const StaticMeshData& mesh = meshes[batch.meshIdx];
+    if (mesh.indices.size() / 3 > settings.maxTrianglesPerOccluder || mesh.vertices.empty())
+    {
+      continue;
+    }
+    std::vector<f32v3> positions(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+      positions[i] = mesh.vertices[i].position;
+    }
+    const AABB meshAABB(positions.data(), static_cast<ui32>(positions.size()));
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      const ui32 instanceIdx = batch.firstInstance + i;
+      candidates.push_back(
+          {getSurfaceArea(transformAABB(meshAABB, instanceTransformations[instanceIdx])), batch.meshIdx, instanceIdx});
+    }
+  }
+
+  const size_t nOccluders = std::min<size_t>(candidates.size(), settings.maxNumberOfOccluders);
+  std::partial_sort(candidates.begin(), candidates.begin() + nOccluders, candidates.end(),
+                    [](const Candidate& a, const Candidate& b) { return a.surfaceArea > b.surfaceArea; });
+
+  std::vector<Occluder> occluders(nOccluders);
+  for (size_t i = 0; i < nOccluders; i++)
+  {
+    const StaticMeshData& mesh = meshes[candidates[i].meshIdx];
+    occluders[i].positions.resize(mesh.vertices.size());
+    for (size_t j = 0; j < mesh.vertices.size(); j++)
+    {
+      occluders[i].positions[j] = mesh.vertices[j].position;
+    }
+    occluders[i].indices        = mesh.indices;
+    occluders[i].transformation = instanceTransformations[candidates[i].instanceIdx];
+  }
+  return occluders;
+}
+
+std::vector<OcclusionQuery> createOcclusionQueries(const std::vector<AABB>&          meshAABBs,
+                                                   const std::vector<InstanceBatch>& batches,
+                                                   const std::vector<f32m4>&         instanceTransformations)
+{
+  std::vector<OcclusionQuery> queries(instanceTransformations.size());
+  for (const auto& batch : batches)
+  {
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      const ui32 instanceIdx = batch.firstInstance + i;
+      const AABB aabb        = transformAABB(meshAABBs[batch.meshIdx], instanceTransformations[instanceIdx]);
+      queries[instanceIdx].lowerLeftBottom = aabb.getLowerLeftBottom();
+      queries[instanceIdx].upperRightTop   = aabb.getUpperRightTop();
+    }
+  }
+  return queries;
+}
+
+OcclusionCullingReport evaluateOcclusionCulling(OcclusionCuller& culler, const std::vector<f32m4>& viewProjections,
+                                                const std::vector<OcclusionQuery>& queries)
+{
+  OcclusionCullingReport report;
+  std::vector<ui8>       visible;
+  ui64                   nTested           = 0;
+  ui64                   nOccluded         = 0;
+  f64                    totalMilliseconds = 0.0;
+  for (const auto& viewProjection : viewProjections)
+  {
+    const auto statistics   = culler.cull(viewProjection, queries, visible);
+    const f64  milliseconds = statistics.getTotalMilliseconds();
+    totalMilliseconds += milliseconds;
+    report.maxMillisecondsPerFrame = std::max(report.maxMillisecondsPerFrame, milliseconds);
+    nTested += statistics.nQueries;
+    nOccluded += statistics.nOccluded;
+  }
+  report.nFrames = static_cast<ui32>(viewProjections.size());
+  if (report.nFrames > 0)
+  {
+    report.averageMillisecondsPerFrame = totalMilliseconds / report.nFrames;
+  }
+  if (nTested > 0)
+  {
+    report.rejectedFraction = static_cast<f64>(nOccluded) / static_cast<f64>(nTested);
+  }
+  return report;
+}
+
+void printOcclusionCullingReport(std::ostream& stream, const OcclusionCullingReport& report)
+{
+  stream << "Occlusion Culling Information:\n"
+         << "------------------------------\n"
+         << "Number of Frames: " << report.nFrames << "\n"
+         << "Average Time per Frame: " << report.averageMillisecondsPerFrame << " ms\n"
+         << "Max. Time per Frame: " << report.maxMillisecondsPerFrame << " ms\n"
+         << "Rejected Draws: " << report.rejectedFraction * 100.0 << " %" << std::endl;
+}
+} // namespace gims
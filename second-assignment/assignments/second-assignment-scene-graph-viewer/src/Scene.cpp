@@ -1,14 +1,18 @@
 #include "Scene.hpp"
 #include <d3dx12/d3dx12.h>
+#include <gimslib/sys/Profiler.hpp>
 #include <unordered_map>
 
 using namespace gims;
 
+static_assert(sizeof(Scene::MaterialConstantBuffer) == 64, "Material table stride must match the HLSL struct.");
+static_assert(sizeof(f32m4) == 64, "Instance table stride must match float4x4 in HLSL.");
+
 namespace
 {
 void addToCommandListImpl(Scene& scene, ui32 nodeIdx, f32m4 transformation,
                           const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 modelViewRootParameterIdx,
-                          ui32 materialConstantsRootParameterIdx, ui32 srvRootParameterIdx, ui32 pipelineState)
+                          ui32 srvRootParameterIdx, ui32 pipelineState)
 {
 
   if (nodeIdx >= scene.getNumberOfNodes())
@@ -23,11 +27,8 @@ void addToCommandListImpl(Scene& scene, ui32 nodeIdx, f32m4 transformation,
   for (ui32 i = 0; i < currentNode.meshIndices.size(); i++)
   {
     commandList->SetGraphicsRoot32BitConstants(modelViewRootParameterIdx, 16, &accumulatedTransformation, 0);
-    commandList->SetGraphicsRootConstantBufferView(
-        materialConstantsRootParameterIdx,
-        scene.getMaterial(scene.getMesh(currentNode.meshIndices[i]).getMaterialIndex())
-                                 .materialConstantBuffer.getResource()
-                                 ->GetGPUVirtualAddress());
+    commandList->SetGraphicsRoot32BitConstant(
+        modelViewRootParameterIdx, scene.getMesh(currentNode.meshIndices[i]).getMaterialIndex(), 16);
 
     commandList->SetDescriptorHeaps(1, scene.getMaterial(scene.getMesh(currentNode.meshIndices[i]).getMaterialIndex()).srvDescriptorHeap.GetAddressOf());
     commandList->SetGraphicsRootDescriptorTable(
@@ -47,7 +48,7 @@ void addToCommandListImpl(Scene& scene, ui32 nodeIdx, f32m4 transformation,
   for (const ui32& nodeIndex : currentNode.childIndices)
   {
     addToCommandListImpl(scene, nodeIndex, accumulatedTransformation, commandList, modelViewRootParameterIdx,
-                         materialConstantsRootParameterIdx, srvRootParameterIdx, pipelineState);
+                         srvRootParameterIdx, pipelineState);
   }
 
   // Assignemt 6
@@ -74,7 +75,7 @@ const ui32 Scene::getNumberOfNodes() const
   return static_cast<ui32>(m_nodes.size());
 }
 
-const ui32 Scene::getNumberOfMeshesAvailable()
+const ui32 Scene::getNumberOfMeshesAvailable() const
 {
   return static_cast<ui32>(m_meshes.size());
 }
@@ -99,16 +100,151 @@ const Scene::Material& Scene::getMaterial(ui32 materialIdx) const
   return m_materials[materialIdx];
 }
 
+const Scene::MaterialConstantBuffer& Scene::getMaterialConstants(ui32 materialIdx) const
+{
+  return m_materialConstants[materialIdx];
+}
+
+void Scene::updateMaterialConstants(ui32 materialIdx, const MaterialConstantBuffer& materialConstants)
+{
+  m_materialConstants[materialIdx] = materialConstants;
+  m_materialTable.updateElement(materialIdx, &m_materialConstants[materialIdx]);
+}
+
+void Scene::addMaterialTableUpdatesToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 frameIdx)
+{
+  m_materialTable.addUpdatesToCommandList(commandList, frameIdx);
+}
+
+void Scene::setMaterialPipelineState(ui32 materialIdx, const ComPtr<ID3D12PipelineState>& pipelineState)
+{
+  m_materials.at(materialIdx).pipelineState = pipelineState;
+}
+
+const ui32 Scene::getNumberOfDrawCalls() const
+{
+  return static_cast<ui32>(m_instanceBatches.size());
+}
+
+const ui32 Scene::getNumberOfDrawCallsWithoutInstancing() const
+{
+  return m_nDrawCallsWithoutInstancing;
+}
+
+const std::vector<InstanceBatch>& Scene::getInstanceBatches() const
+{
+  return m_instanceBatches;
+}
+
+const std::vector<f32m4>& Scene::getInstanceTransformations() const
+{
+  return m_instanceTransformations;
+}
+
+const StructuredBufferD3D12& Scene::getInstanceTable() const
+{
+  return m_instanceTable;
+}
+
+const StructuredBufferD3D12& Scene::getMaterialTable() const
+{
+  return m_materialTable;
+}
+
 const AABB& Scene::getAABB() const
 {
   return m_aabb;
 }
 
 void Scene::addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const f32m4 transformation,
-                             ui32 modelViewRootParameterIdx, ui32 materialConstantsRootParameterIdx,
-                             ui32 srvRootParameterIdx, ui32 pipelineState)
+                             ui32 modelViewRootParameterIdx, ui32 materialTableRootParameterIdx,
+                             ui32 instanceTableRootParameterIdx, ui32 srvRootParameterIdx, ui32 pipelineState,
+                             const ComPtr<ID3D12PipelineState>& defaultPipelineState,
+                             const std::vector<ui8>*            instanceVisibility)
+{
+  // The material table is bound once, each draw call only selects its entry by a root constant.
+  commandList->SetGraphicsRootShaderResourceView(materialTableRootParameterIdx,
+                                                 m_materialTable.getResource()->GetGPUVirtualAddress());
+
+  // The bounding boxes are drawn by the mesh shader, which needs the full model view matrix per mesh occurrence.
+  if (pipelineState == 1)
+  {
+    addToCommandListImpl(*this, 0, transformation, commandList, modelViewRootParameterIdx, srvRootParameterIdx,
+                         pipelineState);
+    return;
+  }
+
+  addInstanceBatchesToCommandList(commandList, transformation, modelViewRootParameterIdx, materialTableRootParameterIdx,
+                                  instanceTableRootParameterIdx, srvRootParameterIdx,
+                                  {0, static_cast<ui32>(m_instanceBatches.size())}, defaultPipelineState,
+                                  instanceVisibility);
+}
+
+void Scene::addInstanceBatchesToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList,
+                                            const f32m4 transformation, ui32 modelViewRootParameterIdx,
+                                            ui32 materialTableRootParameterIdx, ui32 instanceTableRootParameterIdx,
+                                            ui32 srvRootParameterIdx, ItemRange instanceBatches,
+                                            const ComPtr<ID3D12PipelineState>& defaultPipelineState,
+                                            const std::vector<ui8>*            instanceVisibility)
 {
-  addToCommandListImpl(*this, 0, transformation, commandList, modelViewRootParameterIdx,
-                       materialConstantsRootParameterIdx, srvRootParameterIdx, pipelineState);
+  if (instanceBatches.begin >= instanceBatches.end)
+  {
+    return;
+  }
+  GIMS_PROFILE_ZONE("Record Instance Batches");
+
+  // All occurrences of a mesh are drawn with one call. The vertex shader combines the view matrix from the root
+  // constants with the instance transformation at (first instance + SV_InstanceID).
+  commandList->SetGraphicsRootShaderResourceView(materialTableRootParameterIdx,
+                                                 m_materialTable.getResource()->GetGPUVirtualAddress());
+  commandList->SetGraphicsRootShaderResourceView(instanceTableRootParameterIdx,
+                                                 m_instanceTable.getResource()->GetGPUVirtualAddress());
+  commandList->SetGraphicsRoot32BitConstants(modelViewRootParameterIdx, 16, &transformation, 0);
+  // D3D12 cannot tell which pipeline is set, so the one of the caller is passed in to switch back to it after a
+  // material with its own pipeline.
+  ID3D12PipelineState* currentPipelineState = defaultPipelineState.Get();
+  const ui32           pipelineState        = 0;
+  for (ui32 batchIdx = instanceBatches.begin; batchIdx < instanceBatches.end; batchIdx++)
+  {
+    const InstanceBatch&     batch    = m_instanceBatches[batchIdx];
+    const TriangleMeshD3D12& mesh     = getMesh(batch.meshIdx);
+    const Material&          material = getMaterial(mesh.getMaterialIndex());
+    ID3D12PipelineState*     materialPipelineState =
+        material.pipelineState != nullptr ? material.pipelineState.Get() : defaultPipelineState.Get();
+    if (materialPipelineState != currentPipelineState)
+    {
+      currentPipelineState = materialPipelineState;
+      commandList->SetPipelineState(currentPipelineState);
+    }
+    commandList->SetGraphicsRoot32BitConstant(modelViewRootParameterIdx, mesh.getMaterialIndex(), 16);
+    commandList->SetDescriptorHeaps(1, material.srvDescriptorHeap.GetAddressOf());
+    commandList->SetGraphicsRootDescriptorTable(srvRootParameterIdx,
+                                                material.srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    if (instanceVisibility == nullptr)
+    {
+      commandList->SetGraphicsRoot32BitConstant(modelViewRootParameterIdx, batch.firstInstance, 17);
+      mesh.addToCommandList(commandList, pipelineState, batch.nInstances);
+      continue;
+    }
+
+    // Occluded instances split the batch into runs of consecutive visible instances, one instanced draw per run.
+    const ui32 endInstance = batch.firstInstance + batch.nInstances;
+    for (ui32 runStart = batch.firstInstance; runStart < endInstance;)
+    {
+      if ((*instanceVisibility)[runStart] == 0)
+      {
+        runStart++;
+        continue;
+      }
+      ui32 runEnd = runStart + 1;
+      while (runEnd < endInstance && (*instanceVisibility)[runEnd] != 0)
+      {
+        runEnd++;
+      }
+      commandList->SetGraphicsRoot32BitConstant(modelViewRootParameterIdx, runStart, 17);
+      mesh.addToCommandList(commandList, pipelineState, runEnd - runStart);
+      runStart = runEnd;
+    }
+  }
 }
 } // namespace gims
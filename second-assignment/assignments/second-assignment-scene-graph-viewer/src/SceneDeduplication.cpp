@@ -0,0 +1,309 @@
+#include "SceneDeduplication.hpp"
+#include <algorithm>
+#include <cstring>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace gims;
+
+namespace
+{
+template <typename T> bool haveEqualBytes(const T& a, const T& b)
+{
+  return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template <typename T> bool haveEqualBytes(const std::vector<T>& a, const std::vector<T>& b)
+{
+  return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// Returns how many items have each of the cheap keys, e.g., sizes, so only items that share theirs are hashed.
+std::unordered_map<ui64, ui32> countKeys(const std::vector<ui64>& keys)
+{
+  std::unordered_map<ui64, ui32> result;
+  for (const ui64 key : keys)
+  {
+    result[key]++;
+  }
+  return result;
+}
+
+// Bytes of a texture file or of a texture in memory. Files are only mapped if another texture has their size.
+struct TextureBytes
+{
+  const ui8* data;
+  size_t     size;
+  bool       isReadable;
+};
+
+void deduplicateTextures(ImportedScene& scene, const std::filesystem::path& parentPath,
+                         SceneDeduplicationReport& report)
+{
+  const size_t                       nFiles = scene.textureFileNameToTextureIndex.size();
+  std::vector<std::filesystem::path> relativePaths(nFiles);
+  for (const auto& [textureRelativePath, textureIdx] : scene.textureFileNameToTextureIndex)
+  {
+    relativePaths.at(textureIdx - 3) = textureRelativePath;
+  }
+
+  std::vector<TextureBytes> textures;
+  std::vector<ui64>         sizes;
+  for (const auto& textureRelativePath : relativePaths)
+  {
+    std::error_code errorCode;
+    const auto size = std::filesystem::file_size(findTextureContainerFile(parentPath / textureRelativePath), errorCode);
+    textures.push_back({nullptr, errorCode ? 0 : static_cast<size_t>(size), !errorCode});
+    sizes.push_back(textures.back().size);
+  }
+  for (const auto& texture : scene.textures)
+  {
+    textures.push_back({texture.data, texture.size, true});
+    sizes.push_back(texture.size);
+  }
+
+  const auto              sizeCounts = countKeys(sizes);
+  std::vector<MappedFile> files(nFiles);
+  std::vector<ui64>       keys(textures.size());
+  for (ui32 i = 0; i < textures.size(); i++)
+  {
+    TextureBytes& texture = textures[i];
+    Hasher        hasher;
+    hasher.addValue(static_cast<ui64>(texture.size));
+    if (texture.isReadable && sizeCounts.at(texture.size) > 1 && i < nFiles)
+    {
+      try
+      {
+        files[i]     = MappedFile(findTextureContainerFile(parentPath / relativePaths[i]));
+        texture.data = files[i].getData();
+      }
+      catch (const std::runtime_error&)
+      {
+        texture.isReadable = false;
+      }
+    }
+    if (texture.isReadable && sizeCounts.at(texture.size) > 1)
+    {
+      hasher.add(texture.data, texture.size);
+    }
+    keys[i] = hasher.getValue();
+  }
+
+  const DeduplicationRemap remap =
+      createDeduplicationRemap(keys,
+                               [&](ui32 a, ui32 b)
+                               {
+                                 const TextureBytes& textureA = textures[a];
+                                 const TextureBytes& textureB = textures[b];
+                                 return textureA.isReadable && textureB.isReadable && textureA.size == textureB.size &&
+                                        (textureA.size == 0 ||
+                                         std::memcmp(textureA.data, textureB.data, textureA.size) == 0);
+                               });
+  report.nTextures          = static_cast<ui32>(textures.size());
+  report.nDuplicateTextures = static_cast<ui32>(textures.size() - remap.uniqueIndices.size());
+  for (ui32 i = 0; i < textures.size(); i++)
+  {
+    if (remap.uniqueIndices[remap.oldToNewIndex[i]] != i)
+    {
+      report.textureBytesSaved += textures[i].size;
+    }
+  }
+
+  // The first occurrences keep their order, so the remaining files still come before the textures in memory.
+  std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex;
+  std::vector<ImportedTexture>                    texturesInMemory;
+  for (ui32 newIdx = 0; newIdx < remap.uniqueIndices.size(); newIdx++)
+  {
+    const ui32 oldIdx = remap.uniqueIndices[newIdx];
+    if (oldIdx < nFiles)
+    {
+      textureFileNameToTextureIndex[relativePaths[oldIdx]] = newIdx + 3;
+    }
+    else
+    {
+      texturesInMemory.push_back(scene.textures[oldIdx - nFiles]);
+    }
+  }
+  scene.textureFileNameToTextureIndex = std::move(textureFileNameToTextureIndex);
+  scene.textures                      = std::move(texturesInMemory);
+  for (auto& material : scene.materials)
+  {
+    for (ui32& textureIdx : material.textureIndices)
+    {
+      // The default textures are never merged.
+      if (textureIdx >= 3)
+      {
+        textureIdx = remap.oldToNewIndex.at(textureIdx - 3) + 3;
+      }
+    }
+  }
+}
+
+void deduplicateMaterials(ImportedScene& scene, SceneDeduplicationReport& report)
+{
+  std::vector<ui64> keys;
+  for (const auto& material : scene.materials)
+  {
+    Hasher hasher;
+    hasher.addValue(material.emissive);
+    hasher.addValue(material.ambient);
+    hasher.addValue(material.diffuse);
+    hasher.addValue(material.specularColorAndExponent);
+    hasher.addValue(material.textureIndices);
+    hasher.addValue(material.textureMask);
+    keys.push_back(hasher.getValue());
+  }
+
+  // Compared member by member, since the padding of ImportedMaterial is undefined.
+  const DeduplicationRemap remap =
+      createDeduplicationRemap(keys,
+                               [&](ui32 a, ui32 b)
+                               {
+                                 const ImportedMaterial& materialA = scene.materials[a];
+                                 const ImportedMaterial& materialB = scene.materials[b];
+                                 return haveEqualBytes(materialA.emissive, materialB.emissive) &&
+                                        haveEqualBytes(materialA.ambient, materialB.ambient) &&
+                                        haveEqualBytes(materialA.diffuse, materialB.diffuse) &&
+                                        haveEqualBytes(materialA.specularColorAndExponent,
+                                                       materialB.specularColorAndExponent) &&
+                                        materialA.textureIndices == materialB.textureIndices &&
+                                        materialA.textureMask == materialB.textureMask;
+                               });
+  report.nMaterials          = static_cast<ui32>(scene.materials.size());
+  report.nDuplicateMaterials = static_cast<ui32>(scene.materials.size() - remap.uniqueIndices.size());
+  report.materialBytesSaved  = static_cast<ui64>(report.nDuplicateMaterials) * sizeof(ImportedMaterial);
+
+  std::vector<ImportedMaterial> materials;
+  materials.reserve(remap.uniqueIndices.size());
+  for (const ui32 oldIdx : remap.uniqueIndices)
+  {
+    materials.push_back(scene.materials[oldIdx]);
+  }
+  scene.materials = std::move(materials);
+  for (auto& mesh : scene.meshes)
+  {
+    mesh.materialIdx = remap.oldToNewIndex.at(mesh.materialIdx);
+  }
+}
+
+void deduplicateMeshes(ImportedScene& scene, SceneDeduplicationReport& report)
+{
+  std::vector<ui64> shapeKeys;
+  for (const auto& mesh : scene.meshes)
+  {
+    Hasher hasher;
+    hasher.addValue(mesh.materialIdx);
+    hasher.addValue(static_cast<ui64>(mesh.vertices.size()));
+    hasher.addValue(static_cast<ui64>(mesh.indices.size()));
+    shapeKeys.push_back(hasher.getValue());
+  }
+
+  // Only meshes with the same material and numbers of vertices and indices as another one are hashed.
+  const auto        shapeCounts = countKeys(shapeKeys);
+  std::vector<ui64> keys        = shapeKeys;
+  for (ui32 i = 0; i < scene.meshes.size(); i++)
+  {
+    if (shapeCounts.at(shapeKeys[i]) > 1)
+    {
+      Hasher hasher;
+      hasher.addValue(shapeKeys[i]);
+      hasher.add(scene.meshes[i].vertices.data(), scene.meshes[i].vertices.size() * sizeof(Vertex));
+      hasher.add(scene.meshes[i].indices.data(), scene.meshes[i].indices.size() * sizeof(ui32));
+      keys[i] = hasher.getValue();
+    }
+  }
+
+  const DeduplicationRemap remap =
+      createDeduplicationRemap(keys,
+                               [&](ui32 a, ui32 b)
+                               {
+                                 const ImportedMesh& meshA = scene.meshes[a];
+                                 const ImportedMesh& meshB = scene.meshes[b];
+                                 return meshA.materialIdx == meshB.materialIdx &&
+                                        haveEqualBytes(meshA.vertices, meshB.vertices) &&
+                                        haveEqualBytes(meshA.indices, meshB.indices);
+                               });
+  report.nMeshes          = static_cast<ui32>(scene.meshes.size());
+  report.nDuplicateMeshes = static_cast<ui32>(scene.meshes.size() - remap.uniqueIndices.size());
+  for (ui32 i = 0; i < scene.meshes.size(); i++)
+  {
+    if (remap.uniqueIndices[remap.oldToNewIndex[i]] != i)
+    {
+      report.meshBytesSaved +=
+          scene.meshes[i].vertices.size() * sizeof(Vertex) + scene.meshes[i].indices.size() * sizeof(ui32);
+    }
+  }
+
+  std::vector<ImportedMesh> meshes;
+  meshes.reserve(remap.uniqueIndices.size());
+  for (const ui32 oldIdx : remap.uniqueIndices)
+  {
+    meshes.push_back(std::move(scene.meshes[oldIdx]));
+  }
+  scene.meshes = std::move(meshes);
+  for (auto& node : scene.nodes)
+  {
+    for (ui32& meshIdx : node.meshIndices)
+    {
+      meshIdx = remap.oldToNewIndex.at(meshIdx);
+    }
+  }
+}
+} // namespace
+
+namespace gims
+{
+DeduplicationRemap createDeduplicationRemap(const std::vector<ui64>&               keys,
+                                            const std::function<bool(ui32, ui32)>& isEqual)
+{
+  DeduplicationRemap result;
+  result.oldToNewIndex.resize(keys.size());
+  // New indices of the items kept so far, by their keys.
+  std::unordered_map<ui64, std::vector<ui32>> keyToNewIndices;
+  for (ui32 oldIdx = 0; oldIdx < keys.size(); oldIdx++)
+  {
+    std::vector<ui32>& candidates = keyToNewIndices[keys[oldIdx]];
+    const auto         match      = std::find_if(candidates.begin(), candidates.end(), [&](ui32 newIdx)
+                                                 { return isEqual(result.uniqueIndices[newIdx], oldIdx); });
+    if (match != candidates.end())
+    {
+      result.oldToNewIndex[oldIdx] = *match;
+      continue;
+    }
+    const ui32 newIdx            = static_cast<ui32>(result.uniqueIndices.size());
+    result.oldToNewIndex[oldIdx] = newIdx;
+    result.uniqueIndices.push_back(oldIdx);
+    candidates.push_back(newIdx);
+  }
+  return result;
+}
+
+SceneDeduplicationReport deduplicateScene(ImportedScene& scene, const std::filesystem::path& parentPath)
+{
+  GIMS_PROFILE_ZONE("Deduplicate Scene");
+  // Merging textures can make materials equal, and merging materials can make meshes equal.
+  SceneDeduplicationReport report;
+  deduplicateTextures(scene, parentPath, report);
+  deduplicateMaterials(scene, report);
+  deduplicateMeshes(scene, report);
+  return report;
+}
+
+void printSceneDeduplicationReport(std::ostream& stream, const SceneDeduplicationReport& report)
+{
+  stream << "Deduplication Information:\n"
+         << "--------------------------\n"
+         << "Duplicate Textures: " << report.nDuplicateTextures << " of " << report.nTextures << ", "
+         << report.textureBytesSaved << " bytes\n"
+         << "Duplicate Materials: " << report.nDuplicateMaterials << " of " << report.nMaterials << ", "
+         << report.materialBytesSaved << " bytes\n"
+         << "Duplicate Meshes: " << report.nDuplicateMeshes << " of " << report.nMeshes << ", "
+         << report.meshBytesSaved << " bytes\n"
+         << "Bytes Saved: " << report.textureBytesSaved + report.materialBytesSaved + report.meshBytesSaved
+         << std::endl;
+}
+} // namespace gims
@@ -1,10 +1,20 @@
 #include "SceneFactory.hpp"
+#include "GltfImport.hpp"
+#include "SceneDeduplication.hpp"
+#include "SceneImport.hpp"
+#include "ScenePackage.hpp"
+#include "StaticBatching.hpp"
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <d3dx12/d3dx12.h>
+#include <gimslib/d3d/RenderGraphD3D12.hpp>
 #include <gimslib/d3d/UploadHelper.hpp>
 #include <gimslib/dbg/HrException.hpp>
+#include <gimslib/io/AsyncFileReader.hpp>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sys/Profiler.hpp>
 #include <iostream>
 using namespace gims;
 
@@ -51,94 +61,25 @@ void addTextureToDescriptorHeap(const ComPtr<ID3D12Device2>& device, aiTextureTy
   }
 }
 
-std::unordered_map<std::filesystem::path, ui32> textureFilenameToIndex(aiScene const* const inputScene)
-{
-  std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex;
-
-  ui32 textureIdx = 3;
-  for (ui32 mIdx = 0; mIdx < inputScene->mNumMaterials; mIdx++)
-  {
-    for (ui32 textureType = aiTextureType_NONE; textureType < aiTextureType_UNKNOWN; textureType++)
-    {
-      for (ui32 i = 0; i < inputScene->mMaterials[mIdx]->GetTextureCount((aiTextureType)textureType); i++)
-      {
-        aiString path;
-        inputScene->mMaterials[mIdx]->GetTexture((aiTextureType)textureType, i, &path);
-
-        const auto texturePathCstr = path.C_Str();
-        const auto textureIter     = textureFileNameToTextureIndex.find(texturePathCstr);
-        if (textureIter == textureFileNameToTextureIndex.end())
-        {
-          textureFileNameToTextureIndex.emplace(texturePathCstr, static_cast<ui32>(textureIdx));
-          textureIdx++;
-        }
-      }
-    }
-  }
-  return textureFileNameToTextureIndex;
-}
 /// <summary>
-/// Reads the color from the Asset Importer specific (pKey, type, idx) triple.
-/// Use the Asset Importer Macros AI_MATKEY_COLOR_AMBIENT, AI_MATKEY_COLOR_DIFFUSE, etc. which map to these arguments
-/// correctly.
-///
-/// If that key does not exist a null vector is returned.
+/// Computes the eight corner points of a bounding box in the order the bounding box compute shader writes them.
 /// </summary>
-/// <param name="pKey">Asset importer specific parameter</param>
-/// <param name="type"></param>
-/// <param name="idx"></param>
-/// <param name="material">The material from which we wish to extract the color.</param>
-/// <returns>Color or 0 vector if no color exists.</returns>
-f32v4 getColor(char const* const pKey, unsigned int type, unsigned int idx, aiMaterial const* const material)
+AABBPoints getAABBPoints(const AABB& aabb)
 {
-  aiColor3D color;
-  if (material->Get(pKey, type, idx, color) == aiReturn_SUCCESS)
-  {
-    return f32v4(color.r, color.g, color.b, 0.0f);
-  }
-  else
-  {
-    return f32v4(0.0f);
-  }
+  const f32v4 l = f32v4(aabb.getLowerLeftBottom(), 1.0f);
+  const f32v4 u = f32v4(aabb.getUpperRightTop(), 1.0f);
+
+  AABBPoints points   = {};
+  points.firstPoint   = l;
+  points.secondPoint  = f32v4(l.x, u.y, l.z, l.w);
+  points.thirdPoint   = f32v4(u.x, u.y, l.z, l.w);
+  points.fourthPoint  = f32v4(u.x, l.y, l.z, l.w);
+  points.fifthPoint   = f32v4(l.x, u.y, u.z, l.w);
+  points.sixthPoint   = u;
+  points.seventhPoint = f32v4(l.x, l.y, u.z, l.w);
+  points.eighthPoint  = f32v4(u.x, l.y, u.z, l.w);
+  return points;
 }
-
-
-i32 getTexture(aiTextureType textureType, unsigned int textureIndex, aiMaterial const* const material,
-              std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex)
-{
-  i32 defaultTextureIndexToReturn = 0;
-  aiString textureName("");
-  aiReturn textureRetrievingResult = material->GetTexture(textureType, textureIndex, &textureName);
-  if (textureRetrievingResult == aiReturn_FAILURE)
-  {
-    if (textureType == aiTextureType_AMBIENT)
-    {
-      defaultTextureIndexToReturn = 1;
-    }
-    else if (textureType == aiTextureType_DIFFUSE)
-    {
-      defaultTextureIndexToReturn = 1;
-    }
-    else if (textureType == aiTextureType_SPECULAR)
-    {
-      defaultTextureIndexToReturn = 0;
-    }
-    else if (textureType == aiTextureType_EMISSIVE)
-    {
-      defaultTextureIndexToReturn = 1;
-    }
-    else if (textureType == aiTextureType_HEIGHT)
-    {
-      defaultTextureIndexToReturn = 2;
-    }
-  }
-  else
-  {
-    defaultTextureIndexToReturn = textureFileNameToTextureIndex.find(textureName.C_Str())->second;
-  }
-  return defaultTextureIndexToReturn;
-}
-
 } // namespace
 
 
@@ -149,38 +90,33 @@ Scene SceneGraphFactory::createFromAssImpScene(const std::filesystem::path
                                                const ComPtr<ID3D12GraphicsCommandList6> commandList,
                                                const ComPtr<ID3D12Device2>&       device,
                                                const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                               const ComPtr<ID3D12CommandQueue>&        computeQueue,
                                                ComPtr<ID3D12Resource>&                   calculatedAABBPointsReadBack,
                                                ComPtr<ID3D12Resource>& inputAABB, ComPtr<ID3D12Resource>& calculatedAABBPoints)
 {
+  GIMS_PROFILE_ZONE("Load Scene");
   Scene outputScene;
 
-  const auto absolutePath = std::filesystem::weakly_canonical(pathToScene);
-  if (!std::filesystem::exists(absolutePath))
-  {
-    throw std::exception((absolutePath.string() + std::string(" does not exist.")).c_str());
-  }
-
-  const auto arguments = aiPostProcessSteps::aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                         aiProcess_GenUVCoords | aiProcess_ConvertToLeftHanded | aiProcess_OptimizeMeshes |
-                         aiProcess_RemoveRedundantMaterials | aiProcess_ImproveCacheLocality |
-                         aiProcess_FindInvalidData | aiProcess_FindDegenerates /*| aiProcess_FlipWindingOrder */ |
-                         aiProcess_CalcTangentSpace;
-
+  const auto       absolutePath = std::filesystem::weakly_canonical(pathToScene);
   Assimp::Importer imp;
-  imp.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
-  auto inputScene = imp.ReadFile(absolutePath.string(), arguments);
-  if (!inputScene)
+  const aiScene*   inputScene;
   {
-    throw std::exception((absolutePath.string() + std::string(" can't be loaded. with Assimp.")).c_str());
+    GIMS_PROFILE_ZONE("Import with Assimp");
+    inputScene = importAssimpScene(imp, absolutePath);
   }
   const auto textureFileNameToTextureIndex = textureFilenameToIndex(inputScene);
 
-  createMeshes(inputScene, commandList, device, commandQueue, calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints, outputScene);
+  createMeshes(inputScene, commandList, device, commandQueue, computeQueue, calculatedAABBPointsReadBack, inputAABB,
+               calculatedAABBPoints, outputScene);
 
-  createNodes(inputScene, outputScene, inputScene->mRootNode);
+  {
+    GIMS_PROFILE_ZONE("Create Nodes");
+    createNodes(inputScene, outputScene, inputScene->mRootNode);
+  }
+  createInstanceTable(device, outputScene);
 
   computeSceneAABB(outputScene, outputScene.m_aabb, 0, glm::identity<f32m4>());
-  createTextures(textureFileNameToTextureIndex, absolutePath.parent_path(), device, commandQueue, outputScene);
+  createTextures(textureFileNameToTextureIndex, {}, absolutePath.parent_path(), device, commandQueue, outputScene);
   createMaterials(inputScene, textureFileNameToTextureIndex, device, outputScene);
 
   //inputAABB->Release();
@@ -189,6 +125,69 @@ Scene SceneGraphFactory::createFromAssImpScene(const std::filesystem::path
 }
 
 
+Scene SceneGraphFactory::createFromFile(const std::filesystem::path              pathToScene,
+                                        const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                                        const ComPtr<ID3D12Device2>&             device,
+                                        const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                        const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                                        ComPtr<ID3D12Resource>&                  calculatedAABBPointsReadBack,
+                                        ComPtr<ID3D12Resource>& inputAABB, ComPtr<ID3D12Resource>& calculatedAABBPoints)
+{
+  if (isPackageFile(pathToScene))
+  {
+    GIMS_PROFILE_ZONE("Load Scene");
+    auto inputScene = importScenePackage(pathToScene);
+    printSceneDeduplicationReport(std::cout, deduplicateScene(inputScene, {}));
+    return createFromImportedScene(inputScene, {}, commandList, device, commandQueue, computeQueue,
+                                   calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints);
+  }
+  if (isGltfFile(pathToScene))
+  {
+    GIMS_PROFILE_ZONE("Load Scene");
+    const auto    absolutePath = std::filesystem::weakly_canonical(pathToScene);
+    ImportedScene inputScene;
+    try
+    {
+      inputScene = importGltfScene(absolutePath);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cout << e.what() << " Importing with Assimp instead." << std::endl;
+    }
+    if (!inputScene.nodes.empty())
+    {
+      printSceneDeduplicationReport(std::cout, deduplicateScene(inputScene, absolutePath.parent_path()));
+      return createFromImportedScene(inputScene, absolutePath.parent_path(), commandList, device, commandQueue,
+                                     computeQueue, calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints);
+    }
+  }
+  return createFromAssImpScene(pathToScene, commandList, device, commandQueue, computeQueue,
+                               calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints);
+}
+
+Scene SceneGraphFactory::createFromImportedScene(const ImportedScene&                     inputScene,
+                                                 const std::filesystem::path&             parentPath,
+                                                 const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                                                 const ComPtr<ID3D12Device2>&             device,
+                                                 const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                                 const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                                                 ComPtr<ID3D12Resource>& calculatedAABBPointsReadBack,
+                                                 ComPtr<ID3D12Resource>& inputAABB,
+                                                 ComPtr<ID3D12Resource>& calculatedAABBPoints)
+{
+  Scene outputScene;
+  createMeshes(inputScene, commandList, device, commandQueue, computeQueue, calculatedAABBPointsReadBack, inputAABB,
+               calculatedAABBPoints, outputScene);
+  outputScene.m_nodes = inputScene.nodes;
+  createInstanceTable(device, outputScene);
+  computeSceneAABB(outputScene, outputScene.m_aabb, 0, glm::identity<f32m4>());
+  createTextures(inputScene.textureFileNameToTextureIndex, inputScene.textures, parentPath, device, commandQueue,
+                 outputScene);
+  createMaterials(inputScene.materials, device, outputScene);
+  return outputScene;
+}
+
+
 void SceneGraphFactory::createSceneAABBs(Scene& scene, ComPtr<ID3D12Resource>& calculatedAABBPoints)
  {
   scene.m_sceneCalculatedAABBPoints.resize(scene.m_meshes.size());
@@ -205,15 +204,50 @@ void SceneGraphFactory::createSceneAABBs(Scene& scene, ComPtr<ID3D12Resource>& c
    //calculatedAABBPoints->Release();
  }
 
+void SceneGraphFactory::applyStaticBatching(Scene& scene, const ComPtr<ID3D12Device2>& device,
+                                            const ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+  GIMS_PROFILE_ZONE("Apply Static Batching");
+  std::vector<StaticMeshData> meshes(scene.m_meshes.size());
+  for (ui32 i = 0; i < scene.m_meshes.size(); i++)
+  {
+    meshes[i].vertices      = scene.m_meshes[i].getVertices();
+    meshes[i].indices       = scene.m_meshes[i].getIndices();
+    meshes[i].materialIndex = scene.m_meshes[i].getMaterialIndex();
+  }
+
+  const auto staticBatches = createStaticBatches(scene.m_nodes, meshes);
+  printStaticBatchingReport(std::cout, staticBatches);
+  std::cout << "Max. Static Batching Error: " << getMaxStaticBatchingError(staticBatches, meshes) << std::endl;
+
+  Scene::Node rootNode;
+  rootNode.transformation = glm::identity<f32m4>();
+  scene.m_meshes.clear();
+  scene.m_sceneCalculatedAABBPoints.clear();
+  for (const auto& batch : staticBatches.batches)
+  {
+    rootNode.meshIndices.push_back(static_cast<ui32>(scene.m_meshes.size()));
+    scene.m_meshes.emplace_back(batch.vertices.data(), static_cast<ui32>(batch.vertices.size()),
+                                batch.indices.data(), static_cast<ui32>(batch.indices.size()), batch.materialIndex,
+                                device, commandQueue);
+    scene.m_sceneCalculatedAABBPoints.push_back(getAABBPoints(batch.aabb));
+  }
+  scene.m_nodes = {rootNode};
+
+  createInstanceTable(device, scene);
+}
+
 void SceneGraphFactory::createMeshes(aiScene const* const                     inputScene,
                                      const ComPtr<ID3D12GraphicsCommandList6> commandList,
                                      const ComPtr<ID3D12Device2>&             device,
                                      const ComPtr<ID3D12CommandQueue>& commandQueue, 
+                                     const ComPtr<ID3D12CommandQueue>& computeQueue,
                                      ComPtr<ID3D12Resource>& calculatedAABBPointsReadBack,
                                      ComPtr<ID3D12Resource>& inputAABB,
                                      ComPtr<ID3D12Resource>& calculatedAABBPointsRead,
                                      Scene& outputScene)
 {
+  GIMS_PROFILE_ZONE("Create Meshes");
   // Assignment 3
   
   // Acquiring a pointer to the array of meshes available in the scene
@@ -226,10 +260,6 @@ void SceneGraphFactory::createMeshes(aiScene const* const                     in
   
 
 
-  std::vector<InputAABB> inputCPU;
-  inputCPU.resize(numberOfMeshesInTheScene);
-
-
   // Iterating over the meshes, creating a triangle mesh and adding it to the vector of meshes
   for (ui32 i = 0; i < numberOfMeshesInTheScene; i++)
   {
@@ -292,16 +322,54 @@ void SceneGraphFactory::createMeshes(aiScene const* const                     in
                                    (ui32)(indicesGroupdInFaces.size() * 3), materialIndex, device, commandQueue);
 
 
-      InputAABB inputData       = {};
-      inputData.lowerLeftBottom = glm::float4(triangleMeshToAdd.getAABB().getLowerLeftBottom(), 1.0f);
-      inputData.upperRightTop = glm::float4(triangleMeshToAdd.getAABB().getUpperRightTop(), 1.0f);
-      inputCPU.at(i) = inputData;
-  
-
    outputScene.m_meshes.at(i) = triangleMeshToAdd;
 
   }
 
+  computeMeshAABBs(commandList, device, commandQueue, computeQueue, calculatedAABBPointsReadBack, inputAABB,
+                   calculatedAABBPointsRead, outputScene);
+}
+
+void SceneGraphFactory::createMeshes(const ImportedScene& inputScene,
+                                     const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                                     const ComPtr<ID3D12Device2>&             device,
+                                     const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                     const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                                     ComPtr<ID3D12Resource>&                  calculatedAABBPointsReadBack,
+                                     ComPtr<ID3D12Resource>&                  inputAABB,
+                                     ComPtr<ID3D12Resource>&                  calculatedAABBPointsRead,
+                                     Scene&                                   outputScene)
+{
+  GIMS_PROFILE_ZONE("Create Meshes");
+  // The vertices are already in the final layout, so they are uploaded without conversion.
+  outputScene.m_meshes.reserve(inputScene.meshes.size());
+  for (const auto& mesh : inputScene.meshes)
+  {
+    outputScene.m_meshes.emplace_back(mesh.vertices.data(), static_cast<ui32>(mesh.vertices.size()),
+                                      mesh.indices.data(), static_cast<ui32>(mesh.indices.size()), mesh.materialIdx,
+                                      device, commandQueue);
+  }
+  computeMeshAABBs(commandList, device, commandQueue, computeQueue, calculatedAABBPointsReadBack, inputAABB,
+                   calculatedAABBPointsRead, outputScene);
+}
+
+void SceneGraphFactory::computeMeshAABBs(const ComPtr<ID3D12GraphicsCommandList6> commandList,
+                                         const ComPtr<ID3D12Device2>&             device,
+                                         const ComPtr<ID3D12CommandQueue>&        commandQueue,
+                                         const ComPtr<ID3D12CommandQueue>&        computeQueue,
+                                         ComPtr<ID3D12Resource>&                  calculatedAABBPointsReadBack,
+                                         ComPtr<ID3D12Resource>&                  inputAABB,
+                                         ComPtr<ID3D12Resource>&                  calculatedAABBPointsRead,
+                                         const Scene&                             outputScene)
+{
+  const ui32             numberOfMeshesInTheScene = static_cast<ui32>(outputScene.m_meshes.size());
+  std::vector<InputAABB> inputCPU(numberOfMeshesInTheScene);
+  for (ui32 i = 0; i < numberOfMeshesInTheScene; i++)
+  {
+    inputCPU[i].lowerLeftBottom = glm::float4(outputScene.m_meshes[i].getAABB().getLowerLeftBottom(), 1.0f);
+    inputCPU[i].upperRightTop   = glm::float4(outputScene.m_meshes[i].getAABB().getUpperRightTop(), 1.0f);
+  }
+
   const auto sizeInBytesInput = numberOfMeshesInTheScene * sizeof(InputAABB);
 
   const auto bufferDesc            = CD3DX12_RESOURCE_DESC::Buffer(sizeInBytesInput);
@@ -310,7 +378,8 @@ void SceneGraphFactory::createMeshes(aiScene const* const                     in
                                   D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(inputAABB.GetAddressOf()));
 
   UploadHelper uploader(device, sizeInBytesInput);
-  uploader.uploadBuffer(inputCPU.data(), inputAABB, sizeInBytesInput, commandQueue);
+  uploader.uploadBuffer(inputCPU.data(), inputAABB, sizeInBytesInput, commandQueue,
+                        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
 
   const auto sizeInBytesOutput = numberOfMeshesInTheScene * sizeof(AABBPoints);
 
@@ -324,70 +393,47 @@ void SceneGraphFactory::createMeshes(aiScene const* const                     in
                                   D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
                                   IID_PPV_ARGS(calculatedAABBPointsReadBack.GetAddressOf()));
 
-  commandList->SetComputeRootShaderResourceView(0, inputAABB->GetGPUVirtualAddress());
-  commandList->SetComputeRootUnorderedAccessView(1, calculatedAABBPointsRead->GetGPUVirtualAddress());
-  commandList->Dispatch(1, 1, 1);
-
-  const auto barrier0 = CD3DX12_RESOURCE_BARRIER::Transition(calculatedAABBPointsRead.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                                                             D3D12_RESOURCE_STATE_COPY_SOURCE);
-  commandList->ResourceBarrier(1, &barrier0);
-  commandList->CopyResource(calculatedAABBPointsReadBack.Get(), calculatedAABBPointsRead.Get());
-  const auto barrier1 = CD3DX12_RESOURCE_BARRIER::Transition(calculatedAABBPointsRead.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE,
-                                                             D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-  commandList->ResourceBarrier(1, &barrier1);
+  // The render graph records the transitions between computing the bounding boxes and reading them back.
+  RenderGraphD3D12 renderGraph(device);
+  const ui32       input    = renderGraph.importResource("Input AABBs", inputAABB,
+                                                         D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                                                         D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+  const ui32       output   = renderGraph.importResource("AABB Points", calculatedAABBPointsRead,
+                                                         D3D12_RESOURCE_STATE_COMMON,
+                                                         D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+  const ui32       readBack = renderGraph.importResource("AABB Points Read Back", calculatedAABBPointsReadBack,
+                                                         D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST);
+  renderGraph.addPass("Compute AABB Points", {{input, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE}},
+                      {{output, D3D12_RESOURCE_STATE_UNORDERED_ACCESS}},
+                      [&](const ComPtr<ID3D12GraphicsCommandList6>& passCommandList)
+                      {
+                        passCommandList->SetComputeRootShaderResourceView(0, inputAABB->GetGPUVirtualAddress());
+                        passCommandList->SetComputeRootUnorderedAccessView(
+                            1, calculatedAABBPointsRead->GetGPUVirtualAddress());
+                        passCommandList->Dispatch(1, 1, 1);
+                      });
+  renderGraph.addPass("Read Back AABB Points", {{output, D3D12_RESOURCE_STATE_COPY_SOURCE}},
+                      {{readBack, D3D12_RESOURCE_STATE_COPY_DEST}},
+                      [&](const ComPtr<ID3D12GraphicsCommandList6>& passCommandList) {
+                        passCommandList->CopyResource(calculatedAABBPointsReadBack.Get(),
+                                                      calculatedAABBPointsRead.Get());
+                      });
+  renderGraph.execute([&]() -> const ComPtr<ID3D12GraphicsCommandList6>& { return commandList; });
 
   commandList->Close();
 
+  // Only uses states of compute command lists, so the textures can be uploaded meanwhile.
   ID3D12CommandList* ppCommandLists[] = {commandList.Get()};
-  commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+  computeQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
 }
 
 
-static inline glm::mat4 aiMatrix4x4ToGlm(const aiMatrix4x4& from)
-{
-   return glm::transpose(glm::make_mat4(&from.a1));
-}
-
-
 ui32 SceneGraphFactory::createNodes(aiScene const* const inputScene, Scene& outputScene, aiNode const* const inputNode)
 {
   (void)inputScene;
-  inputNode->mChildren;
-  const ui32 numberOfChildrenOfInputNode = inputNode->mNumChildren;
-  
-  const ui32        numberOfMeshesOfInputNode   = inputNode->mNumMeshes;
-  const auto        meshesOfInputNode           = inputNode->mMeshes;
-
-
-  const aiMatrix4x4 parentRelativeTransformation = inputNode->mTransformation;
-  glm::mat4         convertedParentRelativeTransformation = aiMatrix4x4ToGlm(parentRelativeTransformation);
-
-   Scene::Node nodeToAdd;
-   nodeToAdd.transformation = convertedParentRelativeTransformation;
-   outputScene.m_nodes.push_back(nodeToAdd);
-
-   ui32 nodeToAddId = ui32(outputScene.m_nodes.size() - 1);
-   
-   for (ui32 i = 0; i < numberOfMeshesOfInputNode; i++)
-   {
-     outputScene.m_nodes.at(nodeToAddId).meshIndices.emplace_back(meshesOfInputNode[i]);
-   }
-
-  if (numberOfChildrenOfInputNode == 0)
-  {
-    return nodeToAddId;
-  }
-
-  aiNode**  childrenOfInputNode = inputNode->mChildren;
-  for (ui32 i = 0; i < numberOfChildrenOfInputNode; i++)
-  {
-    const ui32 childNodeCreated = createNodes(inputScene, outputScene, childrenOfInputNode[i]);
-    outputScene.m_nodes.at(nodeToAddId).childIndices.emplace_back(childNodeCreated);
-  }
-
   // Assignment 4
-  return nodeToAddId;
+  return appendSceneNodes(inputNode, outputScene.m_nodes);
 }
 
 void SceneGraphFactory::computeSceneAABB(Scene& scene, AABB& aabb, ui32 nodeIdx, f32m4 transformation)
@@ -418,9 +464,10 @@ void SceneGraphFactory::computeSceneAABB(Scene& scene, AABB& aabb, ui32 nodeIdx,
 
 void SceneGraphFactory::createTextures(
     const std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex,
-    std::filesystem::path parentPath, const ComPtr<ID3D12Device2>& device,
+    const std::vector<ImportedTexture>& textures, std::filesystem::path parentPath, const ComPtr<ID3D12Device2>& device,
     const ComPtr<ID3D12CommandQueue>& commandQueue, Scene& outputScene)
 {
+  GIMS_PROFILE_ZONE("Create Textures");
   
   ui8v4 defaultWhiteTextureData(255, 255, 255, 255);
   ui8v4 defaultBlackTextureData(0, 0, 0, 255);
@@ -430,16 +477,41 @@ void SceneGraphFactory::createTextures(
   Texture2DD3D12 defaultBlackTexture(&defaultBlackTextureData, 1, 1, device, commandQueue);
   Texture2DD3D12 defaultNormalMapTexture(&defaultNormalMapTextureData, 1, 1, device, commandQueue);
 
-  outputScene.m_textures.resize(textureFileNameToTextureIndex.size() + 3);
+  outputScene.m_textures.resize(textureFileNameToTextureIndex.size() + textures.size() + 3);
   outputScene.m_textures.at(0) = defaultWhiteTexture;
   outputScene.m_textures.at(1) = defaultBlackTexture;
   outputScene.m_textures.at(2) = defaultNormalMapTexture;
 
 
+  // The image files are read with many reads in flight while the containers are uploaded from their mappings. Each
+  // image is decoded and uploaded as soon as it has arrived, while the following ones are still being read.
+  std::vector<std::filesystem::path> containerFiles;
+  std::vector<ui32>                  containerTextureIndices;
+  std::vector<std::filesystem::path> imageFiles;
+  std::vector<ui32>                  imageTextureIndices;
   for (const auto& [textureRelativePath, textureIndex] : textureFileNameToTextureIndex)
   {
-    Texture2DD3D12 textureToAdd((parentPath / textureRelativePath), device, commandQueue); 
-    outputScene.m_textures.at(textureIndex) = textureToAdd;
+    const std::filesystem::path path        = findTextureContainerFile(parentPath / textureRelativePath);
+    const bool                  isContainer = isTextureContainerFile(path);
+    (isContainer ? containerFiles : imageFiles).push_back(path);
+    (isContainer ? containerTextureIndices : imageTextureIndices).push_back(textureIndex);
+  }
+  AsyncFileReader reader;
+  auto            images = reader.readFiles(imageFiles);
+  for (size_t i = 0; i < containerFiles.size(); i++)
+  {
+    outputScene.m_textures.at(containerTextureIndices[i]) = Texture2DD3D12(containerFiles[i], device, commandQueue);
+  }
+  for (size_t i = 0; i < imageFiles.size(); i++)
+  {
+    const std::vector<ui8> image = images[i].get();
+    outputScene.m_textures.at(imageTextureIndices[i]) =
+        Texture2DD3D12(image.data(), image.size(), device, commandQueue);
+  }
+  for (size_t i = 0; i < textures.size(); i++)
+  {
+    outputScene.m_textures.at(textureFileNameToTextureIndex.size() + 3 + i) =
+        Texture2DD3D12(textures[i].data, textures[i].size, device, commandQueue);
   }
 
   // Assignment 9
@@ -449,20 +521,11 @@ void SceneGraphFactory::createMaterials(aiScene const* const
                                         std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex,
                                         const ComPtr<ID3D12Device2>& device, Scene& outputScene)
 {
-  const ui32 numberOfMaterialsInTheScene= inputScene->mNumMaterials;
+  const ui32 numberOfMaterialsInTheScene = inputScene->mNumMaterials;
   const auto materialsInTheScene         = inputScene->mMaterials;
-  outputScene.m_materials.resize(numberOfMaterialsInTheScene);
+  std::vector<ImportedMaterial> materials(numberOfMaterialsInTheScene);
   for (ui32 i = 0; i < numberOfMaterialsInTheScene; i++)
   {
-    ComPtr<ID3D12DescriptorHeap> srv;
-    D3D12_DESCRIPTOR_HEAP_DESC   desc = {};
-    desc.Type                         = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    desc.NumDescriptors               = 5;
-    desc.NodeMask                     = 0;
-    desc.Flags                        = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    throwIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&srv)));
-
-
     aiMaterial* materialExtracted = materialsInTheScene[i];
     ai_real           exponentPropertyValue(0.0f);
     f32v4 emissiveParameters = getColor(AI_MATKEY_COLOR_EMISSIVE, materialExtracted);
@@ -470,35 +533,86 @@ void SceneGraphFactory::createMaterials(aiScene const* const
     f32v4 diffuseColor = getColor(AI_MATKEY_COLOR_DIFFUSE, materialExtracted);
     f32v4 specularColor = getColor(AI_MATKEY_COLOR_SPECULAR, materialExtracted);
     aiGetMaterialFloat(materialExtracted, AI_MATKEY_SHININESS, &exponentPropertyValue);
-    
-    i32 ambientTextureIndex = getTexture(aiTextureType_AMBIENT, 0, materialExtracted, textureFileNameToTextureIndex);
-    i32 diffuseTextureIndex = getTexture(aiTextureType_DIFFUSE, 0, materialExtracted, textureFileNameToTextureIndex);
-    i32 specularTextureIndex = getTexture(aiTextureType_SPECULAR, 0, materialExtracted, textureFileNameToTextureIndex);
-    i32 emissiveTextureIndex = getTexture(aiTextureType_EMISSIVE, 0, materialExtracted, textureFileNameToTextureIndex);
-    i32 normalMapTextureIndex = getTexture(aiTextureType_HEIGHT, 0, materialExtracted, textureFileNameToTextureIndex);
 
+    materials[i].emissive = emissiveParameters;
+    materials[i].ambient  = ambientColor;
+    materials[i].diffuse  = diffuseColor;
+    materials[i].specularColorAndExponent =
+        f32v4(specularColor.x, specularColor.y, specularColor.z, exponentPropertyValue);
 
-    outputScene.m_textures.at(ambientTextureIndex).addToDescriptorHeap(device, srv, 0);
-    outputScene.m_textures.at(diffuseTextureIndex).addToDescriptorHeap(device, srv, 1);
-    outputScene.m_textures.at(specularTextureIndex).addToDescriptorHeap(device, srv, 2);
-    outputScene.m_textures.at(emissiveTextureIndex).addToDescriptorHeap(device, srv, 3);
-    outputScene.m_textures.at(normalMapTextureIndex).addToDescriptorHeap(device, srv, 4);
-    
+    // Slots without a texture of their own hold a 1x1 default, the shader permutation replaces those by constants.
+    const aiTextureType slotTextureTypes[] = {aiTextureType_AMBIENT, aiTextureType_DIFFUSE, aiTextureType_SPECULAR,
+                                              aiTextureType_EMISSIVE, aiTextureType_HEIGHT};
+    for (ui32 slot = 0; slot < _countof(slotTextureTypes); slot++)
+    {
+      materials[i].textureIndices[slot] = static_cast<ui32>(
+          getTexture(slotTextureTypes[slot], 0, materialExtracted, textureFileNameToTextureIndex));
+      if (materialExtracted->GetTextureCount(slotTextureTypes[slot]) > 0)
+      {
+        materials[i].textureMask |= 1u << slot;
+      }
+    }
+  }
+  createMaterials(materials, device, outputScene);
+}
 
+void SceneGraphFactory::createMaterials(const std::vector<ImportedMaterial>& materials,
+                                        const ComPtr<ID3D12Device2>& device, Scene& outputScene)
+{
+  GIMS_PROFILE_ZONE("Create Materials");
+  const ui32 numberOfMaterialsInTheScene = static_cast<ui32>(materials.size());
+  outputScene.m_materials.resize(numberOfMaterialsInTheScene);
+  outputScene.m_materialConstants.resize(numberOfMaterialsInTheScene);
+  for (ui32 i = 0; i < numberOfMaterialsInTheScene; i++)
+  {
+    ComPtr<ID3D12DescriptorHeap> srv;
+    D3D12_DESCRIPTOR_HEAP_DESC   desc = {};
+    desc.Type                         = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    desc.NumDescriptors               = 5;
+    desc.NodeMask                     = 0;
+    desc.Flags                        = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    throwIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&srv)));
+
+    for (ui32 slot = 0; slot < materials[i].textureIndices.size(); slot++)
+    {
+      outputScene.m_textures.at(materials[i].textureIndices[slot]).addToDescriptorHeap(device, srv, slot);
+    }
 
-    Scene::MaterialConstantBuffer materialToAddConstantBuffer(
-        emissiveParameters, ambientColor, diffuseColor,
-        f32v4(specularColor.x, specularColor.y, specularColor.z, exponentPropertyValue));
+    Scene::MaterialConstantBuffer materialToAddConstantBuffer(materials[i].emissive, materials[i].ambient,
+                                                              materials[i].diffuse,
+                                                              materials[i].specularColorAndExponent);
 
-    ConstantBufferD3D12 materialToAddConstantBufferCreated(materialToAddConstantBuffer, device);
+    outputScene.m_materialConstants.at(i) = materialToAddConstantBuffer;
 
-    Scene::Material     materialToAdd(materialToAddConstantBufferCreated, srv);
+    Scene::Material materialToAdd(srv);
+    materialToAdd.textureMask = materials[i].textureMask;
     outputScene.m_materials.at(i) = materialToAdd;
   }
 
+  // All material constants share one structured buffer instead of one committed resource per material. The pixel
+  // shaders read it, so it sits in video memory and the first frame copies the constants into it.
+  outputScene.m_materialTable =
+      StructuredBufferD3D12(outputScene.m_materialConstants.data(), numberOfMaterialsInTheScene, device,
+                            StructuredBufferUsage::Updatable);
+
   // Assignment 7
   // Assignment 9
   // Assignment 10
 }
 
+void SceneGraphFactory::createInstanceTable(const ComPtr<ID3D12Device2>& device, Scene& outputScene)
+{
+  GIMS_PROFILE_ZONE("Create Instance Table");
+  const auto instanceBatches =
+      createInstanceBatches(outputScene.m_nodes, static_cast<ui32>(outputScene.m_meshes.size()));
+  printInstanceBatchingReport(std::cout, instanceBatches);
+
+  outputScene.m_instanceBatches             = instanceBatches.batches;
+  outputScene.m_nDrawCallsWithoutInstancing = instanceBatches.nDrawCallsWithoutInstancing;
+  outputScene.m_instanceTransformations     = instanceBatches.instanceTransformations;
+  outputScene.m_instanceTable =
+      StructuredBufferD3D12(outputScene.m_instanceTransformations.data(),
+                            static_cast<ui32>(outputScene.m_instanceTransformations.size()), device);
+}
+
 } // namespace gims
@@ -7,14 +7,35 @@
 #include <gimslib/dbg/HrException.hpp>
 #include <gimslib/io/CograBinaryMeshFile.hpp>
 #include <gimslib/sys/Event.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <gimslib/ui/ProfilerView.hpp>
+#include <fstream>
 #include <imgui.h>
 #include <iostream>
 #include <vector>
 using namespace gims;
 
-SceneGraphViewerApp::SceneGraphViewerApp(const DX12AppConfig config, const std::filesystem::path pathToScene)
+namespace
+{
+// Fewer batches per command list do not pay for the extra list and its state setup.
+const ui32 minInstanceBatchesPerCommandList = 64;
+} // namespace
+
+SceneGraphViewerApp::SceneGraphViewerApp(const DX12AppConfig config, const std::filesystem::path pathToScene,
+                                         bool useStaticBatching)
     : DX12App(config)
+    , m_pixelShaderFeatures(
+          {L"HAS_AMBIENT_TEXTURE", L"HAS_DIFFUSE_TEXTURE", L"HAS_SPECULAR_TEXTURE", L"HAS_EMISSIVE_TEXTURE"})
+    , m_pipelineStateManager(getDevice(),
+                             config.shaderCacheDirectory.empty()
+                                 ? std::filesystem::path()
+                                 : config.shaderCacheDirectory / L"scene-graph-viewer.psolib",
+                             &getThreadPool())
     , m_examinerController(true)
+    , m_nUpdates(0)
+    , m_leftButtonDown(false)
+    , m_rightButtonDown(false)
+    , m_profileZoneOverhead(Profiler::get().measureZoneOverhead())
 {
 
     // Setting an initial camera position so that the whole scene is visible
@@ -26,11 +47,13 @@ SceneGraphViewerApp::SceneGraphViewerApp(const DX12AppConfig config, const std::
   createComputePipeline();
 
 
-  const auto& cmds             = getCommandList();
-  const auto& commandAllocator = getCommandAllocator();
-
-  throwIfFailed(commandAllocator->Reset());
-  throwIfFailed(cmds->Reset(commandAllocator.Get(), nullptr));
+  // The bounding boxes are computed on the compute queue, while the textures are uploaded.
+  ComPtr<ID3D12CommandAllocator>     commandAllocator;
+  ComPtr<ID3D12GraphicsCommandList6> cmds;
+  throwIfFailed(
+      getDevice()->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COMPUTE, IID_PPV_ARGS(&commandAllocator)));
+  throwIfFailed(getDevice()->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COMPUTE, commandAllocator.Get(), nullptr,
+                                               IID_PPV_ARGS(&cmds)));
 
   cmds->SetPipelineState(m_pipelineState.Get());
   cmds->SetComputeRootSignature(m_rootSignatureForComputePipeline.Get());
@@ -40,34 +63,97 @@ SceneGraphViewerApp::SceneGraphViewerApp(const DX12AppConfig config, const std::
   ComPtr<ID3D12Resource> calculatedAABBPoints;
  
 
-  m_scene = SceneGraphFactory::createFromAssImpScene(pathToScene, cmds, getDevice(), getCommandQueue(), calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints);
+  m_scene = SceneGraphFactory::createFromFile(pathToScene, cmds, getDevice(), getCommandQueue(), getComputeQueue(),
+                                              calculatedAABBPointsReadBack, inputAABB, calculatedAABBPoints);
   waitForGPU();
   SceneGraphFactory::createSceneAABBs(m_scene, calculatedAABBPointsReadBack);
+  if (useStaticBatching)
+  {
+    SceneGraphFactory::applyStaticBatching(m_scene, getDevice(), getCommandQueue());
+  }
 
-  createMeshShaderPipeline();
-  createPipeline();
-
+  {
+    GIMS_PROFILE_ZONE("Create Pipelines");
+    createPipelines();
+  }
+  createIndirectSceneRenderer();
+  createOcclusionCuller();
+  createRayCastingScene();
+
+  // All shaders are built into the executable, unless compileShadersAtRuntime is set for editing them.
+  const auto shaderStatistics = getShaderCompilationStatistics();
+  std::cout << "Shader compilation: " << shaderStatistics.milliseconds << " ms (" << shaderStatistics.nEmbedded
+            << " built in, " << shaderStatistics.nCacheHits << " from cache, " << shaderStatistics.nCacheMisses
+            << " compiled)" << std::endl;
 }
 
-void SceneGraphViewerApp::onDraw()
+void SceneGraphViewerApp::onUpdate()
 {
-  if (!ImGui::GetIO().WantCaptureMouse)
+  m_updateInputs.acquire();
+  const UpdateInput& input = m_updateInputs.getReadBuffer();
+
+  // The update may run less often than the UI, so clicks are derived from the button states.
+  const bool leftChanged  = input.leftButton != m_leftButtonDown;
+  const bool rightChanged = input.rightButton != m_rightButtonDown;
+  m_leftButtonDown        = input.leftButton;
+  m_rightButtonDown       = input.rightButton;
+  if (const CameraPose* benchmarkCameraPose = getBenchmarkCameraPose())
   {
-    bool pressed  = ImGui::IsMouseClicked(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right);
-    bool released = ImGui::IsMouseReleased(ImGuiMouseButton_Left) || ImGui::IsMouseReleased(ImGuiMouseButton_Right);
-    if (pressed || released)
+    // A replay runs on the render thread, so each frame gets the pose that was recorded for it.
+    m_examinerController.setRotationQuaterion(benchmarkCameraPose->rotation);
+    m_examinerController.setTranslationVector(benchmarkCameraPose->translation);
+  }
+  else if (!input.mouseCaptured)
+  {
+    if (leftChanged || rightChanged)
     {
-      bool left = ImGui::IsMouseClicked(ImGuiMouseButton_Left) || ImGui::IsMouseReleased(ImGuiMouseButton_Left);
-      m_examinerController.click(pressed, left == true ? 1 : 2,
-                                 ImGui::IsKeyDown(ImGuiKey_LeftCtrl) || ImGui::IsKeyDown(ImGuiKey_RightCtrl),
-                                 getNormalizedMouseCoordinates());
+      const bool pressed = leftChanged ? input.leftButton : input.rightButton;
+      m_examinerController.click(pressed, leftChanged ? 1 : 2, input.control, input.mousePosition);
     }
     else
     {
-      m_examinerController.move(getNormalizedMouseCoordinates());
+      m_examinerController.move(input.mousePosition);
     }
   }
 
+  // The snapshot is reused two publishes later, so every member is written.
+  FrameSnapshot& snapshot          = m_frameSnapshots.getWriteBuffer();
+  snapshot.updateIdx               = ++m_nUpdates;
+  snapshot.projection              = input.projection;
+  snapshot.sceneViewTransformation = m_examinerController.getTransformationMatrix() *
+                                     m_scene.getAABB().getNormalizationTransformation();
+  snapshot.camera                  = {m_examinerController.getRotationQuaterion(),
+                                      m_examinerController.getTranslationVector()};
+  snapshot.cameraActive            = m_examinerController.active();
+  snapshot.useInstanceVisibility   = input.useOcclusionCulling;
+  if (input.useOcclusionCulling)
+  {
+    // The queries are in scene space, so the normalization is part of the view projection.
+    snapshot.occlusionCullingStatistics = m_occlusionCuller.cull(
+        snapshot.projection * snapshot.sceneViewTransformation, m_occlusionQueries, snapshot.instanceVisibility);
+  }
+  else
+  {
+    snapshot.occlusionCullingStatistics = OcclusionCullingFrameStatistics();
+  }
+  // The ray is in scene space, like the instance transformations.
+  snapshot.cursorHit = RayHit();
+  m_rayCastingScene.intersect(
+      createCameraRay(glm::inverse(snapshot.projection * snapshot.sceneViewTransformation), input.mousePosition),
+      snapshot.cursorHit);
+  m_frameSnapshots.publish();
+}
+
+void SceneGraphViewerApp::onDraw()
+{
+  // Draws the latest snapshot, the update thread may already be computing the next one.
+  m_frameSnapshots.acquire();
+  const FrameSnapshot& snapshot = m_frameSnapshots.getReadBuffer();
+  if (m_uiData.m_recordCameraPath)
+  {
+    m_cameraPath.add(snapshot.camera);
+  }
+
   const auto commandList = getCommandList();
   const auto rtvHandle   = getRTVHandle();
   const auto dsvHandle   = getDSVHandle();
@@ -82,14 +168,18 @@ void SceneGraphViewerApp::onDraw()
   commandList->RSSetViewports(1, &getViewport());
   commandList->RSSetScissorRects(1, &getRectScissor());
 
-  drawScene(commandList);
+  if (snapshot.updateIdx != 0)
+  {
+    drawScene(commandList, snapshot);
+  }
 
   
 }
 
 void SceneGraphViewerApp::onDrawUI()
 {
-  const auto imGuiFlags = m_examinerController.active() ? ImGuiWindowFlags_NoInputs : ImGuiWindowFlags_None;
+  const FrameSnapshot& snapshot   = m_frameSnapshots.getReadBuffer();
+  const auto           imGuiFlags = snapshot.cameraActive ? ImGuiWindowFlags_NoInputs : ImGuiWindowFlags_None;
   ImGui::Begin("Scene Information", nullptr, imGuiFlags);
   ImGui::Text("Frame time: %f", 1.0f / ImGui::GetIO().Framerate * 1000.0f);
   ImGui::Text("Frame Width: %d", getWidth());
@@ -99,6 +189,19 @@ void SceneGraphViewerApp::onDrawUI()
   ImGui::Text("Number of Nodes Available: %d", m_scene.getNumberOfNodes());
   ImGui::Text("Number of Materials Available: %d", m_scene.getNumberOfMaterialsAvailable());
   ImGui::Text("Number of Textures Available: %d", m_scene.getNumberOfTexturesAvailable());
+  ImGui::Text("Draw Calls Without Instancing: %d", m_scene.getNumberOfDrawCallsWithoutInstancing());
+  ImGui::Text("Draw Calls With Instancing: %d", m_scene.getNumberOfDrawCalls());
+  ImGui::Text("Shader Permutations: %d", (ui32)m_permutationPipelines.size());
+  if (snapshot.cursorHit.isHit())
+  {
+    const ui32 meshIdx = m_rayCastingScene.getInstance(snapshot.cursorHit.instanceIdx).meshIdx;
+    ImGui::Text("Under Cursor: Mesh %d, Material %d, Triangle %d", meshIdx,
+                m_scene.getMesh(meshIdx).getMaterialIndex(), snapshot.cursorHit.triangleIdx);
+  }
+  else
+  {
+    ImGui::Text("Under Cursor: Nothing");
+  }
   ImGui::End();
   ImGui::Begin("Scene Configuration", nullptr, imGuiFlags);
   ImGui::ColorEdit3("Background Color", &m_uiData.m_backgroundColor[0]);
@@ -110,7 +213,132 @@ void SceneGraphViewerApp::onDrawUI()
   ImGui::SliderFloat("Field of View", &m_uiData.m_fieldOfView, 0.1f, 90.0f);
   ImGui::SliderFloat("Near Plane", &m_uiData.m_nearPlane, 0.1f, 10.0f);
   ImGui::SliderFloat("Far Plane", &m_uiData.m_farPlane, 10.1f, 10000.0f);
+  ImGui::Checkbox("GPU Driven Rendering", &m_uiData.m_useGpuDrivenRendering);
+  if (m_uiData.m_useGpuDrivenRendering)
+  {
+    ImGui::Checkbox("Validate GPU Culling", &m_uiData.m_validateGpuCulling);
+    ImGui::Checkbox("Cull on Compute Queue", &m_uiData.m_useAsyncCompute);
+    ImGui::Text("Indirect Commands: %d", m_indirectSceneRenderer.getNumberOfCommands());
+    if (m_uiData.m_validateGpuCulling)
+    {
+      ImGui::Text("Visible on GPU: %d", m_indirectSceneRenderer.getNumberOfVisibleCommandsOnGPU());
+      ImGui::Text("Visible on CPU: %d", m_indirectSceneRenderer.getNumberOfVisibleCommandsOnCPU());
+      ImGui::Text("Visible Sets Match: %s", m_indirectSceneRenderer.isValidationMatching() ? "Yes" : "No");
+    }
+  }
+  else
+  {
+    ImGui::Checkbox("Parallel Command Recording", &m_uiData.m_useParallelRecording);
+    ImGui::Checkbox("CPU Occlusion Culling", &m_uiData.m_useOcclusionCulling);
+    if (m_uiData.m_useOcclusionCulling)
+    {
+      const auto& statistics = snapshot.occlusionCullingStatistics;
+      ImGui::Text("Occluder Triangles: %d", statistics.nOccluderTriangles);
+      ImGui::Text("Occlusion Culling Time: %.3f ms", statistics.getTotalMilliseconds());
+      ImGui::Text("Occluded Instances: %d / %d", statistics.nOccluded, statistics.nQueries);
+    }
+  }
+  ImGui::End();
+
+  if (m_scene.getNumberOfMaterialsAvailable() > 0)
+  {
+    ImGui::Begin("Material Editor", nullptr, imGuiFlags);
+    ImGui::SliderInt("Material Index", &m_uiData.m_selectedMaterialIdx, 0,
+                     (i32)m_scene.getNumberOfMaterialsAvailable() - 1);
+    const ui32 materialIdx       = (ui32)m_uiData.m_selectedMaterialIdx;
+    auto       materialConstants = m_scene.getMaterialConstants(materialIdx);
+    bool       changed           = false;
+    changed |= ImGui::ColorEdit3("Ambient", &materialConstants.ambientColor[0]);
+    changed |= ImGui::ColorEdit3("Diffuse", &materialConstants.diffuseColor[0]);
+    changed |= ImGui::ColorEdit3("Specular", &materialConstants.specularColorAndExponent[0]);
+    changed |= ImGui::ColorEdit3("Emissive", &materialConstants.emissiveParameters[0]);
+    if (changed)
+    {
+      m_scene.updateMaterialConstants(materialIdx, materialConstants);
+    }
+    ImGui::End();
+  }
+
+  ImGui::Begin("Profiler", nullptr, imGuiFlags);
+  ImGui::Text("Zone Overhead: %.1f ns", m_profileZoneOverhead);
+  ImGui::Checkbox("Show Timeline", &m_uiData.m_showProfiler);
+  ImGui::SliderFloat("Time Range (ms)", &m_uiData.m_profilerMilliseconds, 1.0f, 200.0f);
+  if (ImGui::Button("Export Chrome Trace"))
+  {
+    // All zones that are still in the buffers, which are usually the last few seconds.
+    const std::filesystem::path tracePath = std::filesystem::absolute("profile.json");
+    try
+    {
+      writeChromeTrace(Profiler::get().capture(), tracePath);
+      std::cout << "Wrote profile to " << tracePath.string() << std::endl;
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+  const bool wasRecordingCameraPath = m_uiData.m_recordCameraPath;
+  ImGui::Checkbox("Record Camera Path", &m_uiData.m_recordCameraPath);
+  ImGui::Text("Recorded Camera Poses: %d", m_cameraPath.getNumberOfPoses());
+  if (m_uiData.m_recordCameraPath && !wasRecordingCameraPath)
+  {
+    m_cameraPath.clear();
+  }
+  else if (!m_uiData.m_recordCameraPath && wasRecordingCameraPath && m_cameraPath.getNumberOfPoses() > 0)
+  {
+    // Replayed with --benchmark camera-path.txt.
+    const std::filesystem::path cameraPathPath = std::filesystem::absolute("camera-path.txt");
+    try
+    {
+      m_cameraPath.save(cameraPathPath);
+      std::cout << "Wrote camera path to " << cameraPathPath.string() << std::endl;
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+  if (m_uiData.m_showProfiler)
+  {
+    const ui64 rangeNs = static_cast<ui64>(m_uiData.m_profilerMilliseconds * 1e6f);
+    const ui64 nowNs   = Profiler::get().now();
+    drawProfilerTimeline(Profiler::get().capture(nowNs > rangeNs ? nowNs - rangeNs : 0));
+  }
+  ImGui::End();
+
+  ImGui::Begin("GPU Passes", nullptr, imGuiFlags);
+  for (const auto& passTiming : getGpuProfiler().getPassTimings())
+  {
+    ImGui::Text("%*s%s: %.3f ms (average %.3f ms, max %.3f ms)", static_cast<i32>(passTiming.depth * 2), "",
+                passTiming.name.c_str(), passTiming.milliseconds, passTiming.averageMilliseconds,
+                passTiming.maxMilliseconds);
+  }
+  if (ImGui::Button("Export GPU Timings"))
+  {
+    const std::filesystem::path timingsPath = std::filesystem::absolute("gpu-timings.json");
+    std::ofstream               stream(timingsPath, std::ios::trunc);
+    getGpuProfiler().writeJson(stream);
+    if (stream)
+    {
+      std::cout << "Wrote GPU timings to " << timingsPath.string() << std::endl;
+    }
+    else
+    {
+      std::cerr << "Unable to write " << timingsPath.string() << std::endl;
+    }
+  }
   ImGui::End();
+
+  // Input of the next update, after the UI has decided whether it uses the mouse.
+  UpdateInput& input        = m_updateInputs.getWriteBuffer();
+  input.mousePosition       = getNormalizedMouseCoordinates();
+  input.leftButton          = ImGui::IsMouseDown(ImGuiMouseButton_Left);
+  input.rightButton         = ImGui::IsMouseDown(ImGuiMouseButton_Right);
+  input.control             = ImGui::IsKeyDown(ImGuiKey_LeftCtrl) || ImGui::IsKeyDown(ImGuiKey_RightCtrl);
+  input.mouseCaptured       = ImGui::GetIO().WantCaptureMouse;
+  input.projection          = getProjectionMatrix();
+  input.useOcclusionCulling = m_uiData.m_useOcclusionCulling && !m_uiData.m_useGpuDrivenRendering;
+  m_updateInputs.publish();
 }
 
 
@@ -129,13 +357,12 @@ void SceneGraphViewerApp::createRootSignatureForComputePipeline()
   ComPtr<ID3DBlob> rootBlob, errorBlob;
   D3D12SerializeRootSignature(&rootSignatureDescription, D3D_ROOT_SIGNATURE_VERSION_1, &rootBlob, &errorBlob);
 
-  getDevice()->CreateRootSignature(0, rootBlob->GetBufferPointer(), rootBlob->GetBufferSize(),
-                                   IID_PPV_ARGS(&m_rootSignatureForComputePipeline));
+  m_rootSignatureForComputePipeline = m_pipelineStateManager.createRootSignature(rootBlob);
 }
 
 void SceneGraphViewerApp::createRootSignature()
 {
-  const uint8_t NUMBER_OF_ROOT_PARAMETERS = 5;
+  const uint8_t NUMBER_OF_ROOT_PARAMETERS = 6;
   const uint8_t  NUMBER_OF_STATIC_SAMPLERS   = 1;
 
 
@@ -146,10 +373,11 @@ void SceneGraphViewerApp::createRootSignature()
   };
   CD3DX12_ROOT_PARAMETER rootParameters[NUMBER_OF_ROOT_PARAMETERS] = {};
   rootParameters[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
-  rootParameters[1].InitAsConstants(16, 1, 0, D3D12_SHADER_VISIBILITY_ALL);
-  rootParameters[2].InitAsConstantBufferView(2, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+  rootParameters[1].InitAsConstants(18, 1, 0, D3D12_SHADER_VISIBILITY_ALL);
+  rootParameters[2].InitAsShaderResourceView(5, 0, D3D12_SHADER_VISIBILITY_PIXEL);
   rootParameters[3].InitAsDescriptorTable(1, &range[0]);
   rootParameters[4].InitAsConstants(32, 3, 0, D3D12_SHADER_VISIBILITY_MESH);
+  rootParameters[5].InitAsShaderResourceView(6, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
 
   D3D12_STATIC_SAMPLER_DESC staticSamplerDescription = {};
@@ -174,23 +402,57 @@ void SceneGraphViewerApp::createRootSignature()
   
   ComPtr<ID3DBlob> rootBlob, errorBlob;
   D3D12SerializeRootSignature(&rootSignatureDescription, D3D_ROOT_SIGNATURE_VERSION_1, &rootBlob, &errorBlob);
-  getDevice()->CreateRootSignature(0, rootBlob->GetBufferPointer(), rootBlob->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature));
+  m_rootSignature = m_pipelineStateManager.createRootSignature(rootBlob);
 }
 
 void SceneGraphViewerApp::createComputePipeline()
 {
   const auto computeShader =
-        compileShader("../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxComputeShader.hlsl", L"main", L"cs_6_0");
+        loadShader("../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxComputeShader.hlsl", L"main", L"cs_6_0");
   D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
 
   psoDesc.pRootSignature = m_rootSignatureForComputePipeline.Get();
-  psoDesc.CS             = HLSLCompiler::convert(computeShader);
+  psoDesc.CS             = computeShader;
   psoDesc.Flags          = D3D12_PIPELINE_STATE_FLAG_NONE;
-  throwIfFailed(getDevice()->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
+
+  // Needed right away for computing the AABBs while the scene loads.
+  const auto pipeline = m_pipelineStateManager.requestPipeline(psoDesc);
+  m_pipelineStateManager.createPipelines();
+  m_pipelineState = m_pipelineStateManager.getPipeline(pipeline);
 }
 
 
-void SceneGraphViewerApp::createMeshShaderPipeline()
+void SceneGraphViewerApp::createPipelines()
+{
+  const auto meshShaderPipeline = requestMeshShaderPipeline();
+  // GPU driven rendering draws all materials with one pipeline, so it samples every texture.
+  const auto pipeline = requestPipelineForPermutation(m_pixelShaderFeatures.getAllFeaturesMask());
+  std::vector<PipelineStateManager::Handle> materialPipelines(m_scene.getNumberOfMaterialsAvailable());
+  for (ui32 i = 0; i < m_scene.getNumberOfMaterialsAvailable(); i++)
+  {
+    const ui32 shaderPermutation = m_scene.getMaterial(i).textureMask & m_pixelShaderFeatures.getAllFeaturesMask();
+    materialPipelines[i]         = requestPipelineForPermutation(shaderPermutation);
+  }
+
+  m_pipelineStateManager.createPipelines();
+  m_pipelineStateManager.storeLibrary();
+
+  m_meshShaderPipelineState = m_pipelineStateManager.getPipeline(meshShaderPipeline);
+  m_pipelineState           = m_pipelineStateManager.getPipeline(pipeline);
+  for (ui32 i = 0; i < m_scene.getNumberOfMaterialsAvailable(); i++)
+  {
+    m_scene.setMaterialPipelineState(i, m_pipelineStateManager.getPipeline(materialPipelines[i]));
+  }
+  std::cout << "Created " << m_permutationPipelines.size() << " shader permutations for "
+            << m_scene.getNumberOfMaterialsAvailable() << " materials." << std::endl;
+
+  // Warm starts load all pipelines from the pipeline library.
+  const auto statistics = m_pipelineStateManager.getStatistics();
+  std::cout << "Pipeline creation: " << statistics.milliseconds << " ms (" << statistics.nRequests << " requested, "
+            << statistics.nPipelines << " unique, " << statistics.nLoadedFromLibrary << " from library)" << std::endl;
+}
+
+PipelineStateManager::Handle SceneGraphViewerApp::requestMeshShaderPipeline()
 {
   D3D12_FEATURE_DATA_D3D12_OPTIONS7 featureData = {};
   getDevice()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS7, &featureData, sizeof(featureData));
@@ -198,19 +460,18 @@ void SceneGraphViewerApp::createMeshShaderPipeline()
   {
     std::cout << "OOPS! Mesh shader is not supported :(" << std::endl;
   }
-  waitForGPU();
 
   const auto meshShader =
-      compileShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxMeshShader.hlsl",
-                    L"MS_main", L"ms_6_5");
+      loadShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxMeshShader.hlsl",
+                 L"MS_main", L"ms_6_5");
   const auto pixelShader =
-      compileShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxMeshShader.hlsl",
-                    L"PS_main", L"ps_6_5");
+      loadShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/BoundingBoxMeshShader.hlsl",
+                 L"PS_main", L"ps_6_5");
 
   D3DX12_MESH_SHADER_PIPELINE_STATE_DESC psoDesc = {};
   psoDesc.pRootSignature                         = m_rootSignature.Get();
-  psoDesc.MS                                     = HLSLCompiler::convert(meshShader);
-  psoDesc.PS                                     = HLSLCompiler::convert(pixelShader);
+  psoDesc.MS                                     = meshShader;
+  psoDesc.PS                                     = pixelShader;
   psoDesc.RasterizerState                        = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
   psoDesc.RasterizerState.FillMode               = D3D12_FILL_MODE_SOLID;
   psoDesc.RasterizerState.CullMode               = D3D12_CULL_MODE_NONE;
@@ -225,28 +486,29 @@ void SceneGraphViewerApp::createMeshShaderPipeline()
   psoDesc.RTVFormats[0]                          = getDX12AppConfig().renderTargetFormat;
   psoDesc.SampleDesc.Count                       = 1;
 
- auto psoStream = CD3DX12_PIPELINE_MESH_STATE_STREAM(psoDesc);
-
-  D3D12_PIPELINE_STATE_STREAM_DESC streamDesc;
-  streamDesc.pPipelineStateSubobjectStream = &psoStream;
-  streamDesc.SizeInBytes                   = sizeof(psoStream);
-
-  throwIfFailed(getDevice()->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&m_meshShaderPipelineState)));
+  return m_pipelineStateManager.requestPipeline(psoDesc);
 }
-void SceneGraphViewerApp::createPipeline()
+
+PipelineStateManager::Handle SceneGraphViewerApp::requestPipelineForPermutation(ui32 shaderPermutation)
 {
-  waitForGPU();
+  const auto pipelineIter = m_permutationPipelines.find(shaderPermutation);
+  if (pipelineIter != m_permutationPipelines.end())
+  {
+    return pipelineIter->second;
+  }
+
   const auto inputElementDescs = TriangleMeshD3D12::getInputElementDescriptors();
+  const auto defines           = m_pixelShaderFeatures.getDefines(shaderPermutation);
 
-  const auto vertexShader = compileShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/TriangleMesh.hlsl", L"VS_main", L"vs_6_0");
+  const auto vertexShader = loadShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/TriangleMesh.hlsl", L"VS_main", L"vs_6_0");
   const auto pixelShader=
-      compileShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/TriangleMesh.hlsl", L"PS_main", L"ps_6_0");
+      loadShader(L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/TriangleMesh.hlsl", L"PS_main", L"ps_6_0", defines);
 
   D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
   psoDesc.InputLayout                        = {inputElementDescs.data(), (ui32)inputElementDescs.size()};
   psoDesc.pRootSignature                     = m_rootSignature.Get();
-  psoDesc.VS                                 = HLSLCompiler::convert(vertexShader);
-  psoDesc.PS                                 = HLSLCompiler::convert(pixelShader);
+  psoDesc.VS                                 = vertexShader;
+  psoDesc.PS                                 = pixelShader;
   psoDesc.RasterizerState                    = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
   psoDesc.RasterizerState.FillMode           = D3D12_FILL_MODE_SOLID;
   psoDesc.RasterizerState.CullMode           = D3D12_CULL_MODE_NONE;
@@ -261,21 +523,99 @@ void SceneGraphViewerApp::createPipeline()
   psoDesc.NumRenderTargets                   = 1;
   psoDesc.RTVFormats[0]                      = getDX12AppConfig().renderTargetFormat;
   psoDesc.SampleDesc.Count                   = 1;
-  throwIfFailed(getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
+
+  return m_permutationPipelines[shaderPermutation] = m_pipelineStateManager.requestPipeline(psoDesc);
+}
+
+void SceneGraphViewerApp::createIndirectSceneRenderer()
+{
+  const auto cullingShader = loadShader(
+      L"../../../Assignments/second-assignment-scene-graph-viewer/Shaders/IndirectCulling.hlsl", L"CS_main", L"cs_6_0");
+  m_indirectSceneRenderer = IndirectSceneRendererD3D12(m_scene, getDevice(), m_rootSignature, 1, cullingShader,
+                                                       getDX12AppConfig().frameCount);
+}
+
+void SceneGraphViewerApp::createOcclusionCuller()
+{
+  std::vector<StaticMeshData> meshes(m_scene.getNumberOfMeshesAvailable());
+  std::vector<AABB>           meshAABBs(meshes.size());
+  for (ui32 i = 0; i < meshes.size(); i++)
+  {
+    const TriangleMeshD3D12& mesh = m_scene.getMesh(i);
+    meshes[i].vertices            = mesh.getVertices();
+    meshes[i].indices             = mesh.getIndices();
+    meshes[i].materialIndex       = mesh.getMaterialIndex();
+    meshAABBs[i]                  = mesh.getAABB();
+  }
+
+  const OcclusionCullingSettings settings;
+  m_occlusionCuller = OcclusionCuller(settings, &getThreadPool());
+  m_occlusionCuller.setOccluders(selectOccluders(meshes, m_scene.getInstanceBatches(),
+                                                 m_scene.getInstanceTransformations(), settings));
+  m_occlusionQueries =
+      createOcclusionQueries(meshAABBs, m_scene.getInstanceBatches(), m_scene.getInstanceTransformations());
+  std::cout << "Occlusion culling uses " << getThreadPool().getNumberOfThreads() << " threads." << std::endl;
 }
 
-void SceneGraphViewerApp::drawScene(const ComPtr<ID3D12GraphicsCommandList6>& cmdLst)
+void SceneGraphViewerApp::createRayCastingScene()
 {
-  updateSceneConstantBuffer();
+  GIMS_PROFILE_ZONE("Create Ray Casting Scene");
+  // The hierarchies copy the triangles, the CPU copies of the meshes are only read while they are built.
+  std::vector<TriangleBvhGeometry> geometries;
+  for (ui32 i = 0; i < m_scene.getNumberOfMeshesAvailable(); i++)
+  {
+    const auto& vertices = m_scene.getMesh(i).getVertices();
+    const auto& indices  = m_scene.getMesh(i).getIndices();
+    geometries.push_back({vertices.empty() ? nullptr : &vertices[0].position, static_cast<ui32>(vertices.size()),
+                          sizeof(Vertex), indices.data(), static_cast<ui32>(indices.size() / 3)});
+  }
+  m_rayCastingScene = RayCastingScene(createTriangleBvhs(geometries, getThreadPool()));
+
+  std::vector<RayCastingInstance> instances;
+  for (const auto& batch : m_scene.getInstanceBatches())
+  {
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      instances.push_back({batch.meshIdx, m_scene.getInstanceTransformations()[batch.firstInstance + i]});
+    }
+  }
+  m_rayCastingScene.setInstances(instances);
+}
+
+void SceneGraphViewerApp::drawScene(const ComPtr<ID3D12GraphicsCommandList6>& cmdLst, const FrameSnapshot& snapshot)
+{
+  GIMS_PROFILE_ZONE("Draw Scene");
+  updateSceneConstantBuffer(snapshot.projection);
   // Assignment 2
   // Assignment 6
 
 
   const auto currentConstantBuffer                   = m_constantBuffers[getFrameIndex()].getResource()->GetGPUVirtualAddress();
-  const auto viewTransformation = m_examinerController.getTransformationMatrix();
+  const auto sceneViewTransformation = snapshot.sceneViewTransformation;
+
+  // Edited materials are copied before any draw of the frame reads the material table.
+  m_scene.addMaterialTableUpdatesToCommandList(cmdLst, getFrameIndex());
 
-  auto sceneAABB = m_scene.getAABB();
-  auto sceneNormalizationTransformation = sceneAABB.getNormalizationTransformation();
+  // Culling is a compute pass, it has to be recorded before the graphics pipeline is set. On the compute queue it
+  // overlaps with the clears and the bounding boxes, until the indirect draws wait for it.
+  ui32 cullingJob = 0;
+  if (m_uiData.m_useGpuDrivenRendering)
+  {
+    const f32m4 viewProjection = snapshot.projection * sceneViewTransformation;
+    m_indirectSceneRenderer.setValidation(m_uiData.m_validateGpuCulling);
+    if (m_uiData.m_useAsyncCompute)
+    {
+      cullingJob = recordComputeJob(
+          [&](const ComPtr<ID3D12GraphicsCommandList6>& computeCommandList)
+          { m_indirectSceneRenderer.cull(computeCommandList, viewProjection, getFrameIndex()); });
+    }
+    else
+    {
+      beginGpuPass("Culling");
+      m_indirectSceneRenderer.cull(cmdLst, viewProjection, getFrameIndex());
+      endGpuPass();
+    }
+  }
 
   cmdLst->SetGraphicsRootSignature(m_rootSignature.Get());
   cmdLst->SetGraphicsRootConstantBufferView(0, currentConstantBuffer);
@@ -283,18 +623,79 @@ void SceneGraphViewerApp::drawScene(const ComPtr<ID3D12GraphicsCommandList6>& cm
   // Rendering AABBs of meshes availale in the scene if needed
   if (m_uiData.m_wrapObjectsWithBoundingBoxes == true)
   {
+    beginGpuPass("Bounding Boxes");
     cmdLst->SetPipelineState(m_meshShaderPipelineState.Get());
-    m_scene.addToCommandList(cmdLst, viewTransformation * sceneNormalizationTransformation, 1, 2, 3, 1);
+    m_scene.addToCommandList(cmdLst, sceneViewTransformation, 1, 2, 5, 3, 1, m_meshShaderPipelineState);
+    endGpuPass();
   }
 
-  // Rendering the meshes
+  // Rendering the meshes. With culling on the compute queue, the pass includes waiting for it.
+  beginGpuPass("Geometry");
   cmdLst->SetPipelineState(m_pipelineState.Get());
-  m_scene.addToCommandList(cmdLst, viewTransformation * sceneNormalizationTransformation, 1, 2, 3, 0);
+  if (m_uiData.m_useGpuDrivenRendering)
+  {
+    if (m_uiData.m_useAsyncCompute)
+    {
+      // The draws continue in a new command list, which starts without any state.
+      waitForComputeJob(cullingJob);
+      const auto& drawCommandList = getCommandList();
+      setGraphicsState(drawCommandList);
+      drawCommandList->SetPipelineState(m_pipelineState.Get());
+      m_indirectSceneRenderer.draw(drawCommandList, m_scene, sceneViewTransformation, 1, 2, 5, 3, getFrameIndex());
+    }
+    else
+    {
+      m_indirectSceneRenderer.draw(cmdLst, m_scene, sceneViewTransformation, 1, 2, 5, 3, getFrameIndex());
+    }
+  }
+  else
+  {
+    // The update has culled the instances of the snapshot against the occluders.
+    const std::vector<ui8>* instanceVisibility =
+        snapshot.useInstanceVisibility ? &snapshot.instanceVisibility : nullptr;
+
+    const auto chunks =
+        m_uiData.m_useParallelRecording
+            ? partitionItems(static_cast<ui32>(m_scene.getInstanceBatches().size()),
+                             getThreadPool().getNumberOfThreads(), minInstanceBatchesPerCommandList)
+            : std::vector<ItemRange>();
+    if (chunks.size() <= 1)
+    {
+      m_scene.addToCommandList(cmdLst, sceneViewTransformation, 1, 2, 5, 3, 0, m_pipelineState, instanceVisibility);
+    }
+    else
+    {
+      // Each chunk of instance batches is recorded into its own command list, which starts without any state. cmdLst
+      // must not be used afterwards, the commands that follow go to a new list.
+      recordCommandListsInParallel(
+          static_cast<ui32>(chunks.size()),
+          [&](ui32 chunkIdx, const ComPtr<ID3D12GraphicsCommandList6>& chunkCommandList)
+          {
+            setGraphicsState(chunkCommandList);
+            chunkCommandList->SetPipelineState(m_pipelineState.Get());
+            m_scene.addInstanceBatchesToCommandList(chunkCommandList, sceneViewTransformation, 1, 2, 5, 3,
+                                                    chunks[chunkIdx], m_pipelineState, instanceVisibility);
+          });
+    }
+  }
+  endGpuPass();
 
 
 
 }
 
+void SceneGraphViewerApp::setGraphicsState(const ComPtr<ID3D12GraphicsCommandList6>& commandList)
+{
+  const auto rtvHandle = getRTVHandle();
+  const auto dsvHandle = getDSVHandle();
+  commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+  commandList->RSSetViewports(1, &getViewport());
+  commandList->RSSetScissorRects(1, &getRectScissor());
+  commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+  commandList->SetGraphicsRootConstantBufferView(
+      0, m_constantBuffers[getFrameIndex()].getResource()->GetGPUVirtualAddress());
+}
+
 namespace
 {
 struct ConstantBuffer
@@ -320,11 +721,16 @@ void SceneGraphViewerApp::createSceneConstantBuffer()
   }
 }
 
-void SceneGraphViewerApp::updateSceneConstantBuffer()
+f32m4 SceneGraphViewerApp::getProjectionMatrix() const
+{
+  return glm::perspectiveFovLH_ZO<f32>(glm::radians(m_uiData.m_fieldOfView), (f32)getWidth(), (f32)getHeight(),
+                                       m_uiData.m_nearPlane, m_uiData.m_farPlane);
+}
+
+void SceneGraphViewerApp::updateSceneConstantBuffer(const f32m4& projection)
 {
   ConstantBuffer cb = {};
-  cb.projectionMatrix =
-      glm::perspectiveFovLH_ZO<f32>(glm::radians(m_uiData.m_fieldOfView), (f32)getWidth(), (f32)getHeight(), m_uiData.m_nearPlane, m_uiData.m_farPlane);
+  cb.projectionMatrix = projection;
 
   cb.boundingBoxColor = m_uiData.m_boundingBoxColor;
   cb.m_lightDirectionXCoordinate = f32(m_uiData.m_lightDirectionXCoordinate);
@@ -0,0 +1,127 @@
+#include "SceneImport.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <stdexcept>
+
+namespace gims
+{
+const aiScene* importAssimpScene(Assimp::Importer& importer, const std::filesystem::path& pathToScene)
+{
+  const auto absolutePath = std::filesystem::weakly_canonical(pathToScene);
+  if (!std::filesystem::exists(absolutePath))
+  {
+    throw std::runtime_error(absolutePath.string() + " does not exist.");
+  }
+
+  const auto arguments = aiPostProcessSteps::aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+                         aiProcess_GenUVCoords | aiProcess_ConvertToLeftHanded | aiProcess_OptimizeMeshes |
+                         aiProcess_RemoveRedundantMaterials | aiProcess_ImproveCacheLocality |
+                         aiProcess_FindInvalidData | aiProcess_FindDegenerates /*| aiProcess_FlipWindingOrder */ |
+                         aiProcess_CalcTangentSpace;
+
+  importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
+  const aiScene* inputScene = importer.ReadFile(absolutePath.string(), arguments);
+  if (!inputScene)
+  {
+    throw std::runtime_error(absolutePath.string() + " can't be loaded with Assimp.");
+  }
+  return inputScene;
+}
+
+ui32 appendSceneNodes(aiNode const* const inputNode, std::vector<SceneNode>& nodes)
+{
+  // Assimp stores row-major matrices.
+  const aiMatrix4x4& parentRelativeTransformation = inputNode->mTransformation;
+
+  const ui32 nodeIdx = static_cast<ui32>(nodes.size());
+  nodes.emplace_back();
+  nodes[nodeIdx].transformation = glm::transpose(glm::make_mat4(&parentRelativeTransformation.a1));
+  nodes[nodeIdx].meshIndices.assign(inputNode->mMeshes, inputNode->mMeshes + inputNode->mNumMeshes);
+  nodes[nodeIdx].childIndices.reserve(inputNode->mNumChildren);
+
+  for (ui32 i = 0; i < inputNode->mNumChildren; i++)
+  {
+    // The vector may grow, so the node is looked up again after each child.
+    const ui32 childIdx = appendSceneNodes(inputNode->mChildren[i], nodes);
+    nodes[nodeIdx].childIndices.push_back(childIdx);
+  }
+  return nodeIdx;
+}
+
+std::unordered_map<std::filesystem::path, ui32> textureFilenameToIndex(aiScene const* const inputScene)
+{
+  std::unordered_map<std::filesystem::path, ui32> textureFileNameToTextureIndex;
+
+  ui32 textureIdx = 3;
+  for (ui32 mIdx = 0; mIdx < inputScene->mNumMaterials; mIdx++)
+  {
+    for (ui32 textureType = aiTextureType_NONE; textureType < aiTextureType_UNKNOWN; textureType++)
+    {
+      for (ui32 i = 0; i < inputScene->mMaterials[mIdx]->GetTextureCount((aiTextureType)textureType); i++)
+      {
+        aiString path;
+        inputScene->mMaterials[mIdx]->GetTexture((aiTextureType)textureType, i, &path);
+
+        const auto texturePathCstr = path.C_Str();
+        const auto textureIter     = textureFileNameToTextureIndex.find(texturePathCstr);
+        if (textureIter == textureFileNameToTextureIndex.end())
+        {
+          textureFileNameToTextureIndex.emplace(texturePathCstr, static_cast<ui32>(textureIdx));
+          textureIdx++;
+        }
+      }
+    }
+  }
+  return textureFileNameToTextureIndex;
+}
+
+f32v4 getColor(char const* const pKey, unsigned int type, unsigned int idx, aiMaterial const* const material)
+{
+  aiColor3D color;
+  if (material->Get(pKey, type, idx, color) == aiReturn_SUCCESS)
+  {
+    return f32v4(color.r, color.g, color.b, 0.0f);
+  }
+  else
+  {
+    return f32v4(0.0f);
+  }
+}
+
+i32 getTexture(aiTextureType textureType, unsigned int textureIndex, aiMaterial const* const material,
+               const std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex)
+{
+  i32 defaultTextureIndexToReturn = 0;
+  aiString textureName("");
+  aiReturn textureRetrievingResult = material->GetTexture(textureType, textureIndex, &textureName);
+  if (textureRetrievingResult == aiReturn_FAILURE)
+  {
+    if (textureType == aiTextureType_AMBIENT)
+    {
+      defaultTextureIndexToReturn = 1;
+    }
+    else if (textureType == aiTextureType_DIFFUSE)
+    {
+      defaultTextureIndexToReturn = 1;
+    }
+    else if (textureType == aiTextureType_SPECULAR)
+    {
+      defaultTextureIndexToReturn = 0;
+    }
+    else if (textureType == aiTextureType_EMISSIVE)
+    {
+      defaultTextureIndexToReturn = 1;
+    }
+    else if (textureType == aiTextureType_HEIGHT)
+    {
+      defaultTextureIndexToReturn = 2;
+    }
+  }
+  else
+  {
+    defaultTextureIndexToReturn = textureFileNameToTextureIndex.find(textureName.C_Str())->second;
+  }
+  return defaultTextureIndexToReturn;
+}
+} // namespace gims
@@ -0,0 +1,277 @@
+#include "ScenePackage.hpp"
+#include <cstring>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sw/TextureCompression.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using namespace gims;
+
+namespace
+{
+// The payloads hold the structs as they are in memory, little-endian, which all platforms of the viewer are.
+static_assert(std::is_trivially_copyable_v<Vertex> && std::is_trivially_copyable_v<ImportedMaterial>);
+
+const char* const nodesEntryName     = "nodes";
+const char* const materialsEntryName = "materials";
+
+std::string getMeshEntryName(size_t meshIdx)
+{
+  return "meshes/" + std::to_string(meshIdx);
+}
+
+// Texture i of the package is texture i + 3 of the scene, after the default textures.
+std::string getTextureEntryName(size_t textureIdx)
+{
+  return "textures/" + std::to_string(textureIdx);
+}
+
+// Header of a mesh entry, followed by the vertices and the indices.
+struct MeshHeader
+{
+  ui32 nVertices;
+  ui32 nIndices;
+  ui32 materialIdx;
+  ui32 reserved;
+};
+
+template <typename T> void append(std::vector<ui8>& bytes, const T* values, size_t count)
+{
+  const ui8* data = reinterpret_cast<const ui8*>(values);
+  bytes.insert(bytes.end(), data, data + count * sizeof(T));
+}
+
+// Reads the values of a payload one after the other and throws if it ends before.
+class PayloadReader
+{
+public:
+  PayloadReader(const PackageFile& package, const std::string& entryName)
+      : m_entryName(entryName)
+      , m_position(0)
+  {
+    const ui32 entryIdx = package.find(entryName);
+    if (entryIdx == PackageFile::invalidIdx)
+    {
+      throw std::runtime_error("The package has no entry " + entryName + ".");
+    }
+    m_data = package.getData(entryIdx);
+    m_size = package.getEntries()[entryIdx].size;
+  }
+
+  template <typename T> void read(T* values, size_t count)
+  {
+    if (count > (m_size - m_position) / sizeof(T))
+    {
+      throw std::runtime_error("Entry " + m_entryName + " of the package is truncated.");
+    }
+    std::memcpy(values, m_data + m_position, count * sizeof(T));
+    m_position += count * sizeof(T);
+  }
+
+  template <typename T> T read()
+  {
+    T value;
+    read(&value, 1);
+    return value;
+  }
+
+  // Reads the number of the elements that follow, which must fit into the rest of the payload, so corrupt counts do
+  // not allocate gigabytes.
+  size_t readCount(size_t minElementSize)
+  {
+    const size_t count = read<ui32>();
+    if (count > getRemainingSize() / minElementSize)
+    {
+      throw std::runtime_error("Entry " + m_entryName + " of the package is truncated.");
+    }
+    return count;
+  }
+
+  size_t getRemainingSize() const
+  {
+    return m_size - m_position;
+  }
+
+private:
+  std::string m_entryName;
+  const ui8*  m_data;
+  size_t      m_size;
+  size_t      m_position;
+};
+
+std::vector<ui8> createCompressedTexture(const SoftwareImage& image)
+{
+  const CompressedTexture texture = compressTexture(image, chooseCompressedFormat(image));
+  return createDdsFile(texture.format, texture.width, texture.height, texture.mipLevels);
+}
+
+void addTextureFile(PackageWriter& writer, const std::string& entryName, const std::filesystem::path& path,
+                    bool compressTextures)
+{
+  const std::filesystem::path containerPath = findTextureContainerFile(path);
+  if (compressTextures && !isTextureContainerFile(containerPath))
+  {
+    const auto texture = createCompressedTexture(loadSoftwareImage(path));
+    writer.add(entryName, PackageEntryType::Texture, texture.data(), texture.size());
+    return;
+  }
+  const MappedFile file(compressTextures ? containerPath : path);
+  writer.add(entryName, PackageEntryType::Texture, file.getData(), file.getSize());
+}
+
+void addTexture(PackageWriter& writer, const std::string& entryName, const ImportedTexture& texture,
+                bool compressTextures)
+{
+  if (compressTextures && !isTextureContainer(texture.data, texture.size))
+  {
+    const auto compressedTexture = createCompressedTexture(loadSoftwareImage(texture.data, texture.size));
+    writer.add(entryName, PackageEntryType::Texture, compressedTexture.data(), compressedTexture.size());
+    return;
+  }
+  writer.add(entryName, PackageEntryType::Texture, texture.data, texture.size);
+}
+
+void checkIndex(ui32 index, size_t count, const char* what)
+{
+  if (index >= count)
+  {
+    throw std::runtime_error(std::string("The package references ") + what + " " + std::to_string(index) + " of " +
+                             std::to_string(count) + ".");
+  }
+}
+} // namespace
+
+namespace gims
+{
+void saveScenePackage(const std::filesystem::path& pathToPackage, const ImportedScene& scene,
+                      const std::filesystem::path& parentPath, bool compressTextures)
+{
+  PackageWriter writer(pathToPackage);
+
+  std::vector<ui8> nodes;
+  const ui32       nNodes = static_cast<ui32>(scene.nodes.size());
+  append(nodes, &nNodes, 1);
+  for (const auto& node : scene.nodes)
+  {
+    const ui32 counts[2] = {static_cast<ui32>(node.meshIndices.size()), static_cast<ui32>(node.childIndices.size())};
+    append(nodes, &node.transformation, 1);
+    append(nodes, counts, 2);
+    append(nodes, node.meshIndices.data(), node.meshIndices.size());
+    append(nodes, node.childIndices.data(), node.childIndices.size());
+  }
+  writer.add(nodesEntryName, PackageEntryType::SceneGraph, nodes.data(), nodes.size());
+  writer.add(materialsEntryName, PackageEntryType::Materials, scene.materials.data(),
+             scene.materials.size() * sizeof(ImportedMaterial));
+
+  for (size_t meshIdx = 0; meshIdx < scene.meshes.size(); meshIdx++)
+  {
+    const ImportedMesh& mesh   = scene.meshes[meshIdx];
+    const MeshHeader    header = {static_cast<ui32>(mesh.vertices.size()), static_cast<ui32>(mesh.indices.size()),
+                                  mesh.materialIdx, 0};
+    std::vector<ui8>    payload;
+    payload.reserve(sizeof(header) + mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(ui32));
+    append(payload, &header, 1);
+    append(payload, mesh.vertices.data(), mesh.vertices.size());
+    append(payload, mesh.indices.data(), mesh.indices.size());
+    writer.add(getMeshEntryName(meshIdx), PackageEntryType::Mesh, payload.data(), payload.size());
+  }
+
+  std::vector<std::filesystem::path> textureFiles(scene.textureFileNameToTextureIndex.size());
+  for (const auto& [textureRelativePath, textureIndex] : scene.textureFileNameToTextureIndex)
+  {
+    textureFiles.at(textureIndex - 3) = parentPath / textureRelativePath;
+  }
+  for (size_t i = 0; i < textureFiles.size(); i++)
+  {
+    addTextureFile(writer, getTextureEntryName(i), textureFiles[i], compressTextures);
+  }
+  for (size_t i = 0; i < scene.textures.size(); i++)
+  {
+    addTexture(writer, getTextureEntryName(textureFiles.size() + i), scene.textures[i], compressTextures);
+  }
+  writer.finish();
+}
+
+ImportedScene importScenePackage(const std::filesystem::path& pathToPackage)
+{
+  GIMS_PROFILE_ZONE("Import Scene Package");
+  const auto    package = std::make_shared<const PackageFile>(pathToPackage);
+  ImportedScene result;
+  result.storage = package;
+
+  for (size_t textureIdx = 0;; textureIdx++)
+  {
+    const ui32 entryIdx = package->find(getTextureEntryName(textureIdx));
+    if (entryIdx == PackageFile::invalidIdx)
+    {
+      break;
+    }
+    result.textures.push_back({package->getData(entryIdx), package->getEntries()[entryIdx].size});
+  }
+
+  PayloadReader materials(*package, materialsEntryName);
+  if (materials.getRemainingSize() % sizeof(ImportedMaterial) != 0)
+  {
+    throw std::runtime_error("The materials of the package are corrupt.");
+  }
+  result.materials.resize(materials.getRemainingSize() / sizeof(ImportedMaterial));
+  materials.read(result.materials.data(), result.materials.size());
+  for (const auto& material : result.materials)
+  {
+    for (const ui32 textureIdx : material.textureIndices)
+    {
+      checkIndex(textureIdx, result.textures.size() + 3, "texture");
+    }
+  }
+
+  for (size_t meshIdx = 0; package->find(getMeshEntryName(meshIdx)) != PackageFile::invalidIdx; meshIdx++)
+  {
+    PayloadReader    payload(*package, getMeshEntryName(meshIdx));
+    const MeshHeader header = payload.read<MeshHeader>();
+    if (payload.getRemainingSize() !=
+        static_cast<size_t>(header.nVertices) * sizeof(Vertex) + static_cast<size_t>(header.nIndices) * sizeof(ui32))
+    {
+      throw std::runtime_error("Mesh " + std::to_string(meshIdx) + " of the package is corrupt.");
+    }
+    checkIndex(header.materialIdx, result.materials.size(), "material");
+    ImportedMesh& mesh = result.meshes.emplace_back();
+    mesh.materialIdx   = header.materialIdx;
+    mesh.vertices.resize(header.nVertices);
+    mesh.indices.resize(header.nIndices);
+    payload.read(mesh.vertices.data(), mesh.vertices.size());
+    payload.read(mesh.indices.data(), mesh.indices.size());
+    for (const ui32 index : mesh.indices)
+    {
+      checkIndex(index, mesh.vertices.size(), "vertex");
+    }
+  }
+
+  PayloadReader nodes(*package, nodesEntryName);
+  result.nodes.resize(nodes.readCount(sizeof(f32m4) + 2 * sizeof(ui32)));
+  for (auto& node : result.nodes)
+  {
+    node.transformation = nodes.read<f32m4>();
+    node.meshIndices.resize(nodes.readCount(sizeof(ui32)));
+    node.childIndices.resize(nodes.readCount(sizeof(ui32)));
+    nodes.read(node.meshIndices.data(), node.meshIndices.size());
+    nodes.read(node.childIndices.data(), node.childIndices.size());
+    for (const ui32 meshIdx : node.meshIndices)
+    {
+      checkIndex(meshIdx, result.meshes.size(), "mesh");
+    }
+    for (const ui32 childIdx : node.childIndices)
+    {
+      checkIndex(childIdx, result.nodes.size(), "node");
+    }
+  }
+  if (result.nodes.empty() || nodes.getRemainingSize() != 0)
+  {
+    throw std::runtime_error("The nodes of the package are corrupt.");
+  }
+  return result;
+}
+} // namespace gims
@@ -0,0 +1,216 @@
+#include "SoftwareScene.hpp"
+#include "SceneImport.hpp"
+#include <algorithm>
+#include <assimp/scene.h>
+#include <gimslib/io/AsyncFileReader.hpp>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <gimslib/sw/TextureCompression.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+
+using namespace gims;
+
+namespace
+{
+SoftwareTexture createDefaultTexture(const ui8v4& color)
+{
+  return SoftwareTexture {1, 1, {color}, true};
+}
+
+SoftwareMesh createMesh(aiMesh const* const inputMesh)
+{
+  SoftwareMesh mesh;
+  mesh.materialIdx = inputMesh->mMaterialIndex;
+  mesh.vertices.resize(inputMesh->mNumVertices);
+  for (ui32 i = 0; i < inputMesh->mNumVertices; i++)
+  {
+    const aiVector3D& position = inputMesh->mVertices[i];
+    const aiVector3D& normal   = inputMesh->mNormals[i];
+    mesh.vertices[i].position  = f32v3(position.x, position.y, position.z);
+    mesh.vertices[i].normal    = f32v3(normal.x, normal.y, normal.z);
+    // Meshes without texture coordinates get zeros, like the vertex buffers of TriangleMeshD3D12.
+    mesh.vertices[i].textureCoordinate = f32v2(0.0f);
+    if (inputMesh->mTextureCoords[0] != nullptr)
+    {
+      mesh.vertices[i].textureCoordinate =
+          f32v2(inputMesh->mTextureCoords[0][i].x, inputMesh->mTextureCoords[0][i].y);
+    }
+  }
+  mesh.indices.reserve(inputMesh->mNumFaces * 3);
+  for (ui32 i = 0; i < inputMesh->mNumFaces; i++)
+  {
+    mesh.indices.insert(mesh.indices.end(), inputMesh->mFaces[i].mIndices, inputMesh->mFaces[i].mIndices + 3);
+  }
+  return mesh;
+}
+
+// Batches the instances of the meshes and bounds them.
+void createInstances(const std::vector<SceneNode>& nodes, SoftwareSceneGraph& result)
+{
+  result.instanceBatches = createInstanceBatches(nodes, static_cast<ui32>(result.scene.meshes.size()));
+  for (const auto& batch : result.instanceBatches.batches)
+  {
+    const SoftwareMesh& mesh = result.scene.meshes[batch.meshIdx];
+    std::vector<f32v3>  positions;
+    positions.reserve(mesh.vertices.size());
+    for (const auto& vertex : mesh.vertices)
+    {
+      positions.push_back(vertex.position);
+    }
+    const AABB meshAABB(positions.data(), static_cast<ui32>(positions.size()));
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      f32m4 transformation = result.instanceBatches.instanceTransformations[batch.firstInstance + i];
+      result.aabb          = result.aabb.getUnion(meshAABB.getTransformed(transformation));
+    }
+  }
+}
+
+// Textures in memory follow the ones in files. DDS and KTX2 files are decompressed, the rasterizer samples RGBA8 only.
+void createTextures(const std::unordered_map<std::filesystem::path, ui32>& textureFileNameToTextureIndex,
+                    const std::vector<ImportedTexture>& textures, const std::filesystem::path& parentPath,
+                    SoftwareSceneGraph& result)
+{
+  result.scene.textures.resize(textureFileNameToTextureIndex.size() + textures.size() + 3);
+  result.scene.textures[0] = createDefaultTexture(ui8v4(255, 255, 255, 255));
+  result.scene.textures[1] = createDefaultTexture(ui8v4(0, 0, 0, 255));
+  result.scene.textures[2] = createDefaultTexture(ui8v4(0, 0, 255, 255));
+  // All files are read ahead, so decoding one overlaps with reading the next ones.
+  std::vector<std::filesystem::path> paths;
+  std::vector<ui32>                  textureIndices;
+  for (const auto& [textureRelativePath, textureIndex] : textureFileNameToTextureIndex)
+  {
+    paths.push_back(parentPath / textureRelativePath);
+    textureIndices.push_back(textureIndex);
+  }
+  AsyncFileReader reader;
+  auto            files = reader.readFiles(paths);
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    const std::vector<ui8> file = files[i].get();
+    SoftwareImage          image;
+    try
+    {
+      image = loadSoftwareImage(file.data(), file.size());
+    }
+    catch (const std::runtime_error& e)
+    {
+      throw std::runtime_error(paths[i].string() + ": " + e.what());
+    }
+    result.scene.textures[textureIndices[i]] = {image.width, image.height, std::move(image.pixels), true};
+  }
+  for (size_t i = 0; i < textures.size(); i++)
+  {
+    const ImportedTexture& texture = textures[i];
+    SoftwareImage          image   = isTextureContainer(texture.data, texture.size)
+                                         ? decompressTexture(texture.data, texture.size)
+                                         : loadSoftwareImage(texture.data, texture.size);
+    result.scene.textures[textureFileNameToTextureIndex.size() + 3 + i] = {image.width, image.height,
+                                                                           std::move(image.pixels), true};
+  }
+}
+} // namespace
+
+namespace gims
+{
+SoftwareSceneGraph createSoftwareSceneGraph(aiScene const* const inputScene, const std::filesystem::path& parentPath)
+{
+  GIMS_PROFILE_ZONE("Create Software Scene");
+  SoftwareSceneGraph result;
+  {
+    GIMS_PROFILE_ZONE("Create Meshes");
+    for (ui32 i = 0; i < inputScene->mNumMeshes; i++)
+    {
+      result.scene.meshes.push_back(createMesh(inputScene->mMeshes[i]));
+    }
+  }
+
+  std::vector<SceneNode> nodes;
+  appendSceneNodes(inputScene->mRootNode, nodes);
+  createInstances(nodes, result);
+
+  {
+    GIMS_PROFILE_ZONE("Create Textures");
+    const auto textureFileNameToTextureIndex = textureFilenameToIndex(inputScene);
+    createTextures(textureFileNameToTextureIndex, {}, parentPath, result);
+
+    for (ui32 i = 0; i < inputScene->mNumMaterials; i++)
+    {
+      aiMaterial* inputMaterial = inputScene->mMaterials[i];
+      ai_real     exponent(0.0f);
+      aiGetMaterialFloat(inputMaterial, AI_MATKEY_SHININESS, &exponent);
+      const f32v4 specularColor = getColor(AI_MATKEY_COLOR_SPECULAR, inputMaterial);
+
+      SoftwareMaterial material;
+      material.emissive                 = getColor(AI_MATKEY_COLOR_EMISSIVE, inputMaterial);
+      material.ambient                  = getColor(AI_MATKEY_COLOR_AMBIENT, inputMaterial);
+      material.diffuse                  = getColor(AI_MATKEY_COLOR_DIFFUSE, inputMaterial);
+      material.specularColorAndExponent = f32v4(specularColor.x, specularColor.y, specularColor.z, exponent);
+      const aiTextureType slotTextureTypes[] = {aiTextureType_AMBIENT, aiTextureType_DIFFUSE, aiTextureType_SPECULAR,
+                                                aiTextureType_EMISSIVE};
+      for (ui32 slot = 0; slot < material.textureIndices.size(); slot++)
+      {
+        material.textureIndices[slot] = static_cast<ui32>(
+            getTexture(slotTextureTypes[slot], 0, inputMaterial, textureFileNameToTextureIndex));
+      }
+      result.scene.materials.push_back(material);
+    }
+  }
+  return result;
+}
+
+SoftwareSceneGraph createSoftwareSceneGraph(const ImportedScene& inputScene, const std::filesystem::path& parentPath)
+{
+  GIMS_PROFILE_ZONE("Create Software Scene");
+  SoftwareSceneGraph result;
+  {
+    GIMS_PROFILE_ZONE("Create Meshes");
+    for (const auto& inputMesh : inputScene.meshes)
+    {
+      SoftwareMesh mesh;
+      mesh.materialIdx = inputMesh.materialIdx;
+      mesh.indices     = inputMesh.indices;
+      mesh.vertices.reserve(inputMesh.vertices.size());
+      for (const auto& vertex : inputMesh.vertices)
+      {
+        mesh.vertices.push_back({vertex.position, vertex.normal, vertex.textureCoordinate});
+      }
+      result.scene.meshes.push_back(std::move(mesh));
+    }
+  }
+  createInstances(inputScene.nodes, result);
+
+  {
+    GIMS_PROFILE_ZONE("Create Textures");
+    createTextures(inputScene.textureFileNameToTextureIndex, inputScene.textures, parentPath, result);
+    for (const auto& inputMaterial : inputScene.materials)
+    {
+      SoftwareMaterial material;
+      material.emissive                 = inputMaterial.emissive;
+      material.ambient                  = inputMaterial.ambient;
+      material.diffuse                  = inputMaterial.diffuse;
+      material.specularColorAndExponent = inputMaterial.specularColorAndExponent;
+      std::copy_n(inputMaterial.textureIndices.begin(), material.textureIndices.size(),
+                  material.textureIndices.begin());
+      result.scene.materials.push_back(material);
+    }
+  }
+  return result;
+}
+
+std::vector<SoftwareDrawCall> createSoftwareDrawCalls(const SoftwareSceneGraph& sceneGraph,
+                                                      const f32m4&              sceneViewTransformation)
+{
+  std::vector<SoftwareDrawCall> drawCalls;
+  drawCalls.reserve(sceneGraph.instanceBatches.instanceTransformations.size());
+  for (const auto& batch : sceneGraph.instanceBatches.batches)
+  {
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      drawCalls.push_back({batch.meshIdx, sceneViewTransformation *
+                                              sceneGraph.instanceBatches.instanceTransformations[batch.firstInstance + i]});
+    }
+  }
+  return drawCalls;
+}
+} // namespace gims
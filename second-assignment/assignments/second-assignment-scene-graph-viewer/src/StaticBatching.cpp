@@ -0,0 +1,182 @@
+#include "StaticBatching.hpp"
+#include "InstanceBatching.hpp"
+#include <limits>
+#include <ostream>
+
+using namespace gims;
+
+namespace
+{
+size_t getGeometryBytes(size_t nVertices, size_t nIndices)
+{
+  return nVertices * sizeof(Vertex) + nIndices * sizeof(ui32);
+}
+
+f32m3 getNormalTransformation(const f32m4& transformation)
+{
+  return glm::transpose(glm::inverse(f32m3(transformation)));
+}
+
+bool isMirroring(const f32m4& transformation)
+{
+  return glm::determinant(f32m3(transformation)) < 0.0f;
+}
+
+/// <summary>
+/// Returns the index at position i of the triangle list, with the winding of every triangle flipped if requested.
+/// </summary>
+ui32 getIndex(const std::vector<ui32>& indices, size_t i, bool flipWinding)
+{
+  if (flipWinding && i % 3 != 0)
+  {
+    // Swap the second and third index of each triangle.
+    return indices[i % 3 == 1 ? i + 1 : i - 1];
+  }
+  return indices[i];
+}
+} // namespace
+
+namespace gims
+{
+Vertex transformVertex(const Vertex& vertex, const f32m4& transformation, const f32m3& normalTransformation)
+{
+  Vertex result            = vertex;
+  result.position          = f32v3(transformation * f32v4(vertex.position, 1.0f));
+  result.normal            = normalTransformation * vertex.normal;
+  result.tangent           = f32m3(transformation) * vertex.tangent;
+  const f32 normalLength   = glm::length(result.normal);
+  const f32 tangentLength  = glm::length(result.tangent);
+  if (normalLength > 0.0f)
+  {
+    result.normal /= normalLength;
+  }
+  if (tangentLength > 0.0f)
+  {
+    result.tangent /= tangentLength;
+  }
+  return result;
+}
+
+StaticBatches createStaticBatches(const std::vector<SceneNode>& nodes, const std::vector<StaticMeshData>& meshes,
+                                  ui32 rootNodeIdx)
+{
+  // The instance batches already hold every occurrence of every mesh together with its accumulated transformation.
+  const auto instanceBatches = createInstanceBatches(nodes, static_cast<ui32>(meshes.size()), rootNodeIdx);
+
+  StaticBatches result;
+  auto&         statistics = result.statistics;
+  statistics.nDrawCallsBefore = instanceBatches.nDrawCallsWithoutInstancing;
+
+  ui32 nMaterials = 0;
+  for (const auto& mesh : meshes)
+  {
+    nMaterials = glm::max(nMaterials, mesh.materialIndex + 1);
+  }
+  std::vector<StaticBatch> batchPerMaterial(nMaterials);
+
+  for (const auto& instanceBatch : instanceBatches.batches)
+  {
+    const StaticMeshData& mesh  = meshes[instanceBatch.meshIdx];
+    StaticBatch&          batch = batchPerMaterial[mesh.materialIndex];
+    batch.materialIndex         = mesh.materialIndex;
+
+    statistics.nVerticesBefore += static_cast<ui32>(mesh.vertices.size());
+    statistics.geometryBytesBefore += getGeometryBytes(mesh.vertices.size(), mesh.indices.size());
+
+    for (ui32 i = 0; i < instanceBatch.nInstances; i++)
+    {
+      StaticBatchRange range;
+      range.meshIdx        = instanceBatch.meshIdx;
+      range.firstVertex    = static_cast<ui32>(batch.vertices.size());
+      range.firstIndex     = static_cast<ui32>(batch.indices.size());
+      range.transformation = instanceBatches.instanceTransformations[instanceBatch.firstInstance + i];
+      batch.ranges.push_back(range);
+
+      const f32m3 normalTransformation = getNormalTransformation(range.transformation);
+      for (const auto& vertex : mesh.vertices)
+      {
+        batch.vertices.push_back(transformVertex(vertex, range.transformation, normalTransformation));
+      }
+
+      const bool flipWinding = isMirroring(range.transformation);
+      for (size_t j = 0; j < mesh.indices.size(); j++)
+      {
+        batch.indices.push_back(range.firstVertex + getIndex(mesh.indices, j, flipWinding));
+      }
+    }
+  }
+
+  for (auto& batch : batchPerMaterial)
+  {
+    if (batch.vertices.empty())
+    {
+      continue;
+    }
+    std::vector<f32v3> positions(batch.vertices.size());
+    for (size_t i = 0; i < batch.vertices.size(); i++)
+    {
+      positions[i] = batch.vertices[i].position;
+    }
+    batch.aabb = AABB(positions.data(), static_cast<ui32>(positions.size()));
+
+    statistics.nVerticesAfter += static_cast<ui32>(batch.vertices.size());
+    statistics.geometryBytesAfter += getGeometryBytes(batch.vertices.size(), batch.indices.size());
+    result.batches.push_back(std::move(batch));
+  }
+  statistics.nDrawCallsAfter = static_cast<ui32>(result.batches.size());
+  return result;
+}
+
+f32 getMaxStaticBatchingError(const StaticBatches& staticBatches, const std::vector<StaticMeshData>& meshes)
+{
+  const f32 topologyMismatch = std::numeric_limits<f32>::infinity();
+  f32       maxError         = 0.0f;
+  for (const auto& batch : staticBatches.batches)
+  {
+    for (const auto& range : batch.ranges)
+    {
+      if (range.meshIdx >= meshes.size())
+      {
+        return topologyMismatch;
+      }
+      const StaticMeshData& mesh = meshes[range.meshIdx];
+      if (mesh.materialIndex != batch.materialIndex ||
+          range.firstVertex + mesh.vertices.size() > batch.vertices.size() ||
+          range.firstIndex + mesh.indices.size() > batch.indices.size())
+      {
+        return topologyMismatch;
+      }
+
+      for (size_t i = 0; i < mesh.vertices.size(); i++)
+      {
+        const f32v3 expected = f32v3(range.transformation * f32v4(mesh.vertices[i].position, 1.0f));
+        maxError = glm::max(maxError, glm::distance(expected, batch.vertices[range.firstVertex + i].position));
+      }
+
+      const bool flipWinding = isMirroring(range.transformation);
+      for (size_t i = 0; i < mesh.indices.size(); i++)
+      {
+        if (batch.indices[range.firstIndex + i] != range.firstVertex + getIndex(mesh.indices, i, flipWinding))
+        {
+          return topologyMismatch;
+        }
+      }
+    }
+  }
+  return maxError;
+}
+
+void printStaticBatchingReport(std::ostream& stream, const StaticBatches& staticBatches)
+{
+  const auto& statistics = staticBatches.statistics;
+  stream << "Static Batching Information:\n"
+         << "----------------------------\n"
+         << "Number of Batches: " << staticBatches.batches.size() << "\n"
+         << "Draw Calls Before: " << statistics.nDrawCallsBefore << "\n"
+         << "Draw Calls After: " << statistics.nDrawCallsAfter << "\n"
+         << "Vertices Before: " << statistics.nVerticesBefore << "\n"
+         << "Vertices After: " << statistics.nVerticesAfter << "\n"
+         << "Geometry Size Before: " << statistics.geometryBytesBefore / 1024 << " KiB\n"
+         << "Geometry Size After: " << statistics.geometryBytesAfter / 1024 << " KiB" << std::endl;
+}
+} // namespace gims
@@ -0,0 +1,155 @@
+#include "StructuredBufferD3D12.hpp"
+#include <d3dx12/d3dx12.h>
+#include <gimslib/dbg/HrException.hpp>
+#include <stdexcept>
+
+namespace gims
+{
+StructuredBufferD3D12::StructuredBufferD3D12()
+    : m_elementSizeInBytes(0)
+    , m_nElements(0)
+    , m_usage(StructuredBufferUsage::Static)
+{
+}
+
+StructuredBufferD3D12::StructuredBufferD3D12(size_t elementSizeInBytes, ui32 nElements,
+                                             const ComPtr<ID3D12Device>& device, StructuredBufferUsage usage)
+    : m_elementSizeInBytes(elementSizeInBytes)
+    , m_nElements(nElements)
+    , m_usage(usage)
+{
+  if (m_elementSizeInBytes * m_nElements == 0)
+  {
+    return;
+  }
+  const CD3DX12_RESOURCE_DESC bufferDescription = CD3DX12_RESOURCE_DESC::Buffer(m_elementSizeInBytes * m_nElements);
+  if (m_usage == StructuredBufferUsage::Static)
+  {
+    const CD3DX12_HEAP_PROPERTIES uploadHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    throwIfFailed(device->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDescription,
+                                                  D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                                  IID_PPV_ARGS(&m_structuredBuffer)));
+    return;
+  }
+
+  const CD3DX12_HEAP_PROPERTIES defaultHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+  throwIfFailed(device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDescription,
+                                                D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                                IID_PPV_ARGS(&m_structuredBuffer)));
+  m_data.resize(m_elementSizeInBytes * m_nElements);
+  m_isChanged.resize(m_nElements, false);
+}
+
+void StructuredBufferD3D12::upload(void const* const data)
+{
+  if (m_elementSizeInBytes * m_nElements == 0)
+  {
+    return;
+  }
+  if (m_usage == StructuredBufferUsage::Updatable)
+  {
+    for (ui32 elementIdx = 0; elementIdx < m_nElements; elementIdx++)
+    {
+      updateElement(elementIdx, static_cast<const ui8*>(data) + elementIdx * m_elementSizeInBytes);
+    }
+    return;
+  }
+  void* p;
+  throwIfFailed(m_structuredBuffer->Map(0, nullptr, &p));
+  ::memcpy(p, data, m_elementSizeInBytes * m_nElements);
+  m_structuredBuffer->Unmap(0, nullptr);
+}
+
+void StructuredBufferD3D12::updateElement(ui32 elementIdx, void const* const data)
+{
+  if (m_usage != StructuredBufferUsage::Updatable)
+  {
+    // The GPU may still read the upload heap for frames in flight.
+    throw std::logic_error("Only updatable structured buffers can change their elements.");
+  }
+  if (elementIdx >= m_nElements)
+  {
+    throw std::out_of_range("Structured buffer element index out of range.");
+  }
+  ::memcpy(m_data.data() + elementIdx * m_elementSizeInBytes, data, m_elementSizeInBytes);
+  if (!m_isChanged[elementIdx])
+  {
+    m_isChanged[elementIdx] = true;
+    m_changedElements.push_back(elementIdx);
+  }
+}
+
+void StructuredBufferD3D12::addUpdatesToCommandList(const ComPtr<ID3D12GraphicsCommandList>& commandList,
+                                                    ui32                                      frameIdx)
+{
+  if (m_changedElements.empty())
+  {
+    return;
+  }
+
+  // Each frame gets an upload buffer with room for all records, so a frame never runs out of space.
+  const size_t sizeInBytes = m_elementSizeInBytes * m_nElements;
+  while (m_uploadBuffers.size() <= frameIdx)
+  {
+    ComPtr<ID3D12Device> device;
+    throwIfFailed(m_structuredBuffer->GetDevice(IID_PPV_ARGS(&device)));
+    const CD3DX12_HEAP_PROPERTIES uploadHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC   bufferDescription    = CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes);
+    ComPtr<ID3D12Resource>        uploadBuffer;
+    throwIfFailed(device->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDescription,
+                                                  D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                                  IID_PPV_ARGS(&uploadBuffer)));
+    const D3D12_RANGE noRead = {0, 0};
+    ui8*              p;
+    throwIfFailed(uploadBuffer->Map(0, &noRead, reinterpret_cast<void**>(&p)));
+    m_uploadBuffers.push_back(uploadBuffer);
+    m_mappedUploadBuffers.push_back(p);
+  }
+
+  // Buffers decay to the common state after each ExecuteCommandLists, so every frame starts from it.
+  const auto toCopyDestination = CD3DX12_RESOURCE_BARRIER::Transition(
+      m_structuredBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+  const auto toShaderResource = CD3DX12_RESOURCE_BARRIER::Transition(
+      m_structuredBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+  commandList->ResourceBarrier(1, &toCopyDestination);
+  ui8* const uploadData = m_mappedUploadBuffers[frameIdx];
+  if (m_changedElements.size() == m_nElements)
+  {
+    ::memcpy(uploadData, m_data.data(), sizeInBytes);
+    commandList->CopyBufferRegion(m_structuredBuffer.Get(), 0, m_uploadBuffers[frameIdx].Get(), 0, sizeInBytes);
+  }
+  else
+  {
+    // The records keep their offsets, so the copies of different records never overlap.
+    for (const ui32 elementIdx : m_changedElements)
+    {
+      const size_t offset = elementIdx * m_elementSizeInBytes;
+      ::memcpy(uploadData + offset, m_data.data() + offset, m_elementSizeInBytes);
+      commandList->CopyBufferRegion(m_structuredBuffer.Get(), offset, m_uploadBuffers[frameIdx].Get(), offset,
+                                    m_elementSizeInBytes);
+    }
+  }
+  commandList->ResourceBarrier(1, &toShaderResource);
+
+  for (const ui32 elementIdx : m_changedElements)
+  {
+    m_isChanged[elementIdx] = false;
+  }
+  m_changedElements.clear();
+}
+
+const ComPtr<ID3D12Resource>& StructuredBufferD3D12::getResource() const
+{
+  return m_structuredBuffer;
+}
+
+ui32 StructuredBufferD3D12::getNumElements() const
+{
+  return m_nElements;
+}
+
+size_t StructuredBufferD3D12::getElementSizeInBytes() const
+{
+  return m_elementSizeInBytes;
+}
+} // namespace gims
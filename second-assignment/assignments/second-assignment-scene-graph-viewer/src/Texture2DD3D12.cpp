@@ -3,19 +3,24 @@
 #include <gimslib/contrib/stb/stb_image.h>
 #include <gimslib/d3d/UploadHelper.hpp>
 #include <gimslib/dbg/HrException.hpp>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/io/TextureFile.hpp>
+#include <stdexcept>
+#include <vector>
 
 using namespace gims;
 namespace
 {
 
-ComPtr<ID3D12Resource> createTexture(void const* const data, ui32 textureWidth, ui32 textureHeight,
-                                     const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& commandQueue)
+ComPtr<ID3D12Resource> createTexture(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources, DXGI_FORMAT format,
+                                     ui32 textureWidth, ui32 textureHeight, const ComPtr<ID3D12Device>& device,
+                                     const ComPtr<ID3D12CommandQueue>& commandQueue)
 {
   ComPtr<ID3D12Resource> textureResource;
   
   D3D12_RESOURCE_DESC textureDescription = {};
-  textureDescription.MipLevels           = 1;
-  textureDescription.Format              = DXGI_FORMAT_R8G8B8A8_UNORM;
+  textureDescription.MipLevels           = static_cast<UINT16>(subresources.size());
+  textureDescription.Format              = format;
   textureDescription.Width               = textureWidth;
   textureDescription.Height              = textureHeight;
   textureDescription.Flags               = D3D12_RESOURCE_FLAG_NONE;
@@ -28,11 +33,45 @@ ComPtr<ID3D12Resource> createTexture(void const* const data, ui32 textureWidth,
   throwIfFailed(device->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &textureDescription,
                                                 D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&textureResource)));
 
-  UploadHelper uploadHelper(device, GetRequiredIntermediateSize(textureResource.Get(), 0, 1));
-  uploadHelper.uploadTexture(data, textureResource, textureWidth, textureHeight, commandQueue);
+  const ui32   nSubresources = static_cast<ui32>(subresources.size());
+  UploadHelper uploadHelper(device, GetRequiredIntermediateSize(textureResource.Get(), 0, nSubresources));
+  uploadHelper.uploadTexture(subresources.data(), nSubresources, textureResource, commandQueue);
 
   return textureResource;
 }
+
+ComPtr<ID3D12Resource> createTexture(void const* const data, ui32 textureWidth, ui32 textureHeight,
+                                     const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+  D3D12_SUBRESOURCE_DATA textureData = {};
+  textureData.pData                  = data;
+  textureData.RowPitch               = textureWidth * 4;
+  textureData.SlicePitch             = textureData.RowPitch * textureHeight;
+  return createTexture({textureData}, DXGI_FORMAT_R8G8B8A8_UNORM, textureWidth, textureHeight, device, commandQueue);
+}
+
+// Uploads the mip levels of a DDS or KTX2 file in memory as they are, and returns their format and number.
+ComPtr<ID3D12Resource> createContainerTexture(const ui8* fileData, size_t fileSize, DXGI_FORMAT& format,
+                                              ui32& nMipLevels, const ComPtr<ID3D12Device>& device,
+                                              const ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+  const TextureHeader header = readTextureHeader(fileData, fileSize);
+  if (isBlockCompressed(header.format) && (header.width % 4 != 0 || header.height % 4 != 0))
+  {
+    throw std::runtime_error("The size of a block-compressed texture must be a multiple of 4.");
+  }
+  std::vector<D3D12_SUBRESOURCE_DATA> subresources(header.mipLevels.size());
+  for (ui32 mipLevel = 0; mipLevel < subresources.size(); mipLevel++)
+  {
+    subresources[mipLevel].pData      = fileData + header.mipLevels[mipLevel].offset;
+    subresources[mipLevel].RowPitch   = header.mipLevels[mipLevel].rowPitch;
+    subresources[mipLevel].SlicePitch = header.mipLevels[mipLevel].size;
+  }
+  // TextureFormat has the values of DXGI_FORMAT.
+  format     = static_cast<DXGI_FORMAT>(getSrgbFormat(header.format));
+  nMipLevels = static_cast<ui32>(subresources.size());
+  return createTexture(subresources, format, header.width, header.height, device, commandQueue);
+}
 } // namespace
 
 namespace gims
@@ -40,6 +79,21 @@ namespace gims
 Texture2DD3D12::Texture2DD3D12(std::filesystem::path path, const ComPtr<ID3D12Device>& device,
                                const ComPtr<ID3D12CommandQueue>& commandQueue)
 {
+  if (isTextureContainerFile(path))
+  {
+    const MappedFile file(path);
+    try
+    {
+      m_textureResource =
+          createContainerTexture(file.getData(), file.getSize(), m_format, m_nMipLevels, device, commandQueue);
+    }
+    catch (const std::runtime_error& e)
+    {
+      throw std::runtime_error(path.string() + ": " + e.what());
+    }
+    return;
+  }
+
   const auto fileName     = path.generic_string();
   const auto fileNameCStr = fileName.c_str();
   i32        textureWidth, textureHeight, textureComp;
@@ -53,6 +107,28 @@ Texture2DD3D12::Texture2DD3D12(std::filesystem::path path, const ComPtr<ID3D12De
 
   m_textureResource = createTexture(image.get(), textureWidth, textureHeight, device, commandQueue);
 }
+
+Texture2DD3D12::Texture2DD3D12(const ui8* fileData, size_t fileSize, const ComPtr<ID3D12Device>& device,
+                               const ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+  if (isTextureContainer(fileData, fileSize))
+  {
+    m_textureResource = createContainerTexture(fileData, fileSize, m_format, m_nMipLevels, device, commandQueue);
+    return;
+  }
+
+  i32                                   textureWidth, textureHeight, textureComp;
+  std::unique_ptr<ui8, void (*)(void*)> image(stbi_load_from_memory(fileData, static_cast<i32>(fileSize), &textureWidth,
+                                                                    &textureHeight, &textureComp, 4),
+                                              &stbi_image_free);
+  if (image.get() == nullptr)
+  {
+    throw std::exception("Error loading texture.");
+  }
+
+  m_textureResource = createTexture(image.get(), textureWidth, textureHeight, device, commandQueue);
+}
+
 Texture2DD3D12::Texture2DD3D12(ui8v4 const* const data, ui32 width, ui32 height, const ComPtr<ID3D12Device>& device,
                                const ComPtr<ID3D12CommandQueue>& commandQueue)
 
@@ -67,8 +143,8 @@ void Texture2DD3D12::addToDescriptorHeap(const ComPtr<ID3D12Device>&         dev
   D3D12_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescription = {};
   shaderResourceViewDescription.ViewDimension                   = D3D12_SRV_DIMENSION_TEXTURE2D;
   shaderResourceViewDescription.Shader4ComponentMapping         = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-  shaderResourceViewDescription.Format                          = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-  shaderResourceViewDescription.Texture2D.MipLevels             = 1;
+  shaderResourceViewDescription.Format                          = m_format;
+  shaderResourceViewDescription.Texture2D.MipLevels             = m_nMipLevels;
   shaderResourceViewDescription.Texture2D.MostDetailedMip       = 0;
   shaderResourceViewDescription.Texture2D.ResourceMinLODClamp = 0.0f;
 
@@ -30,7 +30,28 @@ TriangleMeshD3D12::TriangleMeshD3D12(f32v3 const* const positions, f32v3 const*
   uploadIndexBufferOnGPU(device, commandQueue);
 }
 
-void TriangleMeshD3D12::addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 pipelineState) const
+TriangleMeshD3D12::TriangleMeshD3D12(Vertex const* const vertices, ui32 nVertices, ui32 const* const indexBuffer,
+                                     ui32 nIndices, ui32 materialIndex, const ComPtr<ID3D12Device>& device,
+                                     const ComPtr<ID3D12CommandQueue>& commandQueue)
+    : m_nIndices(nIndices)
+    , m_vertexBufferSize(static_cast<ui32>(nVertices * sizeof(Vertex)))
+    , m_indexBufferSize(static_cast<ui32>(nIndices * sizeof(ui32)))
+    , m_materialIndex(materialIndex)
+    , m_vertexBufferOnCPU(vertices, vertices + nVertices)
+    , m_indexBufferOnCPU(indexBuffer, indexBuffer + nIndices)
+{
+  std::vector<f32v3> positions(nVertices);
+  for (ui32 i = 0; i < nVertices; i++)
+  {
+    positions[i] = vertices[i].position;
+  }
+  m_aabb = AABB(positions.data(), nVertices);
+  uploadVertexBuffOnGPU(device, commandQueue);
+  uploadIndexBufferOnGPU(device, commandQueue);
+}
+
+void TriangleMeshD3D12::addToCommandList(const ComPtr<ID3D12GraphicsCommandList6>& commandList, ui32 pipelineState,
+                                         ui32 nInstances) const
 {
   if (pipelineState == 1)
   {
@@ -42,7 +63,7 @@ void TriangleMeshD3D12::addToCommandList(const ComPtr<ID3D12GraphicsCommandList6
     // Assignment 2
     commandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
     commandList->IASetIndexBuffer(&m_indexBufferView);
-    commandList->DrawIndexedInstanced(m_nIndices, 1, 0, 0, 0);
+    commandList->DrawIndexedInstanced(m_nIndices, nInstances, 0, 0, 0);
   }
 
 }
@@ -57,6 +78,31 @@ const ui32 TriangleMeshD3D12::getMaterialIndex() const
   return m_materialIndex;
 }
 
+const D3D12_VERTEX_BUFFER_VIEW& TriangleMeshD3D12::getVertexBufferView() const
+{
+  return m_vertexBufferView;
+}
+
+const D3D12_INDEX_BUFFER_VIEW& TriangleMeshD3D12::getIndexBufferView() const
+{
+  return m_indexBufferView;
+}
+
+ui32 TriangleMeshD3D12::getNumberOfIndices() const
+{
+  return m_nIndices;
+}
+
+const std::vector<Vertex>& TriangleMeshD3D12::getVertices() const
+{
+  return m_vertexBufferOnCPU;
+}
+
+const std::vector<ui32>& TriangleMeshD3D12::getIndices() const
+{
+  return m_indexBufferOnCPU;
+}
+
 const std::vector<D3D12_INPUT_ELEMENT_DESC>& TriangleMeshD3D12::getInputElementDescriptors()
 {
   return m_inputElementDescs;
@@ -135,7 +181,8 @@ void TriangleMeshD3D12::uploadIndexBufferOnGPU(const ComPtr<ID3D12Device>&
   m_indexBufferView.SizeInBytes    = ui32(m_indexBufferSize);
   m_indexBufferView.Format         = DXGI_FORMAT_R32_UINT;
 
-  indexBufferUploader.uploadBuffer(m_indexBufferOnCPU.data(), m_indexBuffer, m_indexBufferSize, commandQueue);
+  indexBufferUploader.uploadBuffer(m_indexBufferOnCPU.data(), m_indexBuffer, m_indexBufferSize, commandQueue,
+                                   D3D12_RESOURCE_STATE_INDEX_BUFFER);
 }
 
 } // namespace gims
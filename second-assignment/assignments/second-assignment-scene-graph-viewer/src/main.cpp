@@ -2,22 +2,53 @@
 #include <gimslib/d3d/DX12Util.hpp>
 #include <gimslib/types.hpp>
 #include <iostream>
+#include <string>
 
 using namespace gims;
 
-int main(int /* argc*/, char /* **argv */)
+int main(int argc, char** argv)
 {
   gims::DX12AppConfig config;
   config.useVSync = false;
   config.debug    = true;
   config.title    = L"Scene Graph Viewer";
+
+  // The camera and the occlusion culling run on their own thread, while the previous frame is drawn and presented.
+  config.useUpdateThread = true;
   try
   {
+    // --benchmark replays a path recorded with "Record Camera Path" and quits after writing benchmark.json.
+    for (int i = 1; i < argc; i++)
+    {
+      const std::string argument = argv[i];
+      if (argument == "--benchmark" && i + 1 < argc)
+      {
+        config.benchmarkCameraPath = argv[++i];
+      }
+      else if (argument == "--frames" && i + 1 < argc)
+      {
+        config.benchmarkFrames = static_cast<ui32>(std::stoul(argv[++i]));
+      }
+      else if (argument == "--warm-up" && i + 1 < argc)
+      {
+        config.benchmarkWarmUpFrames = static_cast<ui32>(std::stoul(argv[++i]));
+      }
+      else
+      {
+        throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                    " [--benchmark <camera path> [--frames <n>] [--warm-up <n>]]");
+      }
+    }
+
     const std::filesystem::path path = "../../../data/NobleCraftsman/scene.gltf";
 
     // Be careful! Number of threads and also conditions inside the mesh and compute shaders must be adjusted!
     // const std::filesystem::path path = "../../../data/CityScene/scene.gltf";
 
+    // Packages written by the scene-packer tool are loaded from a single mapped file, e.g.,
+    // "../../../data/CityScene/scene.gpak".
+
+    // Pass true as third argument to merge the static geometry per material at load time.
     SceneGraphViewerApp app(config, path);
     app.run();
   }
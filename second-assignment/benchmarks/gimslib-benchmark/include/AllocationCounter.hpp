@@ -0,0 +1,22 @@
+#pragma once
+#include <gimslib/types.hpp>
+
+namespace gims
+{
+//! \brief Allocations of all threads since the process started.
+struct AllocationCount
+{
+  ui64 nAllocations;
+  ui64 nBytes;
+  ui64 nLiveBytes; //! Allocated and not yet deleted.
+  ui64 nPeakBytes; //! Most live bytes since the last resetPeakAllocatedBytes().
+};
+
+//! \brief Returns the allocations made with operator new, which the benchmark executable replaces to count them.
+//! Allocations with malloc, e.g., by stb_image, and with over-aligned operator new are not counted, neither are files
+//! mapped into memory.
+AllocationCount getAllocationCount();
+
+//! \brief Sets the peak to the bytes that are live now, to measure the peak of the following code.
+void resetPeakAllocatedBytes();
+} // namespace gims
@@ -0,0 +1,67 @@
+#pragma once
+#include <MicroBenchmark.hpp>
+#include <gimslib/types.hpp>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief Median of the times of a benchmark, with a confidence interval of about 95%.
+//!
+//! The interval is bounded by two of the times, whose ranks follow from the binomial distribution, so it holds for
+//! any distribution of the times, e.g., with the long tail of a preempted thread.
+struct MedianEstimate
+{
+  f64 median;
+  f64 lower;
+  f64 upper;
+};
+
+//! \brief Estimates the median of the times.
+//! \return All zero if there are no times. With fewer than 6 times, the interval spans all of them.
+MedianEstimate estimateMedian(std::vector<f64> milliseconds);
+
+//! \brief Times of a benchmark of an earlier run.
+struct BaselineResult
+{
+  std::string      name;
+  std::vector<f64> milliseconds; //! Per iteration.
+};
+
+//! \brief Reads the results that MicroBenchmarkRunner::writeJson wrote, e.g., a baseline in the repository.
+//! \throws std::runtime_error If the stream is not such JSON.
+std::vector<BaselineResult> readBaselineJson(std::istream& stream);
+
+enum class BaselineVerdict
+{
+  Unchanged,  //! The intervals overlap.
+  Faster,     //! The interval of the run is below the one of the baseline.
+  Slower,     //! The interval of the run is above the one of the baseline, by less than the allowed slowdown.
+  Regression, //! As Slower, but the median is slower by more than the allowed slowdown.
+  New,        //! Only in the run.
+  Missing     //! Only in the baseline, e.g., when the run was filtered.
+};
+
+//! \brief A benchmark of a run compared with the baseline.
+struct BaselineComparison
+{
+  std::string     name;
+  MedianEstimate  baseline; //! All zero for BaselineVerdict::New.
+  MedianEstimate  current;  //! All zero for BaselineVerdict::Missing.
+  f64             change;   //! Relative change of the median, e.g., 0.1 if it takes 10% longer.
+  BaselineVerdict verdict;
+};
+
+//! \brief Compares the benchmarks of a run with the baseline, in the order of the run, followed by the missing ones.
+//! \param maxSlowdown Relative slowdown of the median that is still accepted, e.g., 0.1 for 10%.
+std::vector<BaselineComparison> compareWithBaseline(const std::vector<BaselineResult>&       baseline,
+                                                    const std::vector<MicroBenchmarkResult>& results, f64 maxSlowdown);
+
+//! \brief Returns the number of benchmarks with BaselineVerdict::Regression.
+ui32 countRegressions(const std::vector<BaselineComparison>& comparisons);
+
+//! \brief Writes one line per benchmark, with the medians, their intervals and the verdict.
+void writeBaselineComparisonTable(std::ostream& stream, const std::vector<BaselineComparison>& comparisons);
+} // namespace gims
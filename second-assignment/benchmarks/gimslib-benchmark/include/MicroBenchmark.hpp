@@ -0,0 +1,71 @@
+#pragma once
+#include <functional>
+#include <gimslib/sys/Benchmark.hpp>
+#include <gimslib/types.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief A result of a benchmark besides its time, e.g., the fraction of the objects a culling method rejects.
+struct BenchmarkMetric
+{
+  std::string name;
+  f64         value;
+};
+
+//! \brief Work of one iteration of a benchmark, for its throughput. Either may be 0 if it does not apply.
+struct BenchmarkWork
+{
+  ui64                         nBytes;       //! E.g., of the file that is read.
+  ui64                         nItems;       //! E.g., triangles or pixels.
+  std::vector<BenchmarkMetric> metrics = {}; //! Reported as they are, most benchmarks have none.
+};
+
+//! \brief Times and allocations of a benchmark, per iteration.
+struct MicroBenchmarkResult
+{
+  std::string      name;
+  std::string      itemName;           //! Unit of BenchmarkWork::nItems, e.g., "triangles".
+  std::vector<f64> milliseconds;       //! Per iteration.
+  TimeSummary      times;              //! Of the iterations.
+  BenchmarkWork    work;               //! Of the last iteration.
+  f64              nAllocations;       //! Average over the iterations.
+  f64              nAllocatedBytes;    //! Average over the iterations.
+  f64              nPeakBytes;         //! Most bytes the iterations had allocated at once, beyond those live before.
+  f64              megabytesPerSecond; //! Of the median time.
+  f64              itemsPerSecond;     //! Of the median time.
+};
+
+//! \brief Runs benchmarks for a fixed number of iterations after a warm-up iteration, and reports the distribution of
+//! their times, their throughput and their allocations.
+class MicroBenchmarkRunner
+{
+public:
+  //! \param nIterations Measured iterations per benchmark.
+  //! \param filter Only benchmarks whose name contains it run, all if it is empty.
+  //! \throws std::invalid_argument If nIterations is 0.
+  MicroBenchmarkRunner(ui32 nIterations, const std::string& filter);
+
+  //! \brief Runs a benchmark, unless the filter skips it. Exceptions of the iterations are passed on.
+  //! \param iteration Does the work once and returns its size.
+  void run(const std::string& name, const std::string& itemName, const std::function<BenchmarkWork()>& iteration);
+
+  //! \brief Returns true if the filter lets a benchmark run, e.g., to skip an expensive setup.
+  bool isSelected(const std::string& name) const;
+
+  const std::vector<MicroBenchmarkResult>& getResults() const;
+
+  //! \brief Writes one line per benchmark.
+  void writeTable(std::ostream& stream) const;
+
+  //! \brief Writes the results with all statistics, e.g., to compare them with an earlier run.
+  void writeJson(std::ostream& stream) const;
+
+private:
+  ui32                              m_nIterations;
+  std::string                       m_filter;
+  std::vector<MicroBenchmarkResult> m_results;
+};
+} // namespace gims
@@ -0,0 +1,71 @@
+#include <AllocationCounter.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<gims::ui64> g_nAllocations(0);
+std::atomic<gims::ui64> g_nAllocatedBytes(0);
+std::atomic<gims::ui64> g_nLiveBytes(0);
+std::atomic<gims::ui64> g_nPeakBytes(0);
+
+// Each allocation starts with its size, so deleting it can subtract the size from the live bytes. The header keeps the
+// alignment malloc guarantees.
+const std::size_t headerSize = alignof(std::max_align_t);
+
+void updatePeak(gims::ui64 nLiveBytes)
+{
+  gims::ui64 nPeakBytes = g_nPeakBytes.load(std::memory_order_relaxed);
+  while (nLiveBytes > nPeakBytes &&
+         !g_nPeakBytes.compare_exchange_weak(nPeakBytes, nLiveBytes, std::memory_order_relaxed))
+  {
+  }
+}
+} // namespace
+
+// The array and nothrow forms of the standard library call these, so replacing them counts all of them.
+void* operator new(std::size_t size)
+{
+  g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+  g_nAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  void* result = std::malloc(headerSize + size);
+  if (!result)
+  {
+    throw std::bad_alloc();
+  }
+  *static_cast<std::size_t*>(result) = size;
+  updatePeak(g_nLiveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+  return static_cast<char*>(result) + headerSize;
+}
+
+void operator delete(void* pointer) noexcept
+{
+  if (pointer == nullptr)
+  {
+    return;
+  }
+  void* allocation = static_cast<char*>(pointer) - headerSize;
+  g_nLiveBytes.fetch_sub(*static_cast<std::size_t*>(allocation), std::memory_order_relaxed);
+  std::free(allocation);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+namespace gims
+{
+AllocationCount getAllocationCount()
+{
+  return {g_nAllocations.load(std::memory_order_relaxed), g_nAllocatedBytes.load(std::memory_order_relaxed),
+          g_nLiveBytes.load(std::memory_order_relaxed), g_nPeakBytes.load(std::memory_order_relaxed)};
+}
+
+void resetPeakAllocatedBytes()
+{
+  g_nPeakBytes.store(g_nLiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+} // namespace gims
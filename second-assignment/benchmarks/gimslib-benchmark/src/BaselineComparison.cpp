@@ -0,0 +1,178 @@
+#include <BaselineComparison.hpp>
+#include <algorithm>
+#include <cmath>
+#include <gimslib/io/Json.hpp>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+const char* getVerdictName(BaselineVerdict verdict)
+{
+  switch (verdict)
+  {
+  case BaselineVerdict::Unchanged:
+    return "unchanged";
+  case BaselineVerdict::Faster:
+    return "faster";
+  case BaselineVerdict::Slower:
+    return "slower";
+  case BaselineVerdict::Regression:
+    return "REGRESSION";
+  case BaselineVerdict::New:
+    return "new";
+  case BaselineVerdict::Missing:
+    return "missing";
+  }
+  return "";
+}
+
+BaselineVerdict getVerdict(const MedianEstimate& baseline, const MedianEstimate& current, f64 change, f64 maxSlowdown)
+{
+  if (current.upper < baseline.lower)
+  {
+    return BaselineVerdict::Faster;
+  }
+  if (current.lower > baseline.upper)
+  {
+    return change > maxSlowdown ? BaselineVerdict::Regression : BaselineVerdict::Slower;
+  }
+  return BaselineVerdict::Unchanged;
+}
+} // namespace
+
+namespace gims
+{
+MedianEstimate estimateMedian(std::vector<f64> milliseconds)
+{
+  if (milliseconds.empty())
+  {
+    return {0.0, 0.0, 0.0};
+  }
+  std::sort(milliseconds.begin(), milliseconds.end());
+  const size_t n      = milliseconds.size();
+  const f64    median = n % 2 == 1 ? milliseconds[n / 2] : 0.5 * (milliseconds[n / 2 - 1] + milliseconds[n / 2]);
+
+  // The number of times below the median is binomial with p = 0.5, approximated by a normal distribution. The ranks
+  // are one-based and rounded outwards, so the interval is rather too wide than too narrow.
+  const f64    halfWidth = 1.96 * 0.5 * std::sqrt(static_cast<f64>(n));
+  const size_t lowerRank =
+      static_cast<size_t>(std::max(1.0, std::floor(0.5 * static_cast<f64>(n) - halfWidth)));
+  const size_t upperRank = static_cast<size_t>(
+      std::min(static_cast<f64>(n), std::ceil(0.5 * static_cast<f64>(n) + 1.0 + halfWidth)));
+  return {median, milliseconds[lowerRank - 1], milliseconds[upperRank - 1]};
+}
+
+std::vector<BaselineResult> readBaselineJson(std::istream& stream)
+{
+  const std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+  JsonValue         document;
+  try
+  {
+    document = JsonValue::parse(text);
+  }
+  catch (const std::runtime_error& e)
+  {
+    throw std::runtime_error(std::string("The benchmark JSON is malformed. ") + e.what());
+  }
+  // Members the comparison does not need are ignored, so baselines stay readable when results get more statistics.
+  std::vector<BaselineResult> results;
+  for (const auto& benchmark : document["benchmarks"].getElements())
+  {
+    BaselineResult result;
+    result.name = benchmark["name"].getString();
+    for (const auto& milliseconds : benchmark["milliseconds"].getElements())
+    {
+      result.milliseconds.push_back(milliseconds.getNumber());
+    }
+    if (result.name.empty() || result.milliseconds.empty())
+    {
+      throw std::runtime_error("A benchmark of the JSON has no name or no times.");
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
+std::vector<BaselineComparison> compareWithBaseline(const std::vector<BaselineResult>&       baseline,
+                                                    const std::vector<MicroBenchmarkResult>& results, f64 maxSlowdown)
+{
+  const MedianEstimate            none = {0.0, 0.0, 0.0};
+  std::vector<BaselineComparison> comparisons;
+  for (const auto& result : results)
+  {
+    const auto baselineResult = std::find_if(baseline.begin(), baseline.end(),
+                                             [&](const BaselineResult& b) { return b.name == result.name; });
+    const MedianEstimate current = estimateMedian(result.milliseconds);
+    if (baselineResult == baseline.end())
+    {
+      comparisons.push_back({result.name, none, current, 0.0, BaselineVerdict::New});
+      continue;
+    }
+    const MedianEstimate baselineEstimate = estimateMedian(baselineResult->milliseconds);
+    const f64 change = baselineEstimate.median > 0.0 ? current.median / baselineEstimate.median - 1.0 : 0.0;
+    comparisons.push_back(
+        {result.name, baselineEstimate, current, change, getVerdict(baselineEstimate, current, change, maxSlowdown)});
+  }
+  for (const auto& baselineResult : baseline)
+  {
+    if (std::none_of(results.begin(), results.end(),
+                     [&](const MicroBenchmarkResult& r) { return r.name == baselineResult.name; }))
+    {
+      comparisons.push_back(
+          {baselineResult.name, estimateMedian(baselineResult.milliseconds), none, 0.0, BaselineVerdict::Missing});
+    }
+  }
+  return comparisons;
+}
+
+ui32 countRegressions(const std::vector<BaselineComparison>& comparisons)
+{
+  return static_cast<ui32>(std::count_if(comparisons.begin(), comparisons.end(), [](const BaselineComparison& c)
+                                         { return c.verdict == BaselineVerdict::Regression; }));
+}
+
+void writeBaselineComparisonTable(std::ostream& stream, const std::vector<BaselineComparison>& comparisons)
+{
+  const auto flags     = stream.flags();
+  const auto precision = stream.precision();
+  stream << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(12) << "Base p50" << std::setw(24)
+         << "Base 95% CI" << std::setw(12) << "Run p50" << std::setw(24) << "Run 95% CI" << std::setw(10) << "Change"
+         << "  Verdict\n";
+  stream << std::fixed << std::setprecision(3);
+  for (const auto& comparison : comparisons)
+  {
+    const auto writeEstimate = [&](const MedianEstimate& estimate, bool exists)
+    {
+      if (!exists)
+      {
+        stream << std::setw(12) << "-" << std::setw(24) << "-";
+        return;
+      }
+      std::ostringstream interval;
+      interval << std::fixed << std::setprecision(3) << "[" << estimate.lower << ", " << estimate.upper << "]";
+      stream << std::setw(12) << estimate.median << std::setw(24) << interval.str();
+    };
+    stream << std::left << std::setw(48) << comparison.name << std::right;
+    writeEstimate(comparison.baseline, comparison.verdict != BaselineVerdict::New);
+    writeEstimate(comparison.current, comparison.verdict != BaselineVerdict::Missing);
+    if (comparison.verdict == BaselineVerdict::New || comparison.verdict == BaselineVerdict::Missing)
+    {
+      stream << std::setw(10) << "-";
+    }
+    else
+    {
+      std::ostringstream change;
+      change << std::fixed << std::setprecision(1) << std::showpos << comparison.change * 100.0 << "%";
+      stream << std::setw(10) << change.str();
+    }
+    stream << "  " << getVerdictName(comparison.verdict) << "\n";
+  }
+  stream.flags(flags);
+  stream.precision(precision);
+}
+} // namespace gims
@@ -0,0 +1,146 @@
+#include <AllocationCounter.hpp>
+#include <MicroBenchmark.hpp>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+void writeJsonString(std::ostream& stream, const std::string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\';
+    }
+    stream << (static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+  }
+  stream << '"';
+}
+} // namespace
+
+namespace gims
+{
+MicroBenchmarkRunner::MicroBenchmarkRunner(ui32 nIterations, const std::string& filter)
+    : m_nIterations(nIterations)
+    , m_filter(filter)
+{
+  if (nIterations == 0)
+  {
+    throw std::invalid_argument("A benchmark needs at least one iteration.");
+  }
+}
+
+void MicroBenchmarkRunner::run(const std::string& name, const std::string& itemName,
+                               const std::function<BenchmarkWork()>& iteration)
+{
+  if (!isSelected(name))
+  {
+    return;
+  }
+
+  // The warm-up fills the file cache and the allocator's free lists, as a long running app would have.
+  MicroBenchmarkResult result;
+  result.name     = name;
+  result.itemName = itemName;
+  result.work     = iteration();
+
+  // The times are reserved up front, so only the iterations allocate in between.
+  result.milliseconds.reserve(m_nIterations);
+  resetPeakAllocatedBytes();
+  const AllocationCount allocationsBefore = getAllocationCount();
+  for (ui32 i = 0; i < m_nIterations; i++)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    result.work      = iteration();
+    const auto end   = std::chrono::steady_clock::now();
+    result.milliseconds.push_back(std::chrono::duration<f64, std::milli>(end - start).count());
+  }
+  const AllocationCount allocationsAfter = getAllocationCount();
+
+  const f64  nIterations  = static_cast<f64>(m_nIterations);
+  const ui64 nAllocations = allocationsAfter.nAllocations - allocationsBefore.nAllocations;
+  result.times           = summarizeTimes(result.milliseconds);
+  result.nAllocations    = static_cast<f64>(nAllocations) / nIterations;
+  result.nAllocatedBytes = static_cast<f64>(allocationsAfter.nBytes - allocationsBefore.nBytes) / nIterations;
+  result.nPeakBytes      = static_cast<f64>(allocationsAfter.nPeakBytes - allocationsBefore.nLiveBytes);
+
+  const f64 seconds         = result.times.p50 / 1000.0;
+  result.megabytesPerSecond = seconds > 0.0 ? static_cast<f64>(result.work.nBytes) / (1024.0 * 1024.0) / seconds : 0.0;
+  result.itemsPerSecond     = seconds > 0.0 ? static_cast<f64>(result.work.nItems) / seconds : 0.0;
+  m_results.push_back(result);
+}
+
+bool MicroBenchmarkRunner::isSelected(const std::string& name) const
+{
+  return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+const std::vector<MicroBenchmarkResult>& MicroBenchmarkRunner::getResults() const
+{
+  return m_results;
+}
+
+void MicroBenchmarkRunner::writeTable(std::ostream& stream) const
+{
+  const auto flags     = stream.flags();
+  const auto precision = stream.precision();
+  stream << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(12) << "p50 ms" << std::setw(12)
+         << "p95 ms" << std::setw(12) << "MB/s" << std::setw(14) << "Items/s" << std::setw(14) << "Allocs/iter"
+         << std::setw(14) << "KB/iter" << std::setw(14) << "Peak KB" << "\n";
+  stream << std::fixed;
+  for (const auto& result : m_results)
+  {
+    stream << std::left << std::setw(48) << result.name << std::right << std::setprecision(3) << std::setw(12)
+           << result.times.p50 << std::setw(12) << result.times.p95 << std::setprecision(1) << std::setw(12)
+           << result.megabytesPerSecond << std::setprecision(0) << std::setw(14) << result.itemsPerSecond
+           << std::setw(14) << result.nAllocations << std::setw(14) << result.nAllocatedBytes / 1024.0 << std::setw(14)
+           << result.nPeakBytes / 1024.0 << "  " << result.itemName;
+    stream << std::setprecision(3);
+    for (const auto& metric : result.work.metrics)
+    {
+      stream << "  " << metric.name << " " << metric.value;
+    }
+    stream << "\n";
+  }
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+void MicroBenchmarkRunner::writeJson(std::ostream& stream) const
+{
+  stream << "{\"iterations\":" << m_nIterations << ",\"benchmarks\":[";
+  for (size_t i = 0; i < m_results.size(); i++)
+  {
+    const auto& result = m_results[i];
+    stream << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    writeJsonString(stream, result.name);
+    stream << ",\"items\":";
+    writeJsonString(stream, result.itemName);
+    stream << ",\"bytesPerIteration\":" << result.work.nBytes << ",\"itemsPerIteration\":" << result.work.nItems
+           << ",\"p50\":" << result.times.p50 << ",\"p95\":" << result.times.p95 << ",\"p99\":" << result.times.p99
+           << ",\"mean\":" << result.times.mean << ",\"min\":" << result.times.min << ",\"max\":" << result.times.max
+           << ",\"megabytesPerSecond\":" << result.megabytesPerSecond << ",\"itemsPerSecond\":"
+           << result.itemsPerSecond << ",\"allocations\":" << result.nAllocations
+           << ",\"allocatedBytes\":" << result.nAllocatedBytes << ",\"peakBytes\":" << result.nPeakBytes
+           << ",\"metrics\":{";
+    for (size_t j = 0; j < result.work.metrics.size(); j++)
+    {
+      stream << (j == 0 ? "" : ",");
+      writeJsonString(stream, result.work.metrics[j].name);
+      stream << ":" << result.work.metrics[j].value;
+    }
+    stream << "},\"milliseconds\":[";
+    for (size_t j = 0; j < result.milliseconds.size(); j++)
+    {
+      stream << (j == 0 ? "" : ",") << result.milliseconds[j];
+    }
+    stream << "]}";
+  }
+  stream << "\n]}\n";
+}
+} // namespace gims
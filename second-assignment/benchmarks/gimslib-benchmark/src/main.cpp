@@ -0,0 +1,898 @@
+#include <AABB.hpp>
+#include <BaselineComparison.hpp>
+#include <GltfImport.hpp>
+#include <InstanceBatching.hpp>
+#include <MicroBenchmark.hpp>
+#include <OcclusionCulling.hpp>
+#include <SceneImport.hpp>
+#include <ScenePackage.hpp>
+#include <SoftwareScene.hpp>
+#include <StaticBatching.hpp>
+#include <algorithm>
+#include <cstring>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <filesystem>
+#include <fstream>
+#include <gimslib/contrib/stb/stb_image.h>
+#include <gimslib/io/AsyncFileReader.hpp>
+#include <gimslib/io/CameraPath.hpp>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sw/RayCasting.hpp>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <gimslib/sw/TextureCompression.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <gimslib/ui/ExaminerController.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace gims;
+
+namespace
+{
+struct Arguments
+{
+  std::filesystem::path dataDirectory = GIMS_BENCHMARK_DATA_DIRECTORY;
+  ui32                  nIterations   = 10;
+  std::string           filter;
+  std::filesystem::path jsonPath;
+  std::filesystem::path baselinePath;       //! Results of an earlier run to compare with, if set.
+  f64                   maxSlowdown = 0.1; //! Relative slowdown of a median that is not yet a regression.
+};
+
+Arguments parseArguments(int argc, char** argv)
+{
+  Arguments arguments;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--data" && i + 1 < argc)
+    {
+      arguments.dataDirectory = argv[++i];
+    }
+    else if (argument == "--iterations" && i + 1 < argc)
+    {
+      arguments.nIterations = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--filter" && i + 1 < argc)
+    {
+      arguments.filter = argv[++i];
+    }
+    else if (argument == "--json" && i + 1 < argc)
+    {
+      arguments.jsonPath = argv[++i];
+    }
+    else if (argument == "--baseline" && i + 1 < argc)
+    {
+      arguments.baselinePath = argv[++i];
+    }
+    else if (argument == "--max-slowdown" && i + 1 < argc)
+    {
+      arguments.maxSlowdown = std::stod(argv[++i]) / 100.0;
+    }
+    else
+    {
+      throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                  " [--data <directory>] [--iterations <n>] [--filter <text>] [--json <path>]"
+                                  " [--baseline <path> [--max-slowdown <percent>]]");
+    }
+  }
+  return arguments;
+}
+
+std::vector<ui8> readFile(const std::filesystem::path& path)
+{
+  // One read into a buffer of the file's size, like the fread of stbi_load, instead of copying it byte by byte.
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+  std::vector<ui8> result(static_cast<size_t>(stream.tellg()));
+  stream.seekg(0);
+  if (!stream.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size())))
+  {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+  return result;
+}
+
+// Scenes are the directories of the data directory with a scene.gltf, in a fixed order.
+std::vector<std::filesystem::path> findScenes(const std::filesystem::path& dataDirectory)
+{
+  std::vector<std::filesystem::path> result;
+  for (const auto& entry : std::filesystem::directory_iterator(dataDirectory))
+  {
+    if (entry.is_directory() && std::filesystem::exists(entry.path() / "scene.gltf"))
+    {
+      result.push_back(entry.path() / "scene.gltf");
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<std::filesystem::path> findImages(const std::filesystem::path& directory)
+{
+  std::vector<std::filesystem::path> result;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+  {
+    auto extension = entry.path().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+    if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg"))
+    {
+      result.push_back(entry.path());
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void addMeshBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& meshPath)
+{
+  const std::string name     = meshPath.filename().string();
+  const ui64        nBytes   = std::filesystem::file_size(meshPath);
+  const auto        savePath = std::filesystem::temp_directory_path() / "gimslib-benchmark.cbm";
+
+  CograBinaryMeshFile mesh(meshPath.string());
+  runner.run("CBM Load " + name, "triangles",
+             [&]()
+             {
+               CograBinaryMeshFile loadedMesh(meshPath.string());
+               return BenchmarkWork {nBytes, loadedMesh.getNumTriangles()};
+             });
+  runner.run("CBM Save " + name, "triangles",
+             [&]()
+             {
+               mesh.save(savePath.string());
+               return BenchmarkWork {nBytes, mesh.getNumTriangles()};
+             });
+  std::filesystem::remove(savePath);
+
+  const auto* positions = reinterpret_cast<const f32v3*>(mesh.getPositionsPtr());
+  runner.run("AABB " + name, "vertices",
+             [&]()
+             {
+               const AABB aabb(positions, mesh.getNumVertices());
+               // Keeps the loop from being optimized away.
+               if (aabb.getLowerLeftBottom().x > aabb.getUpperRightTop().x)
+               {
+                 throw std::logic_error("The bounding box of " + name + " is empty.");
+               }
+               return BenchmarkWork {mesh.getNumVertices() * sizeof(f32v3), mesh.getNumVertices()};
+             });
+}
+
+void addSceneBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& scenePath)
+{
+  const std::string name = scenePath.parent_path().filename().string();
+
+  ui64 nVertices = 0;
+  runner.run("Scene Import " + name, "vertices",
+             [&]()
+             {
+               Assimp::Importer importer;
+               const aiScene*   inputScene = importAssimpScene(importer, scenePath);
+               nVertices                   = 0;
+               for (ui32 i = 0; i < inputScene->mNumMeshes; i++)
+               {
+                 nVertices += inputScene->mMeshes[i]->mNumVertices;
+               }
+               return BenchmarkWork {0, nVertices};
+             });
+
+  // Reads the buffers through memory mappings into the final vertex layout, compare with Scene Import.
+  try
+  {
+    runner.run("glTF Import " + name, "vertices",
+               [&]()
+               {
+                 const ImportedScene inputScene = importGltfScene(scenePath);
+                 ui64                nGltfVertices = 0;
+                 for (const auto& mesh : inputScene.meshes)
+                 {
+                   nGltfVertices += mesh.vertices.size();
+                 }
+                 return BenchmarkWork {0, nGltfVertices};
+               });
+  }
+  catch (const std::runtime_error& e)
+  {
+    // The viewer loads such scenes with Assimp.
+    std::cout << "Skipping glTF Import " << name << ": " << e.what() << std::endl;
+  }
+
+  // The scene graph and the bounding boxes of its meshes are built from one import.
+  Assimp::Importer       importer;
+  const aiScene*         inputScene = importAssimpScene(importer, scenePath);
+  std::vector<SceneNode> nodes;
+  runner.run("Scene Graph Construction " + name, "nodes",
+             [&]()
+             {
+               nodes.clear();
+               appendSceneNodes(inputScene->mRootNode, nodes);
+               return BenchmarkWork {0, nodes.size()};
+             });
+
+  std::vector<AABB> meshAABBs;
+  for (ui32 i = 0; i < inputScene->mNumMeshes; i++)
+  {
+    const aiMesh* mesh = inputScene->mMeshes[i];
+    meshAABBs.emplace_back(reinterpret_cast<const f32v3*>(mesh->mVertices), mesh->mNumVertices);
+  }
+  runner.run("Scene Traversal " + name, "instances",
+             [&]()
+             {
+               // Accumulates the transformations like drawing does, and bounds all instances like the scene AABB.
+               const InstanceBatches instanceBatches =
+                   createInstanceBatches(nodes, static_cast<ui32>(meshAABBs.size()));
+               AABB sceneAABB;
+               for (const auto& batch : instanceBatches.batches)
+               {
+                 for (ui32 i = 0; i < batch.nInstances; i++)
+                 {
+                   f32m4 transformation = instanceBatches.instanceTransformations[batch.firstInstance + i];
+                   sceneAABB            = sceneAABB.getUnion(meshAABBs[batch.meshIdx].getTransformed(transformation));
+                 }
+               }
+               return BenchmarkWork {0, instanceBatches.instanceTransformations.size()};
+             });
+}
+
+// The scene graph and the geometry of a scene as the viewer keeps them on the CPU.
+struct StaticScene
+{
+  std::vector<SceneNode>      nodes;
+  std::vector<StaticMeshData> meshes;
+};
+
+// Reads the scene with importGltfScene, so the geometry is the one the viewer batches and culls.
+StaticScene importStaticScene(const std::filesystem::path& scenePath)
+{
+  ImportedScene inputScene = importGltfScene(scenePath);
+  StaticScene   result;
+  result.nodes = std::move(inputScene.nodes);
+  for (auto& mesh : inputScene.meshes)
+  {
+    result.meshes.push_back({std::move(mesh.vertices), std::move(mesh.indices), mesh.materialIdx});
+  }
+  return result;
+}
+
+void addStaticBatchingBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& scenePath)
+{
+  const std::string name = scenePath.parent_path().filename().string();
+  if (!runner.isSelected("Static Batching " + name))
+  {
+    return;
+  }
+  StaticScene scene;
+  try
+  {
+    scene = importStaticScene(scenePath);
+  }
+  catch (const std::runtime_error& e)
+  {
+    std::cout << "Skipping Static Batching " << name << ": " << e.what() << std::endl;
+    return;
+  }
+
+  // Baking the transformations is part of loading a scene with static batching, see applyStaticBatching.
+  runner.run("Static Batching " + name, "vertices",
+             [&]()
+             {
+               const StaticBatches staticBatches = createStaticBatches(scene.nodes, scene.meshes);
+               const auto&         statistics    = staticBatches.statistics;
+               if (staticBatches.batches.empty() && statistics.nDrawCallsBefore > 0)
+               {
+                 throw std::logic_error("Static batching of " + name + " created no batches.");
+               }
+               return BenchmarkWork {statistics.geometryBytesAfter, statistics.nVerticesAfter};
+             });
+}
+
+// 1, 2, 4, ... threads up to the hardware threads, to show how the software rasterizer scales.
+std::vector<ui32> getThreadCounts()
+{
+  const ui32        nHardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<ui32> result;
+  for (ui32 nThreads = 1; nThreads < nHardwareThreads; nThreads *= 2)
+  {
+    result.push_back(nThreads);
+  }
+  result.push_back(nHardwareThreads);
+  return result;
+}
+
+// The projection of the scene graph viewer, for a window of 640x480 pixels.
+f32m4 getViewerProjection()
+{
+  return glm::perspectiveFovLH_ZO<f32>(glm::radians(45.0f), 640.0f, 480.0f, 1.0f / 256.0f, 256.0f);
+}
+
+// The camera path recorded for a scene with "Record Camera Path" of the viewer, saved as camera-path.txt next to the
+// scene. Without a recording, the first camera of the viewer circles the scene once in 120 frames.
+CameraPath loadSceneCameraPath(const std::filesystem::path& scenePath)
+{
+  const std::filesystem::path recordingPath = scenePath.parent_path() / "camera-path.txt";
+  if (std::filesystem::exists(recordingPath))
+  {
+    return CameraPath::load(recordingPath);
+  }
+  const ExaminerController examinerController(true);
+  CameraPath               result;
+  for (ui32 frameIdx = 0; frameIdx < 120; frameIdx++)
+  {
+    const f32q rotation = glm::angleAxis(glm::radians(3.0f * static_cast<f32>(frameIdx)), f32v3(0.0f, 1.0f, 0.0f));
+    result.add({rotation * examinerController.getRotationQuaterion(), examinerController.getTranslationVector()});
+  }
+  return result;
+}
+
+// Culls the instances of the scene for every frame of its camera path, with the occluders and queries the viewer
+// creates in SceneGraphViewerApp::createOcclusionCuller.
+void addOcclusionCullingBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& scenePath)
+{
+  const std::string name = scenePath.parent_path().filename().string();
+  if (!runner.isSelected("Occlusion Culling " + name))
+  {
+    return;
+  }
+  StaticScene scene;
+  CameraPath  cameraPath;
+  try
+  {
+    scene      = importStaticScene(scenePath);
+    cameraPath = loadSceneCameraPath(scenePath);
+  }
+  catch (const std::runtime_error& e)
+  {
+    std::cout << "Skipping Occlusion Culling " << name << ": " << e.what() << std::endl;
+    return;
+  }
+
+  std::vector<AABB> meshAABBs;
+  for (const auto& mesh : scene.meshes)
+  {
+    std::vector<f32v3> positions;
+    positions.reserve(mesh.vertices.size());
+    for (const auto& vertex : mesh.vertices)
+    {
+      positions.push_back(vertex.position);
+    }
+    meshAABBs.emplace_back(positions.data(), static_cast<ui32>(positions.size()));
+  }
+  const InstanceBatches instanceBatches = createInstanceBatches(scene.nodes, static_cast<ui32>(scene.meshes.size()));
+  AABB                  sceneAABB;
+  for (const auto& batch : instanceBatches.batches)
+  {
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      f32m4 transformation = instanceBatches.instanceTransformations[batch.firstInstance + i];
+      sceneAABB            = sceneAABB.getUnion(meshAABBs[batch.meshIdx].getTransformed(transformation));
+    }
+  }
+
+  // The view projections of the viewer, see SceneGraphViewerApp::onUpdate.
+  ExaminerController examinerController(true);
+  std::vector<f32m4> viewProjections;
+  for (ui32 frameIdx = 0; frameIdx < cameraPath.getNumberOfPoses(); frameIdx++)
+  {
+    examinerController.setRotationQuaterion(cameraPath.getPose(frameIdx).rotation);
+    examinerController.setTranslationVector(cameraPath.getPose(frameIdx).translation);
+    viewProjections.push_back(getViewerProjection() * examinerController.getTransformationMatrix() *
+                              sceneAABB.getNormalizationTransformation());
+  }
+
+  const OcclusionCullingSettings    settings;
+  ThreadPool                        threadPool(std::max(1u, std::thread::hardware_concurrency()));
+  OcclusionCuller                   culler(settings, &threadPool);
+  const std::vector<OcclusionQuery> queries =
+      createOcclusionQueries(meshAABBs, instanceBatches.batches, instanceBatches.instanceTransformations);
+  culler.setOccluders(
+      selectOccluders(scene.meshes, instanceBatches.batches, instanceBatches.instanceTransformations, settings));
+
+  OcclusionCullingReport report;
+  runner.run("Occlusion Culling " + name, "frames",
+             [&]()
+             {
+               report = evaluateOcclusionCulling(culler, viewProjections, queries);
+               return BenchmarkWork {0,
+                                     report.nFrames,
+                                     {{"millisecondsPerFrame", report.averageMillisecondsPerFrame},
+                                      {"rejectedFraction", report.rejectedFraction}}};
+             });
+  printOcclusionCullingReport(std::cout, report);
+}
+
+void addRasterizerBenchmarks(MicroBenchmarkRunner& runner, const std::string& name, const SoftwareScene& scene,
+                             const std::vector<SoftwareDrawCall>& drawCalls)
+{
+  SoftwareFrameConstants constants;
+  constants.projection       = getViewerProjection();
+  constants.backgroundColor  = f32v3(0.25f, 0.25f, 0.25f);
+  constants.lightDirectionXY = f32v2(0.0f, 0.0f);
+  for (const ui32 nThreads : getThreadCounts())
+  {
+    ThreadPool         threadPool(nThreads);
+    SoftwareRasterizer rasterizer(640, 480, threadPool);
+    runner.run("Software Rasterizer " + name + " " + std::to_string(nThreads) + " Threads", "triangles",
+               [&]()
+               {
+                 rasterizer.draw(scene, drawCalls, constants);
+                 return BenchmarkWork {0, rasterizer.getStatistics().nTriangles};
+               });
+  }
+}
+
+// Building the hierarchies of all meshes and instances, and casting the primary rays of a frame, in view space like the
+// ray casting mode of the scene renderer.
+void addRayCastingBenchmarks(MicroBenchmarkRunner& runner, const std::string& name, const SoftwareScene& scene,
+                             const std::vector<SoftwareDrawCall>& drawCalls)
+{
+  std::vector<TriangleBvhGeometry> geometries;
+  ui64                             nTriangles = 0;
+  for (const auto& mesh : scene.meshes)
+  {
+    geometries.push_back({mesh.vertices.empty() ? nullptr : &mesh.vertices[0].position,
+                          static_cast<ui32>(mesh.vertices.size()), sizeof(SoftwareVertex), mesh.indices.data(),
+                          static_cast<ui32>(mesh.indices.size() / 3)});
+    nTriangles += mesh.indices.size() / 3;
+  }
+  std::vector<RayCastingInstance> instances;
+  for (const auto& drawCall : drawCalls)
+  {
+    instances.push_back({drawCall.meshIdx, drawCall.modelView});
+  }
+
+  // The rays are created before, so only their traversal is measured.
+  const ui32       width             = 640;
+  const ui32       height            = 480;
+  const f32m4      inverseProjection = glm::inverse(getViewerProjection());
+  std::vector<Ray> rays;
+  for (ui32 y = 0; y < height; y++)
+  {
+    for (ui32 x = 0; x < width; x++)
+    {
+      rays.push_back(createCameraRay(inverseProjection, f32v2((static_cast<f32>(x) + 0.5f) / width * 2.0f - 1.0f,
+                                                              1.0f - (static_cast<f32>(y) + 0.5f) / height * 2.0f)));
+    }
+  }
+
+  // Built by the warm-up iteration of the first ray casting benchmark, so it does not depend on the filter.
+  RayCastingScene rayCastingScene;
+
+  for (const ui32 nThreads : getThreadCounts())
+  {
+    ThreadPool threadPool(nThreads);
+    runner.run("BVH Build " + name + " " + std::to_string(nThreads) + " Threads", "triangles",
+               [&]()
+               {
+                 RayCastingScene rayCastingScene(createTriangleBvhs(geometries, threadPool));
+                 rayCastingScene.setInstances(instances);
+                 return BenchmarkWork {0, nTriangles};
+               });
+    // The hits are counted, which keeps the traversal from being optimized away.
+    std::vector<ui32> nRowHits(height);
+    runner.run("Ray Casting " + name + " " + std::to_string(nThreads) + " Threads", "rays",
+               [&]()
+               {
+                 if (rayCastingScene.getNumberOfInstances() != instances.size())
+                 {
+                   rayCastingScene = RayCastingScene(createTriangleBvhs(geometries, threadPool));
+                   rayCastingScene.setInstances(instances);
+                 }
+                 threadPool.parallelFor(height,
+                                        [&](ui32 y)
+                                        {
+                                          nRowHits[y] = 0;
+                                          for (ui32 x = 0; x < width; x++)
+                                          {
+                                            RayHit hit;
+                                            nRowHits[y] += rayCastingScene.intersect(rays[y * width + x], hit);
+                                          }
+                                        });
+                 return BenchmarkWork {0, rays.size()};
+               });
+  }
+}
+
+void addMeshRasterizerBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& meshPath)
+{
+  SoftwareScene scene;
+  scene.meshes.push_back(createSoftwareMesh(CograBinaryMeshFile(meshPath.string()), 0));
+  scene.textures.push_back({1, 1, {ui8v4(255, 255, 255, 255)}, false});
+  scene.materials.push_back({f32v4(0.0f), f32v4(0.0f), f32v4(1.0f), f32v4(1.0f, 1.0f, 1.0f, 128.0f), {0, 0, 0, 0}});
+
+  // The mesh fills about half of the screen, like in the mesh viewer.
+  f32v3 lowerLeftBottom = scene.meshes[0].vertices.at(0).position;
+  f32v3 upperRightTop   = lowerLeftBottom;
+  for (const auto& vertex : scene.meshes[0].vertices)
+  {
+    lowerLeftBottom = glm::min(lowerLeftBottom, vertex.position);
+    upperRightTop   = glm::max(upperRightTop, vertex.position);
+  }
+  const f32v3 axisLengths = upperRightTop - lowerLeftBottom;
+  const f32   scale       = 1.0f / glm::max(axisLengths.x, glm::max(axisLengths.y, axisLengths.z));
+  const f32m4 modelView   = glm::translate(f32m4(1.0f), f32v3(0.0f, 0.0f, 3.0f)) * glm::scale(f32m4(1.0f), f32v3(scale)) *
+                          glm::translate(f32m4(1.0f), -0.5f * (lowerLeftBottom + upperRightTop));
+  addRasterizerBenchmarks(runner, meshPath.filename().string(), scene, {{0, modelView}});
+  addRayCastingBenchmarks(runner, meshPath.filename().string(), scene, {{0, modelView}});
+}
+
+void addSceneRasterizerBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& scenePath)
+{
+  Assimp::Importer importer;
+  const aiScene*   inputScene = importAssimpScene(importer, scenePath);
+  const auto       sceneGraph = createSoftwareSceneGraph(inputScene, scenePath.parent_path());
+
+  // The first camera of the scene graph viewer.
+  const f32m4 sceneView = glm::translate(f32m4(1.0f), f32v3(0.0f, -0.25f, 2.0f)) *
+                          sceneGraph.aabb.getNormalizationTransformation();
+  const auto drawCalls = createSoftwareDrawCalls(sceneGraph, sceneView);
+  addRasterizerBenchmarks(runner, scenePath.parent_path().filename().string(), sceneGraph.scene, drawCalls);
+  addRayCastingBenchmarks(runner, scenePath.parent_path().filename().string(), sceneGraph.scene, drawCalls);
+}
+
+void addTextureBenchmarks(MicroBenchmarkRunner& runner, const std::string& name,
+                          const std::vector<std::filesystem::path>& imagePaths)
+{
+  if (imagePaths.empty())
+  {
+    return;
+  }
+  // Reading the files is not part of decoding, so they are read before.
+  std::vector<std::vector<ui8>> files;
+  ui64                          nBytes = 0;
+  for (const auto& imagePath : imagePaths)
+  {
+    files.push_back(readFile(imagePath));
+    nBytes += files.back().size();
+  }
+  runner.run("Texture Decode " + name, "pixels",
+             [&]()
+             {
+               // Decoded to RGBA8, like Texture2DD3D12 does.
+               ui64 nPixels = 0;
+               for (size_t i = 0; i < files.size(); i++)
+               {
+                 i32  width, height, nChannels;
+                 ui8* pixels = stbi_load_from_memory(files[i].data(), static_cast<i32>(files[i].size()), &width,
+                                                     &height, &nChannels, 4);
+                 if (!pixels)
+                 {
+                   throw std::runtime_error("Unable to decode " + imagePaths[i].string());
+                 }
+                 stbi_image_free(pixels);
+                 nPixels += static_cast<ui64>(width) * height;
+               }
+               return BenchmarkWork {nBytes, nPixels};
+             });
+}
+
+void addTextureContainerBenchmarks(MicroBenchmarkRunner& runner, const std::string& name,
+                                   const std::vector<std::filesystem::path>& imagePaths)
+{
+  if (imagePaths.empty() || !runner.isSelected("Texture Container Load " + name))
+  {
+    return;
+  }
+  // The images are converted like the texture-converter tool does, the conversion is not part of loading.
+  const auto directory = std::filesystem::temp_directory_path() / "gimslib-benchmark-textures" / name;
+  std::filesystem::create_directories(directory);
+  std::vector<std::filesystem::path> containerPaths;
+  ui64                               nBytes   = 0;
+  size_t                             maxBytes = 0;
+  for (size_t i = 0; i < imagePaths.size(); i++)
+  {
+    const SoftwareImage     image   = loadSoftwareImage(imagePaths[i]);
+    const CompressedTexture texture = compressTexture(image, chooseCompressedFormat(image));
+    containerPaths.push_back(directory / (std::to_string(i) + ".dds"));
+    saveDdsFile(containerPaths.back(), texture.format, texture.width, texture.height, texture.mipLevels);
+    nBytes += std::filesystem::file_size(containerPaths.back());
+    maxBytes = std::max(maxBytes, static_cast<size_t>(std::filesystem::file_size(containerPaths.back())));
+  }
+
+  // Compare with "Texture Decode", which only yields the largest mip level. Here, all mip levels are copied into a
+  // buffer like the upload buffer of Texture2DD3D12, straight from the mapped file.
+  std::vector<ui8> uploadBuffer(maxBytes);
+  runner.run("Texture Container Load " + name, "pixels",
+             [&]()
+             {
+               ui64 nPixels = 0;
+               for (const auto& containerPath : containerPaths)
+               {
+                 const TextureFile file(containerPath);
+                 const auto&       header = file.getHeader();
+                 size_t            offset = 0;
+                 for (ui32 mipLevel = 0; mipLevel < header.mipLevels.size(); mipLevel++)
+                 {
+                   std::memcpy(uploadBuffer.data() + offset, file.getMipLevelData(mipLevel),
+                               header.mipLevels[mipLevel].size);
+                   offset += header.mipLevels[mipLevel].size;
+                 }
+                 nPixels += static_cast<ui64>(header.width) * header.height;
+               }
+               return BenchmarkWork {nBytes, nPixels};
+             });
+}
+
+#ifndef _WIN32
+// Drops the pages of a file from the file cache, so the next read comes from the disk, like the first start after a
+// reboot. Cached pages are dropped only if no process maps them.
+void evictFileFromFileCache(const std::filesystem::path& path)
+{
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file >= 0)
+  {
+    posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+    close(file);
+  }
+}
+
+void evictFromFileCache(const std::filesystem::path& directory)
+{
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+  {
+    if (entry.is_regular_file())
+    {
+      evictFileFromFileCache(entry.path());
+    }
+  }
+}
+#endif
+
+// Reads image files like createTextures does, once one after the other, like it did before, and once with all reads in
+// flight, with each backend of AsyncFileReader. Cold runs evict the files from the cache first.
+void addTextureReadBenchmarks(MicroBenchmarkRunner& runner, const std::string& name,
+                              const std::vector<std::filesystem::path>& imagePaths)
+{
+  if (imagePaths.empty())
+  {
+    return;
+  }
+  std::vector<std::pair<std::string, AsyncFileReaderBackend>> backends = {
+      {" (Thread Pool)", AsyncFileReaderBackend::ThreadPool}};
+  if (isIoUringAvailable())
+  {
+    backends.insert(backends.begin(), {" (io_uring)", AsyncFileReaderBackend::IoUring});
+  }
+  std::vector<std::pair<std::string, bool>> variants = {{"", false}};
+#ifndef _WIN32
+  variants.push_back({" (Cold Cache)", true});
+#endif
+  for (const auto& [suffix, isCold] : variants)
+  {
+    runner.run("Texture Files Read " + name + suffix, "bytes",
+               [&, isCold = isCold]()
+               {
+                 ui64 nBytes = 0;
+                 for (const auto& imagePath : imagePaths)
+                 {
+#ifndef _WIN32
+                   if (isCold)
+                   {
+                     evictFileFromFileCache(imagePath);
+                   }
+#endif
+                   nBytes += readFile(imagePath).size();
+                 }
+                 return BenchmarkWork {nBytes, nBytes};
+               });
+
+    for (const auto& [backendName, backend] : backends)
+    {
+      const std::string benchmarkName = "Texture Files Async Read " + name + backendName + suffix;
+      if (!runner.isSelected(benchmarkName))
+      {
+        continue;
+      }
+      AsyncFileReader reader(64, backend);
+      runner.run(benchmarkName, "bytes",
+                 [&, isCold = isCold]()
+                 {
+#ifndef _WIN32
+                   if (isCold)
+                   {
+                     for (const auto& imagePath : imagePaths)
+                     {
+                       evictFileFromFileCache(imagePath);
+                     }
+                   }
+#endif
+                   ui64 nBytes = 0;
+                   for (auto& file : reader.readFiles(imagePaths))
+                   {
+                     nBytes += file.get().size();
+                   }
+                   return BenchmarkWork {nBytes, nBytes};
+                 });
+    }
+  }
+}
+
+// Loads a glTF scene and the encoded files of its textures, i.e., everything that is read before decoding or
+// uploading, once from the files of the scene and once from a package. Cold runs evict the files from the cache first.
+void addScenePackageBenchmarks(MicroBenchmarkRunner& runner, const std::filesystem::path& scenePath)
+{
+  const std::string name = scenePath.parent_path().filename().string();
+  if (!runner.isSelected("Scene Files Load " + name) && !runner.isSelected("Scene Package Load " + name))
+  {
+    return;
+  }
+  const auto packageDirectory = std::filesystem::temp_directory_path() / "gimslib-benchmark-packages" / name;
+  const auto packagePath      = packageDirectory / "scene.gpak";
+  std::filesystem::create_directories(packageDirectory);
+  try
+  {
+    saveScenePackage(packagePath, importGltfScene(scenePath), scenePath.parent_path(), false);
+  }
+  catch (const std::runtime_error& e)
+  {
+    std::cout << "Skipping Scene Package Load " << name << ": " << e.what() << std::endl;
+    return;
+  }
+
+  std::vector<std::pair<std::string, bool>> variants = {{"", false}};
+#ifndef _WIN32
+  variants.push_back({" (Cold Cache)", true});
+#endif
+  for (const auto& [suffix, isCold] : variants)
+  {
+    runner.run("Scene Files Load " + name + suffix, "bytes",
+               [&, isCold = isCold]()
+               {
+#ifndef _WIN32
+                 if (isCold)
+                 {
+                   evictFromFileCache(scenePath.parent_path());
+                 }
+#endif
+                 const ImportedScene inputScene = importGltfScene(scenePath);
+                 ui64                nBytes     = 0;
+                 for (const auto& [textureRelativePath, textureIndex] : inputScene.textureFileNameToTextureIndex)
+                 {
+                   nBytes += readFile(scenePath.parent_path() / textureRelativePath).size();
+                 }
+                 return BenchmarkWork {nBytes, nBytes};
+               });
+
+    // The textures are copied out of the mapping, like into the upload buffer of Texture2DD3D12.
+    std::vector<ui8> uploadBuffer;
+    runner.run("Scene Package Load " + name + suffix, "bytes",
+               [&, isCold = isCold]()
+               {
+#ifndef _WIN32
+                 if (isCold)
+                 {
+                   evictFromFileCache(packageDirectory);
+                 }
+#endif
+                 const ImportedScene inputScene = importScenePackage(packagePath);
+                 ui64                nBytes     = 0;
+                 for (const auto& texture : inputScene.textures)
+                 {
+                   uploadBuffer.assign(texture.data, texture.data + texture.size);
+                   nBytes += texture.size;
+                 }
+                 return BenchmarkWork {nBytes, nBytes};
+               });
+  }
+}
+
+void addProfilerBenchmarks(MicroBenchmarkRunner& runner)
+{
+  // A zone reads the clock twice, so the difference of the two benchmarks is the cost of recording the event.
+  const ui32 nZones = 1u << 20;
+  runner.run("Profile Clock", "zones",
+             [&]()
+             {
+               ui64 ticks = 0;
+               for (ui32 i = 0; i < nZones; i++)
+               {
+                 ticks += Profiler::getTicks();
+                 ticks += Profiler::getTicks();
+               }
+               // Keeps the loop from being optimized away.
+               if (ticks == 0)
+               {
+                 throw std::logic_error("The clock of the profiler does not run.");
+               }
+               return BenchmarkWork {0, nZones};
+             });
+  runner.run("Profile Zone", "zones",
+             [&]()
+             {
+               for (ui32 i = 0; i < nZones; i++)
+               {
+                 const ProfileZone zone("Empty Zone");
+               }
+               return BenchmarkWork {0, nZones};
+             });
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    const Arguments      arguments = parseArguments(argc, argv);
+    MicroBenchmarkRunner runner(arguments.nIterations, arguments.filter);
+
+    addMeshBenchmarks(runner, arguments.dataDirectory / "bunny.cbm");
+    for (const auto& scenePath : findScenes(arguments.dataDirectory))
+    {
+      addSceneBenchmarks(runner, scenePath);
+    }
+    addTextureBenchmarks(runner, "bunny.png", {arguments.dataDirectory / "bunny.png"});
+    addTextureContainerBenchmarks(runner, "bunny.png", {arguments.dataDirectory / "bunny.png"});
+    addTextureReadBenchmarks(runner, "bunny.png", {arguments.dataDirectory / "bunny.png"});
+    for (const auto& scenePath : findScenes(arguments.dataDirectory))
+    {
+      addTextureBenchmarks(runner, scenePath.parent_path().filename().string(),
+                           findImages(scenePath.parent_path()));
+      addTextureContainerBenchmarks(runner, scenePath.parent_path().filename().string(),
+                                    findImages(scenePath.parent_path()));
+      addTextureReadBenchmarks(runner, scenePath.parent_path().filename().string(),
+                               findImages(scenePath.parent_path()));
+      addScenePackageBenchmarks(runner, scenePath);
+      addStaticBatchingBenchmarks(runner, scenePath);
+      addOcclusionCullingBenchmarks(runner, scenePath);
+    }
+    addMeshRasterizerBenchmarks(runner, arguments.dataDirectory / "bunny.cbm");
+    for (const auto& scenePath : findScenes(arguments.dataDirectory))
+    {
+      addSceneRasterizerBenchmarks(runner, scenePath);
+    }
+    addProfilerBenchmarks(runner);
+
+    runner.writeTable(std::cout);
+    if (!arguments.jsonPath.empty())
+    {
+      std::ofstream stream(arguments.jsonPath);
+      runner.writeJson(stream);
+      if (!stream)
+      {
+        throw std::runtime_error("Unable to write " + arguments.jsonPath.string());
+      }
+      std::cout << "Wrote " << arguments.jsonPath.string() << std::endl;
+    }
+
+    // A regression needs a median that is slower than allowed, and a confidence interval above the baseline's, so
+    // the noise of a shared machine does not fail the run.
+    if (!arguments.baselinePath.empty())
+    {
+      std::ifstream stream(arguments.baselinePath);
+      if (!stream)
+      {
+        throw std::runtime_error("Unable to read " + arguments.baselinePath.string());
+      }
+      const auto comparisons =
+          compareWithBaseline(readBaselineJson(stream), runner.getResults(), arguments.maxSlowdown);
+      std::cout << "\nCompared with " << arguments.baselinePath.string() << ":\n";
+      writeBaselineComparisonTable(std::cout, comparisons);
+      const ui32 nRegressions = countRegressions(comparisons);
+      if (nRegressions > 0)
+      {
+        std::cerr << "Benchmarks more than " << arguments.maxSlowdown * 100.0
+                  << "% slower than the baseline: " << nRegressions << "\n";
+        return 2;
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <d3d12.h>
+#include <gimslib/sys/GpuProfiler.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+namespace gims
+{
+using Microsoft::WRL::ComPtr;
+
+//! \brief Measures named GPU passes with timestamp queries, see GpuProfiler.
+//!
+//! The timestamps of a frame are resolved into its own range of a readback buffer at the end of the frame, and read
+//! when the frame slot is used again, so reading never waits for the GPU. All passes have to be recorded into command
+//! lists of the queue the profiler was created for.
+class GpuProfilerD3D12
+{
+public:
+  //! \param queue Queue that executes the passes, its timestamp frequency converts the ticks.
+  //! \param nFrames Frames in flight, see GpuProfiler.
+  //! \param maxPassesPerFrame Passes that are measured per frame, see GpuProfiler.
+  GpuProfilerD3D12(const ComPtr<ID3D12Device2>& device, const ComPtr<ID3D12CommandQueue>& queue, ui32 nFrames,
+                   ui32 maxPassesPerFrame);
+
+  //! \brief Starts a frame and reads the timestamps of the frame in the same slot before, which has to be finished.
+  void beginFrame(ui32 frameSlot);
+
+  //! \brief Records the timestamp at the begin of a pass.
+  void beginPass(const ComPtr<ID3D12GraphicsCommandList6>& commandList, const std::string& name);
+
+  //! \brief Records the timestamp at the end of the innermost pass.
+  void endPass(const ComPtr<ID3D12GraphicsCommandList6>& commandList);
+
+  //! \brief Ends the frame and records the copy of its timestamps to the readback buffer.
+  void endFrame(const ComPtr<ID3D12GraphicsCommandList6>& commandList);
+
+  const GpuProfiler& getProfiler() const;
+
+private:
+  GpuProfiler                m_profiler;
+  ComPtr<ID3D12QueryHeap>    m_queryHeap;
+  ComPtr<ID3D12Resource>     m_readbackBuffer; //! One timestamp per query.
+  std::vector<GpuQueryRange> m_frameQueries;   //! Per frame slot, resolved but not read yet.
+  ui32                       m_currentFrameSlot;
+};
+} // namespace gims
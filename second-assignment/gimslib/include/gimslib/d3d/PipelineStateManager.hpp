@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <d3d12.h>
+#include <d3dx12/d3dx12.h>
+#include <filesystem>
+#include <functional>
+#include <gimslib/sys/DeduplicatedBatch.hpp>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <wrl.h>
+
+namespace gims
+{
+using Microsoft::WRL::ComPtr;
+
+//! \brief Statistics of a PipelineStateManager.
+struct PipelineStateStatistics
+{
+  ui32 nRequests          = 0;   //! Calls of the request functions.
+  ui32 nPipelines         = 0;   //! Distinct pipelines, i.e., requests minus duplicates.
+  ui32 nLoadedFromLibrary = 0;   //! Pipelines the driver did not have to compile.
+  f64  milliseconds       = 0.0; //! Total time spent in createPipelines.
+};
+
+//! \brief Hashes a root signature by its serialized form, so the hash is the same in every run.
+ui64 hashRootSignature(const void* serializedRootSignature, size_t sizeInBytes);
+
+//! \brief Hashes everything of a description that affects the pipeline. Shaders are hashed by their bytecode, the root
+//! signature is represented by rootSignatureHash. CachedPSO is ignored. Needs no device.
+ui64 hashPipelineDescription(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash);
+
+//! \brief See hashPipelineDescription for graphics pipelines.
+ui64 hashPipelineDescription(const D3D12_COMPUTE_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash);
+
+//! \brief See hashPipelineDescription for graphics pipelines.
+ui64 hashPipelineDescription(const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& description, ui64 rootSignatureHash);
+
+//! \brief Creates pipeline states on worker threads and keeps them across runs.
+//!
+//! Pipelines are requested first and created together by createPipelines(), in parallel on a thread pool. Requests
+//! with identical descriptions share one pipeline. Pipelines the driver has compiled are stored in an
+//! ID3D12PipelineLibrary, which storeLibrary() writes to disk, so the next run loads them instead of compiling.
+//! Pipeline names in the library are description hashes. To give a root signature the same hash in every run, create
+//! it with createRootSignature(). Other root signatures are hashed by address, which still deduplicates requests, but
+//! does not find their pipelines in the library of an earlier run.
+class PipelineStateManager
+{
+public:
+  //! \brief Handle of a requested pipeline.
+  using Handle = ui32;
+
+  //! \brief Creates a manager and loads the pipeline library, if it exists and matches the driver.
+  //! \param device Device on which the pipelines are created.
+  //! \param libraryFile File of the pipeline library. An empty path disables the library.
+  //! \param threadPool Threads that create pipelines. If nullptr, pipelines are created on the calling thread.
+  PipelineStateManager(const ComPtr<ID3D12Device2>& device, const std::filesystem::path& libraryFile,
+                       ThreadPool* threadPool);
+
+  //! \brief Creates a root signature from its serialized form and remembers the hash of the serialized form.
+  ComPtr<ID3D12RootSignature> createRootSignature(const ComPtr<ID3DBlob>& serializedRootSignature);
+
+  //! \brief Requests a graphics pipeline. The description, including shader bytecode and input layout, is copied.
+  Handle requestPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& description);
+
+  //! \brief Requests a compute pipeline. The description, including shader bytecode, is copied.
+  Handle requestPipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC& description);
+
+  //! \brief Requests a mesh shader pipeline. The description, including shader bytecode, is copied.
+  Handle requestPipeline(const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& description);
+
+  //! \brief Creates all requested pipelines, either by loading them from the library or by compiling them.
+  void createPipelines();
+
+  //! \brief Returns a pipeline. Its request must precede the last call of createPipelines.
+  const ComPtr<ID3D12PipelineState>& getPipeline(Handle handle) const;
+
+  //! \brief Writes the library to disk, if pipelines were added since it was loaded or last stored.
+  void storeLibrary();
+
+  //! \brief Returns the statistics.
+  PipelineStateStatistics getStatistics() const;
+
+  PipelineStateManager(const PipelineStateManager& other)            = delete;
+  PipelineStateManager& operator=(const PipelineStateManager& other) = delete;
+
+private:
+  ui64 getRootSignatureHash(ID3D12RootSignature* rootSignature) const;
+
+  //! Creates a pipeline, looking it up in the library first. Called on worker threads.
+  ComPtr<ID3D12PipelineState> createPipeline(
+      ui64 hash, const std::function<HRESULT(ID3D12PipelineLibrary*, const wchar_t*, ComPtr<ID3D12PipelineState>&)>& load,
+      const std::function<ComPtr<ID3D12PipelineState>()>& create);
+
+  ComPtr<ID3D12Device2>                          m_device;              //! Device of all pipelines.
+  ThreadPool*                                    m_threadPool;          //! May be nullptr.
+  std::filesystem::path                          m_libraryFile;         //! Empty, if there is no library.
+  std::vector<ui8>                               m_libraryBlob;         //! Must outlive m_library.
+  ComPtr<ID3D12PipelineLibrary>                  m_library;             //! May be nullptr.
+  std::mutex                                     m_libraryMutex;        //! Serializes stores to the library.
+  bool                                           m_libraryModified;     //! True, if storeLibrary has work.
+  std::unordered_map<ID3D12RootSignature*, ui64> m_rootSignatureHashes; //! Hashes of serialized root signatures.
+  std::vector<ComPtr<ID3D12RootSignature>>       m_rootSignatures;      //! Keeps the hashed root signatures alive.
+  DeduplicatedBatch<ComPtr<ID3D12PipelineState>> m_pipelines;           //! All requested pipelines.
+  std::atomic<ui32>                              m_nLoadedFromLibrary;  //! Pipelines loaded instead of compiled.
+  f64                                            m_milliseconds;        //! Time spent in createPipelines.
+};
+} // namespace gims
@@ -0,0 +1,79 @@
+#pragma once
+#include <d3d12.h>
+#include <functional>
+#include <gimslib/sys/RenderGraph.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+namespace gims
+{
+using Microsoft::WRL::ComPtr;
+
+//! \brief Records a RenderGraph with D3D12.
+//!
+//! Transient resources are placed in a heap that grows with the largest graph. The barriers before a pass are recorded
+//! with a single ResourceBarrier call. Transient render targets and depth buffers are discarded on their first use,
+//! as aliased memory has to be initialized, so the first pass has to write them completely. Transient resources are
+//! placed anew by every execute(), so passes create their views themselves. Resources and heap of an execute() are
+//! kept until the next one, so use one graph per frame in flight.
+class RenderGraphD3D12
+{
+public:
+  //! \brief Records a pass into the command list.
+  using PassFunction = std::function<void(const ComPtr<ID3D12GraphicsCommandList6>& commandList)>;
+
+  //! \brief Returns the command list to record into. Called before each pass, as passes may switch to new lists.
+  using CommandListGetter = std::function<const ComPtr<ID3D12GraphicsCommandList6>&()>;
+
+  RenderGraphD3D12(const ComPtr<ID3D12Device2>& device);
+
+  //! \brief Removes all passes and resources, to build the graph of the next frame.
+  void reset();
+
+  //! \brief Adds a resource that lives outside the graph, see RenderGraph::importResource.
+  ui32 importResource(const std::string& name, const ComPtr<ID3D12Resource>& resource,
+                      D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState);
+
+  //! \brief Adds a resource that is placed in the heap of the graph, see RenderGraph::createTransientResource.
+  //! \throws std::invalid_argument If the device only supports heaps for render targets and depth buffers and the
+  //! resource is neither.
+  ui32 createTransientResource(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+                               const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr);
+
+  //! \brief Adds a pass, see RenderGraph::addPass. The states of the usages are D3D12_RESOURCE_STATES.
+  ui32 addPass(const std::string& name, const std::vector<RenderGraphResourceUsage>& reads,
+               const std::vector<RenderGraphResourceUsage>& writes, PassFunction execute, bool hasSideEffects = false);
+
+  //! \brief Returns a resource. Transient resources only exist during execute().
+  const ComPtr<ID3D12Resource>& getResource(ui32 resourceIdx) const;
+
+  //! \brief Compiles the graph, places the transient resources and records the passes with their barriers.
+  void execute(const CommandListGetter& getCommandList);
+
+  //! \brief Returns the result of the last execute(), e.g., to display the number of barriers.
+  const CompiledRenderGraph& getCompiledRenderGraph() const;
+
+  const RenderGraph& getRenderGraph() const;
+
+private:
+  struct TransientResource
+  {
+    D3D12_RESOURCE_DESC desc;
+    ui64                alignment;
+    D3D12_CLEAR_VALUE   optimizedClearValue;
+    bool                hasOptimizedClearValue;
+  };
+
+  ComPtr<ID3D12Device2>               m_device;
+  bool                                m_onlyRenderTargetsInHeap; //! Resource heap tier 1.
+  RenderGraph                         m_renderGraph;
+  std::vector<PassFunction>           m_passes;             //! Per pass.
+  std::vector<ComPtr<ID3D12Resource>> m_resources;          //! Per resource.
+  std::vector<TransientResource>      m_transientResources; //! Per resource, only set for transient ones.
+  CompiledRenderGraph                 m_compiledRenderGraph;
+  ComPtr<ID3D12Heap>                  m_heap;
+  ui64                                m_heapSize;
+};
+} // namespace gims
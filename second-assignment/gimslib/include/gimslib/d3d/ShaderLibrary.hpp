@@ -0,0 +1,61 @@
+#pragma once
+#include <d3d12.h>
+#include <filesystem>
+#include <gimslib/io/ShaderCache.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gims
+{
+//! \brief A shader that was compiled at build time and is embedded in the executable. The sources defining these are
+//! generated by create_app in CreateApp.cmake from the SHADER_ENTRY_POINTS of an app.
+struct EmbeddedShader
+{
+  const wchar_t* shaderName;    //! File name of the shader source, without directory.
+  const wchar_t* entryPoint;    //! Entry point, e.g., L"PS_main".
+  const wchar_t* targetProfile; //! Target profile, e.g., L"ps_6_0".
+  const wchar_t* defines;       //! Defines as written by getShaderDefinesKey.
+  const ui8*     bytecode;      //! DXIL.
+  size_t         sizeInBytes;   //! Size of the DXIL.
+};
+
+//! \brief Formats defines as "NAME=VALUE,NAME=VALUE" in the given order. Used to look up shader permutations.
+std::wstring getShaderDefinesKey(const std::vector<ShaderDefine>& defines);
+
+//! \brief Shaders compiled at build time, looked up by file name, entry point, profile and defines.
+//!
+//! Only the file name of a shader is part of the key, so the lookup neither depends on the working directory nor on
+//! the location of the sources. The bytecode is not copied and must outlive the library.
+class ShaderLibrary
+{
+public:
+  //! \brief Returns the library of the shaders embedded in the executable.
+  static ShaderLibrary& getEmbedded();
+
+  //! \brief Adds shaders. A shader that is already in the library is replaced.
+  void add(const EmbeddedShader* shaders, size_t nShaders);
+
+  //! \brief Looks up a shader.
+  //! \param bytecode Receives the bytecode, if the shader was found.
+  //! \return True, if the shader was found.
+  bool find(const std::filesystem::path& shaderFile, const wchar_t* entryPoint, const wchar_t* targetProfile,
+            const std::vector<ShaderDefine>& defines, D3D12_SHADER_BYTECODE& bytecode) const;
+
+  //! \brief Returns the number of shaders.
+  size_t getNumberOfShaders() const;
+
+private:
+  static std::wstring getKey(const std::wstring& shaderName, const std::wstring& entryPoint,
+                             const std::wstring& targetProfile, const std::wstring& defines);
+
+  std::unordered_map<std::wstring, D3D12_SHADER_BYTECODE> m_shaders; //! Bytecode by key.
+};
+
+//! \brief Adds shaders to ShaderLibrary::getEmbedded() during static initialization. Used by the generated sources.
+struct EmbeddedShaderRegistration
+{
+  EmbeddedShaderRegistration(const EmbeddedShader* shaders, size_t nShaders);
+};
+} // namespace gims
@@ -0,0 +1,44 @@
+#pragma once
+#include <gimslib/io/ShaderCache.hpp>
+#include <gimslib/types.hpp>
+#include <string>
+#include <vector>
+
+namespace gims
+{
+//! \brief Declares the boolean features of a shader, each of which is a preprocessor define.
+//!
+//! A permutation is a bit mask over the features: bit i is set if feature i is enabled. Each permutation is compiled
+//! with every feature defined as 1 or 0, so the shader can use #if instead of branching at run time.
+class ShaderFeatureSet
+{
+public:
+  //! \brief Creates a set without features. It has exactly one permutation.
+  ShaderFeatureSet() = default;
+
+  //! \brief Creates a set of features.
+  //! \param featureNames The names of the defines. At most 32 features are supported.
+  explicit ShaderFeatureSet(const std::vector<std::wstring>& featureNames);
+
+  //! \brief Returns the number of features.
+  ui32 getNumberOfFeatures() const;
+
+  //! \brief Returns the number of permutations, i.e., 2 to the power of the number of features.
+  ui64 getNumberOfPermutations() const;
+
+  //! \brief Returns the bit of a feature. Throws if the set has no such feature.
+  ui32 getFeatureBit(const std::wstring& featureName) const;
+
+  //! \brief Returns the mask with the bits of all features set.
+  ui32 getAllFeaturesMask() const;
+
+  //! \brief Returns the defines of a permutation. Bits that belong to no feature are ignored.
+  std::vector<ShaderDefine> getDefines(ui32 permutation) const;
+
+  //! \brief Returns the names of the enabled features, separated by '|', or "none".
+  std::string getDescription(ui32 permutation) const;
+
+private:
+  std::vector<std::wstring> m_featureNames; //! Feature i corresponds to bit i.
+};
+} // namespace gims
@@ -0,0 +1,85 @@
+#pragma once
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <gimslib/types.hpp>
+#include <memory>
+#include <vector>
+
+namespace gims
+{
+//! \brief Read of a byte range of a file into a buffer of the caller, which must stay valid until the read finished.
+struct FileReadRequest
+{
+  std::filesystem::path path;
+  ui64                  offset; //! Of the first byte in the file.
+  void*                 buffer;
+  size_t                size;   //! Bytes to read. Fewer are read if the file ends before.
+};
+
+//! \brief Called when a read has finished, on a thread of the reader. Must not block for long, since it delays the
+//! completions of the following reads.
+//! \param requestIdx Index of the request in its batch.
+//! \param nBytesRead Bytes that were read, 0 if the read failed.
+//! \param error Null if the read succeeded, a std::runtime_error otherwise.
+using FileReadCallback = std::function<void(size_t requestIdx, size_t nBytesRead, std::exception_ptr error)>;
+
+//! \brief How an AsyncFileReader reads.
+enum class AsyncFileReaderBackend
+{
+  Automatic,  //! IoUring if the kernel supports it, ThreadPool otherwise.
+  IoUring,    //! Linux only. One submission of all reads of a batch, completed by a single thread.
+  ThreadPool  //! Blocking reads with pread, or ReadFile on Windows, on worker threads.
+};
+
+//! \brief Reads batches of files asynchronously, so loaders can keep many reads in flight and decode the data of one
+//! file while the following ones are read.
+//!
+//! On Linux, the reads go through io_uring, without liburing. The thread-pool backend is the fallback for other
+//! platforms and for kernels or sandboxes without io_uring. Files are opened when their reads are submitted, on the
+//! io_uring backend by the submitting thread.
+class AsyncFileReader
+{
+public:
+  //! \brief Starts the backend.
+  //! \param queueDepth Maximum number of reads in flight. Further reads wait until earlier ones finished.
+  //! \throws std::runtime_error If the IoUring backend is requested but not available.
+  explicit AsyncFileReader(ui32 queueDepth = 64, AsyncFileReaderBackend backend = AsyncFileReaderBackend::Automatic);
+
+  //! \brief Waits for all reads, see waitForAll, and stops the backend.
+  ~AsyncFileReader();
+
+  //! \brief Returns IoUring or ThreadPool.
+  AsyncFileReaderBackend getBackend() const;
+
+  //! \brief Submits a batch of reads. The callback is called once per request, in the order the reads finish, which is
+  //! not the order of the requests.
+  void submit(const std::vector<FileReadRequest>& requests, const FileReadCallback& onCompletion);
+
+  //! \brief Submits a batch of reads and returns one future per request, with the number of bytes read. The futures
+  //! rethrow the errors of failed reads.
+  std::vector<std::future<size_t>> submit(const std::vector<FileReadRequest>& requests);
+
+  //! \brief Reads whole files into buffers of their size.
+  //! \return One future per file, which rethrows the error if the file cannot be read.
+  std::vector<std::future<std::vector<ui8>>> readFiles(const std::vector<std::filesystem::path>& paths);
+
+  //! \brief Returns when all submitted reads have finished and their callbacks have returned.
+  void waitForAll();
+
+  AsyncFileReader(const AsyncFileReader& other)            = delete;
+  AsyncFileReader(AsyncFileReader&& other)                 = delete;
+  AsyncFileReader& operator=(const AsyncFileReader& other) = delete;
+  AsyncFileReader& operator=(AsyncFileReader&& other)      = delete;
+
+  class Backend;
+
+private:
+  std::unique_ptr<Backend> m_backend;
+};
+
+//! \brief Returns true if the kernel supports io_uring and the process may use it, e.g., outside of sandboxes that
+//! block it.
+bool isIoUringAvailable();
+} // namespace gims
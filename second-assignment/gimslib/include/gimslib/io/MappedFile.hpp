@@ -0,0 +1,42 @@
+#pragma once
+#include <filesystem>
+#include <gimslib/types.hpp>
+
+namespace gims
+{
+//! \brief Read-only view of a whole file, mapped into memory with mmap or, on Windows, a file mapping.
+//!
+//! Pages are read when they are first touched and are shared with the file cache, so mapping large buffers neither
+//! copies them nor counts them towards the heap. The view stays valid until the object is destroyed.
+class MappedFile
+{
+public:
+  //! \brief Creates an empty view.
+  MappedFile();
+
+  //! \brief Maps a file. Empty files are not mapped, their data is nullptr.
+  //! \throws std::runtime_error If the file cannot be opened or mapped.
+  explicit MappedFile(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile& other)            = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  const ui8* getData() const;
+  size_t     getSize() const;
+
+  //! \brief Asks the operating system to read a range of the file ahead, in the background. One large sequential read
+  //! is much faster than the page faults of scattered accesses on cold caches, spinning disks, and network drives.
+  //! Ranges beyond the end of the file are clamped. The hint may be ignored, so the data stays valid either way.
+  void prefetch(size_t offset, size_t size) const;
+
+private:
+  void unmap();
+
+  const ui8* m_data;
+  size_t     m_size;
+};
+} // namespace gims
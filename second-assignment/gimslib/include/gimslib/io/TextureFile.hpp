@@ -0,0 +1,122 @@
+#pragma once
+#include <filesystem>
+#include <gimslib/io/MappedFile.hpp>
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+//! \brief Texel formats of texture containers. The values are the ones of DXGI_FORMAT, so D3D12 takes them as they
+//! are, while the library itself does not depend on D3D12.
+enum class TextureFormat : ui32
+{
+  Unknown           = 0,
+  R16G16B16A16Float = 10,
+  R8G8B8A8Unorm     = 28,
+  R8G8B8A8UnormSrgb = 29,
+  R8G8Unorm         = 49,
+  R8Unorm           = 61,
+  BC1Unorm          = 71,
+  BC1UnormSrgb      = 72,
+  BC2Unorm          = 74,
+  BC2UnormSrgb      = 75,
+  BC3Unorm          = 77,
+  BC3UnormSrgb      = 78,
+  BC4Unorm          = 80,
+  BC4Snorm          = 81,
+  BC5Unorm          = 83,
+  BC5Snorm          = 84,
+  B8G8R8A8Unorm     = 87,
+  B8G8R8A8UnormSrgb = 91,
+  BC6HUF16          = 95,
+  BC6HSF16          = 96,
+  BC7Unorm          = 98,
+  BC7UnormSrgb      = 99
+};
+
+//! \brief Returns true for the BC formats, which store blocks of 4x4 texels.
+bool isBlockCompressed(TextureFormat format);
+
+//! \brief Bytes of a texel, or of a block of 4x4 texels for block-compressed formats.
+//! \throws std::invalid_argument If the format is unknown.
+ui32 getBytesPerBlock(TextureFormat format);
+
+//! \brief Returns the SRGB variant of a format, or the format itself if it has none, e.g., BC5Unorm.
+TextureFormat getSrgbFormat(TextureFormat format);
+
+//! \brief One mip level of a 2D texture, in the layout of the file and of D3D12_SUBRESOURCE_DATA.
+struct TextureSubresource
+{
+  ui32   width;    //! In texels.
+  ui32   height;   //! In texels.
+  ui32   rowPitch; //! Bytes of a row of texels, or of a row of blocks for block-compressed formats.
+  ui32   nRows;    //! Rows of texels, or rows of blocks.
+  size_t offset;   //! Of the first byte, relative to the start of the file.
+  size_t size;     //! rowPitch times nRows.
+};
+
+//! \brief Computes the tightly packed mip chain of a texture, as DDS files store it. Each level halves the size of
+//! the previous one, down to 1, and a block-compressed level has at least one block.
+//! \param offset Offset of the first level.
+//! \throws std::invalid_argument If the format is unknown, a size is 0, or there are more levels than the size
+//! allows.
+std::vector<TextureSubresource> computeTextureSubresources(TextureFormat format, ui32 width, ui32 height,
+                                                           ui32 nMipLevels, size_t offset);
+
+//! \brief Format and mip levels of a texture container.
+struct TextureHeader
+{
+  TextureFormat                   format;
+  ui32                            width;
+  ui32                            height;
+  std::vector<TextureSubresource> mipLevels; //! Starting at the largest.
+};
+
+//! \brief Reads the header of a DDS or KTX2 file in memory and computes the layout of its mip levels.
+//!
+//! Only 2D textures without arrays and faces are supported. KTX2 files must not be supercompressed, e.g., with Basis
+//! Universal, since their data could not be uploaded as it is.
+//! \throws std::runtime_error If the data is no DDS or KTX2 file, is truncated, or uses other features or formats.
+TextureHeader readTextureHeader(const ui8* data, size_t size);
+
+//! \brief DDS or KTX2 file, mapped into memory, whose mip levels can be uploaded without decoding them.
+class TextureFile
+{
+public:
+  //! \brief Maps the file and reads its header.
+  //! \throws std::runtime_error See readTextureHeader.
+  explicit TextureFile(const std::filesystem::path& path);
+
+  const TextureHeader& getHeader() const;
+
+  //! \brief Returns the texels of a mip level, which point into the mapped file.
+  //! \throws std::out_of_range If the level does not exist.
+  const ui8* getMipLevelData(ui32 mipLevel) const;
+
+private:
+  MappedFile    m_file;
+  TextureHeader m_header;
+};
+
+//! \brief Returns true for .dds and .ktx2 files, which TextureFile reads.
+bool isTextureContainerFile(const std::filesystem::path& path);
+
+//! \brief Returns the DDS or KTX2 file next to an image with the same name, e.g., written by the texture-converter
+//! tool, whose mip levels can be uploaded without decoding. Returns the image itself if there is none.
+std::filesystem::path findTextureContainerFile(const std::filesystem::path& imagePath);
+
+//! \brief Returns true if data in memory starts like a DDS or KTX2 file, e.g., a texture inside a package.
+bool isTextureContainer(const ui8* data, size_t size);
+
+//! \brief Creates a DDS file in memory, see saveDdsFile.
+//! \throws std::invalid_argument If a level does not have the size of the layout.
+std::vector<ui8> createDdsFile(TextureFormat format, ui32 width, ui32 height,
+                               const std::vector<std::vector<ui8>>& mipLevels);
+
+//! \brief Saves the mip levels of a 2D texture as DDS file with a DX10 header, which can store every format.
+//! \param mipLevels Tightly packed texels of each level, in the layout of computeTextureSubresources.
+//! \throws std::invalid_argument If a level does not have the size of the layout.
+//! \throws std::runtime_error If the file cannot be written.
+void saveDdsFile(const std::filesystem::path& path, TextureFormat format, ui32 width, ui32 height,
+                 const std::vector<std::vector<ui8>>& mipLevels);
+} // namespace gims
@@ -0,0 +1,50 @@
+#pragma once
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <gimslib/types.hpp>
+#include <vector>
+
+namespace gims
+{
+//! \brief Creates the mip levels of an SRGB image, starting with the image itself and ending at 1x1.
+//!
+//! Each level averages 2x2 texels of the previous one in linear space, so the levels do not darken. Odd sizes drop the
+//! last row or column, like D3D12 rounds the sizes of the levels down.
+std::vector<SoftwareImage> createMipChain(const SoftwareImage& image);
+
+//! \brief Returns true if every texel has an alpha of 255, so BC1 can store the image without loss of alpha.
+bool isOpaque(const SoftwareImage& image);
+
+//! \brief Compresses an image into BC1 blocks of 8 bytes, row by row, in the layout of computeTextureSubresources.
+//!
+//! The end points of each block span the bounding box of its colors along the diagonal that fits them best, which is
+//! fast and good enough for textures that are compressed once. Alpha is dropped.
+std::vector<ui8> compressBC1(const SoftwareImage& image);
+
+//! \brief Compresses an image into BC3 blocks of 16 bytes, with the colors of compressBC1 and interpolated alpha.
+std::vector<ui8> compressBC3(const SoftwareImage& image);
+
+//! \brief Mip levels of an image in a format the GPU samples as it is, e.g., for saveDdsFile.
+struct CompressedTexture
+{
+  TextureFormat                 format;
+  ui32                          width;
+  ui32                          height;
+  std::vector<std::vector<ui8>> mipLevels; //! In the layout of computeTextureSubresources.
+};
+
+//! \brief Returns BC1UnormSrgb for opaque images and BC3UnormSrgb otherwise. Images whose size is not a multiple of 4
+//! get R8G8B8A8UnormSrgb, since D3D12 requires that of block-compressed textures.
+TextureFormat chooseCompressedFormat(const SoftwareImage& image);
+
+//! \brief Creates the mip levels of an SRGB image and stores them in a format.
+//! \param format BC1UnormSrgb, BC3UnormSrgb, or R8G8B8A8UnormSrgb.
+//! \throws std::invalid_argument If the format is another one.
+CompressedTexture compressTexture(const SoftwareImage& image, TextureFormat format);
+
+//! \brief Decodes the largest mip level of a DDS or KTX2 file in memory, e.g., for the SoftwareRasterizer, which
+//! samples RGBA8 images only.
+//! \throws std::runtime_error If the data is no texture container, see readTextureHeader, or its format is none of
+//! BC1, BC3, R8G8B8A8, and B8G8R8A8.
+SoftwareImage decompressTexture(const ui8* data, size_t size);
+} // namespace gims
@@ -0,0 +1,80 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <ostream>
+#include <vector>
+
+namespace gims
+{
+//! \brief Distribution of a series of times, in milliseconds.
+struct TimeSummary
+{
+  ui32 nSamples;
+  f64  mean;
+  f64  min;
+  f64  max;
+  f64  p50; //! Median.
+  f64  p95;
+  f64  p99;
+};
+
+//! \brief Summarizes times. Percentiles use the nearest rank, so they are always one of the times.
+//! \return All zero if there are no times.
+TimeSummary summarizeTimes(std::vector<f64> milliseconds);
+
+//! \brief Collects the times of the frames of a benchmark run and writes them with their summaries.
+//!
+//! The first frames warm up caches and pipelines and are not measured. GPU times arrive a few frames late, as they are
+//! read back when the GPU has finished, so the run is complete once the GPU times of all measured frames have arrived
+//! or the frames in flight have passed without them.
+class BenchmarkRecorder
+{
+public:
+  //! \param nWarmUpFrames Frames before the measured ones.
+  //! \param nFrames Frames that are measured.
+  //! \param maxGpuLatency Frames after which the GPU time of a frame has arrived, e.g., the frames in flight.
+  //! \throws std::invalid_argument If nFrames is 0.
+  BenchmarkRecorder(ui32 nWarmUpFrames, ui32 nFrames, ui32 maxGpuLatency);
+
+  //! \brief Returns the index of the current frame, counted from the first warm-up frame.
+  ui64 getFrameIdx() const;
+
+  //! \brief Adds the CPU times of the current frame and continues with the next one.
+  //! \param frameMilliseconds Time since the previous frame started.
+  //! \param cpuMilliseconds Time the CPU spent on the frame, without waiting for the GPU.
+  void addFrame(f64 frameMilliseconds, f64 cpuMilliseconds);
+
+  //! \brief Adds the GPU time of an earlier frame. Times of frames that are not measured are ignored.
+  void addGpuTime(ui64 frameIdx, f64 milliseconds);
+
+  //! \brief Returns true, once all measured frames have been added and their GPU times have arrived.
+  bool isComplete() const;
+
+  TimeSummary getFrameTimeSummary() const;
+  TimeSummary getCpuTimeSummary() const;
+
+  //! \brief Only the frames whose GPU time arrived.
+  TimeSummary getGpuTimeSummary() const;
+
+  //! \brief Writes the summaries as JSON.
+  void writeJson(std::ostream& stream) const;
+
+  //! \brief Writes the times of the measured frames as CSV, with -1 for GPU times that have not arrived.
+  void writeCsv(std::ostream& stream) const;
+
+private:
+  struct FrameTimes
+  {
+    f64  frameMilliseconds;
+    f64  cpuMilliseconds;
+    f64  gpuMilliseconds;
+    bool hasGpuTime;
+  };
+
+  ui32                    m_nWarmUpFrames;
+  ui32                    m_nFrames;
+  ui32                    m_maxGpuLatency;
+  ui64                    m_frameIdx;
+  ui32                    m_nGpuTimes;
+  std::vector<FrameTimes> m_frames; //! Per measured frame.
+};
+} // namespace gims
@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <gimslib/sys/Profiler.hpp>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <memory>
+#include <vector>
+
+namespace gims
+{
+//! \brief A half-open range [begin, end) of items, e.g., of draw calls.
+struct ItemRange
+{
+  ui32 begin; //! First item.
+  ui32 end;   //! One past the last item.
+};
+
+//! \brief Splits [0, nItems) into contiguous ranges of nearly equal size, in ascending order.
+//! \param nItems Number of items.
+//! \param nChunks Maximum number of ranges.
+//! \param minItemsPerChunk Fewer ranges are returned, if a range would get less items.
+//! \return At least one range, unless nItems is 0.
+inline std::vector<ItemRange> partitionItems(ui32 nItems, ui32 nChunks, ui32 minItemsPerChunk = 1)
+{
+  if (nItems == 0)
+  {
+    return std::vector<ItemRange>();
+  }
+  minItemsPerChunk = std::max(minItemsPerChunk, 1u);
+  nChunks          = std::clamp(nChunks, 1u, std::max(nItems / minItemsPerChunk, 1u));
+
+  std::vector<ItemRange> ranges(nChunks);
+  for (ui32 i = 0; i < nChunks; i++)
+  {
+    ranges[i].begin = static_cast<ui32>(static_cast<ui64>(nItems) * i / nChunks);
+    ranges[i].end   = static_cast<ui32>(static_cast<ui64>(nItems) * (i + 1) / nChunks);
+  }
+  return ranges;
+}
+
+//! \brief The command lists of one frame, in the order in which they are submitted.
+//!
+//! The main thread records into the current serial list. recordParallel() closes it, records one list per chunk on a
+//! thread pool and starts a new serial list, so commands recorded afterwards execute after all chunks. The lists are
+//! pooled and reused by the next begin(), which must wait until the GPU has finished the previous frame.
+//! \tparam CommandList Needs reset(), which starts recording, and close().
+template<class CommandList>
+class CommandListSequence
+{
+public:
+  //! \brief Creates a closed command list.
+  using Factory = std::function<std::unique_ptr<CommandList>()>;
+
+  //! \brief Creates the first serial list, so getCurrent() is valid before the first frame.
+  explicit CommandListSequence(Factory factory)
+      : m_factory(std::move(factory))
+      , m_nUsedLists(0)
+  {
+    m_lists.push_back(m_factory());
+    m_submissionOrder.push_back(m_lists.front().get());
+  }
+
+  //! \brief Starts a frame. The first list of the pool becomes the current serial list and is reset.
+  void begin()
+  {
+    m_submissionOrder.clear();
+    m_nUsedLists = 0;
+    beginSerial();
+  }
+
+  //! \brief Returns the serial list the main thread records into.
+  CommandList& getCurrent() const
+  {
+    return *m_submissionOrder.back();
+  }
+
+  //! \brief Records chunks in parallel and inserts them into the sequence at the current position. If a chunk throws,
+  //! the exception is rethrown and the frame has to be abandoned.
+  //! \param nChunks Number of chunks, each gets its own command list.
+  //! \param threadPool Threads that record the chunks. If nullptr, the chunks are recorded on the calling thread.
+  //! \param record Called once per chunk with a list that has just been reset. Must not close it.
+  void recordParallel(ui32 nChunks, ThreadPool* threadPool, const std::function<void(ui32, CommandList&)>& record)
+  {
+    if (nChunks == 0)
+    {
+      return;
+    }
+    getCurrent().close();
+
+    // Lists are taken from the pool on the calling thread, the workers only reset and fill them.
+    const size_t firstChunkList = m_submissionOrder.size();
+    for (ui32 i = 0; i < nChunks; i++)
+    {
+      m_submissionOrder.push_back(&acquire());
+    }
+    const auto recordChunk = [&](ui32 chunkIdx)
+    {
+      GIMS_PROFILE_ZONE("Record Chunk");
+      CommandList& commandList = *m_submissionOrder[firstChunkList + chunkIdx];
+      commandList.reset();
+      record(chunkIdx, commandList);
+      commandList.close();
+    };
+    if (threadPool)
+    {
+      threadPool->parallelFor(nChunks, recordChunk);
+    }
+    else
+    {
+      for (ui32 i = 0; i < nChunks; i++)
+      {
+        recordChunk(i);
+      }
+    }
+
+    beginSerial();
+  }
+
+  //! \brief Closes the current serial list and starts a new one, e.g., to let the GPU wait for another queue between
+  //! them.
+  //! \return Index of the new serial list in the submission order.
+  ui32 split()
+  {
+    getCurrent().close();
+    beginSerial();
+    return static_cast<ui32>(m_submissionOrder.size() - 1);
+  }
+
+  //! \brief Closes the current serial list and returns all lists of the frame in submission order.
+  const std::vector<CommandList*>& end()
+  {
+    getCurrent().close();
+    return m_submissionOrder;
+  }
+
+  //! \brief Returns the number of pooled command lists, i.e., the most lists a frame has used so far.
+  ui32 getNumberOfCommandLists() const
+  {
+    return static_cast<ui32>(m_lists.size());
+  }
+
+private:
+  CommandList& acquire()
+  {
+    if (m_nUsedLists == m_lists.size())
+    {
+      m_lists.push_back(m_factory());
+    }
+    return *m_lists[m_nUsedLists++];
+  }
+
+  void beginSerial()
+  {
+    CommandList& commandList = acquire();
+    commandList.reset();
+    m_submissionOrder.push_back(&commandList);
+  }
+
+  Factory                                   m_factory;         //! Creates the pooled lists.
+  std::vector<std::unique_ptr<CommandList>> m_lists;           //! Pool, in the order of first use within a frame.
+  std::vector<CommandList*>                 m_submissionOrder; //! Lists of the current frame in submission order.
+  size_t                                    m_nUsedLists;      //! Lists of the pool used by the current frame.
+};
+} // namespace gims
@@ -0,0 +1,136 @@
+#pragma once
+#include <functional>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <gimslib/types.hpp>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace gims
+{
+//! \brief Collects requests for objects that are expensive to create, e.g., pipeline states. Requests with the same
+//! hash share one entry, so each distinct object is created once. Pending entries are created in parallel by run().
+//! \tparam T Type of the created objects. Must be default constructible.
+template<class T>
+class DeduplicatedBatch
+{
+public:
+  //! \brief Requests an object. The object is created by the next call of run(), unless an entry with the same hash
+  //! exists already. Then create is dropped.
+  //! \param hash Hash of everything that determines the object.
+  //! \param create Creates the object. Called at most once, possibly on another thread.
+  //! \return Index of the entry.
+  ui32 request(ui64 hash, std::function<T()> create)
+  {
+    m_nRequests++;
+    const auto entryIter = m_hashToEntry.find(hash);
+    if (entryIter != m_hashToEntry.end())
+    {
+      return entryIter->second;
+    }
+    const ui32 entryIdx = static_cast<ui32>(m_entries.size());
+    m_entries.push_back({hash, std::move(create), T(), false});
+    m_pendingEntries.push_back(entryIdx);
+    m_hashToEntry.emplace(hash, entryIdx);
+    return entryIdx;
+  }
+
+  //! \brief Creates all pending entries and returns when they are done. If a creation throws, the first exception is
+  //! rethrown after all others have finished, and the failed entries stay pending.
+  //! \param threadPool Threads that create the entries. If nullptr, the entries are created on the calling thread.
+  //! \return The number of entries created.
+  ui32 run(ThreadPool* threadPool)
+  {
+    const std::vector<ui32> pendingEntries = std::move(m_pendingEntries);
+    m_pendingEntries.clear();
+    const auto createEntry = [&](ui32 i)
+    {
+      Entry& entry  = m_entries[pendingEntries[i]];
+      entry.value   = entry.create();
+      entry.created = true;
+      entry.create  = nullptr;
+    };
+
+    try
+    {
+      if (threadPool)
+      {
+        threadPool->parallelFor(static_cast<ui32>(pendingEntries.size()), createEntry);
+      }
+      else
+      {
+        for (ui32 i = 0; i < pendingEntries.size(); i++)
+        {
+          createEntry(i);
+        }
+      }
+    }
+    catch (...)
+    {
+      for (const ui32 entryIdx : pendingEntries)
+      {
+        if (!m_entries[entryIdx].created)
+        {
+          m_pendingEntries.push_back(entryIdx);
+        }
+      }
+      throw;
+    }
+    return static_cast<ui32>(pendingEntries.size());
+  }
+
+  //! \brief Returns the object of an entry. Throws if the entry has not been created yet.
+  const T& get(ui32 entryIdx) const
+  {
+    if (!m_entries.at(entryIdx).created)
+    {
+      throw std::logic_error("The entry has not been created yet. Call run() first.");
+    }
+    return m_entries[entryIdx].value;
+  }
+
+  //! \brief Returns the hash of an entry.
+  ui64 getHash(ui32 entryIdx) const
+  {
+    return m_entries.at(entryIdx).hash;
+  }
+
+  //! \brief Returns true, if the object of an entry has been created.
+  bool isCreated(ui32 entryIdx) const
+  {
+    return m_entries.at(entryIdx).created;
+  }
+
+  //! \brief Returns the number of calls of request().
+  ui32 getNumberOfRequests() const
+  {
+    return m_nRequests;
+  }
+
+  //! \brief Returns the number of distinct entries.
+  ui32 getNumberOfEntries() const
+  {
+    return static_cast<ui32>(m_entries.size());
+  }
+
+  //! \brief Returns the number of entries that wait for run().
+  ui32 getNumberOfPendingEntries() const
+  {
+    return static_cast<ui32>(m_pendingEntries.size());
+  }
+
+private:
+  struct Entry
+  {
+    ui64               hash;    //! Hash of the request.
+    std::function<T()> create;  //! Creates the value, reset once it has been called.
+    T                  value;   //! The created object.
+    bool               created; //! True, once value holds the object.
+  };
+
+  std::vector<Entry>             m_entries;        //! All distinct entries in the order of their first request.
+  std::vector<ui32>              m_pendingEntries; //! Entries that have not been created yet.
+  std::unordered_map<ui64, ui32> m_hashToEntry;    //! Maps a hash to its entry.
+  ui32                           m_nRequests = 0;  //! Number of calls of request().
+};
+} // namespace gims
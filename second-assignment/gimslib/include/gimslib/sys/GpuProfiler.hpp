@@ -0,0 +1,119 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gims
+{
+//! \brief Consecutive timestamp queries.
+struct GpuQueryRange
+{
+  ui32 first;
+  ui32 count;
+};
+
+//! \brief Time of a pass, in milliseconds.
+struct GpuPassTiming
+{
+  std::string name;                //! Name of the pass, passes of a frame with the same name are added up.
+  ui32        depth;               //! Number of passes that enclose it.
+  f64         milliseconds;        //! Of the last frame that has been read back.
+  f64         averageMilliseconds; //! Over the last frames that contained the pass.
+  f64         maxMilliseconds;     //! Over the same frames.
+  ui32        nFrames;             //! Number of frames of the averages.
+};
+
+//! \brief Allocates the timestamp queries of named GPU passes and turns their results into rolling averages.
+//!
+//! Each frame in flight has its own range of queries, so the results of a frame are read when its slot is used again,
+//! after the GPU has finished it, and reading never stalls. A pass takes one query for its begin and one for its end,
+//! and passes may be nested. Passes that do not fit into the range of a frame are not measured. See GpuProfilerD3D12
+//! for the queries.
+class GpuProfiler
+{
+public:
+  //! \brief Returned by beginPass and endPass if the pass is not measured.
+  static const ui32 invalidQuery = ~0u;
+
+  //! \param nFrames Frames in flight, each has its own queries.
+  //! \param maxPassesPerFrame Passes that are measured per frame.
+  //! \param timestampFrequency Ticks per second of the timestamps.
+  //! \param nAveragedFrames Frames of the rolling averages.
+  //! \throws std::invalid_argument If any of them is 0.
+  GpuProfiler(ui32 nFrames, ui32 maxPassesPerFrame, ui64 timestampFrequency, ui32 nAveragedFrames = 64);
+
+  //! \brief Returns the number of queries of all frames, the size of the query heap.
+  ui32 getNumberOfQueries() const;
+
+  //! \brief Starts a frame. The frame in the same slot before has to be finished on the GPU, its timestamps are read.
+  //! \param frameSlot Slot of the frame, e.g., the index of the back buffer.
+  //! \param timestamps Results of all queries, indexed by query, or nullptr if the results of the slot are lost, e.g.,
+  //! after the readback memory has been recreated.
+  //! \throws std::invalid_argument If frameSlot is not smaller than the number of frames.
+  //! \throws std::logic_error If the previous frame has not ended.
+  void beginFrame(ui32 frameSlot, const ui64* timestamps);
+
+  //! \brief Starts a pass inside the current pass.
+  //! \return Query for the timestamp at the begin of the pass, or invalidQuery if the frame has no queries left.
+  //! \throws std::logic_error If no frame has begun.
+  ui32 beginPass(const std::string& name);
+
+  //! \brief Ends the innermost pass.
+  //! \return Query for the timestamp at the end of the pass, or invalidQuery if the pass is not measured.
+  //! \throws std::logic_error If no pass has begun.
+  ui32 endPass();
+
+  //! \brief Ends the frame.
+  //! \return Queries of the frame, whose results have to be copied to the readback memory.
+  //! \throws std::logic_error If a pass has not ended.
+  GpuQueryRange endFrame();
+
+  //! \brief Returns the passes of the last frame that has been read back, in the order in which they began.
+  const std::vector<GpuPassTiming>& getPassTimings() const;
+
+  //! \brief Returns the number of frames that have been read back.
+  ui64 getNumberOfFrames() const;
+
+  //! \brief Returns the frame of getPassTimings, counted by beginFrame from 0. Only valid if a frame has been read.
+  ui64 getLastReadFrameIdx() const;
+
+  //! \brief Writes the pass timings as JSON, e.g., for scripts that compare runs.
+  void writeJson(std::ostream& stream) const;
+
+private:
+  struct Pass
+  {
+    std::string name;
+    ui32        depth;
+    ui32        beginQuery;
+    ui32        endQuery;
+  };
+
+  // Milliseconds of the last frames that contained a pass, as a ring.
+  struct PassHistory
+  {
+    std::vector<f64> milliseconds;
+    ui32             nextSample;
+  };
+
+  void readFrame(ui32 frameSlot, const ui64* timestamps);
+
+  ui32                                         m_nFrames;
+  ui32                                         m_maxPassesPerFrame;
+  f64                                          m_millisecondsPerTick;
+  ui32                                         m_nAveragedFrames;
+  std::vector<std::vector<Pass>>               m_framePasses;         //! Per frame slot, the passes to read back.
+  std::vector<ui64>                            m_frameIndices;        //! Per frame slot, the frame of its passes.
+  ui64                                         m_nBegunFrames;
+  ui64                                         m_lastReadFrameIdx;
+  ui32                                         m_currentFrameSlot;
+  bool                                         m_frameActive;
+  ui32                                         m_nUsedQueries;        //! Of the current frame.
+  std::vector<ui32>                            m_openPasses;          //! Indices of the passes that have not ended.
+  std::unordered_map<std::string, PassHistory> m_histories;           //! Per pass name.
+  std::vector<GpuPassTiming>                   m_passTimings;
+  ui64                                         m_nReadFrames;
+};
+} // namespace gims
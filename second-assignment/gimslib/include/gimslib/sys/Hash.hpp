@@ -0,0 +1,51 @@
+#pragma once
+#include <gimslib/types.hpp>
+#include <string>
+#include <type_traits>
+
+namespace gims
+{
+//! \brief Incremental 64-bit XXH64 hash with seed 0. Reads 32 bytes per step, so large buffers such as meshes and
+//! texture files hash at several bytes per cycle. Hashes do not depend on how the bytes are split into calls of add,
+//! and they are identical on every platform with the same byte order.
+class Hasher
+{
+public:
+  //! \brief Starts a new hash.
+  Hasher();
+
+  //! \brief Adds raw bytes to the hash.
+  //! \param data Pointer to the bytes.
+  //! \param sizeInBytes Number of bytes.
+  void add(const void* data, size_t sizeInBytes);
+
+  //! \brief Adds a string to the hash. The length is added as well, so "ab" + "c" and "a" + "bc" differ.
+  void add(const std::string& str);
+
+  //! \brief Adds a wide string to the hash. The length is added as well.
+  void add(const std::wstring& str);
+
+  //! \brief Adds the bytes of a trivially copyable value to the hash.
+  template<class T>
+  void addValue(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be hashed by their bytes.");
+    add(&value, sizeof(T));
+  }
+
+  //! \brief Returns the hash of everything added so far.
+  ui64 getValue() const;
+
+private:
+  ui64 m_accumulators[4]; //! Of the four lanes, each consumes 8 bytes of every 32 byte stripe.
+  ui8  m_buffer[32];      //! Bytes of the last stripe, until it is complete.
+  ui32 m_bufferSize;
+  ui64 m_totalSize;       //! Bytes added so far.
+};
+
+//! \brief Returns the XXH64 hash of a byte range, the same as adding it to a new Hasher.
+ui64 hashBytes(const void* data, size_t sizeInBytes);
+
+//! \brief Formats a hash as 16 lower case hexadecimal digits.
+std::string toHexString(ui64 hash);
+} // namespace gims
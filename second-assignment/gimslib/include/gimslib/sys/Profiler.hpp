@@ -0,0 +1,214 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <gimslib/types.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#ifdef GIMS_DISABLE_PROFILING
+#define GIMS_PROFILE_ZONE(name)
+#define GIMS_PROFILE_THREAD(name)
+#else
+#define GIMS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GIMS_PROFILE_CONCAT(a, b)      GIMS_PROFILE_CONCAT_IMPL(a, b)
+//! \brief Profiles the enclosing scope as a zone. name must be a string literal or otherwise outlive the captures.
+//! Expands to nothing if GIMS_DISABLE_PROFILING is defined, see the GIMS_PROFILING option of gimslib.
+#define GIMS_PROFILE_ZONE(name) const gims::ProfileZone GIMS_PROFILE_CONCAT(gimsProfileZone, __LINE__)(name)
+//! \brief Names the calling thread in captures. Expands to nothing if GIMS_DISABLE_PROFILING is defined.
+#define GIMS_PROFILE_THREAD(name) gims::Profiler::get().setThreadName(name)
+#endif
+
+namespace gims
+{
+//! \brief A zone that has ended.
+struct ProfileEvent
+{
+  const char* name;    //! Name passed to the zone.
+  ui64        startNs; //! Nanoseconds since the profiler was created, ticks in ProfileThreadBuffer::capture.
+  ui64        endNs;   //! Nanoseconds since the profiler was created, ticks in ProfileThreadBuffer::capture.
+  ui32        depth;   //! Number of zones of the same thread that enclose it.
+};
+
+//! \brief The events of one thread.
+struct ProfileThreadCapture
+{
+  ui32                      threadIdx;  //! Index in the order in which the threads started their first zone.
+  std::string               threadName; //! Set by GIMS_PROFILE_THREAD, "Thread <threadIdx>" otherwise.
+  std::vector<ProfileEvent> events;     //! In the order in which the zones ended.
+  bool                      incomplete; //! True, if events of the time range were overwritten before the capture.
+};
+
+//! \brief The events of all threads in a time range.
+struct ProfileCapture
+{
+  ui64                              startNs; //! Events that ended before are not captured.
+  ui64                              endNs;   //! Time of the capture.
+  std::vector<ProfileThreadCapture> threads; //! Threads with at least one event.
+};
+
+//! \brief Ring buffer with the last events of one thread. Only the thread itself writes into it, captures read it from
+//! any thread without locks, and skip the events that were overwritten while they were read.
+//!
+//! The slots are written with plain stores between the two counters, like a sequence lock, so recording an event
+//! costs a few nanoseconds and a zone costs little more than its two reads of the clock.
+class ProfileThreadBuffer
+{
+public:
+  //! \brief Number of events kept per thread, a power of two.
+  static const ui32 capacity = 1u << 14;
+
+  explicit ProfileThreadBuffer(ui32 threadIdx);
+
+  //! \brief Starts a zone. Only call from the owning thread.
+  void beginZone()
+  {
+    m_depth++;
+  }
+
+  //! \brief Ends the innermost zone and records it. Only call from the owning thread.
+  void endZone(const char* name, ui64 startTicks, ui64 endTicks)
+  {
+    const ui64 eventIdx = m_nWritten.load(std::memory_order_relaxed);
+    Slot&      slot     = m_slots[eventIdx & (capacity - 1)];
+    m_depth--;
+
+    // A capture that reads any part of the new event also sees m_nStarted and drops the overwritten one.
+    m_nStarted.store(eventIdx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name       = name;
+    slot.startTicks = startTicks;
+    slot.endTicks   = endTicks;
+    slot.depth      = m_depth;
+    m_nWritten.store(eventIdx + 1, std::memory_order_release);
+  }
+
+  //! \brief Copies the events that ended at or after startTicks, with timestamps in ticks. Can be called from any
+  //! thread.
+  ProfileThreadCapture capture(ui64 startTicks) const;
+
+  void setName(const std::string& name);
+
+  ProfileThreadBuffer(const ProfileThreadBuffer& other)            = delete;
+  ProfileThreadBuffer& operator=(const ProfileThreadBuffer& other) = delete;
+
+private:
+  struct Slot
+  {
+    const char* name;
+    ui64        startTicks;
+    ui64        endTicks;
+    ui32        depth;
+  };
+
+  std::array<Slot, capacity> m_slots;     //! Event i is in slot i % capacity.
+  std::atomic<ui64>          m_nStarted;  //! Events whose slot is being written or has been written.
+  std::atomic<ui64>          m_nWritten;  //! Events that have been written completely.
+  ui32                       m_depth;     //! Zones of the thread that have not ended yet.
+  const ui32                 m_threadIdx;
+  mutable std::mutex         m_nameMutex; //! Guards m_name, which captures read from other threads.
+  std::string                m_name;
+};
+
+//! \brief Records zones of all threads into per thread ring buffers, which can be captured at any time, e.g., to
+//! display the last frames or to write them to a Chrome trace.
+//!
+//! Zones are recorded with the cheapest clock available, the time stamp counter on x86-64, and converted to
+//! nanoseconds by the captures. The conversion is calibrated with std::chrono::steady_clock over the lifetime of the
+//! profiler, which assumes an invariant time stamp counter as all x86-64 CPUs of the last decade have.
+class Profiler
+{
+public:
+  //! \brief Returns the profiler of the process.
+  static Profiler& get();
+
+  //! \brief Returns the current time in ticks of the clock of the zones.
+  static ui64 getTicks()
+  {
+#if defined(_M_X64) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return static_cast<ui64>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  //! \brief Returns the nanoseconds since the profiler was created.
+  ui64 now() const;
+
+  //! \brief Returns the buffer of the calling thread, which is created by its first call.
+  static ProfileThreadBuffer& getThreadBuffer()
+  {
+    if (!m_threadBuffer)
+    {
+      m_threadBuffer = &get().createThreadBuffer();
+    }
+    return *m_threadBuffer;
+  }
+
+  //! \brief Names the calling thread in captures.
+  void setThreadName(const std::string& name);
+
+  //! \brief Copies the events of all threads that ended at or after startNs.
+  ProfileCapture capture(ui64 startNs = 0) const;
+
+  //! \brief Measures the average cost of an empty zone on a new thread, so the buffers of other threads are kept.
+  //! \return Nanoseconds per zone, including both timestamps and the recording.
+  f64 measureZoneOverhead(ui32 nZones = 1u << 20);
+
+  Profiler(const Profiler& other)            = delete;
+  Profiler& operator=(const Profiler& other) = delete;
+
+private:
+  Profiler();
+
+  ProfileThreadBuffer& createThreadBuffer();
+
+  // Returns the nanoseconds per tick, measured since the profiler was created.
+  f64 getNanosecondsPerTick() const;
+
+  const ui64                                        m_startTicks;
+  const std::chrono::steady_clock::time_point       m_startTime;
+  mutable std::mutex                                m_mutex;   //! Guards m_buffers.
+  std::vector<std::unique_ptr<ProfileThreadBuffer>> m_buffers; //! Per thread, kept after the thread ended.
+
+  static inline thread_local ProfileThreadBuffer* m_threadBuffer = nullptr; //! Buffer of the calling thread.
+};
+
+//! \brief Records the lifetime of a scope as a zone, see GIMS_PROFILE_ZONE.
+class ProfileZone
+{
+public:
+  explicit ProfileZone(const char* name)
+      : m_buffer(Profiler::getThreadBuffer())
+      , m_name(name)
+  {
+    m_buffer.beginZone();
+    m_startTicks = Profiler::getTicks();
+  }
+
+  ~ProfileZone()
+  {
+    m_buffer.endZone(m_name, m_startTicks, Profiler::getTicks());
+  }
+
+  ProfileZone(const ProfileZone& other)            = delete;
+  ProfileZone& operator=(const ProfileZone& other) = delete;
+
+private:
+  ProfileThreadBuffer& m_buffer;
+  const char*          m_name;
+  ui64                 m_startTicks;
+};
+
+//! \brief Writes a capture in the Chrome trace event format, which chrome://tracing and Perfetto display.
+//! \throws std::runtime_error If the file cannot be written.
+void writeChromeTrace(const ProfileCapture& capture, const std::filesystem::path& path);
+} // namespace gims
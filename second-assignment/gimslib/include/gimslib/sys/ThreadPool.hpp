@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <gimslib/types.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gims
+{
+//! \brief A fixed set of worker threads that execute parallel loops.
+class ThreadPool
+{
+public:
+  //! \brief Starts the worker threads.
+  //! \param nThreads Total number of threads working on a loop, including the calling thread. 0 selects the number of
+  //!                 hardware threads.
+  explicit ThreadPool(ui32 nThreads = 0);
+
+  //! \brief Stops and joins the worker threads.
+  ~ThreadPool();
+
+  //! \brief Returns the total number of threads working on a loop, including the calling thread.
+  ui32 getNumberOfThreads() const;
+
+  //! \brief Calls task(i) for every i in [0, nTasks) and returns when all calls have finished. The calling thread
+  //! takes part in the work. Tasks are handed out in ascending order, but may finish in any order. If a task throws,
+  //! the first exception is rethrown after all tasks have finished. Must not be called from within a task. Loops of
+  //! several calling threads, e.g., of an update and a render thread, are executed one after the other.
+  //! \param nTasks Number of tasks.
+  //! \param task Function that is called once per task index.
+  void parallelFor(ui32 nTasks, const std::function<void(ui32)>& task);
+
+  ThreadPool(const ThreadPool& other)            = delete;
+  ThreadPool(ThreadPool&& other)                 = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+  ThreadPool& operator=(ThreadPool&& other)      = delete;
+
+private:
+  void workerLoop();
+  void runTasks();
+
+  std::vector<std::thread>         m_workers;           //! The worker threads.
+  std::mutex                       m_loopMutex;         //! Held by the calling thread for the whole loop.
+  std::mutex                       m_mutex;             //! Guards everything below except m_nextTask.
+  std::condition_variable          m_wakeUp;            //! Signals a new loop or shutdown to the workers.
+  std::condition_variable          m_finished;          //! Signals that the last worker left the current loop.
+  const std::function<void(ui32)>* m_task;              //! Task of the current loop.
+  ui32                             m_nTasks;            //! Number of tasks of the current loop.
+  std::atomic<ui32>                m_nextTask;          //! Next task index to hand out.
+  ui32                             m_nBusyWorkers;      //! Workers that have not left the current loop yet.
+  ui64                             m_generation;        //! Incremented for every loop.
+  bool                             m_stop;              //! True if the workers shall terminate.
+  std::exception_ptr               m_firstException;    //! First exception thrown by a task of the current loop.
+};
+} // namespace gims
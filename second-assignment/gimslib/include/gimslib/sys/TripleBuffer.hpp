@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <gimslib/types.hpp>
+
+namespace gims
+{
+//! \brief Hands values from one producer thread to one consumer thread without locks.
+//!
+//! The producer fills the write buffer and publishes it, the consumer acquires the most recently published buffer and
+//! reads it. Both sides own one of the three buffers at any time and swap it with the third one, the middle buffer, in
+//! a single atomic exchange. Neither side ever waits for the other: the producer may publish faster than the consumer
+//! acquires, in which case older values are skipped, and the consumer keeps reading its buffer until a newer one was
+//! published. Buffers are reused, so the producer has to overwrite all of the write buffer or rely on the values it
+//! published two buffers ago.
+//! \tparam T Value type, is default constructed or copied into all three buffers.
+template<class T>
+class TripleBuffer
+{
+public:
+  //! \brief Creates the buffers with the same initial value, which the consumer reads until the first publish().
+  explicit TripleBuffer(const T& initialValue = T())
+      : m_buffers {initialValue, initialValue, initialValue}
+      , m_writeIdx(0)
+      , m_middle(1)
+      , m_readIdx(2)
+  {
+  }
+
+  //! \brief Returns the buffer the producer fills. Only call from the producer thread.
+  T& getWriteBuffer()
+  {
+    return m_buffers[m_writeIdx];
+  }
+
+  //! \brief Makes the write buffer the latest value and continues with another buffer. Only call from the producer
+  //! thread.
+  void publish()
+  {
+    // Release makes the contents of the buffer visible to the consumer that acquires it.
+    m_writeIdx = m_middle.exchange(m_writeIdx | newBit, std::memory_order_acq_rel) & indexMask;
+  }
+
+  //! \brief Makes the latest published value the read buffer. Only call from the consumer thread.
+  //! \return True, if a value was published since the last call, otherwise the read buffer is left unchanged.
+  bool acquire()
+  {
+    if ((m_middle.load(std::memory_order_relaxed) & newBit) == 0)
+    {
+      return false;
+    }
+    // Only the consumer clears the bit, so the middle buffer is still new when it is exchanged.
+    m_readIdx = m_middle.exchange(m_readIdx, std::memory_order_acq_rel) & indexMask;
+    return true;
+  }
+
+  //! \brief Returns the buffer the consumer reads. Only call from the consumer thread.
+  const T& getReadBuffer() const
+  {
+    return m_buffers[m_readIdx];
+  }
+
+  TripleBuffer(const TripleBuffer& other)            = delete;
+  TripleBuffer(TripleBuffer&& other)                 = delete;
+  TripleBuffer& operator=(const TripleBuffer& other) = delete;
+  TripleBuffer& operator=(TripleBuffer&& other)      = delete;
+
+private:
+  static constexpr ui32 indexMask = 0x3; //! Bits of m_middle that hold the index.
+  static constexpr ui32 newBit    = 0x4; //! Set in m_middle if the middle buffer was published but not acquired.
+
+  std::array<T, 3>  m_buffers;  //! The three buffers, each owned by the producer, the consumer, or neither.
+  ui32              m_writeIdx; //! Buffer of the producer.
+  std::atomic<ui32> m_middle;   //! Buffer of neither, with newBit.
+  ui32              m_readIdx;  //! Buffer of the consumer.
+};
+} // namespace gims
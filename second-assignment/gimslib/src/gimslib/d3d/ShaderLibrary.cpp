@@ -0,0 +1,61 @@
+#include <gimslib/d3d/ShaderLibrary.hpp>
+
+namespace gims
+{
+std::wstring getShaderDefinesKey(const std::vector<ShaderDefine>& defines)
+{
+  std::wstring key;
+  for (const auto& define : defines)
+  {
+    key += (key.empty() ? L"" : L",") + define.name + L"=" + define.value;
+  }
+  return key;
+}
+
+ShaderLibrary& ShaderLibrary::getEmbedded()
+{
+  // A function local static, so registrations of other translation units may run before or after this one.
+  static ShaderLibrary embeddedShaders;
+  return embeddedShaders;
+}
+
+void ShaderLibrary::add(const EmbeddedShader* shaders, size_t nShaders)
+{
+  for (size_t i = 0; i < nShaders; i++)
+  {
+    const EmbeddedShader& shader = shaders[i];
+    m_shaders[getKey(shader.shaderName, shader.entryPoint, shader.targetProfile, shader.defines)] = {
+        shader.bytecode, shader.sizeInBytes};
+  }
+}
+
+bool ShaderLibrary::find(const std::filesystem::path& shaderFile, const wchar_t* entryPoint,
+                         const wchar_t* targetProfile, const std::vector<ShaderDefine>& defines,
+                         D3D12_SHADER_BYTECODE& bytecode) const
+{
+  const auto shaderIter =
+      m_shaders.find(getKey(shaderFile.filename().wstring(), entryPoint, targetProfile, getShaderDefinesKey(defines)));
+  if (shaderIter == m_shaders.end())
+  {
+    return false;
+  }
+  bytecode = shaderIter->second;
+  return true;
+}
+
+size_t ShaderLibrary::getNumberOfShaders() const
+{
+  return m_shaders.size();
+}
+
+std::wstring ShaderLibrary::getKey(const std::wstring& shaderName, const std::wstring& entryPoint,
+                                   const std::wstring& targetProfile, const std::wstring& defines)
+{
+  return shaderName + L"|" + entryPoint + L"|" + targetProfile + L"|" + defines;
+}
+
+EmbeddedShaderRegistration::EmbeddedShaderRegistration(const EmbeddedShader* shaders, size_t nShaders)
+{
+  ShaderLibrary::getEmbedded().add(shaders, nShaders);
+}
+} // namespace gims
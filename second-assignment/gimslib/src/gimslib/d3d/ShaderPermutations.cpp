@@ -0,0 +1,72 @@
+#include <gimslib/d3d/ShaderPermutations.hpp>
+#include <stdexcept>
+
+namespace gims
+{
+ShaderFeatureSet::ShaderFeatureSet(const std::vector<std::wstring>& featureNames)
+    : m_featureNames(featureNames)
+{
+  if (m_featureNames.size() > 32)
+  {
+    throw std::invalid_argument("A shader feature set supports at most 32 features.");
+  }
+}
+
+ui32 ShaderFeatureSet::getNumberOfFeatures() const
+{
+  return static_cast<ui32>(m_featureNames.size());
+}
+
+ui64 ShaderFeatureSet::getNumberOfPermutations() const
+{
+  return 1ull << m_featureNames.size();
+}
+
+ui32 ShaderFeatureSet::getFeatureBit(const std::wstring& featureName) const
+{
+  for (ui32 i = 0; i < m_featureNames.size(); i++)
+  {
+    if (m_featureNames[i] == featureName)
+    {
+      return 1u << i;
+    }
+  }
+  throw std::invalid_argument("Unknown shader feature.");
+}
+
+ui32 ShaderFeatureSet::getAllFeaturesMask() const
+{
+  return static_cast<ui32>(getNumberOfPermutations() - 1);
+}
+
+std::vector<ShaderDefine> ShaderFeatureSet::getDefines(ui32 permutation) const
+{
+  std::vector<ShaderDefine> defines(m_featureNames.size());
+  for (ui32 i = 0; i < m_featureNames.size(); i++)
+  {
+    defines[i].name  = m_featureNames[i];
+    defines[i].value = (permutation >> i) & 1 ? L"1" : L"0";
+  }
+  return defines;
+}
+
+std::string ShaderFeatureSet::getDescription(ui32 permutation) const
+{
+  std::string description;
+  for (ui32 i = 0; i < m_featureNames.size(); i++)
+  {
+    if ((permutation >> i) & 1)
+    {
+      if (!description.empty())
+      {
+        description += "|";
+      }
+      for (const wchar_t c : m_featureNames[i])
+      {
+        description += static_cast<char>(c);
+      }
+    }
+  }
+  return description.empty() ? "none" : description;
+}
+} // namespace gims
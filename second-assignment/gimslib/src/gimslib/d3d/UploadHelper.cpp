@@ -2,6 +2,7 @@
 #include <gimslib/d3d/DX12Util.hpp>
 #include <gimslib/d3d/UploadHelper.hpp>
 #include <gimslib/dbg/HrException.hpp>
+#include <gimslib/sys/Profiler.hpp>
 namespace gims
 {
 
@@ -26,8 +27,9 @@ UploadHelper::~UploadHelper()
 }
 
 void UploadHelper::uploadBuffer(const void* const src, ComPtr<ID3D12Resource>& dst, size_t size,
-                                const ComPtr<ID3D12CommandQueue>& commandQueue)
+                                const ComPtr<ID3D12CommandQueue>& commandQueue, D3D12_RESOURCE_STATES targetState)
 {
+  GIMS_PROFILE_ZONE("Upload Buffer");
   void* cpuMappedUploadBuffer = nullptr;
   throwIfFailed(m_uploadBuffer->Map(0, nullptr, &cpuMappedUploadBuffer));
   throwIfNullptr(cpuMappedUploadBuffer);
@@ -35,8 +37,7 @@ void UploadHelper::uploadBuffer(const void* const src, ComPtr<ID3D12Resource>& d
   m_uploadBuffer->Unmap(0, nullptr);
   m_uploadCommandList->CopyBufferRegion(dst.Get(), 0, m_uploadBuffer.Get(), 0, size);
 
-  auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(dst.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
-                                                      D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+  auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(dst.Get(), D3D12_RESOURCE_STATE_COPY_DEST, targetState);
   m_uploadCommandList->ResourceBarrier(1, &barrier);
   m_uploadCommandList->Close();
   executeUploadSync(commandQueue);
@@ -49,9 +50,17 @@ void UploadHelper::uploadTexture(const void* const imageData, ComPtr<ID3D12Resou
   textureData.pData                  = imageData;
   textureData.RowPitch               = textureWidth * 4;
   textureData.SlicePitch             = textureData.RowPitch * textureHeight;
-  UpdateSubresources(m_uploadCommandList.Get(), texture.Get(), m_uploadBuffer.Get(), 0, 0, 1, &textureData);
-      const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
-                                                                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+  uploadTexture(&textureData, 1, texture, commandQueue);
+}
+
+void UploadHelper::uploadTexture(const D3D12_SUBRESOURCE_DATA* subresources, ui32 nSubresources,
+                                 ComPtr<ID3D12Resource> texture, const ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+  GIMS_PROFILE_ZONE("Upload Texture");
+  UpdateSubresources(m_uploadCommandList.Get(), texture.Get(), m_uploadBuffer.Get(), 0, 0, nSubresources,
+                     subresources);
+  const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
+                                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
   m_uploadCommandList->ResourceBarrier(1, &barrier);
   m_uploadCommandList->Close();
   executeUploadSync(commandQueue);
@@ -60,6 +69,7 @@ void UploadHelper::uploadTexture(const void* const imageData, ComPtr<ID3D12Resou
 void UploadHelper::uploadDefaultBuffer(const void* const src, ComPtr<ID3D12Resource>& dst, size_t size,
                                        const ComPtr<ID3D12CommandQueue>& commandQueue)
 {
+  GIMS_PROFILE_ZONE("Upload Buffer");
   void* cpuMappedUploadBuffer = nullptr;
   throwIfFailed(m_uploadBuffer->Map(0, nullptr, &cpuMappedUploadBuffer));
   throwIfNullptr(cpuMappedUploadBuffer);
@@ -94,6 +104,7 @@ void UploadHelper::uploadConstantBuffer(const void* const src, const ComPtr<ID3D
 
 void UploadHelper::executeUploadSync(const ComPtr<ID3D12CommandQueue>& commandQueue)
 {
+  GIMS_PROFILE_ZONE("Wait for Upload");
   ComPtr<ID3D12Fence> uploadFence;
   m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&uploadFence));
 
@@ -2,6 +2,7 @@
 #include <d3dx12/d3dx12.h>
 #include <gimslib/d3d/DX12Util.hpp>
 #include <gimslib/dbg/HrException.hpp>
+#include <gimslib/sys/Profiler.hpp>
 
 namespace
 {
@@ -152,12 +153,16 @@ void SwapChainAdapter::waitForGPU()
 void SwapChainAdapter::nextFrame(bool useVSync)
 {
   HRESULT hr;
-  hr = m_swapChain->Present(useVSync ? 1 : 0, 0);
+  {
+    GIMS_PROFILE_ZONE("Present");
+    hr = m_swapChain->Present(useVSync ? 1 : 0, 0);
+  }
 
   gims::DX12Util::throwOnDeviceLost(m_device, hr, "presenting");
   const auto currentFenceValue = m_fenceValues[m_frameIndex];
   throwIfFailed(m_commandQueue->Signal(m_fence.Get(), currentFenceValue));
   m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+  GIMS_PROFILE_ZONE("Wait for Frame");
   DX12Util::waitForFence(m_fence, m_fenceValues[m_frameIndex], m_fenceEvent.getHandle());
   m_fenceValues[m_frameIndex] = currentFenceValue + 1;
 }
@@ -0,0 +1,91 @@
+#include <fstream>
+#include <gimslib/io/CameraPath.hpp>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+const char* const CAMERA_PATH_HEADER = "# gims camera path 1: rotation w x y z, translation x y z";
+} // namespace
+
+namespace gims
+{
+void CameraPath::add(const CameraPose& pose)
+{
+  m_poses.push_back(pose);
+}
+
+void CameraPath::clear()
+{
+  m_poses.clear();
+}
+
+ui32 CameraPath::getNumberOfPoses() const
+{
+  return static_cast<ui32>(m_poses.size());
+}
+
+const CameraPose& CameraPath::getPose(ui64 frameIdx) const
+{
+  if (m_poses.empty())
+  {
+    throw std::logic_error("The camera path has no poses.");
+  }
+  return m_poses[frameIdx % m_poses.size()];
+}
+
+void CameraPath::save(const std::filesystem::path& path) const
+{
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+  stream.precision(std::numeric_limits<f32>::max_digits10);
+  stream << CAMERA_PATH_HEADER << "\n";
+  for (const auto& pose : m_poses)
+  {
+    stream << pose.rotation.w << " " << pose.rotation.x << " " << pose.rotation.y << " " << pose.rotation.z << " "
+           << pose.translation.x << " " << pose.translation.y << " " << pose.translation.z << "\n";
+  }
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to write " + path.string());
+  }
+}
+
+CameraPath CameraPath::load(const std::filesystem::path& path)
+{
+  std::ifstream stream(path);
+  if (!stream)
+  {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+
+  CameraPath  result;
+  std::string line;
+  for (ui32 lineIdx = 1; std::getline(stream, line); lineIdx++)
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    std::istringstream lineStream(line);
+    CameraPose         pose;
+    lineStream >> pose.rotation.w >> pose.rotation.x >> pose.rotation.y >> pose.rotation.z >> pose.translation.x >>
+        pose.translation.y >> pose.translation.z;
+    if (!lineStream)
+    {
+      throw std::runtime_error(path.string() + ":" + std::to_string(lineIdx) + " is not a camera pose.");
+    }
+    result.add(pose);
+  }
+  if (result.m_poses.empty())
+  {
+    throw std::runtime_error(path.string() + " has no camera poses.");
+  }
+  return result;
+}
+} // namespace gims
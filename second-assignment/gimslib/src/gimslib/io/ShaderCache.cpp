@@ -0,0 +1,255 @@
+#include <fstream>
+#include <gimslib/io/ShaderCache.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+
+namespace
+{
+const gims::ui32 CACHE_FILE_MAGIC   = 0x43534d47; // "GMSC"
+const gims::ui32 CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader
+{
+  gims::ui32 magic;
+  gims::ui32 version;
+  gims::ui64 key;
+  gims::ui64 objectSizeInBytes;
+  gims::ui64 reflectionSizeInBytes;
+};
+
+bool readFile(const std::filesystem::path& file, std::string& content)
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  return !stream.bad();
+}
+
+/// <summary>
+/// Returns the name of the file in an #include directive, or an empty string if the line is none.
+/// </summary>
+std::string parseIncludeDirective(const std::string& line)
+{
+  size_t i = line.find_first_not_of(" \t");
+  if (i == std::string::npos || line[i] != '#')
+  {
+    return std::string();
+  }
+  i = line.find_first_not_of(" \t", i + 1);
+  if (i == std::string::npos || line.compare(i, 7, "include") != 0)
+  {
+    return std::string();
+  }
+  i = line.find_first_not_of(" \t", i + 7);
+  if (i == std::string::npos || (line[i] != '"' && line[i] != '<'))
+  {
+    return std::string();
+  }
+  const char   closing = line[i] == '"' ? '"' : '>';
+  const size_t end     = line.find(closing, i + 1);
+  if (end == std::string::npos)
+  {
+    return std::string();
+  }
+  return line.substr(i + 1, end - i - 1);
+}
+
+void findShaderIncludesImpl(const std::filesystem::path& file, const std::vector<std::filesystem::path>& directories,
+                            std::set<std::filesystem::path>& includes)
+{
+  std::string content;
+  if (!readFile(file, content))
+  {
+    return;
+  }
+  size_t lineStart = 0;
+  while (lineStart < content.size())
+  {
+    size_t lineEnd = content.find('\n', lineStart);
+    if (lineEnd == std::string::npos)
+    {
+      lineEnd = content.size();
+    }
+    const std::string includeName = parseIncludeDirective(content.substr(lineStart, lineEnd - lineStart));
+    lineStart                     = lineEnd + 1;
+    if (includeName.empty())
+    {
+      continue;
+    }
+
+    std::vector<std::filesystem::path> candidates = {file.parent_path() / includeName};
+    for (const auto& directory : directories)
+    {
+      candidates.push_back(directory / includeName);
+    }
+    for (const auto& candidate : candidates)
+    {
+      std::error_code errorCode;
+      if (std::filesystem::is_regular_file(candidate, errorCode))
+      {
+        const auto normalized = std::filesystem::weakly_canonical(candidate, errorCode).lexically_normal();
+        if (includes.insert(normalized).second)
+        {
+          findShaderIncludesImpl(normalized, directories, includes);
+        }
+        break;
+      }
+    }
+  }
+}
+} // namespace
+
+namespace gims
+{
+std::vector<std::filesystem::path> findShaderIncludes(const std::filesystem::path&              shaderFile,
+                                                      const std::vector<std::filesystem::path>& includeDirectories)
+{
+  std::set<std::filesystem::path> includes;
+  findShaderIncludesImpl(shaderFile, includeDirectories, includes);
+  return std::vector<std::filesystem::path>(includes.begin(), includes.end());
+}
+
+ShaderCache::ShaderCache()
+{
+}
+
+ShaderCache::ShaderCache(const std::filesystem::path& directory)
+    : m_directory(directory)
+{
+  if (!m_directory.empty())
+  {
+    std::error_code errorCode;
+    std::filesystem::create_directories(m_directory, errorCode);
+  }
+}
+
+bool ShaderCache::isEnabled() const
+{
+  return !m_directory.empty();
+}
+
+ui64 ShaderCache::computeKey(const std::filesystem::path& shaderFile, const std::wstring& entryPoint,
+                             const std::wstring& targetProfile, const std::vector<ShaderDefine>& defines,
+                             ui64 compilerVersion, const std::vector<std::filesystem::path>& includeDirectories) const
+{
+  Hasher hasher;
+  hasher.addValue(CACHE_FILE_VERSION);
+  hasher.addValue(compilerVersion);
+  hasher.add(entryPoint);
+  hasher.add(targetProfile);
+  hasher.addValue(static_cast<ui64>(defines.size()));
+  for (const auto& define : defines)
+  {
+    hasher.add(define.name);
+    hasher.add(define.value);
+  }
+  // The directories decide which of several files with the same name an include resolves to.
+  hasher.addValue(static_cast<ui64>(includeDirectories.size()));
+  for (const auto& directory : includeDirectories)
+  {
+    hasher.add(directory.generic_string());
+  }
+
+  std::string content;
+  if (!readFile(shaderFile, content))
+  {
+    throw std::runtime_error("Unable to load " + shaderFile.string());
+  }
+  hasher.add(content);
+
+  // Only the contents of the includes matter, their location may differ between checkouts.
+  for (const auto& include : findShaderIncludes(shaderFile, includeDirectories))
+  {
+    if (readFile(include, content))
+    {
+      hasher.add(content);
+    }
+  }
+  return hasher.getValue();
+}
+
+bool ShaderCache::load(ui64 key, ShaderCacheEntry& entry) const
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+  std::ifstream stream(getEntryPath(key), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+  CacheFileHeader header = {};
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream || header.magic != CACHE_FILE_MAGIC || header.version != CACHE_FILE_VERSION || header.key != key)
+  {
+    return false;
+  }
+  // The sizes must add up to the rest of the file, so a damaged header never makes us allocate more than the file.
+  stream.seekg(0, std::ios::end);
+  const std::streamoff fileSize = stream.tellg();
+  stream.seekg(sizeof(header), std::ios::beg);
+  if (!stream || fileSize < static_cast<std::streamoff>(sizeof(header)))
+  {
+    return false;
+  }
+  const ui64 remainingSize = static_cast<ui64>(fileSize) - sizeof(header);
+  if (header.objectSizeInBytes > remainingSize ||
+      header.reflectionSizeInBytes != remainingSize - header.objectSizeInBytes)
+  {
+    return false;
+  }
+  entry.object.resize(header.objectSizeInBytes);
+  entry.reflection.resize(header.reflectionSizeInBytes);
+  stream.read(reinterpret_cast<char*>(entry.object.data()), entry.object.size());
+  stream.read(reinterpret_cast<char*>(entry.reflection.data()), entry.reflection.size());
+  return static_cast<bool>(stream) && !entry.object.empty();
+}
+
+bool ShaderCache::store(ui64 key, const ShaderCacheEntry& entry) const
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  // Written to a temporary file first, so a crash or a second process never leaves a half written entry behind.
+  const std::filesystem::path entryPath     = getEntryPath(key);
+  std::filesystem::path       temporaryPath = entryPath;
+  temporaryPath += ".tmp";
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+      return false;
+    }
+    const CacheFileHeader header = {CACHE_FILE_MAGIC, CACHE_FILE_VERSION, key, entry.object.size(),
+                                    entry.reflection.size()};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(entry.object.data()), entry.object.size());
+    stream.write(reinterpret_cast<const char*>(entry.reflection.data()), entry.reflection.size());
+    if (!stream)
+    {
+      return false;
+    }
+  }
+  std::error_code errorCode;
+  std::filesystem::rename(temporaryPath, entryPath, errorCode);
+  if (errorCode)
+  {
+    std::filesystem::remove(temporaryPath, errorCode);
+    return false;
+  }
+  return true;
+}
+
+std::filesystem::path ShaderCache::getEntryPath(ui64 key) const
+{
+  return m_directory / (toHexString(key) + ".shader");
+}
+} // namespace gims
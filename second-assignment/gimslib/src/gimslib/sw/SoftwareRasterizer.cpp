@@ -0,0 +1,738 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <gimslib/sys/Profiler.hpp>
+#include <stdexcept>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GIMS_SOFTWARE_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+using namespace gims;
+
+// Screen positions have 4 fractional bits, like the 8 of D3D12 hardware they make the edge functions exact.
+const i32 subpixelBits  = 4;
+const i32 subpixelScale = 1 << subpixelBits;
+// Screen positions stay within this many pixels around the screen, so the edge functions fit into 64 bits.
+const f32 guardBandPixels = 16384.0f;
+// Minimum number of triangles that are set up by one task.
+const ui64 minTrianglesPerChunk = 1024;
+// Number of vertices that are transformed by one task.
+const ui64 verticesPerTask = 16384;
+
+using Clock = std::chrono::steady_clock;
+
+f64 getMilliseconds(Clock::time_point start, Clock::time_point end)
+{
+  return std::chrono::duration<f64, std::milli>(end - start).count();
+}
+
+// Returns the entry of prefix sums that contains the element.
+ui32 findRange(const std::vector<ui64>& offsets, ui64 element)
+{
+  return static_cast<ui32>(std::upper_bound(offsets.begin(), offsets.end(), element) - offsets.begin()) - 1;
+}
+
+// Linear colors of the 8 bit values of SRGB textures.
+struct SrgbTable
+{
+  f32 values[256];
+
+  SrgbTable()
+  {
+    for (ui32 i = 0; i < 256; i++)
+    {
+      const f32 c = static_cast<f32>(i) / 255.0f;
+      values[i]   = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+  }
+};
+
+f32v3 sampleTexture(const SoftwareTexture& texture, const f32v2& textureCoordinate)
+{
+  static const SrgbTable srgbTable;
+
+  // Point filtering with wrapping, like the static sampler of the viewers.
+  const f32   u     = textureCoordinate.x - std::floor(textureCoordinate.x);
+  const f32   v     = textureCoordinate.y - std::floor(textureCoordinate.y);
+  const ui32  x     = std::min(static_cast<ui32>(u * static_cast<f32>(texture.width)), texture.width - 1);
+  const ui32  y     = std::min(static_cast<ui32>(v * static_cast<f32>(texture.height)), texture.height - 1);
+  const ui8v4 texel = texture.texels[static_cast<size_t>(y) * texture.width + x];
+  if (texture.srgb)
+  {
+    return f32v3(srgbTable.values[texel.x], srgbTable.values[texel.y], srgbTable.values[texel.z]);
+  }
+  return f32v3(texel) / 255.0f;
+}
+
+// pow as HLSL computes it, so the results agree for a base or exponent of 0.
+f32 hlslPow(f32 base, f32 exponent)
+{
+  return std::exp2(exponent * std::log2(base));
+}
+
+// Conversion of a shader output to UNORM, which writes NaN as 0.
+ui8 toUnorm(f32 value)
+{
+  if (!(value > 0.0f))
+  {
+    return 0;
+  }
+  return static_cast<ui8>(std::min(value, 1.0f) * 255.0f + 0.5f);
+}
+
+ui8v4 toUnorm(const f32v3& color)
+{
+  return ui8v4(toUnorm(color.x), toUnorm(color.y), toUnorm(color.z), 255);
+}
+
+// The pixel shaders of TriangleMesh.hlsl and mesh-viewer.hlsl, which only differ in their constants.
+f32v3 shade(const SoftwareScene& scene, const SoftwareMaterial& material, const SoftwareFrameConstants& constants,
+            const f32v3& viewPosition, const f32v3& viewNormal, const f32v2& textureCoordinate,
+            const f32v3& faceNormal)
+{
+  const f32v3 ambientColor  = sampleTexture(scene.textures[material.textureIndices[0]], textureCoordinate);
+  const f32v3 diffuseColor  = sampleTexture(scene.textures[material.textureIndices[1]], textureCoordinate);
+  const f32v3 specularColor = sampleTexture(scene.textures[material.textureIndices[2]], textureCoordinate);
+  const f32v3 emissiveColor = sampleTexture(scene.textures[material.textureIndices[3]], textureCoordinate);
+
+  const f32v3 l = glm::normalize(f32v3(constants.lightDirectionXY, -1.0f));
+  const f32v3 v = glm::normalize(-viewPosition);
+  f32v3       n = constants.flatShading ? faceNormal : glm::normalize(viewNormal);
+  if (constants.twoSidedLighting)
+  {
+    n = n.z < 0.0f ? n : -n;
+  }
+  const f32v3 h = glm::normalize(l + v);
+
+  const f32 diffuse  = std::max(0.0f, glm::dot(n, l));
+  const f32 specular = hlslPow(std::max(0.0f, glm::dot(n, h)), material.specularColorAndExponent.w);
+  return f32v3(material.emissive) * emissiveColor + f32v3(material.ambient) * ambientColor +
+         constants.lightIntensity * diffuse * f32v3(material.diffuse) * diffuseColor +
+         constants.lightIntensity * specular * f32v3(material.specularColorAndExponent) * specularColor;
+}
+
+// Tests four pixels of a row against the edge functions and the depths, and writes the depths of the pixels that pass.
+// Returns a bit per pixel that passed, only pixels with a bit in validMask are tested.
+ui32 testBlock(const f32 edges[3], const f32 edgeSteps[3], f32 depth, f32 depthStep, f32* depths, ui32 validMask)
+{
+#ifdef GIMS_SOFTWARE_RASTERIZER_SSE2
+  const __m128 lanes  = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  const __m128 zero   = _mm_setzero_ps();
+  __m128       inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (ui32 k = 0; k < 3; k++)
+  {
+    const __m128 e = _mm_add_ps(_mm_set1_ps(edges[k]), _mm_mul_ps(lanes, _mm_set1_ps(edgeSteps[k])));
+    inside         = _mm_and_ps(inside, _mm_cmpge_ps(e, zero));
+  }
+  // The depth buffer is cleared to 1, so depths that pass are below the far plane.
+  const __m128 z        = _mm_add_ps(_mm_set1_ps(depth), _mm_mul_ps(lanes, _mm_set1_ps(depthStep)));
+  const __m128 oldDepth = _mm_loadu_ps(depths);
+  const __m128 pass     = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(z, oldDepth), _mm_cmpge_ps(z, zero)));
+  const ui32   mask     = static_cast<ui32>(_mm_movemask_ps(pass)) & validMask;
+  if (mask == 0)
+  {
+    return 0;
+  }
+  const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+  const __m128  write    = _mm_castsi128_ps(
+      _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<i32>(mask)), laneBits), laneBits));
+  _mm_storeu_ps(depths, _mm_or_ps(_mm_and_ps(write, z), _mm_andnot_ps(write, oldDepth)));
+  return mask;
+#else
+  ui32 mask = 0;
+  for (ui32 lane = 0; lane < 4; lane++)
+  {
+    const f32 l = static_cast<f32>(lane);
+    const f32 z = depth + l * depthStep;
+    if ((validMask & (1u << lane)) && edges[0] + l * edgeSteps[0] >= 0.0f && edges[1] + l * edgeSteps[1] >= 0.0f &&
+        edges[2] + l * edgeSteps[2] >= 0.0f && z < depths[lane] && z >= 0.0f)
+    {
+      depths[lane] = z;
+      mask |= 1u << lane;
+    }
+  }
+  return mask;
+#endif
+}
+
+// Returns the number of trailing zero bits of a non-zero value.
+ui32 getLowestBit(ui32 mask)
+{
+  ui32 bit = 0;
+  while (!(mask & (1u << bit)))
+  {
+    bit++;
+  }
+  return bit;
+}
+} // namespace
+
+namespace gims
+{
+SoftwareRasterizer::SoftwareRasterizer(ui32 width, ui32 height, ThreadPool& threadPool)
+    : m_width(width)
+    , m_height(height)
+    , m_guardBand(2.0f * guardBandPixels / static_cast<f32>(std::max(width, 1u)) - 1.0f,
+                  2.0f * guardBandPixels / static_cast<f32>(std::max(height, 1u)) - 1.0f)
+    , m_nTilesX((width + tileSize - 1) / tileSize)
+    , m_nTilesY((height + tileSize - 1) / tileSize)
+    , m_threadPool(threadPool)
+    , m_colors(static_cast<size_t>(width) * height, ui8v4(0, 0, 0, 255))
+    , m_depths(static_cast<size_t>(width) * height, 1.0f)
+    , m_statistics {0, 0, 0, 0.0, 0.0, 0.0, 0.0}
+{
+  if (width == 0 || height == 0 || width > maxSize || height > maxSize)
+  {
+    throw std::invalid_argument("The software rasterizer supports 1 to " + std::to_string(maxSize) +
+                                " pixels per side, not " + std::to_string(width) + "x" + std::to_string(height) + ".");
+  }
+}
+
+void SoftwareRasterizer::draw(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+                              const SoftwareFrameConstants& constants)
+{
+  GIMS_PROFILE_ZONE("Software Rasterizer");
+  const auto start = Clock::now();
+  m_statistics     = {0, 0, 0, 0.0, 0.0, 0.0, 0.0};
+
+  // Everything the draw calls refer to is checked up front, so the tasks can index without checks.
+  m_vertexOffsets.assign(drawCalls.size() + 1, 0);
+  m_triangleOffsets.assign(drawCalls.size() + 1, 0);
+  for (size_t i = 0; i < drawCalls.size(); i++)
+  {
+    const SoftwareMesh&     mesh     = scene.meshes.at(drawCalls[i].meshIdx);
+    const SoftwareMaterial& material = scene.materials.at(mesh.materialIdx);
+    for (const ui32 textureIdx : material.textureIndices)
+    {
+      const SoftwareTexture& texture = scene.textures.at(textureIdx);
+      if (texture.texels.size() != static_cast<size_t>(texture.width) * texture.height || texture.texels.empty())
+      {
+        throw std::out_of_range("Texture " + std::to_string(textureIdx) + " has no texels.");
+      }
+    }
+    for (const ui32 index : mesh.indices)
+    {
+      if (index >= mesh.vertices.size())
+      {
+        throw std::out_of_range("Mesh " + std::to_string(drawCalls[i].meshIdx) + " has an index out of range.");
+      }
+    }
+    m_vertexOffsets[i + 1]   = m_vertexOffsets[i] + mesh.vertices.size();
+    m_triangleOffsets[i + 1] = m_triangleOffsets[i] + mesh.indices.size() / 3;
+  }
+  m_statistics.nTriangles = m_triangleOffsets.back();
+
+  {
+    GIMS_PROFILE_ZONE("Transform Vertices");
+    // The vertices of all draw calls are split into tasks of equal size, so a single large mesh uses all threads.
+    m_transformedVertices.resize(drawCalls.size());
+    for (size_t i = 0; i < drawCalls.size(); i++)
+    {
+      m_transformedVertices[i].resize(scene.meshes[drawCalls[i].meshIdx].vertices.size());
+    }
+    const ui32 nTasks = static_cast<ui32>((m_vertexOffsets.back() + verticesPerTask - 1) / verticesPerTask);
+    m_threadPool.parallelFor(
+        nTasks, [&](ui32 taskIdx) { transformVertices(scene, drawCalls, constants.projection, taskIdx); });
+  }
+  const auto transformed = Clock::now();
+
+  {
+    GIMS_PROFILE_ZONE("Bin Triangles");
+    // Several chunks per thread balance the load, the bins of each chunk keep the order of the draw calls.
+    const ui64 nTriangles        = m_triangleOffsets.back();
+    const ui64 trianglesPerChunk = std::max(minTrianglesPerChunk, nTriangles / (4 * m_threadPool.getNumberOfThreads()));
+    const ui32 nChunks           = static_cast<ui32>((nTriangles + trianglesPerChunk - 1) / trianglesPerChunk);
+    m_triangles.resize(nChunks);
+    m_bins.resize(nChunks);
+    m_threadPool.parallelFor(
+        nChunks, [&](ui32 chunkIdx) { binTriangles(scene, drawCalls, constants, trianglesPerChunk, chunkIdx); });
+    for (ui32 i = 0; i < nChunks; i++)
+    {
+      m_statistics.nRasterizedTriangles += m_triangles[i].size();
+    }
+  }
+  const auto binned = Clock::now();
+
+  {
+    GIMS_PROFILE_ZONE("Rasterize Tiles");
+    std::vector<ui64> nShadedPixels(m_nTilesX * m_nTilesY, 0);
+    m_threadPool.parallelFor(m_nTilesX * m_nTilesY,
+                             [&](ui32 tileIdx) { renderTile(scene, constants, tileIdx, nShadedPixels[tileIdx]); });
+    for (const ui64 n : nShadedPixels)
+    {
+      m_statistics.nShadedPixels += n;
+    }
+  }
+  const auto end = Clock::now();
+
+  m_statistics.vertexMilliseconds  = getMilliseconds(start, transformed);
+  m_statistics.binningMilliseconds = getMilliseconds(transformed, binned);
+  m_statistics.rasterMilliseconds  = getMilliseconds(binned, end);
+  m_statistics.totalMilliseconds   = getMilliseconds(start, end);
+}
+
+ui32 SoftwareRasterizer::getWidth() const
+{
+  return m_width;
+}
+
+ui32 SoftwareRasterizer::getHeight() const
+{
+  return m_height;
+}
+
+const std::vector<ui8v4>& SoftwareRasterizer::getColors() const
+{
+  return m_colors;
+}
+
+const std::vector<f32>& SoftwareRasterizer::getDepths() const
+{
+  return m_depths;
+}
+
+const SoftwareRasterizerStatistics& SoftwareRasterizer::getStatistics() const
+{
+  return m_statistics;
+}
+
+void SoftwareRasterizer::transformVertices(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+                                           const f32m4& projection, ui32 taskIdx)
+{
+  const ui64 begin = taskIdx * verticesPerTask;
+  const ui64 end   = std::min(m_vertexOffsets.back(), begin + verticesPerTask);
+  for (ui32 drawIdx = findRange(m_vertexOffsets, begin); drawIdx < drawCalls.size() && m_vertexOffsets[drawIdx] < end;
+       drawIdx++)
+  {
+    const SoftwareDrawCall& drawCall = drawCalls[drawIdx];
+    const auto&             vertices = scene.meshes[drawCall.meshIdx].vertices;
+    const ui64              first    = std::max(begin, m_vertexOffsets[drawIdx]) - m_vertexOffsets[drawIdx];
+    const ui64              last     = std::min(end, m_vertexOffsets[drawIdx + 1]) - m_vertexOffsets[drawIdx];
+    for (ui64 i = first; i < last; i++)
+    {
+      // The same operations as VS_main, the normal is transformed by the model view matrix as well.
+      const f32v4        viewPosition = drawCall.modelView * f32v4(vertices[i].position, 1.0f);
+      TransformedVertex& transformed  = m_transformedVertices[drawIdx][i];
+      transformed.clipPosition        = projection * viewPosition;
+      transformed.viewPosition        = f32v3(viewPosition);
+      transformed.viewNormal          = f32v3(drawCall.modelView * f32v4(vertices[i].normal, 0.0f));
+      transformed.textureCoordinate   = vertices[i].textureCoordinate;
+    }
+  }
+}
+
+void SoftwareRasterizer::binTriangles(const SoftwareScene& scene, const std::vector<SoftwareDrawCall>& drawCalls,
+                                      const SoftwareFrameConstants& constants, ui64 trianglesPerChunk, ui32 chunkIdx)
+{
+  m_triangles[chunkIdx].clear();
+  m_triangles[chunkIdx].reserve(trianglesPerChunk);
+  m_bins[chunkIdx].resize(m_nTilesX * m_nTilesY);
+  for (auto& bin : m_bins[chunkIdx])
+  {
+    bin.clear();
+  }
+
+  const ui64 begin = chunkIdx * trianglesPerChunk;
+  const ui64 end   = std::min(m_triangleOffsets.back(), begin + trianglesPerChunk);
+  for (ui32 drawIdx = findRange(m_triangleOffsets, begin);
+       drawIdx < drawCalls.size() && m_triangleOffsets[drawIdx] < end; drawIdx++)
+  {
+    const SoftwareMesh& mesh     = scene.meshes[drawCalls[drawIdx].meshIdx];
+    const auto&         vertices = m_transformedVertices[drawIdx];
+    const ui64          first    = std::max(begin, m_triangleOffsets[drawIdx]) - m_triangleOffsets[drawIdx];
+    const ui64          last     = std::min(end, m_triangleOffsets[drawIdx + 1]) - m_triangleOffsets[drawIdx];
+    for (ui64 i = first; i < last; i++)
+    {
+      addTriangle(vertices[mesh.indices[3 * i]], vertices[mesh.indices[3 * i + 1]],
+                  vertices[mesh.indices[3 * i + 2]], mesh.materialIdx, constants, chunkIdx);
+    }
+  }
+}
+
+void SoftwareRasterizer::addTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+                                     const TransformedVertex& v2, ui32 materialIdx,
+                                     const SoftwareFrameConstants& constants, ui32 chunkIdx)
+{
+  // Signed distances to the near plane, the far plane, and the guard band, inside if not negative.
+  const auto getPlaneDistance = [this](const f32v4& p, ui32 planeIdx)
+  {
+    switch (planeIdx)
+    {
+    case 0:
+      return p.z;
+    case 1:
+      return p.w - p.z;
+    case 2:
+      return m_guardBand.x * p.w - p.x;
+    case 3:
+      return m_guardBand.x * p.w + p.x;
+    case 4:
+      return m_guardBand.y * p.w - p.y;
+    default:
+      return m_guardBand.y * p.w + p.y;
+    }
+  };
+  const ui32               nPlanes     = 6;
+  const ui32               farPlaneBit = 1u << 1;
+  const TransformedVertex* vertices[3] = {&v0, &v1, &v2};
+  ui32                     outsideAll  = ~0u;
+  ui32                     outsideAny  = 0;
+  for (const TransformedVertex* v : vertices)
+  {
+    ui32 outside = 0;
+    for (ui32 planeIdx = 0; planeIdx < nPlanes; planeIdx++)
+    {
+      outside |= getPlaneDistance(v->clipPosition, planeIdx) < 0.0f ? 1u << planeIdx : 0u;
+    }
+    outsideAll &= outside;
+    outsideAny |= outside;
+  }
+  if (outsideAll != 0)
+  {
+    return;
+  }
+
+  // The normal of the plane, turned towards the camera as cross(ddx, ddy) of FLAT_SHADING is.
+  f32v3 faceNormal = glm::cross(v1.viewPosition - v0.viewPosition, v2.viewPosition - v0.viewPosition);
+  if (glm::dot(faceNormal, v0.viewPosition) > 0.0f)
+  {
+    faceNormal = -faceNormal;
+  }
+  faceNormal = glm::normalize(faceNormal);
+
+  // Pixels beyond the far plane fail the depth test, so only the near plane and the guard band are clipped.
+  if ((outsideAny & ~farPlaneBit) == 0)
+  {
+    setupTriangle(v0, v1, v2, faceNormal, materialIdx, constants, chunkIdx);
+    return;
+  }
+  TransformedVertex polygons[2][3 + nPlanes];
+  ui32              nVertices = 3;
+  polygons[0][0]              = v0;
+  polygons[0][1]              = v1;
+  polygons[0][2]              = v2;
+  ui32 current                = 0;
+  for (ui32 planeIdx = 0; planeIdx < nPlanes; planeIdx++)
+  {
+    if ((1u << planeIdx) == farPlaneBit || !(outsideAny & (1u << planeIdx)))
+    {
+      continue;
+    }
+    const TransformedVertex* input      = polygons[current];
+    TransformedVertex*       output     = polygons[1 - current];
+    ui32                     nOutput    = 0;
+    for (ui32 i = 0; i < nVertices; i++)
+    {
+      const TransformedVertex& a         = input[i];
+      const TransformedVertex& b         = input[(i + 1) % nVertices];
+      const f32                distanceA = getPlaneDistance(a.clipPosition, planeIdx);
+      const f32                distanceB = getPlaneDistance(b.clipPosition, planeIdx);
+      if (distanceA >= 0.0f)
+      {
+        output[nOutput++] = a;
+      }
+      if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+      {
+        // Attributes are linear in clip space.
+        const f32 t                         = distanceA / (distanceA - distanceB);
+        output[nOutput].clipPosition        = glm::mix(a.clipPosition, b.clipPosition, t);
+        output[nOutput].viewPosition        = glm::mix(a.viewPosition, b.viewPosition, t);
+        output[nOutput].viewNormal          = glm::mix(a.viewNormal, b.viewNormal, t);
+        output[nOutput].textureCoordinate   = glm::mix(a.textureCoordinate, b.textureCoordinate, t);
+        nOutput++;
+      }
+    }
+    nVertices = nOutput;
+    current   = 1 - current;
+    if (nVertices < 3)
+    {
+      return;
+    }
+  }
+  for (ui32 i = 2; i < nVertices; i++)
+  {
+    setupTriangle(polygons[current][0], polygons[current][i - 1], polygons[current][i], faceNormal, materialIdx,
+                  constants, chunkIdx);
+  }
+}
+
+void SoftwareRasterizer::setupTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+                                       const TransformedVertex& v2, const f32v3& faceNormal, ui32 materialIdx,
+                                       const SoftwareFrameConstants& constants, ui32 chunkIdx)
+{
+  Triangle triangle;
+  triangle.vertices[0] = v0;
+  triangle.vertices[1] = v1;
+  triangle.vertices[2] = v2;
+  for (ui32 i = 0; i < 3; i++)
+  {
+    // Viewport transformation, y points down.
+    const f32v4& c = triangle.vertices[i].clipPosition;
+    triangle.invW[i] = 1.0f / c.w;
+    const f32 x      = (c.x * triangle.invW[i] * 0.5f + 0.5f) * static_cast<f32>(m_width);
+    const f32 y      = (0.5f - c.y * triangle.invW[i] * 0.5f) * static_cast<f32>(m_height);
+    if (!std::isfinite(x) || !std::isfinite(y))
+    {
+      return;
+    }
+    triangle.x[i] = static_cast<i32>(std::lround(x * subpixelScale));
+    triangle.y[i] = static_cast<i32>(std::lround(y * subpixelScale));
+    triangle.z[i] = c.z * triangle.invW[i];
+  }
+
+  // Twice the area in fixed-point units, positive if the triangle is clockwise on the screen.
+  i64 area = static_cast<i64>(triangle.x[2] - triangle.x[1]) * (triangle.y[0] - triangle.y[1]) -
+             static_cast<i64>(triangle.y[2] - triangle.y[1]) * (triangle.x[0] - triangle.x[1]);
+  if (area == 0 || (area < 0 && constants.cullBackFaces))
+  {
+    return;
+  }
+  // Both sides are rasterized with the same edge functions, which are made positive inside.
+  if (area < 0)
+  {
+    std::swap(triangle.vertices[1], triangle.vertices[2]);
+    std::swap(triangle.x[1], triangle.x[2]);
+    std::swap(triangle.y[1], triangle.y[2]);
+    std::swap(triangle.z[1], triangle.z[2]);
+    std::swap(triangle.invW[1], triangle.invW[2]);
+    area = -area;
+  }
+
+  // Pixels whose center lies within the bounds of the positions.
+  const i32 halfPixel = subpixelScale / 2;
+  triangle.minX = std::max(0, (std::min({triangle.x[0], triangle.x[1], triangle.x[2]}) - halfPixel + subpixelScale - 1) >>
+                                  subpixelBits);
+  triangle.minY = std::max(0, (std::min({triangle.y[0], triangle.y[1], triangle.y[2]}) - halfPixel + subpixelScale - 1) >>
+                                  subpixelBits);
+  triangle.maxX = std::min(static_cast<i32>(m_width) - 1,
+                           (std::max({triangle.x[0], triangle.x[1], triangle.x[2]}) - halfPixel) >> subpixelBits);
+  triangle.maxY = std::min(static_cast<i32>(m_height) - 1,
+                           (std::max({triangle.y[0], triangle.y[1], triangle.y[2]}) - halfPixel) >> subpixelBits);
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+  {
+    return;
+  }
+
+  // Edge k is opposite to vertex k. A pixel center on an edge is covered if the edge is a top or a left edge.
+  i64 dx[3];
+  i64 dy[3];
+  for (ui32 k = 0; k < 3; k++)
+  {
+    dx[k]            = triangle.x[(k + 2) % 3] - triangle.x[(k + 1) % 3];
+    dy[k]            = triangle.y[(k + 2) % 3] - triangle.y[(k + 1) % 3];
+    triangle.bias[k] = (dy[k] < 0 || (dy[k] == 0 && dx[k] > 0)) ? 0 : -1;
+  }
+  triangle.invArea     = 1.0f / static_cast<f32>(area);
+  triangle.faceNormal  = faceNormal;
+  triangle.materialIdx = materialIdx;
+
+  auto&      triangles   = m_triangles[chunkIdx];
+  const ui32 triangleIdx = static_cast<ui32>(triangles.size());
+  triangles.push_back(triangle);
+
+  // Tiles of the bounding box that lie completely outside of an edge are skipped.
+  for (i32 tileY = triangle.minY / static_cast<i32>(tileSize); tileY <= triangle.maxY / static_cast<i32>(tileSize);
+       tileY++)
+  {
+    for (i32 tileX = triangle.minX / static_cast<i32>(tileSize); tileX <= triangle.maxX / static_cast<i32>(tileSize);
+         tileX++)
+    {
+      const i64 minPx   = (static_cast<i64>(tileX) * tileSize << subpixelBits) + halfPixel;
+      const i64 minPy   = (static_cast<i64>(tileY) * tileSize << subpixelBits) + halfPixel;
+      const i64 maxPx   = minPx + ((static_cast<i64>(tileSize) - 1) << subpixelBits);
+      const i64 maxPy   = minPy + ((static_cast<i64>(tileSize) - 1) << subpixelBits);
+      bool      outside = false;
+      for (ui32 k = 0; k < 3 && !outside; k++)
+      {
+        // The corner of the tile at which the edge function is largest.
+        const i64 px   = dy[k] < 0 ? maxPx : minPx;
+        const i64 py   = dx[k] > 0 ? maxPy : minPy;
+        const i64 edge = dx[k] * (py - triangle.y[(k + 1) % 3]) - dy[k] * (px - triangle.x[(k + 1) % 3]);
+        outside        = edge + triangle.bias[k] < 0;
+      }
+      if (!outside)
+      {
+        m_bins[chunkIdx][tileY * m_nTilesX + tileX].push_back(triangleIdx);
+      }
+    }
+  }
+}
+
+void SoftwareRasterizer::renderTile(const SoftwareScene& scene, const SoftwareFrameConstants& constants, ui32 tileIdx,
+                                    ui64& nShadedPixels)
+{
+  GIMS_PROFILE_ZONE("Render Tile");
+  const i32 tileX      = static_cast<i32>(tileIdx % m_nTilesX * tileSize);
+  const i32 tileY      = static_cast<i32>(tileIdx / m_nTilesX * tileSize);
+  const i32 tileMaxX   = std::min(tileX + static_cast<i32>(tileSize), static_cast<i32>(m_width)) - 1;
+  const i32 tileMaxY   = std::min(tileY + static_cast<i32>(tileSize), static_cast<i32>(m_height)) - 1;
+  const i32 tileStride = static_cast<i32>(tileSize);
+
+  // The closest triangle of each pixel, which is shaded afterwards. Both fit on the stack, so tiles do not allocate.
+  std::array<f32, tileSize * tileSize>             depths;
+  std::array<const Triangle*, tileSize * tileSize> closestTriangles;
+  depths.fill(1.0f);
+  closestTriangles.fill(nullptr);
+  for (size_t chunkIdx = 0; chunkIdx < m_bins.size(); chunkIdx++)
+  {
+    for (const ui32 triangleIdx : m_bins[chunkIdx][tileIdx])
+    {
+      const Triangle& t    = m_triangles[chunkIdx][triangleIdx];
+      const i32       minX = std::max(t.minX, tileX);
+      const i32       maxX = std::min(t.maxX, tileMaxX);
+      const i32       minY = std::max(t.minY, tileY);
+      const i32       maxY = std::min(t.maxY, tileMaxY);
+      if (minX > maxX || minY > maxY)
+      {
+        continue;
+      }
+
+      // Blocks of four pixels start at multiples of four within the tile, so they never leave a row of the tile.
+      const i32 blockMinX = tileX + ((minX - tileX) & ~3);
+      i64       dx[3];
+      i64       dy[3];
+      i64       rowEdges[3];
+      f32       edgeSteps[3];
+      for (ui32 k = 0; k < 3; k++)
+      {
+        dx[k]        = t.x[(k + 2) % 3] - t.x[(k + 1) % 3];
+        dy[k]        = t.y[(k + 2) % 3] - t.y[(k + 1) % 3];
+        const i64 px = (static_cast<i64>(blockMinX) << subpixelBits) + subpixelScale / 2;
+        const i64 py = (static_cast<i64>(minY) << subpixelBits) + subpixelScale / 2;
+        rowEdges[k]  = dx[k] * (py - t.y[(k + 1) % 3]) - dy[k] * (px - t.x[(k + 1) % 3]);
+        edgeSteps[k] = static_cast<f32>(-dy[k] * subpixelScale);
+      }
+      // Depth is linear in screen space: z = sum_k z_k * e_k(x, y) / area.
+      const f32 depthStep = (edgeSteps[0] * t.z[0] + edgeSteps[1] * t.z[1] + edgeSteps[2] * t.z[2]) * t.invArea;
+
+      for (i32 y = minY; y <= maxY; y++)
+      {
+        i64 blockEdges[3] = {rowEdges[0], rowEdges[1], rowEdges[2]};
+        for (i32 x = blockMinX; x <= maxX; x += 4)
+        {
+          // Lanes left of the bounding box or right of it are not tested.
+          const ui32 validMask = (0xFu << std::max(0, minX - x) & 0xFu) & (0xFu >> std::max(0, x + 3 - maxX));
+          const f32  edges[3]  = {static_cast<f32>(blockEdges[0] + t.bias[0]),
+                                  static_cast<f32>(blockEdges[1] + t.bias[1]),
+                                  static_cast<f32>(blockEdges[2] + t.bias[2])};
+          const f32  depth     = (static_cast<f32>(blockEdges[0]) * t.z[0] + static_cast<f32>(blockEdges[1]) * t.z[1] +
+                             static_cast<f32>(blockEdges[2]) * t.z[2]) *
+                            t.invArea;
+          const i32 pixelIdx = (y - tileY) * tileStride + (x - tileX);
+          ui32      mask     = testBlock(edges, edgeSteps, depth, depthStep, &depths[pixelIdx], validMask);
+          while (mask != 0)
+          {
+            const ui32 lane                       = getLowestBit(mask);
+            closestTriangles[pixelIdx + lane] = &t;
+            mask &= mask - 1;
+          }
+          for (ui32 k = 0; k < 3; k++)
+          {
+            blockEdges[k] -= dy[k] * 4 * subpixelScale;
+          }
+        }
+        for (ui32 k = 0; k < 3; k++)
+        {
+          rowEdges[k] += dx[k] * subpixelScale;
+        }
+      }
+    }
+  }
+
+  // Each covered pixel is shaded once, with perspective correct attributes.
+  const ui8v4 backgroundColor = toUnorm(constants.backgroundColor);
+  for (i32 y = tileY; y <= tileMaxY; y++)
+  {
+    for (i32 x = tileX; x <= tileMaxX; x++)
+    {
+      const i32       pixelIdx = (y - tileY) * tileStride + (x - tileX);
+      const size_t    frameIdx = static_cast<size_t>(y) * m_width + x;
+      const Triangle* t        = closestTriangles[pixelIdx];
+      m_depths[frameIdx]       = depths[pixelIdx];
+      if (!t)
+      {
+        m_colors[frameIdx] = backgroundColor;
+        continue;
+      }
+
+      const i64 px = (static_cast<i64>(x) << subpixelBits) + subpixelScale / 2;
+      const i64 py = (static_cast<i64>(y) << subpixelBits) + subpixelScale / 2;
+      f32       weights[3];
+      f32       sum = 0.0f;
+      for (ui32 k = 0; k < 3; k++)
+      {
+        const i64 dx   = t->x[(k + 2) % 3] - t->x[(k + 1) % 3];
+        const i64 dy   = t->y[(k + 2) % 3] - t->y[(k + 1) % 3];
+        const i64 edge = dx * (py - t->y[(k + 1) % 3]) - dy * (px - t->x[(k + 1) % 3]);
+        weights[k]     = static_cast<f32>(edge) * t->invArea * t->invW[k];
+        sum += weights[k];
+      }
+      f32v3 viewPosition      = f32v3(0.0f);
+      f32v3 viewNormal        = f32v3(0.0f);
+      f32v2 textureCoordinate = f32v2(0.0f);
+      for (ui32 k = 0; k < 3; k++)
+      {
+        const f32 weight = weights[k] / sum;
+        viewPosition += weight * t->vertices[k].viewPosition;
+        viewNormal += weight * t->vertices[k].viewNormal;
+        textureCoordinate += weight * t->vertices[k].textureCoordinate;
+      }
+      m_colors[frameIdx] = toUnorm(shade(scene, scene.materials[t->materialIdx], constants, viewPosition, viewNormal,
+                                         textureCoordinate, t->faceNormal));
+      nShadedPixels++;
+    }
+  }
+}
+
+ui8v4 shadeSoftwareSurface(const SoftwareScene& scene, const SoftwareMaterial& material,
+                           const SoftwareFrameConstants& constants, const f32v3& viewPosition,
+                           const f32v3& viewNormal, const f32v2& textureCoordinate, const f32v3& faceNormal)
+{
+  return toUnorm(shade(scene, material, constants, viewPosition, viewNormal, textureCoordinate, faceNormal));
+}
+
+SoftwareMesh createSoftwareMesh(const CograBinaryMeshFile& meshFile, ui32 materialIdx)
+{
+  // Attributes are only read if they have the components the mesh viewer reads.
+  const auto getAttribute = [&](ui32 attributeIdx, ui32 nComponents) -> const f32*
+  {
+    if (meshFile.getNumAttributes() <= attributeIdx ||
+        meshFile.getAttributeComponentSize(attributeIdx) != sizeof(f32) ||
+        meshFile.getAttributeComponents(attributeIdx) < nComponents)
+    {
+      return nullptr;
+    }
+    return static_cast<const f32*>(meshFile.getAttributePtr(attributeIdx));
+  };
+  const f32* positions          = meshFile.getPositionsPtr();
+  const f32* normals            = getAttribute(0, 3);
+  const f32* textureCoordinates = getAttribute(1, 2);
+  const ui32 normalStride       = normals ? meshFile.getAttributeComponents(0) : 0;
+  const ui32 textureStride      = textureCoordinates ? meshFile.getAttributeComponents(1) : 0;
+
+  SoftwareMesh mesh;
+  mesh.materialIdx = materialIdx;
+  mesh.vertices.resize(meshFile.getNumVertices());
+  for (ui32 i = 0; i < meshFile.getNumVertices(); i++)
+  {
+    SoftwareVertex& vertex = mesh.vertices[i];
+    vertex.position        = f32v3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+    vertex.normal          = normals ? f32v3(normals[normalStride * i], normals[normalStride * i + 1],
+                                             normals[normalStride * i + 2])
+                                     : f32v3(0.0f);
+    vertex.textureCoordinate =
+        textureCoordinates
+            ? f32v2(textureCoordinates[textureStride * i], textureCoordinates[textureStride * i + 1])
+            : f32v2(0.0f);
+  }
+  const ui32* indices = meshFile.getTriangleIndices();
+  mesh.indices.assign(indices, indices + 3 * meshFile.getNumTriangles());
+  return mesh;
+}
+} // namespace gims
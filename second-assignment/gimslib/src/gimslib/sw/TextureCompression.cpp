@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <gimslib/sw/TextureCompression.hpp>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+using namespace gims;
+
+f32 srgbToLinear(ui8 value)
+{
+  static const auto table = []()
+  {
+    std::array<f32, 256> result;
+    for (ui32 i = 0; i < 256; i++)
+    {
+      const f32 c = i / 255.0f;
+      result[i]   = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    return result;
+  }();
+  return table[value];
+}
+
+ui8 linearToSrgb(f32 value)
+{
+  const f32 c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+  return static_cast<ui8>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+
+// Texels of the block at (blockX, blockY). Blocks at the right and bottom border repeat the last column and row.
+std::array<ui8v4, 16> getBlock(const SoftwareImage& image, ui32 blockX, ui32 blockY)
+{
+  std::array<ui8v4, 16> block;
+  for (ui32 y = 0; y < 4; y++)
+  {
+    for (ui32 x = 0; x < 4; x++)
+    {
+      const ui32 imageX = std::min(blockX * 4 + x, image.width - 1);
+      const ui32 imageY = std::min(blockY * 4 + y, image.height - 1);
+      block[y * 4 + x]  = image.pixels[static_cast<size_t>(imageY) * image.width + imageX];
+    }
+  }
+  return block;
+}
+
+ui16 toRgb565(const f32v3& color)
+{
+  const ui32 r = static_cast<ui32>(std::clamp(color.x * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+  const ui32 g = static_cast<ui32>(std::clamp(color.y * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+  const ui32 b = static_cast<ui32>(std::clamp(color.z * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+  return static_cast<ui16>((r << 11) | (g << 5) | b);
+}
+
+f32v3 fromRgb565(ui16 color)
+{
+  const ui32 r = (color >> 11) & 31;
+  const ui32 g = (color >> 5) & 63;
+  const ui32 b = color & 31;
+  return f32v3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+}
+
+// Writes the 8 bytes of a color block that always uses four colors, as BC3 requires and BC1 does if the first end
+// point is the larger one.
+void compressColorBlock(const std::array<ui8v4, 16>& block, ui8* output)
+{
+  f32v3 minColor(255.0f);
+  f32v3 maxColor(0.0f);
+  f32v3 mean(0.0f);
+  for (const auto& texel : block)
+  {
+    const f32v3 color(texel.x, texel.y, texel.z);
+    minColor = glm::min(minColor, color);
+    maxColor = glm::max(maxColor, color);
+    mean += color / 16.0f;
+  }
+
+  // The bounding box has four diagonals, the covariances with green tell which one the colors follow.
+  f32 covarianceRG = 0.0f;
+  f32 covarianceBG = 0.0f;
+  for (const auto& texel : block)
+  {
+    const f32v3 d = f32v3(texel.x, texel.y, texel.z) - mean;
+    covarianceRG += d.x * d.y;
+    covarianceBG += d.z * d.y;
+  }
+  if (covarianceRG < 0.0f)
+  {
+    std::swap(minColor.x, maxColor.x);
+  }
+  if (covarianceBG < 0.0f)
+  {
+    std::swap(minColor.z, maxColor.z);
+  }
+  // Insetting the end points by 1/16 of the range lowers the error of the interpolated colors.
+  const f32v3 inset = (maxColor - minColor) / 16.0f;
+  minColor += inset;
+  maxColor -= inset;
+
+  ui16 color0 = toRgb565(maxColor);
+  ui16 color1 = toRgb565(minColor);
+  if (color0 < color1)
+  {
+    std::swap(color0, color1);
+  }
+  const f32v3 end0    = fromRgb565(color0);
+  const f32v3 end1    = fromRgb565(color1);
+  const f32v3 palette[4] = {end0, end1, (2.0f * end0 + end1) / 3.0f, (end0 + 2.0f * end1) / 3.0f};
+
+  ui32 indices = 0;
+  if (color0 != color1)
+  {
+    for (ui32 i = 0; i < 16; i++)
+    {
+      const f32v3 color(block[i].x, block[i].y, block[i].z);
+      ui32        bestIdx      = 0;
+      f32         bestDistance = std::numeric_limits<f32>::max();
+      for (ui32 p = 0; p < 4; p++)
+      {
+        const f32v3 d        = color - palette[p];
+        const f32   distance = glm::dot(d, d);
+        if (distance < bestDistance)
+        {
+          bestDistance = distance;
+          bestIdx      = p;
+        }
+      }
+      indices |= bestIdx << (2 * i);
+    }
+  }
+  output[0] = static_cast<ui8>(color0);
+  output[1] = static_cast<ui8>(color0 >> 8);
+  output[2] = static_cast<ui8>(color1);
+  output[3] = static_cast<ui8>(color1 >> 8);
+  for (ui32 i = 0; i < 4; i++)
+  {
+    output[4 + i] = static_cast<ui8>(indices >> (8 * i));
+  }
+}
+
+// Writes the 8 bytes of an alpha block with eight interpolated values between the largest and smallest alpha.
+void compressAlphaBlock(const std::array<ui8v4, 16>& block, ui8* output)
+{
+  ui8 alpha0 = 0;
+  ui8 alpha1 = 255;
+  for (const auto& texel : block)
+  {
+    alpha0 = std::max(alpha0, texel.w);
+    alpha1 = std::min(alpha1, texel.w);
+  }
+  ui64 indices = 0;
+  if (alpha0 != alpha1)
+  {
+    // Index 0 is alpha0, 1 is alpha1, and 2 to 7 step from alpha0 to alpha1.
+    for (ui32 i = 0; i < 16; i++)
+    {
+      const f32  t      = static_cast<f32>(alpha0 - block[i].w) / (alpha0 - alpha1);
+      const ui32 step   = static_cast<ui32>(t * 7.0f + 0.5f);
+      const ui64 idx    = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+      indices |= idx << (3 * i);
+    }
+  }
+  output[0] = alpha0;
+  output[1] = alpha1;
+  for (ui32 i = 0; i < 6; i++)
+  {
+    output[2 + i] = static_cast<ui8>(indices >> (8 * i));
+  }
+}
+
+// Inverse of compressColorBlock, including the three colors and transparent black BC1 uses if color0 <= color1.
+void decompressColorBlock(const ui8* input, bool hasThreeColors, std::array<ui8v4, 16>& block)
+{
+  const ui16  color0 = static_cast<ui16>(input[0] | (input[1] << 8));
+  const ui16  color1 = static_cast<ui16>(input[2] | (input[3] << 8));
+  const f32v3 end0   = fromRgb565(color0);
+  const f32v3 end1   = fromRgb565(color1);
+  f32v4       palette[4];
+  palette[0] = f32v4(end0, 255.0f);
+  palette[1] = f32v4(end1, 255.0f);
+  if (!hasThreeColors || color0 > color1)
+  {
+    palette[2] = f32v4((2.0f * end0 + end1) / 3.0f, 255.0f);
+    palette[3] = f32v4((end0 + 2.0f * end1) / 3.0f, 255.0f);
+  }
+  else
+  {
+    palette[2] = f32v4((end0 + end1) / 2.0f, 255.0f);
+    palette[3] = f32v4(0.0f);
+  }
+  const ui32 indices = input[4] | (input[5] << 8) | (input[6] << 16) | (static_cast<ui32>(input[7]) << 24);
+  for (ui32 i = 0; i < 16; i++)
+  {
+    const f32v4& color = palette[(indices >> (2 * i)) & 3];
+    block[i]           = ui8v4(static_cast<ui8>(color.x + 0.5f), static_cast<ui8>(color.y + 0.5f),
+                               static_cast<ui8>(color.z + 0.5f), static_cast<ui8>(color.w));
+  }
+}
+
+// Inverse of compressAlphaBlock, including the six values and 0 and 255 that are used if alpha0 <= alpha1.
+void decompressAlphaBlock(const ui8* input, std::array<ui8v4, 16>& block)
+{
+  const ui32 alpha0 = input[0];
+  const ui32 alpha1 = input[1];
+  ui32       palette[8] = {alpha0, alpha1, 0, 0, 0, 0, 0, 255};
+  if (alpha0 > alpha1)
+  {
+    for (ui32 i = 1; i < 7; i++)
+    {
+      palette[i + 1] = ((7 - i) * alpha0 + i * alpha1 + 3) / 7;
+    }
+  }
+  else
+  {
+    for (ui32 i = 1; i < 5; i++)
+    {
+      palette[i + 1] = ((5 - i) * alpha0 + i * alpha1 + 2) / 5;
+    }
+  }
+  ui64 indices = 0;
+  for (ui32 i = 0; i < 6; i++)
+  {
+    indices |= static_cast<ui64>(input[2 + i]) << (8 * i);
+  }
+  for (ui32 i = 0; i < 16; i++)
+  {
+    block[i].w = static_cast<ui8>(palette[(indices >> (3 * i)) & 7]);
+  }
+}
+
+template <ui32 BytesPerBlock> std::vector<ui8> compressBlocks(const SoftwareImage& image)
+{
+  const ui32       nBlocksX = std::max(1u, (image.width + 3) / 4);
+  const ui32       nBlocksY = std::max(1u, (image.height + 3) / 4);
+  std::vector<ui8> result(static_cast<size_t>(nBlocksX) * nBlocksY * BytesPerBlock);
+  for (ui32 blockY = 0; blockY < nBlocksY; blockY++)
+  {
+    for (ui32 blockX = 0; blockX < nBlocksX; blockX++)
+    {
+      const auto block  = getBlock(image, blockX, blockY);
+      ui8*       output = &result[(static_cast<size_t>(blockY) * nBlocksX + blockX) * BytesPerBlock];
+      if constexpr (BytesPerBlock == 16)
+      {
+        compressAlphaBlock(block, output);
+        output += 8;
+      }
+      compressColorBlock(block, output);
+    }
+  }
+  return result;
+}
+} // namespace
+
+namespace gims
+{
+std::vector<SoftwareImage> createMipChain(const SoftwareImage& image)
+{
+  std::vector<SoftwareImage> result = {image};
+  while (result.back().width > 1 || result.back().height > 1)
+  {
+    const SoftwareImage& source = result.back();
+    SoftwareImage        level;
+    level.width  = std::max(1u, source.width / 2);
+    level.height = std::max(1u, source.height / 2);
+    level.pixels.resize(static_cast<size_t>(level.width) * level.height);
+    for (ui32 y = 0; y < level.height; y++)
+    {
+      for (ui32 x = 0; x < level.width; x++)
+      {
+        f32v4 sum(0.0f);
+        for (ui32 dy = 0; dy < 2; dy++)
+        {
+          for (ui32 dx = 0; dx < 2; dx++)
+          {
+            const ui32   sourceX = std::min(2 * x + dx, source.width - 1);
+            const ui32   sourceY = std::min(2 * y + dy, source.height - 1);
+            const ui8v4& texel   = source.pixels[static_cast<size_t>(sourceY) * source.width + sourceX];
+            sum += f32v4(srgbToLinear(texel.x), srgbToLinear(texel.y), srgbToLinear(texel.z), texel.w);
+          }
+        }
+        sum /= 4.0f;
+        level.pixels[static_cast<size_t>(y) * level.width + x] =
+            ui8v4(linearToSrgb(sum.x), linearToSrgb(sum.y), linearToSrgb(sum.z), static_cast<ui8>(sum.w + 0.5f));
+      }
+    }
+    result.push_back(std::move(level));
+  }
+  return result;
+}
+
+bool isOpaque(const SoftwareImage& image)
+{
+  return std::all_of(image.pixels.begin(), image.pixels.end(), [](const ui8v4& texel) { return texel.w == 255; });
+}
+
+std::vector<ui8> compressBC1(const SoftwareImage& image)
+{
+  return compressBlocks<8>(image);
+}
+
+std::vector<ui8> compressBC3(const SoftwareImage& image)
+{
+  return compressBlocks<16>(image);
+}
+
+TextureFormat chooseCompressedFormat(const SoftwareImage& image)
+{
+  if (image.width % 4 != 0 || image.height % 4 != 0)
+  {
+    return TextureFormat::R8G8B8A8UnormSrgb;
+  }
+  return isOpaque(image) ? TextureFormat::BC1UnormSrgb : TextureFormat::BC3UnormSrgb;
+}
+
+CompressedTexture compressTexture(const SoftwareImage& image, TextureFormat format)
+{
+  if (format != TextureFormat::BC1UnormSrgb && format != TextureFormat::BC3UnormSrgb &&
+      format != TextureFormat::R8G8B8A8UnormSrgb)
+  {
+    throw std::invalid_argument("Images cannot be compressed to format " +
+                                std::to_string(static_cast<ui32>(format)) + ".");
+  }
+  CompressedTexture result = {format, image.width, image.height, {}};
+  for (const auto& level : createMipChain(image))
+  {
+    if (format == TextureFormat::BC1UnormSrgb)
+    {
+      result.mipLevels.push_back(compressBC1(level));
+    }
+    else if (format == TextureFormat::BC3UnormSrgb)
+    {
+      result.mipLevels.push_back(compressBC3(level));
+    }
+    else
+    {
+      const ui8* texels = reinterpret_cast<const ui8*>(level.pixels.data());
+      result.mipLevels.emplace_back(texels, texels + level.pixels.size() * sizeof(ui8v4));
+    }
+  }
+  return result;
+}
+
+SoftwareImage decompressTexture(const ui8* data, size_t size)
+{
+  const TextureHeader       header = readTextureHeader(data, size);
+  const TextureSubresource& level  = header.mipLevels.front();
+  const ui8*                texels = data + level.offset;
+  SoftwareImage             result = {level.width, level.height, {}};
+  result.pixels.resize(static_cast<size_t>(level.width) * level.height);
+  switch (header.format)
+  {
+  case TextureFormat::R8G8B8A8Unorm:
+  case TextureFormat::R8G8B8A8UnormSrgb:
+  case TextureFormat::B8G8R8A8Unorm:
+  case TextureFormat::B8G8R8A8UnormSrgb:
+  {
+    const bool isBgra = header.format == TextureFormat::B8G8R8A8Unorm ||
+                        header.format == TextureFormat::B8G8R8A8UnormSrgb;
+    for (size_t i = 0; i < result.pixels.size(); i++)
+    {
+      const ui8* texel = texels + i * 4;
+      result.pixels[i] = isBgra ? ui8v4(texel[2], texel[1], texel[0], texel[3])
+                                : ui8v4(texel[0], texel[1], texel[2], texel[3]);
+    }
+    break;
+  }
+  case TextureFormat::BC1Unorm:
+  case TextureFormat::BC1UnormSrgb:
+  case TextureFormat::BC3Unorm:
+  case TextureFormat::BC3UnormSrgb:
+  {
+    const ui32 bytesPerBlock = getBytesPerBlock(header.format);
+    const ui32 nBlocksX      = level.rowPitch / bytesPerBlock;
+    for (ui32 blockY = 0; blockY < level.nRows; blockY++)
+    {
+      for (ui32 blockX = 0; blockX < nBlocksX; blockX++)
+      {
+        const ui8* input = texels + static_cast<size_t>(blockY) * level.rowPitch + blockX * bytesPerBlock;
+        std::array<ui8v4, 16> block;
+        if (bytesPerBlock == 16)
+        {
+          decompressColorBlock(input + 8, false, block);
+          decompressAlphaBlock(input, block);
+        }
+        else
+        {
+          decompressColorBlock(input, true, block);
+        }
+        for (ui32 y = 0; y < 4 && blockY * 4 + y < level.height; y++)
+        {
+          for (ui32 x = 0; x < 4 && blockX * 4 + x < level.width; x++)
+          {
+            result.pixels[static_cast<size_t>(blockY * 4 + y) * level.width + blockX * 4 + x] = block[y * 4 + x];
+          }
+        }
+      }
+    }
+    break;
+  }
+  default:
+    throw std::runtime_error("Textures of format " + std::to_string(static_cast<ui32>(header.format)) +
+                             " cannot be decompressed.");
+  }
+  return result;
+}
+} // namespace gims
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <gimslib/sys/GpuProfiler.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace gims;
+
+void writeJsonString(std::ostream& stream, const std::string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\';
+    }
+    stream << (static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+  }
+  stream << '"';
+}
+} // namespace
+
+namespace gims
+{
+GpuProfiler::GpuProfiler(ui32 nFrames, ui32 maxPassesPerFrame, ui64 timestampFrequency, ui32 nAveragedFrames)
+    : m_nFrames(nFrames)
+    , m_maxPassesPerFrame(maxPassesPerFrame)
+    , m_millisecondsPerTick(timestampFrequency == 0 ? 0.0 : 1000.0 / static_cast<f64>(timestampFrequency))
+    , m_nAveragedFrames(nAveragedFrames)
+    , m_framePasses(nFrames)
+    , m_frameIndices(nFrames, 0)
+    , m_nBegunFrames(0)
+    , m_lastReadFrameIdx(0)
+    , m_currentFrameSlot(0)
+    , m_frameActive(false)
+    , m_nUsedQueries(0)
+    , m_nReadFrames(0)
+{
+  if (nFrames == 0 || maxPassesPerFrame == 0 || timestampFrequency == 0 || nAveragedFrames == 0)
+  {
+    throw std::invalid_argument("The GPU profiler needs frames, passes, a timestamp frequency and averaged frames.");
+  }
+}
+
+ui32 GpuProfiler::getNumberOfQueries() const
+{
+  return m_nFrames * m_maxPassesPerFrame * 2;
+}
+
+void GpuProfiler::beginFrame(ui32 frameSlot, const ui64* timestamps)
+{
+  if (frameSlot >= m_nFrames)
+  {
+    throw std::invalid_argument("Frame slot " + std::to_string(frameSlot) + " is out of range.");
+  }
+  if (m_frameActive)
+  {
+    throw std::logic_error("The previous frame has not ended.");
+  }
+  if (timestamps)
+  {
+    readFrame(frameSlot, timestamps);
+  }
+  m_framePasses[frameSlot].clear();
+  m_frameIndices[frameSlot] = m_nBegunFrames++;
+  m_currentFrameSlot        = frameSlot;
+  m_frameActive             = true;
+  m_nUsedQueries            = 0;
+}
+
+ui32 GpuProfiler::beginPass(const std::string& name)
+{
+  if (!m_frameActive)
+  {
+    throw std::logic_error("Pass " + name + " begins outside of a frame.");
+  }
+  auto&      passes = m_framePasses[m_currentFrameSlot];
+  const ui32 depth  = static_cast<ui32>(m_openPasses.size());
+  m_openPasses.push_back(static_cast<ui32>(passes.size()));
+  if (m_nUsedQueries + 2 > m_maxPassesPerFrame * 2)
+  {
+    passes.push_back({name, depth, invalidQuery, invalidQuery});
+    return invalidQuery;
+  }
+
+  // The queries of a pass are taken when it begins, so the ones of a frame are consecutive.
+  const ui32 beginQuery = m_currentFrameSlot * m_maxPassesPerFrame * 2 + m_nUsedQueries;
+  m_nUsedQueries += 2;
+  passes.push_back({name, depth, beginQuery, beginQuery + 1});
+  return beginQuery;
+}
+
+ui32 GpuProfiler::endPass()
+{
+  if (m_openPasses.empty())
+  {
+    throw std::logic_error("No pass has begun.");
+  }
+  const ui32 passIdx = m_openPasses.back();
+  m_openPasses.pop_back();
+  return m_framePasses[m_currentFrameSlot][passIdx].endQuery;
+}
+
+GpuQueryRange GpuProfiler::endFrame()
+{
+  if (!m_openPasses.empty())
+  {
+    throw std::logic_error("Pass " + m_framePasses[m_currentFrameSlot][m_openPasses.back()].name + " has not ended.");
+  }
+  m_frameActive = false;
+  return {m_currentFrameSlot * m_maxPassesPerFrame * 2, m_nUsedQueries};
+}
+
+const std::vector<GpuPassTiming>& GpuProfiler::getPassTimings() const
+{
+  return m_passTimings;
+}
+
+ui64 GpuProfiler::getNumberOfFrames() const
+{
+  return m_nReadFrames;
+}
+
+ui64 GpuProfiler::getLastReadFrameIdx() const
+{
+  return m_lastReadFrameIdx;
+}
+
+void GpuProfiler::readFrame(ui32 frameSlot, const ui64* timestamps)
+{
+  const auto& passes = m_framePasses[frameSlot];
+  if (passes.empty())
+  {
+    return;
+  }
+
+  // Passes with the same name, e.g., of several command lists, are added up at the position of the first one.
+  m_passTimings.clear();
+  std::unordered_map<std::string, ui32> passTimingIndices;
+  for (const auto& pass : passes)
+  {
+    if (pass.beginQuery == invalidQuery)
+    {
+      continue;
+    }
+    // Timestamps of a queue only grow, unless the GPU was reset, so a negative time is skipped.
+    const ui64 begin        = timestamps[pass.beginQuery];
+    const ui64 end          = timestamps[pass.endQuery];
+    const f64  milliseconds = end >= begin ? static_cast<f64>(end - begin) * m_millisecondsPerTick : 0.0;
+    const auto [it, isNew]  = passTimingIndices.try_emplace(pass.name, static_cast<ui32>(m_passTimings.size()));
+    if (isNew)
+    {
+      m_passTimings.push_back({pass.name, pass.depth, 0.0, 0.0, 0.0, 0});
+    }
+    m_passTimings[it->second].milliseconds += milliseconds;
+  }
+
+  for (auto& passTiming : m_passTimings)
+  {
+    auto& history = m_histories[passTiming.name];
+    if (history.milliseconds.size() < m_nAveragedFrames)
+    {
+      history.milliseconds.push_back(passTiming.milliseconds);
+    }
+    else
+    {
+      history.milliseconds[history.nextSample] = passTiming.milliseconds;
+    }
+    history.nextSample = (history.nextSample + 1) % m_nAveragedFrames;
+
+    f64 sum = 0.0;
+    for (const f64 milliseconds : history.milliseconds)
+    {
+      sum += milliseconds;
+      passTiming.maxMilliseconds = std::max(passTiming.maxMilliseconds, milliseconds);
+    }
+    passTiming.nFrames             = static_cast<ui32>(history.milliseconds.size());
+    passTiming.averageMilliseconds = sum / passTiming.nFrames;
+  }
+  m_lastReadFrameIdx = m_frameIndices[frameSlot];
+  m_nReadFrames++;
+}
+
+void GpuProfiler::writeJson(std::ostream& stream) const
+{
+  stream << "{\"frames\":" << m_nReadFrames << ",\"passes\":[";
+  for (size_t i = 0; i < m_passTimings.size(); i++)
+  {
+    const auto& passTiming = m_passTimings[i];
+    stream << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    writeJsonString(stream, passTiming.name);
+    stream << ",\"depth\":" << passTiming.depth << ",\"milliseconds\":" << passTiming.milliseconds
+           << ",\"averageMilliseconds\":" << passTiming.averageMilliseconds
+           << ",\"maxMilliseconds\":" << passTiming.maxMilliseconds << ",\"averagedFrames\":" << passTiming.nFrames
+           << "}";
+  }
+  stream << "\n]}\n";
+}
+} // namespace gims
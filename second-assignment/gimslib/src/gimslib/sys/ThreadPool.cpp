@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <gimslib/sys/Profiler.hpp>
+#include <gimslib/sys/ThreadPool.hpp>
+
+namespace gims
+{
+ThreadPool::ThreadPool(ui32 nThreads)
+    : m_task(nullptr)
+    , m_nTasks(0)
+    , m_nextTask(0)
+    , m_nBusyWorkers(0)
+    , m_generation(0)
+    , m_stop(false)
+{
+  if (nThreads == 0)
+  {
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (ui32 i = 1; i < nThreads; i++)
+  {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto& worker : m_workers)
+  {
+    worker.join();
+  }
+}
+
+ui32 ThreadPool::getNumberOfThreads() const
+{
+  return static_cast<ui32>(m_workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(ui32 nTasks, const std::function<void(ui32)>& task)
+{
+  if (nTasks == 0)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> loopLock(m_loopMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task           = &task;
+    m_nTasks         = nTasks;
+    m_nextTask       = 0;
+    m_nBusyWorkers   = static_cast<ui32>(m_workers.size());
+    m_firstException = nullptr;
+    m_generation++;
+  }
+  m_wakeUp.notify_all();
+
+  runTasks();
+
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_nBusyWorkers == 0; });
+    m_task    = nullptr;
+    exception = m_firstException;
+  }
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+void ThreadPool::workerLoop()
+{
+  GIMS_PROFILE_THREAD("Worker");
+  ui64 lastGeneration = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeUp.wait(lock, [&] { return m_stop || m_generation != lastGeneration; });
+      if (m_stop)
+      {
+        return;
+      }
+      lastGeneration = m_generation;
+    }
+
+    runTasks();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_nBusyWorkers--;
+      if (m_nBusyWorkers == 0)
+      {
+        m_finished.notify_one();
+      }
+    }
+  }
+}
+
+void ThreadPool::runTasks()
+{
+  for (ui32 taskIdx = m_nextTask++; taskIdx < m_nTasks; taskIdx = m_nextTask++)
+  {
+    try
+    {
+      (*m_task)(taskIdx);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_firstException)
+      {
+        m_firstException = std::current_exception();
+      }
+    }
+  }
+}
+} // namespace gims
@@ -0,0 +1,25 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+namespace gims
+{
+//! \brief Creates an empty directory in the temporary directory of the system and removes it with its content.
+class TemporaryDirectory
+{
+public:
+  //! \param name Prefix of the directory name, followed by a number that makes it unique.
+  explicit TemporaryDirectory(const std::string& name);
+  ~TemporaryDirectory();
+
+  const std::filesystem::path& getPath() const;
+
+  TemporaryDirectory(const TemporaryDirectory& other)            = delete;
+  TemporaryDirectory(TemporaryDirectory&& other)                 = delete;
+  TemporaryDirectory& operator=(const TemporaryDirectory& other) = delete;
+  TemporaryDirectory& operator=(TemporaryDirectory&& other)      = delete;
+
+private:
+  std::filesystem::path m_path;
+};
+} // namespace gims
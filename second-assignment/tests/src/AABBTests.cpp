@@ -0,0 +1,47 @@
+#include "AABB.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("AABB encloses its positions", "[scene]")
+{
+  const std::vector<f32v3> positions = {f32v3(1.0f, -2.0f, 3.0f), f32v3(-1.0f, 4.0f, 0.5f), f32v3(0.0f, 0.0f, 7.0f)};
+  const AABB               aabb(positions.data(), static_cast<ui32>(positions.size()));
+  CHECK(aabb.getLowerLeftBottom() == f32v3(-1.0f, -2.0f, 0.5f));
+  CHECK(aabb.getUpperRightTop() == f32v3(1.0f, 4.0f, 7.0f));
+}
+
+TEST_CASE("AABB union encloses both boxes", "[scene]")
+{
+  const std::vector<f32v3> a = {f32v3(0.0f), f32v3(1.0f)};
+  const std::vector<f32v3> b = {f32v3(-2.0f, 0.5f, 0.5f), f32v3(0.5f, 3.0f, 0.5f)};
+  const AABB               result = AABB(a.data(), 2).getUnion(AABB(b.data(), 2));
+  CHECK(result.getLowerLeftBottom() == f32v3(-2.0f, 0.0f, 0.0f));
+  CHECK(result.getUpperRightTop() == f32v3(1.0f, 3.0f, 1.0f));
+}
+
+TEST_CASE("AABB normalization maps the box to the unit cube around the origin", "[scene]")
+{
+  const std::vector<f32v3> positions = {f32v3(2.0f, 2.0f, 2.0f), f32v3(6.0f, 4.0f, 3.0f)};
+  const AABB               aabb(positions.data(), 2);
+  const f32m4              normalization = aabb.getNormalizationTransformation();
+  const f32v4              lower         = normalization * f32v4(aabb.getLowerLeftBottom(), 1.0f);
+  const f32v4              upper         = normalization * f32v4(aabb.getUpperRightTop(), 1.0f);
+  // The longest axis spans [-0.5, 0.5], the others are scaled by the same factor.
+  CHECK(lower.x == Approx(-0.5f));
+  CHECK(upper.x == Approx(0.5f));
+  CHECK(upper.y - lower.y == Approx(0.5f));
+  CHECK(upper.z - lower.z == Approx(0.25f));
+  CHECK(lower.y + upper.y == Approx(0.0f).margin(1e-6));
+}
+
+TEST_CASE("AABB transformation encloses the transformed corners", "[scene]")
+{
+  const std::vector<f32v3> positions = {f32v3(0.0f), f32v3(1.0f, 2.0f, 3.0f)};
+  const AABB               aabb(positions.data(), 2);
+  f32m4                    translation = glm::translate(f32m4(1.0f), f32v3(10.0f, 0.0f, -1.0f));
+  const AABB               moved       = aabb.getTransformed(translation);
+  CHECK(moved.getLowerLeftBottom() == f32v3(10.0f, 0.0f, -1.0f));
+  CHECK(moved.getUpperRightTop() == f32v3(11.0f, 2.0f, 2.0f));
+}
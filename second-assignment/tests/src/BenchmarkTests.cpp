@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <gimslib/sys/Benchmark.hpp>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("summarizeTimes uses the nearest rank for the percentiles", "[sys]")
+{
+  std::vector<f64> milliseconds(100);
+  std::iota(milliseconds.begin(), milliseconds.end(), 1.0);
+  std::shuffle(milliseconds.begin(), milliseconds.end(), std::mt19937(1));
+  const TimeSummary summary = summarizeTimes(milliseconds);
+  CHECK(summary.nSamples == 100);
+  CHECK(summary.mean == Approx(50.5));
+  CHECK(summary.min == 1.0);
+  CHECK(summary.max == 100.0);
+  CHECK(summary.p50 == 50.0);
+  CHECK(summary.p95 == 95.0);
+  CHECK(summary.p99 == 99.0);
+
+  const TimeSummary fewTimes = summarizeTimes({3.0, 1.0, 2.0});
+  CHECK(fewTimes.p50 == 2.0);
+  CHECK(fewTimes.p95 == 3.0);
+  CHECK(fewTimes.p99 == 3.0);
+
+  const TimeSummary oneTime = summarizeTimes({7.0});
+  CHECK(oneTime.min == 7.0);
+  CHECK(oneTime.p50 == 7.0);
+  CHECK(oneTime.p99 == 7.0);
+
+  const TimeSummary noTimes = summarizeTimes({});
+  CHECK(noTimes.nSamples == 0);
+  CHECK(noTimes.mean == 0.0);
+  CHECK(noTimes.p99 == 0.0);
+}
+
+TEST_CASE("BenchmarkRecorder measures the frames after the warm-up", "[sys]")
+{
+  BenchmarkRecorder recorder(2, 3, 2);
+  recorder.addFrame(100.0, 100.0);
+  recorder.addFrame(100.0, 100.0);
+  recorder.addGpuTime(0, 100.0);
+  for (const f64 milliseconds : {10.0, 20.0, 30.0})
+  {
+    recorder.addFrame(milliseconds, milliseconds / 10.0);
+  }
+  // Frames after the measured ones only count towards the GPU latency.
+  recorder.addFrame(100.0, 100.0);
+  CHECK(recorder.getFrameIdx() == 6);
+  CHECK_FALSE(recorder.isComplete());
+
+  recorder.addGpuTime(2, 5.0);
+  recorder.addGpuTime(4, 7.0);
+  recorder.addGpuTime(9, 100.0);
+  CHECK_FALSE(recorder.isComplete());
+  recorder.addGpuTime(3, 6.0);
+  CHECK(recorder.isComplete());
+
+  const TimeSummary frameTimes = recorder.getFrameTimeSummary();
+  CHECK(frameTimes.nSamples == 3);
+  CHECK(frameTimes.mean == Approx(20.0));
+  CHECK(frameTimes.max == 30.0);
+  CHECK(recorder.getCpuTimeSummary().max == Approx(3.0));
+  const TimeSummary gpuTimes = recorder.getGpuTimeSummary();
+  CHECK(gpuTimes.nSamples == 3);
+  CHECK(gpuTimes.min == 5.0);
+  CHECK(gpuTimes.max == 7.0);
+}
+
+TEST_CASE("BenchmarkRecorder completes without the GPU times that did not arrive in time", "[sys]")
+{
+  BenchmarkRecorder recorder(0, 2, 2);
+  recorder.addFrame(10.0, 1.0);
+  recorder.addFrame(20.0, 2.0);
+  recorder.addGpuTime(1, 4.0);
+  CHECK_FALSE(recorder.isComplete());
+  recorder.addFrame(0.0, 0.0);
+  CHECK_FALSE(recorder.isComplete());
+  recorder.addFrame(0.0, 0.0);
+  CHECK(recorder.isComplete());
+  CHECK(recorder.getGpuTimeSummary().nSamples == 1);
+
+  std::stringstream csv;
+  recorder.writeCsv(csv);
+  CHECK(csv.str() == "frame,frameMilliseconds,cpuMilliseconds,gpuMilliseconds\n0,10,1,-1\n1,20,2,4\n");
+  std::stringstream json;
+  recorder.writeJson(json);
+  CHECK(json.str().find("\"gpuTime\":{\"samples\":1,") != std::string::npos);
+
+  CHECK_THROWS_AS(BenchmarkRecorder(1, 0, 1), std::invalid_argument);
+}
@@ -0,0 +1,77 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <gimslib/io/CameraPath.hpp>
+#include <stdexcept>
+
+namespace
+{
+void writeFile(const std::filesystem::path& path, const char* content)
+{
+  std::ofstream stream(path, std::ios::trunc);
+  stream << content;
+}
+} // namespace
+
+using namespace gims;
+
+TEST_CASE("CameraPath reads back the exact poses it saved", "[io]")
+{
+  CameraPath path;
+  path.add({f32q(1.0f, 0.0f, 0.0f, 0.0f), f32v3(0.0f, 0.0f, -5.0f)});
+  // Values without a short decimal representation, which need all digits to be read back exactly.
+  path.add({f32q(0.7071068f, 0.1f, -0.3333333f, 1.0e-7f), f32v3(1.0f / 3.0f, -123456.79f, 3.4e38f)});
+  path.add({f32q(-0.5f, 0.5f, 0.5f, -0.5f), f32v3(-0.0f, 2.5f, 1.0e-30f)});
+
+  const TemporaryDirectory directory("gimslib-core-tests-camera-path");
+  const auto               fileName = directory.getPath() / "path.txt";
+  path.save(fileName);
+  const CameraPath loaded = CameraPath::load(fileName);
+
+  REQUIRE(loaded.getNumberOfPoses() == path.getNumberOfPoses());
+  for (ui32 i = 0; i < path.getNumberOfPoses(); i++)
+  {
+    const CameraPose& expected = path.getPose(i);
+    const CameraPose& actual   = loaded.getPose(i);
+    CHECK(actual.rotation.w == expected.rotation.w);
+    CHECK(actual.rotation.x == expected.rotation.x);
+    CHECK(actual.rotation.y == expected.rotation.y);
+    CHECK(actual.rotation.z == expected.rotation.z);
+    CHECK(actual.translation.x == expected.translation.x);
+    CHECK(actual.translation.y == expected.translation.y);
+    CHECK(actual.translation.z == expected.translation.z);
+  }
+}
+
+TEST_CASE("CameraPath starts over after its last pose", "[io]")
+{
+  CameraPath path;
+  CHECK_THROWS_AS(path.getPose(0), std::logic_error);
+  path.add({f32q(1.0f, 0.0f, 0.0f, 0.0f), f32v3(0.0f, 0.0f, 1.0f)});
+  path.add({f32q(1.0f, 0.0f, 0.0f, 0.0f), f32v3(0.0f, 0.0f, 2.0f)});
+  CHECK(path.getPose(0).translation.z == 1.0f);
+  CHECK(path.getPose(1).translation.z == 2.0f);
+  CHECK(path.getPose(5).translation.z == 2.0f);
+  path.clear();
+  CHECK(path.getNumberOfPoses() == 0);
+}
+
+TEST_CASE("CameraPath skips comments and rejects malformed files", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-camera-path");
+  const auto               fileName = directory.getPath() / "path.txt";
+
+  writeFile(fileName, "# comment\n\n1 0 0 0 1 2 3\n# another comment\n0 1 0 0 4 5 6\n");
+  const CameraPath path = CameraPath::load(fileName);
+  REQUIRE(path.getNumberOfPoses() == 2);
+  CHECK(path.getPose(1).rotation.x == 1.0f);
+  CHECK(path.getPose(1).translation.z == 6.0f);
+
+  writeFile(fileName, "1 0 0 0 1 2\n");
+  CHECK_THROWS_AS(CameraPath::load(fileName), std::runtime_error);
+  writeFile(fileName, "1 0 0 0 1 2 x\n");
+  CHECK_THROWS_AS(CameraPath::load(fileName), std::runtime_error);
+  writeFile(fileName, "# only a comment\n");
+  CHECK_THROWS_AS(CameraPath::load(fileName), std::runtime_error);
+  CHECK_THROWS_AS(CameraPath::load(directory.getPath() / "missing.txt"), std::runtime_error);
+}
@@ -0,0 +1,56 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <filesystem>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("CograBinaryMeshFile keeps positions, indices, attributes and constants when saved and loaded", "[io]")
+{
+  const std::vector<f32>  positions = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.5f};
+  const std::vector<ui32> indices   = {0, 1, 2, 2, 1, 3};
+  const std::vector<f32>  normals   = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+  const i32               answer    = 42;
+
+  CograBinaryMeshFile mesh;
+  mesh.setPositions(positions.data(), 4);
+  mesh.setTriangleIndices(indices.data(), 2);
+  mesh.addAttribute(normals.data(), 3, sizeof(f32), "normal");
+  mesh.addConstant(&answer, 1, sizeof(i32), "answer");
+
+  const TemporaryDirectory directory("gimslib-core-tests-cbm");
+  const auto               fileName = (directory.getPath() / "quad.cbm").string();
+  mesh.save(fileName);
+
+  const CograBinaryMeshFile loaded(fileName);
+  REQUIRE(loaded.getNumVertices() == 4);
+  REQUIRE(loaded.getNumTriangles() == 2);
+  CHECK(std::memcmp(loaded.getPositionsPtr(), positions.data(), positions.size() * sizeof(f32)) == 0);
+  CHECK(std::memcmp(loaded.getTriangleIndices(), indices.data(), indices.size() * sizeof(ui32)) == 0);
+  REQUIRE(loaded.getNumAttributes() == 1);
+  CHECK(std::string(loaded.getAttributeName(0)) == "normal");
+  CHECK(loaded.getAttributeElementSize(0) == 3 * sizeof(f32));
+  CHECK(std::memcmp(loaded.getAttributePtr(0), normals.data(), normals.size() * sizeof(f32)) == 0);
+  bool ok = false;
+  CHECK(loaded.getIntegerConstant("answer", &ok) == answer);
+  CHECK(ok);
+}
+
+TEST_CASE("CograBinaryMeshFile loads the bundled bunny", "[io]")
+{
+  const CograBinaryMeshFile bunny((std::filesystem::path(GIMS_TEST_DATA_DIRECTORY) / "bunny.cbm").string());
+  REQUIRE(bunny.getNumVertices() > 0);
+  REQUIRE(bunny.getNumTriangles() > 0);
+  const auto* indices = bunny.getTriangleIndices();
+  for (ui32 i = 0; i < bunny.getNumTriangles() * 3; i++)
+  {
+    REQUIRE(indices[i] < bunny.getNumVertices());
+  }
+}
+
+TEST_CASE("CograBinaryMeshFile throws if the file does not exist", "[io]")
+{
+  CHECK_THROWS(CograBinaryMeshFile("this-file-does-not-exist.cbm"));
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch.hpp>
+#include <gimslib/sys/CommandListSequence.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+// Records numbers instead of commands and checks that it is only filled while recording.
+struct MockCommandList
+{
+  std::vector<ui32> commands;
+  bool              isRecording = false;
+  ui32              nResets     = 0;
+
+  void reset()
+  {
+    if (isRecording)
+    {
+      throw std::logic_error("Reset while recording.");
+    }
+    commands.clear();
+    isRecording = true;
+    nResets++;
+  }
+
+  void close()
+  {
+    if (!isRecording)
+    {
+      throw std::logic_error("Closed twice.");
+    }
+    isRecording = false;
+  }
+
+  void record(ui32 command)
+  {
+    if (!isRecording)
+    {
+      throw std::logic_error("Recorded into a closed list.");
+    }
+    commands.push_back(command);
+  }
+};
+
+// The commands of all lists in submission order, i.e., in the order the GPU executes them.
+std::vector<ui32> getExecutedCommands(const std::vector<MockCommandList*>& commandLists)
+{
+  std::vector<ui32> result;
+  for (const MockCommandList* commandList : commandLists)
+  {
+    CHECK_FALSE(commandList->isRecording);
+    result.insert(result.end(), commandList->commands.begin(), commandList->commands.end());
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("partitionItems splits items into contiguous ranges of nearly equal size", "[sys]")
+{
+  CHECK(partitionItems(0, 4).empty());
+
+  const auto ranges = partitionItems(10, 4);
+  REQUIRE(ranges.size() == 4);
+  CHECK(ranges.front().begin == 0);
+  CHECK(ranges.back().end == 10);
+  for (size_t i = 0; i < ranges.size(); i++)
+  {
+    CHECK(ranges[i].end - ranges[i].begin >= 2);
+    CHECK(ranges[i].end - ranges[i].begin <= 3);
+    if (i > 0)
+    {
+      CHECK(ranges[i].begin == ranges[i - 1].end);
+    }
+  }
+
+  CHECK(partitionItems(10, 4, 4).size() == 2);
+  CHECK(partitionItems(3, 8).size() == 3);
+  CHECK(partitionItems(3, 0).size() == 1);
+  CHECK(partitionItems(3, 8, 100).size() == 1);
+}
+
+TEST_CASE("CommandListSequence executes parallel chunks in order between the serial commands", "[sys]")
+{
+  ThreadPool                           pool(4);
+  ui32                                 nCreatedLists = 0;
+  CommandListSequence<MockCommandList> sequence(
+      [&]()
+      {
+        nCreatedLists++;
+        return std::make_unique<MockCommandList>();
+      });
+
+  const ui32 nItems = 1000;
+  for (ui32 frameIdx = 0; frameIdx < 3; frameIdx++)
+  {
+    sequence.begin();
+    sequence.getCurrent().record(0);
+    const auto ranges = partitionItems(nItems, 7);
+    sequence.recordParallel(static_cast<ui32>(ranges.size()), &pool,
+                            [&](ui32 chunkIdx, MockCommandList& commandList)
+                            {
+                              for (ui32 i = ranges[chunkIdx].begin; i < ranges[chunkIdx].end; i++)
+                              {
+                                commandList.record(i + 1);
+                              }
+                            });
+    sequence.getCurrent().record(nItems + 1);
+    const ui32 splitIdx = sequence.split();
+    sequence.getCurrent().record(nItems + 2);
+    const auto& commandLists = sequence.end();
+
+    // The serial list, one list per chunk, the list after the chunks and the one after the split.
+    REQUIRE(commandLists.size() == 1 + 7 + 2);
+    CHECK(splitIdx == 9);
+    std::vector<ui32> expectedCommands;
+    for (ui32 i = 0; i <= nItems + 2; i++)
+    {
+      expectedCommands.push_back(i);
+    }
+    CHECK(getExecutedCommands(commandLists) == expectedCommands);
+  }
+  // The lists of the first frame are reused by the following ones.
+  CHECK(nCreatedLists == 10);
+  CHECK(sequence.getNumberOfCommandLists() == 10);
+}
+
+TEST_CASE("CommandListSequence records chunks on the calling thread without a pool", "[sys]")
+{
+  CommandListSequence<MockCommandList> sequence([]() { return std::make_unique<MockCommandList>(); });
+  sequence.begin();
+  sequence.recordParallel(3, nullptr,
+                          [](ui32 chunkIdx, MockCommandList& commandList) { commandList.record(chunkIdx); });
+  sequence.recordParallel(0, nullptr, [](ui32, MockCommandList&) { FAIL("No chunk to record."); });
+  CHECK(getExecutedCommands(sequence.end()) == std::vector<ui32> {0, 1, 2});
+}
@@ -0,0 +1,92 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <gimslib/sys/DeduplicatedBatch.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("DeduplicatedBatch creates each distinct object once", "[sys]")
+{
+  ThreadPool                     pool(4);
+  DeduplicatedBatch<std::string> batch;
+  std::atomic<ui32>              nCalls = 0;
+  const auto                     create = [&](const std::string& value)
+  {
+    return [&nCalls, value]()
+    {
+      nCalls++;
+      return value;
+    };
+  };
+
+  const ui32 one       = batch.request(1, create("one"));
+  const ui32 two       = batch.request(2, create("two"));
+  const ui32 duplicate = batch.request(1, create("duplicate"));
+  CHECK(duplicate == one);
+  CHECK(two != one);
+  CHECK(batch.getNumberOfRequests() == 3);
+  CHECK(batch.getNumberOfEntries() == 2);
+  CHECK(batch.getNumberOfPendingEntries() == 2);
+  CHECK_FALSE(batch.isCreated(one));
+  CHECK_THROWS_AS(batch.get(one), std::logic_error);
+
+  CHECK(batch.run(&pool) == 2);
+  CHECK(nCalls == 2);
+  CHECK(batch.get(one) == "one");
+  CHECK(batch.get(two) == "two");
+  CHECK(batch.getHash(two) == 2);
+  CHECK(batch.getNumberOfPendingEntries() == 0);
+
+  // Requests after the run only create the new objects.
+  const ui32 three = batch.request(3, create("three"));
+  CHECK(batch.request(2, create("duplicate")) == two);
+  CHECK(batch.run(nullptr) == 1);
+  CHECK(nCalls == 3);
+  CHECK(batch.get(three) == "three");
+}
+
+TEST_CASE("DeduplicatedBatch creates many requests in parallel", "[sys]")
+{
+  ThreadPool              pool(4);
+  DeduplicatedBatch<ui64> batch;
+  std::vector<ui32>       entries;
+  for (ui64 i = 0; i < 1000; i++)
+  {
+    // Every hash is requested twice.
+    entries.push_back(batch.request(i % 500, [i]() { return (i % 500) * 7; }));
+  }
+  CHECK(batch.getNumberOfEntries() == 500);
+  CHECK(batch.run(&pool) == 500);
+  for (ui64 i = 0; i < entries.size(); i++)
+  {
+    REQUIRE(batch.get(entries[i]) == (i % 500) * 7);
+  }
+}
+
+TEST_CASE("DeduplicatedBatch keeps failed entries pending", "[sys]")
+{
+  ThreadPool             pool(2);
+  DeduplicatedBatch<int> batch;
+  bool                   fail = true;
+  const ui32             good = batch.request(1, []() { return 1; });
+  const ui32             bad  = batch.request(2,
+                                              [&fail]()
+                                              {
+                                                if (fail)
+                                                {
+                                                  throw std::runtime_error("Creation failed.");
+                                                }
+                                                return 2;
+                                              });
+
+  CHECK_THROWS_AS(batch.run(&pool), std::runtime_error);
+  CHECK(batch.isCreated(good));
+  CHECK_FALSE(batch.isCreated(bad));
+  CHECK(batch.getNumberOfPendingEntries() == 1);
+
+  fail = false;
+  CHECK(batch.run(&pool) == 1);
+  CHECK(batch.get(bad) == 2);
+}
@@ -0,0 +1,140 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <fstream>
+#include <gimslib/io/GltfFile.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+std::string encodeBase64(const std::vector<ui8>& bytes)
+{
+  const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string result;
+  for (size_t i = 0; i < bytes.size(); i += 3)
+  {
+    const ui32 nBytes = static_cast<ui32>(std::min<size_t>(3, bytes.size() - i));
+    ui32       group  = 0;
+    for (ui32 j = 0; j < 3; j++)
+    {
+      group = (group << 8) | (j < nBytes ? bytes[i + j] : 0);
+    }
+    for (ui32 j = 0; j < 4; j++)
+    {
+      result += j <= nBytes ? alphabet[(group >> (18 - 6 * j)) & 0x3f] : '=';
+    }
+  }
+  return result;
+}
+
+template <typename T> void append(std::vector<ui8>& bytes, const T& value)
+{
+  const size_t offset = bytes.size();
+  bytes.resize(offset + sizeof(T));
+  std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+// A triangle with positions and texture coordinates interleaved at a stride of 20 bytes, and 16-bit indices after it.
+std::vector<ui8> createTriangleBuffer()
+{
+  std::vector<ui8> bytes;
+  for (ui32 i = 0; i < 3; i++)
+  {
+    append(bytes, f32v3(static_cast<f32>(i), 10.0f + i, 20.0f + i));
+    append(bytes, f32v2(0.5f * i, 1.0f - 0.5f * i));
+  }
+  for (const ui16 index : {2, 1, 0})
+  {
+    append(bytes, index);
+  }
+  return bytes;
+}
+
+std::string createTriangleGltf(const std::string& uri, ui32 nPositions)
+{
+  return R"({"asset": {"version": "2.0"},
+  "buffers": [{"byteLength": 66, "uri": ")" +
+         uri + R"("}],
+  "bufferViews": [{"buffer": 0, "byteLength": 60, "byteStride": 20}, {"buffer": 0, "byteOffset": 60, "byteLength": 6}],
+  "accessors": [{"bufferView": 0, "componentType": 5126, "type": "VEC3", "count": )" +
+         std::to_string(nPositions) + R"(},
+                {"bufferView": 0, "byteOffset": 12, "componentType": 5126, "type": "VEC2", "count": 3},
+                {"bufferView": 1, "componentType": 5123, "type": "SCALAR", "count": 3}],
+  "meshes": [{"name": "triangle", "primitives": [{"attributes": {"POSITION": 0, "TEXCOORD_0": 1}, "indices": 2}]}],
+  "nodes": [{"mesh": 0, "translation": [1, 2, 3]}],
+  "scenes": [{"nodes": [0]}]})";
+}
+
+void writeTextFile(const std::filesystem::path& path, const std::string& text)
+{
+  std::ofstream stream(path, std::ios::binary);
+  stream << text;
+}
+} // namespace
+
+TEST_CASE("glTF buffers in data URIs are decoded into strided accessor views", "[io]")
+{
+  TemporaryDirectory directory("gims-gltf-test");
+  const auto         path = directory.getPath() / "triangle.gltf";
+  writeTextFile(path, createTriangleGltf("data:application/octet-stream;base64," +
+                                             encodeBase64(createTriangleBuffer()), 3));
+  const GltfFile file(path);
+
+  REQUIRE(file.getMeshes().size() == 1);
+  REQUIRE(file.getMeshes()[0].primitives.size() == 1);
+  const GltfPrimitive& primitive = file.getMeshes()[0].primitives[0];
+  // The constant is copied, since it has no definition to bind a reference to.
+  const ui32 invalidIdx = GltfFile::invalidIdx;
+  CHECK(primitive.normals == invalidIdx);
+  CHECK(primitive.mode == 4);
+
+  const auto positions = file.getAccessorView<f32v3>(primitive.positions);
+  REQUIRE(positions.size() == 3);
+  const auto textureCoordinates = file.getAccessorView<f32v2>(primitive.textureCoordinates);
+  REQUIRE(textureCoordinates.size() == 3);
+  for (ui32 i = 0; i < 3; i++)
+  {
+    CHECK(positions[i] == f32v3(static_cast<f32>(i), 10.0f + i, 20.0f + i));
+    CHECK(textureCoordinates[i] == f32v2(0.5f * i, 1.0f - 0.5f * i));
+  }
+  CHECK(file.readIndices(primitive.indices) == std::vector<ui32> {2, 1, 0});
+  CHECK_THROWS_AS(file.getAccessorView<f32v2>(primitive.positions), std::runtime_error);
+  CHECK_THROWS_AS(file.getAccessorView<f32v3>(3), std::out_of_range);
+
+  REQUIRE(file.getNodes().size() == 1);
+  CHECK(file.getRootNodes() == std::vector<ui32> {0});
+  CHECK(file.getNodes()[0].mesh == 0);
+  CHECK(file.getNodes()[0].transformation[3] == f32v4(1.0f, 2.0f, 3.0f, 1.0f));
+}
+
+TEST_CASE("glTF files with accessors beyond their buffer views are rejected", "[io]")
+{
+  TemporaryDirectory directory("gims-gltf-test");
+  const auto         path = directory.getPath() / "triangle.gltf";
+  // A fourth position would be read from the indices and beyond.
+  writeTextFile(path, createTriangleGltf("data:application/octet-stream;base64," +
+                                             encodeBase64(createTriangleBuffer()), 4));
+  CHECK_THROWS_AS(GltfFile(path), std::runtime_error);
+}
+
+TEST_CASE("glTF files with buffers that are too short or corrupt are rejected", "[io]")
+{
+  TemporaryDirectory directory("gims-gltf-test");
+  const auto         path   = directory.getPath() / "triangle.gltf";
+  auto               buffer = createTriangleBuffer();
+  buffer.resize(60);
+  writeTextFile(path, createTriangleGltf("data:application/octet-stream;base64," + encodeBase64(buffer), 3));
+  CHECK_THROWS_AS(GltfFile(path), std::runtime_error);
+
+  writeTextFile(path, createTriangleGltf("data:application/octet-stream;base64,AA*A", 3));
+  CHECK_THROWS_AS(GltfFile(path), std::runtime_error);
+
+  const std::string text = createTriangleGltf("data:application/octet-stream;base64," +
+                                              encodeBase64(createTriangleBuffer()), 3);
+  writeTextFile(path, text.substr(0, text.size() / 2));
+  CHECK_THROWS_AS(GltfFile(path), std::runtime_error);
+}
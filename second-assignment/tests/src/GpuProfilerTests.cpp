@@ -0,0 +1,139 @@
+#include <catch2/catch.hpp>
+#include <gimslib/sys/GpuProfiler.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("GpuProfiler gives each frame slot its own consecutive queries", "[sys]")
+{
+  GpuProfiler profiler(2, 2, 1000);
+  CHECK(profiler.getNumberOfQueries() == 8);
+
+  profiler.beginFrame(1, nullptr);
+  CHECK(profiler.beginPass("Outer") == 4);
+  CHECK(profiler.beginPass("Inner") == 6);
+  CHECK(profiler.endPass() == 7);
+  CHECK(profiler.endPass() == 5);
+  // The frame has no queries left. The constant is copied, since it has no definition to bind a reference to.
+  const ui32 invalidQuery = GpuProfiler::invalidQuery;
+  CHECK(profiler.beginPass("Unmeasured") == invalidQuery);
+  CHECK(profiler.endPass() == invalidQuery);
+  const GpuQueryRange range = profiler.endFrame();
+  CHECK(range.first == 4);
+  CHECK(range.count == 4);
+
+  profiler.beginFrame(0, nullptr);
+  CHECK(profiler.beginPass("Outer") == 0);
+  CHECK(profiler.endPass() == 1);
+  CHECK(profiler.endFrame().count == 2);
+}
+
+TEST_CASE("GpuProfiler reads the timestamps of a slot when it is used again", "[sys]")
+{
+  // One tick per millisecond.
+  GpuProfiler       profiler(2, 4, 1000, 2);
+  std::vector<ui64> timestamps(profiler.getNumberOfQueries(), 0);
+
+  const auto recordFrame = [&](ui32 frameSlot, ui64 shadowTicks, ui64 drawTicks)
+  {
+    profiler.beginFrame(frameSlot, timestamps.data());
+    const ui32 frameBegin  = profiler.beginPass("Frame");
+    const ui32 shadowBegin = profiler.beginPass("Shadows");
+    const ui32 shadowEnd   = profiler.endPass();
+    const ui32 drawBegin   = profiler.beginPass("Draw");
+    const ui32 drawEnd     = profiler.endPass();
+
+    // Passes with the same name are added up.
+    const ui32 secondDrawBegin = profiler.beginPass("Draw");
+    const ui32 secondDrawEnd   = profiler.endPass();
+    const ui32 frameEnd        = profiler.endPass();
+    profiler.endFrame();
+
+    timestamps[frameBegin]      = 100;
+    timestamps[shadowBegin]     = 100;
+    timestamps[shadowEnd]       = 100 + shadowTicks;
+    timestamps[drawBegin]       = 200;
+    timestamps[drawEnd]         = 200 + drawTicks;
+    timestamps[secondDrawBegin] = 300;
+    timestamps[secondDrawEnd]   = 301;
+    timestamps[frameEnd]        = 400;
+  };
+
+  recordFrame(0, 10, 20);
+  recordFrame(1, 30, 40);
+  CHECK(profiler.getNumberOfFrames() == 0);
+  CHECK(profiler.getPassTimings().empty());
+
+  // Slot 0 is used again, so the first frame is read.
+  recordFrame(0, 50, 60);
+  CHECK(profiler.getNumberOfFrames() == 1);
+  CHECK(profiler.getLastReadFrameIdx() == 0);
+  auto passTimings = profiler.getPassTimings();
+  REQUIRE(passTimings.size() == 3);
+  CHECK(passTimings[0].name == "Frame");
+  CHECK(passTimings[0].depth == 0);
+  CHECK(passTimings[0].milliseconds == Approx(300.0));
+  CHECK(passTimings[1].name == "Shadows");
+  CHECK(passTimings[1].depth == 1);
+  CHECK(passTimings[1].milliseconds == Approx(10.0));
+  CHECK(passTimings[2].name == "Draw");
+  CHECK(passTimings[2].milliseconds == Approx(21.0));
+  CHECK(passTimings[2].nFrames == 1);
+
+  // The averages cover the last two frames.
+  recordFrame(1, 70, 80);
+  recordFrame(0, 90, 100);
+  CHECK(profiler.getNumberOfFrames() == 3);
+  CHECK(profiler.getLastReadFrameIdx() == 2);
+  passTimings = profiler.getPassTimings();
+  REQUIRE(passTimings.size() == 3);
+  CHECK(passTimings[1].milliseconds == Approx(50.0));
+  CHECK(passTimings[1].averageMilliseconds == Approx(40.0));
+  CHECK(passTimings[1].maxMilliseconds == Approx(50.0));
+  CHECK(passTimings[1].nFrames == 2);
+
+  std::stringstream json;
+  profiler.writeJson(json);
+  CHECK(json.str().find("\"name\":\"Shadows\"") != std::string::npos);
+  CHECK(json.str().find("\"frames\":3") != std::string::npos);
+}
+
+TEST_CASE("GpuProfiler skips slots whose results are lost and negative times", "[sys]")
+{
+  GpuProfiler       profiler(1, 1, 1000);
+  std::vector<ui64> timestamps = {20, 10};
+  profiler.beginFrame(0, nullptr);
+  profiler.beginPass("Pass");
+  profiler.endPass();
+  profiler.endFrame();
+  profiler.beginFrame(0, nullptr);
+  CHECK(profiler.getNumberOfFrames() == 0);
+
+  profiler.beginPass("Pass");
+  profiler.endPass();
+  profiler.endFrame();
+  profiler.beginFrame(0, timestamps.data());
+  REQUIRE(profiler.getPassTimings().size() == 1);
+  CHECK(profiler.getPassTimings()[0].milliseconds == 0.0);
+}
+
+TEST_CASE("GpuProfiler rejects invalid arguments and unbalanced passes", "[sys]")
+{
+  CHECK_THROWS_AS(GpuProfiler(0, 1, 1000), std::invalid_argument);
+  CHECK_THROWS_AS(GpuProfiler(1, 0, 1000), std::invalid_argument);
+  CHECK_THROWS_AS(GpuProfiler(1, 1, 0), std::invalid_argument);
+  CHECK_THROWS_AS(GpuProfiler(1, 1, 1000, 0), std::invalid_argument);
+
+  GpuProfiler profiler(2, 4, 1000);
+  CHECK_THROWS_AS(profiler.beginFrame(2, nullptr), std::invalid_argument);
+  CHECK_THROWS_AS(profiler.beginPass("Pass"), std::logic_error);
+  profiler.beginFrame(0, nullptr);
+  CHECK_THROWS_AS(profiler.beginFrame(1, nullptr), std::logic_error);
+  CHECK_THROWS_AS(profiler.endPass(), std::logic_error);
+  profiler.beginPass("Pass");
+  CHECK_THROWS_AS(profiler.endFrame(), std::logic_error);
+  profiler.endPass();
+  CHECK_NOTHROW(profiler.endFrame());
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("hashBytes matches the reference values of XXH64", "[sys]")
+{
+  const std::string abc        = "abc";
+  const std::string repetition = "Nobody inspects the spammish repetition";
+  CHECK(hashBytes(nullptr, 0) == 0xef46db3751d8e999ull);
+  CHECK(hashBytes(abc.data(), abc.size()) == 0x44bc2cf5ad770999ull);
+  CHECK(hashBytes(repetition.data(), repetition.size()) == 0xfbcea83c8a378bf1ull);
+  CHECK(toHexString(0xfbcea83c8a378bf1ull) == "fbcea83c8a378bf1");
+}
+
+TEST_CASE("Hasher does not depend on how the bytes are split", "[sys]")
+{
+  std::vector<ui8> bytes(300);
+  for (size_t i = 0; i < bytes.size(); i++)
+  {
+    bytes[i] = static_cast<ui8>(i * 37 + 11);
+  }
+  const ui64 expected = hashBytes(bytes.data(), bytes.size());
+  for (const size_t chunkSize : {1, 3, 7, 8, 31, 32, 33, 100})
+  {
+    Hasher hasher;
+    for (size_t offset = 0; offset < bytes.size(); offset += chunkSize)
+    {
+      hasher.add(bytes.data() + offset, std::min(chunkSize, bytes.size() - offset));
+    }
+    CHECK(hasher.getValue() == expected);
+  }
+
+  // Each byte changes the hash, also in the tail after the last stripe.
+  for (const size_t changedIdx : {0, 31, 32, 290, 299})
+  {
+    std::vector<ui8> changed = bytes;
+    changed[changedIdx] ^= 1;
+    CHECK(hashBytes(changed.data(), changed.size()) != expected);
+  }
+}
+
+TEST_CASE("Hasher adds the length of strings", "[sys]")
+{
+  Hasher ab;
+  ab.add(std::string("ab"));
+  ab.add(std::string("c"));
+  Hasher a;
+  a.add(std::string("a"));
+  a.add(std::string("bc"));
+  CHECK(ab.getValue() != a.getValue());
+
+  Hasher wide;
+  wide.add(std::wstring(L"abc"));
+  Hasher sameWide;
+  sameWide.add(std::wstring(L"abc"));
+  CHECK(wide.getValue() == sameWide.getValue());
+}
@@ -0,0 +1,224 @@
+#include "IndirectDrawing.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <glm/gtc/matrix_transform.hpp>
+#include <utility>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+// A root with three children. Mesh 0 occurs twice, the material indices of the meshes are 1, 0 and 1.
+std::vector<SceneNode> createScene()
+{
+  std::vector<SceneNode> nodes(4);
+  nodes[0].transformation = f32m4(1.0f);
+  nodes[0].childIndices   = {1, 2, 3};
+  nodes[1].transformation = glm::translate(f32m4(1.0f), f32v3(-1.0f, 0.0f, 10.0f));
+  nodes[1].meshIndices    = {0, 1};
+  nodes[2].transformation = glm::translate(f32m4(1.0f), f32v3(30.0f, 0.0f, 10.0f));
+  nodes[2].meshIndices    = {0};
+  nodes[3].transformation = glm::translate(f32m4(1.0f), f32v3(0.0f, 0.0f, 100.0f));
+  nodes[3].meshIndices    = {2};
+  return nodes;
+}
+
+std::vector<IndirectMeshBuffers> createMeshes()
+{
+  std::vector<IndirectMeshBuffers> meshes(3);
+  const ui32                       materialIndices[] = {1, 0, 1};
+  for (ui32 meshIdx = 0; meshIdx < meshes.size(); meshIdx++)
+  {
+    IndirectMeshBuffers& mesh = meshes[meshIdx];
+    mesh.vertexBufferLocation = 0x10000 * (meshIdx + 1);
+    mesh.vertexBufferSize     = 1024 * (meshIdx + 1);
+    mesh.vertexBufferStride   = 44;
+    mesh.indexBufferLocation  = 0x10000 * (meshIdx + 1) + 0x8000;
+    mesh.indexBufferSize      = 12 * (meshIdx + 1);
+    mesh.indexBufferFormat    = 42;
+    mesh.nIndices             = 3 * (meshIdx + 1);
+    mesh.materialIndex        = materialIndices[meshIdx];
+    mesh.lowerLeftBottom      = f32v3(-0.5f);
+    mesh.upperRightTop        = f32v3(0.5f);
+  }
+  return meshes;
+}
+
+// The draws of the direct path, which issues one instanced draw per batch, as pairs of mesh and instance index.
+std::vector<std::pair<ui32, ui32>> getDirectDraws(const InstanceBatches& instanceBatches)
+{
+  std::vector<std::pair<ui32, ui32>> result;
+  for (const auto& batch : instanceBatches.batches)
+  {
+    for (ui32 i = 0; i < batch.nInstances; i++)
+    {
+      result.emplace_back(batch.meshIdx, batch.firstInstance + i);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+ui32 findMesh(const std::vector<IndirectMeshBuffers>& meshes, const IndirectDrawCommand& command)
+{
+  for (ui32 meshIdx = 0; meshIdx < meshes.size(); meshIdx++)
+  {
+    if (meshes[meshIdx].vertexBufferLocation == command.vertexBufferLocation)
+    {
+      return meshIdx;
+    }
+  }
+  return ~0u;
+}
+
+// Visible unless all corners of the box are outside the same clip plane, computed in clip space.
+bool isBoxVisible(const f32m4& viewProjection, const f32m4& transformation, const IndirectMeshBuffers& mesh)
+{
+  ui32 outsideMasks = 0x3f;
+  for (ui32 cornerIdx = 0; cornerIdx < 8; cornerIdx++)
+  {
+    const f32v3 corner(cornerIdx & 1 ? mesh.upperRightTop.x : mesh.lowerLeftBottom.x,
+                       cornerIdx & 2 ? mesh.upperRightTop.y : mesh.lowerLeftBottom.y,
+                       cornerIdx & 4 ? mesh.upperRightTop.z : mesh.lowerLeftBottom.z);
+    const f32v4 p = viewProjection * transformation * f32v4(corner, 1.0f);
+    outsideMasks &= (p.x < -p.w ? 0x1 : 0) | (p.x > p.w ? 0x2 : 0) | (p.y < -p.w ? 0x4 : 0) |
+                    (p.y > p.w ? 0x8 : 0) | (p.z < 0.0f ? 0x10 : 0) | (p.z > p.w ? 0x20 : 0);
+  }
+  return outsideMasks == 0;
+}
+} // namespace
+
+TEST_CASE("Indirect argument offsets match the layout of IndirectDrawCommand", "[indirect]")
+{
+  const auto layout  = getIndirectDrawCommandLayout(3);
+  const auto offsets = getIndirectArgumentOffsets(layout);
+  REQUIRE(layout.size() == 4);
+  CHECK(layout[0].type == IndirectArgumentType::Constant);
+  CHECK(layout[0].rootParameterIdx == 3);
+  CHECK(layout[0].destOffsetIn32BitValues == 16);
+  CHECK(layout[0].num32BitValues == 2);
+  REQUIRE(offsets.size() == layout.size() + 1);
+  CHECK(offsets[0] == offsetof(IndirectDrawCommand, materialIndex));
+  CHECK(offsets[1] == offsetof(IndirectDrawCommand, vertexBufferLocation));
+  CHECK(offsets[2] == offsetof(IndirectDrawCommand, indexBufferLocation));
+  CHECK(offsets[3] == offsetof(IndirectDrawCommand, indexCountPerInstance));
+  CHECK(offsets[4] == sizeof(IndirectDrawCommand));
+}
+
+TEST_CASE("Indirect argument offsets align buffer views to 8 bytes", "[indirect]")
+{
+  IndirectArgument constant;
+  constant.type           = IndirectArgumentType::Constant;
+  constant.num32BitValues = 1;
+  IndirectArgument vertexBufferView;
+  vertexBufferView.type = IndirectArgumentType::VertexBufferView;
+  IndirectArgument drawIndexed;
+  drawIndexed.type = IndirectArgumentType::DrawIndexed;
+
+  const auto offsets = getIndirectArgumentOffsets({constant, vertexBufferView, drawIndexed});
+  CHECK(offsets == std::vector<ui32> {0, 8, 24, 48});
+}
+
+TEST_CASE("Packed indirect commands draw the same instances as the direct path", "[indirect]")
+{
+  const auto nodes           = createScene();
+  const auto meshes          = createMeshes();
+  const auto instanceBatches = createInstanceBatches(nodes, static_cast<ui32>(meshes.size()));
+  const auto indirectData    = packIndirectDrawData(instanceBatches.batches, meshes);
+
+  REQUIRE(indirectData.commandTemplates.size() == 4);
+  REQUIRE(indirectData.cullRecords.size() == indirectData.commandTemplates.size());
+
+  std::vector<std::pair<ui32, ui32>> indirectDraws;
+  for (const auto& command : indirectData.commandTemplates)
+  {
+    const ui32 meshIdx = findMesh(meshes, command);
+    REQUIRE(meshIdx < meshes.size());
+    const IndirectMeshBuffers& mesh = meshes[meshIdx];
+    CHECK(command.materialIndex == mesh.materialIndex);
+    CHECK(command.vertexBufferSize == mesh.vertexBufferSize);
+    CHECK(command.vertexBufferStride == mesh.vertexBufferStride);
+    CHECK(command.indexBufferLocation == mesh.indexBufferLocation);
+    CHECK(command.indexBufferSize == mesh.indexBufferSize);
+    CHECK(command.indexBufferFormat == mesh.indexBufferFormat);
+    CHECK(command.indexCountPerInstance == mesh.nIndices);
+    CHECK(command.instanceCount == 1);
+    CHECK(command.startIndexLocation == 0);
+    CHECK(command.baseVertexLocation == 0);
+    CHECK(command.startInstanceLocation == 0);
+    indirectDraws.emplace_back(meshIdx, command.instanceIndex);
+  }
+  std::sort(indirectDraws.begin(), indirectDraws.end());
+  CHECK(indirectDraws == getDirectDraws(instanceBatches));
+}
+
+TEST_CASE("Packed indirect commands are grouped by material", "[indirect]")
+{
+  const auto meshes          = createMeshes();
+  const auto instanceBatches = createInstanceBatches(createScene(), static_cast<ui32>(meshes.size()));
+  const auto indirectData    = packIndirectDrawData(instanceBatches.batches, meshes);
+
+  REQUIRE(indirectData.groups.size() == 2);
+  CHECK(indirectData.groups[0].materialIndex == 0);
+  CHECK(indirectData.groups[0].firstCommand == 0);
+  CHECK(indirectData.groups[0].nCommands == 1);
+  CHECK(indirectData.groups[1].materialIndex == 1);
+  CHECK(indirectData.groups[1].firstCommand == 1);
+  CHECK(indirectData.groups[1].nCommands == 3);
+  for (ui32 groupIdx = 0; groupIdx < indirectData.groups.size(); groupIdx++)
+  {
+    const auto& group = indirectData.groups[groupIdx];
+    for (ui32 commandIdx = group.firstCommand; commandIdx < group.firstCommand + group.nCommands; commandIdx++)
+    {
+      CHECK(indirectData.commandTemplates[commandIdx].materialIndex == group.materialIndex);
+      CHECK(indirectData.cullRecords[commandIdx].groupIdx == groupIdx);
+      CHECK(indirectData.cullRecords[commandIdx].groupFirstCommand == group.firstCommand);
+      CHECK(indirectData.cullRecords[commandIdx].instanceIndex ==
+            indirectData.commandTemplates[commandIdx].instanceIndex);
+      CHECK(indirectData.cullRecords[commandIdx].center == f32v4(0.0f, 0.0f, 0.0f, 1.0f));
+      CHECK(indirectData.cullRecords[commandIdx].extent == f32v4(0.5f, 0.5f, 0.5f, 0.0f));
+    }
+  }
+}
+
+TEST_CASE("Packing rejects batches of meshes that do not exist", "[indirect]")
+{
+  const auto    meshes = createMeshes();
+  InstanceBatch batch;
+  batch.meshIdx    = static_cast<ui32>(meshes.size());
+  batch.nInstances = 1;
+  CHECK_THROWS_AS(packIndirectDrawData({batch}, meshes), std::out_of_range);
+}
+
+TEST_CASE("The culling reference keeps the instances whose boxes intersect the frustum", "[indirect]")
+{
+  const auto  meshes          = createMeshes();
+  const auto  instanceBatches = createInstanceBatches(createScene(), static_cast<ui32>(meshes.size()));
+  const auto  indirectData    = packIndirectDrawData(instanceBatches.batches, meshes);
+  const f32m4 viewProjection  = glm::perspectiveFovLH_ZO(glm::radians(90.0f), 1.0f, 1.0f, 0.1f, 50.0f);
+
+  const auto visibleCommands = cullIndirectDrawDataReference(extractFrustumPlanes(viewProjection),
+                                                             instanceBatches.instanceTransformations, indirectData);
+
+  // Meshes 0 and 1 of the first child are visible, mesh 0 of the second child is right of the frustum, and mesh 2
+  // is behind the far plane.
+  std::vector<ui32> expectedCommands;
+  for (ui32 commandIdx = 0; commandIdx < indirectData.commandTemplates.size(); commandIdx++)
+  {
+    const auto& command = indirectData.commandTemplates[commandIdx];
+    if (isBoxVisible(viewProjection, instanceBatches.instanceTransformations[command.instanceIndex],
+                     meshes[findMesh(meshes, command)]))
+    {
+      expectedCommands.push_back(commandIdx);
+    }
+  }
+  CHECK(visibleCommands == expectedCommands);
+  REQUIRE(visibleCommands.size() == 2);
+  for (const ui32 commandIdx : visibleCommands)
+  {
+    const ui32 instanceIdx = indirectData.commandTemplates[commandIdx].instanceIndex;
+    CHECK(instanceBatches.instanceTransformations[instanceIdx][3] == f32v4(-1.0f, 0.0f, 10.0f, 1.0f));
+  }
+}
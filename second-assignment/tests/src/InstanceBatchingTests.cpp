@@ -0,0 +1,112 @@
+#include "InstanceBatching.hpp"
+#include <catch2/catch.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+// Mesh 0 occurs under two different parents and in the root, mesh 2 once, mesh 1 never.
+struct TestScene
+{
+  TestScene()
+      : nodes(5)
+      , parentA(glm::translate(f32m4(1.0f), f32v3(10.0f, 0.0f, 0.0f)))
+      , parentB(glm::scale(f32m4(1.0f), f32v3(2.0f, 3.0f, 4.0f)))
+      , child(glm::translate(f32m4(1.0f), f32v3(0.0f, 5.0f, 0.0f)))
+  {
+    nodes[0].transformation = f32m4(1.0f);
+    nodes[0].meshIndices    = {0};
+    nodes[0].childIndices   = {1, 2};
+    nodes[1].transformation = parentA;
+    nodes[1].childIndices   = {3};
+    nodes[2].transformation = parentB;
+    nodes[2].childIndices   = {4};
+    nodes[3].transformation = child;
+    nodes[3].meshIndices    = {0, 2};
+    nodes[4].transformation = child;
+    nodes[4].meshIndices    = {0};
+  }
+
+  std::vector<SceneNode> nodes;
+  f32m4                  parentA;
+  f32m4                  parentB;
+  f32m4                  child;
+};
+
+void checkEqual(const f32m4& a, const f32m4& b)
+{
+  for (i32 column = 0; column < 4; column++)
+  {
+    for (i32 row = 0; row < 4; row++)
+    {
+      CHECK(a[column][row] == Approx(b[column][row]));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("createInstanceBatches collapses the occurrences of a mesh into one batch", "[scene]")
+{
+  const TestScene       scene;
+  const InstanceBatches result = createInstanceBatches(scene.nodes, 3);
+
+  // Mesh 1 is never referenced, so it gets no batch.
+  REQUIRE(result.batches.size() == 2);
+  CHECK(result.batches[0].meshIdx == 0);
+  CHECK(result.batches[0].firstInstance == 0);
+  CHECK(result.batches[0].nInstances == 3);
+  CHECK(result.batches[1].meshIdx == 2);
+  CHECK(result.batches[1].firstInstance == 3);
+  CHECK(result.batches[1].nInstances == 1);
+  CHECK(result.instanceTransformations.size() == 4);
+}
+
+TEST_CASE("createInstanceBatches accumulates the transformations of the parents", "[scene]")
+{
+  const TestScene       scene;
+  const InstanceBatches result = createInstanceBatches(scene.nodes, 3);
+  REQUIRE(result.instanceTransformations.size() == 4);
+
+  // The instances of a batch are in traversal order.
+  const InstanceBatch& mesh0 = result.batches[0];
+  checkEqual(result.instanceTransformations[mesh0.firstInstance + 0], f32m4(1.0f));
+  checkEqual(result.instanceTransformations[mesh0.firstInstance + 1], scene.parentA * scene.child);
+  checkEqual(result.instanceTransformations[mesh0.firstInstance + 2], scene.parentB * scene.child);
+  checkEqual(result.instanceTransformations[result.batches[1].firstInstance], scene.parentA * scene.child);
+
+  // The translation of the child is scaled by the parent, so the order of the product matters.
+  const f32v4 origin = result.instanceTransformations[mesh0.firstInstance + 2] * f32v4(0.0f, 0.0f, 0.0f, 1.0f);
+  CHECK(origin.y == Approx(15.0f));
+}
+
+TEST_CASE("createInstanceBatches counts the draw calls before and after instancing", "[scene]")
+{
+  const TestScene       scene;
+  const InstanceBatches result = createInstanceBatches(scene.nodes, 3);
+  CHECK(result.nDrawCallsWithoutInstancing == 4);
+  CHECK(result.nDrawCallsWithInstancing == 2);
+
+  std::ostringstream stream;
+  printInstanceBatchingReport(stream, result);
+  CHECK(stream.str().find("Number of Batches With More Than One Instance: 1") != std::string::npos);
+  CHECK(stream.str().find("Draw Calls Without Instancing: 4") != std::string::npos);
+  CHECK(stream.str().find("Draw Calls With Instancing: 2") != std::string::npos);
+}
+
+TEST_CASE("createInstanceBatches skips invalid mesh and node indices", "[scene]")
+{
+  std::vector<SceneNode> nodes(1);
+  nodes[0].transformation = f32m4(1.0f);
+  nodes[0].meshIndices    = {0, 7};
+  nodes[0].childIndices   = {9};
+  const InstanceBatches result = createInstanceBatches(nodes, 1);
+  REQUIRE(result.batches.size() == 1);
+  CHECK(result.batches[0].nInstances == 1);
+  CHECK(result.nDrawCallsWithoutInstancing == 1);
+
+  CHECK(createInstanceBatches(nodes, 1, 5).batches.empty());
+}
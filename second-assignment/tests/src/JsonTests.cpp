@@ -0,0 +1,92 @@
+#include <catch2/catch.hpp>
+#include <gimslib/io/Json.hpp>
+#include <stdexcept>
+#include <string>
+
+using namespace gims;
+
+TEST_CASE("JSON documents are parsed into values", "[io]")
+{
+  const JsonValue document =
+      JsonValue::parse(" {\"name\": \"box\", \"count\": 3, \"visible\": true, \"parent\": null, \"scale\": [1, 2.5]} ");
+  REQUIRE(document.isObject());
+  CHECK(document.getKeys() == std::vector<std::string> {"name", "count", "visible", "parent", "scale"});
+  CHECK(document["name"].getString() == "box");
+  CHECK(document["count"].getIndex() == 3);
+  CHECK(document["visible"].getBool());
+  CHECK(document["parent"].isNull());
+  REQUIRE(document["scale"].getElements().size() == 2);
+  CHECK(document["scale"][1].getNumber() == 2.5);
+  CHECK(document.find("missing") == nullptr);
+  CHECK(document.getIndex("missing", 7) == 7);
+  CHECK_THROWS_AS(document["missing"], std::runtime_error);
+  CHECK_THROWS_AS(document["scale"][2], std::runtime_error);
+  CHECK_THROWS_AS(document["name"].getNumber(), std::runtime_error);
+}
+
+TEST_CASE("JSON strings decode their escapes", "[io]")
+{
+  CHECK(JsonValue::parse(R"("\"\\\/\b\f\n\r\t")").getString() == "\"\\/\b\f\n\r\t");
+  // One, two, and three bytes in UTF-8.
+  CHECK(JsonValue::parse(R"("A\u00e9\u20AC")").getString() == "A\xc3\xa9\xe2\x82\xac");
+  // Characters beyond the basic multilingual plane keep their surrogates.
+  CHECK(JsonValue::parse(R"("\ud83d\ude00")").getString() == "\xed\xa0\xbd\xed\xb8\x80");
+  CHECK(JsonValue::parse("\"data:application/octet-stream;base64,AAAA\"").getString() ==
+        "data:application/octet-stream;base64,AAAA");
+}
+
+TEST_CASE("JSON numbers are parsed as doubles", "[io]")
+{
+  CHECK(JsonValue::parse("0").getNumber() == 0.0);
+  CHECK(JsonValue::parse("-12.5e2").getNumber() == -1250.0);
+  CHECK(JsonValue::parse("1E-3").getNumber() == Approx(0.001));
+  CHECK(JsonValue::parse("4294967295").getIndex() == 4294967295u);
+  CHECK(JsonValue::parse("9007199254740993").getNumber() == 9007199254740992.0);
+  CHECK_THROWS_AS(JsonValue::parse("4294967296").getIndex(), std::runtime_error);
+  CHECK_THROWS_AS(JsonValue::parse("-1").getIndex(), std::runtime_error);
+  CHECK_THROWS_AS(JsonValue::parse("1.5").getIndex(), std::runtime_error);
+  CHECK_THROWS_AS(JsonValue::parse("1e999"), std::runtime_error);
+}
+
+TEST_CASE("JSON parsing rejects truncated and malformed documents", "[io]")
+{
+  const char* documents[] = {"",
+                             "{",
+                             "{\"a\"",
+                             "{\"a\":",
+                             "{\"a\": [1, 2",
+                             "[1, 2,",
+                             "\"abc",
+                             "\"abc\\",
+                             "\"\\u12",
+                             "\"\\u12g4\"",
+                             "\"\\x\"",
+                             "tru",
+                             "nul",
+                             "-",
+                             "1 2",
+                             "{\"a\" 1}",
+                             "{1: 2}",
+                             "[1 2]"};
+  for (const char* document : documents)
+  {
+    INFO(document);
+    CHECK_THROWS_AS(JsonValue::parse(document), std::runtime_error);
+  }
+  // Nesting beyond the limit of the parser is rejected instead of overflowing the stack.
+  CHECK_THROWS_AS(JsonValue::parse(std::string(100000, '[')), std::runtime_error);
+  CHECK_NOTHROW(JsonValue::parse(std::string(100, '[') + std::string(100, ']')));
+}
+
+TEST_CASE("JSON errors report the offset", "[io]")
+{
+  try
+  {
+    JsonValue::parse("[1, 2, x]");
+    FAIL("The document was accepted.");
+  }
+  catch (const std::runtime_error& e)
+  {
+    CHECK(std::string(e.what()).find("offset 7") != std::string::npos);
+  }
+}
@@ -0,0 +1,48 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <fstream>
+#include <gimslib/io/MappedFile.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace gims;
+
+TEST_CASE("Mapped files show the content of the file", "[io]")
+{
+  TemporaryDirectory directory("gims-mapped-file-test");
+  const auto         path = directory.getPath() / "data.bin";
+  const std::string  text(10000, 'x');
+  {
+    std::ofstream stream(path, std::ios::binary);
+    stream << text;
+  }
+  MappedFile file(path);
+  REQUIRE(file.getSize() == text.size());
+  CHECK(std::memcmp(file.getData(), text.data(), text.size()) == 0);
+  // Ranges beyond the end of the file are clamped.
+  file.prefetch(5000, 100000);
+  file.prefetch(20000, 1);
+
+  MappedFile moved(std::move(file));
+  CHECK(moved.getSize() == text.size());
+  CHECK(file.getData() == nullptr);
+  CHECK(file.getSize() == 0);
+}
+
+TEST_CASE("Empty files are not mapped", "[io]")
+{
+  TemporaryDirectory directory("gims-mapped-file-test");
+  const auto         path = directory.getPath() / "empty.bin";
+  std::ofstream(path, std::ios::binary).close();
+  const MappedFile file(path);
+  CHECK(file.getData() == nullptr);
+  CHECK(file.getSize() == 0);
+}
+
+TEST_CASE("Mapping a missing file throws", "[io]")
+{
+  TemporaryDirectory directory("gims-mapped-file-test");
+  CHECK_THROWS_AS(MappedFile(directory.getPath() / "missing.bin"), std::runtime_error);
+}
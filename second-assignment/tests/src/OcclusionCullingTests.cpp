@@ -0,0 +1,132 @@
+#include "OcclusionCulling.hpp"
+#include <catch2/catch.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+// The camera is at the origin and looks along the positive z axis, at z = 5 the screen spans about +-5.8 by +-2.9.
+f32m4 getViewProjection()
+{
+  return glm::perspectiveFovLH_ZO<f32>(glm::radians(60.0f), 256.0f, 128.0f, 0.1f, 100.0f);
+}
+
+// A quad at z = 5 that covers the whole screen.
+Occluder createWall()
+{
+  Occluder wall;
+  wall.positions = {f32v3(-20.0f, -20.0f, 5.0f), f32v3(20.0f, -20.0f, 5.0f), f32v3(20.0f, 20.0f, 5.0f),
+                    f32v3(-20.0f, 20.0f, 5.0f)};
+  wall.indices   = {0, 1, 2, 0, 2, 3};
+  return wall;
+}
+
+bool isVisible(OcclusionCuller& culler, const OcclusionQuery& query)
+{
+  std::vector<ui8> visible;
+  culler.cull(getViewProjection(), {query}, visible);
+  return visible.at(0) != 0;
+}
+} // namespace
+
+TEST_CASE("OcclusionCuller hides a box behind a large occluder", "[scene]")
+{
+  OcclusionCuller culler;
+  culler.setOccluders({createWall()});
+  CHECK_FALSE(isVisible(culler, {f32v3(-1.0f, -1.0f, 8.0f), f32v3(1.0f, 1.0f, 9.0f)}));
+
+  // Without occluders, the same box is visible.
+  culler.setOccluders({});
+  CHECK(isVisible(culler, {f32v3(-1.0f, -1.0f, 8.0f), f32v3(1.0f, 1.0f, 9.0f)}));
+}
+
+TEST_CASE("OcclusionCuller keeps a box in front of the occluder", "[scene]")
+{
+  OcclusionCuller culler;
+  culler.setOccluders({createWall()});
+  CHECK(isVisible(culler, {f32v3(-1.0f, -1.0f, 2.0f), f32v3(1.0f, 1.0f, 3.0f)}));
+  // A box that reaches through the occluder is in front of it in part.
+  CHECK(isVisible(culler, {f32v3(-1.0f, -1.0f, 4.0f), f32v3(1.0f, 1.0f, 9.0f)}));
+}
+
+TEST_CASE("OcclusionCuller never rejects a box that crosses the near plane", "[scene]")
+{
+  OcclusionCuller culler;
+  culler.setOccluders({createWall()});
+  CHECK(isVisible(culler, {f32v3(-1.0f, -1.0f, -1.0f), f32v3(1.0f, 1.0f, 9.0f)}));
+  CHECK(isVisible(culler, {f32v3(-1.0f, -1.0f, 0.05f), f32v3(1.0f, 1.0f, 9.0f)}));
+}
+
+TEST_CASE("OcclusionCuller never rejects a box that is partly outside of the screen", "[scene]")
+{
+  OcclusionCuller culler;
+  culler.setOccluders({createWall()});
+  // At z = 8, the screen ends at x = 9.2 and y = 4.6.
+  CHECK(isVisible(culler, {f32v3(5.0f, -1.0f, 8.0f), f32v3(20.0f, 1.0f, 9.0f)}));
+  CHECK(isVisible(culler, {f32v3(-1.0f, -20.0f, 8.0f), f32v3(1.0f, 0.0f, 9.0f)}));
+  CHECK(isVisible(culler, {f32v3(-30.0f, -30.0f, 8.0f), f32v3(30.0f, 30.0f, 9.0f)}));
+  CHECK_FALSE(isVisible(culler, {f32v3(5.0f, -1.0f, 8.0f), f32v3(9.0f, 1.0f, 9.0f)}));
+}
+
+TEST_CASE("OcclusionCuller gives the same result with threads and without SSE2", "[scene]")
+{
+  std::mt19937                        generator(7);
+  std::uniform_real_distribution<f32> position(-6.0f, 6.0f);
+  std::uniform_real_distribution<f32> depth(2.0f, 20.0f);
+  std::uniform_real_distribution<f32> size(0.1f, 3.0f);
+
+  // Occluders with random triangles at random depths, so the bands see partly covered rows.
+  std::vector<Occluder> occluders(8);
+  for (auto& occluder : occluders)
+  {
+    for (ui32 i = 0; i < 30; i++)
+    {
+      occluder.positions.push_back(f32v3(position(generator), position(generator), depth(generator)));
+      occluder.indices.push_back(i);
+    }
+  }
+  std::vector<OcclusionQuery> queries;
+  for (ui32 i = 0; i < 2000; i++)
+  {
+    const f32v3 lower = f32v3(position(generator), position(generator), depth(generator));
+    queries.push_back({lower, lower + f32v3(size(generator), size(generator), size(generator))});
+  }
+
+  ThreadPool               threadPool(4);
+  OcclusionCullingSettings threadedSettings;
+  OcclusionCullingSettings scalarSettings;
+  threadedSettings.nBands = 7;
+  scalarSettings.useSimd  = false;
+  OcclusionCuller threaded(threadedSettings, &threadPool);
+  OcclusionCuller scalar(scalarSettings, nullptr);
+  threaded.setOccluders(occluders);
+  scalar.setOccluders(occluders);
+
+  std::vector<ui8> threadedVisible;
+  std::vector<ui8> scalarVisible;
+  const auto       threadedStatistics = threaded.cull(getViewProjection(), queries, threadedVisible);
+  const auto       scalarStatistics   = scalar.cull(getViewProjection(), queries, scalarVisible);
+  CHECK(threaded.getDepthBuffer() == scalar.getDepthBuffer());
+  CHECK(threadedVisible == scalarVisible);
+  CHECK(threadedStatistics.nOccluderTriangles == scalarStatistics.nOccluderTriangles);
+  // Both some hidden and some visible boxes, so the comparison means something.
+  CHECK(threadedStatistics.nOccluded > 0);
+  CHECK(threadedStatistics.nOccluded < queries.size());
+}
+
+TEST_CASE("evaluateOcclusionCulling summarizes the frames", "[scene]")
+{
+  OcclusionCuller culler;
+  culler.setOccluders({createWall()});
+  const std::vector<OcclusionQuery> queries = {{f32v3(-1.0f, -1.0f, 8.0f), f32v3(1.0f, 1.0f, 9.0f)},
+                                               {f32v3(-1.0f, -1.0f, 2.0f), f32v3(1.0f, 1.0f, 3.0f)}};
+  // The second frame looks backwards, where nothing is hidden.
+  const f32m4 backwards = getViewProjection() * glm::scale(f32m4(1.0f), f32v3(-1.0f, 1.0f, -1.0f));
+  const OcclusionCullingReport report = evaluateOcclusionCulling(culler, {getViewProjection(), backwards}, queries);
+  CHECK(report.nFrames == 2);
+  CHECK(report.rejectedFraction == Approx(0.25));
+  CHECK(report.maxMillisecondsPerFrame >= report.averageMillisecondsPerFrame);
+}
@@ -0,0 +1,216 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <fstream>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/sys/Hash.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+// Offsets in the header and in an entry of the table of contents, as PackageWriter writes them.
+const size_t headerVersionOffset   = 8;
+const size_t headerTocOffsetOffset = 16;
+const size_t headerTocSizeOffset   = 24;
+const size_t tocEntrySizeOffset    = 8;
+const size_t tocEntryNameOffset    = 32;
+
+std::vector<ui8> createPayload(size_t size, ui8 seed)
+{
+  std::vector<ui8> result(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    result[i] = static_cast<ui8>(seed + i * 7);
+  }
+  return result;
+}
+
+void writePackage(const std::filesystem::path& path, const std::vector<std::vector<ui8>>& payloads)
+{
+  PackageWriter writer(path);
+  writer.add("mesh/0", PackageEntryType::Mesh, payloads[0].data(), payloads[0].size());
+  writer.add("texture/0", PackageEntryType::Texture, payloads[1].data(), payloads[1].size());
+  writer.add("materials", PackageEntryType::Materials, payloads[2].data(), payloads[2].size());
+  writer.finish();
+}
+
+// Payloads of different sizes, the first one larger than a page.
+std::vector<std::vector<ui8>> createPayloads()
+{
+  return {createPayload(5000, 1), createPayload(1, 2), createPayload(4096, 3)};
+}
+
+std::vector<ui8> readBytes(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  return std::vector<ui8>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::filesystem::path& path, const std::vector<ui8>& bytes)
+{
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+ui64 readUi64(const std::vector<ui8>& bytes, size_t offset)
+{
+  ui64 value = 0;
+  std::memcpy(&value, bytes.data() + offset, sizeof(value));
+  return value;
+}
+
+void writeUi32(std::vector<ui8>& bytes, size_t offset, ui32 value)
+{
+  std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+void writeUi64(std::vector<ui8>& bytes, size_t offset, ui64 value)
+{
+  std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+} // namespace
+
+TEST_CASE("Packages keep the payloads, names, and types of their entries", "[io]")
+{
+  TemporaryDirectory directory("gims-package-test");
+  const auto         path     = directory.getPath() / "scene.gpak";
+  const auto         payloads = createPayloads();
+  writePackage(path, payloads);
+
+  const PackageFile package(path);
+  REQUIRE(package.getEntries().size() == 3);
+  const char*            names[] = {"mesh/0", "texture/0", "materials"};
+  const PackageEntryType types[] = {PackageEntryType::Mesh, PackageEntryType::Texture, PackageEntryType::Materials};
+  for (ui32 entryIdx = 0; entryIdx < 3; entryIdx++)
+  {
+    const PackageEntry& entry = package.getEntries()[entryIdx];
+    CHECK(package.find(names[entryIdx]) == entryIdx);
+    CHECK(entry.name == names[entryIdx]);
+    CHECK(entry.type == types[entryIdx]);
+    CHECK(entry.size == payloads[entryIdx].size());
+    CHECK(entry.offset % packageAlignment == 0);
+    CHECK(entry.hash == hashBytes(payloads[entryIdx].data(), payloads[entryIdx].size()));
+    CHECK(std::memcmp(package.getData(entryIdx), payloads[entryIdx].data(), payloads[entryIdx].size()) == 0);
+    CHECK(package.verify(entryIdx));
+    if (entryIdx > 0)
+    {
+      const PackageEntry& previous = package.getEntries()[entryIdx - 1];
+      CHECK(entry.offset >= previous.offset + previous.size);
+    }
+  }
+  // The constant is copied, since it has no definition to bind a reference to.
+  const ui32 invalidIdx = PackageFile::invalidIdx;
+  CHECK(package.find("texture/1") == invalidIdx);
+  CHECK_THROWS_AS(package.getData(3), std::out_of_range);
+  CHECK(isPackageFile(path));
+  CHECK_FALSE(isPackageFile(directory.getPath() / "scene.gltf"));
+}
+
+TEST_CASE("Package verification detects changed payloads", "[io]")
+{
+  TemporaryDirectory directory("gims-package-test");
+  const auto         path = directory.getPath() / "scene.gpak";
+  writePackage(path, createPayloads());
+  auto bytes = readBytes(path);
+  {
+    const PackageFile package(path);
+    bytes[package.getEntries()[2].offset + 100] ^= 1;
+  }
+  writeBytes(path, bytes);
+
+  const PackageFile package(path);
+  CHECK(package.verify(0));
+  CHECK(package.verify(1));
+  CHECK_FALSE(package.verify(2));
+}
+
+TEST_CASE("Package writers reject duplicate names and entries after finish", "[io]")
+{
+  TemporaryDirectory directory("gims-package-test");
+  const ui8          byte = 1;
+  PackageWriter      writer(directory.getPath() / "scene.gpak");
+  writer.add("a", PackageEntryType::Blob, &byte, 1);
+  CHECK_THROWS_AS(writer.add("a", PackageEntryType::Blob, &byte, 1), std::invalid_argument);
+  CHECK_THROWS_AS(writer.add("", PackageEntryType::Blob, &byte, 1), std::invalid_argument);
+  writer.finish();
+  CHECK_THROWS_AS(writer.add("b", PackageEntryType::Blob, &byte, 1), std::logic_error);
+}
+
+TEST_CASE("Corrupt packages are rejected", "[io]")
+{
+  TemporaryDirectory directory("gims-package-test");
+  const auto         path = directory.getPath() / "scene.gpak";
+  writePackage(path, createPayloads());
+  const auto original  = readBytes(path);
+  const ui64 tocOffset = readUi64(original, headerTocOffsetOffset);
+
+  SECTION("Bad magic")
+  {
+    auto bytes = original;
+    bytes[0]   = 'X';
+    writeBytes(path, bytes);
+  }
+  SECTION("Wrong version")
+  {
+    auto bytes = original;
+    writeUi32(bytes, headerVersionOffset, 1);
+    writeBytes(path, bytes);
+  }
+  SECTION("Header only")
+  {
+    writeBytes(path, std::vector<ui8>(original.begin(), original.begin() + 16));
+  }
+  SECTION("Table of contents beyond the end of the file")
+  {
+    auto bytes = original;
+    writeUi64(bytes, headerTocOffsetOffset, bytes.size() - 8);
+    writeBytes(path, bytes);
+  }
+  SECTION("Table of contents larger than the file")
+  {
+    auto bytes = original;
+    writeUi64(bytes, headerTocSizeOffset, ~0ull - 16);
+    writeBytes(path, bytes);
+  }
+  SECTION("Truncated table of contents")
+  {
+    writeBytes(path, std::vector<ui8>(original.begin(), original.end() - 8));
+  }
+  SECTION("Entry that overlaps the table of contents")
+  {
+    auto       bytes  = original;
+    const ui64 offset = readUi64(bytes, tocOffset);
+    writeUi64(bytes, tocOffset + tocEntrySizeOffset, tocOffset - offset + 1);
+    writeBytes(path, bytes);
+    CHECK_THROWS_WITH(PackageFile(path), Catch::Contains("exceeds the payloads"));
+  }
+  SECTION("Entry that is not aligned")
+  {
+    auto bytes = original;
+    writeUi64(bytes, tocOffset, readUi64(bytes, tocOffset) + 1);
+    writeBytes(path, bytes);
+  }
+  CHECK_THROWS_AS(PackageFile(path), std::runtime_error);
+}
+
+TEST_CASE("Packages with duplicate names are rejected", "[io]")
+{
+  TemporaryDirectory directory("gims-package-test");
+  const auto         path = directory.getPath() / "scene.gpak";
+  const ui8          byte = 1;
+  PackageWriter      writer(path);
+  writer.add("a", PackageEntryType::Blob, &byte, 1);
+  writer.add("b", PackageEntryType::Blob, &byte, 1);
+  writer.finish();
+
+  // The name of the first entry is padded to 8 bytes, the second entry follows it.
+  auto       bytes     = readBytes(path);
+  const ui64 tocOffset = readUi64(bytes, headerTocOffsetOffset);
+  bytes[tocOffset + tocEntryNameOffset + 8 + tocEntryNameOffset] = 'a';
+  writeBytes(path, bytes);
+  CHECK_THROWS_WITH(PackageFile(path), Catch::Contains("twice"));
+}
@@ -0,0 +1,122 @@
+#include <catch2/catch.hpp>
+#include <gimslib/sys/QueueScheduler.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+// Scene preparation, culling on the compute queue, drawing with the culled lists, an independent compute job, and
+// composition that needs both compute jobs.
+const std::vector<QueueJob> frameJobs = {{QueueType::Graphics, {}},
+                                         {QueueType::Compute, {}},
+                                         {QueueType::Graphics, {1}},
+                                         {QueueType::Compute, {}},
+                                         {QueueType::Graphics, {1, 3}}};
+const std::vector<f64>      frameJobDurations = {2.0, 3.0, 4.0, 5.0, 1.0};
+
+void checkWaits(const QueueSubmission& submission, const std::vector<QueueWait>& expectedWaits)
+{
+  REQUIRE(submission.waits.size() == expectedWaits.size());
+  for (size_t i = 0; i < expectedWaits.size(); i++)
+  {
+    CHECK(submission.waits[i].queue == expectedWaits[i].queue);
+    CHECK(submission.waits[i].fenceValue == expectedWaits[i].fenceValue);
+  }
+}
+} // namespace
+
+using namespace gims;
+
+TEST_CASE("QueueScheduler only synchronizes dependencies across queues", "[sys]")
+{
+  QueueScheduler scheduler;
+  const auto     submissions = scheduler.schedule(frameJobs);
+  REQUIRE(submissions.size() == frameJobs.size());
+  for (ui32 jobIdx = 0; jobIdx < frameJobs.size(); jobIdx++)
+  {
+    CHECK(submissions[jobIdx].jobIdx == jobIdx);
+    CHECK(submissions[jobIdx].queue == frameJobs[jobIdx].queue);
+  }
+
+  checkWaits(submissions[0], {});
+  checkWaits(submissions[1], {});
+  checkWaits(submissions[2], {{QueueType::Compute, 1}});
+  checkWaits(submissions[3], {});
+  checkWaits(submissions[4], {{QueueType::Compute, 2}});
+  // Only jobs that are waited for and the last job of each queue signal.
+  CHECK(submissions[0].signalValue == 0);
+  CHECK(submissions[1].signalValue == 1);
+  CHECK(submissions[2].signalValue == 0);
+  CHECK(submissions[3].signalValue == 2);
+  CHECK(submissions[4].signalValue == 1);
+  CHECK(scheduler.getLastSignaledValue(QueueType::Graphics) == 1);
+  CHECK(scheduler.getLastSignaledValue(QueueType::Compute) == 2);
+}
+
+TEST_CASE("QueueScheduler omits dependencies on the same queue and waits that are covered", "[sys]")
+{
+  QueueScheduler scheduler;
+  const auto     submissions = scheduler.schedule({{QueueType::Compute, {}},
+                                                   {QueueType::Graphics, {0}},
+                                                   {QueueType::Graphics, {0, 1}},
+                                                   {QueueType::Compute, {0}}});
+  checkWaits(submissions[1], {{QueueType::Compute, 1}});
+  checkWaits(submissions[2], {});
+  checkWaits(submissions[3], {});
+}
+
+TEST_CASE("QueueScheduler lets the first jobs of a frame wait for the previous frame", "[sys]")
+{
+  QueueScheduler scheduler;
+  scheduler.schedule(frameJobs);
+  const auto submissions = scheduler.schedule(frameJobs);
+  // The graphics queue already waited for all compute work of the first frame.
+  checkWaits(submissions[0], {});
+  checkWaits(submissions[1], {{QueueType::Graphics, 1}});
+  checkWaits(submissions[2], {{QueueType::Compute, 3}});
+  checkWaits(submissions[4], {{QueueType::Compute, 4}});
+
+  const ui64 reservedValue = scheduler.reserveSignalValue(QueueType::Graphics);
+  CHECK(reservedValue == 3);
+  CHECK(scheduler.getLastSignaledValue(QueueType::Graphics) == reservedValue);
+  checkWaits(scheduler.schedule({{QueueType::Compute, {}}})[0], {{QueueType::Graphics, reservedValue}});
+}
+
+TEST_CASE("QueueScheduler rejects dependencies on the job itself or later jobs", "[sys]")
+{
+  QueueScheduler scheduler;
+  CHECK_THROWS_AS(scheduler.schedule({{QueueType::Graphics, {0}}}), std::invalid_argument);
+  CHECK_THROWS_AS(scheduler.schedule({{QueueType::Graphics, {1}}, {QueueType::Compute, {}}}), std::invalid_argument);
+}
+
+TEST_CASE("QueueTimelineSimulator overlaps the queues as far as the fences allow", "[sys]")
+{
+  QueueScheduler         scheduler;
+  QueueTimelineSimulator simulator;
+  const auto             timings = simulator.simulate(scheduler.schedule(frameJobs), frameJobDurations);
+
+  const std::vector<std::pair<f64, f64>> expectedTimings = {{0.0, 2.0}, {0.0, 3.0}, {3.0, 7.0}, {3.0, 8.0}, {8.0, 9.0}};
+  REQUIRE(timings.size() == expectedTimings.size());
+  for (size_t i = 0; i < timings.size(); i++)
+  {
+    CHECK(timings[i].start == expectedTimings[i].first);
+    CHECK(timings[i].end == expectedTimings[i].second);
+  }
+  CHECK(simulator.getQueueTime(QueueType::Graphics) == 9.0);
+  CHECK(simulator.getQueueTime(QueueType::Compute) == 8.0);
+
+  // The next frame starts on both queues when the previous one has finished.
+  const auto nextTimings = simulator.simulate(scheduler.schedule(frameJobs), frameJobDurations);
+  CHECK(nextTimings[0].start == 9.0);
+  CHECK(nextTimings[1].start == 9.0);
+  CHECK(simulator.getQueueTime(QueueType::Graphics) == 18.0);
+}
+
+TEST_CASE("QueueTimelineSimulator rejects waits for values that are never signaled", "[sys]")
+{
+  QueueTimelineSimulator simulator;
+  QueueSubmission        submission = {0, QueueType::Graphics, {{QueueType::Compute, 1}}, 0};
+  CHECK_THROWS_AS(simulator.simulate({submission}, {1.0}), std::logic_error);
+}
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <filesystem>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/sw/RayCasting.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+struct Mesh
+{
+  std::vector<f32v3> positions;
+  std::vector<ui32>  indices;
+
+  TriangleBvhGeometry getGeometry() const
+  {
+    return {positions.data(), static_cast<ui32>(positions.size()), sizeof(f32v3), indices.data(),
+            static_cast<ui32>(indices.size() / 3)};
+  }
+};
+
+Mesh loadBunny()
+{
+  const CograBinaryMeshFile bunny((std::filesystem::path(GIMS_TEST_DATA_DIRECTORY) / "bunny.cbm").string());
+  const auto*               positions = reinterpret_cast<const f32v3*>(bunny.getPositionsPtr());
+  const ui32*               indices   = bunny.getTriangleIndices();
+  return {std::vector<f32v3>(positions, positions + bunny.getNumVertices()),
+          std::vector<ui32>(indices, indices + bunny.getNumTriangles() * 3)};
+}
+
+Mesh createTriangle()
+{
+  return {{f32v3(-1.0f, -1.0f, 0.0f), f32v3(1.0f, -1.0f, 0.0f), f32v3(0.0f, 1.0f, 0.0f)}, {0, 1, 2}};
+}
+
+// Tests the ray against every triangle, in double precision.
+RayHit intersectAll(const Mesh& mesh, const Ray& ray)
+{
+  RayHit           result;
+  const glm::dvec3 origin(ray.origin);
+  const glm::dvec3 direction(ray.direction);
+  for (ui32 triangleIdx = 0; triangleIdx < mesh.indices.size() / 3; triangleIdx++)
+  {
+    const glm::dvec3 v0(mesh.positions[mesh.indices[triangleIdx * 3 + 0]]);
+    const glm::dvec3 edge1 = glm::dvec3(mesh.positions[mesh.indices[triangleIdx * 3 + 1]]) - v0;
+    const glm::dvec3 edge2 = glm::dvec3(mesh.positions[mesh.indices[triangleIdx * 3 + 2]]) - v0;
+    const glm::dvec3 p     = glm::cross(direction, edge2);
+    const f64        det   = glm::dot(edge1, p);
+    if (det == 0.0)
+    {
+      continue;
+    }
+    const glm::dvec3 s = origin - v0;
+    const glm::dvec3 q = glm::cross(s, edge1);
+    const f64        u = glm::dot(s, p) / det;
+    const f64        v = glm::dot(direction, q) / det;
+    const f64        t = glm::dot(edge2, q) / det;
+    if (u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= ray.tMin && t < ray.tMax && t < result.t)
+    {
+      result.t            = static_cast<f32>(t);
+      result.triangleIdx  = triangleIdx;
+      result.barycentrics = f32v2(static_cast<f32>(u), static_cast<f32>(v));
+    }
+  }
+  return result;
+}
+
+// Rays from a sphere around the bounds towards random points inside them, so most of them hit.
+std::vector<Ray> createRays(const BvhBounds& bounds, ui32 nRays)
+{
+  std::mt19937                        random(7);
+  std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+  const f32v3                         center = (bounds.lowerLeftBottom + bounds.upperRightTop) * 0.5f;
+  const f32                           radius = glm::length(bounds.upperRightTop - bounds.lowerLeftBottom);
+  std::vector<Ray>                    result;
+  for (ui32 i = 0; i < nRays; i++)
+  {
+    const f32   z      = unit(random) * 2.0f - 1.0f;
+    const f32   phi    = unit(random) * 6.2831853f;
+    const f32   r      = std::sqrt(1.0f - z * z);
+    const f32v3 origin = center + radius * f32v3(r * std::cos(phi), r * std::sin(phi), z);
+    const f32v3 extent = bounds.upperRightTop - bounds.lowerLeftBottom;
+    const f32v3 target = bounds.lowerLeftBottom + f32v3(unit(random), unit(random), unit(random)) * extent;
+    result.push_back({origin, target - origin});
+  }
+  return result;
+}
+} // namespace
+
+using namespace gims;
+
+TEST_CASE("TriangleBvh finds the same closest hits as testing every triangle", "[sw]")
+{
+  const Mesh        bunny = loadBunny();
+  ThreadPool        threadPool(4);
+  const TriangleBvh bvh(bunny.getGeometry(), &threadPool);
+  CHECK(bvh.getNumberOfTriangles() == bunny.indices.size() / 3);
+  CHECK(bvh.getSahCost() > 0.0f);
+
+  const BvhBounds bounds = bvh.getBounds();
+  for (const f32v3& position : bunny.positions)
+  {
+    for (ui32 axis = 0; axis < 3; axis++)
+    {
+      REQUIRE(position[axis] >= bounds.lowerLeftBottom[axis]);
+      REQUIRE(position[axis] <= bounds.upperRightTop[axis]);
+    }
+  }
+
+  // The constant is copied, since it has no definition to bind a reference to.
+  const ui32 invalidIdx = RayHit::invalidIdx;
+  ui32       nHits      = 0;
+  for (const Ray& ray : createRays(bounds, 500))
+  {
+    RayHit       hit;
+    const bool   isHit    = bvh.intersect(ray, hit);
+    const RayHit expected = intersectAll(bunny, ray);
+    REQUIRE(isHit == expected.isHit());
+    REQUIRE(bvh.isOccluded(ray) == expected.isHit());
+    if (isHit)
+    {
+      nHits++;
+      CHECK(hit.t == Approx(expected.t).epsilon(1.0e-4));
+      // Triangles that share the hit point may be reported either way.
+      if (hit.triangleIdx == expected.triangleIdx)
+      {
+        CHECK(hit.barycentrics.x == Approx(expected.barycentrics.x).margin(1.0e-4));
+        CHECK(hit.barycentrics.y == Approx(expected.barycentrics.y).margin(1.0e-4));
+      }
+      CHECK(hit.instanceIdx == invalidIdx);
+    }
+  }
+  CHECK(nHits > 100);
+}
+
+TEST_CASE("TriangleBvh builds the same hierarchy with and without threads", "[sw]")
+{
+  const Mesh        bunny = loadBunny();
+  ThreadPool        threadPool(4);
+  const TriangleBvh parallelBvh(bunny.getGeometry(), &threadPool);
+  const TriangleBvh serialBvh(bunny.getGeometry());
+  const auto&       parallelNodes = parallelBvh.getNodes();
+  const auto&       serialNodes   = serialBvh.getNodes();
+  REQUIRE(parallelNodes.size() == serialNodes.size());
+  for (size_t i = 0; i < serialNodes.size(); i++)
+  {
+    REQUIRE(parallelNodes[i].offset == serialNodes[i].offset);
+    REQUIRE(parallelNodes[i].count == serialNodes[i].count);
+  }
+}
+
+TEST_CASE("TriangleBvh only reports hits inside the parameter range of the ray", "[sw]")
+{
+  const Mesh        triangle = createTriangle();
+  const TriangleBvh bvh(triangle.getGeometry());
+
+  // The hit is at t = 2, since the direction is not normalized.
+  RayHit hit;
+  CHECK(bvh.intersect({f32v3(0.0f, 0.0f, -4.0f), f32v3(0.0f, 0.0f, 2.0f)}, hit));
+  CHECK(hit.t == Approx(2.0f));
+  CHECK(hit.triangleIdx == 0);
+  CHECK(hit.barycentrics.x == Approx(0.25f));
+  CHECK(hit.barycentrics.y == Approx(0.5f));
+
+  CHECK_FALSE(bvh.isOccluded({f32v3(0.0f, 0.0f, -4.0f), f32v3(0.0f, 0.0f, 2.0f), 0.0f, 2.0f}));
+  CHECK_FALSE(bvh.isOccluded({f32v3(0.0f, 0.0f, -4.0f), f32v3(0.0f, 0.0f, 2.0f), 2.5f}));
+  CHECK_FALSE(bvh.isOccluded({f32v3(2.0f, 0.0f, -4.0f), f32v3(0.0f, 0.0f, 1.0f)}));
+  // A closer hit is kept.
+  hit.t = 1.0f;
+  CHECK_FALSE(bvh.intersect({f32v3(0.0f, 0.0f, -4.0f), f32v3(0.0f, 0.0f, 2.0f)}, hit));
+
+  RayHit emptyHit;
+  CHECK_FALSE(TriangleBvh().intersect({f32v3(0.0f), f32v3(0.0f, 0.0f, 1.0f)}, emptyHit));
+  CHECK_FALSE(emptyHit.isHit());
+}
+
+TEST_CASE("TriangleBvh rejects indices out of range", "[sw]")
+{
+  Mesh triangle       = createTriangle();
+  triangle.indices[2] = 3;
+  CHECK_THROWS_AS(TriangleBvh(triangle.getGeometry()), std::invalid_argument);
+}
+
+TEST_CASE("RayCastingScene finds the closest instance in the space of the scene", "[sw]")
+{
+  const Mesh                      triangle = createTriangle();
+  ThreadPool                      threadPool(2);
+  RayCastingScene                 scene(createTriangleBvhs({triangle.getGeometry()}, threadPool));
+  std::vector<RayCastingInstance> instances;
+  for (ui32 i = 0; i < 10; i++)
+  {
+    // Instances along z, the three closest ones half as large as the others.
+    const f32m4 translation = glm::translate(f32m4(1.0f), f32v3(0.0f, 0.0f, 10.0f - static_cast<f32>(i)));
+    instances.push_back({0, glm::scale(translation, f32v3(i >= 7 ? 0.5f : 1.0f))});
+  }
+  scene.setInstances(instances);
+  CHECK(scene.getNumberOfMeshes() == 1);
+  CHECK(scene.getNumberOfInstances() == 10);
+
+  RayHit hit;
+  REQUIRE(scene.intersect({f32v3(0.0f, 0.0f, -1.0f), f32v3(0.0f, 0.0f, 1.0f)}, hit));
+  CHECK(hit.instanceIdx == 9);
+  CHECK(hit.t == Approx(2.0f));
+  CHECK(hit.triangleIdx == 0);
+
+  // Misses the instances that are scaled down.
+  hit = RayHit();
+  REQUIRE(scene.intersect({f32v3(0.0f, -0.9f, -1.0f), f32v3(0.0f, 0.0f, 1.0f)}, hit));
+  CHECK(hit.instanceIdx == 6);
+  CHECK(hit.t == Approx(5.0f));
+
+  CHECK(scene.isOccluded({f32v3(0.0f, 0.0f, -1.0f), f32v3(0.0f, 0.0f, 1.0f)}));
+  CHECK_FALSE(scene.isOccluded({f32v3(0.0f, 0.0f, -1.0f), f32v3(0.0f, 0.0f, 1.0f), 0.0f, 1.5f}));
+  CHECK_FALSE(scene.isOccluded({f32v3(5.0f, 0.0f, -1.0f), f32v3(0.0f, 0.0f, 1.0f)}));
+
+  CHECK_THROWS_AS(scene.setInstances({{1, f32m4(1.0f)}}), std::out_of_range);
+}
+
+TEST_CASE("createCameraRay goes from the near to the far plane", "[sw]")
+{
+  const f32m4 projection = glm::perspectiveFovLH_ZO(glm::radians(60.0f), 4.0f, 3.0f, 0.5f, 100.0f);
+  const Ray   ray        = createCameraRay(glm::inverse(projection), f32v2(0.0f));
+  CHECK(ray.tMin == 0.0f);
+  CHECK(ray.tMax == 1.0f);
+  CHECK(ray.origin.z == Approx(0.5f));
+  CHECK(ray.origin.x == Approx(0.0f).margin(1.0e-5));
+  CHECK((ray.origin + ray.direction).z == Approx(100.0f).epsilon(1.0e-4));
+
+  // The corner of the screen is on the border of the view frustum.
+  const Ray   cornerRay = createCameraRay(glm::inverse(projection), f32v2(1.0f, 1.0f));
+  const f32v4 clip      = projection * f32v4(cornerRay.origin + cornerRay.direction * 0.5f, 1.0f);
+  CHECK(clip.x / clip.w == Approx(1.0f));
+  CHECK(clip.y / clip.w == Approx(1.0f));
+}
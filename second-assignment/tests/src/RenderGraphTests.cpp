@@ -0,0 +1,175 @@
+#include <catch2/catch.hpp>
+#include <gimslib/sys/RenderGraph.hpp>
+#include <stdexcept>
+
+using namespace gims;
+
+namespace
+{
+// The bits of the D3D12_RESOURCE_STATES the tests use.
+const ResourceStates present                = 0x0;
+const ResourceStates renderTarget           = 0x4;
+const ResourceStates nonPixelShaderResource = 0x40;
+const ResourceStates pixelShaderResource    = 0x80;
+
+bool isTransition(const RenderGraphBarrier& barrier, ui32 resourceIdx, ResourceStates before, ResourceStates after)
+{
+  return barrier.type == RenderGraphBarrier::Type::Transition && barrier.resourceIdx == resourceIdx &&
+         barrier.stateBefore == before && barrier.stateAfter == after;
+}
+} // namespace
+
+TEST_CASE("RenderGraph culls passes whose results are never used", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  backBuffer = graph.importResource("Back Buffer", present, present);
+  const ui32  unused     = graph.createTransientResource("Unused", {1024, 256});
+  const ui32  shadowMap  = graph.createTransientResource("Shadow Map", {1024, 256});
+
+  const ui32 unusedPass  = graph.addPass("Unused", {}, {{unused, renderTarget}});
+  const ui32 shadowPass  = graph.addPass("Shadows", {}, {{shadowMap, renderTarget}});
+  const ui32 sideEffect  = graph.addPass("Readback", {}, {}, true);
+  const ui32 overwritten = graph.addPass("Overwritten", {}, {{backBuffer, renderTarget}});
+  const ui32 drawPass    = graph.addPass("Draw", {{shadowMap, pixelShaderResource}}, {{backBuffer, renderTarget}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  CHECK(compiled.passCulled[unusedPass]);
+  CHECK_FALSE(compiled.passCulled[shadowPass]);
+  CHECK_FALSE(compiled.passCulled[sideEffect]);
+  // Draw does not read the back buffer, so it does not depend on what the pass before wrote.
+  CHECK(compiled.passCulled[overwritten]);
+  CHECK_FALSE(compiled.passCulled[drawPass]);
+
+  REQUIRE(compiled.steps.size() == 4);
+  CHECK(compiled.steps[0].passIdx == shadowPass);
+  CHECK(compiled.steps[1].passIdx == sideEffect);
+  CHECK(compiled.steps[2].passIdx == drawPass);
+  CHECK(compiled.steps[3].passIdx == renderGraphInvalidIdx);
+  CHECK(compiled.heapOffsets[unused] == ~0ull);
+}
+
+TEST_CASE("RenderGraph transitions imported resources and restores their final states", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  backBuffer = graph.importResource("Back Buffer", present, present);
+  const ui32  drawPass   = graph.addPass("Draw", {}, {{backBuffer, renderTarget}});
+  const ui32  uiPass     = graph.addPass("UI", {{backBuffer, renderTarget}}, {{backBuffer, renderTarget}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  REQUIRE(compiled.steps.size() == 3);
+  CHECK(compiled.steps[0].passIdx == drawPass);
+  REQUIRE(compiled.steps[0].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[0].barriers[0], backBuffer, present, renderTarget));
+  // Already in the state the UI needs.
+  CHECK(compiled.steps[1].passIdx == uiPass);
+  CHECK(compiled.steps[1].barriers.empty());
+  REQUIRE(compiled.steps[2].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[2].barriers[0], backBuffer, renderTarget, present));
+  CHECK(compiled.nBarriers == 2);
+}
+
+TEST_CASE("RenderGraph batches consecutive reads into one transition", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  texture    = graph.importResource("Texture", renderTarget, pixelShaderResource);
+  const ui32  backBuffer = graph.importResource("Back Buffer", renderTarget, renderTarget);
+  graph.addPass("Pixel Shader", {{texture, pixelShaderResource}}, {{backBuffer, renderTarget}});
+  graph.addPass("Compute Shader", {{texture, nonPixelShaderResource}, {backBuffer, renderTarget}},
+                {{backBuffer, renderTarget}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  REQUIRE(compiled.steps.size() == 3);
+  REQUIRE(compiled.steps[0].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[0].barriers[0], texture, renderTarget,
+                     pixelShaderResource | nonPixelShaderResource));
+  CHECK(compiled.steps[1].barriers.empty());
+  REQUIRE(compiled.steps[2].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[2].barriers[0], texture, pixelShaderResource | nonPixelShaderResource,
+                     pixelShaderResource));
+}
+
+TEST_CASE("RenderGraph separates consecutive unordered access writes with UAV barriers", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  buffer = graph.importResource("Buffer", resourceStateUnorderedAccess, resourceStateUnorderedAccess);
+  graph.addPass("First", {}, {{buffer, resourceStateUnorderedAccess}});
+  graph.addPass("Second", {{buffer, resourceStateUnorderedAccess}}, {{buffer, resourceStateUnorderedAccess}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  REQUIRE(compiled.steps.size() == 3);
+  REQUIRE(compiled.steps[1].barriers.size() == 1);
+  CHECK(compiled.steps[1].barriers[0].type == RenderGraphBarrier::Type::UnorderedAccess);
+  CHECK(compiled.steps[1].barriers[0].resourceIdx == buffer);
+  CHECK(compiled.steps[2].barriers.empty());
+}
+
+TEST_CASE("RenderGraph aliases transient resources with disjoint lifetimes", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  backBuffer = graph.importResource("Back Buffer", present, present);
+  const ui32  first      = graph.createTransientResource("First", {1024, 256});
+  const ui32  second     = graph.createTransientResource("Second", {1024, 256});
+  graph.addPass("Write First", {}, {{first, renderTarget}});
+  graph.addPass("Read First", {{first, pixelShaderResource}}, {{backBuffer, renderTarget}});
+  graph.addPass("Write Second", {}, {{second, renderTarget}});
+  graph.addPass("Read Second", {{second, pixelShaderResource}, {backBuffer, renderTarget}},
+                {{backBuffer, renderTarget}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  CHECK(compiled.heapOffsets[first] == 0);
+  CHECK(compiled.heapOffsets[second] == 0);
+  CHECK(compiled.heapSize == 1024);
+  CHECK(compiled.transientSize == 2048);
+  CHECK(compiled.initialStates[first] == renderTarget);
+  CHECK(compiled.initialStates[second] == renderTarget);
+
+  REQUIRE(compiled.steps.size() == 5);
+  CHECK(compiled.steps[0].activated == std::vector<ui32> {first});
+  CHECK(compiled.steps[0].barriers.empty());
+  REQUIRE(compiled.steps[1].barriers.size() == 2);
+  CHECK(isTransition(compiled.steps[1].barriers[0], first, renderTarget, pixelShaderResource));
+  CHECK(isTransition(compiled.steps[1].barriers[1], backBuffer, present, renderTarget));
+  // The second resource takes over the memory of the first one before it is written.
+  CHECK(compiled.steps[2].activated == std::vector<ui32> {second});
+  REQUIRE(compiled.steps[2].barriers.size() == 1);
+  CHECK(compiled.steps[2].barriers[0].type == RenderGraphBarrier::Type::Aliasing);
+  CHECK(compiled.steps[2].barriers[0].resourceIdx == second);
+  CHECK(compiled.steps[2].barriers[0].resourceBeforeIdx == first);
+  REQUIRE(compiled.steps[3].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[3].barriers[0], second, renderTarget, pixelShaderResource));
+  REQUIRE(compiled.steps[4].barriers.size() == 1);
+  CHECK(isTransition(compiled.steps[4].barriers[0], backBuffer, renderTarget, present));
+  CHECK(compiled.nBarriers == 5);
+}
+
+TEST_CASE("RenderGraph places transient resources with overlapping lifetimes apart and aligned", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  backBuffer = graph.importResource("Back Buffer", present, present);
+  const ui32  small      = graph.createTransientResource("Small", {1000, 65536});
+  const ui32  large      = graph.createTransientResource("Large", {4096, 65536});
+  graph.addPass("Write", {}, {{small, renderTarget}, {large, renderTarget}});
+  graph.addPass("Read", {{small, pixelShaderResource}, {large, pixelShaderResource}}, {{backBuffer, renderTarget}});
+
+  const CompiledRenderGraph compiled = graph.compile();
+  // Largest first, so the large resource is at the start of the heap.
+  CHECK(compiled.heapOffsets[large] == 0);
+  CHECK(compiled.heapOffsets[small] == 65536);
+  CHECK(compiled.heapSize == 65536 + 1000);
+  CHECK(compiled.transientSize == 2 * 65536);
+  REQUIRE(compiled.steps.size() == 3);
+  for (const auto& barrier : compiled.steps[0].barriers)
+  {
+    CHECK(barrier.type != RenderGraphBarrier::Type::Aliasing);
+  }
+}
+
+TEST_CASE("RenderGraph rejects unknown resources and conflicting states", "[sys]")
+{
+  RenderGraph graph;
+  const ui32  texture = graph.importResource("Texture", present, present);
+  CHECK_THROWS_AS(graph.addPass("Unknown", {{texture + 1, renderTarget}}, {}), std::invalid_argument);
+  CHECK_THROWS_AS(graph.addPass("Conflict", {{texture, pixelShaderResource}}, {{texture, renderTarget}}),
+                  std::invalid_argument);
+  CHECK(graph.getNumberOfPasses() == 0);
+}
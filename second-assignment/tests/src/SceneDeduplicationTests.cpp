@@ -0,0 +1,115 @@
+#include "TemporaryDirectory.hpp"
+#include <SceneDeduplication.hpp>
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace gims;
+
+namespace
+{
+void writeFile(const std::filesystem::path& file, const std::string& content)
+{
+  std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+  stream << content;
+}
+
+const ui8* getBytes(const std::string& str)
+{
+  return reinterpret_cast<const ui8*>(str.data());
+}
+} // namespace
+
+TEST_CASE("createDeduplicationRemap keeps the first of equal items", "[scene]")
+{
+  // All keys collide, so only isEqual tells the items apart.
+  const std::vector<int>   values = {5, 7, 5, 9, 7, 5};
+  const DeduplicationRemap remap  = createDeduplicationRemap(std::vector<ui64>(values.size(), 42),
+                                                             [&](ui32 a, ui32 b) { return values[a] == values[b]; });
+  CHECK(remap.uniqueIndices == std::vector<ui32> {0, 1, 3});
+  CHECK(remap.oldToNewIndex == std::vector<ui32> {0, 1, 0, 2, 1, 0});
+
+  CHECK(createDeduplicationRemap({}, [](ui32, ui32) { return true; }).uniqueIndices.empty());
+}
+
+TEST_CASE("createDeduplicationRemap only compares items with the same key", "[scene]")
+{
+  bool                     comparedDifferentKeys = false;
+  const DeduplicationRemap remap                 = createDeduplicationRemap({1, 2, 1},
+                                                                            [&](ui32 a, ui32 b)
+                                                                            {
+                                                                              comparedDifferentKeys |= a == 1 || b == 1;
+                                                                              return true;
+                                                                            });
+  CHECK_FALSE(comparedDifferentKeys);
+  CHECK(remap.uniqueIndices == std::vector<ui32> {0, 1});
+  CHECK(remap.oldToNewIndex == std::vector<ui32> {0, 1, 0});
+}
+
+TEST_CASE("deduplicateScene merges textures, then materials, then meshes", "[scene]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-scene-deduplication");
+  writeFile(directory.getPath() / "a.png", "AAAA");
+  writeFile(directory.getPath() / "b.png", "AAAA");
+  writeFile(directory.getPath() / "c.png", "CCCC");
+  const std::string inMemoryA = "AAAA";
+  const std::string inMemoryY = "YY";
+
+  // Textures 3 to 6 are files, one of them missing, 7 and 8 are in memory.
+  ImportedScene scene;
+  scene.textureFileNameToTextureIndex = {{"a.png", 3}, {"b.png", 4}, {"c.png", 5}, {"missing.png", 6}};
+  scene.textures = {{getBytes(inMemoryA), inMemoryA.size()}, {getBytes(inMemoryY), inMemoryY.size()}};
+
+  // The first two materials only differ in textures with equal files.
+  ImportedMaterial material      = {};
+  material.textureIndices        = {0, 3, 1, 2, 2};
+  ImportedMaterial sameMaterial  = material;
+  sameMaterial.textureIndices    = {0, 4, 1, 2, 2};
+  ImportedMaterial otherMaterial = material;
+  otherMaterial.textureIndices   = {0, 7, 8, 6, 5};
+  scene.materials                = {material, sameMaterial, otherMaterial};
+
+  // The first two meshes only differ in the equal materials.
+  ImportedMesh mesh;
+  mesh.vertices.resize(3);
+  mesh.indices           = {0, 1, 2};
+  mesh.materialIdx       = 1;
+  ImportedMesh sameMesh  = mesh;
+  sameMesh.materialIdx   = 0;
+  ImportedMesh otherMesh = mesh;
+  otherMesh.materialIdx  = 2;
+  scene.meshes           = {mesh, sameMesh, otherMesh};
+  scene.nodes.push_back({f32m4(1.0f), {0, 1, 2}, {}});
+
+  const SceneDeduplicationReport report = deduplicateScene(scene, directory.getPath());
+  CHECK(report.nTextures == 6);
+  CHECK(report.nDuplicateTextures == 2);
+  CHECK(report.textureBytesSaved == 8);
+  CHECK(report.nMaterials == 3);
+  CHECK(report.nDuplicateMaterials == 1);
+  CHECK(report.materialBytesSaved == sizeof(ImportedMaterial));
+  CHECK(report.nMeshes == 3);
+  CHECK(report.nDuplicateMeshes == 1);
+  CHECK(report.meshBytesSaved == 3 * sizeof(Vertex) + 3 * sizeof(ui32));
+
+  // The missing file is kept, so createTextures can report it.
+  CHECK(scene.textureFileNameToTextureIndex.size() == 3);
+  CHECK(scene.textureFileNameToTextureIndex.at("a.png") == 3);
+  CHECK(scene.textureFileNameToTextureIndex.at("c.png") == 4);
+  CHECK(scene.textureFileNameToTextureIndex.at("missing.png") == 5);
+  REQUIRE(scene.textures.size() == 1);
+  CHECK(scene.textures[0].data == getBytes(inMemoryY));
+
+  REQUIRE(scene.materials.size() == 2);
+  CHECK(scene.materials[0].textureIndices == std::array<ui32, 5> {0, 3, 1, 2, 2});
+  CHECK(scene.materials[1].textureIndices == std::array<ui32, 5> {0, 3, 6, 5, 4});
+  REQUIRE(scene.meshes.size() == 2);
+  CHECK(scene.meshes[0].materialIdx == 0);
+  CHECK(scene.meshes[1].materialIdx == 1);
+  CHECK(scene.nodes[0].meshIndices == std::vector<ui32> {0, 0, 1});
+
+  std::ostringstream stream;
+  printSceneDeduplicationReport(stream, report);
+  CHECK(stream.str().find("Duplicate Textures: 2 of 6, 8 bytes") != std::string::npos);
+}
@@ -0,0 +1,189 @@
+#include "TemporaryDirectory.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <gimslib/io/ShaderCache.hpp>
+#include <iterator>
+#include <string>
+
+using namespace gims;
+
+namespace
+{
+void writeFile(const std::filesystem::path& file, const std::string& content)
+{
+  std::filesystem::create_directories(file.parent_path());
+  std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+  stream << content;
+}
+
+std::string readFile(const std::filesystem::path& file)
+{
+  std::ifstream stream(file, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+// A shader that includes a local header, which includes a header from an include directory.
+struct ShaderFiles
+{
+  explicit ShaderFiles(const std::filesystem::path& directory)
+      : shader(directory / "shaders" / "Shader.hlsl")
+      , localInclude(directory / "shaders" / "Local.hlsli")
+      , includeDirectory(directory / "include")
+      , otherIncludeDirectory(directory / "other")
+      , sharedInclude(directory / "include" / "Shared.hlsli")
+  {
+    writeFile(shader, "#include \"Local.hlsli\"\nfloat4 main() : SV_Target { return color(); }\n");
+    writeFile(localInclude, "  #  include <Shared.hlsli>\nfloat4 color() { return SHARED; }\n");
+    writeFile(sharedInclude, "#define SHARED float4(1, 0, 0, 1)\n");
+    writeFile(otherIncludeDirectory / "Shared.hlsli", "#define SHARED float4(0, 1, 0, 1)\n");
+  }
+
+  std::filesystem::path shader;
+  std::filesystem::path localInclude;
+  std::filesystem::path includeDirectory;
+  std::filesystem::path otherIncludeDirectory;
+  std::filesystem::path sharedInclude;
+};
+
+std::filesystem::path normalize(const std::filesystem::path& path)
+{
+  return std::filesystem::weakly_canonical(path).lexically_normal();
+}
+} // namespace
+
+TEST_CASE("findShaderIncludes follows includes transitively through the include directories", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-shader-includes");
+  const ShaderFiles        files(directory.getPath());
+
+  CHECK(findShaderIncludes(files.shader) == std::vector<std::filesystem::path> {normalize(files.localInclude)});
+  const auto includes = findShaderIncludes(files.shader, {files.includeDirectory});
+  REQUIRE(includes.size() == 2);
+  CHECK(std::find(includes.begin(), includes.end(), normalize(files.localInclude)) != includes.end());
+  CHECK(std::find(includes.begin(), includes.end(), normalize(files.sharedInclude)) != includes.end());
+}
+
+TEST_CASE("ShaderCache keys change with every input of the compilation", "[io]")
+{
+  const TemporaryDirectory  directory("gimslib-core-tests-shader-keys");
+  const ShaderFiles         files(directory.getPath());
+  const ShaderCache         cache(directory.getPath() / "cache");
+  std::vector<ShaderDefine> defines = {{L"FEATURE", L"1"}};
+
+  const auto computeKey = [&]()
+  { return cache.computeKey(files.shader, L"main", L"ps_6_0", defines, 42, {files.includeDirectory}); };
+  const ui64 key = computeKey();
+  CHECK(computeKey() == key);
+
+  CHECK(cache.computeKey(files.shader, L"other", L"ps_6_0", defines, 42, {files.includeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_6", defines, 42, {files.includeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_0", {}, 42, {files.includeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_0", {{L"FEATURE", L"0"}}, 42, {files.includeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_0", defines, 43, {files.includeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_0", defines, 42, {files.otherIncludeDirectory}) != key);
+  CHECK(cache.computeKey(files.shader, L"main", L"ps_6_0", defines, 42, {}) != key);
+
+  SECTION("The key changes if the shader changes")
+  {
+    writeFile(files.shader, readFile(files.shader) + "// Changed\n");
+    CHECK(computeKey() != key);
+  }
+  SECTION("The key changes if a direct include changes")
+  {
+    writeFile(files.localInclude, readFile(files.localInclude) + "// Changed\n");
+    CHECK(computeKey() != key);
+  }
+  SECTION("The key changes if an include from an include directory changes")
+  {
+    writeFile(files.sharedInclude, "#define SHARED float4(0, 0, 1, 1)\n");
+    CHECK(computeKey() != key);
+  }
+}
+
+TEST_CASE("ShaderCache throws if the shader cannot be read", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-shader-missing");
+  const ShaderCache        cache(directory.getPath());
+  CHECK_THROWS_AS(cache.computeKey(directory.getPath() / "Missing.hlsl", L"main", L"ps_6_0", {}, 0),
+                  std::runtime_error);
+}
+
+TEST_CASE("ShaderCache loads the entries it stored", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-shader-store");
+  const ShaderCache        cache(directory.getPath() / "cache");
+  REQUIRE(cache.isEnabled());
+
+  const ShaderCacheEntry entry = {{1, 2, 3, 4, 5}, {6, 7}};
+  ShaderCacheEntry       loaded;
+  CHECK_FALSE(cache.load(1, loaded));
+  REQUIRE(cache.store(1, entry));
+  REQUIRE(cache.load(1, loaded));
+  CHECK(loaded.object == entry.object);
+  CHECK(loaded.reflection == entry.reflection);
+  CHECK_FALSE(cache.load(2, loaded));
+
+  // An entry renamed to another key is rejected, since the key is stored in the file.
+  std::filesystem::copy_file(cache.getEntryPath(1), cache.getEntryPath(2));
+  CHECK_FALSE(cache.load(2, loaded));
+}
+
+TEST_CASE("ShaderCache treats damaged entries as misses", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-shader-damaged");
+  const ShaderCache        cache(directory.getPath());
+  REQUIRE(cache.store(1, {{1, 2, 3, 4, 5, 6, 7, 8}, {9, 10, 11, 12}}));
+  const std::string content = readFile(cache.getEntryPath(1));
+  // The header: magic, version, key, object size and reflection size.
+  const size_t objectSizeOffset     = 16;
+  const size_t reflectionSizeOffset = 24;
+  REQUIRE(content.size() == 32 + 12);
+
+  ShaderCacheEntry loaded;
+  SECTION("Truncated")
+  {
+    writeFile(cache.getEntryPath(1), content.substr(0, content.size() - 1));
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+  SECTION("Truncated header")
+  {
+    writeFile(cache.getEntryPath(1), content.substr(0, 20));
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+  SECTION("Trailing bytes")
+  {
+    writeFile(cache.getEntryPath(1), content + "x");
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+  SECTION("Object size larger than the file")
+  {
+    std::string damaged = content;
+    const ui64  size    = 1ull << 60;
+    damaged.replace(objectSizeOffset, sizeof(size), reinterpret_cast<const char*>(&size), sizeof(size));
+    writeFile(cache.getEntryPath(1), damaged);
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+  SECTION("Sizes that overflow to the file size")
+  {
+    std::string damaged = content;
+    const ui64  size    = ~0ull;
+    damaged.replace(reflectionSizeOffset, sizeof(size), reinterpret_cast<const char*>(&size), sizeof(size));
+    writeFile(cache.getEntryPath(1), damaged);
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+  SECTION("Wrong magic")
+  {
+    writeFile(cache.getEntryPath(1), "XXXX" + content.substr(4));
+    CHECK_FALSE(cache.load(1, loaded));
+  }
+}
+
+TEST_CASE("A disabled ShaderCache neither stores nor loads", "[io]")
+{
+  const ShaderCache cache;
+  ShaderCacheEntry  loaded;
+  CHECK_FALSE(cache.isEnabled());
+  CHECK_FALSE(cache.store(1, {{1}, {}}));
+  CHECK_FALSE(cache.load(1, loaded));
+}
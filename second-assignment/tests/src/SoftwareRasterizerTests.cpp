@@ -0,0 +1,206 @@
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+const ui32 width  = 100;
+const ui32 height = 70;
+
+// A scene with one white texture and one material per color, which only emits its color.
+SoftwareScene createScene(const std::vector<f32v3>& colors)
+{
+  SoftwareScene scene;
+  scene.textures.push_back({1, 1, {ui8v4(255, 255, 255, 255)}, false});
+  for (const f32v3& color : colors)
+  {
+    scene.materials.push_back(
+        {f32v4(color, 1.0f), f32v4(0.0f), f32v4(0.0f), f32v4(0.0f, 0.0f, 0.0f, 1.0f), {0, 0, 0, 0}});
+  }
+  return scene;
+}
+
+// Triangles in clip space, which the identity matrices of the draw calls and the projection keep.
+SoftwareMesh createMesh(const std::vector<f32v3>& positions, ui32 materialIdx)
+{
+  SoftwareMesh mesh;
+  mesh.materialIdx = materialIdx;
+  for (const f32v3& position : positions)
+  {
+    mesh.indices.push_back(static_cast<ui32>(mesh.vertices.size()));
+    mesh.vertices.push_back({position, f32v3(0.0f, 0.0f, -1.0f), f32v2(0.0f)});
+  }
+  return mesh;
+}
+
+// The halves of a quad that covers the screen, both clockwise on the screen.
+std::vector<f32v3> getUpperLeftHalf(f32 z)
+{
+  return {f32v3(-1.0f, 1.0f, z), f32v3(1.0f, 1.0f, z), f32v3(-1.0f, -1.0f, z)};
+}
+
+std::vector<f32v3> getLowerRightHalf(f32 z)
+{
+  return {f32v3(1.0f, 1.0f, z), f32v3(1.0f, -1.0f, z), f32v3(-1.0f, -1.0f, z)};
+}
+
+SoftwareFrameConstants createConstants()
+{
+  SoftwareFrameConstants constants;
+  constants.projection       = f32m4(1.0f);
+  constants.backgroundColor  = f32v3(0.2f, 0.4f, 0.6f);
+  constants.lightDirectionXY = f32v2(0.0f);
+  return constants;
+}
+
+ui64 countPixels(const std::vector<ui8v4>& colors, const ui8v4& color)
+{
+  ui64 result = 0;
+  for (const ui8v4& pixelColor : colors)
+  {
+    result += pixelColor == color ? 1 : 0;
+  }
+  return result;
+}
+} // namespace
+
+using namespace gims;
+
+TEST_CASE("SoftwareRasterizer clears to the background color and the far plane", "[sw]")
+{
+  ThreadPool         threadPool(2);
+  SoftwareRasterizer rasterizer(width, height, threadPool);
+  rasterizer.draw(createScene({}), {}, createConstants());
+  CHECK(countPixels(rasterizer.getColors(), ui8v4(51, 102, 153, 255)) == width * height);
+  for (const f32 depth : rasterizer.getDepths())
+  {
+    REQUIRE(depth == 1.0f);
+  }
+  CHECK(rasterizer.getStatistics().nShadedPixels == 0);
+}
+
+TEST_CASE("SoftwareRasterizer covers each pixel of adjacent triangles exactly once", "[sw]")
+{
+  ThreadPool         threadPool(2);
+  SoftwareRasterizer rasterizer(width, height, threadPool);
+  SoftwareScene      scene = createScene({f32v3(1.0f, 0.0f, 0.0f)});
+  scene.meshes.push_back(createMesh(getUpperLeftHalf(0.5f), 0));
+  scene.meshes.push_back(createMesh(getLowerRightHalf(0.5f), 0));
+  const ui8v4 red(255, 0, 0, 255);
+
+  rasterizer.draw(scene, {{0, f32m4(1.0f)}}, createConstants());
+  const ui64 nUpperLeftPixels = countPixels(rasterizer.getColors(), red);
+  CHECK(rasterizer.getStatistics().nShadedPixels == nUpperLeftPixels);
+  rasterizer.draw(scene, {{1, f32m4(1.0f)}}, createConstants());
+  const ui64 nLowerRightPixels = countPixels(rasterizer.getColors(), red);
+  // The top-left rule gives the pixels on the shared edge to one of the triangles.
+  CHECK(nUpperLeftPixels + nLowerRightPixels == width * height);
+
+  rasterizer.draw(scene, {{0, f32m4(1.0f)}, {1, f32m4(1.0f)}}, createConstants());
+  CHECK(countPixels(rasterizer.getColors(), red) == width * height);
+  CHECK(rasterizer.getStatistics().nTriangles == 2);
+  CHECK(rasterizer.getStatistics().nShadedPixels == width * height);
+  for (const f32 depth : rasterizer.getDepths())
+  {
+    REQUIRE(depth == Approx(0.5f));
+  }
+}
+
+TEST_CASE("SoftwareRasterizer keeps the closest triangle of each pixel regardless of the draw order", "[sw]")
+{
+  ThreadPool         threadPool(2);
+  SoftwareRasterizer rasterizer(width, height, threadPool);
+  SoftwareScene      scene = createScene({f32v3(1.0f, 0.0f, 0.0f), f32v3(0.0f, 0.0f, 1.0f)});
+  scene.meshes.push_back(createMesh(getUpperLeftHalf(0.75f), 0));
+  scene.meshes.push_back(createMesh(getLowerRightHalf(0.75f), 0));
+  scene.meshes.push_back(createMesh(getUpperLeftHalf(0.25f), 1));
+  const std::vector<SoftwareDrawCall> farFirst  = {{0, f32m4(1.0f)}, {1, f32m4(1.0f)}, {2, f32m4(1.0f)}};
+  const std::vector<SoftwareDrawCall> nearFirst = {{2, f32m4(1.0f)}, {0, f32m4(1.0f)}, {1, f32m4(1.0f)}};
+
+  rasterizer.draw(scene, farFirst, createConstants());
+  const std::vector<ui8v4> colors = rasterizer.getColors();
+  const std::vector<f32>   depths = rasterizer.getDepths();
+  CHECK(countPixels(colors, ui8v4(255, 0, 0, 255)) + countPixels(colors, ui8v4(0, 0, 255, 255)) == width * height);
+  // The upper left pixel is in front, the lower right one behind.
+  CHECK(colors.front() == ui8v4(0, 0, 255, 255));
+  CHECK(depths.front() == Approx(0.25f));
+  CHECK(colors.back() == ui8v4(255, 0, 0, 255));
+  CHECK(depths.back() == Approx(0.75f));
+
+  rasterizer.draw(scene, nearFirst, createConstants());
+  CHECK(rasterizer.getColors() == colors);
+  CHECK(rasterizer.getDepths() == depths);
+}
+
+TEST_CASE("SoftwareRasterizer culls the back faces if requested", "[sw]")
+{
+  ThreadPool         threadPool(2);
+  SoftwareRasterizer rasterizer(width, height, threadPool);
+  SoftwareScene      scene = createScene({f32v3(1.0f, 0.0f, 0.0f)});
+  scene.meshes.push_back(createMesh(getUpperLeftHalf(0.5f), 0));
+  std::vector<f32v3> counterClockwise = getUpperLeftHalf(0.5f);
+  std::swap(counterClockwise[1], counterClockwise[2]);
+  scene.meshes.push_back(createMesh(counterClockwise, 0));
+
+  SoftwareFrameConstants constants = createConstants();
+  constants.cullBackFaces          = true;
+  rasterizer.draw(scene, {{0, f32m4(1.0f)}}, constants);
+  CHECK(rasterizer.getStatistics().nRasterizedTriangles == 1);
+  CHECK(rasterizer.getStatistics().nShadedPixels > 0);
+  rasterizer.draw(scene, {{1, f32m4(1.0f)}}, constants);
+  CHECK(rasterizer.getStatistics().nRasterizedTriangles == 0);
+  CHECK(rasterizer.getStatistics().nShadedPixels == 0);
+
+  constants.cullBackFaces = false;
+  rasterizer.draw(scene, {{1, f32m4(1.0f)}}, constants);
+  CHECK(rasterizer.getStatistics().nShadedPixels > 0);
+}
+
+TEST_CASE("SoftwareRasterizer renders the same image with any number of threads", "[sw]")
+{
+  const CograBinaryMeshFile bunny((std::filesystem::path(GIMS_TEST_DATA_DIRECTORY) / "bunny.cbm").string());
+  SoftwareScene             scene = createScene({f32v3(0.1f)});
+  scene.materials[0].diffuse      = f32v4(0.8f, 0.6f, 0.4f, 1.0f);
+  scene.meshes.push_back(createSoftwareMesh(bunny, 0));
+
+  // Looks at the bunny, which is about a unit across around the origin, from the front.
+  SoftwareFrameConstants constants = createConstants();
+  constants.projection       = glm::perspectiveFovLH_ZO(glm::radians(45.0f), 320.0f, 240.0f, 0.1f, 10.0f);
+  constants.twoSidedLighting = true;
+
+  const f32m4 modelView = glm::translate(f32m4(1.0f), f32v3(0.0f, 0.0f, 2.0f));
+
+  std::vector<std::vector<ui8v4>> images;
+  for (const ui32 nThreads : {1u, 4u})
+  {
+    ThreadPool         threadPool(nThreads);
+    SoftwareRasterizer rasterizer(320, 240, threadPool);
+    rasterizer.draw(scene, {{0, modelView}}, constants);
+    CHECK(rasterizer.getStatistics().nTriangles == bunny.getNumTriangles());
+    CHECK(rasterizer.getStatistics().nShadedPixels > 0);
+    images.push_back(rasterizer.getColors());
+  }
+  CHECK(images[0] == images[1]);
+}
+
+TEST_CASE("SoftwareRasterizer rejects invalid sizes and references", "[sw]")
+{
+  ThreadPool threadPool(1);
+  CHECK_THROWS_AS(SoftwareRasterizer(0, 1, threadPool), std::invalid_argument);
+  CHECK_THROWS_AS(SoftwareRasterizer(1, SoftwareRasterizer::maxSize + 1, threadPool), std::invalid_argument);
+
+  SoftwareRasterizer rasterizer(width, height, threadPool);
+  SoftwareScene      scene = createScene({f32v3(1.0f)});
+  scene.meshes.push_back(createMesh(getUpperLeftHalf(0.5f), 0));
+  CHECK_THROWS_AS(rasterizer.draw(scene, {{1, f32m4(1.0f)}}, createConstants()), std::out_of_range);
+  scene.meshes[0].indices[2] = 3;
+  CHECK_THROWS_AS(rasterizer.draw(scene, {{0, f32m4(1.0f)}}, createConstants()), std::out_of_range);
+  scene.meshes[0].indices[2]  = 2;
+  scene.meshes[0].materialIdx = 1;
+  CHECK_THROWS_AS(rasterizer.draw(scene, {{0, f32m4(1.0f)}}, createConstants()), std::out_of_range);
+}
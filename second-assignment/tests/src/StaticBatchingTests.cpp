@@ -0,0 +1,168 @@
+#include "StaticBatching.hpp"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+// Mesh 0 with material 0 occurs in three nodes, one of them mirroring. Mesh 1 with material 1 occurs once.
+struct TestScene
+{
+  TestScene()
+      : nodes(4)
+      , meshes(2)
+      , translation(glm::translate(f32m4(1.0f), f32v3(10.0f, 0.0f, 0.0f)))
+      , nonUniformScale(glm::translate(f32m4(1.0f), f32v3(0.0f, 0.0f, 5.0f)) *
+                        glm::scale(f32m4(1.0f), f32v3(1.0f, 2.0f, 4.0f)))
+      , mirroring(glm::scale(f32m4(1.0f), f32v3(-1.0f, 1.0f, 1.0f)))
+  {
+    const f32v3 normal = f32v3(1.0f, 1.0f, 0.0f) / std::sqrt(2.0f);
+    meshes[0].vertices = {{f32v3(0.0f, 0.0f, 0.0f), normal, f32v2(0.0f), f32v3(0.0f, 0.0f, 1.0f)},
+                          {f32v3(1.0f, 0.0f, 0.0f), normal, f32v2(0.0f), f32v3(0.0f, 0.0f, 1.0f)},
+                          {f32v3(0.0f, 1.0f, 0.0f), normal, f32v2(0.0f), f32v3(0.0f, 0.0f, 1.0f)}};
+    meshes[0].indices       = {0, 1, 2};
+    meshes[1]               = meshes[0];
+    meshes[1].materialIndex = 1;
+
+    nodes[0].transformation = f32m4(1.0f);
+    nodes[0].childIndices   = {1, 2, 3};
+    nodes[1].transformation = translation;
+    nodes[1].meshIndices    = {0};
+    nodes[2].transformation = nonUniformScale;
+    nodes[2].meshIndices    = {0, 1};
+    nodes[3].transformation = mirroring;
+    nodes[3].meshIndices    = {0};
+  }
+
+  std::vector<SceneNode>      nodes;
+  std::vector<StaticMeshData> meshes;
+  f32m4                       translation;
+  f32m4                       nonUniformScale;
+  f32m4                       mirroring;
+};
+
+void checkEqual(const f32v3& a, const f32v3& b)
+{
+  CHECK(a.x == Approx(b.x).margin(1e-6));
+  CHECK(a.y == Approx(b.y).margin(1e-6));
+  CHECK(a.z == Approx(b.z).margin(1e-6));
+}
+} // namespace
+
+TEST_CASE("createStaticBatches merges the occurrences of each material into one batch", "[scene]")
+{
+  const TestScene     scene;
+  const StaticBatches result = createStaticBatches(scene.nodes, scene.meshes);
+
+  REQUIRE(result.batches.size() == 2);
+  const StaticBatch& batch = result.batches[0];
+  CHECK(batch.materialIndex == 0);
+  CHECK(batch.vertices.size() == 9);
+  CHECK(batch.indices.size() == 9);
+  REQUIRE(batch.ranges.size() == 3);
+  CHECK(result.batches[1].materialIndex == 1);
+  CHECK(result.batches[1].ranges.size() == 1);
+
+  // The occurrences are in traversal order, each with the positions of the mesh transformed by its node.
+  const f32m4 transformations[] = {scene.translation, scene.nonUniformScale, scene.mirroring};
+  for (ui32 rangeIdx = 0; rangeIdx < 3; rangeIdx++)
+  {
+    const StaticBatchRange& range = batch.ranges[rangeIdx];
+    CHECK(range.meshIdx == 0);
+    CHECK(range.firstVertex == 3 * rangeIdx);
+    CHECK(range.firstIndex == 3 * rangeIdx);
+    for (ui32 i = 0; i < 3; i++)
+    {
+      checkEqual(batch.vertices[range.firstVertex + i].position,
+                 f32v3(transformations[rangeIdx] * f32v4(scene.meshes[0].vertices[i].position, 1.0f)));
+    }
+  }
+  checkEqual(batch.vertices[4].position, f32v3(1.0f, 0.0f, 5.0f));
+  checkEqual(batch.vertices[5].position, f32v3(0.0f, 2.0f, 5.0f));
+}
+
+TEST_CASE("createStaticBatches transforms normals with the inverse-transpose", "[scene]")
+{
+  const TestScene     scene;
+  const StaticBatches result = createStaticBatches(scene.nodes, scene.meshes);
+  REQUIRE(result.batches.size() == 2);
+
+  // Scaling by (1, 2, 4) scales the normal by (1, 1/2, 1/4), so it stays perpendicular to the scaled triangle.
+  const Vertex& vertex = result.batches[0].vertices[3];
+  checkEqual(vertex.normal, glm::normalize(f32v3(1.0f, 0.5f, 0.0f)));
+  const f32v3 edge = result.batches[0].vertices[5].position - result.batches[0].vertices[4].position;
+  CHECK(glm::dot(vertex.normal, edge) == Approx(0.0f).margin(1e-6));
+  checkEqual(vertex.tangent, f32v3(0.0f, 0.0f, 1.0f));
+
+  // The mirrored normal is mirrored as well.
+  checkEqual(result.batches[0].vertices[6].normal, f32v3(-1.0f, 1.0f, 0.0f) / std::sqrt(2.0f));
+}
+
+TEST_CASE("createStaticBatches flips the winding of mirrored occurrences", "[scene]")
+{
+  const TestScene     scene;
+  const StaticBatches result = createStaticBatches(scene.nodes, scene.meshes);
+  REQUIRE(result.batches.size() == 2);
+  const std::vector<ui32>& indices = result.batches[0].indices;
+  CHECK(std::vector<ui32>(indices.begin(), indices.begin() + 6) == std::vector<ui32> {0, 1, 2, 3, 4, 5});
+  CHECK(std::vector<ui32>(indices.begin() + 6, indices.end()) == std::vector<ui32> {6, 8, 7});
+}
+
+TEST_CASE("createStaticBatches bounds every vertex of a batch", "[scene]")
+{
+  const TestScene     scene;
+  const StaticBatches result = createStaticBatches(scene.nodes, scene.meshes);
+  for (const auto& batch : result.batches)
+  {
+    const f32v3 lower = batch.aabb.getLowerLeftBottom();
+    const f32v3 upper = batch.aabb.getUpperRightTop();
+    for (const auto& vertex : batch.vertices)
+    {
+      for (i32 axis = 0; axis < 3; axis++)
+      {
+        CHECK(vertex.position[axis] >= lower[axis]);
+        CHECK(vertex.position[axis] <= upper[axis]);
+      }
+    }
+  }
+  checkEqual(result.batches[0].aabb.getLowerLeftBottom(), f32v3(-1.0f, 0.0f, 0.0f));
+  checkEqual(result.batches[0].aabb.getUpperRightTop(), f32v3(11.0f, 2.0f, 5.0f));
+}
+
+TEST_CASE("createStaticBatches reports the cost before and after batching", "[scene]")
+{
+  const TestScene                 scene;
+  const StaticBatches             result     = createStaticBatches(scene.nodes, scene.meshes);
+  const StaticBatchingStatistics& statistics = result.statistics;
+  CHECK(statistics.nDrawCallsBefore == 4);
+  CHECK(statistics.nDrawCallsAfter == 2);
+  CHECK(statistics.nVerticesBefore == 6);
+  CHECK(statistics.nVerticesAfter == 12);
+  CHECK(statistics.geometryBytesBefore == 6 * sizeof(Vertex) + 6 * sizeof(ui32));
+  CHECK(statistics.geometryBytesAfter == 12 * sizeof(Vertex) + 12 * sizeof(ui32));
+
+  std::ostringstream stream;
+  printStaticBatchingReport(stream, result);
+  CHECK(stream.str().find("Draw Calls Before: 4") != std::string::npos);
+  CHECK(stream.str().find("Draw Calls After: 2") != std::string::npos);
+}
+
+TEST_CASE("getMaxStaticBatchingError finds corrupted batches", "[scene]")
+{
+  const TestScene scene;
+  StaticBatches   result = createStaticBatches(scene.nodes, scene.meshes);
+  CHECK(getMaxStaticBatchingError(result, scene.meshes) == Approx(0.0f).margin(1e-5));
+
+  StaticBatches movedVertex = result;
+  movedVertex.batches[0].vertices[4].position.x += 0.5f;
+  CHECK(getMaxStaticBatchingError(movedVertex, scene.meshes) == Approx(0.5f));
+
+  result.batches[0].indices[7] = 0;
+  CHECK(getMaxStaticBatchingError(result, scene.meshes) == std::numeric_limits<f32>::infinity());
+}
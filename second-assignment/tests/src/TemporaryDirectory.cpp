@@ -0,0 +1,32 @@
+#include "TemporaryDirectory.hpp"
+#include <random>
+#include <stdexcept>
+
+namespace gims
+{
+TemporaryDirectory::TemporaryDirectory(const std::string& name)
+{
+  std::random_device randomDevice;
+  for (int attempt = 0; attempt < 16; attempt++)
+  {
+    const auto path = std::filesystem::temp_directory_path() / (name + "-" + std::to_string(randomDevice()));
+    if (std::filesystem::create_directory(path))
+    {
+      m_path = path;
+      return;
+    }
+  }
+  throw std::runtime_error("Cannot create a temporary directory for " + name + ".");
+}
+
+TemporaryDirectory::~TemporaryDirectory()
+{
+  std::error_code errorCode;
+  std::filesystem::remove_all(m_path, errorCode);
+}
+
+const std::filesystem::path& TemporaryDirectory::getPath() const
+{
+  return m_path;
+}
+} // namespace gims
@@ -0,0 +1,252 @@
+#include "TemporaryDirectory.hpp"
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <fstream>
+#include <gimslib/io/TextureFile.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using namespace gims;
+
+// Offsets in a DDS file with a DX10 header, as createDdsFile writes it.
+const size_t ddsMipCountOffset      = 4 + 24;
+const size_t ddsFourCCOffset        = 4 + 72 + 8;
+const size_t ddsCaps2Offset         = 4 + 108;
+const size_t ddsDx10HeaderOffset    = 4 + 124;
+const size_t ddsDx10ArraySizeOffset = ddsDx10HeaderOffset + 12;
+const size_t ddsDataOffset          = ddsDx10HeaderOffset + 20;
+
+void writeUi32(std::vector<ui8>& bytes, size_t offset, ui32 value)
+{
+  std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+void writeUi64(std::vector<ui8>& bytes, size_t offset, ui64 value)
+{
+  std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+// Levels filled with their index and the position of each byte, so misplaced levels are noticed.
+std::vector<std::vector<ui8>> createMipLevels(TextureFormat format, ui32 width, ui32 height, ui32 nMipLevels)
+{
+  std::vector<std::vector<ui8>> result;
+  for (const auto& subresource : computeTextureSubresources(format, width, height, nMipLevels, 0))
+  {
+    std::vector<ui8> level(subresource.size);
+    for (size_t i = 0; i < level.size(); i++)
+    {
+      level[i] = static_cast<ui8>(result.size() * 64 + i);
+    }
+    result.push_back(std::move(level));
+  }
+  return result;
+}
+
+// A KTX2 file with an RGBA8 texture of 4x2 texels and two levels, the smaller one first, as KTX2 files store them.
+std::vector<ui8> createKtx2File()
+{
+  const ui8        identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+  std::vector<ui8> result(128 + 8 + 32, 0);
+  std::memcpy(result.data(), identifier, sizeof(identifier));
+  writeUi32(result, 12, 37); // VK_FORMAT_R8G8B8A8_UNORM
+  writeUi32(result, 16, 1);  // Type size.
+  writeUi32(result, 20, 4);
+  writeUi32(result, 24, 2);
+  writeUi32(result, 36, 1);  // Faces.
+  writeUi32(result, 40, 2);  // Levels.
+  writeUi64(result, 80, 136);
+  writeUi64(result, 88, 32);
+  writeUi64(result, 96, 32);
+  writeUi64(result, 104, 128);
+  writeUi64(result, 112, 8);
+  writeUi64(result, 120, 8);
+  for (size_t i = 128; i < result.size(); i++)
+  {
+    result[i] = static_cast<ui8>(i);
+  }
+  return result;
+}
+
+void checkRejected(const std::vector<ui8>& file)
+{
+  CHECK_THROWS_AS(readTextureHeader(file.data(), file.size()), std::runtime_error);
+}
+} // namespace
+
+using namespace gims;
+
+TEST_CASE("computeTextureSubresources packs the mip chain tightly", "[io]")
+{
+  const auto levels = computeTextureSubresources(TextureFormat::R8G8B8A8Unorm, 5, 3, 3, 100);
+  REQUIRE(levels.size() == 3);
+  CHECK(levels[0].width == 5);
+  CHECK(levels[0].height == 3);
+  CHECK(levels[0].rowPitch == 20);
+  CHECK(levels[0].nRows == 3);
+  CHECK(levels[0].offset == 100);
+  CHECK(levels[0].size == 60);
+  CHECK(levels[1].width == 2);
+  CHECK(levels[1].height == 1);
+  CHECK(levels[1].offset == 160);
+  CHECK(levels[1].size == 8);
+  CHECK(levels[2].width == 1);
+  CHECK(levels[2].offset == 168);
+  CHECK(levels[2].size == 4);
+
+  // Block-compressed levels have at least one block.
+  const auto blockLevels = computeTextureSubresources(TextureFormat::BC1Unorm, 10, 6, 4, 0);
+  REQUIRE(blockLevels.size() == 4);
+  CHECK(blockLevels[0].rowPitch == 24);
+  CHECK(blockLevels[0].nRows == 2);
+  CHECK(blockLevels[1].rowPitch == 16);
+  CHECK(blockLevels[1].nRows == 1);
+  CHECK(blockLevels[2].size == 8);
+  CHECK(blockLevels[3].width == 1);
+  CHECK(blockLevels[3].size == 8);
+  CHECK(blockLevels[3].offset == 48 + 16 + 8);
+
+  CHECK_THROWS_AS(computeTextureSubresources(TextureFormat::BC1Unorm, 10, 6, 0, 0), std::invalid_argument);
+  CHECK_THROWS_AS(computeTextureSubresources(TextureFormat::BC1Unorm, 10, 6, 5, 0), std::invalid_argument);
+  CHECK_THROWS_AS(computeTextureSubresources(TextureFormat::BC1Unorm, 0, 6, 1, 0), std::invalid_argument);
+  CHECK_THROWS_AS(computeTextureSubresources(TextureFormat::Unknown, 4, 4, 1, 0), std::invalid_argument);
+}
+
+TEST_CASE("TextureFormat helpers know the block sizes and SRGB variants", "[io]")
+{
+  CHECK(isBlockCompressed(TextureFormat::BC1Unorm));
+  CHECK(isBlockCompressed(TextureFormat::BC7UnormSrgb));
+  CHECK_FALSE(isBlockCompressed(TextureFormat::B8G8R8A8Unorm));
+  CHECK(getBytesPerBlock(TextureFormat::R8Unorm) == 1);
+  CHECK(getBytesPerBlock(TextureFormat::R16G16B16A16Float) == 8);
+  CHECK(getBytesPerBlock(TextureFormat::BC4Snorm) == 8);
+  CHECK(getBytesPerBlock(TextureFormat::BC6HUF16) == 16);
+  CHECK(getSrgbFormat(TextureFormat::BC3Unorm) == TextureFormat::BC3UnormSrgb);
+  CHECK(getSrgbFormat(TextureFormat::BC5Unorm) == TextureFormat::BC5Unorm);
+}
+
+TEST_CASE("TextureFile reads the mip levels of the DDS files it saves", "[io]")
+{
+  const auto               mipLevels = createMipLevels(TextureFormat::BC7UnormSrgb, 8, 4, 4);
+  const TemporaryDirectory directory("gimslib-core-tests-texture-file");
+  const auto               fileName = directory.getPath() / "texture.dds";
+  saveDdsFile(fileName, TextureFormat::BC7UnormSrgb, 8, 4, mipLevels);
+
+  const TextureFile    file(fileName);
+  const TextureHeader& header = file.getHeader();
+  CHECK(header.format == TextureFormat::BC7UnormSrgb);
+  CHECK(header.width == 8);
+  CHECK(header.height == 4);
+  REQUIRE(header.mipLevels.size() == 4);
+  CHECK(header.mipLevels[0].offset == ddsDataOffset);
+  for (ui32 level = 0; level < 4; level++)
+  {
+    REQUIRE(header.mipLevels[level].size == mipLevels[level].size());
+    CHECK(std::memcmp(file.getMipLevelData(level), mipLevels[level].data(), mipLevels[level].size()) == 0);
+  }
+  CHECK_THROWS_AS(file.getMipLevelData(4), std::out_of_range);
+
+  CHECK_THROWS_AS(createDdsFile(TextureFormat::BC7UnormSrgb, 8, 4, {std::vector<ui8>(16)}), std::invalid_argument);
+}
+
+TEST_CASE("readTextureHeader reads DDS files without DX10 header", "[io]")
+{
+  std::vector<ui8> file =
+      createDdsFile(TextureFormat::BC1Unorm, 8, 8, createMipLevels(TextureFormat::BC1Unorm, 8, 8, 2));
+  file.erase(file.begin() + ddsDx10HeaderOffset, file.begin() + ddsDataOffset);
+  writeUi32(file, ddsFourCCOffset, 0x31545844); // "DXT1"
+  const TextureHeader header = readTextureHeader(file.data(), file.size());
+  CHECK(header.format == TextureFormat::BC1Unorm);
+  REQUIRE(header.mipLevels.size() == 2);
+  CHECK(header.mipLevels[0].offset == ddsDx10HeaderOffset);
+  CHECK(header.mipLevels[1].offset == ddsDx10HeaderOffset + 32);
+}
+
+TEST_CASE("readTextureHeader reads the level index of KTX2 files", "[io]")
+{
+  const std::vector<ui8> file   = createKtx2File();
+  const TextureHeader    header = readTextureHeader(file.data(), file.size());
+  CHECK(header.format == TextureFormat::R8G8B8A8Unorm);
+  CHECK(header.width == 4);
+  CHECK(header.height == 2);
+  REQUIRE(header.mipLevels.size() == 2);
+  CHECK(header.mipLevels[0].offset == 136);
+  CHECK(header.mipLevels[0].size == 32);
+  CHECK(header.mipLevels[1].offset == 128);
+  CHECK(header.mipLevels[1].size == 8);
+  CHECK(isTextureContainer(file.data(), file.size()));
+}
+
+TEST_CASE("readTextureHeader rejects malformed DDS files", "[io]")
+{
+  const std::vector<ui8> valid = createDdsFile(TextureFormat::R8G8B8A8Unorm, 8, 8,
+                                               createMipLevels(TextureFormat::R8G8B8A8Unorm, 8, 8, 4));
+  REQUIRE_NOTHROW(readTextureHeader(valid.data(), valid.size()));
+
+  checkRejected(std::vector<ui8>(valid.begin(), valid.begin() + 100));
+  checkRejected(std::vector<ui8>(valid.begin(), valid.begin() + ddsDx10HeaderOffset + 10));
+  checkRejected(std::vector<ui8>(valid.begin(), valid.end() - 1));
+
+  std::vector<ui8> file = valid;
+  writeUi32(file, ddsCaps2Offset, 0x200);
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, ddsDx10ArraySizeOffset, 2);
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, ddsDx10HeaderOffset, 2); // DXGI_FORMAT_R32G32B32A32_FLOAT
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, ddsMipCountOffset, 5);
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, ddsFourCCOffset, 0x31545846);
+  checkRejected(file);
+}
+
+TEST_CASE("readTextureHeader rejects malformed KTX2 files", "[io]")
+{
+  const std::vector<ui8> valid = createKtx2File();
+  checkRejected(std::vector<ui8>(valid.begin(), valid.begin() + 60));
+  checkRejected(std::vector<ui8>(valid.begin(), valid.begin() + 100));
+  checkRejected(std::vector<ui8>(valid.begin(), valid.end() - 1));
+
+  std::vector<ui8> file = valid;
+  writeUi32(file, 44, 2); // Zstandard.
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, 36, 6);
+  checkRejected(file);
+  file = valid;
+  writeUi32(file, 12, 1000);
+  checkRejected(file);
+  // More levels than 4x2 texels have, in a file that is large enough for their index.
+  file = valid;
+  file.resize(256);
+  writeUi32(file, 40, 5);
+  checkRejected(file);
+  file = valid;
+  writeUi64(file, 112, 16);
+  checkRejected(file);
+  file = valid;
+  writeUi64(file, 80, 1u << 20);
+  checkRejected(file);
+
+  checkRejected({'P', 'N', 'G', ' ', 0, 0, 0, 0});
+  CHECK_FALSE(isTextureContainer(valid.data(), 8));
+}
+
+TEST_CASE("findTextureContainerFile prefers a DDS or KTX2 file next to an image", "[io]")
+{
+  const TemporaryDirectory directory("gimslib-core-tests-texture-file");
+  const auto               imagePath = directory.getPath() / "albedo.png";
+  CHECK(findTextureContainerFile(imagePath) == imagePath);
+  std::ofstream(directory.getPath() / "albedo.ktx2").put(0);
+  CHECK(findTextureContainerFile(imagePath) == directory.getPath() / "albedo.ktx2");
+  std::ofstream(directory.getPath() / "albedo.dds").put(0);
+  CHECK(findTextureContainerFile(imagePath) == directory.getPath() / "albedo.dds");
+  CHECK(isTextureContainerFile("albedo.KTX2"));
+  CHECK(isTextureContainerFile("albedo.dds"));
+  CHECK_FALSE(isTextureContainerFile(imagePath));
+}
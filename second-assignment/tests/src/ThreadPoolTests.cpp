@@ -0,0 +1,54 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <gimslib/sys/ThreadPool.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gims;
+
+TEST_CASE("ThreadPool calls every task exactly once", "[sys]")
+{
+  ThreadPool pool(4);
+  CHECK(pool.getNumberOfThreads() == 4);
+  for (const ui32 nTasks : {0u, 1u, 3u, 1000u})
+  {
+    std::vector<std::atomic<ui32>> nCalls(nTasks);
+    pool.parallelFor(nTasks, [&](ui32 taskIdx) { nCalls[taskIdx]++; });
+    for (const auto& n : nCalls)
+    {
+      REQUIRE(n == 1);
+    }
+  }
+}
+
+TEST_CASE("ThreadPool rethrows the exception of a task after all tasks finished", "[sys]")
+{
+  ThreadPool        pool(4);
+  std::atomic<ui32> nCalls = 0;
+  CHECK_THROWS_AS(pool.parallelFor(100,
+                                   [&](ui32 taskIdx)
+                                   {
+                                     nCalls++;
+                                     if (taskIdx == 10)
+                                     {
+                                       throw std::runtime_error("Task failed.");
+                                     }
+                                   }),
+                  std::runtime_error);
+  CHECK(nCalls == 100);
+  // The pool stays usable.
+  nCalls = 0;
+  pool.parallelFor(10, [&](ui32) { nCalls++; });
+  CHECK(nCalls == 10);
+}
+
+TEST_CASE("ThreadPool executes the loops of several calling threads one after the other", "[sys]")
+{
+  ThreadPool        pool(3);
+  std::atomic<ui64> sum = 0;
+  std::thread       other([&]() { pool.parallelFor(500, [&](ui32 taskIdx) { sum += taskIdx; }); });
+  pool.parallelFor(500, [&](ui32 taskIdx) { sum += taskIdx; });
+  other.join();
+  CHECK(sum == 2 * (499 * 500 / 2));
+}
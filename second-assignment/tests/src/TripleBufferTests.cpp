@@ -0,0 +1,126 @@
+#include <array>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <gimslib/sys/TripleBuffer.hpp>
+#include <thread>
+
+using namespace gims;
+
+namespace
+{
+// Every value of a frame is derived from its number, so a frame the producer writes while the consumer reads it shows
+// up as a mix of two numbers.
+struct Frame
+{
+  ui64                 frameIdx = 0;
+  std::array<ui64, 32> values   = {};
+};
+
+void fillFrame(Frame& frame, ui64 frameIdx)
+{
+  frame.frameIdx = frameIdx;
+  for (ui64 i = 0; i < frame.values.size(); i++)
+  {
+    frame.values[i] = frameIdx * frame.values.size() + i;
+  }
+}
+
+bool isIntact(const Frame& frame)
+{
+  for (ui64 i = 0; i < frame.values.size(); i++)
+  {
+    if (frame.values[i] != frame.frameIdx * frame.values.size() + i)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+TEST_CASE("TripleBuffer hands the latest published value to the consumer", "[sys]")
+{
+  TripleBuffer<int> buffer(7);
+  CHECK_FALSE(buffer.acquire());
+  CHECK(buffer.getReadBuffer() == 7);
+
+  buffer.getWriteBuffer() = 1;
+  buffer.publish();
+  buffer.getWriteBuffer() = 2;
+  buffer.publish();
+  CHECK(buffer.acquire());
+  CHECK(buffer.getReadBuffer() == 2);
+  CHECK_FALSE(buffer.acquire());
+  CHECK(buffer.getReadBuffer() == 2);
+
+  buffer.getWriteBuffer() = 3;
+  buffer.publish();
+  CHECK(buffer.acquire());
+  CHECK(buffer.getReadBuffer() == 3);
+}
+
+TEST_CASE("TripleBuffer never tears, repeats or loses the latest frame with concurrent producer and consumer", "[sys]")
+{
+  constexpr ui64 nFrames = 200000;
+  Frame          initialFrame;
+  fillFrame(initialFrame, 0);
+  TripleBuffer<Frame> buffer(initialFrame);
+  std::atomic<ui64>   lastPublishedFrameIdx = 0;
+
+  std::thread producer(
+      [&]()
+      {
+        for (ui64 frameIdx = 1; frameIdx <= nFrames; frameIdx++)
+        {
+          fillFrame(buffer.getWriteBuffer(), frameIdx);
+          buffer.publish();
+          lastPublishedFrameIdx.store(frameIdx);
+        }
+      });
+
+  // Counted instead of checked with REQUIRE on every frame, since Catch2 assertions are slow and not thread-safe.
+  ui64 nTornFrames      = 0;
+  ui64 nRepeatedFrames  = 0;
+  ui64 nChangedFrames   = 0; // Read buffers that changed although acquire() returned false.
+  ui64 nOutdatedFrames  = 0;
+  ui64 nAcquiredFrames  = 0;
+  ui64 lastReadFrameIdx = 0;
+  while (lastReadFrameIdx < nFrames)
+  {
+    // Every frame published before acquire() must be visible afterwards, either as the new read buffer or as an older
+    // read buffer that already was as recent.
+    const ui64   publishedFrameIdx = lastPublishedFrameIdx.load();
+    const bool   isNew             = buffer.acquire();
+    const Frame& frame             = buffer.getReadBuffer();
+    if (!isIntact(frame))
+    {
+      nTornFrames++;
+    }
+    if (isNew)
+    {
+      nAcquiredFrames++;
+      if (frame.frameIdx <= lastReadFrameIdx)
+      {
+        nRepeatedFrames++;
+      }
+    }
+    else if (frame.frameIdx != lastReadFrameIdx)
+    {
+      nChangedFrames++;
+    }
+    if (frame.frameIdx < publishedFrameIdx)
+    {
+      nOutdatedFrames++;
+    }
+    lastReadFrameIdx = frame.frameIdx;
+  }
+  producer.join();
+
+  CHECK(nTornFrames == 0);
+  CHECK(nRepeatedFrames == 0);
+  CHECK(nChangedFrames == 0);
+  CHECK(nOutdatedFrames == 0);
+  CHECK(nAcquiredFrames > 0);
+  CHECK(lastReadFrameIdx == nFrames);
+  CHECK_FALSE(buffer.acquire());
+}
@@ -0,0 +1,3 @@
+// Catch2 provides the main function of gimslib-core-tests.
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,136 @@
+#include <GltfImport.hpp>
+#include <SceneDeduplication.hpp>
+#include <ScenePackage.hpp>
+#include <chrono>
+#include <filesystem>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <iostream>
+#include <string>
+
+using namespace gims;
+
+namespace
+{
+struct Arguments
+{
+  std::filesystem::path input;
+  std::filesystem::path output;                   //! Next to the input, with the extension .gpak, if empty.
+  bool                  compressTextures = false;
+  bool                  verify           = false; //! Reads the package back and checks the hashes of all entries.
+};
+
+Arguments parseArguments(int argc, char** argv)
+{
+  Arguments arguments;
+  bool      valid = true;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--output" && i + 1 < argc)
+    {
+      arguments.output = argv[++i];
+    }
+    else if (argument == "--compress-textures")
+    {
+      arguments.compressTextures = true;
+    }
+    else if (argument == "--verify")
+    {
+      arguments.verify = true;
+    }
+    else if (argument.rfind("--", 0) != 0 && arguments.input.empty())
+    {
+      arguments.input = argument;
+    }
+    else
+    {
+      valid = false;
+      break;
+    }
+  }
+  const bool isMesh = arguments.input.extension() == ".cbm";
+  if (!valid || (!isGltfFile(arguments.input) && !isMesh))
+  {
+    throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                " <scene.gltf | scene.glb | mesh.cbm> [--output <package>] [--compress-textures]"
+                                " [--verify]\n"
+                                "Writes the scene and its textures into one package, which the scene graph viewer"
+                                " and the scene-renderer load with a single mapping.");
+  }
+  if (arguments.output.empty())
+  {
+    arguments.output = std::filesystem::path(arguments.input).replace_extension(".gpak");
+  }
+  return arguments;
+}
+
+// A mesh file becomes a scene of one node and one material without textures, with the colors of the mesh viewer.
+ImportedScene importMesh(const std::filesystem::path& path)
+{
+  const SoftwareMesh softwareMesh = createSoftwareMesh(CograBinaryMeshFile(path.string()), 0);
+  ImportedScene      result;
+  ImportedMesh&      mesh = result.meshes.emplace_back();
+  mesh.vertices.reserve(softwareMesh.vertices.size());
+  for (const auto& vertex : softwareMesh.vertices)
+  {
+    mesh.vertices.push_back({vertex.position, vertex.normal, vertex.textureCoordinate, f32v3(0.0f)});
+  }
+  mesh.indices = softwareMesh.indices;
+  result.nodes.push_back({f32m4(1.0f), {0}, {}});
+
+  ImportedMaterial material;
+  material.emissive                 = f32v4(0.0f);
+  material.ambient                  = f32v4(0.0f);
+  material.diffuse                  = f32v4(1.0f, 1.0f, 1.0f, 0.0f);
+  material.specularColorAndExponent = f32v4(1.0f, 1.0f, 1.0f, 128.0f);
+  material.textureIndices           = {1, 0, 0, 1, 2}; // White for diffuse, like the mesh viewer without texture.
+  result.materials.push_back(material);
+  return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    const Arguments arguments  = parseArguments(argc, argv);
+    const auto      start      = std::chrono::steady_clock::now();
+    const auto      parentPath = std::filesystem::weakly_canonical(arguments.input).parent_path();
+
+    ImportedScene scene =
+        isGltfFile(arguments.input) ? importGltfScene(arguments.input) : importMesh(arguments.input);
+    // Duplicates are stored once, so the viewer finds none when it loads the package.
+    printSceneDeduplicationReport(std::cout, deduplicateScene(scene, parentPath));
+    saveScenePackage(arguments.output, scene, parentPath, arguments.compressTextures);
+
+    const auto seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Wrote " << arguments.output.string() << " (" << scene.meshes.size() << " meshes, "
+              << scene.materials.size() << " materials, " << scene.textureFileNameToTextureIndex.size()
+              << " textures, " << std::filesystem::file_size(arguments.output) / 1024 << " KB) in " << seconds << " s"
+              << std::endl;
+
+    if (arguments.verify)
+    {
+      const PackageFile package(arguments.output);
+      for (ui32 entryIdx = 0; entryIdx < package.getEntries().size(); entryIdx++)
+      {
+        if (!package.verify(entryIdx))
+        {
+          throw std::runtime_error("Entry " + package.getEntries()[entryIdx].name + " does not match its hash.");
+        }
+      }
+      // Reading the scene back checks the layouts and indices of the entries.
+      const ImportedScene packagedScene = importScenePackage(arguments.output);
+      std::cout << "Verified " << package.getEntries().size() << " entries, " << packagedScene.meshes.size()
+                << " meshes, and " << packagedScene.textures.size() << " textures." << std::endl;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,426 @@
+#include <GltfImport.hpp>
+#include <SceneDeduplication.hpp>
+#include <SceneImport.hpp>
+#include <ScenePackage.hpp>
+#include <SoftwareScene.hpp>
+#include <algorithm>
+#include <assimp/Importer.hpp>
+#include <chrono>
+#include <filesystem>
+#include <gimslib/io/CameraPath.hpp>
+#include <gimslib/io/CograBinaryMeshFile.hpp>
+#include <gimslib/io/PackageFile.hpp>
+#include <gimslib/sw/RayCasting.hpp>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <gimslib/sw/SoftwareRasterizer.hpp>
+#include <gimslib/sys/Benchmark.hpp>
+#include <gimslib/ui/ExaminerController.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+struct Arguments
+{
+  std::filesystem::path input;
+  std::filesystem::path output = "render.png";
+  ui32                  width  = 640;
+  ui32                  height = 480;
+  ui32                  nThreads = 0;
+  ui32                  nFrames  = 1;
+  std::filesystem::path cameraPath;
+  ui32                  poseIdx = 0;
+  std::filesystem::path texture;
+  bool                  cullBackFaces    = false;
+  bool                  twoSidedLighting = false;
+  bool                  flatShading      = false;
+  bool                  rayCast          = false;
+  bool                  assimp           = false; //! Imports glTF scenes with Assimp instead of importGltfScene.
+  std::filesystem::path reference;
+  ui32                  tolerance                 = 8;
+  f64                   maxFractionAboveTolerance = 0.01;
+};
+
+Arguments parseArguments(int argc, char** argv)
+{
+  Arguments arguments;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--output" && i + 1 < argc)
+    {
+      arguments.output = argv[++i];
+    }
+    else if (argument == "--width" && i + 1 < argc)
+    {
+      arguments.width = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--height" && i + 1 < argc)
+    {
+      arguments.height = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--threads" && i + 1 < argc)
+    {
+      arguments.nThreads = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--frames" && i + 1 < argc)
+    {
+      arguments.nFrames = std::max(1u, static_cast<ui32>(std::stoul(argv[++i])));
+    }
+    else if (argument == "--camera-path" && i + 1 < argc)
+    {
+      arguments.cameraPath = argv[++i];
+    }
+    else if (argument == "--pose" && i + 1 < argc)
+    {
+      arguments.poseIdx = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--texture" && i + 1 < argc)
+    {
+      arguments.texture = argv[++i];
+    }
+    else if (argument == "--cull-back-faces")
+    {
+      arguments.cullBackFaces = true;
+    }
+    else if (argument == "--two-sided-lighting")
+    {
+      arguments.twoSidedLighting = true;
+    }
+    else if (argument == "--flat-shading")
+    {
+      arguments.flatShading = true;
+    }
+    else if (argument == "--ray-cast")
+    {
+      arguments.rayCast = true;
+    }
+    else if (argument == "--assimp")
+    {
+      arguments.assimp = true;
+    }
+    else if (argument == "--reference" && i + 1 < argc)
+    {
+      arguments.reference = argv[++i];
+    }
+    else if (argument == "--tolerance" && i + 1 < argc)
+    {
+      arguments.tolerance = static_cast<ui32>(std::stoul(argv[++i]));
+    }
+    else if (argument == "--max-fraction" && i + 1 < argc)
+    {
+      arguments.maxFractionAboveTolerance = std::stod(argv[++i]);
+    }
+    else if (arguments.input.empty() && argument.rfind("--", 0) != 0)
+    {
+      arguments.input = argument;
+    }
+    else
+    {
+      arguments.input.clear();
+      break;
+    }
+  }
+  if (arguments.rayCast && arguments.cullBackFaces)
+  {
+    throw std::invalid_argument("--ray-cast does not cull back faces.");
+  }
+  if (arguments.input.empty())
+  {
+    throw std::invalid_argument(
+        "Usage: " + std::string(argv[0]) +
+        " <scene.gltf | scene.gpak | mesh.cbm> [--output <png>] [--width <n>] [--height <n>] [--threads <n>]"
+        " [--frames <n>] [--camera-path <path> [--pose <n>]] [--texture <png>] [--cull-back-faces] [--two-sided-lighting]"
+        " [--flat-shading] [--ray-cast] [--assimp] [--reference <image> [--tolerance <n>] [--max-fraction <f>]]");
+  }
+  return arguments;
+}
+
+// What is drawn, with the constants and the camera of the viewer that shows it.
+struct Frame
+{
+  SoftwareScene                 scene;
+  std::vector<SoftwareDrawCall> drawCalls;
+  SoftwareFrameConstants        constants;
+};
+
+// The view of the first or the recorded camera, as ExaminerController computes it.
+f32m4 getViewTransformation(const Arguments& arguments, const f32v3& initialTranslation)
+{
+  ExaminerController examinerController(true);
+  examinerController.setTranslationVector(initialTranslation);
+  if (!arguments.cameraPath.empty())
+  {
+    const CameraPose& pose = CameraPath::load(arguments.cameraPath).getPose(arguments.poseIdx);
+    examinerController.setRotationQuaterion(pose.rotation);
+    examinerController.setTranslationVector(pose.translation);
+  }
+  return examinerController.getTransformationMatrix();
+}
+
+// glTF scenes are read without Assimp, unless they use features importGltfScene does not support. Packages are read
+// with importScenePackage. Both are deduplicated like the viewer does.
+SoftwareSceneGraph loadSceneGraph(const Arguments& arguments)
+{
+  const auto parentPath = std::filesystem::weakly_canonical(arguments.input).parent_path();
+  if (isPackageFile(arguments.input))
+  {
+    ImportedScene inputScene = importScenePackage(arguments.input);
+    deduplicateScene(inputScene, parentPath);
+    return createSoftwareSceneGraph(inputScene, parentPath);
+  }
+  if (isGltfFile(arguments.input) && !arguments.assimp)
+  {
+    ImportedScene inputScene;
+    try
+    {
+      inputScene = importGltfScene(arguments.input);
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << " Importing with Assimp instead." << std::endl;
+    }
+    if (!inputScene.nodes.empty())
+    {
+      deduplicateScene(inputScene, parentPath);
+      return createSoftwareSceneGraph(inputScene, parentPath);
+    }
+  }
+  Assimp::Importer importer;
+  const aiScene*   inputScene = importAssimpScene(importer, arguments.input);
+  return createSoftwareSceneGraph(inputScene, parentPath);
+}
+
+// The scene graph viewer, with its default settings.
+Frame createSceneFrame(const Arguments& arguments)
+{
+  const auto sceneGraph = loadSceneGraph(arguments);
+
+  const f32m4 sceneView =
+      getViewTransformation(arguments, f32v3(0, -0.25f, 2.0f)) * sceneGraph.aabb.getNormalizationTransformation();
+  Frame frame;
+  frame.scene     = sceneGraph.scene;
+  frame.drawCalls = createSoftwareDrawCalls(sceneGraph, sceneView);
+  frame.constants.projection = glm::perspectiveFovLH_ZO<f32>(glm::radians(45.0f), (f32)arguments.width,
+                                                             (f32)arguments.height, 1.0f / 256.0f, 256.0f);
+  frame.constants.backgroundColor  = f32v3(0.25f, 0.25f, 0.25f);
+  frame.constants.lightDirectionXY = f32v2(0.0f, 0.0f);
+  frame.constants.lightIntensity   = 3.0f;
+  return frame;
+}
+
+// The mesh viewer, with its default settings and its normalization of the mesh.
+Frame createMeshFrame(const Arguments& arguments)
+{
+  const CograBinaryMeshFile meshFile(arguments.input.string());
+  Frame                     frame;
+  frame.scene.meshes.push_back(createSoftwareMesh(meshFile, 0));
+
+  // The mesh viewer loads its texture flipped and samples it without SRGB conversion.
+  frame.scene.textures.push_back({1, 1, {ui8v4(255, 255, 255, 255)}, false});
+  frame.scene.textures.push_back({1, 1, {ui8v4(0, 0, 0, 255)}, false});
+  ui32 diffuseTextureIdx = 0;
+  if (!arguments.texture.empty())
+  {
+    SoftwareImage image = loadSoftwareImage(arguments.texture);
+    for (ui32 y = 0; y < image.height / 2; y++)
+    {
+      std::swap_ranges(image.pixels.begin() + static_cast<size_t>(y) * image.width,
+                       image.pixels.begin() + static_cast<size_t>(y + 1) * image.width,
+                       image.pixels.begin() + static_cast<size_t>(image.height - 1 - y) * image.width);
+    }
+    diffuseTextureIdx = static_cast<ui32>(frame.scene.textures.size());
+    frame.scene.textures.push_back({image.width, image.height, std::move(image.pixels), false});
+  }
+  frame.scene.materials.push_back(
+      {f32v4(0.0f), f32v4(0.0f), f32v4(1.0f), f32v4(1.0f, 1.0f, 1.0f, 128.0f), {0, diffuseTextureIdx, 0, 1}});
+
+  f32v3 centroid(0.0f);
+  f32v3 lowerLeftBottom = frame.scene.meshes[0].vertices.at(0).position;
+  f32v3 upperRightTop   = lowerLeftBottom;
+  for (const auto& vertex : frame.scene.meshes[0].vertices)
+  {
+    centroid += vertex.position;
+    lowerLeftBottom = glm::min(lowerLeftBottom, vertex.position);
+    upperRightTop   = glm::max(upperRightTop, vertex.position);
+  }
+  centroid /= static_cast<f32>(frame.scene.meshes[0].vertices.size());
+  const f32v3 axisLengths = upperRightTop - lowerLeftBottom;
+  const f32   longestAxis = glm::max(axisLengths.x, glm::max(axisLengths.y, axisLengths.z));
+  const f32m4 normalization =
+      glm::rotate(f32m4(1.0f), glm::radians(180.0f), f32v3(0.0f, 1.0f, 0.0f)) *
+      glm::scale(f32m4(1.0f), axisLengths / longestAxis) * glm::translate(f32m4(1.0f), -centroid);
+
+  frame.drawCalls = {{0, getViewTransformation(arguments, f32v3(0, 0, 3.0f)) * normalization}};
+  frame.constants.projection = glm::perspectiveFovLH_ZO<f32>(glm::radians(45.0f), (f32)arguments.width,
+                                                             (f32)arguments.height, 0.01f, 1000.01f);
+  frame.constants.backgroundColor  = f32v3(0.25f, 0.25f, 0.25f);
+  frame.constants.lightDirectionXY = f32v2(0.0f, 0.0f);
+  frame.constants.lightIntensity   = 1.0f;
+  return frame;
+}
+
+SoftwareImage rasterize(const Frame& frame, const Arguments& arguments, ThreadPool& threadPool)
+{
+  SoftwareRasterizer rasterizer(arguments.width, arguments.height, threadPool);
+  std::vector<f64>   milliseconds;
+  for (ui32 i = 0; i < arguments.nFrames; i++)
+  {
+    rasterizer.draw(frame.scene, frame.drawCalls, frame.constants);
+    milliseconds.push_back(rasterizer.getStatistics().totalMilliseconds);
+  }
+
+  // Throughput of the median frame, all frames draw the same.
+  const auto&       statistics = rasterizer.getStatistics();
+  const TimeSummary times      = summarizeTimes(milliseconds);
+  const f64         seconds    = std::max(times.p50, 1e-6) / 1000.0;
+  std::cout << "Threads: " << threadPool.getNumberOfThreads() << ", Draw Calls: " << frame.drawCalls.size()
+            << ", Triangles: " << statistics.nTriangles << " (" << statistics.nRasterizedTriangles
+            << " rasterized), Shaded Pixels: " << statistics.nShadedPixels << "\n"
+            << "Frame: " << times.p50 << " ms (p50 of " << times.nSamples << "), Vertices "
+            << statistics.vertexMilliseconds << " ms, Binning " << statistics.binningMilliseconds << " ms, Tiles "
+            << statistics.rasterMilliseconds << " ms\n"
+            << "Throughput: " << static_cast<f64>(statistics.nTriangles) / seconds / 1e6 << " MTriangles/s, "
+            << static_cast<f64>(statistics.nShadedPixels) / seconds / 1e6 << " MPixels/s" << std::endl;
+  return {rasterizer.getWidth(), rasterizer.getHeight(), rasterizer.getColors()};
+}
+
+// Casts one ray through the center of each pixel and shades the closest hit like the rasterizer does, so the images
+// of both agree up to the rounding of the attributes. The instances are the draw calls, in view space.
+SoftwareImage castRays(const Frame& frame, const Arguments& arguments, ThreadPool& threadPool)
+{
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  std::vector<TriangleBvhGeometry> geometries;
+  for (const auto& mesh : frame.scene.meshes)
+  {
+    geometries.push_back({mesh.vertices.empty() ? nullptr : &mesh.vertices[0].position,
+                          static_cast<ui32>(mesh.vertices.size()), sizeof(SoftwareVertex), mesh.indices.data(),
+                          static_cast<ui32>(mesh.indices.size() / 3)});
+  }
+  RayCastingScene                 scene(createTriangleBvhs(geometries, threadPool));
+  std::vector<RayCastingInstance> instances;
+  for (const auto& drawCall : frame.drawCalls)
+  {
+    instances.push_back({drawCall.meshIdx, drawCall.modelView});
+  }
+  scene.setInstances(instances);
+  const f64 buildMilliseconds = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+  const f32m4       inverseProjection = glm::inverse(frame.constants.projection);
+  const f32v3       background = glm::clamp(frame.constants.backgroundColor, 0.0f, 1.0f) * 255.0f + 0.5f;
+  const ui8v4       backgroundColor(f32v4(background, 255.0f));
+  SoftwareImage     image = {arguments.width, arguments.height,
+                             std::vector<ui8v4>(static_cast<size_t>(arguments.width) * arguments.height)};
+  std::vector<f64>  milliseconds;
+  std::vector<ui64> nRowHits(arguments.height);
+  for (ui32 frameIdx = 0; frameIdx < arguments.nFrames; frameIdx++)
+  {
+    const auto frameStart = Clock::now();
+    threadPool.parallelFor(
+        arguments.height,
+        [&](ui32 y)
+        {
+          nRowHits[y] = 0;
+          for (ui32 x = 0; x < arguments.width; x++)
+          {
+            const f32v2 normalizedCoordinates(
+                (static_cast<f32>(x) + 0.5f) / static_cast<f32>(arguments.width) * 2.0f - 1.0f,
+                1.0f - (static_cast<f32>(y) + 0.5f) / static_cast<f32>(arguments.height) * 2.0f);
+            RayHit hit;
+            ui8v4& pixel = image.pixels[static_cast<size_t>(y) * arguments.width + x];
+            if (!scene.intersect(createCameraRay(inverseProjection, normalizedCoordinates), hit))
+            {
+              pixel = backgroundColor;
+              continue;
+            }
+            nRowHits[y]++;
+
+            // The attributes of the vertices, weighted with the barycentric coordinates of the hit.
+            const SoftwareDrawCall& drawCall = frame.drawCalls[hit.instanceIdx];
+            const SoftwareMesh&     mesh     = frame.scene.meshes[drawCall.meshIdx];
+            const f32 weights[3] = {1.0f - hit.barycentrics.x - hit.barycentrics.y, hit.barycentrics.x,
+                                    hit.barycentrics.y};
+            f32v3     viewPositions[3];
+            f32v3     viewNormal        = f32v3(0.0f);
+            f32v2     textureCoordinate = f32v2(0.0f);
+            for (ui32 k = 0; k < 3; k++)
+            {
+              const SoftwareVertex& vertex = mesh.vertices[mesh.indices[hit.triangleIdx * 3 + k]];
+              viewPositions[k]             = f32v3(drawCall.modelView * f32v4(vertex.position, 1.0f));
+              viewNormal += weights[k] * f32v3(drawCall.modelView * f32v4(vertex.normal, 0.0f));
+              textureCoordinate += weights[k] * vertex.textureCoordinate;
+            }
+            const f32v3 viewPosition =
+                weights[0] * viewPositions[0] + weights[1] * viewPositions[1] + weights[2] * viewPositions[2];
+            f32v3 faceNormal =
+                glm::cross(viewPositions[1] - viewPositions[0], viewPositions[2] - viewPositions[0]);
+            faceNormal = glm::normalize(glm::dot(faceNormal, viewPositions[0]) > 0.0f ? -faceNormal : faceNormal);
+            pixel      = shadeSoftwareSurface(frame.scene, frame.scene.materials.at(mesh.materialIdx),
+                                              frame.constants, viewPosition, viewNormal, textureCoordinate,
+                                              faceNormal);
+          }
+        });
+    milliseconds.push_back(std::chrono::duration<f64, std::milli>(Clock::now() - frameStart).count());
+  }
+
+  ui64 nHits = 0;
+  for (const ui64 n : nRowHits)
+  {
+    nHits += n;
+  }
+  const TimeSummary times   = summarizeTimes(milliseconds);
+  const f64         seconds = std::max(times.p50, 1e-6) / 1000.0;
+  const f64         nRays   = static_cast<f64>(arguments.width) * arguments.height;
+  std::cout << "Threads: " << threadPool.getNumberOfThreads() << ", Instances: " << instances.size()
+            << ", Hierarchies: " << buildMilliseconds << " ms, Rays: " << nRays << " (" << nHits << " hits)\n"
+            << "Frame: " << times.p50 << " ms (p50 of " << times.nSamples << ")\n"
+            << "Throughput: " << nRays / seconds / 1e6 << " MRays/s" << std::endl;
+  return image;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    const Arguments arguments = parseArguments(argc, argv);
+    Frame           frame     = arguments.input.extension() == ".cbm" ? createMeshFrame(arguments)
+                                                                      : createSceneFrame(arguments);
+    frame.constants.cullBackFaces    = arguments.cullBackFaces;
+    frame.constants.twoSidedLighting = arguments.twoSidedLighting;
+    frame.constants.flatShading      = arguments.flatShading;
+
+    ThreadPool          threadPool(arguments.nThreads);
+    const SoftwareImage image =
+        arguments.rayCast ? castRays(frame, arguments, threadPool) : rasterize(frame, arguments, threadPool);
+    saveSoftwareImage(arguments.output, image);
+    std::cout << "Wrote " << arguments.output.string() << std::endl;
+
+    if (!arguments.reference.empty())
+    {
+      // A capture of a viewer, e.g., a screenshot of the drawing area at the same size.
+      const SoftwareImageDifference difference =
+          compareSoftwareImages(image, loadSoftwareImage(arguments.reference), arguments.tolerance);
+      std::cout << "Reference: mean error " << difference.meanError << ", max. error " << difference.maxError << ", "
+                << difference.fractionAboveTolerance * 100.0 << " % of the pixels above " << arguments.tolerance
+                << std::endl;
+      if (difference.fractionAboveTolerance > arguments.maxFractionAboveTolerance)
+      {
+        std::cerr << "Error: The image differs from " << arguments.reference.string() << "\n";
+        return 1;
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include <filesystem>
+#include <gimslib/io/TextureFile.hpp>
+#include <gimslib/sw/SoftwareImage.hpp>
+#include <gimslib/sw/TextureCompression.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace gims;
+
+namespace
+{
+struct Arguments
+{
+  std::vector<std::filesystem::path> inputs;
+  std::string                        format = "auto"; //! auto, bc1, bc3, or rgba8.
+  std::filesystem::path              outputDirectory;  //! Next to the input if empty.
+};
+
+Arguments parseArguments(int argc, char** argv)
+{
+  Arguments arguments;
+  bool      valid = true;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--format" && i + 1 < argc)
+    {
+      arguments.format = argv[++i];
+    }
+    else if (argument == "--output-directory" && i + 1 < argc)
+    {
+      arguments.outputDirectory = argv[++i];
+    }
+    else if (argument.rfind("--", 0) != 0)
+    {
+      arguments.inputs.push_back(argument);
+    }
+    else
+    {
+      valid = false;
+      break;
+    }
+  }
+  if (!valid || arguments.inputs.empty() ||
+      (arguments.format != "auto" && arguments.format != "bc1" && arguments.format != "bc3" &&
+       arguments.format != "rgba8"))
+  {
+    throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                " <image>... [--format auto | bc1 | bc3 | rgba8] [--output-directory <directory>]\n"
+                                "Writes a DDS file with all mip levels next to each image, which the scene graph viewer"
+                                " uploads instead of the image. auto uses BC1 for opaque images and BC3 otherwise.");
+  }
+  return arguments;
+}
+
+void convert(const std::filesystem::path& input, const Arguments& arguments)
+{
+  const SoftwareImage image  = loadSoftwareImage(input);
+  const TextureFormat format = arguments.format == "bc1"     ? TextureFormat::BC1UnormSrgb
+                               : arguments.format == "bc3"   ? TextureFormat::BC3UnormSrgb
+                               : arguments.format == "rgba8" ? TextureFormat::R8G8B8A8UnormSrgb
+                                                             : chooseCompressedFormat(image);
+  const CompressedTexture texture = compressTexture(image, format);
+
+  const std::filesystem::path directory =
+      arguments.outputDirectory.empty() ? input.parent_path() : arguments.outputDirectory;
+  const std::filesystem::path output = directory / input.filename().replace_extension(".dds");
+  saveDdsFile(output, texture.format, texture.width, texture.height, texture.mipLevels);
+  const char* formatName = format == TextureFormat::BC1UnormSrgb   ? "BC1"
+                           : format == TextureFormat::BC3UnormSrgb ? "BC3"
+                                                                   : "RGBA8";
+  std::cout << "Wrote " << output.string() << " (" << formatName << ", " << texture.mipLevels.size()
+            << " mip levels, " << std::filesystem::file_size(output) / 1024 << " KB)" << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    const Arguments arguments = parseArguments(argc, argv);
+    for (const auto& input : arguments.inputs)
+    {
+      convert(input, arguments);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}